@@ -0,0 +1,3 @@
+#!/bin/sh
+# Run reproducible constant array comparison benchmarks.
+exec "$(dirname "$0")/runner.py" "$@"
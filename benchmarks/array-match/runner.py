@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+"""Run paired, alternating constant array comparison benchmark trials."""
+
+import argparse
+import json
+import os
+from pathlib import Path
+import platform
+import shlex
+import statistics
+import subprocess
+import tempfile
+
+
+def arguments():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--build-dir", required=True)
+    parser.add_argument("--label", required=True)
+    parser.add_argument("--output", required=True)
+    parser.add_argument("--pair-build-dir")
+    parser.add_argument("--pair-label")
+    parser.add_argument("--pair-output")
+    parser.add_argument("--messages", type=int, default=500000)
+    parser.add_argument("--patterns", default="8,64,512")
+    parser.add_argument("--operators", default="contains,contains_i,startswith")
+    parser.add_argument("--data-len", type=int, default=200)
+    parser.add_argument("--trials", type=int, default=11)
+    parser.add_argument("--calibration", type=int, default=1)
+    args = parser.parse_args()
+    paired = (args.pair_build_dir, args.pair_label, args.pair_output)
+    if any(paired) and not all(paired):
+        parser.error("pair mode requires all pair arguments")
+    if args.pair_label == args.label:
+        parser.error("pair labels must be distinct")
+    try:
+        args.patterns = [int(count) for count in args.patterns.split(",")]
+    except ValueError:
+        parser.error("patterns must be a comma-separated list of integers")
+    args.operators = args.operators.split(",")
+    if not set(args.operators) <= {"contains", "contains_i", "startswith", "startswith_i", "endswith"}:
+        parser.error("unsupported operator")
+    if min([args.messages, args.data_len, args.trials] + args.patterns) < 1:
+        parser.error("numeric arguments must be positive")
+    if args.calibration < 0:
+        parser.error("calibration must not be negative")
+    return args
+
+
+def build_metadata(build):
+    makefile = build / "Makefile"
+    compiler = "unknown"
+    if makefile.exists():
+        for line in makefile.read_text(encoding="utf-8", errors="replace").splitlines():
+            if line.startswith("CC = "):
+                compiler = line[5:].strip()
+                break
+    try:
+        compiler_version = subprocess.check_output(
+            shlex.split(compiler) + ["--version"], text=True, stderr=subprocess.STDOUT).splitlines()[0]
+    except (OSError, subprocess.CalledProcessError):
+        compiler_version = "unavailable"
+    try:
+        configure = subprocess.check_output(
+            [str(build / "config.status"), "--config"], text=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        configure = "unavailable"
+    revision = subprocess.check_output(["git", "-C", str(build), "rev-parse", "HEAD"], text=True).strip()
+    return {"revision": revision, "compiler": compiler,
+            "compiler_version": compiler_version, "configure": configure}
+
+
+def run_trial(script, build, args, workload, index, measured, artifacts):
+    operator, patterns = workload
+    metric = artifacts / ("metric-%s-%s-%d-%d.json" % (build.name, operator, patterns, index))
+    env = os.environ.copy()
+    env.update({"BENCH_BUILD_DIR": str(build), "BENCH_METRIC_FILE": str(metric),
+                "BENCH_MESSAGES": str(args.messages), "BENCH_PATTERNS": str(patterns),
+                "BENCH_OPERATOR": operator, "BENCH_DATA_LEN": str(args.data_len)})
+    subprocess.run([str(script)], env=env, check=True)
+    value = json.loads(metric.read_text(encoding="utf-8"))
+    value.update({"index": index, "measured": measured})
+    return value
+
+
+def main():
+    args = arguments()
+    script = Path(__file__).with_name("trial.sh").resolve()
+    builds = [(Path(args.build_dir).resolve(), args.label, Path(args.output).resolve())]
+    if args.pair_build_dir:
+        builds.append((Path(args.pair_build_dir).resolve(), args.pair_label, Path(args.pair_output).resolve()))
+    workloads = [(operator, patterns) for operator in args.operators for patterns in args.patterns]
+    results = {label: {workload: [] for workload in workloads} for _, label, _ in builds}
+    with tempfile.TemporaryDirectory(prefix="rsyslog-array-match-bench-") as directory:
+        artifacts = Path(directory)
+        for workload in workloads:
+            for index in range(args.calibration + args.trials):
+                order = builds if index % 2 == 0 else list(reversed(builds))
+                for build, label, _ in order:
+                    results[label][workload].append(
+                        run_trial(script, build, args, workload, index, index >= args.calibration, artifacts))
+    for build, label, output in builds:
+        summary = {}
+        for (operator, patterns), trials in results[label].items():
+            measured = [item for item in trials if item["measured"]]
+            summary["%s/%d" % (operator, patterns)] = {
+                "median_messages_per_second": statistics.median(
+                    item["messages_per_second"] for item in measured)}
+        document = {"schema": 1, "label": label, **build_metadata(build),
+                    "system": {"platform": platform.platform(), "machine": platform.machine(),
+                               "processor": platform.processor(), "cpus": os.cpu_count(),
+                               "python": platform.python_version()},
+                    "workload": {"messages": args.messages, "data_len": args.data_len},
+                    "host_exclusive": False, "cache_state": "uncontrolled",
+                    "trials": {"%s/%d" % key: trials for key, trials in results[label].items()},
+                    "summary": summary}
+        output.parent.mkdir(parents=True, exist_ok=True)
+        output.write_text(json.dumps(document, indent=2) + "\n", encoding="utf-8")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,42 @@
+#!/bin/bash
+# Compare every message against a large constant array and validate delivery.
+: "${BENCH_BUILD_DIR:?}" "${BENCH_MESSAGES:?}" "${BENCH_PATTERNS:?}"
+: "${BENCH_OPERATOR:?}" "${BENCH_DATA_LEN:?}" "${BENCH_METRIC_FILE:?}"
+
+cd "$BENCH_BUILD_DIR/tests" || exit 1
+export srcdir="$BENCH_BUILD_DIR/tests"
+. "$srcdir/diag.sh" init
+
+# patterns never occur in tcpflood messages, so every comparison has to
+# look at all of them; this is the worst case for member-by-member matching
+array=$(awk -v n="$BENCH_PATTERNS" 'BEGIN {
+	for (i = 0; i < n; ++i) printf "%s\"tok%05dz-%x\"", (i ? ", " : ""), i, i * 2654435761 % 65536 }')
+PORT_FILE="$PWD/${RSYSLOG_DYNNAME}.input.port"
+generate_conf
+add_conf '
+module(load="../plugins/imtcp/.libs/imtcp")
+main_queue(queue.workerThreads="1")
+input(type="imtcp" address="127.0.0.1" port="0" listenPortFileName="'"$PORT_FILE"'")
+template(name="benchOut" type="string" string="x\n")
+if ($msg '"$BENCH_OPERATOR"' ['"$array"']) then {
+	stop
+}
+action(type="omfile" file="'"$RSYSLOG_OUT_LOG"'" template="benchOut")
+'
+
+startup
+assign_file_content INPUT_PORT "$PORT_FILE"
+start_ns=$(date +%s%N)
+tcpflood -p"$INPUT_PORT" -m"$BENCH_MESSAGES" -d"$BENCH_DATA_LEN" >/dev/null
+shutdown_when_empty
+wait_shutdown
+end_ns=$(date +%s%N)
+
+delivered=$(wc -l <"$RSYSLOG_OUT_LOG")
+[ "$delivered" -eq "$BENCH_MESSAGES" ] || error_exit 1 "delivered $delivered of $BENCH_MESSAGES messages"
+mkdir -p "$(dirname "$BENCH_METRIC_FILE")"
+printf '{"messages":%d,"patterns":%d,"operator":"%s","data_len":%d,"elapsed_ns":%d,"messages_per_second":%.3f}\n' \
+	"$BENCH_MESSAGES" "$BENCH_PATTERNS" "$BENCH_OPERATOR" "$BENCH_DATA_LEN" "$((end_ns-start_ns))" \
+	"$(awk -v n="$BENCH_MESSAGES" -v t="$((end_ns-start_ns))" 'BEGIN { print n * 1000000000 / t }')" \
+	>"$BENCH_METRIC_FILE"
+exit_test
@@ -0,0 +1,3 @@
+#!/bin/sh
+# Run reproducible imfile read path benchmarks.
+exec "$(dirname "$0")/runner.py" "$@"
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""Run paired, alternating imfile read path benchmark trials."""
+
+import argparse
+import json
+import os
+from pathlib import Path
+import platform
+import random
+import shlex
+import statistics
+import subprocess
+import tempfile
+
+READ_MODES = ("0", "2", "startmsg")
+
+
+def arguments():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--build-dir", required=True)
+    parser.add_argument("--label", required=True)
+    parser.add_argument("--output", required=True)
+    parser.add_argument("--pair-build-dir")
+    parser.add_argument("--pair-label")
+    parser.add_argument("--pair-output")
+    parser.add_argument("--input")
+    parser.add_argument("--synthetic-lines", type=int, default=1000000)
+    parser.add_argument("--line-length", type=int, default=200)
+    parser.add_argument("--read-modes", default="0,2,startmsg")
+    parser.add_argument("--startmsg-regex", default="^msgnum:")
+    parser.add_argument("--trials", type=int, default=11)
+    parser.add_argument("--calibration", type=int, default=1)
+    args = parser.parse_args()
+    paired = (args.pair_build_dir, args.pair_label, args.pair_output)
+    if any(paired) and not all(paired):
+        parser.error("pair mode requires all pair arguments")
+    if args.pair_label == args.label:
+        parser.error("pair labels must be distinct")
+    args.read_modes = args.read_modes.split(",")
+    if any(mode not in READ_MODES for mode in args.read_modes):
+        parser.error("read modes must be a comma-separated list of %s" % ", ".join(READ_MODES))
+    if min(args.synthetic_lines, args.line_length, args.trials) < 1:
+        parser.error("numeric arguments must be positive")
+    if args.calibration < 0:
+        parser.error("calibration must not be negative")
+    return args
+
+
+def synthesize_input(path, lines, length):
+    """Application log style lines; every eighth one is followed by an indented continuation."""
+    rng = random.Random(4711)
+    with path.open("w", encoding="ascii") as log:
+        for number in range(lines):
+            log.write("msgnum:%08d: 2026-10-17T12:00:00.000Z app[%d] %s\n" %
+                      (number, number % 4096, "x" * rng.randrange(length // 2, length + 1)))
+            if number % 8 == 0:
+                log.write("\tat continuation line %d\n" % number)
+
+
+def build_metadata(build):
+    makefile = build / "Makefile"
+    compiler = "unknown"
+    if makefile.exists():
+        for line in makefile.read_text(encoding="utf-8", errors="replace").splitlines():
+            if line.startswith("CC = "):
+                compiler = line[5:].strip()
+                break
+    try:
+        compiler_version = subprocess.check_output(
+            shlex.split(compiler) + ["--version"], text=True, stderr=subprocess.STDOUT).splitlines()[0]
+    except (OSError, subprocess.CalledProcessError):
+        compiler_version = "unavailable"
+    try:
+        configure = subprocess.check_output(
+            [str(build / "config.status"), "--config"], text=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        configure = "unavailable"
+    revision = subprocess.check_output(["git", "-C", str(build), "rev-parse", "HEAD"], text=True).strip()
+    return {"revision": revision, "compiler": compiler,
+            "compiler_version": compiler_version, "configure": configure}
+
+
+def run_trial(script, build, args, source, mode, index, measured, artifacts):
+    metric = artifacts / ("metric-%s-%s-%d.json" % (build.name, mode, index))
+    env = os.environ.copy()
+    env.update({"BENCH_BUILD_DIR": str(build), "BENCH_METRIC_FILE": str(metric),
+                "BENCH_INPUT": str(source), "BENCH_READ_MODE": mode,
+                "BENCH_STARTMSG_REGEX": args.startmsg_regex})
+    subprocess.run([str(script)], env=env, check=True)
+    value = json.loads(metric.read_text(encoding="utf-8"))
+    value.update({"index": index, "measured": measured})
+    return value
+
+
+def main():
+    args = arguments()
+    script = Path(__file__).with_name("trial.sh").resolve()
+    builds = [(Path(args.build_dir).resolve(), args.label, Path(args.output).resolve())]
+    if args.pair_build_dir:
+        builds.append((Path(args.pair_build_dir).resolve(), args.pair_label, Path(args.pair_output).resolve()))
+    results = {label: {mode: [] for mode in args.read_modes} for _, label, _ in builds}
+    with tempfile.TemporaryDirectory(prefix="rsyslog-imfile-read-bench-") as directory:
+        artifacts = Path(directory)
+        if args.input:
+            source = Path(args.input).resolve()
+            origin = "recorded"
+        else:
+            source = artifacts / "synthetic.log"
+            synthesize_input(source, args.synthetic_lines, args.line_length)
+            origin = "synthetic"
+        for mode in args.read_modes:
+            for index in range(args.calibration + args.trials):
+                order = builds if index % 2 == 0 else list(reversed(builds))
+                for build, label, _ in order:
+                    results[label][mode].append(
+                        run_trial(script, build, args, source, mode, index, index >= args.calibration, artifacts))
+        input_bytes = source.stat().st_size
+    # every build must split the file into the same messages
+    for mode in args.read_modes:
+        delivered = {item["delivered"] for label in results for item in results[label][mode]}
+        if len(delivered) != 1:
+            raise SystemExit("read mode %s: delivered message counts differ: %s" % (mode, sorted(delivered)))
+    for build, label, output in builds:
+        summary = {}
+        for mode, trials in results[label].items():
+            measured = [item for item in trials if item["measured"]]
+            summary["read_mode/%s" % mode] = {
+                "median_messages_per_second": statistics.median(
+                    item["messages_per_second"] for item in measured),
+                "median_megabytes_per_second": statistics.median(
+                    item["megabytes_per_second"] for item in measured),
+                "delivered": measured[0]["delivered"]}
+        document = {"schema": 1, "label": label, **build_metadata(build),
+                    "system": {"platform": platform.platform(), "machine": platform.machine(),
+                               "processor": platform.processor(), "cpus": os.cpu_count(),
+                               "python": platform.python_version()},
+                    "input": {"source": origin, "bytes": input_bytes,
+                              "startmsg_regex": args.startmsg_regex},
+                    "host_exclusive": False, "cache_state": "uncontrolled",
+                    "trials": {"read_mode/%s" % mode: trials for mode, trials in results[label].items()},
+                    "summary": summary}
+        output.parent.mkdir(parents=True, exist_ok=True)
+        output.write_text(json.dumps(document, indent=2) + "\n", encoding="utf-8")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,57 @@
+#!/bin/bash
+# Replay one log file through imfile and time until its last line arrived.
+: "${BENCH_BUILD_DIR:?}" "${BENCH_INPUT:?}" "${BENCH_READ_MODE:?}"
+: "${BENCH_STARTMSG_REGEX:?}" "${BENCH_METRIC_FILE:?}"
+
+cd "$BENCH_BUILD_DIR/tests" || exit 1
+export srcdir="$BENCH_BUILD_DIR/tests"
+. "$srcdir/diag.sh" init
+
+# The input ends in two marker lines. In every mode the second one completes
+# the message that holds the first one, so its arrival means the whole file
+# has been read.
+MARKER="rsyslog-bench-end"
+MARKER_LOG="$PWD/$RSYSLOG_DYNNAME.marker.log"
+INPUT_FILE="$PWD/$RSYSLOG_DYNNAME.input"
+case "$BENCH_READ_MODE" in
+	startmsg) read_params='startmsg.regex="('"$BENCH_STARTMSG_REGEX"')|^'"$MARKER"'"' ;;
+	*) read_params='readMode="'"$BENCH_READ_MODE"'"' ;;
+esac
+generate_conf
+add_conf '
+global(maxMessageSize="64k")
+main_queue(queue.workerThreads="1")
+module(load="../plugins/imfile/.libs/imfile" mode="inotify")
+input(type="imfile" file="'"$INPUT_FILE"'" tag="bench:" '"$read_params"')
+template(name="benchOut" type="string" string="x\n")
+if $msg contains "'"$MARKER"'" then {
+	action(type="omfile" file="'"$MARKER_LOG"'" template="benchOut")
+	stop
+}
+action(type="omfile" file="'"$RSYSLOG_OUT_LOG"'" template="benchOut")
+'
+
+# prepare the file next to its final name so that it appears atomically
+cp "$BENCH_INPUT" "$INPUT_FILE.tmp"
+printf '%s\n%s\n' "$MARKER" "$MARKER" >>"$INPUT_FILE.tmp"
+bytes=$(stat -c %s "$INPUT_FILE.tmp")
+startup
+start_ns=$(date +%s%N)
+mv "$INPUT_FILE.tmp" "$INPUT_FILE"
+deadline=$(($(date +%s) + 600))
+until [ -s "$MARKER_LOG" ]; do
+	[ "$(date +%s)" -lt "$deadline" ] || error_exit 1 "input file not consumed within 600 seconds"
+	sleep 0.01
+done
+end_ns=$(date +%s%N)
+shutdown_when_empty
+wait_shutdown
+
+delivered=$(wc -l <"$RSYSLOG_OUT_LOG" 2>/dev/null || echo 0)
+mkdir -p "$(dirname "$BENCH_METRIC_FILE")"
+printf '{"read_mode":"%s","bytes":%d,"delivered":%d,"elapsed_ns":%d,"messages_per_second":%.3f,"megabytes_per_second":%.3f}\n' \
+	"$BENCH_READ_MODE" "$bytes" "$delivered" "$((end_ns-start_ns))" \
+	"$(awk -v n="$delivered" -v t="$((end_ns-start_ns))" 'BEGIN { print n * 1000000000 / t }')" \
+	"$(awk -v n="$bytes" -v t="$((end_ns-start_ns))" 'BEGIN { print n * 1000 / t }')" \
+	>"$BENCH_METRIC_FILE"
+exit_test
@@ -0,0 +1,3 @@
+#!/bin/sh
+# Run reproducible regex lookup table benchmarks.
+exec "$(dirname "$0")/runner.py" "$@"
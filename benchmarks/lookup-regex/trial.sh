@@ -0,0 +1,45 @@
+#!/bin/bash
+# Look every message up in a large regex lookup table and validate delivery.
+: "${BENCH_BUILD_DIR:?}" "${BENCH_MESSAGES:?}" "${BENCH_ENTRIES:?}"
+: "${BENCH_DATA_LEN:?}" "${BENCH_METRIC_FILE:?}"
+
+cd "$BENCH_BUILD_DIR/tests" || exit 1
+export srcdir="$BENCH_BUILD_DIR/tests"
+. "$srcdir/diag.sh" init
+
+# no entry matches tcpflood messages, so every lookup has to consider the
+# whole table; this is the worst case for evaluating entry by entry
+awk -v n="$BENCH_ENTRIES" 'BEGIN {
+	printf "{ \"version\": 1, \"nomatch\": \"none\", \"type\": \"regex\", \"table\": [\n"
+	for (i = 0; i < n; ++i)
+		printf "%s  { \"regex\": \"(^|[ =])tok%05d[a-f]+-[0-9]{2,4}( |$)\", \"tag\": \"t%d\" }\n",
+			(i ? "," : ""), i, i % 16
+	printf "] }\n" }' >"$RSYSLOG_DYNNAME.rx.lkp_tbl"
+PORT_FILE="$PWD/${RSYSLOG_DYNNAME}.input.port"
+generate_conf
+add_conf '
+module(load="../plugins/imtcp/.libs/imtcp")
+main_queue(queue.workerThreads="1")
+input(type="imtcp" address="127.0.0.1" port="0" listenPortFileName="'"$PORT_FILE"'")
+lookup_table(name="rx" file="'"$RSYSLOG_DYNNAME"'.rx.lkp_tbl")
+template(name="benchOut" type="string" string="%$.tag%\n")
+set $.tag = lookup("rx", $msg);
+action(type="omfile" file="'"$RSYSLOG_OUT_LOG"'" template="benchOut")
+'
+
+startup
+assign_file_content INPUT_PORT "$PORT_FILE"
+start_ns=$(date +%s%N)
+tcpflood -p"$INPUT_PORT" -m"$BENCH_MESSAGES" -d"$BENCH_DATA_LEN" >/dev/null
+shutdown_when_empty
+wait_shutdown
+end_ns=$(date +%s%N)
+
+delivered=$(grep -c '^none$' "$RSYSLOG_OUT_LOG")
+[ "$delivered" -eq "$BENCH_MESSAGES" ] || error_exit 1 "delivered $delivered of $BENCH_MESSAGES messages"
+mkdir -p "$(dirname "$BENCH_METRIC_FILE")"
+printf '{"messages":%d,"entries":%d,"data_len":%d,"elapsed_ns":%d,"messages_per_second":%.3f}\n' \
+	"$BENCH_MESSAGES" "$BENCH_ENTRIES" "$BENCH_DATA_LEN" "$((end_ns-start_ns))" \
+	"$(awk -v n="$BENCH_MESSAGES" -v t="$((end_ns-start_ns))" 'BEGIN { print n * 1000000000 / t }')" \
+	>"$BENCH_METRIC_FILE"
+exit_test
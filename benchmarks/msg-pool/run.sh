@@ -0,0 +1,3 @@
+#!/bin/sh
+# Run reproducible message object pool benchmarks.
+exec "$(dirname "$0")/runner.py" "$@"
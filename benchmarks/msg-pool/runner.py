@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Run paired, alternating message object pool benchmark trials."""
+
+import argparse
+import json
+import os
+from pathlib import Path
+import platform
+import shlex
+import statistics
+import subprocess
+import tempfile
+
+
+def arguments():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--build-dir", required=True)
+    parser.add_argument("--label", required=True)
+    parser.add_argument("--output", required=True)
+    parser.add_argument("--pair-build-dir")
+    parser.add_argument("--pair-label")
+    parser.add_argument("--pair-output")
+    parser.add_argument("--messages", type=int, default=1000000)
+    parser.add_argument("--producers", default="1,2,4,8")
+    parser.add_argument("--consumers", default="1,4")
+    parser.add_argument("--trials", type=int, default=11)
+    parser.add_argument("--calibration", type=int, default=1)
+    args = parser.parse_args()
+    paired = (args.pair_build_dir, args.pair_label, args.pair_output)
+    if any(paired) and not all(paired):
+        parser.error("pair mode requires all pair arguments")
+    if args.pair_label == args.label:
+        parser.error("pair labels must be distinct")
+    try:
+        args.producers = [int(count) for count in args.producers.split(",")]
+        args.consumers = [int(count) for count in args.consumers.split(",")]
+    except ValueError:
+        parser.error("producers and consumers must be comma-separated lists of integers")
+    if min([args.messages, args.trials] + args.producers + args.consumers) < 1:
+        parser.error("numeric arguments must be positive")
+    if args.calibration < 0:
+        parser.error("calibration must not be negative")
+    return args
+
+
+def build_metadata(build):
+    makefile = build / "Makefile"
+    compiler = "unknown"
+    if makefile.exists():
+        for line in makefile.read_text(encoding="utf-8", errors="replace").splitlines():
+            if line.startswith("CC = "):
+                compiler = line[5:].strip()
+                break
+    try:
+        compiler_version = subprocess.check_output(
+            shlex.split(compiler) + ["--version"], text=True, stderr=subprocess.STDOUT).splitlines()[0]
+    except (OSError, subprocess.CalledProcessError):
+        compiler_version = "unavailable"
+    try:
+        configure = subprocess.check_output(
+            [str(build / "config.status"), "--config"], text=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        configure = "unavailable"
+    revision = subprocess.check_output(["git", "-C", str(build), "rev-parse", "HEAD"], text=True).strip()
+    return {"revision": revision, "compiler": compiler,
+            "compiler_version": compiler_version, "configure": configure}
+
+
+def run_trial(script, build, args, workload, index, measured, artifacts):
+    producers, consumers = workload
+    metric = artifacts / ("metric-%s-%d-%d-%d.json" % (build.name, producers, consumers, index))
+    env = os.environ.copy()
+    env.update({"BENCH_BUILD_DIR": str(build), "BENCH_METRIC_FILE": str(metric),
+                "BENCH_MESSAGES": str(args.messages), "BENCH_PRODUCERS": str(producers),
+                "BENCH_CONSUMERS": str(consumers)})
+    subprocess.run([str(script)], env=env, check=True)
+    value = json.loads(metric.read_text(encoding="utf-8"))
+    value.update({"index": index, "measured": measured})
+    return value
+
+
+def main():
+    args = arguments()
+    script = Path(__file__).with_name("trial.sh").resolve()
+    builds = [(Path(args.build_dir).resolve(), args.label, Path(args.output).resolve())]
+    if args.pair_build_dir:
+        builds.append((Path(args.pair_build_dir).resolve(), args.pair_label, Path(args.pair_output).resolve()))
+    workloads = [(producers, consumers) for producers in args.producers for consumers in args.consumers]
+    results = {label: {workload: [] for workload in workloads} for _, label, _ in builds}
+    with tempfile.TemporaryDirectory(prefix="rsyslog-msg-pool-bench-") as directory:
+        artifacts = Path(directory)
+        for workload in workloads:
+            for index in range(args.calibration + args.trials):
+                order = builds if index % 2 == 0 else list(reversed(builds))
+                for build, label, _ in order:
+                    results[label][workload].append(
+                        run_trial(script, build, args, workload, index, index >= args.calibration, artifacts))
+    for build, label, output in builds:
+        summary = {}
+        for (producers, consumers), trials in results[label].items():
+            measured = [item for item in trials if item["measured"]]
+            summary["producers/%d/consumers/%d" % (producers, consumers)] = {
+                "median_messages_per_second": statistics.median(
+                    item["messages_per_second"] for item in measured),
+                "median_delivered": statistics.median(item["delivered"] for item in measured)}
+        document = {"schema": 1, "label": label, **build_metadata(build),
+                    "system": {"platform": platform.platform(), "machine": platform.machine(),
+                               "processor": platform.processor(), "cpus": os.cpu_count(),
+                               "python": platform.python_version()},
+                    "workload": {"messages": args.messages},
+                    "host_exclusive": False, "cache_state": "uncontrolled",
+                    "trials": {"producers/%d/consumers/%d" % key: trials
+                               for key, trials in results[label].items()},
+                    "summary": summary}
+        output.parent.mkdir(parents=True, exist_ok=True)
+        output.write_text(json.dumps(document, indent=2) + "\n", encoding="utf-8")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,48 @@
+#!/bin/bash
+# Flood imudp from several sender threads and let queue workers destruct the messages.
+: "${BENCH_BUILD_DIR:?}" "${BENCH_PRODUCERS:?}" "${BENCH_CONSUMERS:?}"
+: "${BENCH_MESSAGES:?}" "${BENCH_METRIC_FILE:?}"
+
+cd "$BENCH_BUILD_DIR/tests" || exit 1
+export srcdir="$BENCH_BUILD_DIR/tests"
+. "$srcdir/diag.sh" init
+
+# one socket per producer, so that every imudp thread constructs messages
+inputs=
+for ((i = 0; i < BENCH_PRODUCERS; ++i)); do
+	inputs+='input(type="imudp" address="127.0.0.1" port="0" rcvbufSize="16m"
+	      listenPortFileName="'"$RSYSLOG_DYNNAME"'.port'$i'")
+'
+done
+generate_conf
+add_conf '
+module(load="../plugins/imudp/.libs/imudp" threads="'"$BENCH_PRODUCERS"'")
+main_queue(queue.size="200000" queue.workerThreads="'"$BENCH_CONSUMERS"'"
+	   queue.workerThreadMinimumMessages="1")
+'"$inputs"'
+template(name="benchOut" type="string" string="x\n")
+action(type="omfile" file="'"$RSYSLOG_OUT_LOG"'" template="benchOut")
+'
+
+startup
+per_producer=$((BENCH_MESSAGES / BENCH_PRODUCERS))
+start_ns=$(date +%s%N)
+for ((i = 0; i < BENCH_PRODUCERS; ++i)); do
+	assign_file_content INPUT_PORT "$RSYSLOG_DYNNAME.port$i"
+	./tcpflood -Tudp -p"$INPUT_PORT" -m"$per_producer" >/dev/null &
+done
+wait
+shutdown_when_empty
+wait_shutdown
+end_ns=$(date +%s%N)
+
+# UDP may drop under overload; throughput is what actually went through
+delivered=$(wc -l <"$RSYSLOG_OUT_LOG")
+sent=$((per_producer * BENCH_PRODUCERS))
+[ "$delivered" -gt 0 ] || error_exit 1 "no messages delivered"
+mkdir -p "$(dirname "$BENCH_METRIC_FILE")"
+printf '{"producers":%d,"consumers":%d,"sent":%d,"delivered":%d,"elapsed_ns":%d,"messages_per_second":%.3f}\n' \
+	"$BENCH_PRODUCERS" "$BENCH_CONSUMERS" "$sent" "$delivered" "$((end_ns-start_ns))" \
+	"$(awk -v n="$delivered" -v t="$((end_ns-start_ns))" 'BEGIN { print n * 1000000000 / t }')" \
+	>"$BENCH_METRIC_FILE"
+exit_test
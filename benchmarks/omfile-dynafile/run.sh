@@ -0,0 +1,3 @@
+#!/bin/sh
+# Run reproducible omfile dynafile cache benchmarks.
+exec "$(dirname "$0")/runner.py" "$@"
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+"""Run paired, alternating omfile dynafile cache benchmark trials."""
+
+import argparse
+import json
+import os
+from pathlib import Path
+import platform
+import shlex
+import statistics
+import subprocess
+import tempfile
+
+
+def arguments():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--build-dir", required=True)
+    parser.add_argument("--label", required=True)
+    parser.add_argument("--output", required=True)
+    parser.add_argument("--pair-build-dir")
+    parser.add_argument("--pair-label")
+    parser.add_argument("--pair-output")
+    parser.add_argument("--messages", type=int, default=1000000)
+    parser.add_argument("--names", type=int, default=10000)
+    parser.add_argument("--cache-sizes", default="10000,2000")
+    parser.add_argument("--trials", type=int, default=11)
+    parser.add_argument("--calibration", type=int, default=1)
+    args = parser.parse_args()
+    paired = (args.pair_build_dir, args.pair_label, args.pair_output)
+    if any(paired) and not all(paired):
+        parser.error("pair mode requires all pair arguments")
+    if args.pair_label == args.label:
+        parser.error("pair labels must be distinct")
+    try:
+        args.cache_sizes = [int(size) for size in args.cache_sizes.split(",")]
+    except ValueError:
+        parser.error("cache sizes must be a comma-separated list of integers")
+    if min([args.messages, args.names, args.trials] + args.cache_sizes) < 1:
+        parser.error("numeric arguments must be positive")
+    if args.calibration < 0:
+        parser.error("calibration must not be negative")
+    return args
+
+
+def build_metadata(build):
+    makefile = build / "Makefile"
+    compiler = "unknown"
+    if makefile.exists():
+        for line in makefile.read_text(encoding="utf-8", errors="replace").splitlines():
+            if line.startswith("CC = "):
+                compiler = line[5:].strip()
+                break
+    try:
+        compiler_version = subprocess.check_output(
+            shlex.split(compiler) + ["--version"], text=True, stderr=subprocess.STDOUT).splitlines()[0]
+    except (OSError, subprocess.CalledProcessError):
+        compiler_version = "unavailable"
+    try:
+        configure = subprocess.check_output(
+            [str(build / "config.status"), "--config"], text=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        configure = "unavailable"
+    revision = subprocess.check_output(["git", "-C", str(build), "rev-parse", "HEAD"], text=True).strip()
+    return {"revision": revision, "compiler": compiler,
+            "compiler_version": compiler_version, "configure": configure}
+
+
+def run_trial(script, build, args, cache_size, index, measured, artifacts):
+    metric = artifacts / ("metric-%s-%d-%d.json" % (build.name, cache_size, index))
+    env = os.environ.copy()
+    env.update({"BENCH_BUILD_DIR": str(build), "BENCH_METRIC_FILE": str(metric),
+                "BENCH_MESSAGES": str(args.messages), "BENCH_NAMES": str(args.names),
+                "BENCH_CACHE_SIZE": str(cache_size)})
+    subprocess.run([str(script)], env=env, check=True)
+    value = json.loads(metric.read_text(encoding="utf-8"))
+    value.update({"index": index, "measured": measured})
+    return value
+
+
+def main():
+    args = arguments()
+    script = Path(__file__).with_name("trial.sh").resolve()
+    builds = [(Path(args.build_dir).resolve(), args.label, Path(args.output).resolve())]
+    if args.pair_build_dir:
+        builds.append((Path(args.pair_build_dir).resolve(), args.pair_label, Path(args.pair_output).resolve()))
+    results = {label: {size: [] for size in args.cache_sizes} for _, label, _ in builds}
+    with tempfile.TemporaryDirectory(prefix="rsyslog-omfile-dynafile-bench-") as directory:
+        artifacts = Path(directory)
+        for cache_size in args.cache_sizes:
+            for index in range(args.calibration + args.trials):
+                order = builds if index % 2 == 0 else list(reversed(builds))
+                for build, label, _ in order:
+                    results[label][cache_size].append(
+                        run_trial(script, build, args, cache_size, index, index >= args.calibration, artifacts))
+    for build, label, output in builds:
+        summary = {}
+        for cache_size, trials in results[label].items():
+            measured = [item for item in trials if item["measured"]]
+            summary[str(cache_size)] = {
+                "median_messages_per_second": statistics.median(
+                    item["messages_per_second"] for item in measured),
+                "max_maxprobe": max(item["maxprobe"] for item in measured)}
+        document = {"schema": 1, "label": label, **build_metadata(build),
+                    "system": {"platform": platform.platform(), "machine": platform.machine(),
+                               "processor": platform.processor(), "cpus": os.cpu_count(),
+                               "python": platform.python_version()},
+                    "workload": {"messages": args.messages, "names": args.names},
+                    "host_exclusive": False, "cache_state": "uncontrolled",
+                    "trials": {str(size): trials for size, trials in results[label].items()},
+                    "summary": summary}
+        output.parent.mkdir(parents=True, exist_ok=True)
+        output.write_text(json.dumps(document, indent=2) + "\n", encoding="utf-8")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,61 @@
+#!/bin/bash
+# Spread messages round-robin over many dynafile names and validate delivery.
+: "${BENCH_BUILD_DIR:?}" "${BENCH_MESSAGES:?}" "${BENCH_NAMES:?}"
+: "${BENCH_CACHE_SIZE:?}" "${BENCH_METRIC_FILE:?}"
+
+cd "$BENCH_BUILD_DIR/tests" || exit 1
+export srcdir="$BENCH_BUILD_DIR/tests"
+. "$srcdir/diag.sh" init
+
+# every cached dynafile keeps its descriptor open
+ulimit -n $((BENCH_CACHE_SIZE + 1024)) || error_exit 1 "cannot raise the open file limit"
+
+PORT_FILE="$PWD/${RSYSLOG_DYNNAME}.input.port"
+STATS_FILE="$PWD/${RSYSLOG_DYNNAME}.stats"
+OUT_DIR="$PWD/${RSYSLOG_DYNNAME}.dynafiles"
+mkdir -p "$OUT_DIR"
+generate_conf
+add_conf '
+module(load="../plugins/imtcp/.libs/imtcp")
+module(load="../plugins/impstats/.libs/impstats" log.file="'"$STATS_FILE"'"
+	interval="1" resetCounters="off" ruleset="benchStats")
+ruleset(name="benchStats") { stop }
+main_queue(queue.workerThreads="1")
+input(type="imtcp" address="127.0.0.1" port="0" listenPortFileName="'"$PORT_FILE"'")
+template(name="benchFile" type="string" string="'"$OUT_DIR"'/%$.name%.log")
+template(name="benchOut" type="string" string="x\n")
+if ($msg contains "msgnum:") then {
+	set $.name = cnum(field($msg, 58, 2)) % '"$BENCH_NAMES"';
+	action(type="omfile" dynaFile="benchFile" template="benchOut"
+		dynaFileCacheSize="'"$BENCH_CACHE_SIZE"'")
+}
+'
+
+startup
+assign_file_content INPUT_PORT "$PORT_FILE"
+# the interval ends with shutdown, so closing the cached files is included
+start_ns=$(date +%s%N)
+tcpflood -p"$INPUT_PORT" -m"$BENCH_MESSAGES" >/dev/null
+shutdown_when_empty
+wait_shutdown
+end_ns=$(date +%s%N)
+
+delivered=$(find "$OUT_DIR" -type f -exec cat {} + | wc -l)
+[ "$delivered" -eq "$BENCH_MESSAGES" ] || error_exit 1 "delivered $delivered of $BENCH_MESSAGES messages"
+files=$(find "$OUT_DIR" -type f | wc -l)
+# last cache statistics sample; counters a build does not have are reported as -1
+counter() {
+	local value
+	value=$(sed -n 's/.*dynafile cache benchFile: origin=omfile .*\b'"$1"'=\([0-9][0-9]*\).*/\1/p' \
+		"$STATS_FILE" | tail -1)
+	printf '%s' "${value:--1}"
+}
+mkdir -p "$(dirname "$BENCH_METRIC_FILE")"
+printf '{"messages":%d,"names":%d,"files":%d,"cache_size":%d,"elapsed_ns":%d,"messages_per_second":%.3f,' \
+	"$BENCH_MESSAGES" "$BENCH_NAMES" "$files" "$BENCH_CACHE_SIZE" "$((end_ns-start_ns))" \
+	"$(awk -v n="$BENCH_MESSAGES" -v t="$((end_ns-start_ns))" 'BEGIN { print n * 1000000000 / t }')" \
+	>"$BENCH_METRIC_FILE"
+printf '"missed":%d,"evicted":%d,"probes":%d,"maxprobe":%d}\n' \
+	"$(counter missed)" "$(counter evicted)" "$(counter probes)" "$(counter maxprobe)" >>"$BENCH_METRIC_FILE"
+rm -rf "$OUT_DIR"
+exit_test
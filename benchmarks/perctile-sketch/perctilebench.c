@@ -0,0 +1,192 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file perctilebench.c
+ * @brief Observe throughput of the percentile_stats ring buffer and sketch backends.
+ *
+ * Usage: perctilebench ringbuffer|sketch <threads> <observations per thread> <window size>
+ *
+ * All threads start together and record into the same statistic, locking
+ * the way perctile_observe() does for an existing key: the ring buffer takes
+ * the bucket write lock plus the statistic lock, the sketch only the bucket
+ * read lock. Afterwards one report is computed like report_perctile_stats()
+ * does and timed separately. Prints one JSON object; exits non-zero if the
+ * sketch lost an observation.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "../../runtime/statsctr.c"
+#include "../../runtime/perctile_ringbuf.c"
+#include "../../runtime/perctile_sketch.c"
+
+#define N_VALUES 4096 /* power of 2 */
+
+static const uint8_t percentiles[] = {50, 95, 99};
+static int bSketch;
+static long nObservations;
+static size_t windowSize;
+static int64_t values[N_VALUES];
+static pthread_barrier_t barrier;
+static pthread_rwlock_t bucketLock;
+
+/* state of one statistic, like perctile_stat_t */
+static pthread_rwlock_t statLock;
+static ringbuf_t *rb;
+static perctile_sketch_t *sketch;
+static int64_t windowCount, windowSum, windowMin = INT64_MAX, windowMax = INT64_MIN;
+
+static void *observer(void *arg) {
+    const long offset = (long)(intptr_t)arg;
+
+    if (bSketch) statsctrThreadIdx(); /* assign the index outside the timed loop */
+    pthread_barrier_wait(&barrier);
+    for (long i = 0; i < nObservations; ++i) {
+        const int64_t value = values[(i + offset) & (N_VALUES - 1)];
+        if (bSketch) {
+            pthread_rwlock_rdlock(&bucketLock);
+            if (perctile_sketch_add(sketch, value) != RS_RET_OK) exit(1);
+            pthread_rwlock_unlock(&bucketLock);
+        } else {
+            pthread_rwlock_wrlock(&bucketLock);
+            ringbuf_append_with_overwrite(rb, value);
+            pthread_rwlock_wrlock(&statLock);
+            ++windowCount;
+            windowSum += value;
+            if (value < windowMin) windowMin = value;
+            if (value > windowMax) windowMax = value;
+            pthread_rwlock_unlock(&statLock);
+            pthread_rwlock_unlock(&bucketLock);
+        }
+    }
+    return NULL;
+}
+
+static int cmpItem(const void *p1, const void *p2) {
+    const ITEM a = *(const ITEM *)p1;
+    const ITEM b = *(const ITEM *)p2;
+    return (a > b) - (a < b);
+}
+
+/* @return the sum of the reported percentiles, so the work cannot be optimized away */
+static int64_t report(uint64_t *const count) {
+    int64_t result = 0;
+
+    pthread_rwlock_rdlock(&bucketLock);
+    if (bSketch) {
+        perctile_sketch_window_t win;
+        uint64_t *merged = malloc(perctile_sketch_buckets(sketch) * sizeof(uint64_t));
+        if (merged == NULL) exit(1);
+        perctile_sketch_collect(sketch, merged, &win);
+        *count = win.count;
+        for (size_t i = 0; i < sizeof(percentiles) && win.count; ++i) {
+            result += perctile_sketch_quantile(sketch, merged, &win, percentiles[i]);
+        }
+        free(merged);
+    } else {
+        ITEM *buf = malloc(windowSize * sizeof(ITEM));
+        size_t n;
+        if (buf == NULL) exit(1);
+        memset(buf, 0, windowSize * sizeof(ITEM));
+        n = ringbuf_read_to_end(rb, buf, windowSize);
+        qsort(buf, n, sizeof(ITEM), cmpItem);
+        *count = n;
+        for (size_t i = 0; i < sizeof(percentiles) && n; ++i) {
+            const double index = (percentiles[i] / 100.0) * n - 1;
+            result += buf[index > 0 ? (size_t)index : 0];
+        }
+        free(buf);
+    }
+    pthread_rwlock_unlock(&bucketLock);
+    return result;
+}
+
+static uint64 nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64)ts.tv_sec * 1000000000u + (uint64)ts.tv_nsec;
+}
+
+int main(int argc, char *argv[]) {
+    pthread_t *threads;
+    uint64 start, elapsed, reportNs, total, reported;
+    uint32_t seed = 20261017;
+    int64_t checksum;
+    int nThreads;
+
+    if (argc != 5 || (strcmp(argv[1], "ringbuffer") && strcmp(argv[1], "sketch"))) {
+        fprintf(stderr, "usage: %s ringbuffer|sketch <threads> <observations per thread> <window size>\n", argv[0]);
+        return 2;
+    }
+    bSketch = !strcmp(argv[1], "sketch");
+    nThreads = atoi(argv[2]);
+    nObservations = atol(argv[3]);
+    windowSize = (size_t)atol(argv[4]);
+    if (nThreads < 1 || nObservations < 1 || windowSize < 1) {
+        fprintf(stderr, "thread, observation and window counts must be positive\n");
+        return 2;
+    }
+    /* log-uniform latencies from 1 to about 1e9 */
+    for (int i = 0; i < N_VALUES; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        values[i] = (int64_t)exp((double)(seed >> 8) / (double)(1u << 24) * 20.7);
+    }
+    pthread_rwlock_init(&bucketLock, NULL);
+    pthread_rwlock_init(&statLock, NULL);
+    if (bSketch) {
+        if (perctile_sketch_new(&sketch, PERCTILE_SKETCH_DFLT_ACCURACY, PERCTILE_SKETCH_DFLT_MAX_BUCKETS) != RS_RET_OK) {
+            return 1;
+        }
+    } else if ((rb = ringbuf_new(windowSize)) == NULL) {
+        return 1;
+    }
+    if ((threads = calloc(nThreads, sizeof(*threads))) == NULL) return 1;
+    pthread_barrier_init(&barrier, NULL, nThreads + 1);
+    for (int i = 0; i < nThreads; ++i) {
+        if (pthread_create(&threads[i], NULL, observer, (void *)(intptr_t)(i * 997)) != 0) {
+            perror("pthread_create");
+            return 1;
+        }
+    }
+    pthread_barrier_wait(&barrier);
+    start = nowNs();
+    for (int i = 0; i < nThreads; ++i) pthread_join(threads[i], NULL);
+    elapsed = nowNs() - start;
+
+    start = nowNs();
+    checksum = report(&reported);
+    reportNs = nowNs() - start;
+
+    total = (uint64)nThreads * (uint64)nObservations;
+    if (bSketch && reported != total) {
+        fprintf(stderr, "lost observations: counted %llu, expected %llu\n", reported, total);
+        return 1;
+    }
+    printf("{\"backend\":\"%s\",\"threads\":%d,\"observations\":%llu,\"reported\":%llu,\"elapsed_ns\":%llu,"
+           "\"observations_per_second\":%.3f,\"report_ns\":%llu,\"checksum\":%lld}\n",
+           argv[1], nThreads, total, reported, elapsed, (double)total * 1e9 / (double)(elapsed ? elapsed : 1),
+           reportNs, (long long)checksum);
+    if (bSketch) {
+        perctile_sketch_del(sketch);
+    } else {
+        ringbuf_del(rb);
+    }
+    free(threads);
+    return 0;
+}
@@ -0,0 +1,3 @@
+#!/bin/sh
+# Run reproducible percentile_stats backend scaling benchmarks.
+exec "$(dirname "$0")/runner.py" "$@"
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+"""Run alternating percentile_stats backend benchmark trials over thread counts."""
+
+import argparse
+import json
+import os
+from pathlib import Path
+import platform
+import shlex
+import statistics
+import subprocess
+import tempfile
+
+BACKENDS = ("ringbuffer", "sketch")
+
+
+def arguments():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--build-dir", required=True)
+    parser.add_argument("--output", required=True)
+    parser.add_argument("--threads", default="1,2,4,8,16,32")
+    parser.add_argument("--observations", type=int, default=2000000)
+    parser.add_argument("--window-size", type=int, default=1000)
+    parser.add_argument("--trials", type=int, default=7)
+    parser.add_argument("--calibration", type=int, default=1)
+    args = parser.parse_args()
+    try:
+        args.threads = [int(item) for item in args.threads.split(",")]
+    except ValueError:
+        parser.error("threads must be a comma-separated list of integers")
+    if min(args.threads + [args.observations, args.window_size, args.trials]) < 1:
+        parser.error("numeric arguments must be positive")
+    if args.calibration < 0:
+        parser.error("calibration must not be negative")
+    return args
+
+
+def makefile_variable(build, name):
+    makefile = build / "Makefile"
+    if makefile.exists():
+        for line in makefile.read_text(encoding="utf-8", errors="replace").splitlines():
+            if line.startswith(name + " = "):
+                return line[len(name) + 3:].strip()
+    return None
+
+
+def build_metadata(build):
+    compiler = makefile_variable(build, "CC") or "unknown"
+    try:
+        compiler_version = subprocess.check_output(
+            shlex.split(compiler) + ["--version"], text=True, stderr=subprocess.STDOUT).splitlines()[0]
+    except (OSError, subprocess.CalledProcessError):
+        compiler_version = "unavailable"
+    try:
+        configure = subprocess.check_output(
+            [str(build / "config.status"), "--config"], text=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        configure = "unavailable"
+    revision = subprocess.check_output(["git", "-C", str(build), "rev-parse", "HEAD"], text=True).strip()
+    return {"revision": revision, "compiler": compiler,
+            "compiler_version": compiler_version, "configure": configure}
+
+
+def compile_driver(build, binary):
+    """Build the driver with the compiler, flags and config.h of the configured tree."""
+    source = Path(__file__).with_name("perctilebench.c").resolve()
+    srcdir = Path(makefile_variable(build, "abs_top_srcdir") or build)
+    command = (shlex.split(makefile_variable(build, "CC") or "cc") +
+               shlex.split(makefile_variable(build, "CFLAGS") or "-O2") +
+               ["-I%s" % build, "-I%s" % srcdir, "-I%s" % (srcdir / "runtime"), "-I%s" % (srcdir / "grammar"),
+                "-pthread", "-o", str(binary), str(source), "-lm"])
+    subprocess.run(command, check=True)
+
+
+def run_trial(binary, backend, threads, observations, window_size, index, measured):
+    value = json.loads(subprocess.check_output(
+        [str(binary), backend, str(threads), str(observations), str(window_size)], text=True))
+    value.update({"index": index, "measured": measured})
+    return value
+
+
+def main():
+    args = arguments()
+    build = Path(args.build_dir).resolve()
+    output = Path(args.output).resolve()
+    results = {(backend, threads): [] for backend in BACKENDS for threads in args.threads}
+    with tempfile.TemporaryDirectory(prefix="rsyslog-perctile-sketch-bench-") as directory:
+        binary = Path(directory) / "perctilebench"
+        compile_driver(build, binary)
+        for threads in args.threads:
+            for index in range(args.calibration + args.trials):
+                order = BACKENDS if index % 2 == 0 else tuple(reversed(BACKENDS))
+                for backend in order:
+                    results[(backend, threads)].append(
+                        run_trial(binary, backend, threads, args.observations, args.window_size, index,
+                                  index >= args.calibration))
+    series = []
+    for (backend, threads), trials in results.items():
+        measured = [item for item in trials if item["measured"]]
+        series.append({"backend": backend, "threads": threads, "trials": trials,
+                       "median_observations_per_second": statistics.median(
+                           item["observations_per_second"] for item in measured),
+                       "median_report_ns": statistics.median(item["report_ns"] for item in measured)})
+    document = {"schema": 1, **build_metadata(build),
+                "system": {"platform": platform.platform(), "machine": platform.machine(),
+                           "processor": platform.processor(), "cpus": os.cpu_count(),
+                           "python": platform.python_version()},
+                "observations_per_thread": args.observations, "window_size": args.window_size,
+                "host_exclusive": False, "cache_state": "uncontrolled",
+                "series": series}
+    output.parent.mkdir(parents=True, exist_ok=True)
+    output.write_text(json.dumps(document, indent=2) + "\n", encoding="utf-8")
+
+
+if __name__ == "__main__":
+    main()
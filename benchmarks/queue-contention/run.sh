@@ -0,0 +1,3 @@
+#!/bin/sh
+# Run reproducible queue enqueue contention benchmarks.
+exec "$(dirname "$0")/runner.py" "$@"
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""Run alternating queue contention benchmark trials over producer counts."""
+
+import argparse
+import json
+import os
+from pathlib import Path
+import platform
+import shlex
+import statistics
+import subprocess
+import tempfile
+
+
+def arguments():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--build-dir", required=True)
+    parser.add_argument("--output", required=True)
+    parser.add_argument("--queue-types", default="FixedArray,RingBuffer")
+    parser.add_argument("--producers", default="1,2,4,8,16,32,64")
+    parser.add_argument("--messages", type=int, default=1000000)
+    parser.add_argument("--queue-size", type=int, default=100000)
+    parser.add_argument("--trials", type=int, default=7)
+    parser.add_argument("--calibration", type=int, default=1)
+    args = parser.parse_args()
+    args.queue_types = [item.strip() for item in args.queue_types.split(",") if item.strip()]
+    try:
+        args.producers = [int(item) for item in args.producers.split(",")]
+    except ValueError:
+        parser.error("producers must be a comma-separated list of integers")
+    if len(set(item.lower() for item in args.queue_types)) != len(args.queue_types) or not args.queue_types:
+        parser.error("queue types must be distinct and non-empty")
+    for item in args.queue_types:
+        shards = item.partition("/")[2]
+        if shards and (not shards.isdigit() or int(shards) < 1):
+            parser.error("shard count in '%s' must be a positive integer" % item)
+    if min(args.producers + [args.messages, args.queue_size, args.trials]) < 1:
+        parser.error("numeric arguments must be positive")
+    if args.calibration < 0:
+        parser.error("calibration must not be negative")
+    return args
+
+
+def build_metadata(build):
+    makefile = build / "Makefile"
+    compiler = "unknown"
+    if makefile.exists():
+        for line in makefile.read_text(encoding="utf-8", errors="replace").splitlines():
+            if line.startswith("CC = "):
+                compiler = line[5:].strip()
+                break
+    try:
+        compiler_version = subprocess.check_output(
+            shlex.split(compiler) + ["--version"], text=True, stderr=subprocess.STDOUT).splitlines()[0]
+    except (OSError, subprocess.CalledProcessError):
+        compiler_version = "unavailable"
+    try:
+        configure = subprocess.check_output(
+            [str(build / "config.status"), "--config"], text=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        configure = "unavailable"
+    revision = subprocess.check_output(["git", "-C", str(build), "rev-parse", "HEAD"], text=True).strip()
+    return {"revision": revision, "compiler": compiler,
+            "compiler_version": compiler_version, "configure": configure}
+
+
+def run_trial(script, build, args, queue_type, producers, index, measured, artifacts):
+    metric = artifacts / ("metric-%s-%d-%d.json" % (queue_type.replace("/", "-"), producers, index))
+    env = os.environ.copy()
+    base_type, _, shards = queue_type.partition("/")
+    env.update({"BENCH_BUILD_DIR": str(build), "BENCH_METRIC_FILE": str(metric),
+                "BENCH_QUEUE_TYPE": base_type, "BENCH_QUEUE_SHARDS": shards or "1",
+                "BENCH_PRODUCERS": str(producers),
+                "BENCH_MESSAGES": str(args.messages), "BENCH_QUEUE_SIZE": str(args.queue_size)})
+    subprocess.run([str(script)], env=env, check=True)
+    value = json.loads(metric.read_text(encoding="utf-8"))
+    value.update({"index": index, "measured": measured})
+    return value
+
+
+def main():
+    args = arguments()
+    script = Path(__file__).with_name("trial.sh").resolve()
+    build = Path(args.build_dir).resolve()
+    output = Path(args.output).resolve()
+    results = {(queue_type, producers): [] for queue_type in args.queue_types for producers in args.producers}
+    with tempfile.TemporaryDirectory(prefix="rsyslog-queue-contention-bench-") as directory:
+        artifacts = Path(directory)
+        for producers in args.producers:
+            for index in range(args.calibration + args.trials):
+                order = args.queue_types if index % 2 == 0 else list(reversed(args.queue_types))
+                for queue_type in order:
+                    results[(queue_type, producers)].append(
+                        run_trial(script, build, args, queue_type, producers, index,
+                                  index >= args.calibration, artifacts))
+    series = []
+    for (queue_type, producers), trials in results.items():
+        measured = [item for item in trials if item["measured"]]
+        series.append({"queue_type": queue_type, "producers": producers, "trials": trials,
+                       "median_messages_per_second": statistics.median(
+                           item["messages_per_second"] for item in measured)})
+    document = {"schema": 1, **build_metadata(build),
+                "system": {"platform": platform.platform(), "machine": platform.machine(),
+                           "processor": platform.processor(), "cpus": os.cpu_count(),
+                           "python": platform.python_version()},
+                "messages": args.messages, "queue_size": args.queue_size,
+                "host_exclusive": False, "cache_state": "uncontrolled",
+                "series": series}
+    output.parent.mkdir(parents=True, exist_ok=True)
+    output.write_text(json.dumps(document, indent=2) + "\n", encoding="utf-8")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,35 @@
+#!/bin/bash
+# Flood one queue type from a given number of concurrent producers.
+: "${BENCH_BUILD_DIR:?}" "${BENCH_QUEUE_TYPE:?}" "${BENCH_PRODUCERS:?}"
+: "${BENCH_MESSAGES:?}" "${BENCH_QUEUE_SIZE:?}" "${BENCH_METRIC_FILE:?}"
+: "${BENCH_QUEUE_SHARDS:=1}"
+
+cd "$BENCH_BUILD_DIR/tests" || exit 1
+export srcdir="$BENCH_BUILD_DIR/tests"
+. "$srcdir/diag.sh" init
+
+PORT_FILE="$PWD/${RSYSLOG_DYNNAME}.input.port"
+generate_conf
+add_conf '
+main_queue(queue.type="'"$BENCH_QUEUE_TYPE"'" queue.size="'"$BENCH_QUEUE_SIZE"'"
+	   queue.workerThreads="4" queue.shards="'"$BENCH_QUEUE_SHARDS"'")
+module(load="../plugins/imtcp/.libs/imtcp" workerThreads="'"$BENCH_PRODUCERS"'")
+input(type="imtcp" address="127.0.0.1" port="0" listenPortFileName="'"$PORT_FILE"'")
+template(name="benchOut" type="string" string="x\n")
+action(type="omfile" file="'"$RSYSLOG_OUT_LOG"'" template="benchOut")
+'
+
+startup
+assign_file_content INPUT_PORT "$PORT_FILE"
+start_ns=$(date +%s%N)
+tcpflood -p"$INPUT_PORT" -c"$BENCH_PRODUCERS" -m"$BENCH_MESSAGES" >/dev/null
+wait_file_lines "$RSYSLOG_OUT_LOG" "$BENCH_MESSAGES" 300
+end_ns=$(date +%s%N)
+shutdown_when_empty
+wait_shutdown
+mkdir -p "$(dirname "$BENCH_METRIC_FILE")"
+printf '{"queue_type":"%s","shards":%d,"producers":%d,"messages":%d,"elapsed_ns":%d,"messages_per_second":%.3f}\n' \
+	"$BENCH_QUEUE_TYPE" "$BENCH_QUEUE_SHARDS" "$BENCH_PRODUCERS" "$BENCH_MESSAGES" "$((end_ns-start_ns))" \
+	"$(awk -v n="$BENCH_MESSAGES" -v t="$((end_ns-start_ns))" 'BEGIN { print n * 1000000000 / t }')" \
+	>"$BENCH_METRIC_FILE"
+exit_test
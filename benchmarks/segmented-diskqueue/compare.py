@@ -10,7 +10,8 @@ import statistics
 
 
 METRICS = ("spill_ns", "drain_ns", "restart_ns", "end_to_end_ns", "wall_ns",
-           "child_cpu_seconds", "child_user_seconds", "child_system_seconds")
+           "child_cpu_seconds", "child_user_seconds", "child_system_seconds",
+           "disk_bytes_at_spill")
 
 
 def parse_args():
@@ -40,7 +41,8 @@ def median_absolute_deviation(values):
 def metric_value(record, metric):
     if metric == "child_cpu_seconds":
         return record["child_user_seconds"] + record["child_system_seconds"]
-    return record[metric]
+    # records from before a metric was introduced simply do not take part
+    return record.get(metric, 0)
 
 
 def paired_metric_ratios(pairs, metric):
@@ -16,6 +16,7 @@ import time
 PAYLOADS = (512, 4096, 32768)
 TARGET_BYTES = 8 * 1024 * 1024
 MIN_DA_MESSAGES = 12288
+COMPRESSION = ("none", "zstd")
 
 
 def parse_args():
@@ -35,6 +36,8 @@ def parse_args():
     parser.add_argument("--mode", action="append", choices=("segmented", "da"))
     parser.add_argument("--target-bytes", type=int, default=TARGET_BYTES)
     parser.add_argument("--batch-size", type=int, default=1024)
+    parser.add_argument("--compression", choices=COMPRESSION, default="none")
+    parser.add_argument("--pair-compression", choices=COMPRESSION, default="none")
     parser.add_argument("--session", default=time.strftime("%Y%m%dT%H%M%SZ", time.gmtime()))
     parser.add_argument("--strace-summary", action="store_true")
     parser.add_argument("--resume", action="store_true")
@@ -134,10 +137,11 @@ def build_metadata(build_dir):
     }
 
 
-def metadata(build_dir, label, session):
+def metadata(build_dir, label, session, compression):
     result = {
         "label": label,
         "session": session,
+        "compression": compression,
         "revision": git_value(build_dir, "rev-parse", "HEAD"),
         "dirty": bool(git_value(build_dir, "status", "--porcelain")),
         "source_fingerprint": source_fingerprint(build_dir),
@@ -171,7 +175,7 @@ def parse_strace_summary(text):
     return calls
 
 
-def run_trial(script, build_dir, workload, trial_index, measured, strace_summary, artifact_dir):
+def run_trial(script, build_dir, compression, workload, trial_index, measured, strace_summary, artifact_dir):
     metric_file = artifact_dir / ("metrics-%s-%s-%s-%d.json" % (
         workload["scenario"], workload["mode"], workload["payload_bytes"], trial_index))
     strace_file = artifact_dir / ("strace-%s-%s-%s-%d.txt" % (
@@ -188,6 +192,7 @@ def run_trial(script, build_dir, workload, trial_index, measured, strace_summary
         "BENCH_SYNC_FILES": "on" if workload["sync_files"] else "off",
         "BENCH_BATCH_SIZE": str(workload["batch_size"]),
         "BENCH_SEGMENT_BYTES": str(workload["segment_bytes"]),
+        "BENCH_COMPRESSION": compression,
         "BENCH_METRIC_FILE": str(metric_file),
         "BENCH_STRACE_FILE": str(strace_file) if strace_summary else "",
         "TEST_MAX_RUNTIME": "900",
@@ -235,7 +240,7 @@ def load_resume(path, meta, enabled):
     with path.open(encoding="utf-8") as stream:
         previous = json.load(stream)
     for field in ("revision", "source_fingerprint", "pair_revision", "pair_source_fingerprint",
-                  "label", "session"):
+                  "label", "session", "compression"):
         if previous["metadata"].get(field) != meta.get(field):
             raise SystemExit("cannot resume: %s metadata changed for %s" % (field, path))
     return previous["records"]
@@ -263,8 +268,8 @@ def main():
         verify_build(pair_dir)
     artifact_root = primary_output.parent / "artifacts" / args.session
     artifact_root.mkdir(parents=True, exist_ok=True)
-    primary_meta = metadata(primary_dir, args.label, args.session)
-    pair_meta = metadata(pair_dir, args.pair_label, args.session) if pair_dir else None
+    primary_meta = metadata(primary_dir, args.label, args.session, args.compression)
+    pair_meta = metadata(pair_dir, args.pair_label, args.session, args.pair_compression) if pair_dir else None
     if pair_meta:
         primary_meta.update({
             "pair_revision": pair_meta["revision"],
@@ -284,13 +289,16 @@ def main():
                            workload["batch_size"], workload["segment_bytes"])
         workload_started = any(item[:5] == workload_prefix for item in primary_completed | pair_completed)
         if not workload_started:
+            sides = ((primary_dir, args.compression), (pair_dir, args.pair_compression))
             for calibration in range(args.calibration):
-                for build_dir in (primary_dir, pair_dir) if pair_dir else (primary_dir,):
-                    run_trial(trial_script, build_dir, workload, -(calibration + 1), False, False,
+                for build_dir, compression in sides if pair_dir else sides[:1]:
+                    run_trial(trial_script, build_dir, compression, workload, -(calibration + 1), False, False,
                               Path(tempfile.mkdtemp(prefix="calibration-", dir=artifact_root)))
         for trial in range(args.trials):
             order = ((primary_dir, primary_records, primary_completed, primary_output, primary_meta),
                      (pair_dir, pair_records, pair_completed, pair_output, pair_meta))
+            # Both sides may use the same build with different queue.compression
+            # settings, so the side is told apart by its position, not its path.
             if pair_dir and trial % 2:
                 order = tuple(reversed(order))
             for build_dir, destination, completed, output, meta in order:
@@ -299,9 +307,9 @@ def main():
                 trial_key = workload_prefix + (trial,)
                 if trial_key in completed:
                     continue
-                per_build = artifact_root / ("primary" if build_dir == primary_dir else "pair")
+                per_build = artifact_root / ("primary" if meta is primary_meta else "pair")
                 per_build.mkdir(parents=True, exist_ok=True)
-                destination.append(run_trial(trial_script, build_dir, workload, trial, True,
+                destination.append(run_trial(trial_script, build_dir, meta["compression"], workload, trial, True,
                                              args.strace_summary and trial == 0, per_build))
                 completed.add(trial_key)
                 write_result(output, meta, destination)
@@ -54,6 +54,12 @@ def main():
     ]
     check(compare.paired_metric_ratios(metric_pairs, "spill_ns") == [(7, 2.0)],
           "filtered metric ratio lost its original trial ID")
+    # Records written before disk usage was measured must not break a comparison.
+    check(compare.paired_metric_ratios(metric_pairs, "disk_bytes_at_spill") == [],
+          "missing metric was not skipped")
+    disk_pairs = [({"trial": 0, "disk_bytes_at_spill": 900}, {"trial": 0, "disk_bytes_at_spill": 300})]
+    check(compare.paired_metric_ratios(disk_pairs, "disk_bytes_at_spill") == [(0, 3.0)],
+          "disk usage ratio changed direction")
 
     matching = (
         {"metadata": {"session": "session-a", "revision": "base", "source_fingerprint": "base-fp",
@@ -9,6 +9,7 @@
 : "${BENCH_BATCH_SIZE:?}"
 : "${BENCH_SEGMENT_BYTES:?}"
 : "${BENCH_METRIC_FILE:?}"
+: "${BENCH_COMPRESSION:=none}"
 
 cd "$BENCH_BUILD_DIR/tests" || exit 1
 export srcdir="$BENCH_BUILD_DIR/tests"
@@ -54,18 +55,23 @@ global(workDirectory="'"$SPOOL_DIR"'")
 input(type="imtcp" address="127.0.0.1" port="0" listenPortFileName="'"$INPUT_PORT_FILE"'" workerthreads="4")
 '
 worker_minimum=1024
+# builds without queue.compression must keep accepting the baseline config
+compression_param=
+[ "$BENCH_COMPRESSION" = none ] || compression_param='queue.compression="'"$BENCH_COMPRESSION"'"'
 if [ "$BENCH_MODE" = segmented ]; then
 	add_conf 'main_queue(queue.type="segmentedDisk" queue.filename="mainq"
 	queue.maxFileSize="'"$BENCH_SEGMENT_BYTES"'" queue.maxDiskSpace="2g" queue.dequeueBatchSize="'"$BENCH_BATCH_SIZE"'"
 	queue.workerThreadMinimumMessages="'"$worker_minimum"'"
-	queue.checkpointInterval="0" queue.syncQueueFiles="'"$BENCH_SYNC_FILES"'" queue.saveOnShutdown="on")'
+	queue.checkpointInterval="0" queue.syncQueueFiles="'"$BENCH_SYNC_FILES"'" queue.saveOnShutdown="on"
+	'"$compression_param"')'
 else
 	add_conf 'main_queue(queue.type="LinkedList" queue.filename="mainq"
 	queue.size="8192" queue.highWatermark="1024" queue.lowWatermark="256" queue.fullDelayMark="8192"
 	queue.maxFileSize="'"$BENCH_SEGMENT_BYTES"'" queue.maxDiskSpace="2g" queue.workerThreads="4"
 	queue.workerThreadMinimumMessages="'"$worker_minimum"'" queue.dequeueBatchSize="'"$BENCH_BATCH_SIZE"'" queue.timeoutEnqueue="300000"
 	queue.diskQueueType="segmentedDisk" queue.diskQueueIdleTimeout="-1"
-	queue.checkpointInterval="0" queue.syncQueueFiles="'"$BENCH_SYNC_FILES"'" queue.saveOnShutdown="on")'
+	queue.checkpointInterval="0" queue.syncQueueFiles="'"$BENCH_SYNC_FILES"'" queue.saveOnShutdown="on"
+	'"$compression_param"')'
 fi
 add_conf '
 	template(name="benchFormat" type="string" string="%msg%\n")
@@ -147,6 +153,9 @@ fi
 t_spilled=$(now_ns)
 segments_at_spill=$(find "$SPOOL_DIR/mainq.segq" -maxdepth 1 -type f \
 	\( -name '*.seg' -o -name '*.open' -o -name '*.recover' \) 2>/dev/null | wc -l)
+disk_bytes_at_spill=$(find "$SPOOL_DIR/mainq.segq" -maxdepth 1 -type f \
+	\( -name '*.seg' -o -name '*.open' -o -name '*.recover' \) -printf '%s\n' 2>/dev/null |
+	awk '{ sum += $1 } END { print sum + 0 }')
 
 restart_ns=0
 t_drain_start=$(now_ns)
@@ -164,13 +173,13 @@ cut -d: -f2 "$RECEIVER_FILE" >"$RSYSLOG_OUT_LOG"
 export NUMMESSAGES="$BENCH_MESSAGES"
 seq_check 0 $((BENCH_MESSAGES - 1))
 mkdir -p "$(dirname "$BENCH_METRIC_FILE")"
-printf '{"scenario":"%s","mode":"%s","payload_bytes":%d,"batch_size":%d,"segment_bytes":%d,"messages":%d,"bytes":%d,"input_submitted_at_spill":%d,"enqueued_at_spill":%d,"child_enqueued_at_spill":%d,"backlog_at_spill":%d,"startup_ns":%d,"spill_ns":%d,"restart_ns":%d,"drain_ns":%d,"shutdown_ns":%d,"end_to_end_ns":%d,"segments_observed":%d}\n' \
+printf '{"scenario":"%s","mode":"%s","payload_bytes":%d,"batch_size":%d,"segment_bytes":%d,"messages":%d,"bytes":%d,"input_submitted_at_spill":%d,"enqueued_at_spill":%d,"child_enqueued_at_spill":%d,"backlog_at_spill":%d,"startup_ns":%d,"spill_ns":%d,"restart_ns":%d,"drain_ns":%d,"shutdown_ns":%d,"end_to_end_ns":%d,"segments_observed":%d,"compression":"%s","disk_bytes_at_spill":%d}\n' \
 	"$BENCH_SCENARIO" "$BENCH_MODE" "$BENCH_PAYLOAD_BYTES" "$BENCH_BATCH_SIZE" "$BENCH_SEGMENT_BYTES" \
 	"$BENCH_MESSAGES" "$((BENCH_PAYLOAD_BYTES * BENCH_MESSAGES))" "$input_submitted" "$enqueued" \
 	"$child_enqueued" "$backlog" \
 	"$((t_started - t0))" \
 	"$((t_spilled - t_started))" \
 	"$restart_ns" "$((t_drained - t_drain_start))" "$((t_end - t_drained))" "$((t_end - t0))" \
-	"$segments_at_spill" \
+	"$segments_at_spill" "$BENCH_COMPRESSION" "$disk_bytes_at_spill" \
 	>"$BENCH_METRIC_FILE"
 exit_test
@@ -0,0 +1,103 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file counterbench.c
+ * @brief Update throughput of a shared versus a sharded stats counter.
+ *
+ * Usage: counterbench shared|sharded <threads> <updates per thread>
+ *
+ * All threads start together and increment the same counter the way
+ * STATSCOUNTER_INC and STATSCOUNTER_SHARDED_INC do. Prints one JSON object
+ * with the elapsed time; exits non-zero if the final value is not exact.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "../../runtime/statsctr.c"
+
+static int bSharded;
+static long nUpdates;
+static pthread_barrier_t barrier;
+static shardedctr_t ctrSharded;
+static struct {
+    uint64 value;
+    char pad[STATSCTR_CACHELINE - sizeof(uint64)];
+} ctrShared;
+DEF_ATOMIC_HELPER_MUT64(mutCtr);
+
+static void *updater(void __attribute__((unused)) * arg) {
+    if (bSharded) statsctrThreadIdx(); /* assign the index outside the timed loop */
+    pthread_barrier_wait(&barrier);
+    if (bSharded) {
+        for (long i = 0; i < nUpdates; ++i) ATOMIC_INC_uint64_RELAXED(statsctrShardedSlot(&ctrSharded), &mutCtr);
+    } else {
+        for (long i = 0; i < nUpdates; ++i) ATOMIC_INC_uint64_RELAXED(&ctrShared.value, &mutCtr);
+    }
+    return NULL;
+}
+
+static uint64 nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64)ts.tv_sec * 1000000000u + (uint64)ts.tv_nsec;
+}
+
+int main(int argc, char *argv[]) {
+    pthread_t *threads;
+    uint64 start, elapsed, total;
+    int nThreads;
+
+    if (argc != 4 || (strcmp(argv[1], "shared") && strcmp(argv[1], "sharded"))) {
+        fprintf(stderr, "usage: %s shared|sharded <threads> <updates per thread>\n", argv[0]);
+        return 2;
+    }
+    bSharded = !strcmp(argv[1], "sharded");
+    nThreads = atoi(argv[2]);
+    nUpdates = atol(argv[3]);
+    if (nThreads < 1 || nUpdates < 1) {
+        fprintf(stderr, "thread and update counts must be positive\n");
+        return 2;
+    }
+    INIT_ATOMIC_HELPER_MUT64(mutCtr);
+    statsctrShardedInit(&ctrSharded);
+    if ((threads = calloc(nThreads, sizeof(*threads))) == NULL) return 1;
+    pthread_barrier_init(&barrier, NULL, nThreads + 1);
+    for (int i = 0; i < nThreads; ++i) {
+        if (pthread_create(&threads[i], NULL, updater, NULL) != 0) {
+            perror("pthread_create");
+            return 1;
+        }
+    }
+    pthread_barrier_wait(&barrier);
+    start = nowNs();
+    for (int i = 0; i < nThreads; ++i) pthread_join(threads[i], NULL);
+    elapsed = nowNs() - start;
+
+    total = bSharded ? statsctrShardedGet(&ctrSharded) : ctrShared.value;
+    if (total != (uint64)nThreads * (uint64)nUpdates) {
+        fprintf(stderr, "lost updates: counted %llu, expected %llu\n", total, (uint64)nThreads * (uint64)nUpdates);
+        return 1;
+    }
+    printf("{\"counter\":\"%s\",\"threads\":%d,\"updates\":%llu,\"shards\":%u,\"elapsed_ns\":%llu,"
+           "\"updates_per_second\":%.3f}\n",
+           argv[1], nThreads, total, bSharded ? ctrSharded.mask + 1 : 1, elapsed,
+           (double)total * 1e9 / (double)(elapsed ? elapsed : 1));
+    statsctrShardedDestruct(&ctrSharded);
+    free(threads);
+    return 0;
+}
@@ -0,0 +1,3 @@
+#!/bin/sh
+# Run reproducible statistics counter scaling benchmarks.
+exec "$(dirname "$0")/runner.py" "$@"
@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""Run alternating statistics counter benchmark trials over thread counts."""
+
+import argparse
+import json
+import os
+from pathlib import Path
+import platform
+import shlex
+import statistics
+import subprocess
+import tempfile
+
+COUNTERS = ("shared", "sharded")
+
+
+def arguments():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--build-dir", required=True)
+    parser.add_argument("--output", required=True)
+    parser.add_argument("--threads", default="1,2,4,8,16,32,64")
+    parser.add_argument("--updates", type=int, default=10000000)
+    parser.add_argument("--trials", type=int, default=7)
+    parser.add_argument("--calibration", type=int, default=1)
+    args = parser.parse_args()
+    try:
+        args.threads = [int(item) for item in args.threads.split(",")]
+    except ValueError:
+        parser.error("threads must be a comma-separated list of integers")
+    if min(args.threads + [args.updates, args.trials]) < 1:
+        parser.error("numeric arguments must be positive")
+    if args.calibration < 0:
+        parser.error("calibration must not be negative")
+    return args
+
+
+def makefile_variable(build, name):
+    makefile = build / "Makefile"
+    if makefile.exists():
+        for line in makefile.read_text(encoding="utf-8", errors="replace").splitlines():
+            if line.startswith(name + " = "):
+                return line[len(name) + 3:].strip()
+    return None
+
+
+def build_metadata(build):
+    compiler = makefile_variable(build, "CC") or "unknown"
+    try:
+        compiler_version = subprocess.check_output(
+            shlex.split(compiler) + ["--version"], text=True, stderr=subprocess.STDOUT).splitlines()[0]
+    except (OSError, subprocess.CalledProcessError):
+        compiler_version = "unavailable"
+    try:
+        configure = subprocess.check_output(
+            [str(build / "config.status"), "--config"], text=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        configure = "unavailable"
+    revision = subprocess.check_output(["git", "-C", str(build), "rev-parse", "HEAD"], text=True).strip()
+    return {"revision": revision, "compiler": compiler,
+            "compiler_version": compiler_version, "configure": configure}
+
+
+def compile_driver(build, binary):
+    """Build the driver with the compiler, flags and config.h of the configured tree."""
+    source = Path(__file__).with_name("counterbench.c").resolve()
+    srcdir = Path(makefile_variable(build, "abs_top_srcdir") or build)
+    command = (shlex.split(makefile_variable(build, "CC") or "cc") +
+               shlex.split(makefile_variable(build, "CFLAGS") or "-O2") +
+               ["-I%s" % build, "-I%s" % (srcdir / "runtime"), "-pthread", "-o", str(binary), str(source)])
+    subprocess.run(command, check=True)
+
+
+def run_trial(binary, counter, threads, updates, index, measured):
+    value = json.loads(subprocess.check_output([str(binary), counter, str(threads), str(updates)], text=True))
+    value.update({"index": index, "measured": measured})
+    return value
+
+
+def main():
+    args = arguments()
+    build = Path(args.build_dir).resolve()
+    output = Path(args.output).resolve()
+    results = {(counter, threads): [] for counter in COUNTERS for threads in args.threads}
+    with tempfile.TemporaryDirectory(prefix="rsyslog-stats-counters-bench-") as directory:
+        binary = Path(directory) / "counterbench"
+        compile_driver(build, binary)
+        for threads in args.threads:
+            for index in range(args.calibration + args.trials):
+                order = COUNTERS if index % 2 == 0 else tuple(reversed(COUNTERS))
+                for counter in order:
+                    results[(counter, threads)].append(
+                        run_trial(binary, counter, threads, args.updates, index, index >= args.calibration))
+    series = []
+    for (counter, threads), trials in results.items():
+        measured = [item for item in trials if item["measured"]]
+        series.append({"counter": counter, "threads": threads, "shards": trials[0]["shards"], "trials": trials,
+                       "median_updates_per_second": statistics.median(
+                           item["updates_per_second"] for item in measured)})
+    document = {"schema": 1, **build_metadata(build),
+                "system": {"platform": platform.platform(), "machine": platform.machine(),
+                           "processor": platform.processor(), "cpus": os.cpu_count(),
+                           "python": platform.python_version()},
+                "updates_per_thread": args.updates,
+                "host_exclusive": False, "cache_state": "uncontrolled",
+                "series": series}
+    output.parent.mkdir(parents=True, exist_ok=True)
+    output.write_text(json.dumps(document, indent=2) + "\n", encoding="utf-8")
+
+
+if __name__ == "__main__":
+    main()
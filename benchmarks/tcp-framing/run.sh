@@ -0,0 +1,3 @@
+#!/bin/sh
+# Run reproducible TCP framing benchmarks.
+exec "$(dirname "$0")/runner.py" "$@"
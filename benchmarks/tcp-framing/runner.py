@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""Run paired, alternating TCP framing replay benchmark trials."""
+
+import argparse
+import json
+import os
+from pathlib import Path
+import platform
+import random
+import shlex
+import statistics
+import subprocess
+import tempfile
+
+
+def arguments():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--build-dir", required=True)
+    parser.add_argument("--label", required=True)
+    parser.add_argument("--output", required=True)
+    parser.add_argument("--pair-build-dir")
+    parser.add_argument("--pair-label")
+    parser.add_argument("--pair-output")
+    parser.add_argument("--capture")
+    parser.add_argument("--synthetic-frames", type=int, default=200000)
+    parser.add_argument("--payload", type=int, default=300)
+    parser.add_argument("--cycles", type=int, default=5)
+    parser.add_argument("--trials", type=int, default=11)
+    parser.add_argument("--calibration", type=int, default=1)
+    args = parser.parse_args()
+    paired = (args.pair_build_dir, args.pair_label, args.pair_output)
+    if any(paired) and not all(paired):
+        parser.error("pair mode requires all pair arguments")
+    if args.pair_label == args.label:
+        parser.error("pair labels must be distinct")
+    if min(args.synthetic_frames, args.payload, args.cycles, args.trials) < 1:
+        parser.error("numeric arguments must be positive")
+    if args.calibration < 0:
+        parser.error("calibration must not be negative")
+    return args
+
+
+def count_frames(data):
+    """Count frames with the same rules imtcp applies to a fresh session."""
+    frames = 0
+    pos = 0
+    while pos < len(data):
+        if data[pos:pos + 1].isdigit():
+            space = data.index(b" ", pos)
+            pos = space + 1 + int(data[pos:space])
+        else:
+            end = data.find(b"\n", pos)
+            pos = len(data) if end < 0 else end + 1
+        frames += 1
+    return frames
+
+
+def synthesize_capture(path, frames, payload):
+    rng = random.Random(4711)
+    with path.open("wb") as capture:
+        for number in range(frames):
+            body = ("<%d>Oct 17 12:00:00 host%d app[%d]: msgnum:%08d:%s" %
+                    (rng.randrange(192), number % 97, number % 4096, number,
+                     "x" * rng.randrange(payload // 2, payload + 1))).encode("ascii")
+            if number % 3 == 0:
+                capture.write(b"%d %s" % (len(body), body))
+            else:
+                capture.write(body + b"\n")
+
+
+def build_metadata(build):
+    makefile = build / "Makefile"
+    compiler = "unknown"
+    if makefile.exists():
+        for line in makefile.read_text(encoding="utf-8", errors="replace").splitlines():
+            if line.startswith("CC = "):
+                compiler = line[5:].strip()
+                break
+    try:
+        compiler_version = subprocess.check_output(
+            shlex.split(compiler) + ["--version"], text=True, stderr=subprocess.STDOUT).splitlines()[0]
+    except (OSError, subprocess.CalledProcessError):
+        compiler_version = "unavailable"
+    try:
+        configure = subprocess.check_output(
+            [str(build / "config.status"), "--config"], text=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        configure = "unavailable"
+    revision = subprocess.check_output(["git", "-C", str(build), "rev-parse", "HEAD"], text=True).strip()
+    return {"revision": revision, "compiler": compiler,
+            "compiler_version": compiler_version, "configure": configure}
+
+
+def run_trial(script, build, capture, frames, cycles, index, measured, artifacts):
+    metric = artifacts / ("metric-%s-%d.json" % (build.name, index))
+    env = os.environ.copy()
+    env.update({"BENCH_BUILD_DIR": str(build), "BENCH_METRIC_FILE": str(metric),
+                "BENCH_CAPTURE": str(capture), "BENCH_FRAMES": str(frames),
+                "BENCH_CYCLES": str(cycles)})
+    subprocess.run([str(script)], env=env, check=True)
+    value = json.loads(metric.read_text(encoding="utf-8"))
+    value.update({"index": index, "measured": measured})
+    return value
+
+
+def main():
+    args = arguments()
+    script = Path(__file__).with_name("trial.sh").resolve()
+    builds = [(Path(args.build_dir).resolve(), args.label, Path(args.output).resolve())]
+    if args.pair_build_dir:
+        builds.append((Path(args.pair_build_dir).resolve(), args.pair_label, Path(args.pair_output).resolve()))
+    results = {label: [] for _, label, _ in builds}
+    with tempfile.TemporaryDirectory(prefix="rsyslog-tcp-framing-bench-") as directory:
+        artifacts = Path(directory)
+        if args.capture:
+            capture = Path(args.capture).resolve()
+            source = "recorded"
+        else:
+            capture = artifacts / "synthetic.bin"
+            synthesize_capture(capture, args.synthetic_frames, args.payload)
+            source = "synthetic"
+        frames = count_frames(capture.read_bytes())
+        total = args.calibration + args.trials
+        for index in range(total):
+            order = builds if index % 2 == 0 else list(reversed(builds))
+            for build, label, _ in order:
+                results[label].append(run_trial(script, build, capture, frames, args.cycles, index,
+                                                index >= args.calibration, artifacts))
+        capture_bytes = capture.stat().st_size
+    for build, label, output in builds:
+        measured = [item for item in results[label] if item["measured"]]
+        document = {"schema": 1, "label": label, **build_metadata(build),
+                    "system": {"platform": platform.platform(), "machine": platform.machine(),
+                               "processor": platform.processor(),
+                               "python": platform.python_version()},
+                    "capture": {"source": source, "bytes": capture_bytes, "frames": frames},
+                    "host_exclusive": False, "cache_state": "uncontrolled",
+                    "trials": results[label],
+                    "median_messages_per_second": statistics.median(
+                        item["messages_per_second"] for item in measured),
+                    "median_megabytes_per_second": statistics.median(
+                        item["megabytes_per_second"] for item in measured)}
+        output.parent.mkdir(parents=True, exist_ok=True)
+        output.write_text(json.dumps(document, indent=2) + "\n", encoding="utf-8")
+
+
+if __name__ == "__main__":
+    main()
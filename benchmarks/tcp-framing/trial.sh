@@ -0,0 +1,37 @@
+#!/bin/bash
+# Replay one capture through imtcp and validate the delivered message count.
+: "${BENCH_BUILD_DIR:?}" "${BENCH_CAPTURE:?}" "${BENCH_FRAMES:?}"
+: "${BENCH_CYCLES:?}" "${BENCH_METRIC_FILE:?}"
+
+cd "$BENCH_BUILD_DIR/tests" || exit 1
+export srcdir="$BENCH_BUILD_DIR/tests"
+. "$srcdir/diag.sh" init
+
+PORT_FILE="$PWD/${RSYSLOG_DYNNAME}.input.port"
+generate_conf
+add_conf '
+global(maxMessageSize="64k")
+main_queue(queue.workerThreads="1")
+module(load="../plugins/imtcp/.libs/imtcp")
+input(type="imtcp" address="127.0.0.1" port="0" listenPortFileName="'"$PORT_FILE"'")
+template(name="benchOut" type="string" string="x\n")
+action(type="omfile" file="'"$RSYSLOG_OUT_LOG"'" template="benchOut")
+'
+
+startup
+assign_file_content INPUT_PORT "$PORT_FILE"
+expected=$((BENCH_FRAMES * BENCH_CYCLES))
+start_ns=$(date +%s%N)
+tcpflood -p"$INPUT_PORT" -B -I "$BENCH_CAPTURE" -C"$BENCH_CYCLES" >/dev/null
+end_ns=$(date +%s%N)
+wait_file_lines "$RSYSLOG_OUT_LOG" "$expected" 300
+shutdown_when_empty
+wait_shutdown
+bytes=$(($(stat -c %s "$BENCH_CAPTURE") * BENCH_CYCLES))
+mkdir -p "$(dirname "$BENCH_METRIC_FILE")"
+printf '{"frames":%d,"cycles":%d,"bytes":%d,"elapsed_ns":%d,"messages_per_second":%.3f,"megabytes_per_second":%.3f}\n' \
+	"$BENCH_FRAMES" "$BENCH_CYCLES" "$bytes" "$((end_ns-start_ns))" \
+	"$(awk -v n="$expected" -v t="$((end_ns-start_ns))" 'BEGIN { print n * 1000000000 / t }')" \
+	"$(awk -v n="$bytes" -v t="$((end_ns-start_ns))" 'BEGIN { print n * 1000 / t }')" \
+	>"$BENCH_METRIC_FILE"
+exit_test
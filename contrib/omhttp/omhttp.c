@@ -66,6 +66,7 @@
 #include "ratelimit.h"
 #include "ruleset.h"
 #include "statsobj.h"
+#include "httppipe.h"
 
 #ifndef O_LARGEFILE
     #define O_LARGEFILE 0
@@ -77,7 +78,7 @@ MODULE_CNFNAME("omhttp")
 
 /* internal structures */
 DEF_OMOD_STATIC_DATA;
-DEFobjCurrIf(prop) DEFobjCurrIf(ruleset) DEFobjCurrIf(statsobj)
+DEFobjCurrIf(prop) DEFobjCurrIf(ruleset) DEFobjCurrIf(statsobj) DEFobjCurrIf(httppipe)
 
 
     typedef struct _targetStats {
@@ -137,6 +138,7 @@ static uchar template_StdSplkRaw[] = "\"%rawmsg:::drop-last-lf%\n\"";
 #define DEFAULT_MAX_BATCH_BYTES (10 * 1024 * 1024) /* 10 MB - default max message size for AWS API Gateway */
 #define DEFAULT_REPLY_MAX_BYTES (1024 * 1024) /* 1 MB - default max response size */
 #define SPLUNK_HEC_MAX_BATCH_BYTES (1024 * 1024) /* 1 MB - Splunk HEC recommended limit */
+#define MAX_PIPELINE_INFLIGHT 256 /* upper bound for pipeline.maxinflight */
 typedef enum batchFormat_e { FMT_NEWLINE, FMT_JSONARRAY, FMT_KAFKAREST, FMT_LOKIREST } batchFormat_t;
 typedef enum vendor_e { LOKI, SPLUNK } vendor_t;
 
@@ -179,6 +181,7 @@ typedef struct instanceConf_s {
     size_t maxBatchBytes;
     size_t maxBatchSize;
     size_t replyMaxBytes;
+    int pipelineMaxInFlight; /* max concurrent requests per worker, 1 = sequential curl_easy_perform() */
     sbool compress;
     int compressionLevel; /* Compression level for zlib, default=-1, fastest=1, best=9, none=0*/
     sbool useHttps;
@@ -239,6 +242,25 @@ typedef struct serverData_s {
     sbool gzipHeaderEnabled; /* Track whether the cached header includes gzip encoding */
 } serverData_t;
 
+/*
+ * One request of the pipelined transport (pipeline.maxinflight > 1). The
+ * slot keeps everything checkResult() needs once the response arrives, as
+ * by then the worker has already moved on to the next batch.
+ */
+typedef struct pipelineSlot_s {
+    instanceData *pData;
+    int serverIndex; /* server the request was sent to */
+    uchar *reqmsg; /* uncompressed request body, for error file and retries */
+    sbool bOwnReqmsg; /* reqmsg is a serialized batch we must free */
+    char *postData; /* private copy of the compressed body, NULL if reqmsg is sent */
+    uchar **msgs; /* batch members, point into the transaction's params */
+    size_t nmemb;
+    char *reply;
+    size_t replyLen;
+    size_t replyBufLen;
+    char errbuf[CURL_ERROR_SIZE];
+} pipelineSlot_t;
+
 typedef struct wrkrInstanceData {
     PTR_ASSERT_DEF
     instanceData *pData;
@@ -262,6 +284,11 @@ typedef struct wrkrInstanceData {
         size_t len;
     } compressCtx;
     serverData_t **listServerDataWkr;
+    struct {
+        httppipe_t *pipe; /* drives the slots' transfers */
+        pipelineSlot_t *slots; /* our per-request state, indexed like the pipe's slots */
+        int nSlots; /* 0 if pipelining is off */
+    } pipeline;
 
 } wrkrInstanceData_t;
 
@@ -289,6 +316,7 @@ static struct cnfparamdescr actpdescr[] = {
     {"batch.maxbytes", eCmdHdlrSize, 0},
     {"batch.maxsize", eCmdHdlrSize, 0},
     {"replymaxbytes", eCmdHdlrSize, 0},
+    {"pipeline.maxinflight", eCmdHdlrPositiveInt, 0},
     {"compress", eCmdHdlrBinary, 0},
     {"compress.level", eCmdHdlrInt, 0},
     {"usehttps", eCmdHdlrBinary, 0},
@@ -325,6 +353,8 @@ static void ATTR_NONNULL(1) markServerSuspended(instanceData *pData, int serverI
 static void ATTR_NONNULL(1) markServerFailed(instanceData *pData, int serverIdx, time_t now);
 static void ATTR_NONNULL(1) markServerRateLimited(instanceData *pData, int serverIdx, time_t now);
 static void ATTR_NONNULL(1) markServerAvailable(instanceData *pData, int serverIdx, time_t now);
+static void ATTR_NONNULL() pipelineCleanup(wrkrInstanceData_t *pWrkrData);
+static void ATTR_NONNULL() freePipelineSlots(wrkrInstanceData_t *pWrkrData);
 
 /* compressCtx functions */
 static void ATTR_NONNULL() initCompressCtx(wrkrInstanceData_t *pWrkrData);
@@ -400,11 +430,23 @@ BEGINcreateWrkrInstance
         pWrkrData->listServerDataWkr[i]->restPATH = NULL;
         pWrkrData->listServerDataWkr[i]->gzipHeaderEnabled = 0;
     }
+    pWrkrData->pipeline.pipe = NULL;
+    pWrkrData->pipeline.nSlots = 0;
+    if (pData->pipelineMaxInFlight > 1) {
+        const size_t nMsgs = pData->batchMode ? pData->maxBatchSize : 1;
+        CHKmalloc(pWrkrData->pipeline.slots = calloc((size_t)pData->pipelineMaxInFlight, sizeof(pipelineSlot_t)));
+        pWrkrData->pipeline.nSlots = pData->pipelineMaxInFlight;
+        for (i = 0; i < pWrkrData->pipeline.nSlots; i++) {
+            pWrkrData->pipeline.slots[i].pData = pData;
+            CHKmalloc(pWrkrData->pipeline.slots[i].msgs = malloc(nMsgs * sizeof(uchar *)));
+        }
+    }
     initCompressCtx(pWrkrData);
     iRet = curlSetup(pWrkrData);
 
 finalize_it:
     if (iRet != RS_RET_OK) {
+        freePipelineSlots(pWrkrData);
         freeWorkerServerData(pWrkrData);
         free(pWrkrData->listServerDataWkr);
         pWrkrData->listServerDataWkr = NULL;
@@ -469,6 +511,7 @@ ENDfreeInstance
 
 BEGINfreeWrkrInstance
     CODESTARTfreeWrkrInstance;
+    freePipelineSlots(pWrkrData);
     freeWorkerServerData(pWrkrData);
     free(pWrkrData->listServerDataWkr);
     pWrkrData->listServerDataWkr = NULL;
@@ -521,6 +564,7 @@ BEGINdbgPrintInstInfo
     dbgprintf("\tbatch.maxbytes=%zu\n", pData->maxBatchBytes);
     dbgprintf("\tbatch.maxsize=%zu\n", pData->maxBatchSize);
     dbgprintf("\treplymaxbytes=%zu\n", pData->replyMaxBytes);
+    dbgprintf("\tpipeline.maxinflight=%d\n", pData->pipelineMaxInFlight);
     dbgprintf("\tcompress=%d\n", pData->compress);
     dbgprintf("\tcompress.level=%d\n", pData->compressionLevel);
     dbgprintf("\tallowUnsignedCerts=%d\n", pData->allowUnsignedCerts);
@@ -546,68 +590,86 @@ BEGINdbgPrintInstInfo
 ENDdbgPrintInstInfo
 
 
-/* http POST result string ... useful for debugging */
-static size_t curlResult(void *ptr, size_t size, size_t nmemb, void *userdata) {
-    const char *const p = (const char *)ptr;
-    wrkrInstanceData_t *const pWrkrData = (wrkrInstanceData_t *)userdata;
+/* append a chunk of an http reply to a reply buffer, honoring replymaxbytes */
+static size_t appendReply(const instanceData *const pData,
+                          char **const reply,
+                          size_t *const replyLen,
+                          size_t *const replyBufLen,
+                          const char *const p,
+                          const size_t size,
+                          const size_t nmemb) {
     char *buf;
     size_t size_add;
     size_t newlen;
 
-    PTR_ASSERT_CHK(pWrkrData, WRKR_DATA_TYPE_ES);
     if (nmemb != 0 && size > SIZE_MAX / nmemb) {
         LogError(0, RS_RET_ERR, "omhttp: reply buffer size overflow in curlResult");
-        pWrkrData->replyLen = 0;
-        if (pWrkrData->reply != NULL && pWrkrData->replyBufLen > 0) {
-            pWrkrData->reply[0] = '\0';
+        *replyLen = 0;
+        if (*reply != NULL && *replyBufLen > 0) {
+            (*reply)[0] = '\0';
         }
         return 0;
     }
     size_add = size * nmemb;
-    if (size_add > SIZE_MAX - pWrkrData->replyLen) {
+    if (size_add > SIZE_MAX - *replyLen) {
         LogError(0, RS_RET_ERR, "omhttp: reply buffer size overflow in curlResult");
-        pWrkrData->replyLen = 0;
-        if (pWrkrData->reply != NULL && pWrkrData->replyBufLen > 0) {
-            pWrkrData->reply[0] = '\0';
+        *replyLen = 0;
+        if (*reply != NULL && *replyBufLen > 0) {
+            (*reply)[0] = '\0';
         }
         return 0;
     }
-    newlen = pWrkrData->replyLen + size_add;
+    newlen = *replyLen + size_add;
     if (newlen == SIZE_MAX) {
         LogError(0, RS_RET_ERR, "omhttp: reply buffer size overflow in curlResult");
-        pWrkrData->replyLen = 0;
-        if (pWrkrData->reply != NULL && pWrkrData->replyBufLen > 0) {
-            pWrkrData->reply[0] = '\0';
+        *replyLen = 0;
+        if (*reply != NULL && *replyBufLen > 0) {
+            (*reply)[0] = '\0';
         }
         return 0;
     }
-    if (pWrkrData->pData->replyMaxBytes > 0 && newlen > pWrkrData->pData->replyMaxBytes) {
-        LogError(0, RS_RET_ERR, "omhttp: reply buffer exceeds replymaxbytes limit (%zu)",
-                 pWrkrData->pData->replyMaxBytes);
-        if (pWrkrData->reply != NULL && pWrkrData->replyBufLen > 0) {
-            pWrkrData->reply[pWrkrData->replyLen] = '\0';
+    if (pData->replyMaxBytes > 0 && newlen > pData->replyMaxBytes) {
+        LogError(0, RS_RET_ERR, "omhttp: reply buffer exceeds replymaxbytes limit (%zu)", pData->replyMaxBytes);
+        if (*reply != NULL && *replyBufLen > 0) {
+            (*reply)[*replyLen] = '\0';
         }
         return 0;
     }
-    if (newlen + 1 > pWrkrData->replyBufLen) {
-        if ((buf = realloc(pWrkrData->reply, newlen + 1)) == NULL) {
+    if (newlen + 1 > *replyBufLen) {
+        if ((buf = realloc(*reply, newlen + 1)) == NULL) {
             LogError(errno, RS_RET_ERR, "omhttp: realloc failed in curlResult");
-            if (pWrkrData->reply != NULL && pWrkrData->replyBufLen > 0) {
-                pWrkrData->reply[pWrkrData->replyLen] = '\0';
+            if (*reply != NULL && *replyBufLen > 0) {
+                (*reply)[*replyLen] = '\0';
             }
             return 0; /* abort due to failure */
         }
-        pWrkrData->replyBufLen = newlen + 1;
-        pWrkrData->reply = buf;
+        *replyBufLen = newlen + 1;
+        *reply = buf;
     }
-    memcpy(pWrkrData->reply + pWrkrData->replyLen, p, size_add);
-    pWrkrData->replyLen = newlen;
-    if (pWrkrData->replyBufLen > 0) {
-        pWrkrData->reply[pWrkrData->replyLen] = '\0';
+    memcpy(*reply + *replyLen, p, size_add);
+    *replyLen = newlen;
+    if (*replyBufLen > 0) {
+        (*reply)[*replyLen] = '\0';
     }
     return size_add;
 }
 
+/* http POST result string ... useful for debugging */
+static size_t curlResult(void *ptr, size_t size, size_t nmemb, void *userdata) {
+    wrkrInstanceData_t *const pWrkrData = (wrkrInstanceData_t *)userdata;
+
+    PTR_ASSERT_CHK(pWrkrData, WRKR_DATA_TYPE_ES);
+    return appendReply(pWrkrData->pData, &pWrkrData->reply, &pWrkrData->replyLen, &pWrkrData->replyBufLen,
+                       (const char *)ptr, size, nmemb);
+}
+
+/* same as curlResult, but for a request of the pipelined transport */
+static size_t pipelineResult(void *ptr, size_t size, size_t nmemb, void *userdata) {
+    pipelineSlot_t *const slot = (pipelineSlot_t *)userdata;
+
+    return appendReply(slot->pData, &slot->reply, &slot->replyLen, &slot->replyBufLen, (const char *)ptr, size, nmemb);
+}
+
 /* Build basic URL part, which includes hostname and port as follows:
  * http://hostname:port/ based on a server param
  * Newly creates a cstr for this purpose.
@@ -1105,7 +1167,8 @@ finalize_it:
     RETiRet;
 }
 
-static rsRetVal checkResult(wrkrInstanceData_t *pWrkrData, uchar *reqmsg) {
+/* evaluate the response of a request; handle is the curl handle that carried it */
+static rsRetVal checkResult(wrkrInstanceData_t *pWrkrData, CURL *const handle, uchar *reqmsg) {
     instanceData *pData;
     long statusCode;
     size_t numMessages;
@@ -1113,7 +1176,6 @@ static rsRetVal checkResult(wrkrInstanceData_t *pWrkrData, uchar *reqmsg) {
     DEFiRet;
     CURLcode resCurl = 0;
     int indexStats = 0;
-    serverData_t *serverData = pWrkrData->listServerDataWkr[pWrkrData->serverIndex];
 
     pData = pWrkrData->pData;
     statusCode = pWrkrData->httpStatusCode;
@@ -1185,11 +1247,11 @@ static rsRetVal checkResult(wrkrInstanceData_t *pWrkrData, uchar *reqmsg) {
         long req = 0;
         double total = 0;
         /* record total bytes */
-        resCurl = curl_easy_getinfo(serverData->curlPostHandle, CURLINFO_REQUEST_SIZE, &req);
+        resCurl = curl_easy_getinfo(handle, CURLINFO_REQUEST_SIZE, &req);
         if (!resCurl) {
             STATSCOUNTER_ADD(serverStats->httpRequestsBytes, serverStats->mutHttpRequestsBytes, (uint64_t)req);
         }
-        resCurl = curl_easy_getinfo(serverData->curlPostHandle, CURLINFO_TOTAL_TIME, &total);
+        resCurl = curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME, &total);
         if (CURLE_OK == resCurl) {
             /* this needs to be converted to milliseconds */
             long total_time_ms = (long)(total * 1000);
@@ -1596,7 +1658,7 @@ static rsRetVal ATTR_NONNULL(1, 2) curlPost(wrkrInstanceData_t *pWrkrData,
         // Check the result here too and retry if needed, then we should suspend
         // Usually in batch mode we clobber any iRet values, but probably not a great
         // idea to keep hitting a dead server. The http status code will be 0 at this point.
-        checkResult(pWrkrData, message);
+        checkResult(pWrkrData, curl, message);
         ABORT_FINALIZE(RS_RET_SUSPENDED);
     } else {
         STATSCOUNTER_INC(pWrkrData->pData->listObjStats[indexStats].ctrHttpRequestSuccess,
@@ -1616,7 +1678,7 @@ static rsRetVal ATTR_NONNULL(1, 2) curlPost(wrkrInstanceData_t *pWrkrData,
         }
         DBGPRINTF("omhttp: curlPost pWrkrData reply: '%s'\n", pWrkrData->reply);
     }
-    CHKiRet(checkResult(pWrkrData, message));
+    CHKiRet(checkResult(pWrkrData, curl, message));
 
 finalize_it:
     incrementServerIndex(pWrkrData);
@@ -1624,6 +1686,194 @@ finalize_it:
     RETiRet;
 }
 
+/* Pipelined transport (pipeline.maxinflight > 1)
+ *
+ * Instead of blocking in curl_easy_perform() for every POST, the requests a
+ * transaction is split into are handed to the shared httppipe object, which
+ * keeps up to pipeline.maxinflight of them on the wire at the same time (on
+ * separate connections, or multiplexed over one HTTP/2 connection if the
+ * server supports it). Responses are evaluated by checkResult() as they
+ * arrive. commitTransaction() only returns once all of them are in, and
+ * returns the first retriable failure. So the core still retries the whole
+ * transaction, exactly as with sequential requests.
+ */
+
+static void ATTR_NONNULL() pipelineReleaseSlot(pipelineSlot_t *const slot) {
+    if (slot->bOwnReqmsg) free(slot->reqmsg);
+    slot->reqmsg = NULL;
+    slot->bOwnReqmsg = 0;
+    free(slot->postData);
+    slot->postData = NULL;
+    slot->nmemb = 0;
+}
+
+/* httppipe done callback: evaluate a finished request, much like the tail of
+ * curlPost() does
+ */
+static rsRetVal pipelineComplete(void *const pUsr, const int iSlot, CURL *const handle, const CURLcode curlCode) {
+    wrkrInstanceData_t *const pWrkrData = (wrkrInstanceData_t *)pUsr;
+    pipelineSlot_t *const slot = &pWrkrData->pipeline.slots[iSlot];
+    instanceData *const pData = pWrkrData->pData;
+    const int indexStats = pData->statsBySenders ? slot->serverIndex : 0;
+    /* checkResult() and its helpers work on the worker's current request,
+     * so present this slot's request as such while it is evaluated.
+     */
+    const int serverIndex = pWrkrData->serverIndex;
+    uchar **const batchData = pWrkrData->batch.data;
+    const size_t batchNmemb = pWrkrData->batch.nmemb;
+    char *const reply = pWrkrData->reply;
+    const size_t replyLen = pWrkrData->replyLen;
+    const size_t replyBufLen = pWrkrData->replyBufLen;
+    rsRetVal localRet;
+
+    pWrkrData->serverIndex = slot->serverIndex;
+    pWrkrData->batch.data = slot->msgs;
+    pWrkrData->batch.nmemb = slot->nmemb;
+    pWrkrData->reply = slot->reply;
+    pWrkrData->replyLen = slot->replyLen;
+    pWrkrData->replyBufLen = slot->replyBufLen;
+    pWrkrData->httpStatusCode = 0;
+
+    DBGPRINTF("omhttp: pipelined request to server %d returned curl code %lld\n", slot->serverIndex,
+              (long long)curlCode);
+    STATSCOUNTER_INC(pData->listObjStats[indexStats].ctrHttpRequestsCount,
+                     pData->listObjStats[indexStats].mutCtrHttpRequestsCount);
+    if (curlCode != CURLE_OK) {
+        STATSCOUNTER_INC(pData->listObjStats[indexStats].ctrHttpRequestFail,
+                         pData->listObjStats[indexStats].mutCtrHttpRequestFail);
+        LogError(0, RS_RET_SUSPENDED, "omhttp: suspending ourselves due to server failure %lld: %s",
+                 (long long)curlCode, slot->errbuf[0] != '\0' ? slot->errbuf : curl_easy_strerror(curlCode));
+        markServerFailed(pData, slot->serverIndex, time(NULL));
+        checkResult(pWrkrData, handle, slot->reqmsg);
+        localRet = RS_RET_SUSPENDED;
+    } else {
+        STATSCOUNTER_INC(pData->listObjStats[indexStats].ctrHttpRequestSuccess,
+                         pData->listObjStats[indexStats].mutCtrHttpRequestSuccess);
+        curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &pWrkrData->httpStatusCode);
+        DBGPRINTF("omhttp: pipelined request reply: '%s'\n", slot->reply == NULL ? "" : slot->reply);
+        localRet = checkResult(pWrkrData, handle, slot->reqmsg);
+    }
+
+    pWrkrData->serverIndex = serverIndex;
+    pWrkrData->batch.data = batchData;
+    pWrkrData->batch.nmemb = batchNmemb;
+    pWrkrData->reply = reply;
+    pWrkrData->replyLen = replyLen;
+    pWrkrData->replyBufLen = replyBufLen;
+
+    if (localRet == RS_RET_DATAFAIL) {
+        DBGPRINTF("omhttp: permanent data failure for pipelined request, continuing transaction\n");
+        localRet = RS_RET_OK;
+    }
+    pipelineReleaseSlot(slot);
+    return localRet;
+}
+
+/* httppipe abandon callback: the request is retried with the transaction */
+static void pipelineAbandon(void *const pUsr, const int iSlot) {
+    wrkrInstanceData_t *const pWrkrData = (wrkrInstanceData_t *)pUsr;
+    pipelineReleaseSlot(&pWrkrData->pipeline.slots[iSlot]);
+}
+
+/* Start a POST on the pipeline, waiting for a free slot first. If bOwnMessage
+ * is set, the pipeline takes ownership of message (a serialized batch).
+ * Returns the first retriable failure of the transaction so far, if any, so
+ * that the caller stops producing further requests.
+ */
+static rsRetVal ATTR_NONNULL(1, 2) pipelinePost(wrkrInstanceData_t *const pWrkrData,
+                                                uchar *const message,
+                                                const size_t msglen,
+                                                uchar **const tpls,
+                                                const sbool bOwnMessage) {
+    instanceData *const pData = pWrkrData->pData;
+    httppipe_t *const pPipe = pWrkrData->pipeline.pipe;
+    pipelineSlot_t *slot;
+    serverData_t *serverData;
+    CURL *handle;
+    char *postCopy = NULL;
+    const char *postData;
+    size_t postLen;
+    sbool compressed = 0;
+    sbool bStarted = 0;
+    int iSlot;
+    DEFiRet;
+
+    PTR_ASSERT_SET_TYPE(pWrkrData, WRKR_DATA_TYPE_ES);
+
+    CHKiRet(httppipe.Wait(pPipe, pWrkrData->pipeline.nSlots));
+
+    if (pData->numServers > 1) {
+        /* needs to be called to support ES HA feature */
+        CHKiRet(checkConn(pWrkrData));
+    }
+    serverData = pWrkrData->listServerDataWkr[pWrkrData->serverIndex];
+
+    postData = (const char *)message;
+    postLen = msglen;
+    if (pData->compress) {
+        iRet = compressHttpPayload(pWrkrData, message, msglen);
+        if (iRet != RS_RET_OK) {
+            LogError(0, iRet, "omhttp: pipelinePost error while compressing, will default to uncompressed");
+            iRet = RS_RET_OK;
+        } else {
+            /* compressCtx is reused by the next request */
+            postLen = pWrkrData->compressCtx.curLen;
+            CHKmalloc(postCopy = malloc(postLen));
+            memcpy(postCopy, pWrkrData->compressCtx.buf, postLen);
+            postData = postCopy;
+            compressed = 1;
+        }
+    }
+    if (postLen > (size_t)LLONG_MAX) {
+        LogError(0, RS_RET_ERR, "omhttp: POST payload too large for libcurl (%zu bytes)", postLen);
+        ABORT_FINALIZE(RS_RET_ERR);
+    }
+
+    if (pData->dynRestPath || serverData->fullUrlPost == NULL) {
+        CHKiRet(setPostURL(pWrkrData, tpls));
+    }
+    if (serverData->curlHeader == NULL || serverData->gzipHeaderEnabled != compressed) {
+        /* requests in flight still use the current header list */
+        CHKiRet(httppipe.Wait(pPipe, 0));
+        CHKiRet(buildCurlHeaders(pWrkrData, serverData, &serverData->curlHeader, compressed));
+        curl_easy_setopt(serverData->curlPostHandle, CURLOPT_HTTPHEADER, serverData->curlHeader);
+    }
+
+    CHKiRet(httppipe.GetFreeSlot(pPipe, &iSlot));
+    slot = &pWrkrData->pipeline.slots[iSlot];
+    slot->serverIndex = pWrkrData->serverIndex;
+    slot->nmemb = 0;
+    if (pData->batchMode) {
+        memcpy(slot->msgs, pWrkrData->batch.data, pWrkrData->batch.nmemb * sizeof(uchar *));
+        slot->nmemb = pWrkrData->batch.nmemb;
+    }
+    slot->replyLen = 0;
+    if (slot->reply != NULL && slot->replyBufLen > 0) slot->reply[0] = '\0';
+    slot->errbuf[0] = '\0';
+
+    handle = httppipe.GetHandle(pPipe, iSlot);
+    curl_easy_setopt(handle, CURLOPT_URL, (char *)serverData->fullUrlPost);
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, serverData->curlHeader);
+    curl_easy_setopt(handle, CURLOPT_POSTFIELDS, postData);
+    curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)postLen);
+    CHKiRet(httppipe.Start(pPipe, iSlot));
+    slot->reqmsg = message;
+    slot->bOwnReqmsg = bOwnMessage;
+    slot->postData = postCopy;
+    postCopy = NULL;
+    bStarted = 1;
+    DBGPRINTF("omhttp: pipelinePost started request of %zu bytes\n", postLen);
+
+    /* get the request on the wire right away */
+    CHKiRet(httppipe.Wait(pPipe, pWrkrData->pipeline.nSlots));
+
+finalize_it:
+    if (!bStarted && bOwnMessage) free(message);
+    free(postCopy);
+    if (bStarted) incrementServerIndex(pWrkrData);
+    RETiRet;
+}
+
 /* Build a JSON batch that conforms to the Kafka Rest Proxy format.
  * See https://docs.confluent.io/current/kafka-rest/docs/quickstart.html for more info.
  * Want {"records": [{"value": "message1"}, {"value": "message2"}]}
@@ -1918,7 +2168,12 @@ static rsRetVal submitBatch(wrkrInstanceData_t *pWrkrData, uchar **tpls) {
 
     DBGPRINTF("omhttp: submitBatch, batch: '%s' tpls: '%p'\n", batchBuf, tpls);
 
-    CHKiRet(curlPost(pWrkrData, (uchar *)batchBuf, strlen(batchBuf), tpls, pWrkrData->batch.nmemb));
+    if (pWrkrData->pipeline.nSlots > 0) {
+        iRet = pipelinePost(pWrkrData, (uchar *)batchBuf, strlen(batchBuf), tpls, 1);
+        batchBuf = NULL; /* owned by the pipeline now */
+    } else {
+        CHKiRet(curlPost(pWrkrData, (uchar *)batchBuf, strlen(batchBuf), tpls, pWrkrData->batch.nmemb));
+    }
 
 finalize_it:
     if (batchBuf != NULL) free(batchBuf);
@@ -2027,7 +2282,9 @@ BEGINcommitTransaction
             CHKiRet(buildBatch(pWrkrData, payload));
         } else {
             /* non-batch mode: send immediately */
-            const rsRetVal postRet = curlPost(pWrkrData, payload, strlen((char *)payload), tpls, 1);
+            const rsRetVal postRet = (pWrkrData->pipeline.nSlots > 0)
+                                         ? pipelinePost(pWrkrData, payload, strlen((char *)payload), tpls, 0)
+                                         : curlPost(pWrkrData, payload, strlen((char *)payload), tpls, 1);
             if (postRet == RS_RET_DATAFAIL) {
                 DBGPRINTF("omhttp: permanent data failure for single message, continuing transaction\n");
                 continue;
@@ -2045,6 +2302,11 @@ BEGINcommitTransaction
         }
     }
 finalize_it:
+    if (pWrkrData->pipeline.nSlots > 0) {
+        /* the transaction is only done when all of its requests are */
+        const rsRetVal drainRet = httppipe.Drain(pWrkrData->pipeline.pipe);
+        if (iRet == RS_RET_OK) iRet = drainRet;
+    }
 ENDcommitTransaction
 
 
@@ -2150,25 +2412,65 @@ static void ATTR_NONNULL() curlCheckConnSetup(wrkrInstanceData_t *const pWrkrDat
     curl_easy_setopt(serverData->curlCheckConnHandle, CURLOPT_TIMEOUT_MS, pWrkrData->pData->healthCheckTimeout);
 }
 
-static void ATTR_NONNULL(1) curlPostSetup(wrkrInstanceData_t *const pWrkrData, serverData_t *serverData) {
+static void ATTR_NONNULL(1) curlPostSetup(wrkrInstanceData_t *const pWrkrData,
+                                          serverData_t *serverData,
+                                          CURL *const handle) {
     PTR_ASSERT_SET_TYPE(pWrkrData, WRKR_DATA_TYPE_ES);
-    curlSetupCommon(pWrkrData, serverData, serverData->curlPostHandle);
-    curl_easy_setopt(serverData->curlPostHandle, CURLOPT_POST, 1L);
+    curlSetupCommon(pWrkrData, serverData, handle);
+    curl_easy_setopt(handle, CURLOPT_POST, 1L);
     CURLcode cRet;
     /* Enable TCP keep-alive for this transfer */
-    cRet = curl_easy_setopt(serverData->curlPostHandle, CURLOPT_TCP_KEEPALIVE, 1L);
+    cRet = curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
     if (cRet != CURLE_OK) DBGPRINTF("omhttp: curlPostSetup unknown option CURLOPT_TCP_KEEPALIVE\n");
     /* keep-alive idle time to 120 seconds */
-    cRet = curl_easy_setopt(serverData->curlPostHandle, CURLOPT_TCP_KEEPIDLE, 120L);
+    cRet = curl_easy_setopt(handle, CURLOPT_TCP_KEEPIDLE, 120L);
     if (cRet != CURLE_OK) DBGPRINTF("omhttp: curlPostSetup unknown option CURLOPT_TCP_KEEPIDLE\n");
     /* interval time between keep-alive probes: 60 seconds */
-    cRet = curl_easy_setopt(serverData->curlPostHandle, CURLOPT_TCP_KEEPINTVL, 60L);
+    cRet = curl_easy_setopt(handle, CURLOPT_TCP_KEEPINTVL, 60L);
     if (cRet != CURLE_OK) DBGPRINTF("omhttp: curlPostSetup unknown option CURLOPT_TCP_KEEPINTVL\n");
 
-    cRet = curl_easy_setopt(serverData->curlPostHandle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+    cRet = curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
     if (cRet != CURLE_OK) DBGPRINTF("omhttp: curlPostSetup unknown option CURLOPT_HTTP_VERSION\n");
 }
 
+/* create the pipelined transport and set up the easy handles of its slots */
+static rsRetVal ATTR_NONNULL() pipelineSetup(wrkrInstanceData_t *const pWrkrData) {
+    DEFiRet;
+
+    if (pWrkrData->pipeline.nSlots == 0) FINALIZE;
+
+    CHKiRet(httppipe.Construct(&pWrkrData->pipeline.pipe, pWrkrData->pipeline.nSlots, "omhttp", pipelineComplete,
+                               pipelineAbandon, pWrkrData));
+    for (int i = 0; i < pWrkrData->pipeline.nSlots; ++i) {
+        pipelineSlot_t *const slot = &pWrkrData->pipeline.slots[i];
+        CURL *const handle = httppipe.GetHandle(pWrkrData->pipeline.pipe, i);
+        curlPostSetup(pWrkrData, pWrkrData->listServerDataWkr[0], handle);
+        curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, pipelineResult);
+        curl_easy_setopt(handle, CURLOPT_WRITEDATA, slot);
+        curl_easy_setopt(handle, CURLOPT_ERRORBUFFER, slot->errbuf);
+    }
+
+finalize_it:
+    RETiRet;
+}
+
+/* release the curl resources of the pipelined transport; the slots stay */
+static void ATTR_NONNULL() pipelineCleanup(wrkrInstanceData_t *const pWrkrData) {
+    httppipe.Destruct(&pWrkrData->pipeline.pipe);
+}
+
+static void ATTR_NONNULL() freePipelineSlots(wrkrInstanceData_t *const pWrkrData) {
+    if (pWrkrData->pipeline.slots == NULL) return;
+    pipelineCleanup(pWrkrData);
+    for (int i = 0; i < pWrkrData->pipeline.nSlots; ++i) {
+        free(pWrkrData->pipeline.slots[i].msgs);
+        free(pWrkrData->pipeline.slots[i].reply);
+    }
+    free(pWrkrData->pipeline.slots);
+    pWrkrData->pipeline.slots = NULL;
+    pWrkrData->pipeline.nSlots = 0;
+}
+
 static rsRetVal ATTR_NONNULL() curlSetup(wrkrInstanceData_t *const pWrkrData) {
     serverData_t *serverData = NULL;
     int i = 0;
@@ -2181,11 +2483,13 @@ static rsRetVal ATTR_NONNULL() curlSetup(wrkrInstanceData_t *const pWrkrData) {
         CHKiRet(buildCurlHeaders(pWrkrData, serverData, &serverData->curlCheckHeader, 0));
         CHKmalloc(serverData->curlCheckConnHandle = curl_easy_init());
         CHKmalloc(serverData->curlPostHandle = curl_easy_init());
-        curlPostSetup(pWrkrData, serverData);
+        curlPostSetup(pWrkrData, serverData, serverData->curlPostHandle);
         curlCheckConnSetup(pWrkrData, serverData);
     }
+    CHKiRet(pipelineSetup(pWrkrData));
 finalize_it:
     if (iRet != RS_RET_OK) {
+        pipelineCleanup(pWrkrData);
         for (int j = 0; j < i; j++) {
             cleanupServerData(pWrkrData->listServerDataWkr[j]);
         }
@@ -2234,6 +2538,7 @@ static void freeWorkerServerData(wrkrInstanceData_t *pWrkrData) {
 
 static void ATTR_NONNULL() curlCleanup(wrkrInstanceData_t *const pWrkrData) {
     int size = pWrkrData->numServers;
+    pipelineCleanup(pWrkrData);
     if (pWrkrData->listServerDataWkr != NULL) {
         for (int i = 0; i < size; i++) {
             cleanupServerData(pWrkrData->listServerDataWkr[i]);
@@ -2271,6 +2576,7 @@ static void ATTR_NONNULL() setInstParamDefaults(instanceData *const pData) {
     pData->maxBatchBytes = DEFAULT_MAX_BATCH_BYTES;  // 10 MB - default max message size for AWS API Gateway
     pData->maxBatchSize = 100;  // 100 messages
     pData->replyMaxBytes = DEFAULT_REPLY_MAX_BYTES;  // 1 MB default max response size (0 disables limit)
+    pData->pipelineMaxInFlight = 1;  // sequential requests
     pData->compress = 0;  // off
     pData->compressionLevel = -1;  // default compression
     pData->allowUnsignedCerts = 0;
@@ -2669,6 +2975,13 @@ BEGINnewActInst
             pData->maxBatchSize = (size_t)pvals[i].val.d.n;
         } else if (!strcmp(actpblk.descr[i].name, "replymaxbytes")) {
             pData->replyMaxBytes = (size_t)pvals[i].val.d.n;
+        } else if (!strcmp(actpblk.descr[i].name, "pipeline.maxinflight")) {
+            pData->pipelineMaxInFlight = (int)pvals[i].val.d.n;
+            if (pData->pipelineMaxInFlight > MAX_PIPELINE_INFLIGHT) {
+                LogError(0, RS_RET_PARAM_ERROR, "omhttp: pipeline.maxinflight %d too large, using %d instead",
+                         pData->pipelineMaxInFlight, MAX_PIPELINE_INFLIGHT);
+                pData->pipelineMaxInFlight = MAX_PIPELINE_INFLIGHT;
+            }
         } else if (!strcmp(actpblk.descr[i].name, "compress")) {
             pData->compress = pvals[i].val.d.n;
         } else if (!strcmp(actpblk.descr[i].name, "compress.level")) {
@@ -3066,6 +3379,7 @@ BEGINmodExit
     objRelease(prop, CORE_COMPONENT);
     objRelease(ruleset, CORE_COMPONENT);
     objRelease(statsobj, CORE_COMPONENT);
+    objRelease(httppipe, LM_HTTPPIPE_FILENAME);
 ENDmodExit
 
 NO_LEGACY_CONF_parseSelectorAct
@@ -3084,6 +3398,7 @@ BEGINmodInit()
     CODEmodInit_QueryRegCFSLineHdlr CHKiRet(objUse(prop, CORE_COMPONENT));
     CHKiRet(objUse(ruleset, CORE_COMPONENT));
     CHKiRet(objUse(statsobj, CORE_COMPONENT));
+    CHKiRet(objUse(httppipe, LM_HTTPPIPE_FILENAME));
 
     if (curl_global_init(CURL_GLOBAL_ALL) != 0) {
         LogError(0, RS_RET_OBJ_CREATION_FAILED, "CURL fail. -http disabled");
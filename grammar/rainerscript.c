@@ -61,6 +61,7 @@
 #include "unicode-helper.h"
 #include "errmsg.h"
 #include "glbl.h"
+#include "acmatch.h"
 #ifdef HAVE_LIBYAML
     #include "yamlconf.h"
 #endif
@@ -918,6 +919,8 @@ static int doGetQueueType(struct nvlst *valnode, struct cnfparamdescr *param, st
         val->val.d.n = QUEUETYPE_DIRECT;
     } else if (!es_strcasebufcmp(valnode->val.d.estr, (uchar *)"segmenteddisk", 13)) {
         val->val.d.n = QUEUETYPE_SEGMENTED_DISK;
+    } else if (!es_strcasebufcmp(valnode->val.d.estr, (uchar *)"ringbuffer", 10)) {
+        val->val.d.n = QUEUETYPE_RINGBUFFER;
     } else {
         cstr = es_str2cstr(valnode->val.d.estr, NULL);
         if (cstr == NULL) {
@@ -3744,8 +3747,9 @@ static void evalVar(struct cnfvar *__restrict__ const var,
 
 /* perform a string comparision operation against a while array. Semantic is
  * that one one comparison is true, the whole construct is true.
- * TODO: we can obviously optimize this process. One idea is to
- * compile a regex, which should work faster than serial comparison.
+ * If the optimizer compiled the array into a multi-pattern matcher, we use
+ * that, which scans the string once no matter how many members the array
+ * has. Otherwise we compare member by member.
  * Note: compiling a regex does NOT work at all. I experimented with that
  * and it was generally 5 to 10 times SLOWER than what we do here...
  */
@@ -3759,6 +3763,8 @@ static int evalStrArrayCmp(es_str_t *const estr_l, const struct cnfarray *__rest
     } else if (cmpop == CMP_NE) {
         res = bsearch(&estr_l, ar->arr, ar->nmemb, sizeof(es_str_t *), qs_arrcmp);
         r = res == NULL;
+    } else if (ar->matcher != NULL) {
+        r = acmatchMatch(ar->matcher, es_getBufAddr(estr_l), es_strlen(estr_l));
     } else {
         for (i = 0; (r == 0) && (i < ar->nmemb); ++i) {
             switch (cmpop) {
@@ -4212,6 +4218,7 @@ void cnfarrayContentDestruct(struct cnfarray *ar) {
         es_deleteStr(ar->arr[i]);
     }
     free(ar->arr);
+    acmatchDestruct(&ar->matcher);
 }
 
 static void regex_destruct(struct cnffunc *func) {
@@ -4641,6 +4648,52 @@ void cnfexprDestruct(struct cnfexpr *__restrict__ const expr) {
     free(expr);
 }
 
+/* Check if expression @p expr calls a function whose result depends on what
+ * the previous statements did for the same message: script_error() reports
+ * the last function's error state and previous_action_suspended() the last
+ * action's outcome, both kept per worker rather than per message. The ruleset
+ * engine must execute such scripts message by message.
+ */
+int cnfexprNeedsMsgOrder(const struct cnfexpr *const expr) {
+    if (expr == NULL) return 0;
+
+    switch (expr->nodetype) {
+        case CMP_NE:
+        case CMP_EQ:
+        case CMP_LE:
+        case CMP_GE:
+        case CMP_LT:
+        case CMP_GT:
+        case CMP_STARTSWITH:
+        case CMP_ENDSWITH:
+        case CMP_STARTSWITHI:
+        case CMP_CONTAINS:
+        case CMP_CONTAINSI:
+        case OR:
+        case AND:
+        case '&':
+        case '+':
+        case '-':
+        case '*':
+        case '/':
+        case '%': /* binary */
+            return cnfexprNeedsMsgOrder(expr->l) || cnfexprNeedsMsgOrder(expr->r);
+        case NOT:
+        case 'M': /* unary */
+            return cnfexprNeedsMsgOrder(expr->r);
+        case 'F': {
+            const struct cnffunc *const func = (const struct cnffunc *)expr;
+            if (func->fPtr == doFunct_ScriptError || func->fPtr == doFunct_PreviousActionSuspended) return 1;
+            for (unsigned short i = 0; i < func->nParams; ++i) {
+                if (cnfexprNeedsMsgOrder(func->expr[i])) return 1;
+            }
+            return 0;
+        }
+        default:
+            return 0;
+    }
+}
+
 //---- END
 
 
@@ -5002,6 +5055,7 @@ struct cnfarray *cnfarrayNew(es_str_t *val) {
         ar->nodetype = 'A';
         ar->nmemb = 0;
         ar->arr = NULL;
+        ar->matcher = NULL;
         if (val == NULL) {
             goto done;
         }
@@ -5688,6 +5742,71 @@ static inline void cnfexprOptimize_CMPEQ_arr(struct cnfarray *arr) {
 }
 
 
+/* arrays with fewer members than this are cheaper to compare one by one */
+#define ARRAY_MATCHER_MIN_MEMB 4
+
+/* compile an array used with contains, contains_i, startswith, startswith_i
+ * or endswith into a multi-pattern matcher. If that fails (e.g. because the
+ * automaton would become too large), we simply keep comparing member by
+ * member.
+ */
+static void cnfexprOptimize_CMPSTR_arr(struct cnfarray *const arr, const int cmpop) {
+    const unsigned char **patterns = NULL;
+    size_t *lens = NULL;
+    acmatchMode_t mode;
+    int bNoCase;
+    rsRetVal localRet;
+
+    if (arr->matcher != NULL || arr->nmemb < ARRAY_MATCHER_MIN_MEMB) goto done;
+    switch (cmpop) {
+        case CMP_CONTAINS:
+            mode = ACMATCH_CONTAINS;
+            bNoCase = 0;
+            break;
+        case CMP_CONTAINSI:
+            mode = ACMATCH_CONTAINS;
+            bNoCase = 1;
+            break;
+        case CMP_STARTSWITH:
+            mode = ACMATCH_PREFIX;
+            bNoCase = 0;
+            break;
+        case CMP_STARTSWITHI:
+            mode = ACMATCH_PREFIX;
+            bNoCase = 1;
+            break;
+        case CMP_ENDSWITH:
+            mode = ACMATCH_SUFFIX;
+            bNoCase = 0;
+            break;
+        default:
+            goto done;
+    }
+
+    if ((patterns = malloc(arr->nmemb * sizeof(unsigned char *))) == NULL ||
+        (lens = malloc(arr->nmemb * sizeof(size_t))) == NULL) {
+        goto done;
+    }
+    for (int i = 0; i < arr->nmemb; ++i) {
+        patterns[i] = es_getBufAddr(arr->arr[i]);
+        lens[i] = es_strlen(arr->arr[i]);
+    }
+    localRet = acmatchConstruct(&arr->matcher, patterns, lens, arr->nmemb, mode, bNoCase);
+    if (localRet == RS_RET_OK) {
+        DBGPRINTF("optimizer: compiled array of %d members for %s into matcher with %d states\n", arr->nmemb,
+                  tokenToString(cmpop), acmatchNumStates(arr->matcher));
+    } else {
+        DBGPRINTF("optimizer: could not compile array of %d members for %s, error %d - "
+                  "comparing members one by one\n",
+                  arr->nmemb, tokenToString(cmpop), localRet);
+    }
+
+done:
+    free(patterns);
+    free(lens);
+}
+
+
 /* (recursively) optimize an expression */
 struct cnfexpr *cnfexprOptimize(struct cnfexpr *expr) {
     long long ln, rn;
@@ -5780,6 +5899,9 @@ struct cnfexpr *cnfexprOptimize(struct cnfexpr *expr) {
         case CMP_STARTSWITHI:
             expr->l = cnfexprOptimize(expr->l);
             expr->r = cnfexprOptimize(expr->r);
+            if (expr->r->nodetype == 'A') {
+                cnfexprOptimize_CMPSTR_arr((struct cnfarray *)expr->r, expr->nodetype);
+            }
             break;
         case AND:
         case OR:
@@ -211,6 +211,7 @@ struct cnfarray {
     unsigned nodetype;
     int nmemb;
     es_str_t **arr;
+    struct acmatch_s *matcher; /* compiled by the optimizer for contains/startswith/endswith, or NULL */
 } __attribute__((aligned(8)));
 
 struct cnffparamlst {
@@ -414,6 +415,7 @@ void cnfparamvalsDestruct(const struct cnfparamvals *paramvals, const struct cnf
 struct cnfstmt *cnfstmtNew(unsigned s_type);
 struct cnfitr *cnfNewIterator(char *var, struct cnfexpr *collection);
 void cnfstmtPrintOnly(struct cnfstmt *stmt, int indent, sbool subtree);
+int cnfexprNeedsMsgOrder(const struct cnfexpr *const expr);
 void cnfstmtPrint(struct cnfstmt *stmt, int indent);
 struct cnfstmt *scriptAddStmt(struct cnfstmt *root, struct cnfstmt *s);
 struct objlst *objlstAdd(struct objlst *root, struct cnfobj *o);
@@ -52,6 +52,9 @@
 #ifdef HAVE_LINUX_FS_H
     #include <linux/fs.h>
 #endif
+#ifdef HAVE_SYS_PRCTL_H
+    #include <sys/prctl.h>
+#endif
 #if defined(OS_SOLARIS) && defined(HAVE_PORT_SOURCE_FILE)
     #include <port.h>
     #include <sys/port.h>
@@ -230,6 +233,11 @@ struct act_obj_s {
     statsobj_t *stats; /* stats object for this file */
     STATSCOUNTER_DEF(bytesProcessed, mutBytesProcessed); /* total bytes processed from this file */
     STATSCOUNTER_DEF(linesProcessed, mutLinesProcessed); /* total lines processed from this file */
+    pthread_mutex_t mutPoll; /* serializes pollFile() runs, readers and the main thread may both poll */
+    /* reader pool bookkeeping, protected by readerPool.mut */
+    act_obj_t *rdNext; /* next object in the reader queue */
+    uint8_t rdState; /* RDSTATE_* */
+    sbool rdDetached; /* being destroyed, must not be queued again */
 };
 struct fs_edge_s {
     fs_node_t *parent; /* node pointing to this edge */
@@ -251,7 +259,10 @@ struct fs_node_s {
 /* forward definitions */
 static rsRetVal persistStrmState(act_obj_t *);
 static rsRetVal resetConfigVariables(uchar __attribute__((unused)) * pp, void __attribute__((unused)) * pVal);
+static rsRetVal openFile(act_obj_t *const act);
 static rsRetVal ATTR_NONNULL(1) pollFile(act_obj_t *act);
+static void ATTR_NONNULL(1) pollFileAsync(act_obj_t *act);
+static void ATTR_NONNULL(1) readerPoolForget(act_obj_t *act);
 static int ATTR_NONNULL() getBasename(uchar *const __restrict__ basen, uchar *const __restrict__ path);
 static void act_obj_destroy(act_obj_t *const act, const int is_deleted);
 static void ATTR_NONNULL() act_obj_unlink_nodestroy(act_obj_t *act);
@@ -262,6 +273,32 @@ static int ATTR_NONNULL()
     getFullStateFileName(const uchar *const, const char *const, uchar *const pszout, const size_t ilenout);
 static void ATTR_NONNULL(1) getFileID(act_obj_t *const act);
 
+/* Reader pool (inotify mode only). The input thread keeps handling all
+ * inotify events and directory changes, but hands the actual reading of
+ * files to a set of reader threads via a single FIFO. A file is in the
+ * queue at most once and read by at most one reader at a time, so lines
+ * of a file are still submitted in order; a busy file is moved to the end
+ * of the queue after a batch of lines, so one hot file cannot starve the
+ * others.
+ */
+#define RDSTATE_IDLE 0 /* neither queued nor being read */
+#define RDSTATE_QUEUED 1 /* in the queue */
+#define RDSTATE_BUSY 2 /* being read by a reader */
+#define RDSTATE_BUSY_PENDING 3 /* being read, and new data was signalled meanwhile */
+#define READER_BATCH_LINES 1024 /* max lines a reader processes before requeueing a file */
+static struct {
+    pthread_mutex_t mut;
+    pthread_cond_t work; /* signalled when a file was queued or on shutdown */
+    pthread_cond_t idle; /* broadcast when a reader finished a batch */
+    act_obj_t *head, *tail; /* files waiting to be read */
+    pthread_t *thrds;
+    int nThrds; /* 0 if the pool is not running */
+    int nJoined; /* readers already joined while stopping */
+    sbool bStop;
+} readerPool = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, NULL, NULL, 0, 0, 0};
+/* per-minute rate limits are per instance, but an instance may monitor many files */
+static pthread_mutex_t mutPerMinuteRateLimits = PTHREAD_MUTEX_INITIALIZER;
+
 static rsRetVal ATTR_NONNULL(1, 2, 3)
     getRequiredStateJsonField(struct json_object *json, const char *fieldName, struct json_object **out) {
     DEFiRet;
@@ -317,6 +354,7 @@ struct modConfData_s {
     int maxiNotifyWatches;
     int inotifyFallbackInterval;
     sbool bInotifyLimitHit;
+    int readerThreads; /* size of the reader pool in inotify mode, 0: read on the input thread */
     instanceConf_t *root, *tail;
     fs_node_t *conf_tree;
     uint8_t opMode;
@@ -385,6 +423,7 @@ static struct cnfparamdescr modpdescr[] = {
     {"deletestateonfilemove", eCmdHdlrBinary, 0},
     {"maxinotifywatches", eCmdHdlrNonNegInt, 0},
     {"inotifyfallbackinterval", eCmdHdlrNonNegInt, 0},
+    {"readerthreads", eCmdHdlrNonNegInt, 0},
 };
 static struct cnfparamblk modpblk = {CNFPARAMBLK_VERSION, sizeof(modpdescr) / sizeof(struct cnfparamdescr), modpdescr};
 
@@ -835,6 +874,8 @@ static rsRetVal ATTR_NONNULL(1, 2) act_obj_add(fs_edge_t *const edge,
     }
     DBGPRINTF("add new active object '%s' in '%s'\n", name, edge->path);
     CHKmalloc(act = calloc(1, sizeof(act_obj_t)));
+    pthread_mutex_init(&act->mutPoll, NULL);
+    act->rdState = RDSTATE_IDLE;
     CHKmalloc(act->name = strdup(name));
     if (-1 == getBasename((uchar *)basename, (uchar *)name)) {
         CHKmalloc(act->basename = strdup(name)); /* assume basename is same as name */
@@ -886,7 +927,16 @@ static rsRetVal ATTR_NONNULL(1, 2) act_obj_add(fs_edge_t *const edge,
         CHKiRet(statsobj.AddCounter(act->stats, UCHAR_CONSTANT("lines.processed"), ctrType_IntCtr, CTR_FLAG_RESETTABLE,
                                     &(act->linesProcessed)));
         CHKiRet(statsobj.ConstructFinalize(act->stats));
-        pollFile(act);
+        if (readerPool.nThrds > 0) {
+            /* open right away: freshStartTail applies only to files found
+             * during the initial run, which may be over before a reader
+             * gets to the file. A failed open is retried by the reader.
+             */
+            openFile(act);
+            pollFileAsync(act);
+        } else {
+            pollFile(act);
+        }
     }
 
     /* all well, add to active list */
@@ -899,6 +949,7 @@ finalize_it:
     if (iRet != RS_RET_OK) {
         if (act != NULL) {
             if (act->ratelimiter != NULL) ratelimitDestruct(act->ratelimiter);
+            pthread_mutex_destroy(&act->mutPoll);
             free(act->name);
             free(act);
         }
@@ -976,7 +1027,7 @@ static void detect_updates(fs_edge_t *const edge) {
                         "open: %" PRId64 "/%" PRId64 "/%" PRId64 "s!\n",
                         act_name, (int64_t)act->time_to_delete, (int64_t)ttNow, (int64_t)ttNow - act->time_to_delete);
                     havePendingDeletes = 1;
-                    pollFile(act);
+                    pollFileAsync(act);
                 }
                 break;
             } else if (fileInfo.st_ino != act->ino) {
@@ -1045,7 +1096,7 @@ static void ATTR_NONNULL() poll_active_files(fs_edge_t *const edge) {
     for (act = edge->active; act != NULL; act = act->next) {
         fen_setupWatch(act);
         DBGPRINTF("poll_active_files: polling '%s'\n", act->name);
-        pollFile(act);
+        pollFileAsync(act);
     }
 }
 
@@ -1149,9 +1200,13 @@ static void ATTR_NONNULL() poll_timeouts(fs_edge_t *const edge) {
     if (edge->is_file) {
         act_obj_t *act;
         for (act = edge->active; act != NULL; act = act->next) {
-            if (act->pStrm && strmReadMultiLine_isTimedOut(act->pStrm)) {
+            /* a file a reader works on right now is checked on the next round */
+            if (pthread_mutex_trylock(&act->mutPoll) != 0) continue;
+            const int bTimedOut = act->pStrm && strmReadMultiLine_isTimedOut(act->pStrm);
+            pthread_mutex_unlock(&act->mutPoll);
+            if (bTimedOut) {
                 DBGPRINTF("timeout occurred on %s\n", act->name);
-                pollFile(act);
+                pollFileAsync(act);
             }
         }
     }
@@ -1216,6 +1271,7 @@ static void act_obj_destroy(act_obj_t *const act, const int is_deleted) {
 
     DBGPRINTF("act_obj_destroy: act %p '%s' (source '%s'), wd %d, pStrm %p, is_deleted %d, in_move %d\n", act,
               act->name, act->source_name ? act->source_name : "---", act->wd, act->pStrm, is_deleted, act->in_move);
+    readerPoolForget(act); /* from here on, only we access act */
     if (act->pStrm != NULL) {
         const instanceConf_t *const inst = act->edge->instarr[0];  // TODO: same file, multiple instances?
         pollFile(act); /* get any left-over data */
@@ -1278,6 +1334,7 @@ static void act_obj_destroy(act_obj_t *const act, const int is_deleted) {
     free(act->basename);
     free(act->source_name);
     free(act->multiSub.ppMsgs);
+    pthread_mutex_destroy(&act->mutPoll);
 #if defined(OS_SOLARIS) && defined(HAVE_PORT_SOURCE_FILE)
     act->is_deleted = 1;
 #else
@@ -1641,8 +1698,10 @@ static rsRetVal ATTR_NONNULL(1, 2)
         const instanceConf_t *const inst = act->edge->instarr[inst_idx];
 
         if (inst->perMinuteRateLimits.maxBytesPerMinute || inst->perMinuteRateLimits.maxLinesPerMinute) {
+            pthread_mutex_lock(&mutPerMinuteRateLimits);
             const rsRetVal localRet =
                 checkPerMinuteRateLimits((per_minute_rate_limit_t *)&inst->perMinuteRateLimits, msgLen);
+            pthread_mutex_unlock(&mutPerMinuteRateLimits);
             if (localRet == RS_RET_RATE_LIMITED && act->edge->ninst > 1) {
                 msgDestruct(&msgs[inst_idx]);
                 continue;
@@ -1883,7 +1942,7 @@ static void pollFileCancelCleanup(void *pArg) {
 
 
 /* pollFile needs to be split due to the unfortunate pthread_cancel_push() macros. */
-static rsRetVal ATTR_NONNULL() pollFileReal(act_obj_t *act, cstr_t **pCStr) {
+static rsRetVal ATTR_NONNULL() pollFileReal(act_obj_t *act, cstr_t **pCStr, const int maxLines, sbool *const pbMore) {
     int64 strtOffs;
     DEFiRet;
     int64_t startOffs = 0;
@@ -1906,7 +1965,10 @@ static rsRetVal ATTR_NONNULL() pollFileReal(act_obj_t *act, cstr_t **pCStr) {
     startOffs = act->pStrm->iCurrOffs;
     /* loop below will be exited when strmReadLine() returns EOF */
     while (glbl.GetGlobalInputTermState() == 0) {
-        if (inst->maxLinesAtOnce != 0 && nProcessed >= inst->maxLinesAtOnce) break;
+        if (maxLines != 0 && nProcessed >= maxLines) {
+            *pbMore = 1;
+            break;
+        }
         if ((start_preg == NULL) && (end_preg == NULL)) {
             CHKiRet(strm.ReadLine(act->pStrm, pCStr, inst->readMode, inst->escapeLF, inst->escapeLFString,
                                   inst->trimLineOverBytes, &strtOffs));
@@ -1951,23 +2013,218 @@ finalize_it:
     RETiRet;
 }
 
-/* poll a file, need to check file rollover etc. open file if not open */
-static rsRetVal ATTR_NONNULL(1) pollFile(act_obj_t *const act) {
+/* poll a file, need to check file rollover etc. open file if not open.
+ * Processes at most maxLines lines (0: no limit) and sets *pbMore if it
+ * stopped because of that limit.
+ */
+static rsRetVal ATTR_NONNULL(1, 3) pollFileLimited(act_obj_t *const act, const int maxLines, sbool *const pbMore) {
     cstr_t *pCStr = NULL;
     DEFiRet;
+    *pbMore = 0;
     if (act->is_symlink) {
         FINALIZE; /* no reason to poll symlink file */
     }
+    pthread_mutex_lock(&act->mutPoll);
     /* Note: we must do pthread_cleanup_push() immediately, because the POSIX macros
      * otherwise do not work if I include the _cleanup_pop() inside an if... -- rgerhards, 2008-08-14
      */
+    pthread_cleanup_push(mutexCancelCleanup, &act->mutPoll);
     pthread_cleanup_push(pollFileCancelCleanup, &pCStr);
-    iRet = pollFileReal(act, &pCStr);
+    iRet = pollFileReal(act, &pCStr, maxLines, pbMore);
     pthread_cleanup_pop(0);
+    pthread_cleanup_pop(1); /* unlock mutPoll */
 finalize_it:
     RETiRet;
 }
 
+static rsRetVal ATTR_NONNULL(1) pollFile(act_obj_t *const act) {
+    const instanceConf_t *const inst = act->edge->instarr[0];
+    sbool bMore;
+    return pollFileLimited(act, inst->maxLinesAtOnce, &bMore);
+}
+
+
+/* queue a file for the reader pool; readerPool.mut must be held */
+static void ATTR_NONNULL(1) readerPoolEnqueue(act_obj_t *const act) {
+    act->rdNext = NULL;
+    if (readerPool.tail == NULL) {
+        readerPool.head = act;
+    } else {
+        readerPool.tail->rdNext = act;
+    }
+    readerPool.tail = act;
+    act->rdState = RDSTATE_QUEUED;
+    pthread_cond_signal(&readerPool.work);
+}
+
+/* read a file, on a reader thread if the pool runs and on the caller's otherwise */
+static void ATTR_NONNULL(1) pollFileAsync(act_obj_t *const act) {
+    if (readerPool.nThrds == 0) {
+        pollFile(act);
+        return;
+    }
+    if (act->is_symlink) return;
+    pthread_mutex_lock(&readerPool.mut);
+    if (!act->rdDetached) {
+        if (act->rdState == RDSTATE_IDLE) {
+            readerPoolEnqueue(act);
+        } else if (act->rdState == RDSTATE_BUSY) {
+            act->rdState = RDSTATE_BUSY_PENDING; /* reader must have another look */
+        }
+    }
+    pthread_mutex_unlock(&readerPool.mut);
+}
+
+/* Remove a file from the pool's view before it is destroyed: dequeue it
+ * and wait until no reader works on it any longer. Afterwards, the caller
+ * is the only one accessing act.
+ */
+static void ATTR_NONNULL(1) readerPoolForget(act_obj_t *const act) {
+    if (readerPool.nThrds == 0) return;
+    pthread_mutex_lock(&readerPool.mut);
+    act->rdDetached = 1;
+    if (act->rdState == RDSTATE_QUEUED) {
+        act_obj_t *prev = NULL;
+        for (act_obj_t *a = readerPool.head; a != NULL; prev = a, a = a->rdNext) {
+            if (a == act) {
+                if (prev == NULL) {
+                    readerPool.head = act->rdNext;
+                } else {
+                    prev->rdNext = act->rdNext;
+                }
+                if (readerPool.tail == act) readerPool.tail = prev;
+                break;
+            }
+        }
+        act->rdState = RDSTATE_IDLE;
+    }
+    pthread_cleanup_push(mutexCancelCleanup, &readerPool.mut);
+    while (act->rdState != RDSTATE_IDLE) pthread_cond_wait(&readerPool.idle, &readerPool.mut);
+    pthread_cleanup_pop(1); /* unlock readerPool.mut */
+}
+
+#if defined(HAVE_INOTIFY_INIT)
+static void *readerPoolWorker(void *const arg) {
+    const int id = (int)(intptr_t)arg;
+    uchar thrdName[32];
+
+    snprintf((char *)thrdName, sizeof(thrdName), "imfile(r%d)", id);
+#if defined(HAVE_PRCTL) && defined(PR_SET_NAME)
+    /* set thread name - we ignore if the call fails, has no harsh consequences... */
+    if (prctl(PR_SET_NAME, thrdName, 0, 0, 0) != 0) {
+        DBGPRINTF("prctl failed, not setting thread name for '%s'\n", thrdName);
+    }
+#endif
+    dbgOutputTID((char *)thrdName);
+
+    pthread_mutex_lock(&readerPool.mut);
+    /* readers are cancelled if they do not stop in time, see readerPoolCancelCleanup() */
+    pthread_cleanup_push(mutexCancelCleanup, &readerPool.mut);
+    while (1) {
+        while (readerPool.head == NULL && !readerPool.bStop && glbl.GetGlobalInputTermState() == 0)
+            pthread_cond_wait(&readerPool.work, &readerPool.mut);
+        /* on shutdown, files still queued are read by act_obj_destroy() */
+        if (readerPool.bStop || glbl.GetGlobalInputTermState() != 0) break;
+        act_obj_t *const act = readerPool.head;
+        readerPool.head = act->rdNext;
+        if (readerPool.head == NULL) readerPool.tail = NULL;
+        act->rdState = RDSTATE_BUSY;
+        pthread_mutex_unlock(&readerPool.mut);
+
+        const int maxLinesAtOnce = act->edge->instarr[0]->maxLinesAtOnce;
+        sbool bMore = 0;
+        pollFileLimited(act, (maxLinesAtOnce > 0 && maxLinesAtOnce < READER_BATCH_LINES) ? maxLinesAtOnce
+                                                                                          : READER_BATCH_LINES,
+                        &bMore);
+
+        pthread_mutex_lock(&readerPool.mut);
+        if ((bMore || act->rdState == RDSTATE_BUSY_PENDING) && !act->rdDetached &&
+            glbl.GetGlobalInputTermState() == 0) {
+            readerPoolEnqueue(act); /* to the end, so that other files get their turn */
+        } else {
+            act->rdState = RDSTATE_IDLE;
+        }
+        pthread_cond_broadcast(&readerPool.idle);
+    }
+    pthread_cleanup_pop(1); /* unlock readerPool.mut */
+    return NULL;
+}
+
+static void readerPoolStart(const int nThrds) {
+    readerPool.head = readerPool.tail = NULL;
+    readerPool.bStop = 0;
+    readerPool.nJoined = 0;
+    if (nThrds == 0) return;
+    readerPool.thrds = calloc(nThrds, sizeof(pthread_t));
+    if (readerPool.thrds == NULL) {
+        LogError(errno, RS_RET_OUT_OF_MEMORY, "imfile: cannot start reader threads, reading on input thread");
+        return;
+    }
+    for (int i = 0; i < nThrds; ++i) {
+        const int r = pthread_create(&readerPool.thrds[readerPool.nThrds], &default_thread_attr, readerPoolWorker,
+                                     (void *)(intptr_t)i);
+        if (r != 0) {
+            LogError(r, RS_RET_ERR, "imfile: could only start %d of %d reader threads", readerPool.nThrds, nThrds);
+            break;
+        }
+        ++readerPool.nThrds;
+    }
+    if (readerPool.nThrds == 0) {
+        free(readerPool.thrds);
+        readerPool.thrds = NULL;
+    }
+    DBGPRINTF("imfile: started %d reader threads\n", readerPool.nThrds);
+}
+
+/* tell the readers to stop after their current batch */
+static void readerPoolSignalStop(void) {
+    pthread_mutex_lock(&readerPool.mut);
+    readerPool.bStop = 1;
+    pthread_cond_broadcast(&readerPool.work);
+    pthread_mutex_unlock(&readerPool.mut);
+}
+
+/* join the readers not joined yet and release the pool; if bCancel, they are
+ * cancelled first, as they may be blocked submitting to a full queue
+ */
+static void readerPoolJoin(const int bCancel) {
+    if (bCancel) {
+        for (int i = readerPool.nJoined; i < readerPool.nThrds; ++i) pthread_cancel(readerPool.thrds[i]);
+    }
+    while (readerPool.nJoined < readerPool.nThrds) {
+        pthread_join(readerPool.thrds[readerPool.nJoined], NULL);
+        ++readerPool.nJoined;
+    }
+    free(readerPool.thrds);
+    readerPool.thrds = NULL;
+    /* no reader is left, so no file is busy any longer */
+    for (act_obj_t *act = readerPool.head; act != NULL; act = act->rdNext) act->rdState = RDSTATE_IDLE;
+    readerPool.head = readerPool.tail = NULL;
+    readerPool.nThrds = 0;
+}
+
+/* cancel cleanup handler of the input thread: the readers must not outlive
+ * it, but waiting for them could hang the cancel, so they are cancelled, too
+ */
+static void readerPoolCancelCleanup(void __attribute__((unused)) * arg) {
+    if (readerPool.nThrds == 0) return;
+    readerPoolSignalStop();
+    readerPoolJoin(1);
+}
+
+/* Stop the readers. Files still queued are left alone: act_obj_destroy()
+ * reads what is left of each file on the input thread. If the input thread
+ * is cancelled while waiting for the readers, they are cancelled as well.
+ */
+static void readerPoolStop(void) {
+    if (readerPool.nThrds == 0) return;
+    readerPoolSignalStop();
+    pthread_cleanup_push(readerPoolCancelCleanup, NULL);
+    readerPoolJoin(0);
+    pthread_cleanup_pop(0);
+}
+#endif /* #if defined(HAVE_INOTIFY_INIT) */
+
 
 /* create input instance, set default parameters, and
  * add it to the list of instances.
@@ -2373,6 +2630,7 @@ BEGINbeginCnfLoad
     loadModConf->maxiNotifyWatches = 0; /* default: no limit */
     loadModConf->inotifyFallbackInterval = DFLT_INOTIFY_FALLBACK_INTERVAL;
     loadModConf->bInotifyLimitHit = 0;
+    loadModConf->readerThreads = 0;
     loadModConf->normalizePath = 1;
     loadModConf->sortFiles = GLOB_NOSORT;
     loadModConf->stateFileDirectory = NULL;
@@ -2433,6 +2691,8 @@ BEGINsetModCnf
             loadModConf->maxiNotifyWatches = (int)pvals[i].val.d.n;
         } else if (!strcmp(modpblk.descr[i].name, "inotifyfallbackinterval")) {
             loadModConf->inotifyFallbackInterval = (int)pvals[i].val.d.n;
+        } else if (!strcmp(modpblk.descr[i].name, "readerthreads")) {
+            loadModConf->readerThreads = (int)pvals[i].val.d.n;
         } else if (!strcmp(modpblk.descr[i].name, "sortfiles")) {
             loadModConf->sortFiles = ((sbool)pvals[i].val.d.n) ? 0 : GLOB_NOSORT;
         } else if (!strcmp(modpblk.descr[i].name, "statefile.directory")) {
@@ -2692,7 +2952,7 @@ static void ATTR_NONNULL(1) in_dbg_showEv(const struct inotify_event *ev) {
 static void ATTR_NONNULL(1, 2) in_handleFileEvent(struct inotify_event *ev, const wd_map_t *const etry) {
     if (ev->mask & IN_FILE_UPDATE_EVENTS) {
         DBGPRINTF("fs_node_notify_file_update: act->name '%s'\n", etry->act->name);
-        pollFile(etry->act);
+        pollFileAsync(etry->act);
     } else {
         DBGPRINTF("got non-expected inotify event:\n");
         in_dbg_showEv(ev);
@@ -2784,6 +3044,8 @@ static rsRetVal do_inotify(void) {
     }
     DBGPRINTF("inotify fd %d\n", ino_fd);
 
+    readerPoolStart(runModConf->readerThreads);
+    pthread_cleanup_push(readerPoolCancelCleanup, NULL);
     do_initial_poll_run();
     bSignaledReady = 1;
 
@@ -2906,8 +3168,10 @@ static rsRetVal do_inotify(void) {
             }
         }
     }
+    pthread_cleanup_pop(0); /* readerPoolStop() below */
 
 finalize_it:
+    readerPoolStop();
     if (!bSignaledReady) rsconfSignalReady();
     if (ino_fd >= 0) {
         close(ino_fd);
@@ -177,6 +177,7 @@ struct instanceConf_s {
     int iKeepAliveProbes;
     int iKeepAliveTime;
     unsigned starvationMaxReads;
+    sbool bZeroCopyFraming;
     int compressionMode;
     int compressionDriver;
     uint64_t compressionMaxExpansionRatio;
@@ -227,6 +228,7 @@ struct modConfData_s {
     sbool configSetViaV2Method;
     sbool bPreserveCase; /* preserve case of fromhost; true by default */
     unsigned starvationMaxReads;
+    sbool bZeroCopyFraming;
     int compressionMode;
     int compressionDriver;
     uint64_t compressionMaxExpansionRatio;
@@ -252,6 +254,7 @@ static struct cnfparamdescr modpdescr[] = {{"flowcontrol", eCmdHdlrBinary, 0},
                                            {"maxlisteners", eCmdHdlrPositiveInt, 0},
                                            {"workerthreads", eCmdHdlrPositiveInt, 0},
                                            {"starvationprotection.maxreads", eCmdHdlrNonNegInt, 0},
+                                           {"framing.zerocopy", eCmdHdlrBinary, 0},
                                            {"streamdriver.mode", eCmdHdlrNonNegInt, 0},
                                            {"streamdriver.authmode", eCmdHdlrString, 0},
                                            {"streamdriver.permitexpiredcerts", eCmdHdlrString, 0},
@@ -299,6 +302,7 @@ static struct cnfparamdescr inppdescr[] = {{"port", eCmdHdlrString, CNFPARAM_REQ
                                            {"defaulttz", eCmdHdlrString, 0},
                                            {"ruleset", eCmdHdlrString, 0},
                                            {"starvationprotection.maxreads", eCmdHdlrNonNegInt, 0},
+                                           {"framing.zerocopy", eCmdHdlrBinary, 0},
                                            {"streamdriver.mode", eCmdHdlrNonNegInt, 0},
                                            {"streamdriver.authmode", eCmdHdlrString, 0},
                                            {"streamdriver.permitexpiredcerts", eCmdHdlrString, 0},
@@ -662,6 +666,7 @@ static rsRetVal createInstance(instanceConf_t **pinst) {
     inst->iTCPSessMax = loadModConf->iTCPSessMax;
     inst->numWrkr = loadModConf->numWrkr;
     inst->starvationMaxReads = loadModConf->starvationMaxReads;
+    inst->bZeroCopyFraming = loadModConf->bZeroCopyFraming;
     inst->compressionMode = loadModConf->compressionMode;
     inst->compressionDriver = loadModConf->compressionDriver;
     inst->compressionMaxExpansionRatio = loadModConf->compressionMaxExpansionRatio;
@@ -743,6 +748,7 @@ static rsRetVal addInstance(void __attribute__((unused)) * pVal, uchar *pNewVal)
     inst->iTCPSessMax = cs.iTCPSessMax;
     inst->numWrkr = DEFAULT_NUMWRKR;
     inst->starvationMaxReads = DEFAULT_STARVATIONMAXREADS;
+    inst->bZeroCopyFraming = 0;
     inst->compressionMode = cs.compressionMode;
     inst->compressionDriver = cs.compressionDriver;
     inst->compressionMaxExpansionRatio = cs.compressionMaxExpansionRatio;
@@ -777,6 +783,7 @@ static rsRetVal addListner(modConfData_t *modConf, instanceConf_t *inst) {
     /* params */
     CHKiRet(tcpsrv.SetNumWrkr(pOurTcpsrv, inst->numWrkr));
     CHKiRet(tcpsrv.SetStarvationMaxReads(pOurTcpsrv, inst->starvationMaxReads));
+    CHKiRet(tcpsrv.SetZeroCopyFraming(pOurTcpsrv, inst->bZeroCopyFraming));
     CHKiRet(tcpsrv.SetKeepAlive(pOurTcpsrv, inst->bKeepAlive));
     CHKiRet(tcpsrv.SetKeepAliveIntvl(pOurTcpsrv, inst->iKeepAliveIntvl));
     CHKiRet(tcpsrv.SetKeepAliveProbes(pOurTcpsrv, inst->iKeepAliveProbes));
@@ -961,6 +968,8 @@ BEGINnewInpInst
             CHKmalloc(inst->pszStrmDrvrName = (uchar *)es_str2cstr(pvals[i].val.d.estr, NULL));
         } else if (!strcmp(inppblk.descr[i].name, "starvationprotection.maxreads")) {
             inst->starvationMaxReads = (unsigned)pvals[i].val.d.n;
+        } else if (!strcmp(inppblk.descr[i].name, "framing.zerocopy")) {
+            inst->bZeroCopyFraming = (sbool)pvals[i].val.d.n;
         } else if (!strcmp(inppblk.descr[i].name, "gnutlsprioritystring")) {
             CHKmalloc(inst->gnutlsPriorityString = (uchar *)es_str2cstr(pvals[i].val.d.estr, NULL));
         } else if (!strcmp(inppblk.descr[i].name, "permittedpeer")) {
@@ -1084,6 +1093,7 @@ BEGINbeginCnfLoad
     loadModConf->iTCPLstnMax = 20;
     loadModConf->numWrkr = DEFAULT_NUMWRKR;
     loadModConf->starvationMaxReads = DEFAULT_STARVATIONMAXREADS;
+    loadModConf->bZeroCopyFraming = 0;
     loadModConf->bSuppOctetFram = 1;
     loadModConf->iStrmDrvrMode = 0;
     loadModConf->bStrmDrvrModeSet = 0;
@@ -1170,6 +1180,8 @@ BEGINsetModCnf
             loadModConf->iTCPSessMax = (int)pvals[i].val.d.n;
         } else if (!strcmp(modpblk.descr[i].name, "starvationprotection.maxreads")) {
             loadModConf->starvationMaxReads = (unsigned)pvals[i].val.d.n;
+        } else if (!strcmp(modpblk.descr[i].name, "framing.zerocopy")) {
+            loadModConf->bZeroCopyFraming = (sbool)pvals[i].val.d.n;
         } else if (!strcmp(modpblk.descr[i].name, "maxlisteners") ||
                    !strcmp(modpblk.descr[i].name, "maxlistners")) { /* keep old name for a while */
             loadModConf->iTCPLstnMax = (int)pvals[i].val.d.n;
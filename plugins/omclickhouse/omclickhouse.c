@@ -51,18 +51,21 @@
 #include "obj-types.h"
 #include "ratelimit.h"
 #include "ruleset.h"
+#include "httppipe.h"
 
 #ifndef O_LARGEFILE
     #define O_LARGEFILE 0
 #endif
 
+#define MAX_PIPELINE_INFLIGHT 256 /* upper bound for pipeline.maxinflight */
+
 MODULE_TYPE_OUTPUT;
 MODULE_TYPE_NOKEEP;
 MODULE_CNFNAME("omclickhouse")
 
 /* internal structures */
 DEF_OMOD_STATIC_DATA;
-DEFobjCurrIf(statsobj) DEFobjCurrIf(prop) DEFobjCurrIf(ruleset)
+DEFobjCurrIf(statsobj) DEFobjCurrIf(prop) DEFobjCurrIf(ruleset) DEFobjCurrIf(httppipe)
 
     statsobj_t *indexStats;
 STATSCOUNTER_DEF(indexSubmit, mutIndexSubmit)
@@ -89,6 +92,7 @@ typedef struct instanceConf_s {
     uchar *errorFile;
     sbool bulkmode;
     size_t maxbytes;
+    int pipelineMaxInFlight; /* max concurrent bulk requests per worker, 1 = sequential */
     uchar *caCertFile;
     uchar *myCertFile;
     uchar *myPrivKeyFile;
@@ -101,6 +105,17 @@ struct modConfData_s {
 };
 static modConfData_t *loadModConf = NULL; /* modConf ptr to use for the current load process */
 
+/* One bulk request of the pipelined transport (pipeline.maxinflight > 1),
+ * kept until its response has been evaluated.
+ */
+typedef struct pipelineSlot_s {
+    uchar *reqmsg; /* the request body, owned by the slot */
+    int nmemb; /* number of messages in the request */
+    int replyLen;
+    char *reply;
+    char errbuf[CURL_ERROR_SIZE];
+} pipelineSlot_t;
+
 typedef struct wrkrInstanceData {
     PTR_ASSERT_DEF
     instanceData *pData;
@@ -115,6 +130,11 @@ typedef struct wrkrInstanceData {
         int nmemb; /* number of messages in batch (for statistics counting) */
     } batch;
     sbool insertErrorSent; /* needed for insert error message */
+    struct {
+        httppipe_t *pipe; /* drives the slots' transfers */
+        pipelineSlot_t *slots;
+        int nSlots; /* 0 if pipelining is off */
+    } pipeline;
 } wrkrInstanceData_t;
 
 /* tables for interfacing with the v6 config system */
@@ -132,6 +152,7 @@ static struct cnfparamdescr actpdescr[] = {{"server", eCmdHdlrGetWord, 0},
                                            {"errorfile", eCmdHdlrGetWord, 0},
                                            {"bulkmode", eCmdHdlrBinary, 0},
                                            {"maxbytes", eCmdHdlrSize, 0},
+                                           {"pipeline.maxinflight", eCmdHdlrPositiveInt, 0},
                                            {"tls.cacert", eCmdHdlrString, 0},
                                            {"tls.mycert", eCmdHdlrString, 0},
                                            {"tls.myprivkey", eCmdHdlrString, 0}};
@@ -162,8 +183,16 @@ BEGINcreateWrkrInstance
         }
     }
     pWrkrData->insertErrorSent = 0;
+    pWrkrData->pipeline.pipe = NULL;
+    pWrkrData->pipeline.slots = NULL;
+    pWrkrData->pipeline.nSlots = 0;
+    if (pData->bulkmode && pData->pipelineMaxInFlight > 1) {
+        CHKmalloc(pWrkrData->pipeline.slots = calloc((size_t)pData->pipelineMaxInFlight, sizeof(pipelineSlot_t)));
+        pWrkrData->pipeline.nSlots = pData->pipelineMaxInFlight;
+    }
 
     iRet = curlSetup(pWrkrData);
+finalize_it:
 ENDcreateWrkrInstance
 
 BEGINisCompatibleWithFeature
@@ -204,6 +233,8 @@ BEGINfreeWrkrInstance
         pWrkrData->restURL = NULL;
     }
     es_deleteStr(pWrkrData->batch.data);
+    httppipe.Destruct(&pWrkrData->pipeline.pipe);
+    free(pWrkrData->pipeline.slots);
 ENDfreeWrkrInstance
 
 BEGINdbgPrintInstInfo
@@ -222,6 +253,7 @@ BEGINdbgPrintInstInfo
     dbgprintf("\terrorFile='%s'\n", pData->errorFile);
     dbgprintf("\tbulkmode='%d'\n", pData->bulkmode);
     dbgprintf("\tmaxbytes='%zu'\n", pData->maxbytes);
+    dbgprintf("\tpipeline.maxinflight=%d\n", pData->pipelineMaxInFlight);
     dbgprintf("\ttls.cacert='%s'\n", pData->caCertFile);
     dbgprintf("\ttls.mycert='%s'\n", pData->myCertFile);
     dbgprintf("\ttls.myprivkey='%s'\n", pData->myPrivKeyFile);
@@ -307,10 +339,11 @@ finalize_it:
  * Note: we open the file but never close it before exit. If it
  * needs to be closed, HUP must be sent.
  */
-static rsRetVal ATTR_NONNULL() writeDataError(wrkrInstanceData_t *const pWrkrData, uchar *const reqmsg) {
+static rsRetVal ATTR_NONNULL() writeDataError(wrkrInstanceData_t *const pWrkrData,
+                                              const char *const reply,
+                                              uchar *const reqmsg) {
     DEFiRet;
     instanceData *pData = pWrkrData->pData;
-    const char *const reply = pWrkrData->reply == NULL ? "" : pWrkrData->reply;
     char *rendered = NULL;
     size_t toWrite;
     ssize_t wrRet;
@@ -358,10 +391,11 @@ finalize_it:
 }
 
 
-static rsRetVal checkResult(wrkrInstanceData_t *pWrkrData, uchar *reqmsg, const long httpStatus) {
-    const char *const reply = pWrkrData->reply == NULL ? "" : pWrkrData->reply;
+static rsRetVal checkResult(wrkrInstanceData_t *pWrkrData, const char *reply, uchar *reqmsg, const long httpStatus) {
     DEFiRet;
 
+    if (reply == NULL) reply = "";
+
     if (httpStatus >= 400 || strstr(reply, " = DB::Exception") != NULL || strstr(reply, "DB::NetException") != NULL ||
         strstr(reply, "DB::ParsingException") != NULL) {
         dbgprintf("omclickhouse: action failed with HTTP status %ld and reply: %s\n", httpStatus, reply);
@@ -372,7 +406,7 @@ static rsRetVal checkResult(wrkrInstanceData_t *pWrkrData, uchar *reqmsg, const
         STATSCOUNTER_INC(indexFail, mutIndexFail);
         LogError(0, RS_RET_DATAFAIL, "omclickhouse: ClickHouse request failed with HTTP status %ld: %s", httpStatus,
                  reply);
-        writeDataError(pWrkrData, reqmsg);
+        writeDataError(pWrkrData, reply, reqmsg);
         iRet = RS_RET_OK; /* we have handled the problem! */
     }
 
@@ -457,34 +491,40 @@ static void ATTR_NONNULL() initializeBatch(wrkrInstanceData_t *pWrkrData) {
 }
 
 
-static rsRetVal ATTR_NONNULL(1, 2)
-    curlPost(wrkrInstanceData_t *pWrkrData, uchar *message, int msglen, const int nmsgs) {
-    CURLcode code;
-    CURL *const curl = pWrkrData->curlPostHandle;
-    char errbuf[CURL_ERROR_SIZE] = "";
-    long httpStatus = 0;
+/* ClickHouse only accepts INSERT queries from us; complain once if a
+ * template produces anything else
+ */
+static rsRetVal ATTR_NONNULL() checkInsertQuery(wrkrInstanceData_t *const pWrkrData,
+                                                const uchar *const message,
+                                                const int nmsgs) {
     DEFiRet;
 
-    if (!strstr((char *)message, "INSERT INTO") && !pWrkrData->insertErrorSent) {
+    if (!strstr((const char *)message, "INSERT INTO") && !pWrkrData->insertErrorSent) {
         indexHTTPFail += nmsgs;
         LogError(0, RS_RET_ERR,
                  "omclickhouse: Message is no Insert query: "
                  "Message suspended: %s",
-                 (char *)message);
+                 (const char *)message);
         pWrkrData->insertErrorSent = 1;
         ABORT_FINALIZE(RS_RET_ERR);
     }
 
-    pWrkrData->reply = NULL;
-    pWrkrData->replyLen = 0;
+finalize_it:
+    RETiRet;
+}
 
-    CHKiRet(setPostURL(pWrkrData));
 
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, (char *)message);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)msglen);
-    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, errbuf);
-    code = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpStatus);
+/* evaluate the outcome of a POST, both for sequential and pipelined requests */
+static rsRetVal ATTR_NONNULL(1, 3, 7) evalPostResult(wrkrInstanceData_t *const pWrkrData,
+                                                     const CURLcode code,
+                                                     const char *const errbuf,
+                                                     const long httpStatus,
+                                                     char *const reply,
+                                                     const int replyLen,
+                                                     uchar *const message,
+                                                     const int nmsgs) {
+    DEFiRet;
+
     dbgprintf("curl returned %lld\n", (long long)code);
     if (code != CURLE_OK && code != CURLE_HTTP_RETURNED_ERROR) {
         STATSCOUNTER_INC(indexHTTPReqFail, mutIndexHTTPReqFail);
@@ -496,19 +536,46 @@ static rsRetVal ATTR_NONNULL(1, 2)
         ABORT_FINALIZE(RS_RET_SUSPENDED);
     }
 
-    if (pWrkrData->reply == NULL && httpStatus < 400) {
-        dbgprintf("omclickhouse: pWrkrData reply==NULL, replyLen = '%d'\n", pWrkrData->replyLen);
+    if (reply == NULL && httpStatus < 400) {
+        dbgprintf("omclickhouse: pWrkrData reply==NULL, replyLen = '%d'\n", replyLen);
         STATSCOUNTER_INC(indexSuccess, mutIndexSuccess);
     } else {
-        dbgprintf("omclickhouse: pWrkrData replyLen = '%d'\n", pWrkrData->replyLen);
-        if (pWrkrData->reply != NULL && pWrkrData->replyLen > 0) {
-            pWrkrData->reply[pWrkrData->replyLen] = '\0';
+        dbgprintf("omclickhouse: pWrkrData replyLen = '%d'\n", replyLen);
+        if (reply != NULL && replyLen > 0) {
+            reply[replyLen] = '\0';
             /* Append 0 Byte if replyLen is above 0 - byte has been reserved in malloc */
         }
-        dbgprintf("omclickhouse: pWrkrData reply: '%s'\n", pWrkrData->reply == NULL ? "" : pWrkrData->reply);
-        CHKiRet(checkResult(pWrkrData, message, httpStatus));
+        dbgprintf("omclickhouse: pWrkrData reply: '%s'\n", reply == NULL ? "" : reply);
+        CHKiRet(checkResult(pWrkrData, reply, message, httpStatus));
     }
 
+finalize_it:
+    RETiRet;
+}
+
+
+static rsRetVal ATTR_NONNULL(1, 2)
+    curlPost(wrkrInstanceData_t *pWrkrData, uchar *message, int msglen, const int nmsgs) {
+    CURLcode code;
+    CURL *const curl = pWrkrData->curlPostHandle;
+    char errbuf[CURL_ERROR_SIZE] = "";
+    long httpStatus = 0;
+    DEFiRet;
+
+    CHKiRet(checkInsertQuery(pWrkrData, message, nmsgs));
+
+    pWrkrData->reply = NULL;
+    pWrkrData->replyLen = 0;
+
+    CHKiRet(setPostURL(pWrkrData));
+
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, (char *)message);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)msglen);
+    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, errbuf);
+    code = curl_easy_perform(curl);
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpStatus);
+    CHKiRet(evalPostResult(pWrkrData, code, errbuf, httpStatus, pWrkrData->reply, pWrkrData->replyLen, message, nmsgs));
+
 finalize_it:
     free(pWrkrData->reply);
     pWrkrData->reply = NULL; /* don't leave dangling pointer */
@@ -516,6 +583,97 @@ finalize_it:
 }
 
 
+/* Pipelined transport (pipeline.maxinflight > 1, bulk mode only)
+ *
+ * The bulk requests a transaction is split into by maxbytes are handed to
+ * the shared httppipe object instead of being sent one after the other.
+ * Responses are evaluated by evalPostResult() as they arrive. endTransaction()
+ * only returns once all of them are in, and returns the first failure, so
+ * the core still retries the whole transaction.
+ */
+
+static void ATTR_NONNULL() pipelineReleaseSlot(pipelineSlot_t *const slot) {
+    free(slot->reqmsg);
+    slot->reqmsg = NULL;
+    free(slot->reply);
+    slot->reply = NULL;
+    slot->replyLen = 0;
+    slot->nmemb = 0;
+}
+
+/* httppipe done callback */
+static rsRetVal pipelineComplete(void *const pUsr, const int iSlot, CURL *const handle, const CURLcode code) {
+    wrkrInstanceData_t *const pWrkrData = (wrkrInstanceData_t *)pUsr;
+    pipelineSlot_t *const slot = &pWrkrData->pipeline.slots[iSlot];
+    long httpStatus = 0;
+    rsRetVal localRet;
+
+    curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &httpStatus);
+    localRet = evalPostResult(pWrkrData, code, slot->errbuf, httpStatus, slot->reply, slot->replyLen, slot->reqmsg,
+                              slot->nmemb);
+    pipelineReleaseSlot(slot);
+    return localRet;
+}
+
+/* httppipe abandon callback: the request is retried with the transaction */
+static void pipelineAbandon(void *const pUsr, const int iSlot) {
+    wrkrInstanceData_t *const pWrkrData = (wrkrInstanceData_t *)pUsr;
+    pipelineReleaseSlot(&pWrkrData->pipeline.slots[iSlot]);
+}
+
+/* POST result string of a pipelined request */
+static size_t pipelineResult(void *ptr, size_t size, size_t nmemb, void *userdata) {
+    pipelineSlot_t *const slot = (pipelineSlot_t *)userdata;
+    char *buf;
+    size_t newlen;
+    newlen = slot->replyLen + size * nmemb;
+    if ((buf = realloc(slot->reply, newlen + 1)) == NULL) {
+        LogError(errno, RS_RET_ERR, "omclickhouse: realloc failed in pipelineResult");
+        return 0; /* abort due to failure */
+    }
+    memcpy(buf + slot->replyLen, ptr, size * nmemb);
+    slot->replyLen = newlen;
+    slot->reply = buf;
+    return size * nmemb;
+}
+
+/* Start a POST of message on the pipeline, waiting for a free slot first.
+ * The pipeline takes ownership of message. Returns the first failure of the
+ * transaction so far, if any, so that the caller stops producing requests.
+ */
+static rsRetVal ATTR_NONNULL() pipelinePost(wrkrInstanceData_t *const pWrkrData, uchar *const message, const int nmsgs) {
+    httppipe_t *const pPipe = pWrkrData->pipeline.pipe;
+    pipelineSlot_t *slot;
+    CURL *handle;
+    sbool bStarted = 0;
+    int iSlot;
+    DEFiRet;
+
+    CHKiRet(httppipe.Wait(pPipe, pWrkrData->pipeline.nSlots));
+    CHKiRet(checkInsertQuery(pWrkrData, message, nmsgs));
+    CHKiRet(setPostURL(pWrkrData));
+
+    CHKiRet(httppipe.GetFreeSlot(pPipe, &iSlot));
+    slot = &pWrkrData->pipeline.slots[iSlot];
+    slot->errbuf[0] = '\0';
+    handle = httppipe.GetHandle(pPipe, iSlot);
+    curl_easy_setopt(handle, CURLOPT_URL, pWrkrData->restURL);
+    curl_easy_setopt(handle, CURLOPT_POSTFIELDS, (char *)message);
+    curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE, (long)strlen((char *)message));
+    CHKiRet(httppipe.Start(pPipe, iSlot));
+    slot->reqmsg = message;
+    slot->nmemb = nmsgs;
+    bStarted = 1;
+
+    /* get the request on the wire right away */
+    CHKiRet(httppipe.Wait(pPipe, pWrkrData->pipeline.nSlots));
+
+finalize_it:
+    if (!bStarted) free(message);
+    RETiRet;
+}
+
+
 static rsRetVal submitBatch(wrkrInstanceData_t *pWrkrData) {
     char *cstr = NULL;
     DEFiRet;
@@ -523,6 +681,12 @@ static rsRetVal submitBatch(wrkrInstanceData_t *pWrkrData) {
     cstr = es_str2cstr(pWrkrData->batch.data, NULL);
     dbgprintf("omclickhouse: submitBatch, batch: '%s'\n", cstr);
 
+    if (pWrkrData->pipeline.nSlots > 0) {
+        CHKmalloc(cstr);
+        iRet = pipelinePost(pWrkrData, (uchar *)cstr, pWrkrData->batch.nmemb);
+        cstr = NULL; /* now owned by the pipeline */
+        FINALIZE;
+    }
     CHKiRet(curlPost(pWrkrData, (uchar *)cstr, strlen(cstr), pWrkrData->batch.nmemb));
 
 finalize_it:
@@ -537,6 +701,12 @@ BEGINbeginTransaction
         FINALIZE;
     }
 
+    if (pWrkrData->pipeline.nSlots > 0) {
+        /* settle whatever an aborted transaction left in flight; it is
+         * retried as part of this one
+         */
+        (void)httppipe.Drain(pWrkrData->pipeline.pipe);
+    }
     initializeBatch(pWrkrData);
 finalize_it:
 ENDbeginTransaction
@@ -566,7 +736,9 @@ BEGINdoAction
 
         CHKiRet(buildBatch(pWrkrData, batchPart));
 
-        iRet = pWrkrData->batch.nmemb == 1 ? RS_RET_PREVIOUS_COMMITTED : RS_RET_DEFER_COMMIT;
+        /* with pipelining, the previous batch may still be in flight */
+        iRet = (pWrkrData->batch.nmemb == 1 && pWrkrData->pipeline.nSlots == 0) ? RS_RET_PREVIOUS_COMMITTED
+                                                                                   : RS_RET_DEFER_COMMIT;
     } else {
         CHKiRet(curlPost(pWrkrData, ppString[0], strlen((char *)ppString[0]), 1));
     }
@@ -585,6 +757,11 @@ BEGINendTransaction
             "nothing to send. \n");
     }
 finalize_it:
+    if (pWrkrData->pipeline.nSlots > 0) {
+        /* the transaction is only done when all of its requests are */
+        const rsRetVal drainRet = httppipe.Drain(pWrkrData->pipeline.pipe);
+        if (iRet == RS_RET_OK) iRet = drainRet;
+    }
 ENDendTransaction
 
 static void ATTR_NONNULL() setInstParamDefaults(instanceData *const pData) {
@@ -602,6 +779,7 @@ static void ATTR_NONNULL() setInstParamDefaults(instanceData *const pData) {
     pData->errorFile = NULL;
     pData->bulkmode = 1;
     pData->maxbytes = 104857600;  // 100MB
+    pData->pipelineMaxInFlight = 1;  // sequential requests
     pData->caCertFile = NULL;
     pData->myCertFile = NULL;
     pData->myPrivKeyFile = NULL;
@@ -656,25 +834,48 @@ static void ATTR_NONNULL() curlCheckConnSetup(wrkrInstanceData_t *const pWrkrDat
 }
 
 
-static void ATTR_NONNULL(1) curlPostSetup(wrkrInstanceData_t *const pWrkrData) {
-    curlSetupCommon(pWrkrData, pWrkrData->curlPostHandle);
-    curl_easy_setopt(pWrkrData->curlPostHandle, CURLOPT_POST, 1L);
+static void ATTR_NONNULL(1) curlPostSetup(wrkrInstanceData_t *const pWrkrData, CURL *const handle) {
+    curlSetupCommon(pWrkrData, handle);
+    curl_easy_setopt(handle, CURLOPT_POST, 1L);
     if (pWrkrData->pData->timeout) {
-        curl_easy_setopt(pWrkrData->curlPostHandle, CURLOPT_TIMEOUT_MS, pWrkrData->pData->timeout);
+        curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, pWrkrData->pData->timeout);
     }
 }
 
+/* create the pipelined transport and set up the easy handles of its slots */
+static rsRetVal ATTR_NONNULL() pipelineSetup(wrkrInstanceData_t *const pWrkrData) {
+    DEFiRet;
+
+    if (pWrkrData->pipeline.nSlots == 0) FINALIZE;
+
+    CHKiRet(httppipe.Construct(&pWrkrData->pipeline.pipe, pWrkrData->pipeline.nSlots, "omclickhouse",
+                               pipelineComplete, pipelineAbandon, pWrkrData));
+    for (int i = 0; i < pWrkrData->pipeline.nSlots; ++i) {
+        pipelineSlot_t *const slot = &pWrkrData->pipeline.slots[i];
+        CURL *const handle = httppipe.GetHandle(pWrkrData->pipeline.pipe, i);
+        curlPostSetup(pWrkrData, handle);
+        curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, pipelineResult);
+        curl_easy_setopt(handle, CURLOPT_WRITEDATA, slot);
+        curl_easy_setopt(handle, CURLOPT_ERRORBUFFER, slot->errbuf);
+    }
+
+finalize_it:
+    RETiRet;
+}
+
 #define CONTENT_JSON "Content-Type: application/json; charset=utf-8"
 
 static rsRetVal ATTR_NONNULL() curlSetup(wrkrInstanceData_t *const pWrkrData) {
     DEFiRet;
     pWrkrData->curlHeader = curl_slist_append(NULL, CONTENT_JSON);
     CHKmalloc(pWrkrData->curlPostHandle = curl_easy_init());
-    curlPostSetup(pWrkrData);
+    curlPostSetup(pWrkrData, pWrkrData->curlPostHandle);
 
     CHKmalloc(pWrkrData->curlCheckConnHandle = curl_easy_init());
     curlCheckConnSetup(pWrkrData);
 
+    CHKiRet(pipelineSetup(pWrkrData));
+
 finalize_it:
     if (iRet != RS_RET_OK && pWrkrData->curlPostHandle != NULL) {
         curl_easy_cleanup(pWrkrData->curlPostHandle);
@@ -804,6 +1005,13 @@ BEGINnewActInst
             pData->bulkmode = pvals[i].val.d.n;
         } else if (!strcmp(actpblk.descr[i].name, "maxbytes")) {
             pData->maxbytes = (size_t)pvals[i].val.d.n;
+        } else if (!strcmp(actpblk.descr[i].name, "pipeline.maxinflight")) {
+            pData->pipelineMaxInFlight = (int)pvals[i].val.d.n;
+            if (pData->pipelineMaxInFlight > MAX_PIPELINE_INFLIGHT) {
+                LogError(0, RS_RET_PARAM_ERROR, "omclickhouse: pipeline.maxinflight %d too large, using %d instead",
+                         pData->pipelineMaxInFlight, MAX_PIPELINE_INFLIGHT);
+                pData->pipelineMaxInFlight = MAX_PIPELINE_INFLIGHT;
+            }
         } else if (!strcmp(actpblk.descr[i].name, "tls.cacert")) {
             CHKmalloc(pData->caCertFile = (uchar *)es_str2cstr(pvals[i].val.d.estr, NULL));
             fp = fopen((const char *)pData->caCertFile, "r");
@@ -852,6 +1060,12 @@ BEGINnewActInst
                "but a password was given.");
     }
 
+    if (pData->pipelineMaxInFlight > 1 && !pData->bulkmode) {
+        LogMsg(0, RS_RET_OK, LOG_WARNING,
+               "omclickhouse: pipeline.maxinflight only applies "
+               "to bulkmode, sending requests one after the other");
+    }
+
     if (pData->user != NULL) CHKiRet(computeAuthHeader((char *)pData->user, (char *)pData->pwd, &pData->authBuf));
 
     CODE_STD_STRING_REQUESTnewActInst(1);
@@ -925,6 +1139,7 @@ BEGINmodExit
     objRelease(statsobj, CORE_COMPONENT);
     objRelease(prop, CORE_COMPONENT);
     objRelease(ruleset, CORE_COMPONENT);
+    objRelease(httppipe, LM_HTTPPIPE_FILENAME);
 ENDmodExit
 
 NO_LEGACY_CONF_parseSelectorAct
@@ -945,6 +1160,7 @@ BEGINmodInit()
     CODEmodInit_QueryRegCFSLineHdlr CHKiRet(objUse(statsobj, CORE_COMPONENT));
     CHKiRet(objUse(prop, CORE_COMPONENT));
     CHKiRet(objUse(ruleset, CORE_COMPONENT));
+    CHKiRet(objUse(httppipe, LM_HTTPPIPE_FILENAME));
 
     if (curl_global_init(CURL_GLOBAL_ALL) != 0) {
         LogError(0, RS_RET_OBJ_CREATION_FAILED, "CURL fail. -indexing disabled");
@@ -182,6 +182,7 @@ typedef struct wrkrInstanceData {
     pthread_mutex_t batch_mutex;
     int flush_thread_running;
     int flush_thread_stop;
+    omotel_pbuf_t pb_buf; /* protobuf encode buffer, reused across flushes (guarded by batch_mutex) */
 
     /* Statistics counters */
     statsobj_t *stats;
@@ -1755,8 +1756,6 @@ finalize_it:
 static rsRetVal omotel_flush_batch_locked(wrkrInstanceData_t *pWrkrData, omotel_batch_state_t *batch) {
     omotel_log_record_t *records = NULL;
     char *payload = NULL;
-    uint8_t *pb_payload = NULL;
-    size_t pb_payload_len = 0u;
     uint8_t *compressed = NULL;
     const uint8_t *to_send;
     size_t send_len = 0u;
@@ -1809,11 +1808,11 @@ static rsRetVal omotel_flush_batch_locked(wrkrInstanceData_t *pWrkrData, omotel_
     use_protobuf = pWrkrData->pData->protocol != NULL && !strcmp((char *)pWrkrData->pData->protocol, "http/protobuf");
 
     if (use_protobuf) {
-        CHKiRet(omotel_protobuf_build_export(records, batch->count, &resource_attrs, &pWrkrData->pData->attributeMap,
-                                             &pb_payload, &pb_payload_len));
-        to_send = pb_payload;
-        send_len = pb_payload_len;
-        DBGPRINTF("omotel: omotel_flush_batch: protobuf payload length=%zu", pb_payload_len);
+        CHKiRet(omotel_protobuf_encode_export(records, batch->count, &resource_attrs, &pWrkrData->pData->attributeMap,
+                                              &pWrkrData->pb_buf));
+        to_send = pWrkrData->pb_buf.data;
+        send_len = pWrkrData->pb_buf.len;
+        DBGPRINTF("omotel: omotel_flush_batch: protobuf payload length=%zu", send_len);
     } else {
         CHKiRet(omotel_json_build_export(records, batch->count, &resource_attrs, &pWrkrData->pData->attributeMap,
                                          &payload));
@@ -1908,7 +1907,6 @@ static rsRetVal omotel_flush_batch_locked(wrkrInstanceData_t *pWrkrData, omotel_
 finalize_it:
     free(records);
     free(payload);
-    free(pb_payload);
     free(compressed);
     RETiRet;
 }
@@ -2245,6 +2243,7 @@ BEGINcreateWrkrInstance
     pWrkrData->batch.first_enqueue_ms = 0;
     pWrkrData->flush_thread_running = 0;
     pWrkrData->flush_thread_stop = 0;
+    omotel_pbuf_init(&pWrkrData->pb_buf);
     pWrkrData->stats = NULL;
     pthread_mutex_init(&pWrkrData->batch_mutex, NULL);
 
@@ -2404,6 +2403,7 @@ BEGINfreeWrkrInstance
         }
         (void)omotel_flush_batch(pWrkrData);
         omotel_batch_destroy(&pWrkrData->batch);
+        omotel_pbuf_free(&pWrkrData->pb_buf);
         pthread_mutex_destroy(&pWrkrData->batch_mutex);
         omotel_http_client_destroy(&pWrkrData->http_client);
         if (pWrkrData->stats != NULL) {
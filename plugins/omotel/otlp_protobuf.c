@@ -28,6 +28,7 @@
 
 #include "otlp_protobuf.h"
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -651,3 +652,415 @@ finalize_it:
     }
     RETiRet;
 }
+
+/* --- Streaming wire encoder ---
+ *
+ * The functions below write the protobuf wire format directly into an
+ * omotel_pbuf_t. They follow the field order and the proto3 default-value
+ * rules protobuf-c applies when packing the tree built above, so both paths
+ * produce identical bytes: scalar and string fields holding their default
+ * are omitted, while a oneof member (AnyValue) is always written once set.
+ *
+ * Nested messages are opened with a one-byte length placeholder. When the
+ * message is closed and its length needs a longer varint, the body is moved
+ * up to make room. Only records and the two outer containers are ever longer
+ * than 127 bytes, so this costs far less than sizing the message twice.
+ */
+
+#define PB_WIRE_VARINT 0
+#define PB_WIRE_I64 1
+#define PB_WIRE_LEN 2
+#define PB_WIRE_I32 5
+
+#define PB_VARINT_MAX 10
+#define PB_MIN_CAPACITY 4096
+
+/* attribute names for the per-record syslog fields, resolved once per batch */
+typedef struct {
+    const char *hostname;
+    const char *appname;
+    const char *procid;
+    const char *msgid;
+    const char *facility;
+} pb_attr_names_t;
+
+void omotel_pbuf_init(omotel_pbuf_t *buf) {
+    buf->data = NULL;
+    buf->len = 0;
+    buf->capacity = 0;
+}
+
+void omotel_pbuf_free(omotel_pbuf_t *buf) {
+    free(buf->data);
+    omotel_pbuf_init(buf);
+}
+
+static rsRetVal pb_reserve(omotel_pbuf_t *buf, size_t need) {
+    uint8_t *tmp;
+    size_t new_cap;
+    DEFiRet;
+
+    if (buf->capacity - buf->len >= need) {
+        FINALIZE;
+    }
+    new_cap = (buf->capacity == 0) ? PB_MIN_CAPACITY : buf->capacity;
+    while (new_cap - buf->len < need) {
+        if (new_cap > SIZE_MAX / 2) {
+            ABORT_FINALIZE(RS_RET_OUT_OF_MEMORY);
+        }
+        new_cap *= 2;
+    }
+    CHKmalloc(tmp = realloc(buf->data, new_cap));
+    buf->data = tmp;
+    buf->capacity = new_cap;
+
+finalize_it:
+    RETiRet;
+}
+
+static size_t pb_varint_size(uint64_t value) {
+    size_t n = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++n;
+    }
+    return n;
+}
+
+/* caller guarantees PB_VARINT_MAX bytes of space at out */
+static size_t pb_write_varint(uint8_t *out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static rsRetVal pb_put_varint(omotel_pbuf_t *buf, unsigned field, uint64_t value) {
+    DEFiRet;
+    CHKiRet(pb_reserve(buf, 2 * PB_VARINT_MAX));
+    buf->len += pb_write_varint(buf->data + buf->len, ((uint64_t)field << 3) | PB_WIRE_VARINT);
+    buf->len += pb_write_varint(buf->data + buf->len, value);
+finalize_it:
+    RETiRet;
+}
+
+static rsRetVal pb_put_fixed(omotel_pbuf_t *buf, unsigned field, unsigned wire_type, uint64_t value) {
+    const size_t width = (wire_type == PB_WIRE_I64) ? 8 : 4;
+    size_t i;
+    DEFiRet;
+
+    CHKiRet(pb_reserve(buf, PB_VARINT_MAX + width));
+    buf->len += pb_write_varint(buf->data + buf->len, ((uint64_t)field << 3) | wire_type);
+    for (i = 0; i < width; ++i) { /* little endian regardless of host order */
+        buf->data[buf->len++] = (uint8_t)(value >> (8 * i));
+    }
+finalize_it:
+    RETiRet;
+}
+
+/* length-delimited field, always written (also used for oneof strings) */
+static rsRetVal pb_put_bytes(omotel_pbuf_t *buf, unsigned field, const void *data, size_t len) {
+    DEFiRet;
+    CHKiRet(pb_reserve(buf, 2 * PB_VARINT_MAX + len));
+    buf->len += pb_write_varint(buf->data + buf->len, ((uint64_t)field << 3) | PB_WIRE_LEN);
+    buf->len += pb_write_varint(buf->data + buf->len, len);
+    if (len > 0) {
+        memcpy(buf->data + buf->len, data, len);
+        buf->len += len;
+    }
+finalize_it:
+    RETiRet;
+}
+
+/* proto3 string field: omitted when NULL or empty */
+static rsRetVal pb_put_string(omotel_pbuf_t *buf, unsigned field, const char *value) {
+    DEFiRet;
+    if (value != NULL && value[0] != '\0') {
+        CHKiRet(pb_put_bytes(buf, field, value, strlen(value)));
+    }
+finalize_it:
+    RETiRet;
+}
+
+/**
+ * @brief Start a nested message; @p mark receives the offset of its body
+ */
+static rsRetVal pb_open(omotel_pbuf_t *buf, unsigned field, size_t *mark) {
+    DEFiRet;
+    CHKiRet(pb_reserve(buf, PB_VARINT_MAX + 1));
+    buf->len += pb_write_varint(buf->data + buf->len, ((uint64_t)field << 3) | PB_WIRE_LEN);
+    buf->data[buf->len++] = 0; /* length placeholder */
+    *mark = buf->len;
+finalize_it:
+    RETiRet;
+}
+
+/**
+ * @brief Finish a nested message by back-patching its length prefix
+ */
+static rsRetVal pb_close(omotel_pbuf_t *buf, size_t mark) {
+    const size_t body_len = buf->len - mark;
+    const size_t prefix_len = pb_varint_size(body_len);
+    DEFiRet;
+
+    if (prefix_len > 1) {
+        CHKiRet(pb_reserve(buf, prefix_len - 1));
+        memmove(buf->data + mark + prefix_len - 1, buf->data + mark, body_len);
+        buf->len += prefix_len - 1;
+    }
+    pb_write_varint(buf->data + mark - 1, body_len);
+finalize_it:
+    RETiRet;
+}
+
+/* KeyValue framing; the caller writes exactly one AnyValue member in between */
+static rsRetVal pb_kv_begin(omotel_pbuf_t *buf, unsigned field, const char *key, size_t marks[2]) {
+    DEFiRet;
+    CHKiRet(pb_open(buf, field, &marks[0]));
+    CHKiRet(pb_put_string(buf, 1, key)); /* KeyValue.key */
+    CHKiRet(pb_open(buf, 2, &marks[1])); /* KeyValue.value */
+finalize_it:
+    RETiRet;
+}
+
+static rsRetVal pb_kv_end(omotel_pbuf_t *buf, const size_t marks[2]) {
+    DEFiRet;
+    CHKiRet(pb_close(buf, marks[1]));
+    CHKiRet(pb_close(buf, marks[0]));
+finalize_it:
+    RETiRet;
+}
+
+static rsRetVal pb_put_kv_string(omotel_pbuf_t *buf, unsigned field, const char *key, const char *value) {
+    size_t marks[2];
+    DEFiRet;
+    CHKiRet(pb_kv_begin(buf, field, key, marks));
+    CHKiRet(pb_put_bytes(buf, 1, value, strlen(value))); /* AnyValue.string_value */
+    CHKiRet(pb_kv_end(buf, marks));
+finalize_it:
+    RETiRet;
+}
+
+static rsRetVal pb_put_kv_int(omotel_pbuf_t *buf, unsigned field, const char *key, int64_t value) {
+    size_t marks[2];
+    DEFiRet;
+    CHKiRet(pb_kv_begin(buf, field, key, marks));
+    CHKiRet(pb_put_varint(buf, 3, (uint64_t)value)); /* AnyValue.int_value */
+    CHKiRet(pb_kv_end(buf, marks));
+finalize_it:
+    RETiRet;
+}
+
+static rsRetVal pb_put_kv_double(omotel_pbuf_t *buf, unsigned field, const char *key, double value) {
+    size_t marks[2];
+    uint64_t bits;
+    DEFiRet;
+    memcpy(&bits, &value, sizeof(bits));
+    CHKiRet(pb_kv_begin(buf, field, key, marks));
+    CHKiRet(pb_put_fixed(buf, 4, PB_WIRE_I64, bits)); /* AnyValue.double_value */
+    CHKiRet(pb_kv_end(buf, marks));
+finalize_it:
+    RETiRet;
+}
+
+static rsRetVal pb_put_kv_bool(omotel_pbuf_t *buf, unsigned field, const char *key, int value) {
+    size_t marks[2];
+    DEFiRet;
+    CHKiRet(pb_kv_begin(buf, field, key, marks));
+    CHKiRet(pb_put_varint(buf, 2, value ? 1 : 0)); /* AnyValue.bool_value */
+    CHKiRet(pb_kv_end(buf, marks));
+finalize_it:
+    RETiRet;
+}
+
+/**
+ * @brief Encode the Resource message (ResourceLogs.resource)
+ */
+static rsRetVal pb_put_resource(omotel_pbuf_t *buf,
+                                const omotel_log_record_t *records,
+                                size_t record_count,
+                                const omotel_resource_attrs_t *resource_attrs) {
+    size_t mark;
+    size_t i;
+    DEFiRet;
+
+    CHKiRet(pb_open(buf, 1, &mark));
+    CHKiRet(pb_put_kv_string(buf, 1, "service.name", "rsyslog"));
+    CHKiRet(pb_put_kv_string(buf, 1, "telemetry.sdk.name", "rsyslog-omotel"));
+    CHKiRet(pb_put_kv_string(buf, 1, "telemetry.sdk.language", "C"));
+    CHKiRet(pb_put_kv_string(buf, 1, "telemetry.sdk.version", VERSION));
+
+    if (resource_attrs != NULL && resource_attrs->custom_attributes != NULL) {
+        struct json_object_iterator iter = json_object_iter_begin(resource_attrs->custom_attributes);
+        struct json_object_iterator iter_end = json_object_iter_end(resource_attrs->custom_attributes);
+
+        while (!json_object_iter_equal(&iter, &iter_end)) {
+            const char *key = json_object_iter_peek_name(&iter);
+            struct json_object *val = json_object_iter_peek_value(&iter);
+
+            if (val != NULL) {
+                switch (fjson_object_get_type(val)) {
+                    case fjson_type_string:
+                        if (fjson_object_get_string(val) != NULL && fjson_object_get_string(val)[0] != '\0') {
+                            CHKiRet(pb_put_kv_string(buf, 1, key, fjson_object_get_string(val)));
+                        }
+                        break;
+                    case fjson_type_int:
+                        CHKiRet(pb_put_kv_int(buf, 1, key, fjson_object_get_int64(val)));
+                        break;
+                    case fjson_type_double:
+                        CHKiRet(pb_put_kv_double(buf, 1, key, fjson_object_get_double(val)));
+                        break;
+                    case fjson_type_boolean:
+                        CHKiRet(pb_put_kv_bool(buf, 1, key, fjson_object_get_boolean(val)));
+                        break;
+                    case fjson_type_null:
+                    case fjson_type_object:
+                    case fjson_type_array:
+                    default:
+                        break;
+                }
+            }
+            json_object_iter_next(&iter);
+        }
+    }
+
+    if (resource_attrs != NULL) {
+        if (resource_attrs->service_instance_id != NULL && resource_attrs->service_instance_id[0] != '\0') {
+            CHKiRet(pb_put_kv_string(buf, 1, "service.instance.id", resource_attrs->service_instance_id));
+        }
+        if (resource_attrs->deployment_environment != NULL && resource_attrs->deployment_environment[0] != '\0') {
+            CHKiRet(pb_put_kv_string(buf, 1, "deployment.environment", resource_attrs->deployment_environment));
+        }
+    }
+
+    /* host.name at resource level if all records share the same hostname */
+    if (records[0].hostname != NULL && records[0].hostname[0] != '\0') {
+        for (i = 1; i < record_count; ++i) {
+            if (records[i].hostname == NULL || strcmp(records[i].hostname, records[0].hostname) != 0) {
+                break;
+            }
+        }
+        if (i == record_count) {
+            CHKiRet(pb_put_kv_string(buf, 1, "host.name", records[0].hostname));
+        }
+    }
+
+    CHKiRet(pb_close(buf, mark));
+finalize_it:
+    RETiRet;
+}
+
+/**
+ * @brief Encode one LogRecord (ScopeLogs.log_records)
+ */
+static rsRetVal pb_put_log_record(omotel_pbuf_t *buf, const omotel_log_record_t *rec, const pb_attr_names_t *names) {
+    uint8_t id[16];
+    size_t mark;
+    size_t body_mark;
+    const char *body;
+    DEFiRet;
+
+    CHKiRet(pb_open(buf, 2, &mark));
+    if (rec->time_unix_nano != 0) {
+        CHKiRet(pb_put_fixed(buf, 1, PB_WIRE_I64, rec->time_unix_nano));
+    }
+    if (rec->severity_number != 0) {
+        /* enum values are encoded like int32, negatives sign-extended */
+        CHKiRet(pb_put_varint(buf, 2, (uint64_t)(int64_t)(int32_t)rec->severity_number));
+    }
+    CHKiRet(pb_put_string(buf, 3, rec->severity_text));
+
+    body = (rec->body != NULL) ? rec->body : "";
+    CHKiRet(pb_open(buf, 5, &body_mark));
+    CHKiRet(pb_put_bytes(buf, 1, body, strlen(body)));
+    CHKiRet(pb_close(buf, body_mark));
+
+    if (rec->app_name != NULL && rec->app_name[0] != '\0') {
+        CHKiRet(pb_put_kv_string(buf, 6, names->appname, rec->app_name));
+    }
+    if (rec->proc_id != NULL && rec->proc_id[0] != '\0') {
+        CHKiRet(pb_put_kv_string(buf, 6, names->procid, rec->proc_id));
+    }
+    if (rec->msg_id != NULL && rec->msg_id[0] != '\0') {
+        CHKiRet(pb_put_kv_string(buf, 6, names->msgid, rec->msg_id));
+    }
+    CHKiRet(pb_put_kv_int(buf, 6, names->facility, (int64_t)rec->facility));
+    if (rec->hostname != NULL && rec->hostname[0] != '\0') {
+        CHKiRet(pb_put_kv_string(buf, 6, names->hostname, rec->hostname));
+    }
+
+    if (rec->trace_flags != 0) {
+        CHKiRet(pb_put_fixed(buf, 8, PB_WIRE_I32, rec->trace_flags));
+    }
+    if (rec->trace_id != NULL && strlen(rec->trace_id) == 32 && hex_decode(rec->trace_id, id, 16) == 0) {
+        CHKiRet(pb_put_bytes(buf, 9, id, 16));
+    }
+    if (rec->span_id != NULL && strlen(rec->span_id) == 16 && hex_decode(rec->span_id, id, 8) == 0) {
+        CHKiRet(pb_put_bytes(buf, 10, id, 8));
+    }
+    if (rec->observed_time_unix_nano != 0) {
+        CHKiRet(pb_put_fixed(buf, 11, PB_WIRE_I64, rec->observed_time_unix_nano));
+    }
+
+    CHKiRet(pb_close(buf, mark));
+finalize_it:
+    RETiRet;
+}
+
+rsRetVal omotel_protobuf_encode_export(const omotel_log_record_t *records,
+                                       size_t record_count,
+                                       const omotel_resource_attrs_t *resource_attrs,
+                                       const attribute_map_t *attribute_map,
+                                       omotel_pbuf_t *buf) {
+    pb_attr_names_t names = {
+        .hostname = "log.syslog.hostname",
+        .appname = "log.syslog.appname",
+        .procid = "log.syslog.procid",
+        .msgid = "log.syslog.msgid",
+        .facility = "log.syslog.facility",
+    };
+    const char *mapped;
+    size_t resource_logs_mark;
+    size_t scope_logs_mark;
+    size_t scope_mark;
+    size_t i;
+    DEFiRet;
+
+    if (buf == NULL || records == NULL || record_count == 0) {
+        ABORT_FINALIZE(RS_RET_PARAM_ERROR);
+    }
+    buf->len = 0;
+
+    if (attribute_map != NULL) {
+        if ((mapped = attribute_map_lookup(attribute_map, "hostname")) != NULL) names.hostname = mapped;
+        if ((mapped = attribute_map_lookup(attribute_map, "appname")) != NULL) names.appname = mapped;
+        if ((mapped = attribute_map_lookup(attribute_map, "procid")) != NULL) names.procid = mapped;
+        if ((mapped = attribute_map_lookup(attribute_map, "msgid")) != NULL) names.msgid = mapped;
+        if ((mapped = attribute_map_lookup(attribute_map, "facility")) != NULL) names.facility = mapped;
+    }
+
+    CHKiRet(pb_open(buf, 1, &resource_logs_mark)); /* ExportLogsServiceRequest.resource_logs */
+    CHKiRet(pb_put_resource(buf, records, record_count, resource_attrs));
+
+    CHKiRet(pb_open(buf, 2, &scope_logs_mark)); /* ResourceLogs.scope_logs */
+    CHKiRet(pb_open(buf, 1, &scope_mark)); /* ScopeLogs.scope */
+    CHKiRet(pb_put_string(buf, 1, "rsyslog.omotel"));
+    CHKiRet(pb_put_string(buf, 2, VERSION));
+    CHKiRet(pb_close(buf, scope_mark));
+    for (i = 0; i < record_count; ++i) {
+        CHKiRet(pb_put_log_record(buf, &records[i], &names));
+    }
+    CHKiRet(pb_close(buf, scope_logs_mark));
+
+    CHKiRet(pb_close(buf, resource_logs_mark));
+
+finalize_it:
+    if (iRet != RS_RET_OK && buf != NULL) {
+        buf->len = 0;
+    }
+    RETiRet;
+}
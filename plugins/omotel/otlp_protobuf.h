@@ -30,6 +30,54 @@
 #include "rsyslog.h"
 #include "otlp_json.h" /* Reuse omotel_log_record_t, omotel_resource_attrs_t, attribute_map_t */
 
+/**
+ * @brief Reusable output buffer for the streaming protobuf encoder
+ *
+ * The buffer keeps its allocation between encodes so that a worker
+ * reaches a steady state without touching the allocator per batch.
+ */
+typedef struct omotel_pbuf_s {
+    uint8_t *data; /**< encoded bytes, valid up to @c len */
+    size_t len; /**< number of valid bytes */
+    size_t capacity; /**< allocated size of @c data */
+} omotel_pbuf_t;
+
+/**
+ * @brief Initialize an empty encoder buffer (no allocation)
+ */
+void omotel_pbuf_init(omotel_pbuf_t *buf);
+
+/**
+ * @brief Release the memory held by an encoder buffer
+ */
+void omotel_pbuf_free(omotel_pbuf_t *buf);
+
+/**
+ * @brief Encode an OTLP/HTTP protobuf export payload into a reusable buffer
+ *
+ * Writes the ExportLogsServiceRequest wire format directly into @p buf,
+ * without building an intermediate protobuf-c object graph. Length
+ * prefixes of nested messages are back-patched once their content is
+ * known. The output is byte-for-byte identical to
+ * omotel_protobuf_build_export().
+ *
+ * @p buf is reset on entry; previously allocated memory is reused and only
+ * grown when a batch needs more space.
+ *
+ * @param[in] records Array of log records to export
+ * @param[in] record_count Number of records in the array
+ * @param[in] resource_attrs Resource-level attributes to include
+ * @param[in] attribute_map Optional mapping from rsyslog properties to OTLP attributes
+ * @param[in,out] buf Output buffer; on success holds the serialized payload
+ * @return RS_RET_OK on success, RS_RET_PARAM_ERROR for invalid parameters,
+ *         RS_RET_OUT_OF_MEMORY on allocation failure
+ */
+rsRetVal omotel_protobuf_encode_export(const omotel_log_record_t *records,
+                                       size_t record_count,
+                                       const omotel_resource_attrs_t *resource_attrs,
+                                       const attribute_map_t *attribute_map,
+                                       omotel_pbuf_t *buf);
+
 /**
  * @brief Build OTLP/HTTP protobuf export payload
  *
@@ -37,6 +85,11 @@
  * (ExportLogsServiceRequest) according to the OpenTelemetry Protocol
  * specification.
  *
+ * This variant serializes through the protobuf-c generated bindings and
+ * returns a freshly allocated payload. omotel itself uses
+ * omotel_protobuf_encode_export(); this function is kept as the reference
+ * the streaming encoder is verified against.
+ *
  * @param[in] records Array of log records to export
  * @param[in] record_count Number of records in the array
  * @param[in] resource_attrs Resource-level attributes to include
@@ -0,0 +1,203 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file acmatch.c
+ * @brief Multi-pattern matcher behind constant string array compares.
+ *
+ * All modes share one transition table: a trie over the byte classes of the
+ * patterns, with state 0 as root. For ACMATCH_CONTAINS the trie is completed
+ * into an Aho-Corasick DFA by filling every missing transition with the
+ * transition of the state's failure link (computed breadth-first), and a
+ * state is accepting if it or any state on its failure chain ends a pattern.
+ * For prefix and suffix matching missing transitions stay at -1 and end the
+ * walk.
+ */
+#include "config.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "acmatch.h"
+
+struct acmatch_s {
+    acmatchMode_t mode;
+    int nClasses; /**< number of byte classes, class 0 = bytes in no pattern */
+    int nStates;
+    unsigned char byteClass[256];
+    int32_t *delta; /**< nStates * nClasses transitions, -1 = none */
+    unsigned char *accept; /**< per state: a pattern ends here */
+};
+
+static inline unsigned char foldByte(const unsigned char c, const int bNoCase) {
+    return (bNoCase && c >= 'A' && c <= 'Z') ? (unsigned char)(c - 'A' + 'a') : c;
+}
+
+/* assign a class to every byte used by a pattern; all others share class 0 */
+static void buildByteClasses(acmatch_t *const pThis,
+                             const unsigned char *const *const patterns,
+                             const size_t *const lens,
+                             const int nPatterns,
+                             const int bNoCase) {
+    unsigned char used[256];
+    int c;
+
+    memset(used, 0, sizeof(used));
+    for (int i = 0; i < nPatterns; ++i) {
+        for (size_t j = 0; j < lens[i]; ++j) used[foldByte(patterns[i][j], bNoCase)] = 1;
+    }
+    pThis->nClasses = 1;
+    memset(pThis->byteClass, 0, sizeof(pThis->byteClass));
+    for (c = 0; c < 256; ++c) {
+        if (used[c]) pThis->byteClass[c] = (unsigned char)pThis->nClasses++;
+    }
+    if (bNoCase) {
+        for (c = 'A'; c <= 'Z'; ++c) pThis->byteClass[c] = pThis->byteClass[c - 'A' + 'a'];
+    }
+}
+
+/* complete the trie into an Aho-Corasick DFA */
+static rsRetVal buildFailureLinks(acmatch_t *const pThis) {
+    const int nC = pThis->nClasses;
+    int32_t *const delta = pThis->delta;
+    int32_t *fail = NULL;
+    int32_t *queue = NULL;
+    int head = 0;
+    int tail = 0;
+    DEFiRet;
+
+    CHKmalloc(fail = malloc(pThis->nStates * sizeof(int32_t)));
+    CHKmalloc(queue = malloc(pThis->nStates * sizeof(int32_t)));
+
+    for (int c = 0; c < nC; ++c) {
+        const int32_t t = delta[c];
+        if (t == -1) {
+            delta[c] = 0;
+        } else {
+            fail[t] = 0;
+            queue[tail++] = t;
+        }
+    }
+    while (head < tail) {
+        const int32_t s = queue[head++];
+        pThis->accept[s] |= pThis->accept[fail[s]];
+        for (int c = 0; c < nC; ++c) {
+            const int32_t t = delta[s * nC + c];
+            const int32_t viaFail = delta[fail[s] * nC + c];
+            if (t == -1) {
+                delta[s * nC + c] = viaFail;
+            } else {
+                fail[t] = viaFail;
+                queue[tail++] = t;
+            }
+        }
+    }
+
+finalize_it:
+    free(fail);
+    free(queue);
+    RETiRet;
+}
+
+rsRetVal acmatchConstruct(acmatch_t **const ppThis,
+                          const unsigned char *const *const patterns,
+                          const size_t *const lens,
+                          const int nPatterns,
+                          const acmatchMode_t mode,
+                          const int bNoCase) {
+    acmatch_t *pThis = NULL;
+    size_t maxStates = 1;
+    DEFiRet;
+
+    CHKmalloc(pThis = calloc(1, sizeof(acmatch_t)));
+    pThis->mode = mode;
+    buildByteClasses(pThis, patterns, lens, nPatterns, bNoCase);
+
+    for (int i = 0; i < nPatterns; ++i) maxStates += lens[i];
+    if (maxStates > ACMATCH_MAX_TABLE / (size_t)pThis->nClasses) {
+        ABORT_FINALIZE(RS_RET_OUT_OF_MEMORY);
+    }
+    CHKmalloc(pThis->delta = malloc(maxStates * pThis->nClasses * sizeof(int32_t)));
+    CHKmalloc(pThis->accept = calloc(maxStates, 1));
+    memset(pThis->delta, 0xff, pThis->nClasses * sizeof(int32_t)); /* root: all -1 */
+    pThis->nStates = 1;
+
+    for (int i = 0; i < nPatterns; ++i) {
+        int32_t s = 0;
+        for (size_t j = 0; j < lens[i]; ++j) {
+            /* suffixes are matched from the end, so insert them reversed */
+            const unsigned char b = (mode == ACMATCH_SUFFIX) ? patterns[i][lens[i] - 1 - j] : patterns[i][j];
+            int32_t *const pNext = &pThis->delta[s * pThis->nClasses + pThis->byteClass[b]];
+            if (*pNext == -1) {
+                memset(pThis->delta + (size_t)pThis->nStates * pThis->nClasses, 0xff,
+                       pThis->nClasses * sizeof(int32_t));
+                *pNext = pThis->nStates++;
+            }
+            s = *pNext;
+        }
+        pThis->accept[s] = 1;
+    }
+
+    if (mode == ACMATCH_CONTAINS) CHKiRet(buildFailureLinks(pThis));
+
+    *ppThis = pThis;
+    pThis = NULL;
+
+finalize_it:
+    acmatchDestruct(&pThis);
+    RETiRet;
+}
+
+void acmatchDestruct(acmatch_t **const ppThis) {
+    if (*ppThis == NULL) return;
+    free((*ppThis)->delta);
+    free((*ppThis)->accept);
+    free(*ppThis);
+    *ppThis = NULL;
+}
+
+int acmatchMatch(const acmatch_t *const pThis, const unsigned char *const subject, const size_t len) {
+    const int32_t *const delta = pThis->delta;
+    const unsigned char *const accept = pThis->accept;
+    const int nC = pThis->nClasses;
+    int32_t s = 0;
+
+    if (accept[0]) return 1;
+    switch (pThis->mode) {
+        case ACMATCH_CONTAINS:
+            for (size_t i = 0; i < len; ++i) {
+                s = delta[s * nC + pThis->byteClass[subject[i]]];
+                if (accept[s]) return 1;
+            }
+            break;
+        case ACMATCH_PREFIX:
+            for (size_t i = 0; i < len; ++i) {
+                s = delta[s * nC + pThis->byteClass[subject[i]]];
+                if (s == -1) return 0;
+                if (accept[s]) return 1;
+            }
+            break;
+        case ACMATCH_SUFFIX:
+            for (size_t i = len; i > 0; --i) {
+                s = delta[s * nC + pThis->byteClass[subject[i - 1]]];
+                if (s == -1) return 0;
+                if (accept[s]) return 1;
+            }
+            break;
+        default:
+            break;
+    }
+    return 0;
+}
+
+int acmatchNumStates(const acmatch_t *const pThis) {
+    return pThis->nStates;
+}
@@ -0,0 +1,76 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file acmatch.h
+ * @brief Match a string against many constant patterns in one pass.
+ *
+ * The matcher answers "does any of the patterns occur in / start / end the
+ * subject", which is what RainerScript's contains, contains_i, startswith,
+ * startswith_i and endswith operators ask when compared against a constant
+ * string array. Substring search uses an Aho-Corasick automaton that is
+ * compiled into a complete DFA, so matching costs one table lookup per
+ * subject byte regardless of the number of patterns. Prefix and suffix
+ * matching walk a trie of the (for suffixes: reversed) patterns from the
+ * respective end of the subject and stop at the first mismatch. Bytes that
+ * do not occur in any pattern share one input class to keep the table small.
+ *
+ * Case-insensitive matching folds ASCII letters like tolower() in the C
+ * locale, consistent with libestr's case-insensitive compares.
+ */
+#ifndef INCLUDED_ACMATCH_H
+#define INCLUDED_ACMATCH_H
+
+#include <stddef.h>
+#include "rsyslog.h"
+
+#define ACMATCH_MAX_TABLE (4 * 1024 * 1024) /**< max transition entries (4 bytes each) */
+
+typedef enum acmatchMode_e {
+    ACMATCH_CONTAINS, /**< any pattern occurs anywhere in the subject */
+    ACMATCH_PREFIX, /**< the subject starts with any pattern */
+    ACMATCH_SUFFIX /**< the subject ends with any pattern */
+} acmatchMode_t;
+
+typedef struct acmatch_s acmatch_t;
+
+/**
+ * @brief Compile @p nPatterns patterns into a matcher.
+ *
+ * An empty pattern matches every subject. Construction fails with
+ * RS_RET_OUT_OF_MEMORY if the automaton would exceed ACMATCH_MAX_TABLE
+ * entries, so callers can keep evaluating the patterns one by one.
+ *
+ * @param ppThis receives the new matcher
+ * @param patterns pattern buffers, need not be NUL-terminated
+ * @param lens length of each pattern
+ * @param nPatterns number of patterns
+ * @param mode kind of match to perform
+ * @param bNoCase fold case when matching
+ */
+rsRetVal acmatchConstruct(acmatch_t **ppThis,
+                          const unsigned char *const *patterns,
+                          const size_t *lens,
+                          int nPatterns,
+                          acmatchMode_t mode,
+                          int bNoCase);
+
+/** @brief Free a matcher; @p *ppThis may be NULL and is set to NULL. */
+void acmatchDestruct(acmatch_t **ppThis);
+
+/** @return 1 if @p subject of @p len bytes matches any pattern, else 0 */
+int acmatchMatch(const acmatch_t *pThis, const unsigned char *subject, size_t len);
+
+/** @return number of automaton states, for diagnostics */
+int acmatchNumStates(const acmatch_t *pThis);
+
+#endif /* #ifndef INCLUDED_ACMATCH_H */
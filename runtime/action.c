@@ -317,7 +317,11 @@ rsRetVal actionDestruct(action_t *const pThis) {
     /* destroy stats object, if we have one (may not always be
      * be the case, e.g. if turned off)
      */
-    if (pThis->statsobj != NULL) statsobj.Destruct(&pThis->statsobj);
+    if (pThis->statsobj != NULL) {
+        statsobj.Destruct(&pThis->statsobj);
+        STATSCOUNTER_SHARDED_DESTRUCT(pThis->ctrProcessed, pThis->mutCtrProcessed);
+    }
+    msglatencyDestruct(&pThis->pLatency);
 
     if (pThis->ratelimiter != NULL) ratelimitDestruct(pThis->ratelimiter);
     if (pThis->fdErrFile != -1) close(pThis->fdErrFile);
@@ -483,8 +487,8 @@ rsRetVal actionConstructFinalize(action_t *__restrict__ const pThis, struct nvls
     CHKiRet(statsobj.SetName(pThis->statsobj, pThis->pszName));
     CHKiRet(statsobj.SetOrigin(pThis->statsobj, (uchar *)"core.action"));
 
-    STATSCOUNTER_INIT(pThis->ctrProcessed, pThis->mutCtrProcessed);
-    CHKiRet(statsobj.AddCounter(pThis->statsobj, UCHAR_CONSTANT("processed"), ctrType_IntCtr, CTR_FLAG_RESETTABLE,
+    STATSCOUNTER_SHARDED_INIT(pThis->ctrProcessed, pThis->mutCtrProcessed);
+    CHKiRet(statsobj.AddCounter(pThis->statsobj, UCHAR_CONSTANT("processed"), ctrType_ShardedCtr, CTR_FLAG_RESETTABLE,
                                 &pThis->ctrProcessed));
 
     STATSCOUNTER_INIT(pThis->ctrBatchesProcessed, pThis->mutCtrBatchesProcessed);
@@ -1292,6 +1296,9 @@ static rsRetVal prepareDoActionParams(action_t *__restrict__ const pAction,
     pWrkrInfo = &(pWti->actWrkrInfo[pAction->iActionNbr]);
     if (pAction->isTransactional) {
         CHKiRet(wtiNewIParam(pWti, pAction, &iparams));
+        if (pAction->pLatency != NULL) {
+            pWrkrInfo->p.tx.latencyRcvd[pWrkrInfo->p.tx.currIParam - 1] = pMsg->tLatencyRcvd;
+        }
         for (i = 0; i < pAction->iNumTpls; ++i) {
             CHKiRet(tplToString(pAction->ppTpl[i], pMsg, &actParam(iparams, pAction->iNumTpls, 0, i), ttNow));
         }
@@ -1835,6 +1842,19 @@ finalize_it:
  * The result is propagated back through direct-mode queues so
  * higher levels can act on suspend or failure states.
  */
+/* count the latency of the messages of a transaction once it is done with,
+ * whatever its outcome; one clock read for the whole transaction.
+ */
+static void recordCommitLatency(action_t *const pThis, actWrkrInfo_t *const wrkrInfo) {
+    uint64_t now = 0;
+
+    for (int i = 0; i < wrkrInfo->p.tx.currIParam; ++i) {
+        if (wrkrInfo->p.tx.latencyRcvd[i] == 0) continue;
+        if (now == 0) now = msglatencyNow();
+        msglatencyRecord(pThis->pLatency, wrkrInfo->p.tx.latencyRcvd[i], now);
+    }
+}
+
 static rsRetVal ATTR_NONNULL() actionCommit(action_t *__restrict__ const pThis, wti_t *__restrict__ const pWti) {
     actWrkrInfo_t *const wrkrInfo = &(pWti->actWrkrInfo[pThis->iActionNbr]);
     /* Variables that permit us to override the batch of messages */
@@ -1947,6 +1967,9 @@ finalize_it:
     if (needfree_iparams) {
         free(iparams);
     }
+    if (pThis->pLatency != NULL && pThis->isTransactional) {
+        recordCommitLatency(pThis, wrkrInfo);
+    }
     wrkrInfo->p.tx.currIParam = 0; /* reset to beginning */
     RETiRet;
 }
@@ -2000,6 +2023,10 @@ static rsRetVal processMsgMain(action_t *__restrict__ const pAction,
     }
 
     iRet = actionProcessMessage(pAction, pWti->actWrkrInfo[pAction->iActionNbr].p.nontx.actParams, pWti);
+    /* read the clock right after the output module got the message; a batch
+     * time would hide slow outputs. Sampling limits the cost.
+     */
+    if (pAction->pLatency != NULL) msglatencyRecordNow(pAction->pLatency, pMsg->tLatencyRcvd);
     if (pAction->bNeedReleaseBatch) releaseDoActionParams(pAction, pWti, 0);
     if (iRet == RS_RET_OK) {
         if (pWti->execState.bDoAutoCommit) iRet = actionCommit(pAction, pWti);
@@ -2162,6 +2189,9 @@ static rsRetVal setActionQueType(void __attribute__((unused)) * pVal, uchar *psz
     } else if (!strcasecmp((char *)pszType, "linkedlist")) {
         cs.ActionQueType = QUEUETYPE_LINKEDLIST;
         DBGPRINTF("action queue type set to LINKEDLIST\n");
+    } else if (!strcasecmp((char *)pszType, "ringbuffer")) {
+        cs.ActionQueType = QUEUETYPE_RINGBUFFER;
+        DBGPRINTF("action queue type set to RINGBUFFER\n");
     } else if (!strcasecmp((char *)pszType, "disk")) {
         cs.ActionQueType = QUEUETYPE_DISK;
         DBGPRINTF("action queue type set to DISK\n");
@@ -2210,7 +2240,7 @@ static rsRetVal ATTR_NONNULL() doSubmitToActionQ(action_t *const pAction, wti_t
         FINALIZE;
     }
 
-    STATSCOUNTER_INC(pAction->ctrProcessed, pAction->mutCtrProcessed);
+    STATSCOUNTER_SHARDED_INC(pAction->ctrProcessed, pAction->mutCtrProcessed);
     if (pAction->pQueue->qType == QUEUETYPE_DIRECT) {
         STATSCOUNTER_INC(pAction->ctrBatchesProcessed, pAction->mutCtrBatchesProcessed);
         ttNow.year = 0;
@@ -2344,6 +2374,13 @@ PRAGMA_DIAGNOSTIC_POP
 DEFFUNC_llExecFunc(doActivateActions) {
     rsRetVal localRet;
     action_t *const pThis = (action_t *)pData;
+    /* created here, as stats.latency is only known once the config is complete */
+    if (pThis->statsobj != NULL) {
+        localRet = msglatencyConstruct(&pThis->pLatency, pThis->statsobj);
+        if (localRet != RS_RET_OK) {
+            LogError(0, localRet, "action '%s': could not set up latency statistics", pThis->pszName);
+        }
+    }
     localRet = qqueueStart(runConf, pThis->pQueue);
     if (localRet != RS_RET_OK) {
         if (runConf->globals.bAbortOnFailedQueueStartup) {
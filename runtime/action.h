@@ -115,7 +115,7 @@ struct action_s {
     int nWrkr;
     /* for statistics subsystem */
     statsobj_t *statsobj;
-    STATSCOUNTER_DEF(ctrProcessed, mutCtrProcessed)
+    STATSCOUNTER_SHARDED_DEF(ctrProcessed, mutCtrProcessed) /* updated by all workers */
     STATSCOUNTER_DEF(ctrBatchesProcessed, mutCtrBatchesProcessed)
     STATSCOUNTER_DEF(ctrFail, mutCtrFail)
     STATSCOUNTER_DEF(ctrSuspend, mutCtrSuspend)
@@ -125,6 +125,7 @@ struct action_s {
     STATSCOUNTER_DEF(ctrRateLimitDropped, mutCtrRateLimitDropped)
     STATSCOUNTER_DEF(ctrRateLimitPaced, mutCtrRateLimitPaced)
     STATSCOUNTER_DEF(ctrRateLimitPacedUsec, mutCtrRateLimitPacedUsec)
+    msglatency_t *pLatency; /* latency histogram, NULL unless stats.latency is on */
 };
 
 static inline int actionLoadDisabled(action_t *const pAction) {
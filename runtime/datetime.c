@@ -31,6 +31,7 @@
 #include <ctype.h>
 #include <assert.h>
 #include <string.h>
+#include <pthread.h>
 #ifdef HAVE_SYS_TIME_H
     #include <sys/time.h>
 #endif
@@ -92,8 +93,66 @@ static const int weeksInYear[] = {
 static const char *monthNames[12] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
                                      "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
 
+/* Per-thread cache for the hot time functions. Most messages a thread
+ * handles fall into the same second as the one before, so the broken-down
+ * current time and the rendered date/time parts of the last formatted
+ * timestamps are kept and reused while the second does not change; only
+ * the fractional seconds are filled in per call.
+ */
+typedef struct timecache_s {
+    struct {
+        time_t second; /* tv_sec the broken-down time is for, -1: none yet */
+        struct syslogTime t;
+    } now[2]; /* for getCurrTime(), indexed by inUTC */
+    sbool bHave3339;
+    struct syslogTime ts3339; /* timestamp prefix3339 and zone3339 were rendered from */
+    char prefix3339[19]; /* yyyy-mm-ddThh:mm:ss */
+    char zone3339[6]; /* Z or +hh:mm */
+    int lenZone3339;
+    sbool bHave3164;
+    int buggyDay3164;
+    struct syslogTime ts3164;
+    char prefix3164[15]; /* Mmm dd hh:mm:ss */
+} timecache_t;
+
+static pthread_once_t onceTimeCache = PTHREAD_ONCE_INIT;
+static pthread_key_t keyTimeCache;
+static sbool bHaveTimeCacheKey = 0;
+
+
 /* ------------------------------ methods ------------------------------ */
 
+static void initTimeCacheKey(void) {
+    bHaveTimeCacheKey = (pthread_key_create(&keyTimeCache, free) == 0);
+}
+
+
+/* get the calling thread's time cache; NULL if none can be had, in which
+ * case the caller must work uncached.
+ */
+static timecache_t *getTimeCache(void) {
+    timecache_t *tc;
+
+    pthread_once(&onceTimeCache, initTimeCacheKey);
+    if (!bHaveTimeCacheKey) return NULL;
+    if ((tc = pthread_getspecific(keyTimeCache)) == NULL) {
+        if ((tc = calloc(1, sizeof(timecache_t))) == NULL) return NULL;
+        tc->now[0].second = tc->now[1].second = -1;
+        if (pthread_setspecific(keyTimeCache, tc) != 0) {
+            free(tc);
+            return NULL;
+        }
+    }
+    return tc;
+}
+
+
+/* do both timestamps have the same date and time (to the second)? */
+static int sameSecond(const struct syslogTime *const a, const struct syslogTime *const b) {
+    return a->second == b->second && a->minute == b->minute && a->hour == b->hour && a->day == b->day &&
+           a->month == b->month && a->year == b->year;
+}
+
 
 /**
  * Convert struct timeval to syslog_time
@@ -197,7 +256,19 @@ static void getCurrTime(struct syslogTime *t, time_t *ttSeconds, const int inUTC
 #endif
     if (ttSeconds != NULL) *ttSeconds = tp.tv_sec;
 
-    timeval2syslogTime(&tp, t, inUTC);
+    timecache_t *const tc = getTimeCache();
+    if (tc == NULL) {
+        timeval2syslogTime(&tp, t, inUTC);
+        return;
+    }
+    /* localtime_r() is the expensive part, and its result only changes with the second */
+    const int idx = inUTC ? 1 : 0;
+    if (tc->now[idx].second != tp.tv_sec) {
+        timeval2syslogTime(&tp, &tc->now[idx].t, inUTC);
+        tc->now[idx].second = tp.tv_sec;
+    }
+    *t = tc->now[idx].t;
+    t->secfrac = tp.tv_usec;
 }
 
 
@@ -894,6 +965,9 @@ static int formatTimestampSecFrac(struct syslogTime *ts, char *pBuf) {
  * the string terminator). If 0 is returend, an error occurred.
  */
 static int formatTimestamp3339(struct syslogTime *ts, char *pBuf) {
+    timecache_t *const tc = getTimeCache();
+    char zone[6];
+    int lenZone;
     int iBuf;
     int power;
     int secfrac;
@@ -902,32 +976,60 @@ static int formatTimestamp3339(struct syslogTime *ts, char *pBuf) {
     assert(ts != NULL);
     assert(pBuf != NULL);
 
-    /* start with fixed parts */
-    /* year yyyy */
-    pBuf[0] = (ts->year / 1000) % 10 + '0';
-    pBuf[1] = (ts->year / 100) % 10 + '0';
-    pBuf[2] = (ts->year / 10) % 10 + '0';
-    pBuf[3] = ts->year % 10 + '0';
-    pBuf[4] = '-';
-    /* month */
-    pBuf[5] = (ts->month / 10) % 10 + '0';
-    pBuf[6] = ts->month % 10 + '0';
-    pBuf[7] = '-';
-    /* day */
-    pBuf[8] = (ts->day / 10) % 10 + '0';
-    pBuf[9] = ts->day % 10 + '0';
-    pBuf[10] = 'T';
-    /* hour */
-    pBuf[11] = (ts->hour / 10) % 10 + '0';
-    pBuf[12] = ts->hour % 10 + '0';
-    pBuf[13] = ':';
-    /* minute */
-    pBuf[14] = (ts->minute / 10) % 10 + '0';
-    pBuf[15] = ts->minute % 10 + '0';
-    pBuf[16] = ':';
-    /* second */
-    pBuf[17] = (ts->second / 10) % 10 + '0';
-    pBuf[18] = ts->second % 10 + '0';
+    if (tc != NULL && tc->bHave3339 && sameSecond(ts, &tc->ts3339) && ts->OffsetMode == tc->ts3339.OffsetMode &&
+        ts->OffsetHour == tc->ts3339.OffsetHour && ts->OffsetMinute == tc->ts3339.OffsetMinute) {
+        memcpy(pBuf, tc->prefix3339, sizeof(tc->prefix3339));
+        memcpy(zone, tc->zone3339, sizeof(zone));
+        lenZone = tc->lenZone3339;
+    } else {
+        /* start with fixed parts */
+        /* year yyyy */
+        pBuf[0] = (ts->year / 1000) % 10 + '0';
+        pBuf[1] = (ts->year / 100) % 10 + '0';
+        pBuf[2] = (ts->year / 10) % 10 + '0';
+        pBuf[3] = ts->year % 10 + '0';
+        pBuf[4] = '-';
+        /* month */
+        pBuf[5] = (ts->month / 10) % 10 + '0';
+        pBuf[6] = ts->month % 10 + '0';
+        pBuf[7] = '-';
+        /* day */
+        pBuf[8] = (ts->day / 10) % 10 + '0';
+        pBuf[9] = ts->day % 10 + '0';
+        pBuf[10] = 'T';
+        /* hour */
+        pBuf[11] = (ts->hour / 10) % 10 + '0';
+        pBuf[12] = ts->hour % 10 + '0';
+        pBuf[13] = ':';
+        /* minute */
+        pBuf[14] = (ts->minute / 10) % 10 + '0';
+        pBuf[15] = ts->minute % 10 + '0';
+        pBuf[16] = ':';
+        /* second */
+        pBuf[17] = (ts->second / 10) % 10 + '0';
+        pBuf[18] = ts->second % 10 + '0';
+
+        if (ts->OffsetMode == 'Z') {
+            zone[0] = 'Z';
+            lenZone = 1;
+        } else {
+            zone[0] = ts->OffsetMode;
+            zone[1] = (ts->OffsetHour / 10) % 10 + '0';
+            zone[2] = ts->OffsetHour % 10 + '0';
+            zone[3] = ':';
+            zone[4] = (ts->OffsetMinute / 10) % 10 + '0';
+            zone[5] = ts->OffsetMinute % 10 + '0';
+            lenZone = 6;
+        }
+
+        if (tc != NULL) {
+            tc->ts3339 = *ts;
+            memcpy(tc->prefix3339, pBuf, sizeof(tc->prefix3339));
+            memcpy(tc->zone3339, zone, sizeof(zone));
+            tc->lenZone3339 = lenZone;
+            tc->bHave3339 = 1;
+        }
+    }
 
     iBuf = 19; /* points to next free entry, now it becomes dynamic! */
 
@@ -942,17 +1044,8 @@ static int formatTimestamp3339(struct syslogTime *ts, char *pBuf) {
         }
     }
 
-    if (ts->OffsetMode == 'Z') {
-        pBuf[iBuf++] = 'Z';
-    } else {
-        pBuf[iBuf++] = ts->OffsetMode;
-        pBuf[iBuf++] = (ts->OffsetHour / 10) % 10 + '0';
-        pBuf[iBuf++] = ts->OffsetHour % 10 + '0';
-        pBuf[iBuf++] = ':';
-        pBuf[iBuf++] = (ts->OffsetMinute / 10) % 10 + '0';
-        pBuf[iBuf++] = ts->OffsetMinute % 10 + '0';
-    }
-
+    memcpy(pBuf + iBuf, zone, lenZone);
+    iBuf += lenZone;
     pBuf[iBuf] = '\0';
 
     return iBuf;
@@ -970,10 +1063,17 @@ static int formatTimestamp3339(struct syslogTime *ts, char *pBuf) {
  * parsing scripts (in migration cases) rely on that.
  */
 static int formatTimestamp3164(struct syslogTime *ts, char *pBuf, int bBuggyDay) {
+    timecache_t *const tc = getTimeCache();
     int iDay;
     assert(ts != NULL);
     assert(pBuf != NULL);
 
+    if (tc != NULL && tc->bHave3164 && tc->buggyDay3164 == bBuggyDay && sameSecond(ts, &tc->ts3164)) {
+        memcpy(pBuf, tc->prefix3164, sizeof(tc->prefix3164));
+        pBuf[15] = '\0';
+        return 16;
+    }
+
     pBuf[0] = monthNames[(ts->month - 1) % 12][0];
     pBuf[1] = monthNames[(ts->month - 1) % 12][1];
     pBuf[2] = monthNames[(ts->month - 1) % 12][2];
@@ -991,6 +1091,13 @@ static int formatTimestamp3164(struct syslogTime *ts, char *pBuf, int bBuggyDay)
     pBuf[13] = (ts->second / 10) % 10 + '0';
     pBuf[14] = ts->second % 10 + '0';
     pBuf[15] = '\0';
+
+    if (tc != NULL) {
+        tc->ts3164 = *ts;
+        tc->buggyDay3164 = bBuggyDay;
+        memcpy(tc->prefix3164, pBuf, sizeof(tc->prefix3164));
+        tc->bHave3164 = 1;
+    }
     return 16; /* traditional: number of bytes written */
 }
 
@@ -44,6 +44,7 @@ rsRetVal __attribute__((deprecated)) parseAndSubmitMessage(const uchar *hname,
                                                            ruleset_t *pRuleset);
 rsRetVal createMainQueue(qqueue_t **ppQueue, uchar *pszQueueName, struct nvlst *lst);
 rsRetVal startMainQueue(rsconf_t *cnf, qqueue_t *pQueue);
+rsRetVal createParserQueue(qqueue_t **ppQueue, int iWorkerThreads);
 int get_bHadHUP(void);
 
 extern int MarkInterval;
@@ -34,6 +34,11 @@
 #include <netdb.h>
 #include <unistd.h>
 #include <ctype.h>
+#include <errno.h>
+#include <time.h>
+#ifdef HAVE_SYS_PRCTL_H
+    #include <sys/prctl.h>
+#endif
 
 #include "syslogd-types.h"
 #include "glbl.h"
@@ -45,6 +50,24 @@
 #include "prop.h"
 #include "dnscache.h"
 #include "rsconf.h"
+#include "atomic.h"
+
+/* The cache is split into shards, each with its own lock and hash table, so
+ * that lookups for different sources rarely touch the same lock. Names are
+ * never resolved while a shard lock is held: a lookup in the caller's thread
+ * only stalls that caller, and with reverselookup.resolver.threads set,
+ * misses and refreshes of expired entries are handed to a small pool of
+ * resolver threads. Until the resolver is done, the entry carries the IP
+ * as name (unless reverselookup.resolver.publiship is off, in which case
+ * the caller waits for the result).
+ *
+ * Entries are never modified once they are in a table (except for the
+ * refresh flag): a resolved name is published by replacing the entry under
+ * the shard write lock, and readers take their references under the read
+ * lock.
+ */
+#define DNSCACHE_SHARDS 16
+#define DNSCACHE_MAX_PENDING 10000 /* queued async lookups; beyond, callers resolve themselves */
 
 /* module data structures */
 struct dnscache_entry_s {
@@ -56,20 +79,49 @@ struct dnscache_entry_s {
     time_t validUntil;
     struct dnscache_entry_s *next;
     unsigned nUsed;
+    sbool bResolved; /* 0 while the async resolver works on it; names are the IP */
+    sbool bNegative; /* name lookup failed, names are the IP */
+    int bRefreshQueued; /* expired, async refresh requested (updated atomically) */
 };
 typedef struct dnscache_entry_s dnscache_entry_t;
-struct dnscache_s {
+typedef struct dnscache_shard_s {
     pthread_rwlock_t rwlock;
     struct hashtable *ht;
-    unsigned nEntries;
+} dnscache_shard_t;
+struct dnscache_s {
+    dnscache_shard_t shards[DNSCACHE_SHARDS];
 };
 typedef struct dnscache_s dnscache_t;
 
+/* a lookup for the async resolver */
+typedef struct resolve_req_s {
+    struct sockaddr_storage addr;
+    struct resolve_req_s *next;
+} resolve_req_t;
+
 
 /* static data */
 DEFobjStaticHelpers;
 DEFobjCurrIf(glbl) DEFobjCurrIf(prop) static dnscache_t dnsCache;
 static prop_t *staticErrValue;
+DEF_ATOMIC_HELPER_MUT(mutRefreshQueued);
+DEF_ATOMIC_HELPER_MUT(mutResolverState);
+
+static struct {
+    pthread_mutex_t mut;
+    pthread_cond_t work; /* requests queued or stop requested */
+    pthread_cond_t done; /* a lookup completed, for callers that wait */
+    resolve_req_t *head;
+    resolve_req_t *tail;
+    unsigned nPending;
+    unsigned nCompleted; /* lets waiters detect completions they missed */
+    pthread_t *thrds;
+    int nThrds;
+    int bStarted; /* start was attempted (atomic) */
+    int bRunning; /* threads are accepting requests (atomic) */
+    sbool bStop;
+} resolver = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, NULL, 0, 0, NULL, 0,
+              0, 0, 0};
 
 
 /* Our hash function.
@@ -150,13 +202,17 @@ static void ATTR_NONNULL() entryDestruct(dnscache_entry_t *const etry) {
 /* init function (must be called once) */
 rsRetVal dnscacheInit(void) {
     DEFiRet;
-    if ((dnsCache.ht = create_hashtable(100, hash_from_key_fn, key_equals_fn, (void (*)(void *))entryDestruct)) ==
-        NULL) {
-        DBGPRINTF("dnscache: error creating hash table!\n");
-        ABORT_FINALIZE(RS_RET_ERR);  // TODO: make this degrade, but run!
+    for (int i = 0; i < DNSCACHE_SHARDS; ++i) {
+        dnscache_shard_t *const shard = &dnsCache.shards[i];
+        if ((shard->ht = create_hashtable(100, hash_from_key_fn, key_equals_fn, (void (*)(void *))entryDestruct)) ==
+            NULL) {
+            DBGPRINTF("dnscache: error creating hash table!\n");
+            ABORT_FINALIZE(RS_RET_ERR);  // TODO: make this degrade, but run!
+        }
+        pthread_rwlock_init(&shard->rwlock, NULL);
     }
-    dnsCache.nEntries = 0;
-    pthread_rwlock_init(&dnsCache.rwlock, NULL);
+    INIT_ATOMIC_HELPER_MUT(mutRefreshQueued);
+    INIT_ATOMIC_HELPER_MUT(mutResolverState);
     CHKiRet(objGetObjInterface(&obj)); /* this provides the root pointer for all other queries */
     CHKiRet(objUse(glbl, CORE_COMPONENT));
     CHKiRet(objUse(prop, CORE_COMPONENT));
@@ -171,9 +227,17 @@ finalize_it:
 /* deinit function (must be called once) */
 rsRetVal dnscacheDeinit(void) {
     DEFiRet;
+    dnscacheStopResolver();
     prop.Destruct(&staticErrValue);
-    hashtable_destroy(dnsCache.ht, 1); /* 1 => free all values automatically */
-    pthread_rwlock_destroy(&dnsCache.rwlock);
+    for (int i = 0; i < DNSCACHE_SHARDS; ++i) {
+        dnscache_shard_t *const shard = &dnsCache.shards[i];
+        if (shard->ht == NULL) continue;
+        hashtable_destroy(shard->ht, 1); /* 1 => free all values automatically */
+        shard->ht = NULL;
+        pthread_rwlock_destroy(&shard->rwlock);
+    }
+    DESTROY_ATOMIC_HELPER_MUT(mutRefreshQueued);
+    DESTROY_ATOMIC_HELPER_MUT(mutResolverState);
     objRelease(glbl, CORE_COMPONENT);
     objRelease(prop, CORE_COMPONENT);
     RETiRet;
@@ -233,7 +297,8 @@ done:
 }
 
 
-/* resolve an address.
+/* resolve an address. If bResolveName is 0, only the IP is filled in and
+ * used as name, like with DNS disabled.
  *
  * Please see http://www.hmug.org/man/3/getnameinfo.php (under Caveats)
  * for some explanation of the code found below. We do by default not
@@ -242,7 +307,9 @@ done:
  * we should abort. For this, the return value tells the caller if the
  * message should be processed (1) or discarded (0).
  */
-static rsRetVal ATTR_NONNULL() resolveAddr(struct sockaddr_storage *addr, dnscache_entry_t *etry) {
+static rsRetVal ATTR_NONNULL() resolveAddr(struct sockaddr_storage *addr,
+                                           dnscache_entry_t *etry,
+                                           const int bResolveName) {
     DEFiRet;
     int error;
     sigset_t omask, nmask;
@@ -259,7 +326,7 @@ static rsRetVal ATTR_NONNULL() resolveAddr(struct sockaddr_storage *addr, dnscac
         ABORT_FINALIZE(RS_RET_INVALID_SOURCE);
     }
 
-    if (!glbl.GetDisableDNS(runConf)) {
+    if (bResolveName && !glbl.GetDisableDNS(runConf)) {
         sigemptyset(&nmask);
         sigaddset(&nmask, SIGHUP);
         pthread_sigmask(SIG_BLOCK, &nmask, &omask);
@@ -326,7 +393,8 @@ finalize_it:
 
     prop.CreateStringProp(&etry->ip, (uchar *)szIP, strlen(szIP));
 
-    if (error || glbl.GetDisableDNS(runConf)) {
+    etry->bNegative = error && bResolveName && !glbl.GetDisableDNS(runConf);
+    if (error || !bResolveName || glbl.GetDisableDNS(runConf)) {
         dbgprintf("Host name for your address (%s) unknown\n", szIP);
         prop.AddRef(etry->ip);
         etry->fqdn = etry->ip;
@@ -340,35 +408,395 @@ finalize_it:
 }
 
 
-static rsRetVal ATTR_NONNULL() addEntry(struct sockaddr_storage *const addr, dnscache_entry_t **const pEtry) {
-    int r;
-    dnscache_entry_t *etry = NULL;
+/* set the expiry time of a freshly resolved entry */
+static void ATTR_NONNULL() entrySetValidity(dnscache_entry_t *const etry) {
+    if (runConf->globals.dnscacheEnableTTL) {
+        const time_t ttl = (etry->bNegative && runConf->globals.dnscacheNegativeTTL >= 0)
+                               ? (time_t)runConf->globals.dnscacheNegativeTTL
+                               : (time_t)runConf->globals.dnscacheDefaultTTL;
+        etry->validUntil = time(NULL) + ttl;
+    }
+}
+
+
+static int ATTR_NONNULL() entryExpired(const dnscache_entry_t *const etry) {
+    return runConf->globals.dnscacheEnableTTL && etry->bResolved && etry->validUntil <= time(NULL);
+}
+
+
+/* hand out references to the entry's names; shard lock must be held */
+static void ATTR_NONNULL(1, 5) entryGetProps(dnscache_entry_t *const etry,
+                                             prop_t **const fqdn,
+                                             prop_t **const fqdnLowerCase,
+                                             prop_t **const localName,
+                                             prop_t **const ip) {
+    prop.AddRef(etry->ip);
+    *ip = etry->ip;
+    if (fqdn != NULL) {
+        prop.AddRef(etry->fqdn);
+        *fqdn = etry->fqdn;
+    }
+    if (fqdnLowerCase != NULL) {
+        prop.AddRef(etry->fqdnLowerCase);
+        *fqdnLowerCase = etry->fqdnLowerCase;
+    }
+    if (localName != NULL) {
+        prop.AddRef(etry->localName);
+        *localName = etry->localName;
+    }
+}
+
+
+/* put etry into the table, replacing (and destructing) an entry for the same
+ * address. keybuf is handed over in any case. Shard write lock must be held.
+ * Returns 0 if the entry could not be inserted; the caller still owns it then.
+ */
+static int ATTR_NONNULL() replaceEntry(dnscache_shard_t *const shard,
+                                       const unsigned hash,
+                                       dnscache_entry_t *const etry,
+                                       struct sockaddr_storage *const keybuf) {
+    dnscache_entry_t *const old = hashtable_remove_prehashed(shard->ht, hash, &etry->addr);
+    if (old != NULL) entryDestruct(old);
+    memcpy(keybuf, &etry->addr, sizeof(struct sockaddr_storage));
+    if (hashtable_insert_prehashed(shard->ht, hash, keybuf, etry) == 0) {
+        DBGPRINTF("dnscache: inserting element failed\n");
+        free(keybuf);
+        return 0;
+    }
+    return 1;
+}
+
+
+/* wake up callers waiting for a lookup to complete */
+static void resolverNotifyDone(void) {
+    pthread_mutex_lock(&resolver.mut);
+    ++resolver.nCompleted;
+    pthread_cond_broadcast(&resolver.done);
+    pthread_mutex_unlock(&resolver.mut);
+}
+
+
+/* hand a lookup to the resolver threads. Fails if they are not running or
+ * too many lookups are queued already; the caller must then resolve itself.
+ */
+static rsRetVal ATTR_NONNULL() resolverEnqueue(const struct sockaddr_storage *const addr) {
+    resolve_req_t *req = NULL;
     DEFiRet;
 
-    /* entry still does not exist, so add it */
+    CHKmalloc(req = malloc(sizeof(resolve_req_t)));
+    memcpy(&req->addr, addr, sizeof(struct sockaddr_storage));
+    req->next = NULL;
+    pthread_mutex_lock(&resolver.mut);
+    if (resolver.bStop || resolver.nThrds == 0 || resolver.nPending >= DNSCACHE_MAX_PENDING) {
+        pthread_mutex_unlock(&resolver.mut);
+        ABORT_FINALIZE(RS_RET_NOT_FOUND);
+    }
+    if (resolver.tail == NULL) {
+        resolver.head = req;
+    } else {
+        resolver.tail->next = req;
+    }
+    resolver.tail = req;
+    ++resolver.nPending;
+    pthread_cond_signal(&resolver.work);
+    pthread_mutex_unlock(&resolver.mut);
+    req = NULL;
+
+finalize_it:
+    free(req);
+    RETiRet;
+}
+
+
+/* do a lookup on behalf of a resolver thread and publish the result */
+static void ATTR_NONNULL() resolveQueued(struct sockaddr_storage *const addr) {
+    const unsigned hash = hash_from_key_fn(addr);
+    dnscache_shard_t *const shard = &dnsCache.shards[hash % DNSCACHE_SHARDS];
     struct sockaddr_storage *const keybuf = malloc(sizeof(struct sockaddr_storage));
-    CHKmalloc(keybuf);
-    CHKmalloc(etry = malloc(sizeof(dnscache_entry_t)));
-    resolveAddr(addr, etry);
-    assert(etry != NULL);
+    dnscache_entry_t *const etry = calloc(1, sizeof(dnscache_entry_t));
+
+    if (keybuf == NULL || etry == NULL) {
+        free(keybuf);
+        free(etry);
+        /* keep the IP as name, so that waitResolved() does not wait forever,
+         * and let a later lookup try to refresh it
+         */
+        DBGPRINTF("dnscache: out of memory, keeping IP as name\n");
+        pthread_rwlock_wrlock(&shard->rwlock);
+        dnscache_entry_t *const pending = hashtable_search_prehashed(shard->ht, hash, addr);
+        if (pending != NULL) {
+            if (!pending->bResolved) {
+                pending->bResolved = 1;
+                entrySetValidity(pending);
+            }
+            (void)ATOMIC_CAS(&pending->bRefreshQueued, 1, 0, &mutRefreshQueued);
+        }
+        pthread_rwlock_unlock(&shard->rwlock);
+        return; /* resolverWorker() wakes the waiters */
+    }
+    resolveAddr(addr, etry, 1);
     memcpy(&etry->addr, addr, SALEN((struct sockaddr *)addr));
-    etry->nUsed = 0;
-    if (runConf->globals.dnscacheEnableTTL) {
-        etry->validUntil = time(NULL) + runConf->globals.dnscacheDefaultTTL;
+    etry->bResolved = 1;
+    entrySetValidity(etry);
+
+    pthread_rwlock_wrlock(&shard->rwlock);
+    if (!replaceEntry(shard, hash, etry, keybuf)) entryDestruct(etry);
+    pthread_rwlock_unlock(&shard->rwlock);
+}
+
+
+static void *resolverWorker(void *const arg) {
+    const int id = (int)(intptr_t)arg;
+    uchar thrdName[32];
+    sigset_t sigSet;
+
+    /* signals are handled by the main thread */
+    sigfillset(&sigSet);
+    pthread_sigmask(SIG_BLOCK, &sigSet, NULL);
+    snprintf((char *)thrdName, sizeof(thrdName), "rs:dns(%d)", id);
+#if defined(HAVE_PRCTL) && defined(PR_SET_NAME)
+    /* set thread name - we ignore if the call fails, has no harsh consequences... */
+    if (prctl(PR_SET_NAME, thrdName, 0, 0, 0) != 0) {
+        DBGPRINTF("prctl failed, not setting thread name for '%s'\n", thrdName);
+    }
+#endif
+    dbgOutputTID((char *)thrdName);
+
+    pthread_mutex_lock(&resolver.mut);
+    while (1) {
+        while (resolver.head == NULL && !resolver.bStop) pthread_cond_wait(&resolver.work, &resolver.mut);
+        if (resolver.bStop) break;
+        resolve_req_t *const req = resolver.head;
+        resolver.head = req->next;
+        if (resolver.head == NULL) resolver.tail = NULL;
+        --resolver.nPending;
+        pthread_mutex_unlock(&resolver.mut);
+
+        resolveQueued(&req->addr);
+        free(req);
+
+        pthread_mutex_lock(&resolver.mut);
+        ++resolver.nCompleted;
+        pthread_cond_broadcast(&resolver.done);
     }
+    pthread_mutex_unlock(&resolver.mut);
+    return NULL;
+}
 
-    memcpy(keybuf, addr, sizeof(struct sockaddr_storage));
 
-    r = hashtable_insert(dnsCache.ht, keybuf, etry);
-    if (r == 0) {
-        DBGPRINTF("dnscache: inserting element failed\n");
+/* start the resolver threads on first use, as the config is only known then */
+static void resolverStart(void) {
+    const int nThrds = runConf->globals.dnscacheResolverThreads;
+
+    pthread_mutex_lock(&resolver.mut);
+    if (ATOMIC_LOAD_32BIT(&resolver.bStarted, &mutResolverState) || resolver.bStop) goto done;
+    if ((resolver.thrds = calloc(nThrds, sizeof(pthread_t))) == NULL) {
+        LogError(errno, RS_RET_OUT_OF_MEMORY, "dnscache: cannot start resolver threads, resolving synchronously");
+        goto done;
+    }
+    for (int i = 0; i < nThrds; ++i) {
+        const int r =
+            pthread_create(&resolver.thrds[resolver.nThrds], &default_thread_attr, resolverWorker, (void *)(intptr_t)i);
+        if (r != 0) {
+            LogError(r, RS_RET_ERR, "dnscache: could only start %d of %d resolver threads", resolver.nThrds, nThrds);
+            break;
+        }
+        ++resolver.nThrds;
     }
-    *pEtry = etry;
+    DBGPRINTF("dnscache: started %d resolver threads\n", resolver.nThrds);
+    ATOMIC_STORE_32BIT(&resolver.bRunning, &mutResolverState, resolver.nThrds > 0);
+
+done:
+    ATOMIC_STORE_32BIT(&resolver.bStarted, &mutResolverState, 1);
+    pthread_mutex_unlock(&resolver.mut);
+}
+
+
+/* stop the resolver threads. Lookups still queued are dropped; their entries
+ * keep the IP as name. Must be called while the config is still valid.
+ */
+void dnscacheStopResolver(void) {
+    pthread_mutex_lock(&resolver.mut);
+    ATOMIC_STORE_32BIT(&resolver.bStarted, &mutResolverState, 1); /* no (re)start during shutdown */
+    ATOMIC_STORE_32BIT(&resolver.bRunning, &mutResolverState, 0);
+    resolver.bStop = 1;
+    pthread_cond_broadcast(&resolver.work);
+    pthread_cond_broadcast(&resolver.done);
+    pthread_mutex_unlock(&resolver.mut);
+
+    for (int i = 0; i < resolver.nThrds; ++i) pthread_join(resolver.thrds[i], NULL);
+    free(resolver.thrds);
+    resolver.thrds = NULL;
+    resolver.nThrds = 0;
+    while (resolver.head != NULL) {
+        resolve_req_t *const req = resolver.head;
+        resolver.head = req->next;
+        free(req);
+    }
+    resolver.tail = NULL;
+    resolver.nPending = 0;
+}
+
+
+static int resolverActive(void) {
+    if (runConf->globals.dnscacheResolverThreads == 0) return 0;
+    if (!ATOMIC_LOAD_32BIT(&resolver.bStarted, &mutResolverState)) resolverStart();
+    return ATOMIC_LOAD_32BIT(&resolver.bRunning, &mutResolverState);
+}
+
+
+/* wait until the resolver has published a name for addr, or is stopped */
+static void ATTR_NONNULL() waitResolved(dnscache_shard_t *const shard,
+                                        const unsigned hash,
+                                        struct sockaddr_storage *const addr) {
+    struct timespec timeout;
+    unsigned seen;
+    int bPending;
+
+    while (1) {
+        pthread_mutex_lock(&resolver.mut);
+        seen = resolver.nCompleted;
+        pthread_mutex_unlock(&resolver.mut);
+
+        pthread_rwlock_rdlock(&shard->rwlock);
+        const dnscache_entry_t *const etry = hashtable_search_prehashed(shard->ht, hash, addr);
+        bPending = (etry != NULL && !etry->bResolved);
+        pthread_rwlock_unlock(&shard->rwlock);
+        if (!bPending) break;
+
+        pthread_mutex_lock(&resolver.mut);
+        if (!resolver.bStop && resolver.nCompleted == seen) {
+            /* timed, so that we cannot miss a synchronous lookup finishing it */
+            clock_gettime(CLOCK_REALTIME, &timeout);
+            timeout.tv_sec += 1;
+            pthread_cond_timedwait(&resolver.done, &resolver.mut, &timeout);
+        }
+        const sbool bStop = resolver.bStop;
+        pthread_mutex_unlock(&resolver.mut);
+        if (bStop) break;
+    }
+}
+
+
+/* look addr up in its shard and hand out the names, if present. An expired
+ * entry is not found in synchronous mode; in async mode it is still used,
+ * but a refresh is queued. Entries the resolver still works on are only
+ * found if bPendingOK.
+ */
+static rsRetVal ATTR_NONNULL(1, 3, 9) lookupCached(dnscache_shard_t *const shard,
+                                                   const unsigned hash,
+                                                   struct sockaddr_storage *const addr,
+                                                   const int bAsync,
+                                                   const int bPendingOK,
+                                                   prop_t **const fqdn,
+                                                   prop_t **const fqdnLowerCase,
+                                                   prop_t **const localName,
+                                                   prop_t **const ip) {
+    DEFiRet;
+
+    pthread_rwlock_rdlock(&shard->rwlock);
+    dnscache_entry_t *const etry = hashtable_search_prehashed(shard->ht, hash, addr);
+    if (etry == NULL || (!etry->bResolved && !bPendingOK)) {
+        ABORT_FINALIZE(RS_RET_NOT_FOUND);
+    }
+    if (entryExpired(etry)) {
+        if (!bAsync) {
+            DBGPRINTF("dnscache: entry timed out; valid until %lld, now %lld\n", (long long)etry->validUntil,
+                      (long long)time(NULL));
+            ABORT_FINALIZE(RS_RET_NOT_FOUND);
+        }
+        /* keep using the old names until the refresh is done */
+        if (ATOMIC_CAS(&etry->bRefreshQueued, 0, 1, &mutRefreshQueued) && resolverEnqueue(addr) != RS_RET_OK) {
+            (void)ATOMIC_CAS(&etry->bRefreshQueued, 1, 0, &mutRefreshQueued); /* try again next time */
+        }
+    }
+    entryGetProps(etry, fqdn, fqdnLowerCase, localName, ip);
 
 finalize_it:
-    if (iRet != RS_RET_OK) {
+    pthread_rwlock_unlock(&shard->rwlock);
+    RETiRet;
+}
+
+
+/* resolve addr in the calling thread and add it. The lookup is done without
+ * any lock held, so a slow resolver only stalls this caller.
+ */
+static rsRetVal ATTR_NONNULL(1, 3, 7) addEntry(dnscache_shard_t *const shard,
+                                               const unsigned hash,
+                                               struct sockaddr_storage *const addr,
+                                               prop_t **const fqdn,
+                                               prop_t **const fqdnLowerCase,
+                                               prop_t **const localName,
+                                               prop_t **const ip) {
+    struct sockaddr_storage *keybuf = NULL;
+    dnscache_entry_t *etry = NULL;
+    DEFiRet;
+
+    CHKmalloc(keybuf = malloc(sizeof(struct sockaddr_storage)));
+    CHKmalloc(etry = calloc(1, sizeof(dnscache_entry_t)));
+    resolveAddr(addr, etry, 1);
+    memcpy(&etry->addr, addr, SALEN((struct sockaddr *)addr));
+    etry->bResolved = 1;
+    entrySetValidity(etry);
+
+    pthread_rwlock_wrlock(&shard->rwlock);
+    dnscache_entry_t *const old = hashtable_search_prehashed(shard->ht, hash, addr);
+    const sbool bWasPending = (old != NULL && !old->bResolved);
+    if (old != NULL && old->bResolved && !entryExpired(old)) {
+        /* another thread was faster */
+        entryGetProps(old, fqdn, fqdnLowerCase, localName, ip);
+        entryDestruct(etry);
         free(keybuf);
+    } else {
+        entryGetProps(etry, fqdn, fqdnLowerCase, localName, ip);
+        if (!replaceEntry(shard, hash, etry, keybuf)) entryDestruct(etry);
+    }
+    pthread_rwlock_unlock(&shard->rwlock);
+    keybuf = NULL;
+    etry = NULL;
+
+    if (bWasPending) resolverNotifyDone(); /* the resolver could not take it */
+
+finalize_it:
+    free(keybuf);
+    free(etry);
+    RETiRet;
+}
+/* async mode miss: add an entry that carries the IP as name and let the
+ * resolver threads look the name up. *pbQueued tells if an entry the
+ * resolver works on (or a resolved one) is now in the table; if not, the
+ * caller must resolve itself.
+ */
+static rsRetVal ATTR_NONNULL() addPendingEntry(dnscache_shard_t *const shard,
+                                               const unsigned hash,
+                                               struct sockaddr_storage *const addr,
+                                               sbool *const pbQueued) {
+    struct sockaddr_storage *keybuf = NULL;
+    dnscache_entry_t *etry = NULL;
+    DEFiRet;
+
+    *pbQueued = 0;
+    CHKmalloc(keybuf = malloc(sizeof(struct sockaddr_storage)));
+    CHKmalloc(etry = calloc(1, sizeof(dnscache_entry_t)));
+    resolveAddr(addr, etry, 0);
+    memcpy(&etry->addr, addr, SALEN((struct sockaddr *)addr));
+
+    pthread_rwlock_wrlock(&shard->rwlock);
+    if (hashtable_search_prehashed(shard->ht, hash, addr) != NULL) {
+        *pbQueued = 1; /* another thread was faster */
+    } else if (resolverEnqueue(addr) == RS_RET_OK) {
+        /* the resolver blocks on our write lock before it can publish */
+        if (replaceEntry(shard, hash, etry, keybuf)) {
+            etry = NULL;
+            *pbQueued = 1;
+        }
+        keybuf = NULL;
     }
+    pthread_rwlock_unlock(&shard->rwlock);
+
+finalize_it:
+    free(keybuf);
+    if (etry != NULL) entryDestruct(etry);
     RETiRet;
 }
 
@@ -378,55 +806,29 @@ static rsRetVal ATTR_NONNULL(1, 5) findEntry(struct sockaddr_storage *const addr
                                              prop_t **const fqdnLowerCase,
                                              prop_t **const localName,
                                              prop_t **const ip) {
+    const unsigned hash = hash_from_key_fn(addr);
+    dnscache_shard_t *const shard = &dnsCache.shards[hash % DNSCACHE_SHARDS];
+    const int bAsync = resolverActive();
+    const int bPublishIP = runConf->globals.dnscachePublishIP;
+    sbool bQueued;
     DEFiRet;
 
-    pthread_rwlock_rdlock(&dnsCache.rwlock);
-    dnscache_entry_t *etry = hashtable_search(dnsCache.ht, addr);
-    DBGPRINTF("findEntry: 1st lookup found %p\n", etry);
-
-    if (etry == NULL || (runConf->globals.dnscacheEnableTTL && (etry->validUntil <= time(NULL)))) {
-        pthread_rwlock_unlock(&dnsCache.rwlock);
-        pthread_rwlock_wrlock(&dnsCache.rwlock);
-        etry = hashtable_search(dnsCache.ht, addr); /* re-query, might have changed */
-        DBGPRINTF("findEntry: 2nd lookup found %p\n", etry);
-        if (etry == NULL || (runConf->globals.dnscacheEnableTTL && (etry->validUntil <= time(NULL)))) {
-            if (etry != NULL) {
-                DBGPRINTF(
-                    "hashtable: entry timed out, discarding it; "
-                    "valid until %lld, now %lld\n",
-                    (long long)etry->validUntil, (long long)time(NULL));
-                dnscache_entry_t *const deleted = hashtable_remove(dnsCache.ht, addr);
-                if (deleted != etry) {
-                    LogError(0, RS_RET_INTERNAL_ERROR,
-                             "dnscache %d: removed different "
-                             "hashtable entry than expected - please report issue; "
-                             "rsyslog version is %s",
-                             __LINE__, VERSION);
-                }
-                entryDestruct(etry);
-            }
-            /* now entry doesn't exist in any case, so let's (re)create it */
-            CHKiRet(addEntry(addr, &etry));
+    iRet = lookupCached(shard, hash, addr, bAsync, bAsync && bPublishIP, fqdn, fqdnLowerCase, localName, ip);
+    if (iRet != RS_RET_NOT_FOUND) FINALIZE;
+
+    if (bAsync) {
+        CHKiRet(addPendingEntry(shard, hash, addr, &bQueued));
+        if (bQueued) {
+            if (!bPublishIP) waitResolved(shard, hash, addr);
+            iRet = lookupCached(shard, hash, addr, bAsync, 1, fqdn, fqdnLowerCase, localName, ip);
+            if (iRet != RS_RET_NOT_FOUND) FINALIZE;
         }
     }
 
-    prop.AddRef(etry->ip);
-    *ip = etry->ip;
-    if (fqdn != NULL) {
-        prop.AddRef(etry->fqdn);
-        *fqdn = etry->fqdn;
-    }
-    if (fqdnLowerCase != NULL) {
-        prop.AddRef(etry->fqdnLowerCase);
-        *fqdnLowerCase = etry->fqdnLowerCase;
-    }
-    if (localName != NULL) {
-        prop.AddRef(etry->localName);
-        *localName = etry->localName;
-    }
+    /* synchronous mode, or the resolver could not take the lookup */
+    CHKiRet(addEntry(shard, hash, addr, fqdn, fqdnLowerCase, localName, ip));
 
 finalize_it:
-    pthread_rwlock_unlock(&dnsCache.rwlock);
     RETiRet;
 }
 
@@ -24,6 +24,7 @@
 
 rsRetVal dnscacheInit(void);
 rsRetVal dnscacheDeinit(void);
+void dnscacheStopResolver(void);
 rsRetVal ATTR_NONNULL(1, 5) dnscacheLookup(struct sockaddr_storage *const addr,
                                            prop_t **const fqdn,
                                            prop_t **const fqdnLowerCase,
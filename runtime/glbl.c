@@ -151,12 +151,16 @@ static struct cnfparamdescr cnfparamdescr[] = {
     {"parser.escapecontrolcharacterscstyle", eCmdHdlrBinary, 0},
     {"parser.parsehostnameandtag", eCmdHdlrBinary, 0},
     {"parser.permitslashinprogramname", eCmdHdlrBinary, 0},
+    {"parser.workerthreads", eCmdHdlrNonNegInt, 0},
     {"stdlog.channelspec", eCmdHdlrString, 0},
     {"janitor.interval", eCmdHdlrPositiveInt, 0},
     {"senders.reportnew", eCmdHdlrBinary, 0},
     {"senders.reportgoneaway", eCmdHdlrBinary, 0},
     {"senders.timeoutafter", eCmdHdlrPositiveInt, 0},
     {"senders.keeptrack", eCmdHdlrBinary, 0},
+    {"stats.latency", eCmdHdlrBinary, 0},
+    {"stats.latency.sampling", eCmdHdlrPositiveInt, 0},
+    {"ruleset.batchexecution", eCmdHdlrBinary, 0},
     {"inputs.timeout.shutdown", eCmdHdlrPositiveInt, 0},
     {"privdrop.group.keepsupplemental", eCmdHdlrBinary, 0},
     {"privdrop.group.id", eCmdHdlrPositiveInt, 0},
@@ -198,6 +202,9 @@ static struct cnfparamdescr cnfparamdescr[] = {
     {"default.ruleset.queue.timeoutworkerthreadshutdown", eCmdHdlrInt, 0},
     {"reverselookup.cache.ttl.default", eCmdHdlrNonNegInt, 0},
     {"reverselookup.cache.ttl.enable", eCmdHdlrBinary, 0},
+    {"reverselookup.cache.ttl.negative", eCmdHdlrNonNegInt, 0},
+    {"reverselookup.resolver.threads", eCmdHdlrNonNegInt, 0},
+    {"reverselookup.resolver.publiship", eCmdHdlrBinary, 0},
     {"parser.supportcompressionextension", eCmdHdlrBinary, 0},
     {"shutdown.queue.doublesize", eCmdHdlrBinary, 0},
     {"debug.files", eCmdHdlrArray, 0},
@@ -1493,6 +1500,8 @@ rsRetVal glblDoneLoadCnf(void) {
             SetParseHOSTNAMEandTAG(tmp);
         } else if (!strcmp(paramblk.descr[i].name, "parser.permitslashinprogramname")) {
             loadConf->globals.parser.bPermitSlashInProgramname = (int)cnfparamvals[i].val.d.n;
+        } else if (!strcmp(paramblk.descr[i].name, "parser.workerthreads")) {
+            loadConf->globals.parser.iWorkerThreads = (int)cnfparamvals[i].val.d.n;
         } else if (!strcmp(paramblk.descr[i].name, "debug.logfile")) {
             if (pszAltDbgFileName == NULL) {
                 pszAltDbgFileName = es_str2cstr(cnfparamvals[i].val.d.estr, NULL);
@@ -1531,6 +1540,12 @@ rsRetVal glblDoneLoadCnf(void) {
             loadConf->globals.senderStatsTimeout = (int)cnfparamvals[i].val.d.n;
         } else if (!strcmp(paramblk.descr[i].name, "senders.keeptrack")) {
             loadConf->globals.senderKeepTrack = (int)cnfparamvals[i].val.d.n;
+        } else if (!strcmp(paramblk.descr[i].name, "stats.latency")) {
+            loadConf->globals.bLatencyStats = (int)cnfparamvals[i].val.d.n;
+        } else if (!strcmp(paramblk.descr[i].name, "stats.latency.sampling")) {
+            loadConf->globals.latencySampling = (int)cnfparamvals[i].val.d.n;
+        } else if (!strcmp(paramblk.descr[i].name, "ruleset.batchexecution")) {
+            loadConf->globals.bRulesetBatchExec = (int)cnfparamvals[i].val.d.n;
         } else if (!strcmp(paramblk.descr[i].name, "inputs.timeout.shutdown")) {
             loadConf->globals.inputTimeoutShutdown = (int)cnfparamvals[i].val.d.n;
         } else if (!strcmp(paramblk.descr[i].name, "privdrop.group.keepsupplemental")) {
@@ -1617,6 +1632,12 @@ rsRetVal glblDoneLoadCnf(void) {
             loadConf->globals.dnscacheDefaultTTL = cnfparamvals[i].val.d.n;
         } else if (!strcmp(paramblk.descr[i].name, "reverselookup.cache.ttl.enable")) {
             loadConf->globals.dnscacheEnableTTL = cnfparamvals[i].val.d.n;
+        } else if (!strcmp(paramblk.descr[i].name, "reverselookup.cache.ttl.negative")) {
+            loadConf->globals.dnscacheNegativeTTL = cnfparamvals[i].val.d.n;
+        } else if (!strcmp(paramblk.descr[i].name, "reverselookup.resolver.threads")) {
+            loadConf->globals.dnscacheResolverThreads = cnfparamvals[i].val.d.n;
+        } else if (!strcmp(paramblk.descr[i].name, "reverselookup.resolver.publiship")) {
+            loadConf->globals.dnscachePublishIP = cnfparamvals[i].val.d.n;
         } else if (!strcmp(paramblk.descr[i].name, "parser.supportcompressionextension")) {
             loadConf->globals.bSupportCompressionExtension = cnfparamvals[i].val.d.n;
         } else {
@@ -0,0 +1,323 @@
+/* The httppipe object.
+ *
+ * Keeps up to a fixed number of HTTP requests of one action worker in flight
+ * at the same time on top of a libcurl multi handle, on separate connections
+ * or multiplexed over one HTTP/2 connection where libcurl and the server
+ * negotiate it. Each request runs in a slot with its own, reused easy handle.
+ * The output module configures the handles, builds the requests and evaluates
+ * the responses in its done callback; the object drives the transfers and
+ * remembers the first failure, so that the module can fail (and the core
+ * retry) the whole transaction as it would with sequential requests.
+ *
+ * Not thread-safe; every action worker has its own instance.
+ *
+ * Copyright 2026 Adiscon GmbH.
+ *
+ * This file is part of the rsyslog runtime library.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *       -or-
+ *       see COPYING.ASL20 in the source distribution
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "config.h"
+#include <stdlib.h>
+#include <assert.h>
+#include <curl/curl.h>
+
+#include "rsyslog.h"
+#include "module-template.h"
+#include "obj.h"
+#include "errmsg.h"
+#include "debug.h"
+#include "httppipe.h"
+
+MODULE_TYPE_LIB
+MODULE_TYPE_NOKEEP;
+
+/* static data */
+DEFobjStaticHelpers;
+
+typedef struct httppipeSlot_s {
+    CURL *handle;
+    sbool inUse;
+} httppipeSlot_t;
+
+struct httppipe_s {
+    CURLM *multi; /* drives the slots' transfers */
+    httppipeSlot_t *slots;
+    int nSlots;
+    int nInFlight;
+    rsRetVal iRetErr; /* first failure since the last Drain() */
+    const char *modName; /* for error messages, must outlive the object */
+    httppipeDone_t pfDone;
+    httppipeAbandon_t pfAbandon;
+    void *pUsr;
+};
+
+
+/* ------------------------------ methods ------------------------------ */
+
+/* give up on all requests still in flight */
+static void ATTR_NONNULL() httppipeAbort(httppipe_t *const pThis) {
+    for (int i = 0; i < pThis->nSlots; ++i) {
+        if (pThis->slots[i].inUse) {
+            curl_multi_remove_handle(pThis->multi, pThis->slots[i].handle);
+            pThis->slots[i].inUse = 0;
+            pThis->nInFlight--;
+            pThis->pfAbandon(pThis->pUsr, i);
+        }
+    }
+    pThis->iRetErr = RS_RET_SUSPENDED;
+}
+
+
+/* Drive the transfers until no more than maxInFlight requests are
+ * outstanding. With maxInFlight == nSlots this just pushes pending transfers
+ * along without waiting. Returns the first failure since the last Drain().
+ */
+static rsRetVal ATTR_NONNULL() httppipeWait(httppipe_t *const pThis, const int maxInFlight) {
+    CURLMsg *msg;
+    CURLMcode mcode;
+    rsRetVal localRet;
+    int running;
+    int msgsLeft;
+    DEFiRet;
+
+    for (;;) {
+        mcode = curl_multi_perform(pThis->multi, &running);
+        if (mcode != CURLM_OK) {
+            LogError(0, RS_RET_SUSPENDED, "%s: curl_multi_perform failed: %s", pThis->modName,
+                     curl_multi_strerror(mcode));
+            httppipeAbort(pThis);
+            FINALIZE;
+        }
+        while ((msg = curl_multi_info_read(pThis->multi, &msgsLeft)) != NULL) {
+            if (msg->msg == CURLMSG_DONE) {
+                CURL *const handle = msg->easy_handle;
+                const CURLcode curlCode = msg->data.result;
+                char *priv = NULL;
+                curl_easy_getinfo(handle, CURLINFO_PRIVATE, &priv);
+                curl_multi_remove_handle(pThis->multi, handle);
+                httppipeSlot_t *const slot = (httppipeSlot_t *)priv;
+                localRet = pThis->pfDone(pThis->pUsr, (int)(slot - pThis->slots), handle, curlCode);
+                if (localRet != RS_RET_OK && pThis->iRetErr == RS_RET_OK) pThis->iRetErr = localRet;
+                slot->inUse = 0;
+                pThis->nInFlight--;
+            }
+        }
+        if (pThis->nInFlight <= maxInFlight) break;
+        mcode = curl_multi_wait(pThis->multi, NULL, 0, 1000, NULL);
+        if (mcode != CURLM_OK) {
+            LogError(0, RS_RET_SUSPENDED, "%s: curl_multi_wait failed: %s", pThis->modName,
+                     curl_multi_strerror(mcode));
+            httppipeAbort(pThis);
+            FINALIZE;
+        }
+    }
+
+finalize_it:
+    iRet = pThis->iRetErr;
+    RETiRet;
+}
+
+
+/* Wait for all requests and return the first failure since the last call,
+ * which is then forgotten. Used at the end of a transaction, and at the
+ * start of one to settle what an aborted one left behind.
+ */
+static rsRetVal ATTR_NONNULL() httppipeDrain(httppipe_t *const pThis) {
+    DEFiRet;
+    iRet = httppipeWait(pThis, 0);
+    pThis->iRetErr = RS_RET_OK;
+    RETiRet;
+}
+
+
+/* Find a slot for the next request, waiting for one to become free if
+ * needed. The caller sets up the slot's handle and then calls Start().
+ */
+static rsRetVal ATTR_NONNULL() httppipeGetFreeSlot(httppipe_t *const pThis, int *const pSlot) {
+    DEFiRet;
+
+    CHKiRet(httppipeWait(pThis, pThis->nSlots - 1));
+    for (int i = 0; i < pThis->nSlots; ++i) {
+        if (!pThis->slots[i].inUse) {
+            *pSlot = i;
+            FINALIZE;
+        }
+    }
+    assert(0); /* Wait() guarantees a free slot */
+    ABORT_FINALIZE(RS_RET_ERR);
+
+finalize_it:
+    RETiRet;
+}
+
+
+/* Hand the request set up in @p slot to libcurl, as HTTP/2 where possible.
+ * Nothing is sent before the next Wait(), so the caller can still record
+ * what it needs for the done callback. On error, the request was not started.
+ */
+static rsRetVal ATTR_NONNULL() httppipeStart(httppipe_t *const pThis, const int slot) {
+    CURLMcode mcode;
+    DEFiRet;
+
+    assert(slot >= 0 && slot < pThis->nSlots && !pThis->slots[slot].inUse);
+    CURL *const handle = pThis->slots[slot].handle;
+#if LIBCURL_VERSION_NUM >= 0x072f00 /* 7.47.0 */
+    /* set here, as the module's handle setup usually asks for HTTP/1.1:
+     * HTTP/2 where TLS lets us negotiate it, HTTP/1.1 otherwise
+     */
+    if (curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS) != CURLE_OK)
+        DBGPRINTF("%s: HTTP/2 not supported by libcurl\n", pThis->modName);
+    /* rather wait for a multiplexed stream than open another connection */
+    if (curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L) != CURLE_OK)
+        DBGPRINTF("%s: unknown option CURLOPT_PIPEWAIT\n", pThis->modName);
+#endif
+    mcode = curl_multi_add_handle(pThis->multi, handle);
+    if (mcode != CURLM_OK) {
+        LogError(0, RS_RET_SUSPENDED, "%s: curl_multi_add_handle failed: %s", pThis->modName,
+                 curl_multi_strerror(mcode));
+        ABORT_FINALIZE(RS_RET_SUSPENDED);
+    }
+    pThis->slots[slot].inUse = 1;
+    pThis->nInFlight++;
+    DBGPRINTF("%s: pipelined request started, %d in flight\n", pThis->modName, pThis->nInFlight);
+
+finalize_it:
+    RETiRet;
+}
+
+
+/* the easy handle of @p slot, for the caller to set its options */
+static CURL *ATTR_NONNULL() httppipeGetHandle(httppipe_t *const pThis, const int slot) {
+    assert(slot >= 0 && slot < pThis->nSlots);
+    return pThis->slots[slot].handle;
+}
+
+
+/* Destruct the pipeline. Requests still in flight are abandoned. */
+static void httppipeDestruct(httppipe_t **const ppThis) {
+    httppipe_t *const pThis = *ppThis;
+
+    if (pThis == NULL) return;
+    if (pThis->multi != NULL) httppipeAbort(pThis);
+    if (pThis->slots != NULL) {
+        for (int i = 0; i < pThis->nSlots; ++i) curl_easy_cleanup(pThis->slots[i].handle);
+        free(pThis->slots);
+    }
+    if (pThis->multi != NULL) curl_multi_cleanup(pThis->multi);
+    free(pThis);
+    *ppThis = NULL;
+}
+
+
+/* Construct a pipeline with @p nSlots slots. The caller sets up the easy
+ * handles through GetHandle(). CURLOPT_PRIVATE is used by the pipeline and
+ * must not be changed.
+ */
+static rsRetVal ATTR_NONNULL(1, 3, 4, 5) httppipeConstruct(httppipe_t **const ppThis,
+                                                           const int nSlots,
+                                                           const char *const modName,
+                                                           const httppipeDone_t pfDone,
+                                                           const httppipeAbandon_t pfAbandon,
+                                                           void *const pUsr) {
+    httppipe_t *pThis = NULL;
+    DEFiRet;
+
+    assert(nSlots > 0);
+    CHKmalloc(pThis = calloc(1, sizeof(httppipe_t)));
+    pThis->modName = modName;
+    pThis->pfDone = pfDone;
+    pThis->pfAbandon = pfAbandon;
+    pThis->pUsr = pUsr;
+    pThis->iRetErr = RS_RET_OK;
+    CHKmalloc(pThis->slots = calloc((size_t)nSlots, sizeof(httppipeSlot_t)));
+    pThis->nSlots = nSlots;
+
+    CHKmalloc(pThis->multi = curl_multi_init());
+#ifdef CURLPIPE_MULTIPLEX
+    /* send concurrent requests as HTTP/2 streams over one connection if possible */
+    curl_multi_setopt(pThis->multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+    curl_multi_setopt(pThis->multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)nSlots);
+    for (int i = 0; i < nSlots; ++i) {
+        CHKmalloc(pThis->slots[i].handle = curl_easy_init());
+        curl_easy_setopt(pThis->slots[i].handle, CURLOPT_PRIVATE, &pThis->slots[i]);
+    }
+    *ppThis = pThis;
+
+finalize_it:
+    if (iRet != RS_RET_OK) httppipeDestruct(&pThis);
+    RETiRet;
+}
+
+
+/* queryInterface function
+ */
+BEGINobjQueryInterface(httppipe)
+    CODESTARTobjQueryInterface(httppipe);
+    if (pIf->ifVersion != httppipeCURR_IF_VERSION) { /* check for current version, increment on each change */
+        ABORT_FINALIZE(RS_RET_INTERFACE_NOT_SUPPORTED);
+    }
+
+    pIf->Construct = httppipeConstruct;
+    pIf->Destruct = httppipeDestruct;
+    pIf->GetHandle = httppipeGetHandle;
+    pIf->GetFreeSlot = httppipeGetFreeSlot;
+    pIf->Start = httppipeStart;
+    pIf->Wait = httppipeWait;
+    pIf->Drain = httppipeDrain;
+finalize_it:
+ENDobjQueryInterface(httppipe)
+
+
+/* Initialize the httppipe class. Must be called as the very first method
+ * before anything else is called inside this class.
+ */
+BEGINAbstractObjClassInit(httppipe, 1, OBJ_IS_LOADABLE_MODULE) /* class, version */
+    /* request objects we use */
+
+    /* set our own handlers */
+ENDObjClassInit(httppipe)
+
+
+/* Exit the class. */
+BEGINObjClassExit(httppipe, OBJ_IS_LOADABLE_MODULE) /* class, version */
+    CODESTARTObjClassExit(httppipe);
+ENDObjClassExit(httppipe)
+
+
+/* --------------- here now comes the plumbing that makes as a library module --------------- */
+
+
+BEGINmodExit
+    CODESTARTmodExit;
+    httppipeClassExit();
+ENDmodExit
+
+
+BEGINqueryEtryPt
+    CODESTARTqueryEtryPt;
+    CODEqueryEtryPt_STD_LIB_QUERIES;
+ENDqueryEtryPt
+
+
+BEGINmodInit()
+    CODESTARTmodInit;
+    *ipIFVersProvided = CURR_MOD_IF_VERSION; /* we only support the current interface specification */
+
+    /* Initialize all classes that are in our module - this includes ourselfs */
+    CHKiRet(httppipeClassInit(pModInfo));
+ENDmodInit
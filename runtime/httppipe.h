@@ -0,0 +1,63 @@
+/* The httppipe object. It keeps a number of HTTP requests of one action
+ * worker in flight at the same time on top of a libcurl multi handle. It is
+ * shared by the HTTP output modules, which build the requests and evaluate
+ * the responses themselves.
+ *
+ * Copyright 2026 Adiscon GmbH.
+ *
+ * This file is part of the rsyslog runtime library.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *       -or-
+ *       see COPYING.ASL20 in the source distribution
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef INCLUDED_HTTPPIPE_H
+#define INCLUDED_HTTPPIPE_H
+
+#include <curl/curl.h>
+
+typedef struct httppipe_s httppipe_t;
+
+/* Called for every finished request with the slot it ran in. The return value
+ * is the request's result; the first one that is not RS_RET_OK becomes the
+ * result of the pipeline until Drain() hands it out.
+ */
+typedef rsRetVal (*httppipeDone_t)(void *pUsr, int slot, CURL *handle, CURLcode curlCode);
+/* called for every request given up on without a response */
+typedef void (*httppipeAbandon_t)(void *pUsr, int slot);
+
+/* interfaces */
+BEGINinterface(httppipe) /* name must also be changed in ENDinterface macro! */
+    rsRetVal (*Construct)(httppipe_t **ppThis,
+                          int nSlots,
+                          const char *modName,
+                          httppipeDone_t pfDone,
+                          httppipeAbandon_t pfAbandon,
+                          void *pUsr);
+    void (*Destruct)(httppipe_t **ppThis);
+    CURL *(*GetHandle)(httppipe_t *pThis, int slot);
+    rsRetVal (*GetFreeSlot)(httppipe_t *pThis, int *pSlot);
+    rsRetVal (*Start)(httppipe_t *pThis, int slot);
+    rsRetVal (*Wait)(httppipe_t *pThis, int maxInFlight);
+    rsRetVal (*Drain)(httppipe_t *pThis);
+ENDinterface(httppipe)
+#define httppipeCURR_IF_VERSION 1 /* increment whenever you change the interface structure! */
+
+
+/* prototypes */
+PROTOTYPEObj(httppipe);
+
+/* the name of our library binary */
+#define LM_HTTPPIPE_FILENAME "lmhttppipe"
+
+#endif /* #ifndef INCLUDED_HTTPPIPE_H */
@@ -0,0 +1,256 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file jsoncow.c
+ * @brief Copy-on-write support for JSON trees shared between messages.
+ *
+ * The private containers are kept in an open addressing pointer set. Entries
+ * are never removed individually, so no tombstones are needed. Sharing
+ * relies on json-c reference counts being updated atomically, which
+ * libfastjson does.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <json.h>
+#include "rsyslog.h"
+#include "jsoncow.h"
+
+#define JSONCOW_INITIAL_SIZE 16 /* must be a power of 2 */
+
+struct jsoncow_s {
+    const struct json_object **slots; /* NULL until the first container is owned */
+    unsigned size;
+    unsigned n;
+};
+
+
+static unsigned hashPtr(const struct json_object *const json, const unsigned size) {
+    return (unsigned)(((uintptr_t)json >> 4) * 2654435761u) & (size - 1);
+}
+
+
+static int isContainer(struct json_object *const json) {
+    const enum json_type type = json_object_get_type(json);
+    return type == json_type_object || type == json_type_array;
+}
+
+
+static void insertSlot(const struct json_object **const slots, const unsigned size, const struct json_object *json) {
+    unsigned i = hashPtr(json, size);
+    while (slots[i] != NULL && slots[i] != json) i = (i + 1) & (size - 1);
+    slots[i] = json;
+}
+
+
+static rsRetVal growSet(jsoncow_t *const pThis) {
+    const unsigned newSize = (pThis->size == 0) ? JSONCOW_INITIAL_SIZE : pThis->size * 2;
+    const struct json_object **newSlots;
+    DEFiRet;
+
+    CHKmalloc(newSlots = calloc(newSize, sizeof(*newSlots)));
+    for (unsigned i = 0; i < pThis->size; ++i) {
+        if (pThis->slots[i] != NULL) insertSlot(newSlots, newSize, pThis->slots[i]);
+    }
+    free(pThis->slots);
+    pThis->slots = newSlots;
+    pThis->size = newSize;
+
+finalize_it:
+    RETiRet;
+}
+
+
+/* shallow copy of a container: a new node referencing the same children */
+static struct json_object *copyContainer(struct json_object *const src) {
+    struct json_object *dst;
+
+    if (json_object_get_type(src) == json_type_object) {
+        if ((dst = json_object_new_object()) == NULL) return NULL;
+        struct json_object_iterator it = json_object_iter_begin(src);
+        struct json_object_iterator itEnd = json_object_iter_end(src);
+        while (!json_object_iter_equal(&it, &itEnd)) {
+            json_object_object_add(dst, json_object_iter_peek_name(&it),
+                                   json_object_get(json_object_iter_peek_value(&it)));
+            json_object_iter_next(&it);
+        }
+    } else {
+        const int len = json_object_array_length(src);
+        if ((dst = json_object_new_array()) == NULL) return NULL;
+        for (int i = 0; i < len; ++i) {
+            struct json_object *const elem = json_object_get(json_object_array_get_idx(src, i));
+            if (json_object_array_add(dst, elem) != 0) {
+                json_object_put(elem);
+                json_object_put(dst);
+                return NULL;
+            }
+        }
+    }
+    return dst;
+}
+
+
+/* sets *ppCopy to a private copy of json, already recorded as owned, or to
+ * NULL if json can be modified as is
+ */
+static rsRetVal privateCopy(jsoncow_t *const pThis, struct json_object *const json, struct json_object **const ppCopy) {
+    struct json_object *copy = NULL;
+    DEFiRet;
+
+    *ppCopy = NULL;
+    if (json == NULL || !isContainer(json) || jsoncowIsOwned(pThis, json)) FINALIZE;
+    CHKmalloc(copy = copyContainer(json));
+    CHKiRet(jsoncowAddOwned(pThis, copy));
+    *ppCopy = copy;
+    copy = NULL;
+
+finalize_it:
+    if (copy != NULL) json_object_put(copy);
+    RETiRet;
+}
+
+
+rsRetVal jsoncowConstruct(jsoncow_t **const ppThis) {
+    DEFiRet;
+    CHKmalloc(*ppThis = calloc(1, sizeof(jsoncow_t)));
+finalize_it:
+    RETiRet;
+}
+
+
+void jsoncowDestruct(jsoncow_t **const ppThis) {
+    if (*ppThis == NULL) return;
+    free((*ppThis)->slots);
+    free(*ppThis);
+    *ppThis = NULL;
+}
+
+
+void jsoncowReset(jsoncow_t *const pThis) {
+    if (pThis->n == 0) return;
+    memset(pThis->slots, 0, pThis->size * sizeof(*pThis->slots));
+    pThis->n = 0;
+}
+
+
+rsRetVal jsoncowAddOwned(jsoncow_t *const pThis, struct json_object *const json) {
+    DEFiRet;
+
+    if (json == NULL || !isContainer(json) || jsoncowIsOwned(pThis, json)) FINALIZE;
+    if ((pThis->n + 1) * 2 > pThis->size) CHKiRet(growSet(pThis));
+    insertSlot(pThis->slots, pThis->size, json);
+    ++pThis->n;
+
+finalize_it:
+    RETiRet;
+}
+
+
+int jsoncowIsOwned(const jsoncow_t *const pThis, const struct json_object *const json) {
+    if (pThis->n == 0) return 0;
+    for (unsigned i = hashPtr(json, pThis->size); pThis->slots[i] != NULL; i = (i + 1) & (pThis->size - 1)) {
+        if (pThis->slots[i] == json) return 1;
+    }
+    return 0;
+}
+
+
+rsRetVal jsoncowOwnRoot(jsoncow_t *const pThis, struct json_object **const ppRoot) {
+    struct json_object *copy;
+    DEFiRet;
+
+    CHKiRet(privateCopy(pThis, *ppRoot, &copy));
+    if (copy != NULL) {
+        json_object_put(*ppRoot);
+        *ppRoot = copy;
+    }
+
+finalize_it:
+    RETiRet;
+}
+
+
+rsRetVal jsoncowOwnMember(jsoncow_t *const pThis,
+                          struct json_object *const parent,
+                          const char *const key,
+                          struct json_object **const ppMember) {
+    struct json_object *copy;
+    DEFiRet;
+
+    CHKiRet(privateCopy(pThis, *ppMember, &copy));
+    if (copy != NULL) {
+        json_object_object_add(parent, key, copy); /* drops the parent's reference to the shared node */
+        *ppMember = copy;
+    }
+
+finalize_it:
+    RETiRet;
+}
+
+
+rsRetVal jsoncowOwnElement(jsoncow_t *const pThis,
+                           struct json_object *const array,
+                           const int idx,
+                           struct json_object **const ppElem) {
+    struct json_object *copy;
+    DEFiRet;
+
+    CHKiRet(privateCopy(pThis, *ppElem, &copy));
+    if (copy != NULL) {
+        /* idx is within the array, so this only replaces and cannot fail */
+        json_object_array_put_idx(array, idx, copy);
+        *ppElem = copy;
+    }
+
+finalize_it:
+    RETiRet;
+}
+
+
+char *jsoncowRenderDup(struct json_object *const json, const int flags) {
+    struct json_object *view;
+    const char *str;
+    size_t len;
+    char *res = NULL;
+
+    if (json == NULL) return NULL;
+    if (isContainer(json)) {
+        view = copyContainer(json);
+    } else if ((view = json_object_new_array()) != NULL) {
+        /* a scalar is rendered as the only element of a private array, so
+         * that it keeps its own serializer, e.g. the text of a parsed number
+         */
+        if (json_object_array_add(view, json_object_get(json)) != 0) {
+            json_object_put(json);
+            json_object_put(view);
+            view = NULL;
+        }
+    }
+    if (view == NULL) return NULL;
+    if ((str = json_object_to_json_string_ext(view, flags)) == NULL) goto done;
+    len = strlen(str);
+    if (!isContainer(json)) {
+        /* strip the brackets and whatever whitespace the flags put around the element */
+        while (len > 0 && (str[len - 1] == ']' || isspace((unsigned char)str[len - 1]))) --len;
+        while (len > 0 && (*str == '[' || isspace((unsigned char)*str))) ++str, --len;
+    }
+    if ((res = malloc(len + 1)) != NULL) {
+        memcpy(res, str, len);
+        res[len] = '\0';
+    }
+done:
+    json_object_put(view);
+    return res;
+}
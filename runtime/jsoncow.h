@@ -0,0 +1,96 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file jsoncow.h
+ * @brief Copy-on-write support for JSON trees shared between messages.
+ *
+ * MsgDup() hands the duplicate a reference to the original's JSON trees
+ * instead of a deep copy. From then on, neither message may modify a
+ * container node in place that the other one can still reach. A jsoncow_t
+ * records which containers a message made private since the trees were
+ * shared; before a write, every container on the path to the modified node
+ * is "owned": if it is not private yet, it is replaced by a shallow copy
+ * that references the same children. So a write costs copies of the nodes
+ * along one path, not of the whole tree.
+ *
+ * Scalars are never modified in place and thus never copied. Reading a
+ * shared tree is fine, with one exception: json-c renders an object into a
+ * buffer inside that object, so a shared tree must be rendered through
+ * jsoncowRenderDup().
+ *
+ * Stale entries are harmless: an address that is freed and reused while a
+ * message is in copy-on-write mode can only belong to a node the message
+ * created itself, as nodes only become shared through MsgDup(), which
+ * resets the set.
+ */
+#ifndef INCLUDED_JSONCOW_H
+#define INCLUDED_JSONCOW_H
+
+#include <json.h>
+#include "rsyslog.h"
+
+typedef struct jsoncow_s jsoncow_t;
+
+/** @brief Create an empty set: nothing is private, every container is shared. */
+rsRetVal jsoncowConstruct(jsoncow_t **ppThis);
+
+/** @brief Free the set; *ppThis is set to NULL. */
+void jsoncowDestruct(jsoncow_t **ppThis);
+
+/** @brief Forget all private containers, e.g. because the tree was shared again. */
+void jsoncowReset(jsoncow_t *pThis);
+
+/** @brief Record a container the caller created itself as private; scalars are ignored. */
+rsRetVal jsoncowAddOwned(jsoncow_t *pThis, struct json_object *json);
+
+/** @brief Check whether @p json may be modified in place. */
+int jsoncowIsOwned(const jsoncow_t *pThis, const struct json_object *json);
+
+/**
+ * @brief Make the root of a tree private.
+ * @param ppRoot the root; replaced by a private copy if needed, in which
+ *        case the reference to the old root is dropped
+ */
+rsRetVal jsoncowOwnRoot(jsoncow_t *pThis, struct json_object **ppRoot);
+
+/**
+ * @brief Make a member of a private object private.
+ * @param parent    private object containing the member
+ * @param key       name of the member in @p parent
+ * @param ppMember  current value of the member; replaced by, and stored in
+ *                  @p parent as, a private copy if it is a shared container
+ */
+rsRetVal jsoncowOwnMember(jsoncow_t *pThis, struct json_object *parent, const char *key, struct json_object **ppMember);
+
+/**
+ * @brief Make an element of a private array private.
+ * @param array   private array containing the element
+ * @param idx     index of the element in @p array
+ * @param ppElem  current element; replaced like in jsoncowOwnMember()
+ */
+rsRetVal jsoncowOwnElement(jsoncow_t *pThis, struct json_object *array, int idx, struct json_object **ppElem);
+
+/**
+ * @brief Render a possibly shared node without touching its buffer.
+ *
+ * Containers are copied shallowly and the copy is rendered, which renders
+ * the children into the copy's buffer. Scalars are rendered as the element
+ * of a private array, so they keep their serializer; the brackets are
+ * stripped from the result.
+ * @param flags json-c JSON_C_TO_STRING_* flags
+ * @return a malloc()ed string the caller must free, NULL if out of memory or
+ *         if @p json is NULL
+ */
+char *jsoncowRenderDup(struct json_object *json, int flags);
+
+#endif /* #ifndef INCLUDED_JSONCOW_H */
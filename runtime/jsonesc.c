@@ -0,0 +1,108 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file jsonesc.c
+ * @brief Vectorized JSON string escaping for property values.
+ *
+ * The escape sequences are the ones msg.c always produced: the RFC 4627
+ * short forms where they exist, "\u00XX" with upper case hex digits for the
+ * other control characters.
+ */
+#include "config.h"
+#include <string.h>
+#include "jsonesc.h"
+
+static const char hexdigit[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
+
+
+/* escape the character at *ppSrc, which needs escaping; returns bytes written */
+static size_t encodeOne(const unsigned char **const ppSrc,
+                        const unsigned char *const end,
+                        unsigned char *const w,
+                        const int escapeAll) {
+    const unsigned char *src = *ppSrc;
+    const unsigned char c = *src++;
+    size_t n = 2;
+
+    w[0] = '\\';
+    switch (c) {
+        case '"':
+        case '/':
+            w[1] = c;
+            break;
+        case '\\':
+            w[1] = '\\';
+            if (!escapeAll && src < end) {
+                const unsigned char nc = *src;
+                /* attempt to not double encode */
+                if (nc == '"' || nc == '/' || nc == '\\' || nc == 'b' || nc == 'f' || nc == 'n' || nc == 'r' ||
+                    nc == 't' || nc == 'u') {
+                    w[1] = nc;
+                    ++src;
+                }
+            }
+            break;
+        case '\010':
+            w[1] = 'b';
+            break;
+        case '\014':
+            w[1] = 'f';
+            break;
+        case '\n':
+            w[1] = 'n';
+            break;
+        case '\r':
+            w[1] = 'r';
+            break;
+        case '\t':
+            w[1] = 't';
+            break;
+        default:
+            /* remaining control characters; bytes 0x80 and above never get
+             * here, they are copied as is and not checked for valid UTF-8
+             */
+            w[1] = 'u';
+            w[2] = '0';
+            w[3] = '0';
+            w[4] = hexdigit[c >> 4];
+            w[5] = hexdigit[c & 0xf];
+            n = 6;
+            break;
+    }
+    *ppSrc = src;
+    return n;
+}
+
+
+size_t jsonescEncode(const unsigned char **const ppSrc,
+                     const unsigned char *const end,
+                     unsigned char *const dst,
+                     const size_t dstSize,
+                     const int escapeAll) {
+    const unsigned char *src = *ppSrc;
+    unsigned char *w = dst;
+    unsigned char *const dstEnd = dst + dstSize;
+
+    while (src < end) {
+        const unsigned char *const clean = jsonescScan(src, end);
+        size_t run = (size_t)(clean - src);
+        if (run > (size_t)(dstEnd - w)) run = (size_t)(dstEnd - w);
+        memcpy(w, src, run);
+        w += run;
+        src += run;
+        if (src != clean || src == end || dstEnd - w < JSONESC_MAX_SEQ) break;
+        w += encodeOne(&src, end, w, escapeAll);
+    }
+    *ppSrc = src;
+    return (size_t)(w - dst);
+}
@@ -0,0 +1,132 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file jsonesc.h
+ * @brief Vectorized JSON string escaping for property values.
+ *
+ * Values rendered as JSON (property option "json"/"jsonr", jsonf templates)
+ * usually contain long runs that need no escaping at all. jsonescScan()
+ * finds the next byte that must be escaped 32 or 16 bytes at a time, using
+ * AVX2, SSE2 or NEON when the compiler targets them and a scalar loop
+ * otherwise, so that jsonescEncode() can copy the clean runs in bulk.
+ *
+ * Escaped are control characters, the quote, the slash and the backslash.
+ * Bytes 0x80 and above are copied as is; they are expected to be UTF-8.
+ */
+#ifndef INCLUDED_JSONESC_H
+#define INCLUDED_JSONESC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+#endif
+
+/** @brief Longest escape sequence emitted for a single input character ("\u001F"). */
+#define JSONESC_MAX_SEQ 6
+
+static inline int jsonescNeedsEscape(const unsigned char c) {
+    return c < 0x20 || c == '"' || c == '/' || c == '\\';
+}
+
+static inline const unsigned char *jsonescScanScalar(const unsigned char *p, const unsigned char *const end) {
+    while (p < end && !jsonescNeedsEscape(*p)) ++p;
+    return p;
+}
+
+/**
+ * @brief Locate the first byte that must be escaped.
+ *
+ * Only full vector loads that stay inside [p, end) are issued.
+ * @return pointer to that byte, or @p end if the region is clean
+ */
+static inline const unsigned char *jsonescScan(const unsigned char *p, const unsigned char *const end) {
+#if defined(__AVX2__)
+    {
+        const __m256i ctl = _mm256_set1_epi8(0x1f);
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i slash = _mm256_set1_epi8('/');
+        const __m256i bslash = _mm256_set1_epi8('\\');
+        while (end - p >= 32) {
+            const __m256i chunk = _mm256_loadu_si256((const __m256i *)p);
+            /* unsigned chunk <= 0x1f: the minimum is the chunk itself */
+            const __m256i hit =
+                _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(chunk, ctl), chunk),
+                                                _mm256_cmpeq_epi8(chunk, quote)),
+                                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, slash), _mm256_cmpeq_epi8(chunk, bslash)));
+            const uint32_t mask = (uint32_t)_mm256_movemask_epi8(hit);
+            if (mask != 0) return p + __builtin_ctz(mask);
+            p += 32;
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    {
+        const __m128i ctl = _mm_set1_epi8(0x1f);
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i slash = _mm_set1_epi8('/');
+        const __m128i bslash = _mm_set1_epi8('\\');
+        while (end - p >= 16) {
+            const __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+            const __m128i hit = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(chunk, ctl), chunk), _mm_cmpeq_epi8(chunk, quote)),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, slash), _mm_cmpeq_epi8(chunk, bslash)));
+            const unsigned mask = (unsigned)_mm_movemask_epi8(hit);
+            if (mask != 0) return p + __builtin_ctz(mask);
+            p += 16;
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    {
+        const uint8x16_t ctl = vdupq_n_u8(0x1f);
+        const uint8x16_t quote = vdupq_n_u8('"');
+        const uint8x16_t slash = vdupq_n_u8('/');
+        const uint8x16_t bslash = vdupq_n_u8('\\');
+        while (end - p >= 16) {
+            const uint8x16_t chunk = vld1q_u8(p);
+            const uint8x16_t hit = vorrq_u8(vorrq_u8(vcleq_u8(chunk, ctl), vceqq_u8(chunk, quote)),
+                                            vorrq_u8(vceqq_u8(chunk, slash), vceqq_u8(chunk, bslash)));
+            /* narrow each 16-bit lane by 4 to obtain a 4-bits-per-byte mask */
+            const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+            if (mask != 0) return p + (__builtin_ctzll(mask) >> 2);
+            p += 16;
+        }
+    }
+#endif
+    return jsonescScanScalar(p, end);
+}
+
+/**
+ * @brief JSON-escape as much of [*ppSrc, end) as fits into @p dst.
+ *
+ * Call repeatedly until *ppSrc reaches @p end; every call makes progress.
+ * @param ppSrc     start of the input, advanced past what was consumed
+ * @param end       one past the last input byte
+ * @param dst       output buffer
+ * @param dstSize   size of @p dst, at least JSONESC_MAX_SEQ
+ * @param escapeAll if 0, backslash sequences that already look like JSON
+ *                  escapes are copied instead of being escaped again
+ * @return number of bytes written to @p dst
+ */
+size_t jsonescEncode(const unsigned char **ppSrc,
+                     const unsigned char *end,
+                     unsigned char *dst,
+                     size_t dstSize,
+                     int escapeAll);
+
+#endif /* #ifndef INCLUDED_JSONESC_H */
@@ -29,6 +29,7 @@
 #include <unistd.h>
 #include <json.h>
 #include <assert.h>
+#include <time.h>
 
 #include "rsyslog.h"
 #include "srUtils.h"
@@ -39,11 +40,14 @@
 #include "dirty.h"
 #include "unicode-helper.h"
 #include "regexp.h"
+#include "statsobj.h"
+#include "rxset.h"
 
 PRAGMA_IGNORE_Wdeprecated_declarations
     /* definitions for objects we access */
     DEFobjStaticHelpers;
 DEFobjCurrIf(glbl)
+DEFobjCurrIf(statsobj)
 #ifdef FEATURE_REGEXP
     DEFobjCurrIf(regexp)
 #endif
@@ -128,6 +132,10 @@ static rsRetVal lookupNew(lookup_ref_t **ppThis) {
 
     pThis->next = NULL;
     pThis->self = t;
+    t->ref = pThis;
+    STATSCOUNTER_INIT(pThis->ctrLookups, pThis->mutCtrLookups);
+    STATSCOUNTER_INIT(pThis->ctrMatchTime, pThis->mutCtrMatchTime);
+    STATSCOUNTER_INIT(pThis->ctrRegexFallback, pThis->mutCtrRegexFallback);
 
     *ppThis = pThis;
 finalize_it:
@@ -161,7 +169,17 @@ static rsRetVal lookupActivateTable(lookup_ref_t *pThis) {
     CHKiConcCtrl(pthread_create(&pThis->reloader, &pThis->reloader_thd_attr, lookupTableReloader, pThis));
     pThis->reloader_started = 1;
     initialized++; /*5*/
-
+    CHKiRet(statsobj.Construct(&pThis->stats));
+    CHKiRet(statsobj.SetOrigin(pThis->stats, UCHAR_CONSTANT("lookup")));
+    CHKiRet(statsobj.SetName(pThis->stats, pThis->name));
+    CHKiRet(statsobj.AddCounter(pThis->stats, UCHAR_CONSTANT("lookups"), ctrType_IntCtr, CTR_FLAG_RESETTABLE,
+                                &pThis->ctrLookups));
+    CHKiRet(statsobj.AddCounter(pThis->stats, UCHAR_CONSTANT("time.ns"), ctrType_IntCtr, CTR_FLAG_RESETTABLE,
+                                &pThis->ctrMatchTime));
+    CHKiRet(statsobj.AddCounter(pThis->stats, UCHAR_CONSTANT("regex.undecided"), ctrType_IntCtr, CTR_FLAG_RESETTABLE,
+                                &pThis->ctrRegexFallback));
+    CHKiRet(statsobj.ConstructFinalize(pThis->stats));
+    initialized++; /*6*/
 
 finalize_it:
     if (iRet != RS_RET_OK) {
@@ -169,6 +187,7 @@ finalize_it:
                  "a lookup table could not be activated: "
                  "failed at init-step %d (please enable debug logs for details)",
                  initialized);
+        if (pThis->stats != NULL) statsobj.Destruct(&pThis->stats);
         if (pThis->reloader_started) {
             lookupStopReloader(pThis);
             pThis->reloader_started = 0;
@@ -212,11 +231,19 @@ static void lookupStopReloader(lookup_ref_t *pThis) {
     pthread_join(pThis->reloader, NULL);
 }
 
+static void lookupDestroyCounters(lookup_ref_t *pThis) {
+    if (pThis->stats != NULL) statsobj.Destruct(&pThis->stats);
+    DESTROY_ATOMIC_HELPER_MUT64(pThis->mutCtrLookups);
+    DESTROY_ATOMIC_HELPER_MUT64(pThis->mutCtrMatchTime);
+    DESTROY_ATOMIC_HELPER_MUT64(pThis->mutCtrRegexFallback);
+}
+
 static void lookupRefDestruct(lookup_ref_t *pThis) {
     if (pThis->reloader_started) {
         lookupStopReloader(pThis);
         pThis->reloader_started = 0;
     }
+    lookupDestroyCounters(pThis);
     if (pThis->reloader_mut_initialized) pthread_mutex_destroy(&pThis->reloader_mut);
     if (pThis->run_reloader_initialized) pthread_cond_destroy(&pThis->run_reloader);
     if (pThis->reloader_attr_initialized) pthread_attr_destroy(&pThis->reloader_thd_attr);
@@ -274,6 +301,8 @@ static void destructTable_regex(lookup_t *pThis) {
         }
     }
     free(entries);
+    rxsetDestruct(&pThis->table.regex->rxset);
+    free(pThis->table.regex->fallback);
     free(pThis->table.regex);
 }
 #endif
@@ -307,6 +336,7 @@ static void lookupDestruct(lookup_t *pThis) {
 
 static void __attribute__((noinline)) lookupRefFreeUnlinked(lookup_ref_t *pThis) {
     if (pThis == NULL) return;
+    lookupDestroyCounters(pThis);
     lookupDestruct(pThis->self);
     free(pThis->name);
     free(pThis->filename);
@@ -483,12 +513,36 @@ static es_str_t *lookupKey_sprsArr(lookup_t *pThis, lookup_key_t key) {
 }
 
 #ifdef FEATURE_REGEXP
+/* The first matching entry wins. If the table has a DFA, it names the first
+ * match among the entries it covers in a single pass over the key. Only the
+ * entries the DFA does not cover and that precede its match still need to be
+ * run through regexec(). If the DFA cannot decide (it hit its size limit on
+ * this key), all entries are evaluated in order, as without a DFA.
+ */
 static es_str_t *lookupKey_regex(lookup_t *pThis, lookup_key_t key) {
+    const lookup_regex_tab_t *const tab = pThis->table.regex;
     const char *r = defaultVal(pThis);
+    uint32_t i;
+
+    if (tab->rxset != NULL) {
+        const int m = rxsetMatch(tab->rxset, key.k_str, strlen((char *)key.k_str));
+        if (m != RXSET_UNDECIDED) {
+            uint32_t first = (m == RXSET_NOMATCH) ? pThis->nmemb : (uint32_t)m;
+            for (i = 0; i < tab->nfallback && tab->fallback[i] < first; ++i) {
+                if (regexp.regexec(&tab->entries[tab->fallback[i]].regex, (char *)key.k_str, 0, NULL, 0) == 0) {
+                    first = tab->fallback[i];
+                    break;
+                }
+            }
+            if (first < pThis->nmemb) r = (const char *)tab->entries[first].interned_val_ref;
+            return es_newStrFromCStr(r, strlen(r));
+        }
+        STATSCOUNTER_INC(pThis->ref->ctrRegexFallback, pThis->ref->mutCtrRegexFallback);
+    }
 
-    for (uint32_t i = 0; i < pThis->nmemb; ++i) {
-        if (regexp.regexec(&pThis->table.regex->entries[i].regex, (char *)key.k_str, 0, NULL, 0) == 0) {
-            r = (const char *)pThis->table.regex->entries[i].interned_val_ref;
+    for (i = 0; i < pThis->nmemb; ++i) {
+        if (regexp.regexec(&tab->entries[i].regex, (char *)key.k_str, 0, NULL, 0) == 0) {
+            r = (const char *)tab->entries[i].interned_val_ref;
             break;
         }
     }
@@ -682,6 +736,36 @@ finalize_it:
 }
 
 #ifdef FEATURE_REGEXP
+/* compile all regexes of a table into one DFA. Entries using syntax the DFA
+ * does not support are recorded as fallback entries, which lookups still
+ * evaluate with regexec(). If no entry is supported, no DFA is kept.
+ */
+static rsRetVal build_RegexSet(lookup_regex_tab_t *const tab, const uint32_t nmemb, const uchar *const name) {
+    rxset_t *rxset = NULL;
+    int bCompiled;
+    DEFiRet;
+
+    CHKmalloc(tab->fallback = malloc(nmemb * sizeof(uint32_t)));
+    CHKiRet(rxsetConstruct(&rxset));
+    for (uint32_t i = 0; i < nmemb; ++i) {
+        CHKiRet(rxsetAdd(rxset, (const char *)tab->entries[i].regex_str, &bCompiled));
+        if (!bCompiled) tab->fallback[tab->nfallback++] = i;
+    }
+    if (tab->nfallback == nmemb) {
+        DBGPRINTF("lookup table '%s': no regex can be compiled into a DFA\n", name);
+        FINALIZE;
+    }
+    CHKiRet(rxsetCompile(rxset));
+    DBGPRINTF("lookup table '%s': %u of %u regexes compiled into a DFA with %d states\n", name,
+              nmemb - tab->nfallback, nmemb, rxsetNumStates(rxset));
+    tab->rxset = rxset;
+    rxset = NULL;
+
+finalize_it:
+    rxsetDestruct(&rxset);
+    RETiRet;
+}
+
 static rsRetVal build_RegexTable(lookup_t *pThis, struct json_object *jtab, const uchar *name) {
     uint32_t i;
     struct json_object *jrow, *jregex, *jtag;
@@ -737,6 +821,7 @@ static rsRetVal build_RegexTable(lookup_t *pThis, struct json_object *jtab, cons
                 ABORT_FINALIZE(RS_RET_INTERNAL_ERROR);
             }
         }
+        CHKiRet(build_RegexSet(pThis->table.regex, pThis->nmemb, name));
     }
 
     pThis->lookup = lookupKey_regex;
@@ -917,6 +1002,7 @@ static rsRetVal lookupReloadOrStub(lookup_ref_t *pThis, const uchar *stub_val) {
 
     DBGPRINTF("reload requested for lookup table '%s'\n", pThis->name);
     CHKmalloc(newlu = calloc(1, sizeof(lookup_t)));
+    newlu->ref = pThis;
     if (stub_val == NULL) {
         CHKiRet(lookupReadFile(newlu, pThis->name, pThis->filename));
     } else {
@@ -1094,8 +1180,19 @@ es_str_t *lookupKey(lookup_ref_t *pThis, lookup_key_t key) {
 /* caller must hold pThis->rwlock */
 es_str_t *lookupKeyLocked(lookup_ref_t *pThis, lookup_key_t key) {
     lookup_t *t;
+    es_str_t *estr;
+    struct timespec start, end;
+
     t = pThis->self;
-    return t->lookup(t, key);
+    if (!STATSCOUNTER_ENABLED()) return t->lookup(t, key);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    estr = t->lookup(t, key);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    STATSCOUNTER_INC(pThis->ctrLookups, pThis->mutCtrLookups);
+    STATSCOUNTER_ADD(pThis->ctrMatchTime, pThis->mutCtrMatchTime,
+                     (uint64_t)(end.tv_sec - start.tv_sec) * 1000000000 + end.tv_nsec - start.tv_nsec);
+    return estr;
 }
 
 
@@ -1235,6 +1332,7 @@ finalize_it:
 }
 
 void lookupClassExit(void) {
+    objRelease(statsobj, CORE_COMPONENT);
     objRelease(glbl, CORE_COMPONENT);
 }
 
@@ -1242,6 +1340,7 @@ rsRetVal lookupClassInit(void) {
     DEFiRet;
     CHKiRet(objGetObjInterface(&obj));
     CHKiRet(objUse(glbl, CORE_COMPONENT));
+    CHKiRet(objUse(statsobj, CORE_COMPONENT));
 finalize_it:
     RETiRet;
 }
@@ -22,6 +22,8 @@
 #define INCLUDED_LOOKUP_H
 #include <libestr.h>
 #include <regex.h>
+#include "statsobj.h"
+#include "rxset.h"
 
 #define STRING_LOOKUP_TABLE 1
 #define ARRAY_LOOKUP_TABLE 2
@@ -70,6 +72,9 @@ struct lookup_regex_tab_entry_s {
 
 struct lookup_regex_tab_s {
     lookup_regex_tab_entry_t *entries;
+    rxset_t *rxset; /* all entries compiled into one DFA, NULL if not available */
+    uint32_t *fallback; /* ascending indexes of entries the DFA does not cover */
+    uint32_t nfallback;
 };
 
 struct lookup_ref_s {
@@ -95,6 +100,10 @@ struct lookup_ref_s {
     uint8_t is_reloading;
     uint8_t do_stop;
     uint8_t reload_on_hup;
+    statsobj_t *stats;
+    STATSCOUNTER_DEF(ctrLookups, mutCtrLookups)
+    STATSCOUNTER_DEF(ctrMatchTime, mutCtrMatchTime) /* nanoseconds spent in lookups */
+    STATSCOUNTER_DEF(ctrRegexFallback, mutCtrRegexFallback) /* lookups the regex DFA could not decide */
 };
 
 typedef es_str_t *(lookup_fn_t)(lookup_t *, lookup_key_t);
@@ -114,6 +123,7 @@ struct lookup_s {
     uchar **interned_vals;
     uchar *nomatch;
     lookup_fn_t *lookup;
+    lookup_ref_t *ref; /* the reference this table is (or will be) installed in */
 };
 
 union lookup_key_u {
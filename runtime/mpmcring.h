@@ -0,0 +1,128 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file mpmcring.h
+ * @brief Bounded lock-free multi-producer/multi-consumer pointer ring.
+ *
+ * This is the classic sequence-numbered cell design: every cell carries a
+ * sequence counter that tells producers and consumers whether the cell is
+ * free for the current lap. Producers and consumers each claim a position
+ * with a CAS on their own cursor and then publish the cell with a release
+ * store, so neither side ever blocks the other. Capacity is rounded up to a
+ * power of two.
+ *
+ * The ring needs the compiler's __atomic builtins, so the functions are only
+ * available if HAVE_ATOMIC_BUILTINS is defined. The type itself is always
+ * declared to keep structures embedding it identical on all platforms.
+ */
+#ifndef INCLUDED_MPMCRING_H
+#define INCLUDED_MPMCRING_H
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#define MPMCRING_CACHELINE 64
+
+typedef struct mpmcring_cell_s {
+    size_t seq;
+    void *data;
+} mpmcring_cell_t;
+
+typedef struct mpmcring_s {
+    mpmcring_cell_t *cells;
+    size_t mask;
+    char pad0[MPMCRING_CACHELINE];
+    size_t enqPos; /* producer cursor, kept on its own cache line */
+    char pad1[MPMCRING_CACHELINE - sizeof(size_t)];
+    size_t deqPos; /* consumer cursor, kept on its own cache line */
+    char pad2[MPMCRING_CACHELINE - sizeof(size_t)];
+} mpmcring_t;
+
+#ifdef HAVE_ATOMIC_BUILTINS
+
+/**
+ * @brief Allocate the cells of @p ring for at least @p capacity entries.
+ * @return 0 on success, -1 if memory could not be allocated
+ */
+static inline int mpmcRingInit(mpmcring_t *const ring, size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+    ring->cells = (mpmcring_cell_t *)malloc(size * sizeof(mpmcring_cell_t));
+    if (ring->cells == NULL) return -1;
+    for (size_t i = 0; i < size; ++i) {
+        ring->cells[i].seq = i;
+        ring->cells[i].data = NULL;
+    }
+    ring->mask = size - 1;
+    ring->enqPos = 0;
+    ring->deqPos = 0;
+    return 0;
+}
+
+static inline void mpmcRingDestroy(mpmcring_t *const ring) {
+    free(ring->cells);
+    ring->cells = NULL;
+}
+
+/**
+ * @brief Append @p data to the ring.
+ * @return 1 if the element was stored, 0 if the ring is full
+ */
+static inline int mpmcRingPush(mpmcring_t *const ring, void *const data) {
+    size_t pos = __atomic_load_n(&ring->enqPos, __ATOMIC_RELAXED);
+    for (;;) {
+        mpmcring_cell_t *const cell = &ring->cells[pos & ring->mask];
+        const size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        const ptrdiff_t dif = (ptrdiff_t)seq - (ptrdiff_t)pos;
+        if (dif == 0) {
+            if (__atomic_compare_exchange_n(&ring->enqPos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                cell->data = data;
+                __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+                return 1;
+            }
+            /* CAS failure reloaded pos */
+        } else if (dif < 0) {
+            return 0;
+        } else {
+            pos = __atomic_load_n(&ring->enqPos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * @brief Remove the oldest element from the ring.
+ * @return 1 if an element was stored to @p data, 0 if none is published yet
+ */
+static inline int mpmcRingPop(mpmcring_t *const ring, void **const data) {
+    size_t pos = __atomic_load_n(&ring->deqPos, __ATOMIC_RELAXED);
+    for (;;) {
+        mpmcring_cell_t *const cell = &ring->cells[pos & ring->mask];
+        const size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        const ptrdiff_t dif = (ptrdiff_t)seq - (ptrdiff_t)(pos + 1);
+        if (dif == 0) {
+            if (__atomic_compare_exchange_n(&ring->deqPos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *data = cell->data;
+                __atomic_store_n(&cell->seq, pos + ring->mask + 1, __ATOMIC_RELEASE);
+                return 1;
+            }
+        } else if (dif < 0) {
+            return 0;
+        } else {
+            pos = __atomic_load_n(&ring->deqPos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+#endif /* #ifdef HAVE_ATOMIC_BUILTINS */
+
+#endif /* #ifndef INCLUDED_MPMCRING_H */
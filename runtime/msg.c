@@ -65,11 +65,16 @@
 #include "ruleset.h"
 #include "prop.h"
 #include "msg_replace_helper.h"
+#include "rcvslab.h"
+#include "msgpool.h"
+#include "jsonesc.h"
+#include "statsobj.h"
 #include "net.h"
 #include "var.h"
 #include "rsconf.h"
 #include "parserif.h"
 #include "errmsg.h"
+#include "msglatency.h"
 
 #define DEV_DEBUG 0 /* set to 1 to enable very verbose developer debugging messages */
 
@@ -86,8 +91,16 @@ static void msgMaterializeTurboJSON(smsg_t *pMsg);
 /* static data */
 DEFobjStaticHelpers;
 DEFobjCurrIf(datetime) DEFobjCurrIf(glbl) DEFobjCurrIf(regexp) DEFobjCurrIf(prop) DEFobjCurrIf(net) DEFobjCurrIf(var)
+    DEFobjCurrIf(statsobj)
 
-    static const char *one_digit[10] = {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"};
+    /* message object pool counters, refreshed from the pool when stats are read */
+    static statsobj_t *poolStats = NULL;
+static intctr_t ctrPoolHits;
+static intctr_t ctrPoolMisses;
+static intctr_t ctrPoolRemoteFrees;
+static intctr_t ctrPoolTrimmed;
+
+static const char *one_digit[10] = {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"};
 
 static const char *two_digits[100] = {
     "00", "01", "02", "03", "04", "05", "06", "07", "08", "09", "10", "11", "12", "13", "14", "15", "16",
@@ -195,7 +208,6 @@ static struct {
     {UCHAR_CONSTANT("188")}, {UCHAR_CONSTANT("189")}, {UCHAR_CONSTANT("190")}, {UCHAR_CONSTANT("191")},
     {UCHAR_CONSTANT("192")}, {UCHAR_CONSTANT("193")}, {UCHAR_CONSTANT("194")}, {UCHAR_CONSTANT("195")},
     {UCHAR_CONSTANT("196")}, {UCHAR_CONSTANT("197")}, {UCHAR_CONSTANT("198")}, {UCHAR_CONSTANT("199")}};
-static char hexdigit[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
 
 #if defined(_AIX)
 /* AIXPORT : replace facility names with aso and caa only for AIX */
@@ -238,9 +250,13 @@ static pthread_mutex_t mutTrimCtr; /* mutex to handle malloc trim */
 /* some forward declarations */
 static int getAPPNAMELen(smsg_t *const pM, sbool bLockMutex);
 static rsRetVal jsonPathFindParent(
-    struct json_object *jroot, uchar *name, uchar *leaf, struct json_object **parent, int bCreate);
+    struct json_object *jroot, uchar *name, uchar *leaf, struct json_object **parent, int bCreate, jsoncow_t *cow);
 static uchar *jsonPathGetLeaf(uchar *name, int lenName);
 static json_bool jsonVarExtract(struct json_object *root, const char *key, struct json_object **value);
+static rsRetVal jsonPropFind(struct json_object *root,
+                             const msgPropDescr_t *pProp,
+                             struct json_object **field,
+                             json_bool *pbFound);
 void getRawMsgAfterPRI(smsg_t *const pM, uchar **pBuf, int *piLen);
 
 
@@ -675,9 +691,10 @@ uchar *propIDToName(propid_t propID) {
 static rsRetVal msgBaseConstruct(smsg_t **ppThis) {
     DEFiRet;
     smsg_t *pM;
+    int bRecycled;
 
     assert(ppThis != NULL);
-    CHKmalloc(pM = malloc(sizeof(smsg_t)));
+    CHKmalloc(pM = msgpoolAlloc(&bRecycled));
     objConstructSetObjInfo(pM); /* initialize object helper entities */
 
     /* initialize members in ORDER they appear in structure (think "cache line"!) */
@@ -696,6 +713,7 @@ static rsRetVal msgBaseConstruct(smsg_t **ppThis) {
     pM->iLenTAG = 0;
     pM->iLenHOSTNAME = 0;
     pM->pszRawMsg = NULL;
+    pM->pRawSlab = NULL;
     pM->pszHOSTNAME = NULL;
     pM->pszRcvdAt3164 = NULL;
     pM->pszRcvdAt3339 = NULL;
@@ -717,6 +735,8 @@ static rsRetVal msgBaseConstruct(smsg_t **ppThis) {
     pM->pRuleset = NULL;
     pM->json = NULL;
     pM->localvars = NULL;
+    pM->jsonCow = NULL;
+    pM->localvarsCow = NULL;
 #ifdef HAVE_LOGNORM_TURBO
     pM->turbo_result = NULL;
     pM->turbo_result_free = NULL;
@@ -726,6 +746,8 @@ static rsRetVal msgBaseConstruct(smsg_t **ppThis) {
     pM->dfltTZ[0] = '\0';
     memset(&pM->tRcvdAt, 0, sizeof(pM->tRcvdAt));
     memset(&pM->tTIMESTAMP, 0, sizeof(pM->tTIMESTAMP));
+    pM->tLatencyRcvd = 0;
+    pM->tLatencyDeq = 0;
     pM->TAG.pszTAG = NULL;
     pM->pszTimestamp3164[0] = '\0';
     pM->pszTimestamp3339[0] = '\0';
@@ -734,7 +756,7 @@ static rsRetVal msgBaseConstruct(smsg_t **ppThis) {
     pM->pszTIMESTAMP_Unix[0] = '\0';
     pM->pszRcvdAt_Unix[0] = '\0';
     pM->pszUUID = NULL;
-    pthread_mutex_init(&pM->mut, NULL);
+    if (!bRecycled) pthread_mutex_init(&pM->mut, NULL); /* pooled objects keep theirs */
 
 #if DEV_DEBUG == 1
     dbgprintf("msgConstruct\t0x%x, ref 1\n", (int)pM);
@@ -763,6 +785,7 @@ rsRetVal msgConstructWithTime(smsg_t **ppThis, const struct syslogTime *stTime,
     (*ppThis)->ttGenTime = ttGenTime;
     memcpy(&(*ppThis)->tRcvdAt, stTime, sizeof(struct syslogTime));
     memcpy(&(*ppThis)->tTIMESTAMP, stTime, sizeof(struct syslogTime));
+    (*ppThis)->tLatencyRcvd = (*ppThis)->tLatencyDeq = MSGLATENCY_STAMP();
 
 finalize_it:
     RETiRet;
@@ -787,6 +810,7 @@ rsRetVal msgConstruct(smsg_t **ppThis) {
      */
     datetime.getCurrTime(&((*ppThis)->tRcvdAt), &((*ppThis)->ttGenTime), TIME_IN_LOCALTIME);
     memcpy(&(*ppThis)->tTIMESTAMP, &(*ppThis)->tRcvdAt, sizeof(struct syslogTime));
+    (*ppThis)->tLatencyRcvd = (*ppThis)->tLatencyDeq = MSGLATENCY_STAMP();
 
 finalize_it:
     RETiRet;
@@ -813,6 +837,14 @@ static inline void freeTAG(smsg_t *pThis) {
 static inline void freeHOSTNAME(smsg_t *pThis) {
     if (pThis->iLenHOSTNAME >= CONF_HOSTNAME_BUFSIZE) free(pThis->pszHOSTNAME);
 }
+static inline void freeRawMsg(smsg_t *pThis) {
+    if (pThis->pRawSlab != NULL) {
+        rcvslabRelease(pThis->pRawSlab);
+        pThis->pRawSlab = NULL;
+    } else if (pThis->pszRawMsg != pThis->szRawMsg) {
+        free(pThis->pszRawMsg);
+    }
+}
 
 
 rsRetVal msgDestruct(smsg_t **ppThis) {
@@ -839,7 +871,7 @@ rsRetVal msgDestruct(smsg_t **ppThis) {
 #if DEV_DEBUG == 1
         dbgprintf("msgDestruct\t0x%lx, RefCount now 0, doing DESTROY\n", (unsigned long)pThis);
 #endif
-        if (pThis->pszRawMsg != pThis->szRawMsg) free(pThis->pszRawMsg);
+        freeRawMsg(pThis);
         freeTAG(pThis);
         freeHOSTNAME(pThis);
         if (pThis->pInputName != NULL) prop.Destruct(&pThis->pInputName);
@@ -863,6 +895,8 @@ rsRetVal msgDestruct(smsg_t **ppThis) {
         if (pThis->pCSMSGID != NULL) rsCStrDestruct(&pThis->pCSMSGID);
         if (pThis->json != NULL) json_object_put(pThis->json);
         if (pThis->localvars != NULL) json_object_put(pThis->localvars);
+        jsoncowDestruct(&pThis->jsonCow);
+        jsoncowDestruct(&pThis->localvarsCow);
 #ifdef HAVE_LOGNORM_TURBO
         if (pThis->turbo_result != NULL && pThis->turbo_result_free != NULL)
             pThis->turbo_result_free(pThis->turbo_result);
@@ -871,7 +905,6 @@ rsRetVal msgDestruct(smsg_t **ppThis) {
 #ifndef HAVE_ATOMIC_BUILTINS
         MsgUnlock(pThis);
 #endif
-        pthread_mutex_destroy(&pThis->mut);
         /* now we need to do our own optimization. Testing has shown that at least the glibc
          * malloc() subsystem returns memory to the OS far too late in our case. So we need
          * to help it a bit, by calling malloc_trim(), which will tell the alloc subsystem
@@ -892,6 +925,10 @@ rsRetVal msgDestruct(smsg_t **ppThis) {
             }
         }
 #endif
+        /* the object, including its mutex, goes back to the pool */
+        obj.DestructObjSelf((obj_t *)pThis);
+        msgpoolRelease(pThis);
+        pThis = NULL;
     } else {
 #ifndef HAVE_ATOMIC_BUILTINS
         MsgUnlock(pThis);
@@ -900,6 +937,29 @@ rsRetVal msgDestruct(smsg_t **ppThis) {
     }
 ENDobjDestruct
 (msg)
+/* Let a MsgDup() copy share one of the JSON trees of the original. Both
+ * messages now must copy a container before they modify it, including the
+ * ones the original has made private before, as the copy can reach them too.
+ * Must be called with the original's mutex held.
+ */
+static rsRetVal msgShareJSON(struct json_object **const pOldRoot,
+                             jsoncow_t **const pOldCow,
+                             struct json_object **const pNewRoot,
+                             jsoncow_t **const pNewCow) {
+    DEFiRet;
+
+    if (*pOldCow == NULL) {
+        CHKiRet(jsoncowConstruct(pOldCow));
+    } else {
+        jsoncowReset(*pOldCow);
+    }
+    CHKiRet(jsoncowConstruct(pNewCow));
+    *pNewRoot = json_object_get(*pOldRoot);
+
+finalize_it:
+    RETiRet;
+}
+
 /* The macros below are used in MsgDup(). I use macros
  * to keep the fuction code somewhat more readyble. It is my
  * replacement for inline functions in CPP
@@ -951,6 +1011,8 @@ ENDobjDestruct
     pNew->msgFlags = pOld->msgFlags;
     pNew->iProtocolVersion = pOld->iProtocolVersion;
     pNew->tRcvdAt = pOld->tRcvdAt;
+    pNew->tLatencyRcvd = pOld->tLatencyRcvd;
+    pNew->tLatencyDeq = pOld->tLatencyDeq;
     pNew->offMSG = pOld->offMSG;
     pNew->iLenRawMsg = pOld->iLenRawMsg;
     pNew->iLenMSG = pOld->iLenMSG;
@@ -1021,16 +1083,25 @@ ENDobjDestruct
     tmpCOPYCSTR(PROCID);
     tmpCOPYCSTR(MSGID);
 
+    MsgLock(pOld);
 #ifdef HAVE_LOGNORM_TURBO
     /* Turbo snapshots are opaque and cannot be duplicated generically.  Turn
      * one into the normal owned JSON representation before copying so callers
      * of MsgDup() retain CEE properties just like the standard path does. */
-    MsgLock(pOld);
     msgMaterializeTurboJSON(pOld);
-    MsgUnlock(pOld);
 #endif
-    if (pOld->json != NULL) pNew->json = jsonDeepCopy(pOld->json);
-    if (pOld->localvars != NULL) pNew->localvars = jsonDeepCopy(pOld->localvars);
+    /* The JSON trees are not copied but shared; whichever message modifies
+     * them later copies just the nodes it changes (see jsoncow.h).
+     */
+    localRet = RS_RET_OK;
+    if (pOld->json != NULL) localRet = msgShareJSON(&pOld->json, &pOld->jsonCow, &pNew->json, &pNew->jsonCow);
+    if (localRet == RS_RET_OK && pOld->localvars != NULL)
+        localRet = msgShareJSON(&pOld->localvars, &pOld->localvarsCow, &pNew->localvars, &pNew->localvarsCow);
+    MsgUnlock(pOld);
+    if (localRet != RS_RET_OK) {
+        msgDestruct(&pNew);
+        return NULL;
+    }
 
     /* we do not copy all other cache properties, as we do not even know
      * if they are needed once again. So we let them re-create if needed.
@@ -1067,6 +1138,26 @@ static const char *jsonToString(struct json_object *const json) {
     return json_object_to_json_string_ext(json, glblJsonFormatOpt);
 }
 
+/* Return a strdup()ed rendering of @json, like jsonToString() if @flags is
+ * negative, else with the given json-c flags.
+ *
+ * If @bShared is set, @json may belong to a tree shared with other messages
+ * (see MsgDup()). json-c renders a container into a buffer inside the
+ * container, which another thread may be doing at the same time, so it
+ * then renders through jsoncowRenderDup(). Strings are read without
+ * rendering.
+ * Must be called with the tree's mutex held.
+ */
+static char *jsonRenderDup(struct json_object *json, const int bShared, const int flags) {
+    const char *str;
+
+    if (bShared && !(flags < 0 && json_object_is_type(json, json_type_string))) {
+        return jsoncowRenderDup(json, (flags < 0) ? glblJsonFormatOpt : flags);
+    }
+    str = (flags < 0) ? jsonToString(json) : json_object_to_json_string_ext(json, flags);
+    return (str == NULL) ? NULL : strdup(str);
+}
+
 /* This method serializes a message object. That means the whole
  * object is modified into text form. That text form is suitable for
  * later reconstruction of the object by calling MsgDeSerialize().
@@ -1081,6 +1172,7 @@ static const char *jsonToString(struct json_object *const json) {
  */
 static rsRetVal MsgSerialize(smsg_t *pThis, strm_t *pStrm) {
     uchar *psz;
+    char *pszJSON = NULL;
     int len;
     DEFiRet;
 
@@ -1117,17 +1209,19 @@ static rsRetVal MsgSerialize(smsg_t *pThis, strm_t *pStrm) {
     CHKiRet(obj.SerializeProp(pStrm, UCHAR_CONSTANT("pszRcvFromIP"), PROPTYPE_PSZ, (void *)psz));
     psz = pThis->pszStrucData;
     CHKiRet(obj.SerializeProp(pStrm, UCHAR_CONSTANT("pszStrucData"), PROPTYPE_PSZ, (void *)psz));
-    if (pThis->json != NULL) {
-        MsgLock(pThis);
-        psz = (uchar *)jsonToString(pThis->json);
-        MsgUnlock(pThis);
-        CHKiRet(obj.SerializeProp(pStrm, UCHAR_CONSTANT("json"), PROPTYPE_PSZ, (void *)psz));
+    CHKiRet(msgJSONTreeToString(pThis, PROP_CEE, glblJsonFormatOpt, &pszJSON));
+    if (pszJSON != NULL) {
+        iRet = obj.SerializeProp(pStrm, UCHAR_CONSTANT("json"), PROPTYPE_PSZ, (void *)pszJSON);
+        free(pszJSON);
+        pszJSON = NULL;
+        CHKiRet(iRet);
     }
-    if (pThis->localvars != NULL) {
-        MsgLock(pThis);
-        psz = (uchar *)jsonToString(pThis->localvars);
-        MsgUnlock(pThis);
-        CHKiRet(obj.SerializeProp(pStrm, UCHAR_CONSTANT("localvars"), PROPTYPE_PSZ, (void *)psz));
+    CHKiRet(msgJSONTreeToString(pThis, PROP_LOCAL_VAR, glblJsonFormatOpt, &pszJSON));
+    if (pszJSON != NULL) {
+        iRet = obj.SerializeProp(pStrm, UCHAR_CONSTANT("localvars"), PROPTYPE_PSZ, (void *)pszJSON);
+        free(pszJSON);
+        pszJSON = NULL;
+        CHKiRet(iRet);
     }
 
     objSerializePTR(pStrm, pCSAPPNAME, CSTR);
@@ -2799,6 +2893,11 @@ rsRetVal MsgReplaceMSG(smsg_t *pThis, const uchar *pszMSG, int lenMSG) {
     if (pThis->pszRawMsg == NULL) {
         pThis->pszRawMsg = pThis->szRawMsg;
         pThis->szRawMsg[0] = '\0';
+    } else if (pThis->pRawSlab != NULL) {
+        /* the replacement may need to grow the buffer, which a slab reference can not do */
+        const int lenMSG_save = pThis->iLenMSG;
+        MsgSetRawMsg(pThis, (char *)pThis->pszRawMsg, pThis->iLenRawMsg);
+        pThis->iLenMSG = lenMSG_save;
     }
 
     if (pThis->offMSG < 0 || pThis->offMSG > pThis->iLenRawMsg) {
@@ -2844,7 +2943,11 @@ void ATTR_NONNULL() MsgTruncateToMaxSize(smsg_t *const pThis) {
 void ATTR_NONNULL() MsgSetRawMsg(smsg_t *const pThis, const char *const pszRawMsg, const size_t lenMsg) {
     ISOBJ_TYPE_assert(pThis, msg);
     int deltaSize;
-    if (pThis->pszRawMsg != pThis->szRawMsg) free(pThis->pszRawMsg);
+    /* a shared receive slab may be the source of the new text, so it is
+     * released only after the copy */
+    struct rcvslab_s *const pOldSlab = pThis->pRawSlab;
+    pThis->pRawSlab = NULL;
+    if (pOldSlab == NULL && pThis->pszRawMsg != pThis->szRawMsg) free(pThis->pszRawMsg);
 
     deltaSize = (int)lenMsg - pThis->iLenRawMsg; /* value < 0 in truncation case! */
     pThis->iLenRawMsg = lenMsg;
@@ -2859,6 +2962,7 @@ void ATTR_NONNULL() MsgSetRawMsg(smsg_t *const pThis, const char *const pszRawMs
 
     memcpy(pThis->pszRawMsg, pszRawMsg, pThis->iLenRawMsg);
     pThis->pszRawMsg[pThis->iLenRawMsg] = '\0'; /* this also works with truncation! */
+    if (pOldSlab != NULL) rcvslabRelease(pOldSlab);
     /*
      * Update cached MSG length. When offMSG already points into the
      * message (e.g. after initial parsing) adjusting iLenMSG avoids the
@@ -2872,6 +2976,38 @@ void ATTR_NONNULL() MsgSetRawMsg(smsg_t *const pThis, const char *const pszRawMs
 }
 
 
+/**
+ * @brief Set the raw message by reference to a shared receive slab.
+ *
+ * This is the zero-copy counterpart of MsgSetRawMsg(). The message takes a
+ * reference on @p pSlab and points pszRawMsg at @p pszRawMsg, which must lie
+ * inside the slab. The caller transfers ownership of the @p lenMsg bytes and
+ * of the byte after them, which is overwritten with the terminating NUL; the
+ * message may modify that range in place like any other raw message buffer.
+ * Operations that need to grow the buffer copy it out first.
+ */
+void ATTR_NONNULL() MsgSetRawMsgRef(smsg_t *const pThis,
+                                    struct rcvslab_s *const pSlab,
+                                    char *const pszRawMsg,
+                                    const size_t lenMsg) {
+    ISOBJ_TYPE_assert(pThis, msg);
+    assert(pThis->pszRawMsg == NULL);
+    assert((uchar *)pszRawMsg >= pSlab->buf && (uchar *)pszRawMsg + lenMsg < pSlab->buf + pSlab->size);
+
+    const int deltaSize = (int)lenMsg - pThis->iLenRawMsg;
+    rcvslabAddRef(pSlab);
+    pThis->pRawSlab = pSlab;
+    pThis->pszRawMsg = (uchar *)pszRawMsg;
+    pThis->iLenRawMsg = lenMsg;
+    pThis->pszRawMsg[lenMsg] = '\0';
+    /* same MSG length bookkeeping as MsgSetRawMsg() */
+    if (pThis->iLenRawMsg > pThis->offMSG)
+        pThis->iLenMSG += deltaSize;
+    else
+        pThis->iLenMSG = 0;
+}
+
+
 /* set raw message in message object. Size of message is not provided. This
  * function should only be used when it is unavoidable (and over time we should
  * try to remove it altogether).
@@ -3003,7 +3139,13 @@ static void msgMaterializeTurboJSON(smsg_t *pMsg) {
 
     if (pMsg->json == NULL) {
         pMsg->json = snap_json;
+        jsoncowDestruct(&pMsg->jsonCow);
     } else {
+        if (pMsg->jsonCow != NULL && jsoncowOwnRoot(pMsg->jsonCow, &pMsg->json) != RS_RET_OK) {
+            DBGPRINTF("msgMaterializeTurboJSON: out of memory, normalization result lost\n");
+            json_object_put(snap_json);
+            return;
+        }
         /* Keep msgAddJSON() full-tree merge semantics: the normalization
          * result is the later write and therefore replaces matching keys. */
         struct json_object_iterator it = json_object_iter_begin(snap_json);
@@ -3094,14 +3236,50 @@ finalize_it:
     RETiRet;
 }
 
+/* copy-on-write state belonging to a root obtained by getJSONRootAndMutex().
+ * Global variables are never shared between messages, so there is none.
+ */
+static jsoncow_t **getJSONCow(smsg_t *const pMsg, struct json_object **const jroot) {
+    if (jroot == &pMsg->json) return &pMsg->jsonCow;
+    if (jroot == &pMsg->localvars) return &pMsg->localvarsCow;
+    return NULL;
+}
+
+static int isJSONShared(smsg_t *const pMsg, struct json_object **const jroot) {
+    jsoncow_t **const cow = getJSONCow(pMsg, jroot);
+    return cow != NULL && *cow != NULL;
+}
+
+/* Render the whole $! (PROP_CEE) or $. (PROP_LOCAL_VAR) tree of a message
+ * into a new string the caller must free. *ppStr is NULL if the tree is
+ * empty.
+ */
+rsRetVal msgJSONTreeToString(smsg_t *const pMsg, const propid_t id, const int flags, char **const ppStr) {
+    struct json_object **jroot;
+    pthread_mutex_t *mut = NULL;
+    DEFiRet;
+
+    *ppStr = NULL;
+    assert(id == PROP_CEE || id == PROP_LOCAL_VAR);
+    CHKiRet(getJSONRootAndMutex(pMsg, id, &jroot, &mut));
+    pthread_mutex_lock(mut);
+#ifdef HAVE_LOGNORM_TURBO
+    if (id == PROP_CEE) msgMaterializeTurboJSON(pMsg);
+#endif
+    if (*jroot != NULL) CHKmalloc(*ppStr = jsonRenderDup(*jroot, isJSONShared(pMsg, jroot), flags));
+
+finalize_it:
+    if (mut != NULL) pthread_mutex_unlock(mut);
+    RETiRet;
+}
+
 
 /* Get a JSON-Property as string value  (used for various types of JSON-based vars) */
 rsRetVal getJSONPropVal(
     smsg_t *const pMsg, msgPropDescr_t *pProp, uchar **pRes, rs_size_t *buflen, unsigned short *pbMustBeFreed) {
-    uchar *leaf;
     struct json_object **jroot;
-    struct json_object *parent;
     struct json_object *field;
+    json_bool bFound;
     pthread_mutex_t *mut = NULL;
     DEFiRet;
 
@@ -3160,14 +3338,14 @@ rsRetVal getJSONPropVal(
     if (!strcmp((char *)pProp->name, "!")) {
         field = *jroot;
     } else {
-        leaf = jsonPathGetLeaf(pProp->name, pProp->nameLen);
-        CHKiRet(jsonPathFindParent(*jroot, pProp->name, leaf, &parent, 0));
-        if (jsonVarExtract(parent, (char *)leaf, &field) == FALSE) field = NULL;
+        CHKiRet(jsonPropFind(*jroot, pProp, &field, &bFound));
     }
     if (field != NULL) {
-        *pRes = (uchar *)strdup(jsonToString(field));
-        *buflen = (int)ustrlen(*pRes);
-        *pbMustBeFreed = 1;
+        *pRes = (uchar *)jsonRenderDup(field, isJSONShared(pMsg, jroot), -1);
+        if (*pRes != NULL) {
+            *buflen = (int)ustrlen(*pRes);
+            *pbMustBeFreed = 1;
+        }
     }
 
 finalize_it:
@@ -3197,8 +3375,7 @@ rsRetVal msgGetJSONPropJSONorString(smsg_t *const pMsg,
                                     struct json_object **pjson,
                                     uchar **pcstr) {
     struct json_object **jroot;
-    uchar *leaf;
-    struct json_object *parent;
+    json_bool bFound;
     pthread_mutex_t *mut = NULL;
     DEFiRet;
 
@@ -3238,9 +3415,8 @@ rsRetVal msgGetJSONPropJSONorString(smsg_t *const pMsg,
     if (*jroot == NULL) {
         ABORT_FINALIZE(RS_RET_NOT_FOUND);
     }
-    leaf = jsonPathGetLeaf(pProp->name, pProp->nameLen);
-    CHKiRet(jsonPathFindParent(*jroot, pProp->name, leaf, &parent, 0));
-    if (jsonVarExtract(parent, (char *)leaf, pjson) == FALSE) {
+    CHKiRet(jsonPropFind(*jroot, pProp, pjson, &bFound));
+    if (!bFound) {
         ABORT_FINALIZE(RS_RET_NOT_FOUND);
     }
     if (*pjson == NULL) {
@@ -3264,8 +3440,7 @@ finalize_it:
 /* Get a JSON-based-variable as native json object */
 rsRetVal msgGetJSONPropJSON(smsg_t *const pMsg, msgPropDescr_t *pProp, struct json_object **pjson) {
     struct json_object **jroot;
-    uchar *leaf;
-    struct json_object *parent;
+    json_bool bFound;
     pthread_mutex_t *mut = NULL;
     DEFiRet;
 
@@ -3281,9 +3456,8 @@ rsRetVal msgGetJSONPropJSON(smsg_t *const pMsg, msgPropDescr_t *pProp, struct js
         *pjson = *jroot;
         FINALIZE;
     }
-    leaf = jsonPathGetLeaf(pProp->name, pProp->nameLen);
-    CHKiRet(jsonPathFindParent(*jroot, pProp->name, leaf, &parent, 0));
-    if (jsonVarExtract(parent, (char *)leaf, pjson) == FALSE) {
+    CHKiRet(jsonPropFind(*jroot, pProp, pjson, &bFound));
+    if (!bFound) {
         ABORT_FINALIZE(RS_RET_NOT_FOUND);
     }
 
@@ -3297,7 +3471,8 @@ finalize_it:
 
 /* Helper for jsonAddVal(), to be called onces we know there are actually
  * json escapes inside the string. If so, this function takes over.
- * Splitting the functions permits us to make some performance optimizations.
+ * The input is escaped in chunks into a stack buffer, see jsonesc.h for
+ * how clean runs are copied in bulk.
  * For further details, see jsonAddVal().
  */
 static rsRetVal ATTR_NONNULL(1, 4) jsonAddVal_escaped(uchar *const pSrc,
@@ -3305,146 +3480,32 @@ static rsRetVal ATTR_NONNULL(1, 4) jsonAddVal_escaped(uchar *const pSrc,
                                                       const unsigned len_none_escaped_head,
                                                       es_str_t **dst,
                                                       const int escapeAll) {
-    unsigned char c;
-    es_size_t i;
-    char numbuf[4];
-    unsigned ni;
-    unsigned char nc;
-    int j;
-    uchar wrkbuf[100000];
-    size_t dst_realloc_size;
-    size_t dst_size;
-    uchar *dst_base = NULL;
-    uchar *dst_w;
-    uchar *newbuf;
+    uchar wrkbuf[16384];
+    const uchar *src = pSrc + len_none_escaped_head;
+    const uchar *const end = pSrc + buflen;
+    es_str_t *const dstOrig = *dst;
     DEFiRet;
 
     assert(len_none_escaped_head <= buflen);
+    if (*dst == NULL) {
+        /* we hope we have only few escapes... */
+        CHKmalloc(*dst = es_newStr(buflen + 16));
+    }
     /* first copy over unescaped head string */
-    if ((size_t)len_none_escaped_head > sizeof(wrkbuf) - 10) {
-        /* The following condition is not expected to occur in normal operation. */
-#if UINT_MAX > SIZE_MAX / 2
-        if ((size_t)len_none_escaped_head > SIZE_MAX / 2) {
+    if (es_addBuf(dst, (const char *)pSrc, len_none_escaped_head) != 0) {
+        ABORT_FINALIZE(RS_RET_OUT_OF_MEMORY);
+    }
+    while (src < end) {
+        const size_t len = jsonescEncode(&src, end, wrkbuf, sizeof(wrkbuf), escapeAll);
+        if (es_addBuf(dst, (const char *)wrkbuf, len) != 0) {
             ABORT_FINALIZE(RS_RET_OUT_OF_MEMORY);
         }
-#endif
-        dst_size = (size_t)len_none_escaped_head * 2;
-        CHKmalloc(dst_base = malloc(dst_size));
-    } else {
-        dst_size = sizeof(wrkbuf);
-        dst_base = wrkbuf;
-    }
-    dst_realloc_size = dst_size - 10; /* some buffer for escaping */
-    dst_w = dst_base;
-    memcpy(dst_w, pSrc, len_none_escaped_head);
-    dst_w += len_none_escaped_head;
-
-    /* now do the escaping */
-    for (i = len_none_escaped_head; i < buflen; ++i) {
-        const size_t dst_offset = dst_w - dst_base;
-        if (dst_offset >= dst_realloc_size) {
-            if (dst_size > SIZE_MAX / 2) {
-                ABORT_FINALIZE(RS_RET_OUT_OF_MEMORY);
-            }
-            const size_t new_size = 2 * dst_size;
-            if (dst_base == wrkbuf) {
-                CHKmalloc(newbuf = malloc(new_size));
-                memcpy(newbuf, dst_base, dst_offset);
-            } else {
-                CHKmalloc(newbuf = realloc(dst_base, new_size));
-            }
-            dst_size = new_size;
-            dst_realloc_size = new_size - 10; /* some buffer for escaping */
-            dst_base = newbuf;
-            dst_w = dst_base + dst_offset;
-        }
-        c = pSrc[i];
-        if ((c >= 0x30 && c <= 0x5b) || (c >= 0x23 && c <= 0x2e) || (c >= 0x5d /* && c <= 0x10FFFF*/) || c == 0x20 ||
-            c == 0x21) {
-            /* no need to escape */
-            *dst_w++ = c;
-        } else {
-            /* we must escape, try RFC4627-defined special sequences first */
-            switch (c) {
-                case '\0':
-                    *dst_w++ = '\\';
-                    *dst_w++ = 'u';
-                    *dst_w++ = '0';
-                    *dst_w++ = '0';
-                    *dst_w++ = '0';
-                    *dst_w++ = '0';
-                    break;
-                case '\"':
-                    *dst_w++ = '\\';
-                    *dst_w++ = '"';
-                    break;
-                case '/':
-                    *dst_w++ = '\\';
-                    *dst_w++ = '/';
-                    break;
-                case '\\':
-                    if (escapeAll == RSFALSE) {
-                        ni = i + 1;
-                        if (ni < buflen) {
-                            nc = pSrc[ni];
-
-                            /* Attempt to not double encode */
-                            if (nc == '"' || nc == '/' || nc == '\\' || nc == 'b' || nc == 'f' || nc == 'n' ||
-                                nc == 'r' || nc == 't' || nc == 'u') {
-                                *dst_w++ = c;
-                                *dst_w++ = nc;
-                                i = ni;
-                                break;
-                            }
-                        }
-                    }
-                    *dst_w++ = '\\';
-                    *dst_w++ = '\\';
-                    break;
-                case '\010':
-                    *dst_w++ = '\\';
-                    *dst_w++ = 'b';
-                    break;
-                case '\014':
-                    *dst_w++ = '\\';
-                    *dst_w++ = 'f';
-                    break;
-                case '\n':
-                    *dst_w++ = '\\';
-                    *dst_w++ = 'n';
-                    break;
-                case '\r':
-                    *dst_w++ = '\\';
-                    *dst_w++ = 'r';
-                    break;
-                case '\t':
-                    *dst_w++ = '\\';
-                    *dst_w++ = 't';
-                    break;
-                default:
-                    /* TODO : proper Unicode encoding (see header comment) */
-                    for (j = 0; j < 4; ++j) {
-                        numbuf[3 - j] = hexdigit[c % 16];
-                        c = c / 16;
-                    }
-                    *dst_w++ = '\\';
-                    *dst_w++ = 'u';
-                    *dst_w++ = numbuf[0];
-                    *dst_w++ = numbuf[1];
-                    *dst_w++ = numbuf[2];
-                    *dst_w++ = numbuf[3];
-                    break;
-            }
-        }
-    }
-    if (*dst == NULL) {
-        *dst = es_newStrFromBuf((char *)dst_base, dst_w - dst_base);
-    } else {
-        es_addBuf(dst, (const char *)dst_base, dst_w - dst_base);
     }
+
 finalize_it:
-    if (dst_base != NULL && dst_base != wrkbuf) {
-        free(dst_base);
+    if (iRet != RS_RET_OK && dstOrig == NULL && *dst != NULL) {
+        es_deleteStr(*dst);
+        *dst = NULL;
     }
     RETiRet;
 }
@@ -3457,16 +3518,12 @@ finalize_it:
  */
 static rsRetVal ATTR_NONNULL(1, 3)
     jsonAddVal(uchar *const pSrc, const unsigned buflen, es_str_t **dst, const int escapeAll) {
-    es_size_t i;
+    const uchar *const firstEsc = jsonescScan(pSrc, pSrc + buflen);
     DEFiRet;
 
-    for (i = 0; i < buflen; ++i) {
-        const uchar c = pSrc[i];
-        if (!((c >= 0x30 && c <= 0x5b) || (c >= 0x23 && c <= 0x2e) || (c >= 0x5d /* && c <= 0x10FFFF*/) || c == 0x20 ||
-              c == 0x21)) {
-            iRet = jsonAddVal_escaped(pSrc, buflen, i, dst, escapeAll);
-            FINALIZE;
-        }
+    if (firstEsc != pSrc + buflen) {
+        iRet = jsonAddVal_escaped(pSrc, buflen, (unsigned)(firstEsc - pSrc), dst, escapeAll);
+        FINALIZE;
     }
     if (*dst != NULL) {
         es_addBuf(dst, (const char *)pSrc, buflen);
@@ -3990,33 +4047,16 @@ uchar *MsgGetProp(smsg_t *__restrict__ const pMsg,
             break;
         case PROP_CEE_ALL_JSON:
         case PROP_CEE_ALL_JSON_PLAIN:
-            MsgLock(pMsg);
-#ifdef HAVE_LOGNORM_TURBO
-            msgMaterializeTurboJSON(pMsg);
-#endif
-            if (pMsg->json == NULL) {
-                MsgUnlock(pMsg);
+            if (msgJSONTreeToString(pMsg, PROP_CEE,
+                                    (pProp->id == PROP_CEE_ALL_JSON) ? JSON_C_TO_STRING_SPACED : JSON_C_TO_STRING_PLAIN,
+                                    (char **)&pRes) != RS_RET_OK) {
+                RET_OUT_OF_MEMORY;
+            }
+            if (pRes == NULL) {
                 pRes = (uchar *)"{}";
                 bufLen = 2;
                 *pbMustBeFreed = 0;
             } else {
-                const char *jstr;
-                int jflag = 0;
-                if (pProp->id == PROP_CEE_ALL_JSON) {
-                    jflag = JSON_C_TO_STRING_SPACED;
-                } else if (pProp->id == PROP_CEE_ALL_JSON_PLAIN) {
-                    jflag = JSON_C_TO_STRING_PLAIN;
-                }
-                jstr = json_object_to_json_string_ext(pMsg->json, jflag);
-                if (jstr == NULL) {
-                    MsgUnlock(pMsg);
-                    RET_OUT_OF_MEMORY;
-                }
-                pRes = (uchar *)strdup(jstr);
-                MsgUnlock(pMsg);
-                if (pRes == NULL) {
-                    RET_OUT_OF_MEMORY;
-                }
                 *pbMustBeFreed = 1;
             }
             break;
@@ -4908,13 +4948,14 @@ static uchar *jsonPathGetLeaf(uchar *name, int lenName) {
     return name + i;
 }
 
-static json_bool jsonVarExtract(struct json_object *root, const char *key, struct json_object **value) {
-    char namebuf[MAX_VARIABLE_NAME_LEN];
+/* Check if @key has the form "name[idx]". If so, copy the name to
+ * @namebuf and return the index, else return -1.
+ */
+static long jsonVarParseIndex(const char *key, char namebuf[MAX_VARIABLE_NAME_LEN]) {
     const size_t key_len = strlen(key);
     const char *array_idx_start = strstr(key, "[");
     const char *array_idx_end = NULL;
     char *array_idx_num_end_discovered = NULL;
-    struct json_object *arr = NULL;
     if (array_idx_start != NULL) {
         array_idx_end = strstr(array_idx_start, "]");
     }
@@ -4923,28 +4964,92 @@ static json_bool jsonVarExtract(struct json_object *root, const char *key, struc
         const long idx = strtol(array_idx_start + 1, &array_idx_num_end_discovered, 10);
         if (errno == 0 && idx >= 0 && array_idx_num_end_discovered == array_idx_end) {
             const size_t name_len = (size_t)(array_idx_start - key);
-            if (name_len >= sizeof(namebuf)) {
-                return json_object_object_get_ex(root, key, value);
+            if (name_len >= MAX_VARIABLE_NAME_LEN) {
+                return -1;
             }
             memcpy(namebuf, key, name_len);
             namebuf[name_len] = '\0';
-            json_bool found_obj = json_object_object_get_ex(root, namebuf, &arr);
-            if (found_obj && json_object_is_type(arr, json_type_array)) {
-                const size_t len = json_object_array_length(arr);
-                if (len > (size_t)idx) {
-                    *value = json_object_array_get_idx(arr, (size_t)idx);
-                    if (*value != NULL) return TRUE;
-                }
-                return FALSE;
-            }
+            return idx;
+        }
+    }
+    return -1;
+}
+
+/* Check if @key has the form "name[idx]" and @root has an array of that
+ * name. If so, return it, its name and the index; anything else is looked
+ * up as a plain key.
+ */
+static struct json_object *jsonVarIndexedArray(struct json_object *root,
+                                               const char *key,
+                                               char namebuf[MAX_VARIABLE_NAME_LEN],
+                                               size_t *pIdx) {
+    struct json_object *arr = NULL;
+    const long idx = jsonVarParseIndex(key, namebuf);
+    if (idx >= 0 && json_object_object_get_ex(root, namebuf, &arr) && json_object_is_type(arr, json_type_array)) {
+        *pIdx = (size_t)idx;
+        return arr;
+    }
+    return NULL;
+}
+
+static json_bool jsonVarExtract(struct json_object *root, const char *key, struct json_object **value) {
+    char namebuf[MAX_VARIABLE_NAME_LEN];
+    size_t idx;
+    struct json_object *const arr = jsonVarIndexedArray(root, key, namebuf, &idx);
+    if (arr != NULL) {
+        const size_t len = json_object_array_length(arr);
+        if (len > idx) {
+            *value = json_object_array_get_idx(arr, idx);
+            if (*value != NULL) return TRUE;
         }
+        return FALSE;
     }
     return json_object_object_get_ex(root, key, value);
 }
 
+/* Same as jsonVarExtract(), but for modifying the value: a shared container
+ * found is first replaced by a private copy (see jsoncow.h), and so is the
+ * array holding it. @root must already be private. *value is NULL if the key
+ * does not exist.
+ */
+static rsRetVal jsonVarExtractOwned(jsoncow_t *const cow,
+                                    struct json_object *const root,
+                                    const char *const key,
+                                    struct json_object **const value) {
+    char namebuf[MAX_VARIABLE_NAME_LEN];
+    size_t idx;
+    struct json_object *arr = jsonVarIndexedArray(root, key, namebuf, &idx);
+    DEFiRet;
+
+    *value = NULL;
+    if (arr != NULL) {
+        if (json_object_array_length(arr) > idx && (*value = json_object_array_get_idx(arr, idx)) != NULL) {
+            CHKiRet(jsoncowOwnMember(cow, root, namebuf, &arr));
+            CHKiRet(jsoncowOwnElement(cow, arr, (int)idx, value));
+        }
+        FINALIZE;
+    }
+    if (json_object_object_get_ex(root, key, value)) {
+        CHKiRet(jsoncowOwnMember(cow, root, key, value));
+    } else {
+        *value = NULL;
+    }
+
+finalize_it:
+    RETiRet;
+}
+
 
-static rsRetVal jsonPathFindNext(
-    struct json_object *root, uchar *namestart, uchar **name, uchar *leaf, struct json_object **found, int bCreate) {
+/* cow is NULL if the tree is not shared, else root must already be private
+ * and so is the container found or created.
+ */
+static rsRetVal jsonPathFindNext(struct json_object *root,
+                                 uchar *namestart,
+                                 uchar **name,
+                                 uchar *leaf,
+                                 struct json_object **found,
+                                 int bCreate,
+                                 jsoncow_t *const cow) {
     uchar namebuf[MAX_VARIABLE_NAME_LEN];
     struct json_object *json;
     size_t i;
@@ -4962,7 +5067,9 @@ static rsRetVal jsonPathFindNext(
     }
     if (i > 0) {
         namebuf[i] = '\0';
-        if (jsonVarExtract(root, (char *)namebuf, &json) == FALSE) {
+        if (cow != NULL) {
+            CHKiRet(jsonVarExtractOwned(cow, root, (char *)namebuf, &json));
+        } else if (jsonVarExtract(root, (char *)namebuf, &json) == FALSE) {
             json = NULL;
         }
     } else
@@ -4980,6 +5087,7 @@ static rsRetVal jsonPathFindNext(
             }
             json = json_object_new_object();
             json_object_object_add(root, (char *)namebuf, json);
+            if (cow != NULL) CHKiRet(jsoncowAddOwned(cow, json));
         }
     }
 
@@ -4989,20 +5097,146 @@ finalize_it:
     RETiRet;
 }
 
-static rsRetVal jsonPathFindParent(
-    struct json_object *jroot, uchar *name, uchar *leaf, struct json_object **parent, const int bCreate) {
+static rsRetVal jsonPathFindParent(struct json_object *jroot,
+                                   uchar *name,
+                                   uchar *leaf,
+                                   struct json_object **parent,
+                                   const int bCreate,
+                                   jsoncow_t *const cow) {
     uchar *namestart;
     DEFiRet;
     namestart = name;
     *parent = jroot;
     while (name < leaf - 1) {
-        CHKiRet(jsonPathFindNext(*parent, namestart, &name, leaf, parent, bCreate));
+        CHKiRet(jsonPathFindNext(*parent, namestart, &name, leaf, parent, bCreate, cow));
     }
     if (*parent == NULL) ABORT_FINALIZE(RS_RET_NOT_FOUND);
 finalize_it:
     RETiRet;
 }
 
+/* A JSON property name, split into its components by msgPropDescrFill(),
+ * so that lookups need not parse the name for every message. The last
+ * component is the leaf; empty components are dropped like
+ * jsonPathFindNext() skips them.
+ */
+typedef struct jsonPathComp_s {
+    const char *key; /* the component as written */
+    const char *arrName; /* name part if key has the form "name[idx]", else NULL */
+    size_t idx;
+} jsonPathComp_t;
+
+struct jsonPath_s {
+    int nComps;
+    char *names; /* storage for all key and arrName strings */
+    jsonPathComp_t comps[];
+};
+
+/* same as jsonVarExtract(), for a precompiled component */
+static json_bool jsonPathCompExtract(struct json_object *root,
+                                     const jsonPathComp_t *const comp,
+                                     struct json_object **value) {
+    struct json_object *arr;
+    if (comp->arrName != NULL && json_object_object_get_ex(root, comp->arrName, &arr) &&
+        json_object_is_type(arr, json_type_array)) {
+        if (json_object_array_length(arr) > comp->idx) {
+            *value = json_object_array_get_idx(arr, comp->idx);
+            if (*value != NULL) return TRUE;
+        }
+        return FALSE;
+    }
+    return json_object_object_get_ex(root, comp->key, value);
+}
+
+static void jsonPathCompSet(jsonPathComp_t *const comp, char **const names, const uchar *const key, const size_t len) {
+    char namebuf[MAX_VARIABLE_NAME_LEN];
+    long idx;
+
+    comp->key = *names;
+    memcpy(*names, key, len);
+    (*names)[len] = '\0';
+    *names += len + 1;
+    comp->arrName = NULL;
+    if ((idx = jsonVarParseIndex(comp->key, namebuf)) >= 0) {
+        comp->arrName = *names;
+        strcpy(*names, namebuf);
+        *names += strlen(namebuf) + 1;
+        comp->idx = (size_t)idx;
+    }
+}
+
+/* Split the name of a JSON property into its components. This is only an
+ * optimization: if it is not possible, pProp->path stays NULL and lookups
+ * parse the name as before. Components too long for jsonPathFindNext() are
+ * left to it, so that the error is reported the same way.
+ */
+static void jsonPathCompile(msgPropDescr_t *const pProp) {
+    uchar *const leaf = jsonPathGetLeaf(pProp->name, pProp->nameLen);
+    const uchar *p;
+    const uchar *end;
+    int nComps = 1;
+    struct jsonPath_s *path;
+    char *names;
+
+    pProp->path = NULL;
+    if (pProp->name[1] == '\0') return; /* the whole tree */
+    for (p = pProp->name + 1; p < leaf; p = end + 1) {
+        end = (const uchar *)strchr((const char *)p, '!');
+        if (end == NULL || end >= leaf) end = leaf - 1;
+        if (end - p >= MAX_VARIABLE_NAME_LEN - 1) return;
+        if (end > p) ++nComps;
+    }
+    /* each component is stored at most twice, the index form with its name */
+    if ((path = malloc(sizeof(*path) + nComps * sizeof(jsonPathComp_t))) == NULL) return;
+    if ((names = malloc(2 * (ustrlen(pProp->name) + 1))) == NULL) {
+        free(path);
+        return;
+    }
+    path->nComps = nComps;
+    path->names = names;
+    nComps = 0;
+    for (p = pProp->name + 1; p < leaf; p = end + 1) {
+        end = (const uchar *)strchr((const char *)p, '!');
+        if (end == NULL || end >= leaf) end = leaf - 1;
+        if (end > p) jsonPathCompSet(&path->comps[nComps++], &names, p, end - p);
+    }
+    jsonPathCompSet(&path->comps[nComps], &names, leaf, ustrlen(leaf));
+    pProp->path = path;
+}
+
+/* Find the value of a JSON property below @root. Errors are those of the path
+ * walk to the leaf's parent; *pbFound tells whether the leaf exists, which
+ * *field does not, as a JSON null is represented by NULL.
+ */
+static rsRetVal jsonPropFind(struct json_object *root,
+                             const msgPropDescr_t *const pProp,
+                             struct json_object **field,
+                             json_bool *pbFound) {
+    struct json_object *parent;
+    DEFiRet;
+
+    if (pProp->path == NULL) {
+        uchar *const leaf = jsonPathGetLeaf(pProp->name, pProp->nameLen);
+        CHKiRet(jsonPathFindParent(root, pProp->name, leaf, &parent, 0, NULL));
+        *pbFound = jsonVarExtract(parent, (char *)leaf, field);
+    } else {
+        const jsonPathComp_t *const comps = pProp->path->comps;
+        const int iLeaf = pProp->path->nComps - 1;
+        parent = root;
+        for (int i = 0; i < iLeaf; ++i) {
+            if (jsonPathCompExtract(parent, &comps[i], &parent) == FALSE || parent == NULL) {
+                ABORT_FINALIZE(RS_RET_JNAME_INVALID);
+            }
+        }
+        if (parent == NULL) ABORT_FINALIZE(RS_RET_NOT_FOUND);
+        *pbFound = jsonPathCompExtract(parent, &comps[iLeaf], field);
+    }
+    if (!*pbFound) *field = NULL;
+
+finalize_it:
+    RETiRet;
+}
+
 static rsRetVal jsonMerge(struct json_object *existing, struct json_object *json) {
     DEFiRet;
 
@@ -5023,10 +5257,9 @@ static rsRetVal jsonMerge(struct json_object *existing, struct json_object *json
 
 /* find a JSON structure element (field or container doesn't matter).  */
 rsRetVal jsonFind(smsg_t *const pMsg, msgPropDescr_t *pProp, struct json_object **jsonres) {
-    uchar *leaf;
-    struct json_object *parent;
     struct json_object *field;
     struct json_object **jroot = NULL;
+    json_bool bFound;
     pthread_mutex_t *mut = NULL;
     DEFiRet;
 
@@ -5043,9 +5276,7 @@ rsRetVal jsonFind(smsg_t *const pMsg, msgPropDescr_t *pProp, struct json_object
     } else if (!strcmp((char *)pProp->name, ".")) {
         field = *jroot;
     } else {
-        leaf = jsonPathGetLeaf(pProp->name, pProp->nameLen);
-        CHKiRet(jsonPathFindParent(*jroot, pProp->name, leaf, &parent, 0));
-        if (jsonVarExtract(parent, (char *)leaf, &field) == FALSE) field = NULL;
+        CHKiRet(jsonPropFind(*jroot, pProp, &field, &bFound));
     }
     *jsonres = field;
 
@@ -5054,6 +5285,44 @@ finalize_it:
     RETiRet;
 }
 
+/* Same as jsonFind(), but returns a reference the caller must put. If the
+ * tree is shared with other messages, it is a deep copy, so that the caller
+ * may also render it.
+ */
+rsRetVal jsonFindRef(smsg_t *const pMsg, msgPropDescr_t *pProp, struct json_object **jsonres) {
+    struct json_object *field = NULL;
+    struct json_object **jroot = NULL;
+    json_bool bFound;
+    pthread_mutex_t *mut = NULL;
+    DEFiRet;
+
+    *jsonres = NULL;
+    CHKiRet(getJSONRootAndMutex(pMsg, pProp->id, &jroot, &mut));
+    pthread_mutex_lock(mut);
+#ifdef HAVE_LOGNORM_TURBO
+    if (pProp->id == PROP_CEE) msgMaterializeTurboJSON(pMsg);
+#endif
+
+    if (*jroot == NULL) FINALIZE;
+
+    if (!strcmp((char *)pProp->name, "!") || !strcmp((char *)pProp->name, ".")) {
+        field = *jroot;
+    } else {
+        CHKiRet(jsonPropFind(*jroot, pProp, &field, &bFound));
+    }
+    if (field != NULL) {
+        if (isJSONShared(pMsg, jroot)) {
+            CHKmalloc(*jsonres = jsonDeepCopy(field));
+        } else {
+            *jsonres = json_object_get(field);
+        }
+    }
+
+finalize_it:
+    if (mut != NULL) pthread_mutex_unlock(mut);
+    RETiRet;
+}
+
 /* check if JSON variable exists (works on terminal var and container) */
 rsRetVal ATTR_NONNULL() msgCheckVarExists(smsg_t *const pMsg, msgPropDescr_t *pProp) {
     struct json_object *jsonres = NULL;
@@ -5073,12 +5342,14 @@ rsRetVal msgAddJSON(smsg_t *const pM, uchar *name, struct json_object *json, int
     struct json_object **jroot;
     struct json_object *parent, *leafnode;
     struct json_object *given = NULL;
+    jsoncow_t **cow;
     uchar *leaf;
     pthread_mutex_t *mut = NULL;
     DEFiRet;
 
     CHKiRet(getJSONRootAndMutexByVarChar(pM, name[0], &jroot, &mut));
     pthread_mutex_lock(mut);
+    cow = getJSONCow(pM, jroot);
 #ifdef HAVE_LOGNORM_TURBO
     msgMaterializeTurboJSON(pM);
 #endif
@@ -5091,6 +5362,17 @@ rsRetVal msgAddJSON(smsg_t *const pM, uchar *name, struct json_object *json, int
         }
     }
 
+    if (*jroot == NULL) {
+        /* a new tree is not shared with anyone */
+        if (cow != NULL) jsoncowDestruct(cow);
+    } else if (cow != NULL && *cow != NULL) {
+        iRet = jsoncowOwnRoot(*cow, jroot);
+        if (unlikely(iRet != RS_RET_OK)) {
+            json_object_put(json);
+            FINALIZE;
+        }
+    }
+
     if (name[1] == '\0') { /* full tree? */
         if (*jroot == NULL)
             *jroot = json;
@@ -5102,7 +5384,7 @@ rsRetVal msgAddJSON(smsg_t *const pM, uchar *name, struct json_object *json, int
             *jroot = json_object_new_object();
         }
         leaf = jsonPathGetLeaf(name, ustrlen(name));
-        iRet = jsonPathFindParent(*jroot, name, leaf, &parent, 1);
+        iRet = jsonPathFindParent(*jroot, name, leaf, &parent, 1, (cow == NULL) ? NULL : *cow);
         if (unlikely(iRet != RS_RET_OK)) {
             json_object_put(json);
             FINALIZE;
@@ -5129,6 +5411,14 @@ rsRetVal msgAddJSON(smsg_t *const pM, uchar *name, struct json_object *json, int
         } else {
             if (json_object_get_type(json) == json_type_object) {
                 if (json_object_get_type(leafnode) == json_type_object) {
+                    if (cow != NULL && *cow != NULL) {
+                        /* merging modifies the existing object in place */
+                        iRet = jsonVarExtractOwned(*cow, parent, (char *)leaf, &leafnode);
+                        if (unlikely(iRet != RS_RET_OK)) {
+                            json_object_put(json);
+                            FINALIZE;
+                        }
+                    }
                     CHKiRet(jsonMerge(leafnode, json));
                 } else {
                     json_object_object_add(parent, (char *)leaf, json);
@@ -5159,12 +5449,14 @@ finalize_it:
 rsRetVal msgDelJSON(smsg_t *const pM, uchar *name) {
     struct json_object **jroot;
     struct json_object *parent, *leafnode;
+    jsoncow_t **cow;
     uchar *leaf;
     pthread_mutex_t *mut = NULL;
     DEFiRet;
 
     CHKiRet(getJSONRootAndMutexByVarChar(pM, name[0], &jroot, &mut));
     pthread_mutex_lock(mut);
+    cow = getJSONCow(pM, jroot);
 
     if (*jroot == NULL) {
         DBGPRINTF("msgDelJSONVar; jroot empty in unset for property %s\n", name);
@@ -5178,9 +5470,11 @@ rsRetVal msgDelJSON(smsg_t *const pM, uchar *name) {
         DBGPRINTF("unsetting JSON root object\n");
         json_object_put(*jroot);
         *jroot = NULL;
+        if (cow != NULL) jsoncowDestruct(cow);
     } else {
+        if (cow != NULL && *cow != NULL) CHKiRet(jsoncowOwnRoot(*cow, jroot));
         leaf = jsonPathGetLeaf(name, ustrlen(name));
-        CHKiRet(jsonPathFindParent(*jroot, name, leaf, &parent, 0));
+        CHKiRet(jsonPathFindParent(*jroot, name, leaf, &parent, 0, (cow == NULL) ? NULL : *cow));
         if (jsonVarExtract(parent, (char *)leaf, &leafnode) == FALSE) leafnode = NULL;
         if (leafnode == NULL) {
             DBGPRINTF("unset JSON: could not find '%s'\n", name);
@@ -5453,6 +5747,7 @@ rsRetVal msgPropDescrFill(msgPropDescr_t *pProp, uchar *name, int nameLen) {
         /* we patch the root name, so that support functions do not need to
          * check for different root chars. */
         pProp->name[0] = '!';
+        jsonPathCompile(pProp);
     }
     pProp->id = id;
 finalize_it:
@@ -5461,7 +5756,13 @@ finalize_it:
 
 void msgPropDescrDestruct(msgPropDescr_t *pProp) {
     if (pProp != NULL) {
-        if (pProp->id == PROP_CEE || pProp->id == PROP_LOCAL_VAR || pProp->id == PROP_GLOBAL_VAR) free(pProp->name);
+        if (pProp->id == PROP_CEE || pProp->id == PROP_LOCAL_VAR || pProp->id == PROP_GLOBAL_VAR) {
+            free(pProp->name);
+            if (pProp->path != NULL) {
+                free(pProp->path->names);
+                free(pProp->path);
+            }
+        }
     }
 }
 
@@ -5471,6 +5772,38 @@ static rsRetVal msgQueryInterface(interface_t __attribute__((unused)) * i) {
     return RS_RET_NOT_IMPLEMENTED;
 }
 
+/* called by the pool for message objects it gives back to malloc() */
+static void msgPoolObjDestruct(void *const pObj) {
+    pthread_mutex_destroy(&((smsg_t *)pObj)->mut);
+}
+
+static void msgPoolStatsRead(statsobj_t __attribute__((unused)) *const ignore_stats,
+                             void __attribute__((unused)) *const ignore_ctx) {
+    msgpoolStats_t poolCtrs;
+    msgpoolGetStats(&poolCtrs);
+    ctrPoolHits = poolCtrs.hits;
+    ctrPoolMisses = poolCtrs.misses;
+    ctrPoolRemoteFrees = poolCtrs.remoteFrees;
+    ctrPoolTrimmed = poolCtrs.trimmed;
+}
+
+static rsRetVal msgPoolInitStats(void) {
+    DEFiRet;
+    CHKiRet(statsobj.Construct(&poolStats));
+    CHKiRet(statsobj.SetName(poolStats, UCHAR_CONSTANT("msgpool")));
+    CHKiRet(statsobj.SetOrigin(poolStats, UCHAR_CONSTANT("msg")));
+    CHKiRet(statsobj.AddCounter(poolStats, UCHAR_CONSTANT("alloc.hit"), ctrType_IntCtr, 0, &ctrPoolHits));
+    CHKiRet(statsobj.AddCounter(poolStats, UCHAR_CONSTANT("alloc.miss"), ctrType_IntCtr, 0, &ctrPoolMisses));
+    CHKiRet(statsobj.AddCounter(poolStats, UCHAR_CONSTANT("free.remote"), ctrType_IntCtr, 0, &ctrPoolRemoteFrees));
+    CHKiRet(statsobj.AddCounter(poolStats, UCHAR_CONSTANT("free.trimmed"), ctrType_IntCtr, 0, &ctrPoolTrimmed));
+    CHKiRet(statsobj.SetReadNotifier(poolStats, msgPoolStatsRead, NULL));
+    CHKiRet(statsobj.ConstructFinalize(poolStats));
+
+finalize_it:
+    if (iRet != RS_RET_OK && poolStats != NULL) statsobj.Destruct(&poolStats);
+    RETiRet;
+}
+
 /* Initialize the message class. Must be called as the very first method
  * before anything else is called inside this class.
  * rgerhards, 2008-01-04
@@ -5483,6 +5816,10 @@ BEGINObjClassInit(msg, 1, OBJ_IS_CORE_MODULE)
     CHKiRet(objUse(glbl, CORE_COMPONENT));
     CHKiRet(objUse(prop, CORE_COMPONENT));
     CHKiRet(objUse(var, CORE_COMPONENT));
+    CHKiRet(objUse(statsobj, CORE_COMPONENT));
+
+    CHKiRet(msgpoolInit(sizeof(smsg_t), msgPoolObjDestruct));
+    CHKiRet(msgPoolInitStats());
 
     /* set our own handlers */
     OBJSetMethodHandler(objMethod_SERIALIZE, MsgSerialize);
@@ -5491,3 +5828,18 @@ BEGINObjClassInit(msg, 1, OBJ_IS_CORE_MODULE)
     INIT_ATOMIC_HELPER_MUT(mutTrimCtr);
 #endif
 ENDObjClassInit(msg)
+
+
+/* Exit the message class. Must only be called when all queues and actions
+ * are gone, as it frees the cached message objects.
+ */
+BEGINObjClassExit(msg, OBJ_IS_CORE_MODULE)
+    CODESTARTObjClassExit(msg);
+    if (poolStats != NULL) statsobj.Destruct(&poolStats);
+    msgpoolExit();
+    objRelease(datetime, CORE_COMPONENT);
+    objRelease(glbl, CORE_COMPONENT);
+    objRelease(prop, CORE_COMPONENT);
+    objRelease(var, CORE_COMPONENT);
+    objRelease(statsobj, CORE_COMPONENT);
+ENDObjClassExit(msg)
@@ -36,6 +36,9 @@
     #include "syslogd-types.h"
     #include "template.h"
     #include "atomic.h"
+    #include "jsoncow.h"
+
+struct rcvslab_s;
 
 /* rgerhards 2004-11-08: The following structure represents a
  * syslog message.
@@ -79,6 +82,7 @@ struct msg {
         int iLenPROGNAME; /* Length of PROGNAME (-1 = not yet set) */
         uchar *pszRawMsg; /* message as it was received on the wire. This is important in case we
                            * need to preserve cryptographic verifiers.  */
+        struct rcvslab_s *pRawSlab; /* receive slab pszRawMsg points into; NULL if the buffer is ours */
         uchar *pszHOSTNAME; /* HOSTNAME from syslog message */
         char *pszRcvdAt3164; /* time as RFC3164 formatted string (always 15 characters) */
         char *pszRcvdAt3339; /* time as RFC3164 formatted string (32 characters at most) */
@@ -111,8 +115,14 @@ struct msg {
                      it obviously is solved in way or another...). */
         struct syslogTime tRcvdAt; /* time the message entered this program */
         struct syslogTime tTIMESTAMP; /* (parsed) value of the timestamp */
+        uint64_t tLatencyRcvd; /* monotonic stamp for latency stats, 0 if not sampled (see msglatency.h) */
+        uint64_t tLatencyDeq; /* stamp of the dequeue from the main or ruleset queue */
         struct json_object *json;
         struct json_object *localvars;
+        /* copy-on-write state of json/localvars while shared with a MsgDup()
+         * copy, NULL if the tree is exclusively ours (see jsoncow.h) */
+        jsoncow_t *jsonCow;
+        jsoncow_t *localvarsCow;
     #ifdef HAVE_LOGNORM_TURBO
         /* Opaque turbo result slot — set by mmnormalize turbo path.
          * Enables zero-JSON data flow: template resolution reads fields
@@ -182,6 +192,7 @@ struct msg {
 /* function prototypes
  */
 PROTOTYPEObjClassInit(msg);
+PROTOTYPEObjClassExit(msg);
 rsRetVal msgConstruct(smsg_t **ppThis);
 rsRetVal msgConstructWithTime(smsg_t **ppThis, const struct syslogTime *stTime, const time_t ttGenTime);
 rsRetVal msgConstructForDeserializer(smsg_t **ppThis);
@@ -230,6 +241,8 @@ rsRetVal MsgSetAfterPRIOffs(smsg_t *pMsg, int offs);
 void MsgSetMSGoffs(smsg_t *pMsg, int offs);
 void MsgSetRawMsgWOSize(smsg_t *pMsg, char *pszRawMsg);
 void ATTR_NONNULL() MsgSetRawMsg(smsg_t *const pThis, const char *const pszRawMsg, const size_t lenMsg);
+void ATTR_NONNULL() MsgSetRawMsgRef(smsg_t *const pThis, struct rcvslab_s *const pSlab, char *const pszRawMsg,
+                                    const size_t lenMsg);
 rsRetVal MsgReplaceMSG(smsg_t *pThis, const uchar *pszMSG, int lenMSG);
 uchar *MsgGetProp(smsg_t *pMsg,
                   struct templateEntry *pTpe,
@@ -294,6 +307,8 @@ rsRetVal getJSONPropVal(
 rsRetVal msgSetJSONFromVar(smsg_t *pMsg, uchar *varname, struct svar *var, int force_reset);
 rsRetVal msgDelJSON(smsg_t *pMsg, uchar *varname);
 rsRetVal jsonFind(smsg_t *const pMsg, msgPropDescr_t *pProp, struct json_object **jsonres);
+rsRetVal jsonFindRef(smsg_t *const pMsg, msgPropDescr_t *pProp, struct json_object **jsonres);
+rsRetVal msgJSONTreeToString(smsg_t *const pMsg, const propid_t id, const int flags, char **const ppStr);
 struct json_object *jsonDeepCopy(struct json_object *src);
 
 rsRetVal msgPropDescrFill(msgPropDescr_t *pProp, uchar *name, int nameLen);
@@ -0,0 +1,140 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file msglatency.c
+ * @brief Optional message latency histograms for queues and actions.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "rsyslog.h"
+#include "obj.h"
+#include "atomic.h"
+#include "statsobj.h"
+#include "msglatency.h"
+
+DEFobjStaticHelpers;
+DEFobjCurrIf(statsobj)
+
+/* upper bounds of the buckets in microseconds; the last bucket is open-ended */
+static const uint64_t bucketBoundsUs[MSGLATENCY_NBUCKETS - 1] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000};
+
+int bMsgLatencyEnabled = 0;
+static unsigned sampling = 1;
+static shardedctr_t ctrSample; /* messages seen by the sampler, per shard */
+DEF_ATOMIC_HELPER_MUT64(mutCtrSample);
+
+
+rsRetVal msglatencyClassInit(void) {
+    DEFiRet;
+    CHKiRet(objGetObjInterface(&obj));
+    CHKiRet(objUse(statsobj, CORE_COMPONENT));
+    INIT_ATOMIC_HELPER_MUT64(mutCtrSample);
+    statsctrShardedInit(&ctrSample);
+finalize_it:
+    RETiRet;
+}
+
+
+void msglatencyConfigure(const int bEnabled, const unsigned samplingRate) {
+    sampling = (samplingRate == 0) ? 1 : samplingRate;
+    PREFER_STORE_INT(&bMsgLatencyEnabled, bEnabled ? 1 : 0);
+}
+
+
+uint64_t msglatencyNow(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    /* never 0, which means "not stamped" */
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec + 1;
+}
+
+
+uint64_t msglatencySample(void) {
+    if (sampling > 1 &&
+        ATOMIC_INC_AND_FETCH_uint64(statsctrShardedSlot(&ctrSample), &mutCtrSample) % sampling != 0) {
+        return 0;
+    }
+    return msglatencyNow();
+}
+
+
+rsRetVal msglatencyConstruct(msglatency_t **const ppThis, statsobj_t *const stats) {
+    msglatency_t *pThis;
+    char ctrName[64];
+    DEFiRet;
+
+    *ppThis = NULL;
+    if (!PREFER_FETCH_32BIT(bMsgLatencyEnabled)) FINALIZE;
+
+    CHKmalloc(pThis = calloc(1, sizeof(*pThis)));
+    INIT_ATOMIC_HELPER_MUT64(pThis->mutCtrs);
+    for (int i = 0; i < MSGLATENCY_NBUCKETS; ++i) statsctrShardedInit(&pThis->ctrBuckets[i]);
+    statsctrShardedInit(&pThis->ctrCount);
+    statsctrShardedInit(&pThis->ctrSumUs);
+    /* from here on the caller owns it, even if registering a counter fails */
+    *ppThis = pThis;
+
+    for (int i = 0; i < MSGLATENCY_NBUCKETS; ++i) {
+        if (i < MSGLATENCY_NBUCKETS - 1) {
+            snprintf(ctrName, sizeof(ctrName), "latency.le_%lluus", (unsigned long long)bucketBoundsUs[i]);
+        } else {
+            snprintf(ctrName, sizeof(ctrName), "latency.le_inf");
+        }
+        CHKiRet(statsobj.AddCounter(stats, (uchar *)ctrName, ctrType_ShardedCtr, CTR_FLAG_RESETTABLE,
+                                    &pThis->ctrBuckets[i]));
+    }
+    CHKiRet(statsobj.AddCounter(stats, UCHAR_CONSTANT("latency.count"), ctrType_ShardedCtr, CTR_FLAG_RESETTABLE,
+                                &pThis->ctrCount));
+    CHKiRet(statsobj.AddCounter(stats, UCHAR_CONSTANT("latency.sum_us"), ctrType_ShardedCtr, CTR_FLAG_RESETTABLE,
+                                &pThis->ctrSumUs));
+
+finalize_it:
+    RETiRet;
+}
+
+
+void msglatencyDestruct(msglatency_t **const ppThis) {
+    msglatency_t *const pThis = *ppThis;
+
+    if (pThis == NULL) return;
+    for (int i = 0; i < MSGLATENCY_NBUCKETS; ++i) statsctrShardedDestruct(&pThis->ctrBuckets[i]);
+    statsctrShardedDestruct(&pThis->ctrCount);
+    statsctrShardedDestruct(&pThis->ctrSumUs);
+    DESTROY_ATOMIC_HELPER_MUT64(pThis->mutCtrs);
+    free(pThis);
+    *ppThis = NULL;
+}
+
+
+void msglatencyRecord(msglatency_t *const pThis, const uint64_t since, const uint64_t now) {
+    uint64_t us;
+    int i;
+
+    if (since == 0) return;
+    us = (now > since) ? (now - since) / 1000 : 0;
+    for (i = 0; i < MSGLATENCY_NBUCKETS - 1 && us > bucketBoundsUs[i]; ++i) {
+        /* just find the bucket */
+    }
+    STATSCOUNTER_SHARDED_INC(pThis->ctrBuckets[i], pThis->mutCtrs);
+    STATSCOUNTER_SHARDED_INC(pThis->ctrCount, pThis->mutCtrs);
+    STATSCOUNTER_SHARDED_ADD(pThis->ctrSumUs, pThis->mutCtrs, us);
+}
+
+
+void msglatencyRecordNow(msglatency_t *const pThis, const uint64_t since) {
+    if (since != 0) msglatencyRecord(pThis, since, msglatencyNow());
+}
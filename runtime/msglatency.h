@@ -0,0 +1,92 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file msglatency.h
+ * @brief Optional message latency histograms for queues and actions.
+ *
+ * When enabled via global(stats.latency="on"), a message gets a monotonic
+ * timestamp when it is constructed. Each queue then records the time from
+ * that stamp (main and ruleset queues) or from the dequeue from the main or
+ * ruleset queue (action queues) until its consumer gets the message. Each
+ * action records the time from the construction until the message was
+ * handed to the output module; for transactional actions this is the
+ * commit of the batch. Non-transactional actions read the clock for each
+ * stamped message they handed over, transactional ones once per commit;
+ * stats.latency.sampling limits the number of clock reads.
+ *
+ * Latencies are counted in fixed buckets, published as regular impstats
+ * counters of the queue or action ("latency.le_<us>us", "latency.le_inf",
+ * "latency.count", "latency.sum_us"). Unlike a Prometheus histogram, the
+ * bucket counters are not cumulative: each message is counted in the
+ * first bucket whose upper bound is not below its latency.
+ *
+ * With stats.latency.sampling="N", only every N-th message is stamped,
+ * counted per statsctr shard so that input threads do not share a counter.
+ * Messages without a stamp cost a single compare at each stage.
+ */
+#ifndef INCLUDED_MSGLATENCY_H
+#define INCLUDED_MSGLATENCY_H
+
+#include <stdint.h>
+#include "rsyslog.h"
+#include "atomic.h"
+#include "statsctr.h"
+
+#define MSGLATENCY_NBUCKETS 17 /**< 16 bounded buckets plus the open-ended one */
+
+typedef struct msglatency_s {
+    shardedctr_t ctrBuckets[MSGLATENCY_NBUCKETS];
+    shardedctr_t ctrCount;
+    shardedctr_t ctrSumUs;
+    DEF_ATOMIC_HELPER_MUT64(mutCtrs);
+} msglatency_t;
+
+/** non-zero if messages are stamped; read via MSGLATENCY_STAMP() */
+extern int bMsgLatencyEnabled;
+
+/** @brief Stamp for a new message: now, or 0 if latency stats are off. */
+#define MSGLATENCY_STAMP() (PREFER_FETCH_32BIT(bMsgLatencyEnabled) ? msglatencySample() : 0)
+
+rsRetVal msglatencyClassInit(void);
+
+/**
+ * @brief Apply the global configuration; called when a config is activated.
+ *
+ * @param bEnabled stamp messages and create histograms for queues and actions
+ * @param sampling stamp only every sampling-th message; 0 acts as 1
+ */
+void msglatencyConfigure(int bEnabled, unsigned sampling);
+
+/** @brief Monotonic time in nanoseconds. */
+uint64_t msglatencyNow(void);
+
+/** @brief Current time if this message is to be sampled, else 0. */
+uint64_t msglatencySample(void);
+
+/**
+ * @brief Create a histogram and register its counters with @p stats.
+ *
+ * *ppThis is left NULL if latency stats are disabled. @p stats must be
+ * destructed before the histogram.
+ */
+rsRetVal msglatencyConstruct(msglatency_t **ppThis, statsobj_t *stats);
+
+void msglatencyDestruct(msglatency_t **ppThis);
+
+/** @brief Count the latency of a message stamped at @p since, as of @p now; no-op for since == 0. */
+void msglatencyRecord(msglatency_t *pThis, uint64_t since, uint64_t now);
+
+/** @brief Like msglatencyRecord(), reading the clock only if the message was stamped. */
+void msglatencyRecordNow(msglatency_t *pThis, uint64_t since);
+
+#endif /* #ifndef INCLUDED_MSGLATENCY_H */
@@ -0,0 +1,323 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file msgpool.c
+ * @brief Per-thread recycling pool for message objects.
+ *
+ * Every object is preceded by a small header naming the cache it belongs to
+ * and linking it into free lists. The counters of a cache are only written
+ * by its thread and are read relaxed by msgpoolGetStats().
+ *
+ * If MSGPOOL_BYPASS is defined (configure --disable-msgpool), no caches are
+ * created and every object goes straight to malloc() and free().
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "rsyslog.h"
+#include "atomic.h"
+#include "msgpool.h"
+
+#define MSGPOOL_REMOTE_SLOTS 4 /* owners a thread batches returns for at the same time */
+
+typedef struct msgpoolCache_s msgpoolCache_t;
+typedef union msgpoolHdr_u msgpoolHdr_t;
+
+/* the union keeps the object behind the header aligned for any member type */
+union msgpoolHdr_u {
+    struct {
+        msgpoolHdr_t *next;
+        msgpoolCache_t *owner; /* NULL if the object did not come from a cache */
+    } h;
+    long double alignLd;
+    uint64_t alignU64;
+    void *alignPtr;
+};
+
+struct msgpoolCache_s {
+    /* used by the owning thread only */
+    msgpoolHdr_t *freeList;
+    int nFree;
+    struct {
+        msgpoolCache_t *owner;
+        msgpoolHdr_t *head;
+        msgpoolHdr_t *tail;
+        int n;
+    } remote[MSGPOOL_REMOTE_SLOTS]; /* batches being collected for other caches */
+    int nextSlot;
+    uint64 nHits;
+    uint64 nMisses;
+    uint64 nRemoteFrees;
+    uint64 nTrimmed;
+    /* shared, protected by mutReturned */
+    pthread_mutex_t mutReturned;
+    msgpoolHdr_t *returned;
+    int nReturned;
+    /* protected by pool.mut */
+    msgpoolCache_t *nextCache;
+    msgpoolCache_t *nextOrphan;
+};
+
+static struct {
+    size_t objSize;
+    msgpoolObjDestruct_t objDestruct;
+    pthread_key_t key;
+    pthread_mutex_t mut;
+    msgpoolCache_t *caches; /* all caches ever created */
+    msgpoolCache_t *orphans; /* caches whose thread has exited */
+    int bExited; /* msgpoolExit() was called, caches are gone */
+} pool;
+
+#define CTR_INC(ctr, n) PREFER_STORE_uint64(&(ctr), (ctr) + (n))
+
+
+static void destroyObj(msgpoolHdr_t *const h) {
+    pool.objDestruct(h + 1);
+    free(h);
+}
+
+
+static void destroyList(msgpoolHdr_t *h) {
+    while (h != NULL) {
+        msgpoolHdr_t *const next = h->h.next;
+        destroyObj(h);
+        h = next;
+    }
+}
+
+
+/* hand a batch to its owner; if the owner already has plenty of returned
+ * objects waiting (e.g. an input blocked on a full queue), the batch is freed
+ * instead. Returns the number of objects freed.
+ */
+static int returnToOwner(msgpoolCache_t *const owner, msgpoolHdr_t *const head, msgpoolHdr_t *const tail, const int n) {
+    pthread_mutex_lock(&owner->mutReturned);
+    if (owner->nReturned < MSGPOOL_CACHE_MAX) {
+        tail->h.next = owner->returned;
+        owner->returned = head;
+        PREFER_STORE_INT(&owner->nReturned, owner->nReturned + n);
+        pthread_mutex_unlock(&owner->mutReturned);
+        return 0;
+    }
+    pthread_mutex_unlock(&owner->mutReturned);
+    tail->h.next = NULL;
+    destroyList(head);
+    return n;
+}
+
+
+static void flushSlot(msgpoolCache_t *const c, const int slot) {
+    if (c->remote[slot].n > 0) {
+        const int nTrimmed =
+            returnToOwner(c->remote[slot].owner, c->remote[slot].head, c->remote[slot].tail, c->remote[slot].n);
+        CTR_INC(c->nRemoteFrees, c->remote[slot].n - nTrimmed);
+        CTR_INC(c->nTrimmed, nTrimmed);
+    }
+    c->remote[slot].owner = NULL;
+    c->remote[slot].head = c->remote[slot].tail = NULL;
+    c->remote[slot].n = 0;
+}
+
+
+static void addRemote(msgpoolCache_t *const c, msgpoolCache_t *const owner, msgpoolHdr_t *const h) {
+    int slot;
+    int freeSlot = -1;
+
+    for (slot = 0; slot < MSGPOOL_REMOTE_SLOTS; ++slot) {
+        if (c->remote[slot].owner == owner) break;
+        if (c->remote[slot].owner == NULL && freeSlot == -1) freeSlot = slot;
+    }
+    if (slot == MSGPOOL_REMOTE_SLOTS) {
+        if (freeSlot == -1) {
+            freeSlot = c->nextSlot;
+            c->nextSlot = (c->nextSlot + 1) % MSGPOOL_REMOTE_SLOTS;
+            flushSlot(c, freeSlot);
+        }
+        slot = freeSlot;
+        c->remote[slot].owner = owner;
+        c->remote[slot].tail = h;
+    }
+    h->h.next = c->remote[slot].head;
+    c->remote[slot].head = h;
+    if (++c->remote[slot].n == MSGPOOL_BATCH) flushSlot(c, slot);
+}
+
+
+/* thread exit: pass on what we collected for others and let the next new
+ * thread adopt our cache, as objects owned by it may still be in use
+ */
+static void orphanCache(void *const p) {
+    msgpoolCache_t *const c = (msgpoolCache_t *)p;
+    for (int slot = 0; slot < MSGPOOL_REMOTE_SLOTS; ++slot) flushSlot(c, slot);
+    pthread_mutex_lock(&pool.mut);
+    c->nextOrphan = pool.orphans;
+    pool.orphans = c;
+    pthread_mutex_unlock(&pool.mut);
+}
+
+
+static msgpoolCache_t *getCache(void) {
+    msgpoolCache_t *c = (msgpoolCache_t *)pthread_getspecific(pool.key);
+
+    if (c != NULL) return c;
+
+    pthread_mutex_lock(&pool.mut);
+    if ((c = pool.orphans) != NULL) pool.orphans = c->nextOrphan;
+    pthread_mutex_unlock(&pool.mut);
+    if (c == NULL) {
+        if ((c = calloc(1, sizeof(msgpoolCache_t))) == NULL) return NULL;
+        pthread_mutex_init(&c->mutReturned, NULL);
+        pthread_mutex_lock(&pool.mut);
+        c->nextCache = pool.caches;
+        pool.caches = c;
+        pthread_mutex_unlock(&pool.mut);
+    }
+    if (pthread_setspecific(pool.key, c) != 0) {
+        orphanCache(c);
+        return NULL;
+    }
+    return c;
+}
+
+
+/* take over what other threads returned; called when the free list is empty
+ * or when so much was returned that further batches would have to be freed
+ */
+static void reclaimReturned(msgpoolCache_t *const c) {
+    msgpoolHdr_t *h;
+
+    pthread_mutex_lock(&c->mutReturned);
+    h = c->returned;
+    c->returned = NULL;
+    PREFER_STORE_0_TO_INT(&c->nReturned);
+    pthread_mutex_unlock(&c->mutReturned);
+
+    while (h != NULL && c->nFree < MSGPOOL_CACHE_MAX) {
+        msgpoolHdr_t *const next = h->h.next;
+        h->h.next = c->freeList;
+        c->freeList = h;
+        ++c->nFree;
+        h = next;
+    }
+    while (h != NULL) {
+        msgpoolHdr_t *const next = h->h.next;
+        destroyObj(h);
+        CTR_INC(c->nTrimmed, 1);
+        h = next;
+    }
+}
+
+
+rsRetVal msgpoolInit(const size_t objSize, const msgpoolObjDestruct_t objDestruct) {
+    DEFiRet;
+
+    pool.objSize = objSize;
+    pool.objDestruct = objDestruct;
+    pool.caches = NULL;
+    pool.orphans = NULL;
+    pool.bExited = 0;
+    if (pthread_key_create(&pool.key, orphanCache) != 0) {
+        ABORT_FINALIZE(RS_RET_ERR);
+    }
+    pthread_mutex_init(&pool.mut, NULL);
+
+finalize_it:
+    RETiRet;
+}
+
+
+void msgpoolExit(void) {
+    msgpoolCache_t *c = pool.caches;
+
+    PREFER_STORE_1_TO_INT(&pool.bExited);
+    pthread_key_delete(pool.key);
+    while (c != NULL) {
+        msgpoolCache_t *const next = c->nextCache;
+        for (int slot = 0; slot < MSGPOOL_REMOTE_SLOTS; ++slot) {
+            if (c->remote[slot].tail != NULL) c->remote[slot].tail->h.next = NULL;
+            destroyList(c->remote[slot].head);
+        }
+        destroyList(c->freeList);
+        destroyList(c->returned);
+        pthread_mutex_destroy(&c->mutReturned);
+        free(c);
+        c = next;
+    }
+    pool.caches = NULL;
+    pool.orphans = NULL;
+    pthread_mutex_destroy(&pool.mut);
+}
+
+
+void *msgpoolAlloc(int *const pbRecycled) {
+#ifdef MSGPOOL_BYPASS
+    msgpoolCache_t *const c = NULL;
+#else
+    msgpoolCache_t *const c = PREFER_LOAD_INT(&pool.bExited) ? NULL : getCache();
+#endif
+    msgpoolHdr_t *h;
+
+    if (c != NULL) {
+        if (c->freeList == NULL || PREFER_LOAD_INT(&c->nReturned) >= MSGPOOL_CACHE_MAX / 2) reclaimReturned(c);
+        if ((h = c->freeList) != NULL) {
+            c->freeList = h->h.next;
+            --c->nFree;
+            CTR_INC(c->nHits, 1);
+            *pbRecycled = 1;
+            return h + 1;
+        }
+        CTR_INC(c->nMisses, 1);
+    }
+    if ((h = malloc(sizeof(msgpoolHdr_t) + pool.objSize)) == NULL) return NULL;
+    h->h.owner = c;
+    *pbRecycled = 0;
+    return h + 1;
+}
+
+
+void msgpoolRelease(void *const pObj) {
+    msgpoolHdr_t *const h = (msgpoolHdr_t *)pObj - 1;
+    msgpoolCache_t *const owner = h->h.owner;
+    msgpoolCache_t *c;
+
+    if (owner == NULL || PREFER_LOAD_INT(&pool.bExited)) {
+        destroyObj(h); /* after msgpoolExit(), owner points to a freed cache */
+    } else if ((c = getCache()) == owner) {
+        if (c->nFree < MSGPOOL_CACHE_MAX) {
+            h->h.next = c->freeList;
+            c->freeList = h;
+            ++c->nFree;
+        } else {
+            destroyObj(h);
+            CTR_INC(c->nTrimmed, 1);
+        }
+    } else if (c == NULL) {
+        (void)returnToOwner(owner, h, h, 1);
+    } else {
+        addRemote(c, owner, h);
+    }
+}
+
+
+void msgpoolGetStats(msgpoolStats_t *const pStats) {
+    pStats->hits = pStats->misses = pStats->remoteFrees = pStats->trimmed = 0;
+    pthread_mutex_lock(&pool.mut);
+    for (msgpoolCache_t *c = pool.caches; c != NULL; c = c->nextCache) {
+        pStats->hits += PREFER_LOAD_uint64(&c->nHits);
+        pStats->misses += PREFER_LOAD_uint64(&c->nMisses);
+        pStats->remoteFrees += PREFER_LOAD_uint64(&c->nRemoteFrees);
+        pStats->trimmed += PREFER_LOAD_uint64(&c->nTrimmed);
+    }
+    pthread_mutex_unlock(&pool.mut);
+}
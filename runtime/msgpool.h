@@ -0,0 +1,90 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file msgpool.h
+ * @brief Per-thread recycling pool for message objects.
+ *
+ * Message objects are usually constructed by an input thread and destructed
+ * by a queue worker. Handing each of them back to malloc() means a
+ * cross-thread free plus a fresh pthread_mutex_init() for every message. The
+ * pool instead keeps destructed objects, including their still initialized
+ * mutex, for reuse.
+ *
+ * Every thread has its own cache. An object always returns to the cache of
+ * the thread that allocated it: the owner puts it on its local free list
+ * without any locking, other threads collect it in a small per-owner batch
+ * and hand over the whole batch under the owner's return lock. The owner
+ * picks up returned objects when its free list ran empty or when many were
+ * returned. Caches of exited threads are adopted by the next new thread.
+ *
+ * A cache keeps at most MSGPOOL_CACHE_MAX free and about as many returned
+ * objects; anything beyond that goes back to malloc(). So a thread that has
+ * far more messages in flight, e.g. an input blocked on a full queue, only
+ * recycles part of them, but an idle input does not pin a burst's worth of
+ * memory.
+ *
+ * Configuring with --disable-msgpool defines MSGPOOL_BYPASS, which turns the
+ * pool into plain malloc()/free(). This is meant for sanitizer and valgrind
+ * builds, which can only track objects that really go back to the allocator.
+ */
+#ifndef INCLUDED_MSGPOOL_H
+#define INCLUDED_MSGPOOL_H
+
+#include <stddef.h>
+#include "rsyslog.h"
+
+#define MSGPOOL_CACHE_MAX 1024 /**< free objects kept per thread */
+#define MSGPOOL_BATCH 32 /**< objects handed back to another thread at once */
+
+/** @brief Release the resources of an object that leaves the pool. */
+typedef void (*msgpoolObjDestruct_t)(void *pObj);
+
+/** @brief Pool counters, summed over all thread caches. */
+typedef struct msgpoolStats_s {
+    uint64 hits; /**< allocations served from a cache */
+    uint64 misses; /**< allocations that had to call malloc() */
+    uint64 remoteFrees; /**< objects returned to another thread's cache */
+    uint64 trimmed; /**< objects given back to malloc() because a cache was full */
+} msgpoolStats_t;
+
+/**
+ * @brief Set up the pool; must be called once before any other function.
+ * @param objSize     size of the pooled objects
+ * @param objDestruct called for objects that leave the pool for good
+ * @return RS_RET_OK or RS_RET_ERR if no thread key is available
+ */
+rsRetVal msgpoolInit(size_t objSize, msgpoolObjDestruct_t objDestruct);
+
+/**
+ * @brief Free all cached objects and caches.
+ *
+ * Must only be called when no other thread uses the pool anymore. Objects
+ * still in use may be released afterwards; they are freed right away.
+ */
+void msgpoolExit(void);
+
+/**
+ * @brief Get an object.
+ * @param pbRecycled set to 1 if the object was released before, in which
+ *        case everything the object destructor would release is still set up
+ * @return the object or NULL if out of memory
+ */
+void *msgpoolAlloc(int *pbRecycled);
+
+/** @brief Return an object obtained from msgpoolAlloc(); any thread may call this. */
+void msgpoolRelease(void *pObj);
+
+/** @brief Sum the counters of all caches; values are approximate while threads run. */
+void msgpoolGetStats(msgpoolStats_t *pStats);
+
+#endif /* #ifndef INCLUDED_MSGPOOL_H */
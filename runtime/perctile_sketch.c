@@ -0,0 +1,250 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file perctile_sketch.c
+ * @brief Mergeable log-bucket percentile sketch.
+ *
+ * With gamma = (1 + accuracy) / (1 - accuracy), bucket k >= 1 counts the
+ * values in (gamma^(k-2), gamma^(k-1)] and is estimated as
+ * 2 * gamma^(k-1) / (gamma + 1), which is within the accuracy of every
+ * value in it. Bucket 0 counts everything below 1. If maxBuckets is too
+ * small to reach INT64_MAX, the last bucket is open-ended and estimated as
+ * the largest observed value.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <pthread.h>
+#include "rsyslog.h"
+#include "atomic.h"
+#include "statsctr.h"
+#include "perctile_sketch.h"
+
+/* min and max hold int64 bit patterns; these mark "nothing seen yet" */
+#define MIN_UNSET ((uint64)INT64_MAX)
+#define MAX_UNSET ((uint64)INT64_MIN)
+
+typedef struct sketch_shard_s {
+    uint64 *counts; /* nBuckets counters, allocated when the shard is first used */
+    uint64 sum; /* two's complement sum of the observed values */
+    uint64 min;
+    uint64 max;
+    DEF_ATOMIC_HELPER_MUT(mutCounts);
+    DEF_ATOMIC_HELPER_MUT64(mutVals);
+} sketch_shard_t;
+
+/* each shard starts on its own cache line */
+#define SHARD_STRIDE ((sizeof(sketch_shard_t) + STATSCTR_CACHELINE - 1) / STATSCTR_CACHELINE * STATSCTR_CACHELINE)
+
+struct perctile_sketch_s {
+    double gamma;
+    double invLnGamma; /* 1 / ln(gamma) */
+    uint32_t nBuckets;
+    sbool bOpenEnded; /* last bucket also takes everything above its range */
+    unsigned mask; /* number of shards - 1 */
+    void *mem; /* allocation holding the shards */
+    char *shards; /* first shard, cache line aligned */
+};
+
+
+static sketch_shard_t *shardAt(const perctile_sketch_t *const pThis, const unsigned idx) {
+    return (sketch_shard_t *)(pThis->shards + (size_t)idx * SHARD_STRIDE);
+}
+
+
+static uint32_t bucketOf(const perctile_sketch_t *const pThis, const int64_t value) {
+    double k;
+
+    if (value < 1) return 0;
+    k = ceil(log((double)value) * pThis->invLnGamma);
+    if (k >= (double)(pThis->nBuckets - 1)) return pThis->nBuckets - 1;
+    return (uint32_t)k + 1;
+}
+
+
+static int64_t bucketValue(const perctile_sketch_t *const pThis, const size_t bucket) {
+    double value;
+
+    if (bucket == 0) return 0;
+    value = 2.0 * pow(pThis->gamma, (double)(bucket - 1)) / (pThis->gamma + 1.0);
+    if (value >= (double)INT64_MAX) return INT64_MAX;
+    return (int64_t)llround(value);
+}
+
+
+/* atomically read a value and replace it by reset */
+static uint64 takeValue(sketch_shard_t __attribute__((unused)) * const shard, uint64 *const data, const uint64 reset) {
+    uint64 value;
+
+    do {
+        value = PREFER_LOAD_uint64(data);
+    } while (value != reset && !ATOMIC_CAS_uint64(data, value, reset, &shard->mutVals));
+    return value;
+}
+
+
+rsRetVal perctile_sketch_new(perctile_sketch_t **const ppSketch, const double accuracy, const uint32_t maxBuckets) {
+    perctile_sketch_t *pThis = NULL;
+    const unsigned nShards = statsctrNumShards();
+    double needed;
+    DEFiRet;
+
+    if (!(accuracy >= PERCTILE_SKETCH_MIN_ACCURACY && accuracy <= PERCTILE_SKETCH_MAX_ACCURACY) ||
+        maxBuckets < PERCTILE_SKETCH_MIN_BUCKETS || maxBuckets > PERCTILE_SKETCH_MAX_BUCKETS) {
+        ABORT_FINALIZE(RS_RET_PARAM_ERROR);
+    }
+    CHKmalloc(pThis = calloc(1, sizeof(*pThis)));
+    pThis->gamma = (1.0 + accuracy) / (1.0 - accuracy);
+    pThis->invLnGamma = 1.0 / log(pThis->gamma);
+    /* no need for more buckets than it takes to cover all of int64 */
+    needed = ceil(log((double)INT64_MAX) * pThis->invLnGamma) + 2;
+    if (needed <= (double)maxBuckets) {
+        pThis->nBuckets = (uint32_t)needed;
+    } else {
+        pThis->nBuckets = maxBuckets;
+        pThis->bOpenEnded = 1;
+    }
+
+    /* one spare stride to align the first shard */
+    CHKmalloc(pThis->mem = calloc(nShards + 1, SHARD_STRIDE));
+    pThis->shards = (char *)(((uintptr_t)pThis->mem + STATSCTR_CACHELINE - 1) & ~(uintptr_t)(STATSCTR_CACHELINE - 1));
+    pThis->mask = nShards - 1;
+    for (unsigned i = 0; i < nShards; ++i) {
+        sketch_shard_t *const shard = shardAt(pThis, i);
+        INIT_ATOMIC_HELPER_MUT(shard->mutCounts);
+        INIT_ATOMIC_HELPER_MUT64(shard->mutVals);
+        shard->min = MIN_UNSET;
+        shard->max = MAX_UNSET;
+    }
+    *ppSketch = pThis;
+
+finalize_it:
+    if (iRet != RS_RET_OK && pThis != NULL) {
+        free(pThis->mem);
+        free(pThis);
+    }
+    RETiRet;
+}
+
+
+void perctile_sketch_del(perctile_sketch_t *const pThis) {
+    if (pThis == NULL) return;
+    for (unsigned i = 0; i <= pThis->mask; ++i) {
+        sketch_shard_t *const shard = shardAt(pThis, i);
+        free(shard->counts);
+        DESTROY_ATOMIC_HELPER_MUT(shard->mutCounts);
+        DESTROY_ATOMIC_HELPER_MUT64(shard->mutVals);
+    }
+    free(pThis->mem);
+    free(pThis);
+}
+
+
+size_t perctile_sketch_buckets(const perctile_sketch_t *const pThis) {
+    return pThis->nBuckets;
+}
+
+
+rsRetVal perctile_sketch_add(perctile_sketch_t *const pThis, const int64_t value) {
+    sketch_shard_t *const shard = shardAt(pThis, statsctrThreadIdx() & pThis->mask);
+    uint64 *counts;
+    uint64 curr;
+    DEFiRet;
+
+    counts = ATOMIC_LOAD_PTR((void **)&shard->counts, &shard->mutCounts);
+    if (counts == NULL) {
+        CHKmalloc(counts = calloc(pThis->nBuckets, sizeof(uint64)));
+        if (!ATOMIC_CAS_PTR((void **)&shard->counts, NULL, counts, &shard->mutCounts)) {
+            /* another thread mapped to this shard was first */
+            free(counts);
+            counts = ATOMIC_LOAD_PTR((void **)&shard->counts, &shard->mutCounts);
+        }
+    }
+
+    ATOMIC_INC_uint64_RELAXED(&counts[bucketOf(pThis, value)], &shard->mutVals);
+    ATOMIC_ADD_uint64_RELAXED(&shard->sum, &shard->mutVals, (uint64)value);
+    do {
+        curr = PREFER_LOAD_uint64(&shard->min);
+    } while ((int64_t)curr > value && !ATOMIC_CAS_uint64(&shard->min, curr, (uint64)value, &shard->mutVals));
+    do {
+        curr = PREFER_LOAD_uint64(&shard->max);
+    } while ((int64_t)curr < value && !ATOMIC_CAS_uint64(&shard->max, curr, (uint64)value, &shard->mutVals));
+
+finalize_it:
+    RETiRet;
+}
+
+
+void perctile_sketch_collect(perctile_sketch_t *const pThis, uint64_t *const merged, perctile_sketch_window_t *const win) {
+    int64_t value;
+
+    memset(merged, 0, pThis->nBuckets * sizeof(*merged));
+    win->count = 0;
+    win->sum = 0;
+    win->min = INT64_MAX;
+    win->max = INT64_MIN;
+    for (unsigned i = 0; i <= pThis->mask; ++i) {
+        sketch_shard_t *const shard = shardAt(pThis, i);
+        uint64 *const counts = ATOMIC_LOAD_PTR((void **)&shard->counts, &shard->mutCounts);
+
+        if (counts == NULL) continue;
+        for (uint32_t b = 0; b < pThis->nBuckets; ++b) {
+            if (PREFER_LOAD_uint64(&counts[b]) != 0) {
+                const uint64 n = takeValue(shard, &counts[b], 0);
+                merged[b] += n;
+                win->count += n;
+            }
+        }
+        win->sum += (int64_t)takeValue(shard, &shard->sum, 0);
+        value = (int64_t)takeValue(shard, &shard->min, MIN_UNSET);
+        if (value < win->min) win->min = value;
+        value = (int64_t)takeValue(shard, &shard->max, MAX_UNSET);
+        if (value > win->max) win->max = value;
+    }
+
+    /* an observation racing with us may have had its bucket counted but its
+     * min/max update deferred to the next window; fall back to the buckets */
+    if (win->count > 0 && (win->min == INT64_MAX || win->max == INT64_MIN)) {
+        uint32_t lo = 0;
+        uint32_t hi = pThis->nBuckets - 1;
+        while (merged[lo] == 0) ++lo;
+        while (merged[hi] == 0) --hi;
+        if (win->min == INT64_MAX) win->min = bucketValue(pThis, lo);
+        if (win->max == INT64_MIN) win->max = bucketValue(pThis, hi);
+    }
+}
+
+
+int64_t perctile_sketch_quantile(const perctile_sketch_t *const pThis,
+                                 const uint64_t *const merged,
+                                 const perctile_sketch_window_t *const win,
+                                 const uint8_t percentile) {
+    uint64_t rank = (uint64_t)((percentile / 100.0) * win->count);
+    uint64_t seen = 0;
+    size_t b;
+    int64_t value;
+
+    /* same rank as the ring buffer backend: max(0, P/100 * N - 1) */
+    if (rank > 0) --rank;
+    for (b = 0; b < pThis->nBuckets - 1; ++b) {
+        seen += merged[b];
+        if (seen > rank) break;
+    }
+    /* the open-ended bucket has no meaningful midpoint, but holds the max */
+    value = (pThis->bOpenEnded && b == pThis->nBuckets - 1) ? win->max : bucketValue(pThis, b);
+    if (value < win->min) value = win->min;
+    if (value > win->max) value = win->max;
+    return value;
+}
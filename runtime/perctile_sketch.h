@@ -0,0 +1,97 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file perctile_sketch.h
+ * @brief Mergeable log-bucket percentile sketch for percentile_stats.
+ *
+ * A sketch counts observations in buckets whose bounds grow geometrically,
+ * so every estimate is within a configured relative accuracy of a value
+ * that was actually observed (DDSketch mapping). The number of buckets is
+ * fixed when the sketch is created, which bounds its memory.
+ *
+ * Observers record into the shard of their thread (see statsctr.h) with
+ * relaxed atomic updates only. The reporter merges all shards into one
+ * histogram and resets them in the same pass, so each report covers the
+ * observations made since the previous one.
+ */
+#ifndef INCLUDED_PERCTILE_SKETCH_H
+#define INCLUDED_PERCTILE_SKETCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "rsyslog.h"
+
+#define PERCTILE_SKETCH_DFLT_ACCURACY 0.01
+#define PERCTILE_SKETCH_MIN_ACCURACY 0.0001
+#define PERCTILE_SKETCH_MAX_ACCURACY 0.5
+#define PERCTILE_SKETCH_DFLT_MAX_BUCKETS 2048
+#define PERCTILE_SKETCH_MIN_BUCKETS 16
+#define PERCTILE_SKETCH_MAX_BUCKETS 65536
+
+typedef struct perctile_sketch_s perctile_sketch_t;
+
+/** summary of the observations merged by perctile_sketch_collect() */
+typedef struct perctile_sketch_window_s {
+    uint64_t count;
+    int64_t sum;
+    int64_t min;
+    int64_t max;
+} perctile_sketch_window_t;
+
+/**
+ * @brief Create a sketch.
+ *
+ * @param accuracy relative accuracy of the estimates, e.g. 0.01 for 1%
+ * @param maxBuckets upper bound for the number of buckets per shard; fewer
+ *        are used if they already cover the whole int64 range. Otherwise
+ *        values above the range of the last bucket are counted there and
+ *        that bucket is estimated as the largest observed value.
+ */
+rsRetVal perctile_sketch_new(perctile_sketch_t **ppSketch, double accuracy, uint32_t maxBuckets);
+
+void perctile_sketch_del(perctile_sketch_t *pSketch);
+
+/** @return number of buckets, i.e. the size of the array perctile_sketch_collect() fills */
+size_t perctile_sketch_buckets(const perctile_sketch_t *pSketch);
+
+/**
+ * @brief Record one observation; lock-free, callable from any thread.
+ *
+ * Values below 1 share a single bucket that is estimated as 0.
+ * @return RS_RET_OUT_OF_MEMORY if this thread's shard could not be allocated
+ */
+rsRetVal perctile_sketch_add(perctile_sketch_t *pSketch, int64_t value);
+
+/**
+ * @brief Merge all shards into @p merged and reset them.
+ *
+ * @param merged array of perctile_sketch_buckets() counters, overwritten
+ * @param win receives count, sum, min and max of the merged observations
+ *
+ * Observations racing with the collection are reported either now or with
+ * the next collection, never lost. Only one thread may collect at a time.
+ */
+void perctile_sketch_collect(perctile_sketch_t *pSketch, uint64_t *merged, perctile_sketch_window_t *win);
+
+/**
+ * @brief Estimate a percentile from a collected histogram.
+ *
+ * Uses the same rank as the ring buffer backend and clamps the estimate to
+ * the window's min and max. @p win->count must not be 0.
+ */
+int64_t perctile_sketch_quantile(const perctile_sketch_t *pSketch,
+                                 const uint64_t *merged,
+                                 const perctile_sketch_window_t *win,
+                                 uint8_t percentile);
+
+#endif /* #ifndef INCLUDED_PERCTILE_SKETCH_H */
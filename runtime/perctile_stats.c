@@ -29,6 +29,7 @@
 #include "perctile_stats.h"
 #include "hashtable_itr.h"
 #include "perctile_ringbuf.h"
+#include "perctile_sketch.h"
 #include "datetime.h"
 
 #include <stdio.h>
@@ -54,6 +55,9 @@ DEFobjCurrIf(statsobj) DEFobjCurrIf(datetime)
 #define PERCTILE_CONF_PARAM_PERCENTILES "percentiles"
 #define PERCTILE_CONF_PARAM_WINDOW_SIZE "windowsize"
 #define PERCTILE_CONF_PARAM_DELIM "delimiter"
+#define PERCTILE_CONF_PARAM_BACKEND "backend"
+#define PERCTILE_CONF_PARAM_SKETCH_ACCURACY "sketch.accuracy"
+#define PERCTILE_CONF_PARAM_SKETCH_MAX_BUCKETS "sketch.maxbuckets"
 
 #define PERCTILE_MAX_BUCKET_NS_METRIC_LENGTH 128
 #define PERCTILE_METRIC_NAME_SEPARATOR '.'
@@ -63,6 +67,9 @@ DEFobjCurrIf(statsobj) DEFobjCurrIf(datetime)
         {PERCTILE_CONF_PARAM_DELIM, eCmdHdlrString, 0},
         {PERCTILE_CONF_PARAM_PERCENTILES, eCmdHdlrArray, 0},
         {PERCTILE_CONF_PARAM_WINDOW_SIZE, eCmdHdlrPositiveInt, 0},
+        {PERCTILE_CONF_PARAM_BACKEND, eCmdHdlrString, 0},
+        {PERCTILE_CONF_PARAM_SKETCH_ACCURACY, eCmdHdlrString, 0},
+        {PERCTILE_CONF_PARAM_SKETCH_MAX_BUCKETS, eCmdHdlrPositiveInt, 0},
 };
 
 static struct cnfparamblk modpblk = {CNFPARAMBLK_VERSION, sizeof(modpdescr) / sizeof(struct cnfparamdescr), modpdescr};
@@ -100,6 +107,7 @@ static void perctileStatDestruct(perctile_bucket_t *b, perctile_stat_t *pstat) {
         if (pstat->rb_observed_stats) {
             ringbuf_del(pstat->rb_observed_stats);
         }
+        perctile_sketch_del(pstat->sketch);
 
         if (pstat->ctrs) {
             for (size_t i = 0; i < pstat->perctile_ctrs_count; ++i) {
@@ -289,13 +297,25 @@ finalize_it:
 static rsRetVal perctile_observe(perctile_bucket_t *bkt, uchar *key, int64_t value) {
     uint8_t lock_initialized = 0;
     uchar *hash_key = NULL;
+    perctile_stat_t *pstat;
     DEFiRet;
-    time_t now;
-    datetime.GetTime(&now);
+
+    if (bkt->backend == PERCTILE_BACKEND_SKETCH) {
+        /* known keys only need the read lock, the sketch itself records lock-free */
+        pthread_rwlock_rdlock(&bkt->lock);
+        lock_initialized = 1;
+        pstat = (perctile_stat_t *)hashtable_search(bkt->htable, key);
+        if (pstat) {
+            CHKiRet(perctile_sketch_add(pstat->sketch, value));
+            FINALIZE;
+        }
+        pthread_rwlock_unlock(&bkt->lock);
+        lock_initialized = 0;
+    }
 
     pthread_rwlock_wrlock(&bkt->lock);
     lock_initialized = 1;
-    perctile_stat_t *pstat = (perctile_stat_t *)hashtable_search(bkt->htable, key);
+    pstat = (perctile_stat_t *)hashtable_search(bkt->htable, key);
     if (!pstat) {
         PERCTILE_STATS_LOG("perctile_observe(): key '%s' not found - creating new pstat", key);
         // create the pstat if not found
@@ -306,11 +326,20 @@ static rsRetVal perctile_observe(perctile_bucket_t *bkt, uchar *key, int64_t val
             ABORT_FINALIZE(RS_RET_OUT_OF_MEMORY);
         }
         pstat->perctile_ctrs_count = bkt->perctile_values_count;
-        pstat->rb_observed_stats = ringbuf_new(bkt->window_size);
-        if (!pstat->rb_observed_stats) {
-            free(pstat->ctrs);
-            free(pstat);
-            ABORT_FINALIZE(RS_RET_OUT_OF_MEMORY);
+        if (bkt->backend == PERCTILE_BACKEND_SKETCH) {
+            /* parameters were validated at config load, so only memory can fail */
+            if (perctile_sketch_new(&pstat->sketch, bkt->sketch_accuracy, bkt->sketch_max_buckets) != RS_RET_OK) {
+                free(pstat->ctrs);
+                free(pstat);
+                ABORT_FINALIZE(RS_RET_OUT_OF_MEMORY);
+            }
+        } else {
+            pstat->rb_observed_stats = ringbuf_new(bkt->window_size);
+            if (!pstat->rb_observed_stats) {
+                free(pstat->ctrs);
+                free(pstat);
+                ABORT_FINALIZE(RS_RET_OUT_OF_MEMORY);
+            }
         }
         pstat->bReported = 0;
         pthread_rwlock_init(&pstat->stats_lock, NULL);
@@ -337,6 +366,11 @@ static rsRetVal perctile_observe(perctile_bucket_t *bkt, uchar *key, int64_t val
         STATSCOUNTER_INC(bkt->ctrNewKeyAdd, bkt->mutCtrNewKeyAdd);
     }
 
+    if (pstat->sketch) {
+        CHKiRet(perctile_sketch_add(pstat->sketch, value));
+        FINALIZE;
+    }
+
     // add this value into the ringbuffer
     assert(pstat->rb_observed_stats);
     if (ringbuf_append_with_overwrite(pstat->rb_observed_stats, value) != 0) {
@@ -386,18 +420,49 @@ static int cmp(const void *p1, const void *p2) {
     return (*(ITEM *)p1) - (*(ITEM *)p2);
 }
 
+/* Merge and reset the sketch of one stat. As with the ring buffer, the
+ * previous values are kept if nothing was observed since the last report.
+ */
+static void report_perctile_sketch(perctile_stat_t *perc_stat, uint64_t *merged) {
+    perctile_sketch_window_t win;
+
+    perctile_sketch_collect(perc_stat->sketch, merged, &win);
+    if (!win.count) {
+        return;
+    }
+    perc_stat->ctrWindowCount = win.count;
+    perc_stat->ctrWindowSum = win.sum;
+    perc_stat->ctrWindowMin = win.min;
+    perc_stat->ctrWindowMax = win.max;
+    for (size_t i = 0; i < perc_stat->perctile_ctrs_count; ++i) {
+        perctile_ctr_t *pctr = &perc_stat->ctrs[i];
+        pctr->ctr_perctile_stat = perctile_sketch_quantile(perc_stat->sketch, merged, &win, pctr->percentile);
+    }
+}
+
 static rsRetVal report_perctile_stats(perctile_bucket_t *pbkt) {
     ITEM *buf = NULL;
+    uint64_t *merged = NULL;
     struct hashtable_itr *itr = NULL;
     DEFiRet;
 
     pthread_rwlock_rdlock(&pbkt->lock);
     if (hashtable_count(pbkt->htable)) {
         itr = hashtable_iterator(pbkt->htable);
-        CHKmalloc(buf = malloc(pbkt->window_size * sizeof(ITEM)));
+        if (pbkt->backend == PERCTILE_BACKEND_SKETCH) {
+            /* all sketches of a bucket share their parameters */
+            const perctile_stat_t *first = hashtable_iterator_value(itr);
+            CHKmalloc(merged = malloc(perctile_sketch_buckets(first->sketch) * sizeof(uint64_t)));
+        } else {
+            CHKmalloc(buf = malloc(pbkt->window_size * sizeof(ITEM)));
+        }
         do {
-            memset(buf, 0, pbkt->window_size * sizeof(ITEM));
             perctile_stat_t *perc_stat = hashtable_iterator_value(itr);
+            if (perc_stat->sketch) {
+                report_perctile_sketch(perc_stat, merged);
+                continue;
+            }
+            memset(buf, 0, pbkt->window_size * sizeof(ITEM));
             // ringbuffer read
             size_t count = ringbuf_read_to_end(perc_stat->rb_observed_stats, buf, pbkt->window_size);
             if (!count) {
@@ -445,6 +510,7 @@ finalize_it:
     pthread_rwlock_unlock(&pbkt->lock);
     free(itr);
     free(buf);
+    free(merged);
     RETiRet;
 }
 
@@ -509,8 +575,14 @@ finalize_it:
 
 /* Create new perctile bucket, and add it to our list of perctile buckets.
  */
-static rsRetVal perctile_newBucket(
-    const uchar *name, const uchar *delim, uint8_t *perctiles, uint32_t perctilesCount, uint32_t windowSize) {
+static rsRetVal perctile_newBucket(const uchar *name,
+                                   const uchar *delim,
+                                   uint8_t *perctiles,
+                                   uint32_t perctilesCount,
+                                   uint32_t windowSize,
+                                   perctile_backend_t backend,
+                                   double sketchAccuracy,
+                                   uint32_t sketchMaxBuckets) {
     perctile_buckets_t *bkts;
     perctile_bucket_t *b = NULL;
     pthread_rwlockattr_t bucket_lock_attr;
@@ -537,11 +609,14 @@ static rsRetVal perctile_newBucket(
         b->perctile_values_count = perctilesCount;
         memcpy(b->perctile_values, perctiles, perctilesCount * sizeof(uint8_t));
         b->window_size = windowSize;
+        b->backend = backend;
+        b->sketch_accuracy = sketchAccuracy;
+        b->sketch_max_buckets = sketchMaxBuckets;
         b->next = NULL;
         PERCTILE_STATS_LOG(
             "perctile_newBucket: create new bucket for %s,"
-            "with windowsize: %d,  values_count: %zu\n",
-            b->name, b->window_size, b->perctile_values_count);
+            "with windowsize: %d,  values_count: %zu, backend: %d\n",
+            b->name, b->window_size, b->perctile_values_count, b->backend);
 
         // create the statsobj for this bucket
         CHKiRet(perctileInitNewBucketStats(b));
@@ -582,6 +657,9 @@ rsRetVal perctile_processCnf(struct cnfobj *o) {
     uint8_t *perctiles = NULL;
     uint32_t perctilesCount = 0;
     uint64_t windowSize = 0;
+    perctile_backend_t backend = PERCTILE_BACKEND_RINGBUF;
+    double sketchAccuracy = PERCTILE_SKETCH_DFLT_ACCURACY;
+    uint64_t sketchMaxBuckets = PERCTILE_SKETCH_DFLT_MAX_BUCKETS;
     DEFiRet;
 
     pvals = nvlstGetParams(o->nvlst, &modpblk, NULL);
@@ -622,6 +700,43 @@ rsRetVal perctile_processCnf(struct cnfobj *o) {
             }
         } else if (!strcmp(modpblk.descr[i].name, PERCTILE_CONF_PARAM_WINDOW_SIZE)) {
             windowSize = pvals[i].val.d.n;
+        } else if (!strcmp(modpblk.descr[i].name, PERCTILE_CONF_PARAM_BACKEND)) {
+            if (!es_strbufcmp(pvals[i].val.d.estr, (uchar *)"ringbuffer", sizeof("ringbuffer") - 1)) {
+                backend = PERCTILE_BACKEND_RINGBUF;
+            } else if (!es_strbufcmp(pvals[i].val.d.estr, (uchar *)"sketch", sizeof("sketch") - 1)) {
+                backend = PERCTILE_BACKEND_SKETCH;
+            } else {
+                char *cstr = es_str2cstr(pvals[i].val.d.estr, NULL);
+                LogError(0, RS_RET_PARAM_ERROR,
+                         "perctile: backend '%s' is invalid - must be "
+                         "'ringbuffer' or 'sketch'",
+                         cstr != NULL ? cstr : "");
+                free(cstr);
+                ABORT_FINALIZE(RS_RET_PARAM_ERROR);
+            }
+        } else if (!strcmp(modpblk.descr[i].name, PERCTILE_CONF_PARAM_SKETCH_ACCURACY)) {
+            char *cstr = es_str2cstr(pvals[i].val.d.estr, NULL);
+            CHKmalloc(cstr);
+            char *endptr = NULL;
+            errno = 0;
+            sketchAccuracy = strtod(cstr, &endptr);
+            if (errno == ERANGE || endptr == cstr || *endptr != '\0' ||
+                !(sketchAccuracy >= PERCTILE_SKETCH_MIN_ACCURACY && sketchAccuracy <= PERCTILE_SKETCH_MAX_ACCURACY)) {
+                LogError(0, RS_RET_PARAM_ERROR,
+                         "perctile: sketch.accuracy '%s' is invalid - must be a number between %g and %g", cstr,
+                         PERCTILE_SKETCH_MIN_ACCURACY, PERCTILE_SKETCH_MAX_ACCURACY);
+                free(cstr);
+                ABORT_FINALIZE(RS_RET_PARAM_ERROR);
+            }
+            free(cstr);
+        } else if (!strcmp(modpblk.descr[i].name, PERCTILE_CONF_PARAM_SKETCH_MAX_BUCKETS)) {
+            sketchMaxBuckets = pvals[i].val.d.n;
+            if (sketchMaxBuckets < PERCTILE_SKETCH_MIN_BUCKETS || sketchMaxBuckets > PERCTILE_SKETCH_MAX_BUCKETS) {
+                LogError(0, RS_RET_PARAM_ERROR,
+                         "perctile: sketch.maxbuckets %" PRIu64 " is invalid - must be between %d and %d",
+                         sketchMaxBuckets, PERCTILE_SKETCH_MIN_BUCKETS, PERCTILE_SKETCH_MAX_BUCKETS);
+                ABORT_FINALIZE(RS_RET_PARAM_ERROR);
+            }
         } else {
             dbgprintf(
                 "perctile: program error, non-handled "
@@ -631,7 +746,8 @@ rsRetVal perctile_processCnf(struct cnfobj *o) {
     }
 
     if (name != NULL && perctiles != NULL) {
-        CHKiRet(perctile_newBucket(name, delim, perctiles, perctilesCount, windowSize));
+        CHKiRet(perctile_newBucket(name, delim, perctiles, perctilesCount, windowSize, backend, sketchAccuracy,
+                                   (uint32_t)sketchMaxBuckets));
     }
 
 finalize_it:
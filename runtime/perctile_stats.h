@@ -22,6 +22,11 @@
 #include "hashtable.h"
 #include "statsobj.h"
 
+typedef enum perctile_backend_e {
+    PERCTILE_BACKEND_RINGBUF = 0, /* exact percentiles over a sliding window of observations */
+    PERCTILE_BACKEND_SKETCH = 1 /* approximate percentiles over the reporting interval, lock-free recording */
+} perctile_backend_t;
+
 struct perctile_ctr_s {
     // percentile [0,100]
     uint8_t percentile;
@@ -33,7 +38,8 @@ struct perctile_ctr_s {
 struct perctile_stat_s {
     uchar name[128];
     sbool bReported;
-    struct ringbuf_s *rb_observed_stats;
+    struct ringbuf_s *rb_observed_stats; /* ringbuffer backend */
+    struct perctile_sketch_s *sketch; /* sketch backend */
     // array of requested perctile to track
     struct perctile_ctr_s *ctrs;
     size_t perctile_ctrs_count;
@@ -63,6 +69,9 @@ struct perctile_bucket_s {
     STATSCOUNTER_DEF(ctrOpsOverflow, mutCtrOpsOverflow);
     ctr_t *pOpsOverflowCtr;
     uint32_t window_size;
+    perctile_backend_t backend;
+    double sketch_accuracy;
+    uint32_t sketch_max_buckets;
     // These percentile values apply to all perctile stats in this bucket.
     uint8_t *perctile_values;
     size_t perctile_values_count;
@@ -96,6 +96,9 @@
  * - `FixedArray`: A legacy option that pre-allocates a static array of
  * pointers. It can be slightly faster under constant load but is
  * less memory-efficient. It remains the default for ruleset queues.
+ * - `RingBuffer`: Pre-allocates like `FixedArray`, but uses a lock-free
+ * ring so that producers do not take the queue mutex while the queue is
+ * below its watermarks. Intended for queues fed by many input threads.
  * - **Use Case:** High-performance buffering where a potential loss of
  * in-flight messages on crash is acceptable.
  *
@@ -193,6 +196,7 @@
 #include <assert.h>
 #include <signal.h>
 #include <pthread.h>
+#include <sched.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/stat.h> /* required for HP UX */
@@ -202,6 +206,7 @@
 #include <limits.h>
 #include <dirent.h>
 #include <sys/types.h>
+#include <sys/socket.h>
 
 #include "rsyslog.h"
 #include "queue.h"
@@ -211,6 +216,7 @@
 #include "wtp.h"
 #include "wti.h"
 #include "msg.h"
+#include "prop.h"
 #include "obj.h"
 #include "atomic.h"
 #include "errmsg.h"
@@ -219,14 +225,14 @@
 #include "statsobj.h"
 #include "parserif.h"
 #include "rsconf.h"
-
-#ifdef OS_SOLARIS
-    #include <sched.h>
-#endif
+#include "zstdw.h"
 
 /* static data */
 DEFobjStaticHelpers;
 DEFobjCurrIf(glbl) DEFobjCurrIf(strm) DEFobjCurrIf(datetime) DEFobjCurrIf(statsobj)
+#ifdef ENABLE_LIBZSTD
+    DEFobjCurrIf(zstdw)
+#endif
 
 #if __GNUC__ >= 8
     #pragma GCC diagnostic ignored "-Wcast-function-type"  // TODO: investigate further!
@@ -237,6 +243,7 @@ DEFobjCurrIf(glbl) DEFobjCurrIf(strm) DEFobjCurrIf(datetime) DEFobjCurrIf(statso
 #endif
 
 #define OVERSIZE_QUEUE_WATERMARK 500000 /* when is a queue considered to be "overly large"? */
+#define RINGBUF_DEQ_SPINS 64 /* ring buffer dequeue passes before giving up on an in-flight element */
 #define MAX_DISK_QUEUE_FILES 10000000 /* maximum file number for disk queues */
 #define DISKQUEUE_CORRUPTION_RESYNC_MAX_BYTES (1024 * 1024)
 
@@ -251,6 +258,9 @@ static rsRetVal ConsumerDA(qqueue_t *pThis, wti_t *pWti);
 static rsRetVal batchProcessed(qqueue_t *pThis, wti_t *pWti);
 static rsRetVal qqueueMultiEnqObjNonDirect(qqueue_t *pThis, multi_submit_t *pMultiSub);
 static rsRetVal qqueueMultiEnqObjDirect(qqueue_t *pThis, multi_submit_t *pMultiSub);
+#ifdef HAVE_ATOMIC_BUILTINS
+static rsRetVal qqueueMultiEnqObjRingBuffer(qqueue_t *pThis, multi_submit_t *pMultiSub);
+#endif
 static rsRetVal qAddDirect(qqueue_t *pThis, smsg_t *pMsg);
 static rsRetVal qDestructDirect(qqueue_t __attribute__((unused)) * pThis);
 static rsRetVal qConstructDirect(qqueue_t __attribute__((unused)) * pThis);
@@ -309,6 +319,11 @@ static struct cnfparamdescr cnfpdescr[] = {{"queue.filename", eCmdHdlrGetWord, 0
                                            {"queue.cry.provider", eCmdHdlrGetWord, 0},
                                            {"queue.samplinginterval", eCmdHdlrInt, 0},
                                            {"queue.takeflowctlfrommsg", eCmdHdlrBinary, 0},
+                                           {"queue.shards", eCmdHdlrPositiveInt, 0},
+                                           {"queue.shardkey", eCmdHdlrGetWord, 0},
+                                           {"queue.compression", eCmdHdlrGetWord, 0},
+                                           {"queue.compressionblocksize", eCmdHdlrSize, 0},
+                                           {"queue.compressionlevel", eCmdHdlrInt, 0},
                                            {"queue.oncorruption", eCmdHdlrGetWord, 0}};
 static struct cnfparamblk pblk = {CNFPARAMBLK_VERSION, sizeof(cnfpdescr) / sizeof(struct cnfparamdescr), cnfpdescr};
 
@@ -465,6 +480,9 @@ static const char *getQueueTypeName(queueType_t t) {
         case QUEUETYPE_SEGMENTED_DISK:
             r = "segmentedDisk";
             break;
+        case QUEUETYPE_RINGBUFFER:
+            r = "RingBuffer";
+            break;
         default:
             r = "invalid/unknown queue mode";
             break;
@@ -492,6 +510,11 @@ void qqueueDbgPrint(qqueue_t *pThis) {
     dbgoprint((obj_t *)pThis, "queue.syncqueuefiles: %d\n", pThis->bSyncQueueFiles);
     dbgoprint((obj_t *)pThis, "queue.type: %d [%s]\n", pThis->qType, getQueueTypeName(pThis->qType));
     dbgoprint((obj_t *)pThis, "queue.workerthreads: %d\n", pThis->iNumWorkerThreads);
+    dbgoprint((obj_t *)pThis, "queue.shards: %d\n", pThis->iShards);
+    dbgoprint((obj_t *)pThis, "queue.shardkey: %s\n", pThis->shardKey == QUEUE_SHARDKEY_SOURCE ? "source" : "thread");
+    dbgoprint((obj_t *)pThis, "queue.compression: %s\n", pThis->segdiskCompress ? "zstd" : "none");
+    dbgoprint((obj_t *)pThis, "queue.compressionblocksize: %lld\n", pThis->segdiskCompressBlockSize);
+    dbgoprint((obj_t *)pThis, "queue.compressionlevel: %d\n", pThis->segdiskCompressLevel);
     dbgoprint((obj_t *)pThis, "queue.timeoutshutdown: %d\n", pThis->toQShutdown);
     dbgoprint((obj_t *)pThis, "queue.timeoutactioncompletion: %d\n", pThis->toActShutdown);
     dbgoprint((obj_t *)pThis, "queue.timeoutenqueue: %d\n", pThis->toEnq);
@@ -568,6 +591,8 @@ static void qqueueUpdateSegDiskStats(qqueue_t *pThis) {
     pThis->segdiskMaterializations = segdiskStatsInt(stats.materializations);
     pThis->segdiskDematerializations = segdiskStatsInt(stats.dematerializations);
     pThis->segdiskIdleCleanupFailures = segdiskStatsInt(stats.idle_cleanup_failures);
+    pThis->segdiskGroupWrites = segdiskStatsInt(stats.group_writes);
+    pThis->segdiskGroupRecords = segdiskStatsInt(stats.group_records);
 }
 
 static rsRetVal qqueueSegDiskIdleTimeout(qqueue_t *pThis) {
@@ -585,8 +610,9 @@ static rsRetVal qqueueSegDiskIdleTimeout(qqueue_t *pThis) {
     if (pThis->pqParent == NULL || getPhysicalQueueSize(pThis->pqParent) != 0) {
         return RS_RET_RETRY;
     }
-    if (pThis->segdiskIdleObservedActivity != pThis->pqParent->daActivityGeneration) {
-        pThis->segdiskIdleObservedActivity = pThis->pqParent->daActivityGeneration;
+    const uint64_t activity = PREFER_LOAD_uint64(&pThis->pqParent->daActivityGeneration);
+    if (pThis->segdiskIdleObservedActivity != activity) {
+        pThis->segdiskIdleObservedActivity = activity;
         return RS_RET_RETRY;
     }
     const rsRetVal r = segdiskStoreDematerialize(pThis->tVars.segdisk);
@@ -659,6 +685,7 @@ static void queueDrain(qqueue_t *pThis) {
               pThis->iQueueSize);
     /* iQueueSize is not decremented by qDel(), so we need to do it ourselves */
     while (ATOMIC_DEC_AND_FETCH(&pThis->iQueueSize, &pThis->mutQueueSize) > 0) {
+        pMsg = NULL;
         pThis->qDeq(pThis, &pMsg);
         if (pMsg != NULL) {
             msgDestruct(&pMsg);
@@ -798,10 +825,14 @@ static rsRetVal StartDA(qqueue_t *pThis) {
      */
     pThis->pqDA->pqParent = pThis;
     pThis->pqDA->segdiskDAChild = child_type == QUEUETYPE_SEGMENTED_DISK;
+    if (pThis->pqDA->segdiskDAChild) PREFER_STORE_1_TO_INT(&pThis->bDAActivityNotify);
     pThis->pqDA->segdiskLazyCreate = pThis->pqDA->segdiskDAChild && !engine_result.segmented_data;
     pThis->pqDA->daEngineMarkerPending =
         !engine_result.marker_present && !engine_result.classic_data && !engine_result.segmented_data;
     pThis->pqDA->diskQueueIdleTimeout = pThis->diskQueueIdleTimeout;
+    pThis->pqDA->segdiskCompress = pThis->segdiskCompress;
+    pThis->pqDA->segdiskCompressLevel = pThis->segdiskCompressLevel;
+    pThis->pqDA->segdiskCompressBlockSize = pThis->segdiskCompressBlockSize;
 
     CHKiRet(qqueueSetpAction(pThis->pqDA, pThis->pAction));
     CHKiRet(qqueueSetsizeOnDiskMax(pThis->pqDA, pThis->sizeOnDiskMax));
@@ -1089,6 +1120,341 @@ static rsRetVal qDelLinkedList(qqueue_t *pThis) {
 }
 
 
+/* -------------------- ring buffer -------------------- */
+/* The ring buffer stores the same message pointers FixedArray does, but in
+ * bounded lock-free MPMC rings. When called via the regular enqueue path, it is
+ * just storage used under the queue mutex. In addition, producers can use
+ * qqueueEnqRingBufferFast() to enqueue without the queue mutex as long as the
+ * queue is below every mark that may require flow control, discarding or DA
+ * activation; everything above those marks takes the regular path.
+ * Dequeue still happens under the queue mutex, because the batch and
+ * to-delete bookkeeping depends on it. The ring slot is released on dequeue,
+ * so there is nothing to do on delete.
+ *
+ * With queue.shards > 1 the storage is split into several rings. Producers
+ * pick a shard by thread or by sender (see qqueueRingShard()), so concurrent
+ * producers no longer contend on the same ring cursor. A worker starts each
+ * batch at its home shard (worker index modulo shard count) and, once that is
+ * empty, steals from the other shards. With the source shard key a shard is
+ * owned by the worker that took elements from it until that worker asks for
+ * its next batch, so messages from one sender are never processed by two
+ * workers at the same time. All accounting (iQueueSize, marks) stays global.
+ */
+#ifdef HAVE_ATOMIC_BUILTINS
+/* producers are numbered on their first shard lookup; the number is kept in
+ * thread-specific storage and used round-robin by all sharded queues.
+ */
+static pthread_key_t keyProducerIdx;
+static unsigned nextProducerIdx = 0;
+
+static int qqueueRingShard(qqueue_t *const pThis, smsg_t *const pMsg) {
+    const int nRings = pThis->tVars.ringbuf.nRings;
+    uintptr_t idx;
+
+    if (nRings == 1) return 0;
+
+    if (pThis->shardKey == QUEUE_SHARDKEY_SOURCE) {
+        /* FNV-1a over the sender address; the port keeps TCP sessions of one
+         * host apart. Messages without sender info all map to one shard.
+         */
+        uint32_t h = 2166136261u;
+        const uchar *p;
+        int len;
+        if (pMsg->msgFlags & NEEDS_DNSRESOL) {
+            p = (const uchar *)pMsg->rcvFrom.pfrominet;
+            len = (p == NULL) ? 0 : (int)sizeof(struct sockaddr_storage);
+            for (int i = 0; i < len; ++i) h = (h ^ p[i]) * 16777619u;
+        } else {
+            if (pMsg->pRcvFromIP != NULL) {
+                p = propGetSzStr(pMsg->pRcvFromIP);
+                for (int i = 0; i < pMsg->pRcvFromIP->len; ++i) h = (h ^ p[i]) * 16777619u;
+            }
+            if (pMsg->pRcvFromPort != NULL) {
+                p = propGetSzStr(pMsg->pRcvFromPort);
+                for (int i = 0; i < pMsg->pRcvFromPort->len; ++i) h = (h ^ p[i]) * 16777619u;
+            }
+        }
+        return (int)(h % (uint32_t)nRings);
+    }
+
+    idx = (uintptr_t)pthread_getspecific(keyProducerIdx);
+    if (idx == 0) {
+        idx = ATOMIC_INC_AND_FETCH_unsigned(&nextProducerIdx, &NULL);
+        pthread_setspecific(keyProducerIdx, (void *)idx);
+    }
+    return (int)((idx - 1) % (uintptr_t)nRings);
+}
+
+
+static rsRetVal qConstructRingBuffer(qqueue_t *pThis) {
+    DEFiRet;
+
+    assert(pThis != NULL);
+
+    if (pThis->iMaxQueueSize == 0) ABORT_FINALIZE(RS_RET_QSIZE_ZERO);
+
+    const int nRings = (pThis->iShards > 1) ? pThis->iShards : 1;
+    CHKmalloc(pThis->tVars.ringbuf.rings = calloc(nRings, sizeof(mpmcring_t)));
+    /* iQueueSize never exceeds iMaxQueueSize and slots are reserved via
+     * iQueueSize before they are published, so this capacity is sufficient
+     * even if all messages end up in a single shard.
+     */
+    for (int i = 0; i < nRings; ++i) {
+        if (mpmcRingInit(&pThis->tVars.ringbuf.rings[i], (size_t)pThis->iMaxQueueSize) != 0) {
+            ABORT_FINALIZE(RS_RET_OUT_OF_MEMORY);
+        }
+        pThis->tVars.ringbuf.nRings = i + 1; /* number of rings to destroy */
+    }
+    if (nRings > 1 && pThis->shardKey == QUEUE_SHARDKEY_SOURCE) {
+        CHKmalloc(pThis->tVars.ringbuf.owner = calloc(nRings, sizeof(wti_t *)));
+    }
+    pThis->tVars.ringbuf.bFastEnq = 0; /* enabled by qqueueStart() once marks are final */
+
+    qqueueChkIsDA(pThis);
+
+finalize_it:
+    RETiRet;
+}
+
+
+static rsRetVal qDestructRingBuffer(qqueue_t *pThis) {
+    void *pMsg;
+    DEFiRet;
+
+    assert(pThis != NULL);
+
+    /* discard any remaining queue entries; all workers are gone by now */
+    for (int i = 0; i < pThis->tVars.ringbuf.nRings; ++i) {
+        while (mpmcRingPop(&pThis->tVars.ringbuf.rings[i], &pMsg)) {
+            msgDestruct((smsg_t **)&pMsg);
+        }
+        mpmcRingDestroy(&pThis->tVars.ringbuf.rings[i]);
+    }
+    free(pThis->tVars.ringbuf.rings);
+    free(pThis->tVars.ringbuf.owner);
+
+    RETiRet;
+}
+
+
+static rsRetVal qAddRingBuffer(qqueue_t *pThis, smsg_t *in) {
+    DEFiRet;
+
+    assert(pThis != NULL);
+    if (!mpmcRingPush(&pThis->tVars.ringbuf.rings[qqueueRingShard(pThis, in)], in)) {
+        /* cannot happen as long as the iQueueSize invariant holds */
+        DBGOPRINT((obj_t *)pThis, "ring buffer unexpectedly full, discarding message\n");
+        STATSCOUNTER_INC(pThis->ctrFDscrd, pThis->mutCtrFDscrd);
+        msgDestruct(&in);
+        ABORT_FINALIZE(RS_RET_QUEUE_FULL);
+    }
+
+finalize_it:
+    RETiRet;
+}
+
+
+/* release the shards pWti owns because its previous batch is done
+ * @returns number of shards released
+ */
+static int qqueueRingReleaseShards(qqueue_t *const pThis, wti_t *const pWti) {
+    int nReleased = 0;
+    if (pThis->tVars.ringbuf.owner != NULL) {
+        for (int i = 0; i < pThis->tVars.ringbuf.nRings; ++i) {
+            if (pThis->tVars.ringbuf.owner[i] == pWti) {
+                pThis->tVars.ringbuf.owner[i] = NULL;
+                ++nReleased;
+            }
+        }
+    }
+    return nReleased;
+}
+
+
+/* Workers that found only shards owned by pWti are idle on pcondBusy. If
+ * pWti released shards while elements are left, wake them, else those
+ * elements wait for the next enqueue or the idle timeout.
+ */
+static void qqueueRingWakeAfterRelease(qqueue_t *const pThis, wti_t *const pWti, const int nReleased) {
+    if (nReleased > 0 && getLogicalQueueSize(pThis) > 0) wtpWakeupAllWrkr(pWti->pWtp);
+}
+
+
+/* called under the queue mutex when pWti starts a new dequeue
+ * @returns number of shards released, see qqueueRingReleaseShards()
+ */
+static int qqueueRingBeginDeq(qqueue_t *const pThis, wti_t *const pWti) {
+    const int nReleased = qqueueRingReleaseShards(pThis, pWti);
+    pThis->tVars.ringbuf.deqWti = pWti;
+    pThis->tVars.ringbuf.deqRing = pWti->workerIndex % pThis->tVars.ringbuf.nRings;
+    pThis->tVars.ringbuf.bDeqInFlight = 0;
+    return nReleased;
+}
+
+
+/* Returns RS_RET_NO_MORE_DATA if every remaining element sits in a shard owned
+ * by another worker. The caller then idles until that worker releases the
+ * shard, which wakes the pool (see qqueueRingWakeAfterRelease()).
+ * It is also returned, with bDeqInFlight set, if the element is still being
+ * published after RINGBUF_DEQ_SPINS passes; DequeueForConsumer() then lets the
+ * producer run without holding the queue mutex.
+ */
+static rsRetVal qDeqRingBuffer(qqueue_t *pThis, smsg_t **out) {
+    wti_t *const pWti = pThis->tVars.ringbuf.deqWti;
+    wti_t **const owner = pThis->tVars.ringbuf.owner;
+    const int nRings = pThis->tVars.ringbuf.nRings;
+    void *pMsg;
+    int bOwnedElsewhere;
+    DEFiRet;
+
+    assert(pThis != NULL);
+    /* A lock-free producer reserves its slot in iQueueSize before it
+     * publishes the element, so the element the caller counted may still be
+     * in flight. It is guaranteed to arrive, and very quickly so, unless the
+     * producer was preempted. We hold the queue mutex, so do not wait long.
+     */
+    for (int nSpins = 0;; ++nSpins) {
+        bOwnedElsewhere = 0;
+        for (int k = 0; k < nRings; ++k) {
+            const int i = (pThis->tVars.ringbuf.deqRing + k) % nRings;
+            if (owner != NULL && owner[i] != NULL && owner[i] != pWti) {
+                bOwnedElsewhere = 1;
+                continue;
+            }
+            if (mpmcRingPop(&pThis->tVars.ringbuf.rings[i], &pMsg)) {
+                pThis->tVars.ringbuf.deqRing = i; /* stay on this shard for the rest of the batch */
+                if (owner != NULL) owner[i] = pWti;
+                *out = (smsg_t *)pMsg;
+                FINALIZE;
+            }
+        }
+        if (bOwnedElsewhere) ABORT_FINALIZE(RS_RET_NO_MORE_DATA);
+        if (nSpins == RINGBUF_DEQ_SPINS) {
+            pThis->tVars.ringbuf.bDeqInFlight = 1;
+            ABORT_FINALIZE(RS_RET_NO_MORE_DATA);
+        }
+    }
+
+finalize_it:
+    RETiRet;
+}
+
+
+static rsRetVal qDelRingBuffer(qqueue_t __attribute__((unused)) * pThis) {
+    return RS_RET_OK;
+}
+
+
+/* compute the queue sizes below which producers may enqueue without the
+ * queue mutex. Each limit is the lowest mark at which doEnqSingleObj() or
+ * qqueueAdviseMaxWorkers() would act differently for that flow control type.
+ * Must be called after all marks are final (including the DA adjustment of
+ * the full delay mark).
+ */
+static void qqueueSetRingBufferMrks(qqueue_t *pThis) {
+    int base = pThis->iMaxQueueSize;
+
+    if (pThis->iDiscardMrk > 0 && pThis->iDiscardMrk < base) base = pThis->iDiscardMrk;
+    if (pThis->bIsDA && pThis->iHighWtrMrk < base) base = pThis->iHighWtrMrk;
+    pThis->tVars.ringbuf.fastEnqMrk[eFLOWCTL_NO_DELAY] = base;
+    pThis->tVars.ringbuf.fastEnqMrk[eFLOWCTL_LIGHT_DELAY] =
+        (pThis->iLightDlyMrk < base) ? pThis->iLightDlyMrk : base;
+    pThis->tVars.ringbuf.fastEnqMrk[eFLOWCTL_FULL_DELAY] = (pThis->iFullDlyMrk < base) ? pThis->iFullDlyMrk : base;
+    /* sampling needs the mutex-protected counter in qqueueAdd() */
+    pThis->tVars.ringbuf.bFastEnq = (pThis->iSmpInterval == 0);
+    DBGOPRINT((obj_t *)pThis, "ring buffer lock-free enqueue %s, marks %d/%d/%d\n",
+              pThis->tVars.ringbuf.bFastEnq ? "enabled" : "disabled",
+              pThis->tVars.ringbuf.fastEnqMrk[eFLOWCTL_NO_DELAY], pThis->tVars.ringbuf.fastEnqMrk[eFLOWCTL_LIGHT_DELAY],
+              pThis->tVars.ringbuf.fastEnqMrk[eFLOWCTL_FULL_DELAY]);
+}
+
+
+/* Record producer activity for the segmented DA child's idle grace period
+ * and wake its workers. Must be called with the queue mutex locked; the DA
+ * child shares it and its idle callback reads the generation under it.
+ */
+static void qqueueNoteDAActivity(qqueue_t *const pThis) {
+    if (pThis->bIsDA && pThis->pqDA != NULL && pThis->pqDA->segdiskDAChild) {
+        ATOMIC_INC_uint64(&pThis->daActivityGeneration, &pThis->mutDaActivityGeneration);
+        if (pThis->pqDA->pWtpReg != NULL) wtpWakeupAllWrkr(pThis->pqDA->pWtpReg);
+    }
+}
+
+
+/* try to enqueue a message without acquiring the queue mutex.
+ * Returns 1 if the message was enqueued, 0 if the caller must use the regular
+ * (mutex-protected) path. The queue slot is reserved with a CAS on iQueueSize
+ * that only succeeds below the message's fast enqueue mark, so none of the
+ * flow control, discard or DA conditions can trigger for this message.
+ * Workers wait for work under the queue mutex, so we must take it whenever
+ * a worker may need to be woken or started: on the empty -> non-empty
+ * transition and whenever the logical size crosses a workerThreadMinimumMessages
+ * boundary. A queue with a segmented DA child also takes it for every message
+ * to note the activity for the child, as qqueueAdd() does. The logical size
+ * computed here can only be overestimated when a worker deletes a batch
+ * concurrently, and that worker re-checks the queue size under the mutex
+ * afterwards.
+ */
+static int qqueueEnqRingBufferFast(qqueue_t *const pThis, flowControl_t flowCtlType, smsg_t *const pMsg) {
+    int size;
+    int logicalSize;
+
+    if (!pThis->tVars.ringbuf.bFastEnq) return 0;
+    if (unlikely(pThis->takeFlowCtlFromMsg)) {
+        flowCtlType = pMsg->flowCtlType;
+    }
+    const int mrk = pThis->tVars.ringbuf.fastEnqMrk[flowCtlType];
+
+    do {
+        size = ATOMIC_LOAD_32BIT(&pThis->iQueueSize, &pThis->mutQueueSize);
+        if (size + 1 >= mrk) return 0;
+    } while (!ATOMIC_CAS(&pThis->iQueueSize, size, size + 1, &pThis->mutQueueSize));
+
+    STATSCOUNTER_SHARDED_INC(pThis->ctrEnqueued, pThis->mutCtrEnqueued);
+    STATSCOUNTER_SHARDED_ADD(pThis->ctrSizeEnqueued, pThis->mutCtrSizeEnqueued, (uint64_t)pMsg->iLenRawMsg);
+    if (!mpmcRingPush(&pThis->tVars.ringbuf.rings[qqueueRingShard(pThis, pMsg)], pMsg)) {
+        /* cannot happen as long as the iQueueSize invariant holds */
+        ATOMIC_DEC(&pThis->iQueueSize, &pThis->mutQueueSize);
+        return 0;
+    }
+    #ifdef ENABLE_IMDIAG
+    ATOMIC_INC(&iOverallQueueSize, &NULL);
+    #endif
+    STATSCOUNTER_SETMAX_NOMUT(pThis->ctrMaxqsize, size + 1);
+
+    logicalSize = size + 1 - ATOMIC_LOAD_32BIT(&pThis->nLogDeq, &pThis->mutLogDeq);
+    const int bAdvise =
+        logicalSize <= 1 || (pThis->iMinMsgsPerWrkr > 0 && logicalSize % pThis->iMinMsgsPerWrkr == 0);
+    const int bNoteDA = pThis->bIsDA && PREFER_FETCH_32BIT(pThis->bDAActivityNotify);
+    if (bAdvise || bNoteDA) {
+        d_pthread_mutex_lock(pThis->mut);
+        if (bNoteDA) qqueueNoteDAActivity(pThis);
+        if (bAdvise) qqueueAdviseMaxWorkers(pThis);
+        d_pthread_mutex_unlock(pThis->mut);
+    }
+
+    return 1;
+}
+#else
+static int qqueueEnqRingBufferFast(qqueue_t __attribute__((unused)) * const pThis,
+                                   flowControl_t __attribute__((unused)) flowCtlType,
+                                   smsg_t __attribute__((unused)) * const pMsg) {
+    return 0;
+}
+static int qqueueRingReleaseShards(qqueue_t __attribute__((unused)) * const pThis,
+                                   wti_t __attribute__((unused)) * const pWti) {
+    return 0;
+}
+static void qqueueRingWakeAfterRelease(qqueue_t __attribute__((unused)) * const pThis,
+                                       wti_t __attribute__((unused)) * const pWti,
+                                       const int __attribute__((unused)) nReleased) {}
+static int qqueueRingBeginDeq(qqueue_t __attribute__((unused)) * const pThis,
+                              wti_t __attribute__((unused)) * const pWti) {
+    return 0;
+}
+#endif /* #ifdef HAVE_ATOMIC_BUILTINS */
+
+
 /* -------------------- disk  -------------------- */
 
 
@@ -1203,6 +1569,24 @@ static rsRetVal qConstructSegDisk(qqueue_t *pThis) {
     int recovered = 0;
     DEFiRet;
 
+#ifdef ENABLE_LIBZSTD
+    /* The decoder is wired up even without queue.compression so that blocks
+     * written under an earlier configuration can still be replayed. */
+    const rsRetVal zstdRet = objUse(zstdw, LM_ZSTDW_FILENAME);
+    if (zstdRet == RS_RET_OK) {
+        cfg.decompress = zstdw.decompressBlock;
+        if (pThis->segdiskCompress) {
+            cfg.compress = zstdw.compressBlock;
+            cfg.compress_level = pThis->segdiskCompressLevel;
+            cfg.compress_block_size = (size_t)pThis->segdiskCompressBlockSize;
+        }
+    } else if (pThis->segdiskCompress) {
+        LogError(0, zstdRet,
+                 "%s: queue.compression=\"zstd\" was requested, but the zstdw module is unavailable - "
+                 "using without compression",
+                 obj.GetName((obj_t *)pThis));
+    }
+#endif
     CHKiRet(segdiskStoreOpen(&pThis->tVars.segdisk, &cfg, &recovered));
     pThis->iQueueSize = recovered;
     qqueueAddOverallQueueSize(recovered);
@@ -1240,7 +1624,8 @@ static rsRetVal qAddSegDisk(qqueue_t *pThis, smsg_t *pMsg) {
         pThis->daEngineMarkerPending = 0;
     }
     CHKiRet(segdiskStoreAppend(pThis->tVars.segdisk, pMsg, 0, NULL));
-    if (pThis->segdiskDAChild) ++pThis->pqParent->daActivityGeneration;
+    if (pThis->segdiskDAChild)
+        ATOMIC_INC_uint64(&pThis->pqParent->daActivityGeneration, &pThis->pqParent->mutDaActivityGeneration);
     qqueueUpdateSegDiskStats(pThis);
 finalize_it:
     /* The store serializes synchronously and never retains the message. The
@@ -1249,6 +1634,43 @@ finalize_it:
     RETiRet;
 }
 
+/* A multi-message enqueue into a segmentedDisk queue is written as one group,
+ * with a single write and (under syncQueueFiles) a single data sync. The
+ * caller holds the queue mutex for both calls. Records of a failed group
+ * write remain staged in the store and are written with its next write, but
+ * the failure is returned so that the caller does not report the messages
+ * as stored.
+ */
+static void qqueueBeginAppendGroup(qqueue_t *pThis) {
+    if (pThis->qType == QUEUETYPE_SEGMENTED_DISK && pThis->tVars.segdisk != NULL) {
+        segdiskStoreBeginAppend(pThis->tVars.segdisk);
+        ++pThis->nAppendGroups;
+    }
+}
+
+static rsRetVal qqueueCommitAppendGroup(qqueue_t *pThis) {
+    if (pThis->qType != QUEUETYPE_SEGMENTED_DISK || pThis->tVars.segdisk == NULL) return RS_RET_OK;
+    if (pThis->nAppendGroups > 0) --pThis->nAppendGroups;
+    const rsRetVal r = segdiskStoreCommitAppend(pThis->tVars.segdisk);
+    if (r != RS_RET_OK)
+        LogError(0, r, "%s: segmentedDisk could not write enqueued messages; they are kept and written later",
+                 obj.GetName((obj_t *)pThis));
+    qqueueUpdateSegDiskStats(pThis);
+    return r;
+}
+
+/* A single enqueue that arrives while another thread's group is open (that
+ * thread waits for queue space with the mutex released) would only be
+ * staged in that group. Under syncQueueFiles it must not return before its
+ * record is written and synced, so it brackets itself; its commit writes the
+ * other group's records as well, which is harmless. The segmented DA child
+ * is only fed by the DA worker, which brackets its whole batch.
+ */
+static int qqueueNeedsOwnAppendGroup(qqueue_t *pThis) {
+    return pThis->qType == QUEUETYPE_SEGMENTED_DISK && pThis->bSyncQueueFiles && !pThis->segdiskDAChild &&
+           pThis->nAppendGroups > 0;
+}
+
 static rsRetVal qDeqBatchSegDisk(qqueue_t *pThis, batch_t *batch, int max, int *skipped) {
     int discovered = 0;
     const rsRetVal store_ret = segdiskStoreDequeueBatch(pThis->tVars.segdisk, batch, max, skipped, &discovered);
@@ -1263,7 +1685,7 @@ static rsRetVal qDeqBatchSegDisk(qqueue_t *pThis, batch_t *batch, int max, int *
 static rsRetVal qCompleteBatchSegDisk(qqueue_t *pThis, batch_t *batch, int *committed, int *retried) {
     const rsRetVal r = segdiskStoreCompleteBatch(pThis->tVars.segdisk, batch, committed, retried);
     if (r == RS_RET_OK && pThis->segdiskDAChild && segdiskStoreCanDematerialize(pThis->tVars.segdisk))
-        pThis->segdiskIdleObservedActivity = pThis->pqParent->daActivityGeneration;
+        pThis->segdiskIdleObservedActivity = PREFER_LOAD_uint64(&pThis->pqParent->daActivityGeneration);
     qqueueUpdateSegDiskStats(pThis);
     return r;
 }
@@ -2308,13 +2730,10 @@ static rsRetVal qqueueAdd(qqueue_t *pThis, smsg_t *pMsg) {
 
     CHKiRet(pThis->qAdd(pThis, pMsg));
 
-    if (pThis->bIsDA && pThis->pqDA != NULL && pThis->pqDA->segdiskDAChild) {
-        /* Parent and DA child intentionally share this queue mutex. The idle
-         * callback therefore observes this activity generation atomically
-         * with both producer enqueue and child store operations. */
-        ++pThis->daActivityGeneration;
-        if (pThis->pqDA->pWtpReg != NULL) wtpWakeupAllWrkr(pThis->pqDA->pWtpReg);
-    }
+    /* Parent and DA child intentionally share this queue mutex. The idle
+     * callback therefore observes this activity generation atomically
+     * with both producer enqueue and child store operations. */
+    qqueueNoteDAActivity(pThis);
 
     if (pThis->qType != QUEUETYPE_DIRECT) {
         ATOMIC_INC(&pThis->iQueueSize, &pThis->mutQueueSize);
@@ -2638,6 +3057,9 @@ rsRetVal qqueueConstruct(qqueue_t **ppThis,
 
     /* we have an object, so let's fill the properties */
     objConstructSetObjInfo(pThis);
+    /* updated on every enqueue, even by direct queues, which have no stats object */
+    STATSCOUNTER_SHARDED_INIT(pThis->ctrEnqueued, pThis->mutCtrEnqueued);
+    STATSCOUNTER_SHARDED_INIT(pThis->ctrSizeEnqueued, pThis->mutCtrSizeEnqueued);
 
     if (workDir != NULL) {
         if ((pThis->pszSpoolDir = ustrdup(workDir)) == NULL) ABORT_FINALIZE(RS_RET_OUT_OF_MEMORY);
@@ -2651,6 +3073,11 @@ rsRetVal qqueueConstruct(qqueue_t **ppThis,
     pThis->nLogDeq = 0;
     pThis->useCryprov = 0;
     pThis->takeFlowCtlFromMsg = 0;
+    pThis->iShards = 1;
+    pThis->shardKey = QUEUE_SHARDKEY_THREAD;
+    pThis->segdiskCompress = 0;
+    pThis->segdiskCompressLevel = 3;
+    pThis->segdiskCompressBlockSize = 64 * 1024;
     pThis->iMaxQueueSize = iMaxQueueSize;
     pThis->pConsumer = pConsumer;
     pThis->iDeqtWinToHr = 25; /* disable time-windowed dequeuing by default */
@@ -2667,6 +3094,7 @@ rsRetVal qqueueConstruct(qqueue_t **ppThis,
 
 
     INIT_ATOMIC_HELPER_MUT(pThis->mutQueueSize);
+    INIT_ATOMIC_HELPER_MUT64(pThis->mutDaActivityGeneration);
     INIT_ATOMIC_HELPER_MUT(pThis->mutLogDeq);
     INIT_ATOMIC_HELPER_MUT(pThis->mutShutdownImmediate);
     CHKiRet(qqueueSetiNumWorkerThreads(pThis, iWorkerThreads));
@@ -3098,6 +3526,7 @@ static rsRetVal ATTR_NONNULL() DequeueConsumableElements(qqueue_t *const pThis,
     int iQueueSize;
     int keep_running = 1;
     int deferredDiskCorruption = 0;
+    int nShardsReleased = 0;
     rsRetVal pendingCorruptRet = RS_RET_OK;
     struct timespec timeout;
     smsg_t *pMsg;
@@ -3105,6 +3534,7 @@ static rsRetVal ATTR_NONNULL() DequeueConsumableElements(qqueue_t *const pThis,
     DEFiRet;
 
     nDeleted = pWti->batch.nElemDeq;
+    if (pThis->qType == QUEUETYPE_RINGBUFFER) nShardsReleased = qqueueRingBeginDeq(pThis, pWti);
     localRet = DeleteProcessedBatch(pThis, &pWti->batch);
     if (pThis->qCompleteBatch != NULL) CHKiRet(localRet);
 
@@ -3202,6 +3632,10 @@ static rsRetVal ATTR_NONNULL() DequeueConsumableElements(qqueue_t *const pThis,
             }
 
             localRet = pThis->qDeq(pThis, &pMsg);
+            if (localRet == RS_RET_NO_MORE_DATA && pThis->qType == QUEUETYPE_RINGBUFFER) {
+                /* the rest sits in shards other workers currently own */
+                break;
+            }
             if (localRet == RS_RET_FILE_NOT_FOUND) {
                 DBGPRINTF(
                     "fatal error on disk queue '%s': file '%s' "
@@ -3381,6 +3815,7 @@ static rsRetVal ATTR_NONNULL() DequeueConsumableElements(qqueue_t *const pThis,
     pWti->batch.nElemDeq = nDequeued + nDiscarded;
     pWti->batch.deqID = getNextDeqID(pThis);
     *piRemainingQueueSize = iQueueSize;
+    qqueueRingWakeAfterRelease(pThis, pWti, nShardsReleased);
 finalize_it:
     RETiRet;
 }
@@ -3550,7 +3985,16 @@ static rsRetVal DequeueForConsumer(qqueue_t *pThis, wti_t *pWti, int *const pSki
     ISOBJ_TYPE_assert(pThis, qqueue);
     ISOBJ_TYPE_assert(pWti, wti);
 
-    CHKiRet(DequeueConsumable(pThis, pWti, pSkippedMsgs));
+    while (1) {
+        CHKiRet(DequeueConsumable(pThis, pWti, pSkippedMsgs));
+        if (pWti->batch.nElem > 0 || pThis->qType != QUEUETYPE_RINGBUFFER || !pThis->tVars.ringbuf.bDeqInFlight)
+            break;
+        /* a lock-free producer was preempted before publishing; the batch
+         * is empty, so nothing is held that others could trip over */
+        d_pthread_mutex_unlock(pThis->mut);
+        sched_yield();
+        d_pthread_mutex_lock(pThis->mut);
+    }
 
     if (pWti->batch.nElem == 0) ABORT_FINALIZE(RS_RET_IDLE);
 
@@ -3577,16 +4021,41 @@ static rsRetVal batchProcessed(qqueue_t *pThis, wti_t *pWti) {
     ISOBJ_TYPE_assert(pWti, wti);
 
     int iCancelStateSave;
+    int nShardsReleased = 0;
     /* at this spot, we must not be cancelled */
     pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &iCancelStateSave);
+    if (pThis->qType == QUEUETYPE_RINGBUFFER) nShardsReleased = qqueueRingReleaseShards(pThis, pWti);
     DeleteProcessedBatch(pThis, &pWti->batch);
     qqueueChkPersist(pThis, pWti->batch.nElemDeq);
+    qqueueRingWakeAfterRelease(pThis, pWti, nShardsReleased);
     pthread_setcancelstate(iCancelStateSave, NULL);
 
     RETiRet;
 }
 
 
+/* Count how long the messages of a batch took to get to our consumer. Main
+ * and ruleset queues measure from the construction of the message and stamp
+ * it with the dequeue time, from which action queues then measure. Messages
+ * without a stamp were not sampled or were restored from disk.
+ */
+static void recordBatchLatency(qqueue_t *const pThis, batch_t *const pBatch) {
+    uint64_t now = 0;
+
+    for (int i = 0; i < batchNumMsgs(pBatch); ++i) {
+        smsg_t *const pMsg = pBatch->pElem[i].pMsg;
+        if (pMsg->tLatencyRcvd == 0) continue;
+        if (now == 0) now = msglatencyNow(); /* one clock read per batch */
+        if (pThis->pAction == NULL) {
+            msglatencyRecord(pThis->pLatency, pMsg->tLatencyRcvd, now);
+            pMsg->tLatencyDeq = now;
+        } else {
+            msglatencyRecord(pThis->pLatency, pMsg->tLatencyDeq, now);
+        }
+    }
+}
+
+
 /* This is the queue consumer in the regular (non-DA) case. It is
  * protected by the queue mutex, but MUST release it as soon as possible.
  * rgerhards, 2008-01-21
@@ -3633,6 +4102,7 @@ static rsRetVal ConsumerReg(qqueue_t *pThis, wti_t *pWti) {
 
 
     qqueueSetWtiShutdownImmediate(pThis, pWti);
+    if (pThis->pLatency != NULL) recordBatchLatency(pThis, &pWti->batch);
     CHKiRet(pThis->pConsumer(pThis->pAction, &pWti->batch, pWti));
 
     /* we now need to check if we should deliberately delay processing a bit
@@ -3670,6 +4140,7 @@ static rsRetVal ConsumerDA(qqueue_t *pThis, wti_t *pWti) {
     int i;
     int iCancelStateSave;
     int bNeedReLock = 0; /**< do we need to lock the mutex again? */
+    int bAppendGroup = 0;
     int skippedMsgs = 0;
     DEFiRet;
 
@@ -3678,6 +4149,11 @@ static rsRetVal ConsumerDA(qqueue_t *pThis, wti_t *pWti) {
 
     CHKiRet(DequeueForConsumer(pThis, pWti, &skippedMsgs));
 
+    /* The child shares our mutex, so the whole batch can be handed to a
+     * segmented child as one append group. */
+    qqueueBeginAppendGroup(pThis->pqDA);
+    bAppendGroup = 1;
+
     /* we now have a non-idle batch of work, so we can release the queue mutex and process it */
     d_pthread_mutex_unlock(pThis->mut);
     bNeedReLock = 1;
@@ -3746,6 +4222,13 @@ finalize_it:
 
     /* now we are done, but potentially need to re-acquire the mutex */
     if (bNeedReLock) d_pthread_mutex_lock(pThis->mut);
+    if (bAppendGroup) {
+        /* The child keeps the records staged and writes them with its next
+         * write, so the batch stays committed to avoid duplicates; the DA
+         * worker still gets the error. */
+        const rsRetVal commitRet = qqueueCommitAppendGroup(pThis->pqDA);
+        if (iRet == RS_RET_OK) iRet = commitRet;
+    }
 
     RETiRet;
 }
@@ -3839,6 +4322,15 @@ rsRetVal qqueueStart(rsconf_t *cnf, qqueue_t *pThis) /* this is the Construction
      */
     pThis->qDeqBatch = NULL;
     pThis->qCompleteBatch = NULL;
+#ifndef HAVE_ATOMIC_BUILTINS
+    if (pThis->qType == QUEUETYPE_RINGBUFFER) {
+        LogMsg(0, RS_RET_OK_WARN, LOG_WARNING,
+               "queue '%s': queue.type=\"ringBuffer\" needs atomic instructions, which "
+               "this platform does not provide - using FixedArray instead",
+               obj.GetName((obj_t *)pThis));
+        pThis->qType = QUEUETYPE_FIXED_ARRAY;
+    }
+#endif
     switch (pThis->qType) {
         case QUEUETYPE_FIXED_ARRAY:
             pThis->qConstruct = qConstructFixedArray;
@@ -3856,6 +4348,16 @@ rsRetVal qqueueStart(rsconf_t *cnf, qqueue_t *pThis) /* this is the Construction
             pThis->qDel = qDelLinkedList;
             pThis->MultiEnq = qqueueMultiEnqObjNonDirect;
             break;
+#ifdef HAVE_ATOMIC_BUILTINS
+        case QUEUETYPE_RINGBUFFER:
+            pThis->qConstruct = qConstructRingBuffer;
+            pThis->qDestruct = qDestructRingBuffer;
+            pThis->qAdd = qAddRingBuffer;
+            pThis->qDeq = qDeqRingBuffer;
+            pThis->qDel = qDelRingBuffer;
+            pThis->MultiEnq = qqueueMultiEnqObjRingBuffer;
+            break;
+#endif
         case QUEUETYPE_DISK:
             pThis->qConstruct = qConstructDisk;
             pThis->qDestruct = qDestructDisk;
@@ -3923,6 +4425,9 @@ rsRetVal qqueueStart(rsconf_t *cnf, qqueue_t *pThis) /* this is the Construction
         wrk = pThis->iHighWtrMrk - (pThis->iHighWtrMrk / 100) * 50; /* 50% of high water mark */
         if (wrk < pThis->iFullDlyMrk) pThis->iFullDlyMrk = wrk;
     }
+#ifdef HAVE_ATOMIC_BUILTINS
+    if (pThis->qType == QUEUETYPE_RINGBUFFER) qqueueSetRingBufferMrks(pThis);
+#endif
 
     DBGOPRINT((obj_t *)pThis,
               "params: type %d, enq-only %d, disk assisted %d, spoolDir '%s', maxFileSz %lld, "
@@ -4012,13 +4517,11 @@ rsRetVal qqueueStart(rsconf_t *cnf, qqueue_t *pThis) /* this is the Construction
     CHKiRet(
         statsobj.AddCounter(pThis->statsobj, UCHAR_CONSTANT("size"), ctrType_Int, CTR_FLAG_NONE, &pThis->iQueueSize));
 
-    STATSCOUNTER_INIT(pThis->ctrEnqueued, pThis->mutCtrEnqueued);
-    CHKiRet(statsobj.AddCounter(pThis->statsobj, UCHAR_CONSTANT("enqueued"), ctrType_IntCtr, CTR_FLAG_RESETTABLE,
+    CHKiRet(statsobj.AddCounter(pThis->statsobj, UCHAR_CONSTANT("enqueued"), ctrType_ShardedCtr, CTR_FLAG_RESETTABLE,
                                 &pThis->ctrEnqueued));
 
-    STATSCOUNTER_INIT(pThis->ctrSizeEnqueued, pThis->mutCtrSizeEnqueued);
-    CHKiRet(statsobj.AddCounter(pThis->statsobj, UCHAR_CONSTANT("size.enqueued"), ctrType_IntCtr, CTR_FLAG_RESETTABLE,
-                                &pThis->ctrSizeEnqueued));
+    CHKiRet(statsobj.AddCounter(pThis->statsobj, UCHAR_CONSTANT("size.enqueued"), ctrType_ShardedCtr,
+                                CTR_FLAG_RESETTABLE, &pThis->ctrSizeEnqueued));
 
     STATSCOUNTER_INIT(pThis->ctrFull, pThis->mutCtrFull);
     CHKiRet(statsobj.AddCounter(pThis->statsobj, UCHAR_CONSTANT("full"), ctrType_IntCtr, CTR_FLAG_RESETTABLE,
@@ -4070,6 +4573,10 @@ rsRetVal qqueueStart(rsconf_t *cnf, qqueue_t *pThis) /* this is the Construction
                                     CTR_FLAG_NONE, &pThis->segdiskStartupPayloadBytes));
         CHKiRet(statsobj.AddCounter(pThis->statsobj, UCHAR_CONSTANT("startup.segmentFilesProbed"), ctrType_Int,
                                     CTR_FLAG_NONE, &pThis->segdiskStartupSegmentFilesProbed));
+        CHKiRet(statsobj.AddCounter(pThis->statsobj, UCHAR_CONSTANT("group.writes"), ctrType_Int, CTR_FLAG_NONE,
+                                    &pThis->segdiskGroupWrites));
+        CHKiRet(statsobj.AddCounter(pThis->statsobj, UCHAR_CONSTANT("group.records"), ctrType_Int, CTR_FLAG_NONE,
+                                    &pThis->segdiskGroupRecords));
         CHKiRet(statsobj.AddCounter(pThis->statsobj, UCHAR_CONSTANT("store.materializations"), ctrType_Int,
                                     CTR_FLAG_NONE, &pThis->segdiskMaterializations));
         CHKiRet(statsobj.AddCounter(pThis->statsobj, UCHAR_CONSTANT("store.idleDematerializations"), ctrType_Int,
@@ -4080,6 +4587,11 @@ rsRetVal qqueueStart(rsconf_t *cnf, qqueue_t *pThis) /* this is the Construction
                                     &pThis->pWtpReg->iCurNumWrkThrd));
     }
 
+    /* disk-assisted children only see messages restored from disk, which carry no stamp */
+    if (pThis->pqParent == NULL) {
+        CHKiRet(msglatencyConstruct(&pThis->pLatency, pThis->statsobj));
+    }
+
     CHKiRet(statsobj.ConstructFinalize(pThis->statsobj));
 
 finalize_it:
@@ -4337,6 +4849,7 @@ BEGINobjDestruct(qqueue) /* be sure to specify the object type also in END and C
         pthread_cond_destroy(&pThis->belowLightDlyWtrMrk);
 
         DESTROY_ATOMIC_HELPER_MUT(pThis->mutQueueSize);
+        DESTROY_ATOMIC_HELPER_MUT64(pThis->mutDaActivityGeneration);
         DESTROY_ATOMIC_HELPER_MUT(pThis->mutLogDeq);
         DESTROY_ATOMIC_HELPER_MUT(pThis->mutShutdownImmediate);
 
@@ -4354,7 +4867,12 @@ BEGINobjDestruct(qqueue) /* be sure to specify the object type also in END and C
     }
 
     /* some queues do not provide stats and thus have no statsobj! */
-    if (pThis->statsobj != NULL) statsobj.Destruct(&pThis->statsobj);
+    if (pThis->statsobj != NULL) {
+        statsobj.Destruct(&pThis->statsobj);
+        msglatencyDestruct(&pThis->pLatency);
+    }
+    STATSCOUNTER_SHARDED_DESTRUCT(pThis->ctrEnqueued, pThis->mutCtrEnqueued);
+    STATSCOUNTER_SHARDED_DESTRUCT(pThis->ctrSizeEnqueued, pThis->mutCtrSizeEnqueued);
 ENDobjDestruct(qqueue)
 
 
@@ -4424,10 +4942,10 @@ static rsRetVal doEnqSingleObj(qqueue_t *pThis, flowControl_t flowCtlType, smsg_
     int err;
     struct timespec t;
 
-    STATSCOUNTER_INC(pThis->ctrEnqueued, pThis->mutCtrEnqueued);
+    STATSCOUNTER_SHARDED_INC(pThis->ctrEnqueued, pThis->mutCtrEnqueued);
     /* size.enqueued mirrors enqueued: counted on arrival, before discard checks,
      * so it represents inbound byte volume (rejected slice tracked by ctrFDscrd). */
-    STATSCOUNTER_ADD(pThis->ctrSizeEnqueued, pThis->mutCtrSizeEnqueued, (uint64_t)pMsg->iLenRawMsg);
+    STATSCOUNTER_SHARDED_ADD(pThis->ctrSizeEnqueued, pThis->mutCtrSizeEnqueued, (uint64_t)pMsg->iLenRawMsg);
     /* first check if we need to discard this message (which will cause CHKiRet() to exit)
      */
     CHKiRet(qqueueChkDiscardMsg(pThis, pThis->iQueueSize, pMsg));
@@ -4602,6 +5120,7 @@ static rsRetVal qqueueMultiEnqObjNonDirect(qqueue_t *pThis, multi_submit_t *pMul
 
     pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &iCancelStateSave);
     d_pthread_mutex_lock(pThis->mut);
+    qqueueBeginAppendGroup(pThis);
     for (i = 0; i < pMultiSub->nElem; ++i) {
         localRet = doEnqSingleObj(pThis, pMultiSub->ppMsgs[i]->flowCtlType, (void *)pMultiSub->ppMsgs[i]);
         if (localRet != RS_RET_OK && localRet != RS_RET_QUEUE_FULL) ABORT_FINALIZE(localRet);
@@ -4609,6 +5128,8 @@ static rsRetVal qqueueMultiEnqObjNonDirect(qqueue_t *pThis, multi_submit_t *pMul
     qqueueChkPersist(pThis, pMultiSub->nElem);
 
 finalize_it:
+    localRet = qqueueCommitAppendGroup(pThis);
+    if (iRet == RS_RET_OK) iRet = localRet;
     /* make sure at least one worker is running. */
     qqueueAdviseMaxWorkers(pThis);
     /* and release the mutex */
@@ -4619,6 +5140,48 @@ finalize_it:
     RETiRet;
 }
 
+#ifdef HAVE_ATOMIC_BUILTINS
+/* the same function for ring buffer queues. Messages are enqueued lock-free
+ * until one of them hits a mark that needs the regular enqueue logic. That
+ * message and all following ones are then enqueued under the queue mutex,
+ * so the submission order is preserved.
+ */
+static rsRetVal qqueueMultiEnqObjRingBuffer(qqueue_t *pThis, multi_submit_t *pMultiSub) {
+    int iCancelStateSave;
+    int i;
+    int iFirstLocked;
+    sbool bLocked = 0;
+    rsRetVal localRet;
+    DEFiRet;
+
+    ISOBJ_TYPE_assert(pThis, qqueue);
+    assert(pMultiSub != NULL);
+
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &iCancelStateSave);
+    for (i = 0; i < pMultiSub->nElem; ++i) {
+        if (!qqueueEnqRingBufferFast(pThis, pMultiSub->ppMsgs[i]->flowCtlType, pMultiSub->ppMsgs[i])) break;
+    }
+    if (i < pMultiSub->nElem) {
+        d_pthread_mutex_lock(pThis->mut);
+        bLocked = 1;
+        for (iFirstLocked = i; i < pMultiSub->nElem; ++i) {
+            localRet = doEnqSingleObj(pThis, pMultiSub->ppMsgs[i]->flowCtlType, (void *)pMultiSub->ppMsgs[i]);
+            if (localRet != RS_RET_OK && localRet != RS_RET_QUEUE_FULL) ABORT_FINALIZE(localRet);
+        }
+        qqueueChkPersist(pThis, pMultiSub->nElem - iFirstLocked);
+    }
+
+finalize_it:
+    if (bLocked) {
+        qqueueAdviseMaxWorkers(pThis);
+        d_pthread_mutex_unlock(pThis->mut);
+    }
+    pthread_setcancelstate(iCancelStateSave, NULL);
+
+    RETiRet;
+}
+#endif /* #ifdef HAVE_ATOMIC_BUILTINS */
+
 /* now, the same function, but for direct mode */
 static rsRetVal qqueueMultiEnqObjDirect(qqueue_t *pThis, multi_submit_t *pMultiSub) {
     int i;
@@ -4647,10 +5210,22 @@ rsRetVal qqueueEnqMsg(qqueue_t *pThis, flowControl_t flowCtlType, smsg_t *pMsg)
     ISOBJ_TYPE_assert(pThis, qqueue);
 
     const int isNonDirectQ = pThis->qType != QUEUETYPE_DIRECT;
+    int bOwnAppendGroup = 0;
+
+    if (pThis->qType == QUEUETYPE_RINGBUFFER) {
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &iCancelStateSave);
+        const int bEnqueued = qqueueEnqRingBufferFast(pThis, flowCtlType, pMsg);
+        pthread_setcancelstate(iCancelStateSave, NULL);
+        if (bEnqueued) RETiRet;
+    }
 
     if (isNonDirectQ) {
         pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &iCancelStateSave);
         d_pthread_mutex_lock(pThis->mut);
+        if (qqueueNeedsOwnAppendGroup(pThis)) {
+            qqueueBeginAppendGroup(pThis);
+            bOwnAppendGroup = 1;
+        }
     }
 
     CHKiRet(doEnqSingleObj(pThis, flowCtlType, pMsg));
@@ -4658,6 +5233,10 @@ rsRetVal qqueueEnqMsg(qqueue_t *pThis, flowControl_t flowCtlType, smsg_t *pMsg)
     qqueueChkPersist(pThis, 1);
 
 finalize_it:
+    if (bOwnAppendGroup) {
+        const rsRetVal commitRet = qqueueCommitAppendGroup(pThis);
+        if (iRet == RS_RET_OK) iRet = commitRet;
+    }
     if (isNonDirectQ) {
         /* make sure at least one worker is running. */
         qqueueAdviseMaxWorkers(pThis);
@@ -4774,7 +5353,8 @@ void qqueueCorrectParams(qqueue_t *pThis) {
     int goodval; /* a "good value" to use for comparisons (different objects) */
     int needWarnHigh = 0, needWarnLow = 0;
 
-    if (pThis->iMaxQueueSize < 100 && (pThis->qType == QUEUETYPE_LINKEDLIST || pThis->qType == QUEUETYPE_FIXED_ARRAY)) {
+    if (pThis->iMaxQueueSize < 100 && (pThis->qType == QUEUETYPE_LINKEDLIST || pThis->qType == QUEUETYPE_FIXED_ARRAY ||
+                                       pThis->qType == QUEUETYPE_RINGBUFFER)) {
         LogMsg(0, RS_RET_OK_WARN, LOG_WARNING,
                "Note: queue.size=\"%d\" is very "
                "low and can lead to unpredictable results. See also "
@@ -5050,6 +5630,36 @@ rsRetVal qqueueApplyCnfParam(qqueue_t *pThis, struct nvlst *lst) {
             pThis->iSmpInterval = pvals[i].val.d.n;
         } else if (!strcmp(pblk.descr[i].name, "queue.takeflowctlfrommsg")) {
             pThis->takeFlowCtlFromMsg = pvals[i].val.d.n;
+        } else if (!strcmp(pblk.descr[i].name, "queue.shards")) {
+            pThis->iShards = pvals[i].val.d.n;
+        } else if (!strcmp(pblk.descr[i].name, "queue.shardkey")) {
+            char *key;
+            CHKmalloc(key = es_str2cstr(pvals[i].val.d.estr, NULL));
+            if (!strcasecmp(key, "thread")) {
+                pThis->shardKey = QUEUE_SHARDKEY_THREAD;
+            } else if (!strcasecmp(key, "source")) {
+                pThis->shardKey = QUEUE_SHARDKEY_SOURCE;
+            } else {
+                parser_errmsg("queue.shardKey: invalid value '%s'; using 'thread'", key);
+                pThis->shardKey = QUEUE_SHARDKEY_THREAD;
+            }
+            free(key);
+        } else if (!strcmp(pblk.descr[i].name, "queue.compression")) {
+            char *mode;
+            CHKmalloc(mode = es_str2cstr(pvals[i].val.d.estr, NULL));
+            if (!strcasecmp(mode, "none")) {
+                pThis->segdiskCompress = 0;
+            } else if (!strcasecmp(mode, "zstd")) {
+                pThis->segdiskCompress = 1;
+            } else {
+                parser_errmsg("queue.compression: invalid value '%s'; using 'none'", mode);
+                pThis->segdiskCompress = 0;
+            }
+            free(mode);
+        } else if (!strcmp(pblk.descr[i].name, "queue.compressionblocksize")) {
+            pThis->segdiskCompressBlockSize = pvals[i].val.d.n;
+        } else if (!strcmp(pblk.descr[i].name, "queue.compressionlevel")) {
+            pThis->segdiskCompressLevel = pvals[i].val.d.n;
         } else if (!strcmp(pblk.descr[i].name, "queue.oncorruption")) {
             char *mode;
             CHKmalloc(mode = es_str2cstr(pvals[i].val.d.estr, NULL));
@@ -5072,8 +5682,9 @@ rsRetVal qqueueApplyCnfParam(qqueue_t *pThis, struct nvlst *lst) {
         }
     }
 
-    const sbool is_da_memory_queue =
-        (pThis->qType == QUEUETYPE_FIXED_ARRAY || pThis->qType == QUEUETYPE_LINKEDLIST) && pThis->pszFilePrefix != NULL;
+    const sbool is_da_memory_queue = (pThis->qType == QUEUETYPE_FIXED_ARRAY || pThis->qType == QUEUETYPE_LINKEDLIST ||
+                                      pThis->qType == QUEUETYPE_RINGBUFFER) &&
+                                     pThis->pszFilePrefix != NULL;
     /* These are deliberately parser_errmsg(), not advisory warnings:
      * parser_errmsg marks the configuration dirty.  Permissive startup keeps
      * running after the unusable value is ignored, while
@@ -5082,7 +5693,7 @@ rsRetVal qqueueApplyCnfParam(qqueue_t *pThis, struct nvlst *lst) {
         !is_da_memory_queue) {
         parser_errmsg(
             "queue.diskQueueType, queue.diskQueueAutoUpgrade, and queue.diskQueueIdleTimeout apply only to "
-            "FixedArray or LinkedList disk-assisted queues; ignoring these parameters");
+            "FixedArray, LinkedList or RingBuffer disk-assisted queues; ignoring these parameters");
         pThis->diskQueueType = QDA_ENGINE_AUTO;
         pThis->diskQueueAutoUpgrade = 0;
         pThis->diskQueueIdleTimeout = 60000;
@@ -5097,6 +5708,36 @@ rsRetVal qqueueApplyCnfParam(qqueue_t *pThis, struct nvlst *lst) {
         pThis->diskQueueIdleTimeout = 60000;
     }
 
+    if (pThis->iShards > 1 && pThis->qType != QUEUETYPE_RINGBUFFER) {
+        parser_errmsg("queue.shards applies only to RingBuffer queues; ignoring it");
+        pThis->iShards = 1;
+    }
+    if (pThis->segdiskCompress) {
+#ifndef ENABLE_LIBZSTD
+        parser_errmsg("queue.compression=\"zstd\" requires rsyslog to be built with --enable-libzstd; ignoring it");
+        pThis->segdiskCompress = 0;
+#endif
+        if (pThis->qType != QUEUETYPE_SEGMENTED_DISK && !is_da_memory_queue) {
+            parser_errmsg("queue.compression applies only to segmentedDisk queues and their disk-assisted "
+                          "counterparts; ignoring it");
+            pThis->segdiskCompress = 0;
+        }
+        /* a synced queue must not keep acknowledged records in an open block,
+         * and writing a block per enqueue defeats the compression */
+        if (pThis->segdiskCompress && pThis->bSyncQueueFiles) {
+            parser_errmsg("queue.compression can not be combined with queue.syncQueueFiles=\"on\"; ignoring it");
+            pThis->segdiskCompress = 0;
+        }
+    }
+    if (pThis->segdiskCompressBlockSize < 1024 || pThis->segdiskCompressBlockSize > 16 * 1024 * 1024) {
+        parser_errmsg("queue.compressionBlockSize must be between 1k and 16m; using 64k");
+        pThis->segdiskCompressBlockSize = 64 * 1024;
+    }
+    if (pThis->segdiskCompressLevel < 1 || pThis->segdiskCompressLevel > 22) {
+        parser_errmsg("queue.compressionLevel must be between 1 and 22; using 3");
+        pThis->segdiskCompressLevel = 3;
+    }
+
     checkUniqueDiskFile(pThis);
 
     if (pThis->qType == QUEUETYPE_DIRECT) {
@@ -5175,7 +5816,9 @@ int queuesEqual(qqueue_t *pOld, qqueue_t *pNew) {
             NUM_EQUALS(toActShutdown) && NUM_EQUALS(toEnq) && NUM_EQUALS(toWrkShutdown) &&
             NUM_EQUALS(iMinMsgsPerWrkr) && NUM_EQUALS(iMaxFileSize) && NUM_EQUALS(bSaveOnShutdown) &&
             NUM_EQUALS(iDeqSlowdown) && NUM_EQUALS(iDeqtWinFromHr) && NUM_EQUALS(iDeqtWinToHr) &&
-            NUM_EQUALS(iSmpInterval) && NUM_EQUALS(takeFlowCtlFromMsg) && qdaLifecycleConfigEqual(&old_da, &new_da) &&
+            NUM_EQUALS(iSmpInterval) && NUM_EQUALS(takeFlowCtlFromMsg) && NUM_EQUALS(iShards) &&
+            NUM_EQUALS(shardKey) && NUM_EQUALS(segdiskCompress) && NUM_EQUALS(segdiskCompressLevel) &&
+            NUM_EQUALS(segdiskCompressBlockSize) && qdaLifecycleConfigEqual(&old_da, &new_da) &&
             USTR_EQUALS(pszFilePrefix) && USTR_EQUALS(cryprovName));
 }
 
@@ -5263,6 +5906,13 @@ BEGINObjClassInit(qqueue, 1, OBJ_IS_CORE_MODULE)
     CHKiRet(objUse(datetime, CORE_COMPONENT));
     CHKiRet(objUse(statsobj, CORE_COMPONENT));
 
+#ifdef HAVE_ATOMIC_BUILTINS
+    if (pthread_key_create(&keyProducerIdx, NULL) != 0) {
+        dbgprintf("queue.c: pthread_key_create failed\n");
+        ABORT_FINALIZE(RS_RET_ERR);
+    }
+#endif
+
     /* now set our own handlers */
     OBJSetMethodHandler(objMethod_SETPROPERTY, qqueueSetProperty);
 ENDObjClassInit(qqueue)
@@ -47,9 +47,11 @@
 #include "batch.h"
 #include "stream.h"
 #include "statsobj.h"
+#include "msglatency.h"
 #include "cryprov.h"
 #include "queue_da.h"
 #include "segdisk_store.h"
+#include "mpmcring.h"
 
 /* support for the toDelete list */
 typedef struct toDeleteLst_s toDeleteLst_t;
@@ -66,7 +68,8 @@ typedef enum {
     QUEUETYPE_LINKEDLIST = 1, /* linked list used as buffer, lower fixed memory overhead but slower */
     QUEUETYPE_DISK = 2, /* disk files used as buffer */
     QUEUETYPE_DIRECT = 3, /* no queuing happens, consumer is directly called */
-    QUEUETYPE_SEGMENTED_DISK = 4 /* log-structured segmented disk queue */
+    QUEUETYPE_SEGMENTED_DISK = 4, /* log-structured segmented disk queue */
+    QUEUETYPE_RINGBUFFER = 5 /* bounded lock-free ring, producers enqueue without the queue mutex */
 } queueType_t;
 
 /* queue recovery modes */
@@ -76,6 +79,12 @@ typedef enum {
     QUEUE_ON_CORRUPTION_IGNORE = 2
 } queueOnCorruption_t;
 
+/* how producers select a RingBuffer shard */
+typedef enum {
+    QUEUE_SHARDKEY_THREAD = 0, /* one shard per enqueuing thread (round-robin) */
+    QUEUE_SHARDKEY_SOURCE = 1 /* hash of the sender address, keeps per-sender order */
+} queueShardKey_t;
+
 /* list member definition for linked list types of queues: */
 typedef struct qLinkedList_S {
     struct qLinkedList_S *pNext;
@@ -195,8 +204,15 @@ struct queue_s {
         sbool diskQueueIdleTimeoutSet;
         sbool segdiskLazyCreate; /* create a fresh segmented store on first append */
         sbool segdiskDAChild; /* segmented child of an in-memory DA parent */
+        int nAppendGroups; /* open segmentedDisk append groups, protected by the queue mutex */
+        sbool segdiskCompress; /* write zstd-compressed record blocks (segmentedDisk only) */
+        int segdiskCompressLevel; /* zstd level for those blocks */
+        int64 segdiskCompressBlockSize; /* serialized bytes collected per block */
         sbool daEngineMarkerPending; /* publish the selected DA engine before first append */
         uint64_t daActivityGeneration; /* parent enqueue generation for the idle grace period */
+        DEF_ATOMIC_HELPER_MUT64(mutDaActivityGeneration);
+        int bDAActivityNotify; /* a segmented DA child was started; lock-free hint for the ring buffer
+                                * fast path, qqueueNoteDAActivity() re-checks under the mutex */
         uint64_t segdiskIdleObservedActivity;
         struct queue_s *pqDA; /* queue for disk-assisted modes */
         struct queue_s *pqParent; /* pointer to the parent (if this is a child queue) */
@@ -208,6 +224,16 @@ struct queue_s {
                 long deqhead, head, tail;
                 void **pBuf; /* the queued user data structure */
             } farray;
+            struct {
+                mpmcring_t *rings; /* one ring per shard */
+                int nRings;
+                wti_t **owner; /* per shard: worker whose batch came from it (source key only) */
+                wti_t *deqWti; /* worker currently dequeueing, set under the queue mutex */
+                int deqRing; /* shard the current dequeue pulls from */
+                sbool bDeqInFlight; /* current dequeue stopped at an element not yet published */
+                int fastEnqMrk[3]; /* per flowControl_t: lock-free enqueue only below this size */
+                sbool bFastEnq; /* lock-free enqueue permitted at all? */
+            } ringbuf;
             struct {
                 qLinkedList_t *pDeqRoot;
                 qLinkedList_t *pDelRoot;
@@ -236,11 +262,12 @@ struct queue_s {
         DEF_ATOMIC_HELPER_MUT(mutLogDeq);
         /* for statistics subsystem */
         statsobj_t *statsobj;
-        STATSCOUNTER_DEF(ctrEnqueued, mutCtrEnqueued)
-        STATSCOUNTER_DEF(ctrSizeEnqueued, mutCtrSizeEnqueued) /* cumulative bytes enqueued */
+        STATSCOUNTER_SHARDED_DEF(ctrEnqueued, mutCtrEnqueued) /* updated by all producers */
+        STATSCOUNTER_SHARDED_DEF(ctrSizeEnqueued, mutCtrSizeEnqueued) /* cumulative bytes enqueued */
         STATSCOUNTER_DEF(ctrFull, mutCtrFull)
         STATSCOUNTER_DEF(ctrFDscrd, mutCtrFDscrd)
         STATSCOUNTER_DEF(ctrNFDscrd, mutCtrNFDscrd)
+        msglatency_t *pLatency; /* latency histogram, NULL unless stats.latency is on */
         int ctrMaxqsize; /* NOT guarded by a mutex */
         int segdiskBytes;
         int segdiskSegments;
@@ -262,7 +289,11 @@ struct queue_s {
         int segdiskMaterializations;
         int segdiskDematerializations;
         int segdiskIdleCleanupFailures;
+        int segdiskGroupWrites;
+        int segdiskGroupRecords;
         int iSmpInterval; /* line interval of sampling logs */
+        int iShards; /* number of RingBuffer shards */
+        queueShardKey_t shardKey; /* how producers pick a RingBuffer shard */
         int isRunning;
 };
 
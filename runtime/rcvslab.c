@@ -0,0 +1,52 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file rcvslab.c
+ * @brief Reference-counted receive buffers shared with message objects.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include "rsyslog.h"
+#include "rcvslab.h"
+
+rsRetVal rcvslabConstruct(rcvslab_t **const ppThis, const size_t size) {
+    rcvslab_t *pThis;
+    DEFiRet;
+
+    CHKmalloc(pThis = malloc(sizeof(rcvslab_t) + size));
+    pThis->refCount = 1;
+    INIT_ATOMIC_HELPER_MUT(pThis->mutRefCount);
+    pThis->size = size;
+    *ppThis = pThis;
+
+finalize_it:
+    RETiRet;
+}
+
+
+void rcvslabAddRef(rcvslab_t *const pThis) {
+    ATOMIC_INC(&pThis->refCount, &pThis->mutRefCount);
+}
+
+
+void rcvslabRelease(rcvslab_t *const pThis) {
+    if (ATOMIC_DEC_AND_FETCH(&pThis->refCount, &pThis->mutRefCount) == 0) {
+        DESTROY_ATOMIC_HELPER_MUT(pThis->mutRefCount);
+        free(pThis);
+    }
+}
+
+
+int rcvslabIsShared(rcvslab_t *const pThis) {
+    return ATOMIC_LOAD_32BIT(&pThis->refCount, &pThis->mutRefCount) > 1;
+}
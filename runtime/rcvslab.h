@@ -0,0 +1,61 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file rcvslab.h
+ * @brief Reference-counted receive buffers shared with message objects.
+ *
+ * A receive slab is a heap buffer an input reads network data into. Messages
+ * whose raw text lies completely inside the slab can reference it instead of
+ * copying the bytes (see MsgSetRawMsgRef()). The slab is freed when the input
+ * and every referencing message have dropped their reference.
+ *
+ * Ownership rule: each referencing message owns its raw byte range plus the
+ * byte directly after it, which is overwritten with the terminating NUL. The
+ * input must therefore hand out disjoint ranges and must not write into a
+ * slab again once rcvslabIsShared() reports other owners.
+ */
+#ifndef INCLUDED_RCVSLAB_H
+#define INCLUDED_RCVSLAB_H
+
+#include <stddef.h>
+#include "rsyslog.h"
+#include "atomic.h"
+
+/**
+ * @brief A reference-counted receive buffer.
+ */
+typedef struct rcvslab_s {
+    int refCount; /**< number of owners (input plus referencing messages) */
+    DEF_ATOMIC_HELPER_MUT(mutRefCount);
+    size_t size; /**< usable bytes in buf */
+    uchar buf[]; /**< receive data */
+} rcvslab_t;
+
+/**
+ * @brief Allocate a slab with one reference held by the caller.
+ * @param ppThis receives the new slab
+ * @param size   number of usable bytes
+ * @return RS_RET_OK or RS_RET_OUT_OF_MEMORY
+ */
+rsRetVal rcvslabConstruct(rcvslab_t **ppThis, size_t size);
+
+/** @brief Add a reference for a new owner. */
+void rcvslabAddRef(rcvslab_t *pThis);
+
+/** @brief Drop a reference; the slab is freed when the last one is gone. */
+void rcvslabRelease(rcvslab_t *pThis);
+
+/** @brief Check whether owners other than the caller reference the slab. */
+int rcvslabIsShared(rcvslab_t *pThis);
+
+#endif /* #ifndef INCLUDED_RCVSLAB_H */
@@ -72,6 +72,7 @@
 #include "timezones.h"
 #include "ratelimit.h"
 #include "translate.h"
+#include "msglatency.h"
 #ifdef HAVE_LIBYAML
     #include "yamlconf.h"
 #endif
@@ -336,6 +337,9 @@ static void cnfSetDefaults(rsconf_t *pThis) {
     pThis->globals.reportGoneAwaySenders = 0;
     pThis->globals.senderStatsTimeout = 12 * 60 * 60; /* 12 hr timeout for senders */
     pThis->globals.senderKeepTrack = 0;
+    pThis->globals.bLatencyStats = 0;
+    pThis->globals.latencySampling = 1;
+    pThis->globals.bRulesetBatchExec = 0;
     pThis->globals.inputTimeoutShutdown = 1000;
     pThis->globals.iDefPFFamily = PF_UNSPEC;
     pThis->globals.ACLAddHostnameOnFail = 0;
@@ -363,6 +367,9 @@ static void cnfSetDefaults(rsconf_t *pThis) {
 
     pThis->globals.dnscacheDefaultTTL = 24 * 60 * 60;
     pThis->globals.dnscacheEnableTTL = 0;
+    pThis->globals.dnscacheNegativeTTL = -1;
+    pThis->globals.dnscacheResolverThreads = 0;
+    pThis->globals.dnscachePublishIP = 1;
     pThis->globals.shutdownQueueDoubleSize = 0;
     pThis->globals.optionDisallowWarning = 1;
     pThis->globals.bSupportCompressionExtension = 1;
@@ -400,6 +407,7 @@ static void cnfSetDefaults(rsconf_t *pThis) {
     pThis->globals.mainQ.iMainMsgQueueDeqtWinFromHr = 0;
     pThis->globals.mainQ.iMainMsgQueueDeqtWinToHr = 25;
     pThis->pMsgQueue = NULL;
+    pThis->pParserQueue = NULL;
 
     pThis->globals.parser.cCCEscapeChar = '#';
     pThis->globals.parser.bDropTrailingLF = 1;
@@ -411,6 +419,7 @@ static void cnfSetDefaults(rsconf_t *pThis) {
     pThis->globals.parser.bParserEscapeCCCStyle = 0;
     pThis->globals.parser.bPermitSlashInProgramname = 0;
     pThis->globals.parser.bParseHOSTNAMEandTAG = 1;
+    pThis->globals.parser.iWorkerThreads = 0;
 
     pThis->parsers.pDfltParsLst = NULL;
     pThis->parsers.pParsLstRoot = NULL;
@@ -1169,6 +1178,13 @@ static rsRetVal loadMainQueue(void) {
         fprintf(stderr, "fatal error %d: could not create message queue - rsyslogd can not run!\n", iRet);
         FINALIZE;
     }
+    if (loadConf->globals.parser.iWorkerThreads > 0) {
+        CHKiRet_Hdlr(createParserQueue(&loadConf->pParserQueue, loadConf->globals.parser.iWorkerThreads)) {
+            /* not fatal, messages are then parsed by the main queue workers as usual */
+            LogError(0, iRet, "could not create parser queue, parsing in main queue workers");
+            iRet = RS_RET_OK;
+        }
+    }
 finalize_it:
     glblDestructMainqCnfObj();
     RETiRet;
@@ -1193,6 +1209,15 @@ static rsRetVal activateMainQueue(void) {
         PREFER_STORE_1_TO_INT(&bHaveMainQueue);
     }
     DBGPRINTF("Main processing queue is initialized and running\n");
+
+    /* the parse stage feeds the main and ruleset queues, so it must start after them */
+    if (runConf->pParserQueue != NULL) {
+        CHKiRet_Hdlr(qqueueStart(runConf, runConf->pParserQueue)) {
+            LogError(0, iRet, "could not start parser queue, parsing in main queue workers");
+            qqueueDestruct(&runConf->pParserQueue);
+            iRet = RS_RET_OK;
+        }
+    }
 finalize_it:
     RETiRet;
 }
@@ -1212,6 +1237,7 @@ static inline rsRetVal setUmask(int iUmask) {
 static void cleanupOldCnf(rsconf_t *cnf) {
     if (cnf == NULL) FINALIZE;
 
+    if (cnf->pParserQueue != NULL) qqueueDestruct(&cnf->pParserQueue);
     if (runConf->pMsgQueue != cnf->pMsgQueue) qqueueDestruct(&cnf->pMsgQueue);
 
 finalize_it:
@@ -1242,6 +1268,8 @@ static rsRetVal activate(rsconf_t *cnf) {
     if (cnf->globals.iMaxOpenFiles > 0) {
         CHKiRet(glblSetMaxOpenFiles(NULL, cnf->globals.iMaxOpenFiles));
     }
+    /* before any queue or action is started, as they create their histograms then */
+    msglatencyConfigure(cnf->globals.bLatencyStats, (unsigned)cnf->globals.latencySampling);
 
     /* the output part and the queue is now ready to run. So it is a good time
      * to initialize the inputs. Please note that the net code above should be
@@ -1346,6 +1374,9 @@ static rsRetVal setMainMsgQueType(void __attribute__((unused)) * pVal, uchar *ps
     } else if (!strcasecmp((char *)pszType, "linkedlist")) {
         loadConf->globals.mainQ.MainMsgQueType = QUEUETYPE_LINKEDLIST;
         DBGPRINTF("main message queue type set to LINKEDLIST\n");
+    } else if (!strcasecmp((char *)pszType, "ringbuffer")) {
+        loadConf->globals.mainQ.MainMsgQueType = QUEUETYPE_RINGBUFFER;
+        DBGPRINTF("main message queue type set to RINGBUFFER\n");
     } else if (!strcasecmp((char *)pszType, "disk")) {
         loadConf->globals.mainQ.MainMsgQueType = QUEUETYPE_DISK;
         DBGPRINTF("main message queue type set to DISK\n");
@@ -86,6 +86,7 @@ struct parsercnf_s {
     int bParserEscapeCCCStyle; /* escape control characters in c style: 0 - no, 1 - yes */
     int bPermitSlashInProgramname;
     int bParseHOSTNAMEandTAG; /* parser modification (based on startup params!) */
+    int iWorkerThreads; /* threads of the parse stage, 0: parse in the main/ruleset queue workers */
 };
 
 /* globals are data items that are really global, and can be set only
@@ -143,6 +144,9 @@ struct globals_s {
     int reportGoneAwaySenders;
     int senderStatsTimeout;
     int senderKeepTrack; /* keep track of known senders? */
+    int bLatencyStats; /* keep message latency histograms for queues and actions? */
+    int latencySampling; /* stamp only every n-th message for latency stats */
+    int bRulesetBatchExec; /* execute qualifying rulesets statement by statement for a batch? */
     int inputTimeoutShutdown; /* input shutdown timeout in ms */
     int iDefPFFamily; /* protocol family (IPv4, IPv6 or both) */
     int ACLAddHostnameOnFail; /* add hostname to acl when DNS resolving has failed */
@@ -171,6 +175,9 @@ struct globals_s {
 
     unsigned dnscacheDefaultTTL; /* 24 hrs default TTL */
     int dnscacheEnableTTL; /* expire entries or not (0) ? */
+    int dnscacheNegativeTTL; /* TTL of failed lookups, -1: same as dnscacheDefaultTTL */
+    int dnscacheResolverThreads; /* async resolver threads, 0: resolve in the caller */
+    int dnscachePublishIP; /* async: use the IP as name until the lookup completed? */
     int shutdownQueueDoubleSize;
     int optionDisallowWarning; /* complain if message from disallowed sender is received */
     int bSupportCompressionExtension;
@@ -290,6 +297,7 @@ struct rsconf_s {
          */
         timezones_t timezones;
         qqueue_t *pMsgQueue; /* the main message queue */
+        qqueue_t *pParserQueue; /* parse stage ahead of main and ruleset queues, NULL if not configured */
         ratelimit_cfgs_t ratelimit_cfgs;
 };
 
@@ -81,6 +81,7 @@
 #include "rswatch.h"
 #include "strgen.h"
 #include "statsobj.h"
+#include "msglatency.h"
 #include "atomic.h"
 #include "srUtils.h"
 
@@ -232,6 +233,8 @@ rsRetVal rsrtInit(const char **ppErrObj, obj_if_t *pObjIF) {
         CHKiRet(dynstatsClassInit());
         if (ppErrObj != NULL) *ppErrObj = "perctile_stats";
         CHKiRet(perctileClassInit());
+        if (ppErrObj != NULL) *ppErrObj = "msglatency";
+        CHKiRet(msglatencyClassInit());
 
         /* dummy "classes" */
         if (ppErrObj != NULL) *ppErrObj = "str";
@@ -259,6 +262,7 @@ rsRetVal rsrtExit(void) {
     if (iRefCount == 1) {
         /* do actual de-init only if we are the last runtime user */
         rswatchExit();
+        msgClassExit();
         confClassExit();
         glblClassExit();
         rulesetClassExit();
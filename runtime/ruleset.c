@@ -31,6 +31,8 @@
  */
 #include "config.h"
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include <assert.h>
 #include <ctype.h>
 
@@ -400,14 +402,15 @@ finalize_it:
     RETiRet;
 }
 
+static int evalPRIFILT(const struct cnfstmt *const stmt, const smsg_t *const pMsg) {
+    return !((stmt->d.s_prifilt.pmask[pMsg->iFacility] == TABLE_NOPRI) ||
+             ((stmt->d.s_prifilt.pmask[pMsg->iFacility] & (1 << pMsg->iSeverity)) == 0));
+}
+
 static rsRetVal execPRIFILT(struct cnfstmt *stmt, smsg_t *pMsg, wti_t *pWti) {
     int bRet;
     DEFiRet;
-    if ((stmt->d.s_prifilt.pmask[pMsg->iFacility] == TABLE_NOPRI) ||
-        ((stmt->d.s_prifilt.pmask[pMsg->iFacility] & (1 << pMsg->iSeverity)) == 0))
-        bRet = 0;
-    else
-        bRet = 1;
+    bRet = evalPRIFILT(stmt, pMsg);
 
     DBGPRINTF("PRIFILT condition result is %d\n", bRet);
     if (bRet) {
@@ -527,6 +530,54 @@ finalize_it:
     RETiRet;
 }
 
+/* execute a single statement for a single message */
+static rsRetVal ATTR_NONNULL(1, 2, 3) execStmt(struct cnfstmt *const stmt, smsg_t *const pMsg, wti_t *const pWti) {
+    DEFiRet;
+
+    switch (stmt->nodetype) {
+        case S_NOP:
+            break;
+        case S_STOP:
+            ABORT_FINALIZE(RS_RET_DISCARDMSG);
+            break;
+        case S_ACT:
+            CHKiRet(execAct(stmt, pMsg, pWti));
+            break;
+        case S_SET:
+            CHKiRet(execSet(stmt, pMsg, pWti));
+            break;
+        case S_UNSET:
+            CHKiRet(execUnset(stmt, pMsg));
+            break;
+        case S_CALL:
+            CHKiRet(execCall(stmt, pMsg, pWti));
+            break;
+        case S_CALL_INDIRECT:
+            CHKiRet(execCallIndirect(stmt, pMsg, pWti));
+            break;
+        case S_IF:
+            CHKiRet(execIf(stmt, pMsg, pWti));
+            break;
+        case S_FOREACH:
+            CHKiRet(execForeach(stmt, pMsg, pWti));
+            break;
+        case S_PRIFILT:
+            CHKiRet(execPRIFILT(stmt, pMsg, pWti));
+            break;
+        case S_PROPFILT:
+            CHKiRet(execPROPFILT(stmt, pMsg, pWti));
+            break;
+        case S_RELOAD_LOOKUP_TABLE:
+            CHKiRet(execReloadLookupTable(stmt));
+            break;
+        default:
+            dbgprintf("error: unknown stmt type %u during exec\n", (unsigned)stmt->nodetype);
+            break;
+    }
+finalize_it:
+    RETiRet;
+}
+
 /* The rainerscript execution engine. It is debatable if that would be better
  * contained in grammer/rainerscript.c, HOWEVER, that file focusses primarily
  * on the parsing and object creation part. So as an actual executor, it is
@@ -547,44 +598,199 @@ static rsRetVal ATTR_NONNULL(2, 3) scriptExec(struct cnfstmt *const root, smsg_t
         if (Debug) {
             cnfstmtPrintOnly(stmt, 2, 0);
         }
+        CHKiRet(execStmt(stmt, pMsg, pWti));
+    }
+finalize_it:
+    RETiRet;
+}
+
+
+/* Batch execution engine.
+ *
+ * scriptExec() walks the whole statement tree for one message before it looks
+ * at the next one. For rulesets where the order in which different messages
+ * pass the statements cannot be observed, processBatch() instead runs each
+ * statement for a run of consecutive messages before moving on to the next
+ * statement. The messages a statement applies to are tracked in a selection
+ * bitmap; filters split it into the bitmaps of their then and else branches
+ * and "stop" or a failing statement drops a message from it. This pays the
+ * statement dispatch once per batch instead of once per message and hands
+ * each action its messages back to back. Statements with their own
+ * per-message control flow (foreach, set, asynchronous calls, ...) are still
+ * executed one message at a time, but only for the selected messages.
+ *
+ * Every action still sees its messages in batch order. What differs is the
+ * interleaving of different actions, which is why batch execution must be
+ * enabled with the ruleset.batchExecution global and a ruleset only qualifies
+ * if nothing in it depends on what was executed for the previous message: see
+ * scriptBatchDepth().
+ *
+ * If a statement returns RS_RET_SUSPENDED for a message, that message and all
+ * later ones of the run leave the batch. The earlier ones complete batch-wise,
+ * then processBatch() executes the rest message by message from the suspended
+ * one on, retrying it in full as it always does. Statements the later messages
+ * had already passed are executed again for them.
+ */
+#define BATCH_SEL_BITS 64 /* bits per selection bitmap word */
+
+typedef struct batchExec_s {
+    batch_t *pBatch;
+    int first; /* index of the first batch element of this run */
+    int nMsgs; /* number of messages in this run */
+    int nActive; /* messages from this index on were cut off by a suspension */
+    int nWords; /* size of one selection bitmap in words */
+    uint64_t *scratch; /* then and else bitmap for every filter nesting level */
+    rsRetVal *ret; /* per message outcome, RS_RET_OK unless dropped */
+} batchExec_t;
+
+/* iterate over the message indexes selected in @p sel */
+#define FOREACH_SELECTED(be, sel, i)                                                          \
+    for (int w_ = 0; w_ < (be)->nWords; ++w_)                                                  \
+        for (uint64_t b_ = (sel)[w_]; b_ != 0 && ((i) = w_ * BATCH_SEL_BITS + __builtin_ctzll(b_), 1); \
+             b_ &= b_ - 1)
+
+static inline smsg_t *batchExecMsg(const batchExec_t *const be, const int i) {
+    return be->pBatch->pElem[be->first + i].pMsg;
+}
+
+static inline void batchSelSet(uint64_t *const sel, const int i) {
+    sel[i / BATCH_SEL_BITS] |= (uint64_t)1 << (i % BATCH_SEL_BITS);
+}
+
+static inline int batchSelIsEmpty(const batchExec_t *const be, const uint64_t *const sel) {
+    for (int w = 0; w < be->nWords; ++w) {
+        if (sel[w] != 0) return 0;
+    }
+    return 1;
+}
+
+/* remove message @p i from @p sel for the rest of the ruleset */
+static inline void batchExecDrop(batchExec_t *const be, uint64_t *const sel, const int i, const rsRetVal ret) {
+    be->ret[i] = ret;
+    sel[i / BATCH_SEL_BITS] &= ~((uint64_t)1 << (i % BATCH_SEL_BITS));
+}
+
+/* clear the messages cut off by batchExecCut() from @p sel */
+static inline void batchSelTrim(const batchExec_t *const be, uint64_t *const sel) {
+    if (be->nActive >= be->nMsgs) return;
+    const int w = be->nActive / BATCH_SEL_BITS;
+    sel[w] &= ((uint64_t)1 << (be->nActive % BATCH_SEL_BITS)) - 1;
+    for (int j = w + 1; j < be->nWords; ++j) sel[j] = 0;
+}
+
+/* Leave message @p i and all later ones of the run to message by message
+ * execution. Selections of outer nesting levels are trimmed when execution
+ * returns to them.
+ */
+static inline void batchExecCut(batchExec_t *const be, uint64_t *const sel, const int i) {
+    be->nActive = i;
+    batchSelTrim(be, sel);
+}
+
+static rsRetVal scriptExecBatch(struct cnfstmt *const root, batchExec_t *const be, uint64_t *const sel, const int level,
+                                wti_t *const pWti);
+
+/* Run the branches of a filter at nesting @p level. The caller has set the
+ * messages to take the then branch in the level's first scratch bitmap. On
+ * return, @p sel holds the messages that are still active.
+ */
+static rsRetVal ATTR_NONNULL(3, 4, 6) execBranchesBatch(struct cnfstmt *const t_then,
+                                                        struct cnfstmt *const t_else,
+                                                        batchExec_t *const be,
+                                                        uint64_t *const sel,
+                                                        const int level,
+                                                        wti_t *const pWti) {
+    uint64_t *const thenSel = be->scratch + 2 * level * be->nWords;
+    uint64_t *const elseSel = thenSel + be->nWords;
+    DEFiRet;
+
+    for (int w = 0; w < be->nWords; ++w) elseSel[w] = sel[w] & ~thenSel[w];
+    if (t_then != NULL) CHKiRet(scriptExecBatch(t_then, be, thenSel, level + 1, pWti));
+    if (t_else != NULL) CHKiRet(scriptExecBatch(t_else, be, elseSel, level + 1, pWti));
+    for (int w = 0; w < be->nWords; ++w) sel[w] = thenSel[w] | elseSel[w];
+finalize_it:
+    RETiRet;
+}
+
+/* Execute the statements starting at @p root for all messages selected in
+ * @p sel. Per-message errors drop the message; only a forced termination is
+ * returned to the caller.
+ */
+static rsRetVal ATTR_NONNULL(2, 3, 5) scriptExecBatch(struct cnfstmt *const root,
+                                                      batchExec_t *const be,
+                                                      uint64_t *const sel,
+                                                      const int level,
+                                                      wti_t *const pWti) {
+    struct cnfstmt *stmt;
+    uint64_t *const thenSel = be->scratch + 2 * level * be->nWords;
+    rsRetVal localRet;
+    int i;
+    DEFiRet;
+
+    for (stmt = root; stmt != NULL; stmt = stmt->next) {
+        batchSelTrim(be, sel);
+        if (batchSelIsEmpty(be, sel)) break;
+        if (wtiIsShutdownImmediate(pWti)) {
+            DBGPRINTF(
+                "scriptExecBatch: ShutdownImmediate set, "
+                "force terminating\n");
+            ABORT_FINALIZE(RS_RET_FORCE_TERM);
+        }
+        if (Debug) {
+            cnfstmtPrintOnly(stmt, 2, 0);
+        }
         switch (stmt->nodetype) {
             case S_NOP:
                 break;
             case S_STOP:
-                ABORT_FINALIZE(RS_RET_DISCARDMSG);
-                break;
-            case S_ACT:
-                CHKiRet(execAct(stmt, pMsg, pWti));
-                break;
-            case S_SET:
-                CHKiRet(execSet(stmt, pMsg, pWti));
-                break;
-            case S_UNSET:
-                CHKiRet(execUnset(stmt, pMsg));
-                break;
-            case S_CALL:
-                CHKiRet(execCall(stmt, pMsg, pWti));
-                break;
-            case S_CALL_INDIRECT:
-                CHKiRet(execCallIndirect(stmt, pMsg, pWti));
+                FOREACH_SELECTED(be, sel, i) {
+                    batchExecDrop(be, sel, i, RS_RET_DISCARDMSG);
+                }
                 break;
             case S_IF:
-                CHKiRet(execIf(stmt, pMsg, pWti));
-                break;
-            case S_FOREACH:
-                CHKiRet(execForeach(stmt, pMsg, pWti));
+                memset(thenSel, 0, be->nWords * sizeof(uint64_t));
+                FOREACH_SELECTED(be, sel, i) {
+                    if (cnfexprEvalBool(stmt->d.s_if.expr, batchExecMsg(be, i), pWti)) batchSelSet(thenSel, i);
+                }
+                CHKiRet(execBranchesBatch(stmt->d.s_if.t_then, stmt->d.s_if.t_else, be, sel, level, pWti));
                 break;
             case S_PRIFILT:
-                CHKiRet(execPRIFILT(stmt, pMsg, pWti));
+                memset(thenSel, 0, be->nWords * sizeof(uint64_t));
+                FOREACH_SELECTED(be, sel, i) {
+                    if (evalPRIFILT(stmt, batchExecMsg(be, i))) batchSelSet(thenSel, i);
+                }
+                CHKiRet(execBranchesBatch(stmt->d.s_prifilt.t_then, stmt->d.s_prifilt.t_else, be, sel, level, pWti));
                 break;
             case S_PROPFILT:
-                CHKiRet(execPROPFILT(stmt, pMsg, pWti));
-                break;
-            case S_RELOAD_LOOKUP_TABLE:
-                CHKiRet(execReloadLookupTable(stmt));
+                memset(thenSel, 0, be->nWords * sizeof(uint64_t));
+                FOREACH_SELECTED(be, sel, i) {
+                    if (evalPROPFILT(stmt, batchExecMsg(be, i))) batchSelSet(thenSel, i);
+                }
+                CHKiRet(execBranchesBatch(stmt->d.s_propfilt.t_then, NULL, be, sel, level, pWti));
                 break;
+            case S_CALL:
+                if (stmt->d.s_call.ruleset == NULL) {
+                    if (rulesetCallDepthExceeded(pWti, (const char *)es_getBufAddr(stmt->d.s_call.name),
+                                                 es_strlen(stmt->d.s_call.name))) {
+                        break;
+                    }
+                    ++pWti->execState.rulesetCallDepth;
+                    localRet = scriptExecBatch(stmt->d.s_call.stmt, be, sel, level, pWti);
+                    --pWti->execState.rulesetCallDepth;
+                    CHKiRet(localRet);
+                    break;
+                }
+                /* a ruleset with its own queue gets a copy of every message */
+                CASE_FALLTHROUGH
             default:
-                dbgprintf("error: unknown stmt type %u during exec\n", (unsigned)stmt->nodetype);
+                FOREACH_SELECTED(be, sel, i) {
+                    localRet = execStmt(stmt, batchExecMsg(be, i), pWti);
+                    if (localRet == RS_RET_SUSPENDED) {
+                        batchExecCut(be, sel, i);
+                        break; /* later bits of this word; later words are cleared */
+                    }
+                    if (localRet != RS_RET_OK) batchExecDrop(be, sel, i, localRet);
+                }
                 break;
         }
     }
@@ -592,12 +798,65 @@ finalize_it:
     RETiRet;
 }
 
+/* Execute @p pRuleset for the @p nMsgs consecutive messages starting at batch
+ * element @p first and mark the ones that completed as committed. On return,
+ * @p pnDone holds the number of messages handled; if it is less than @p nMsgs,
+ * the message at that offset was suspended and it and the rest of the run are
+ * left to the caller. Returns an error without having executed anything if
+ * memory is short, so that the caller can fall back to message by message
+ * execution.
+ */
+static rsRetVal ATTR_NONNULL() scriptExecBatchRun(ruleset_t *const pRuleset,
+                                                  batch_t *const pBatch,
+                                                  const int first,
+                                                  const int nMsgs,
+                                                  int *const pnDone,
+                                                  wti_t *const pWti) {
+    batchExec_t be;
+    uint64_t *sel = NULL;
+    int i;
+    DEFiRet;
+
+    be.pBatch = pBatch;
+    be.first = first;
+    be.nMsgs = be.nActive = nMsgs;
+    be.nWords = (nMsgs + BATCH_SEL_BITS - 1) / BATCH_SEL_BITS;
+    const size_t nSelWords = (size_t)be.nWords * (1 + 2 * pRuleset->batchExecDepth);
+    CHKmalloc(sel = malloc(nSelWords * sizeof(uint64_t) + nMsgs * sizeof(rsRetVal)));
+    be.scratch = sel + be.nWords;
+    be.ret = (rsRetVal *)(sel + nSelWords);
+
+    memset(sel, 0, be.nWords * sizeof(uint64_t));
+    for (i = 0; i < nMsgs; ++i) {
+        be.ret[i] = RS_RET_OK;
+        batchSelSet(sel, i);
+    }
+
+    DBGPRINTF("processBATCH: executing ruleset '%s' for messages %d..%d at once\n", pRuleset->pszName, first,
+              first + nMsgs - 1);
+    CHKiRet(scriptExecBatch(pRuleset->root, &be, sel, 0, pWti));
+
+    for (i = 0; i < be.nActive && !wtiIsShutdownImmediate(pWti); ++i) {
+        if (be.ret[i] == RS_RET_OK) batchSetElemState(pBatch, first + i, BATCH_STATE_COMM);
+    }
+    *pnDone = be.nActive;
+
+finalize_it:
+    free(sel);
+    RETiRet;
+}
+
 
 /* Process (consume) a batch of messages. Calls the actions configured.
- * This is called by MAIN queues.
+ * This is called by MAIN queues. Runs of consecutive messages bound to the
+ * same batch-capable ruleset are executed statement by statement, everything
+ * else message by message.
  */
 static rsRetVal processBatch(batch_t *pBatch, wti_t *pWti) {
     int i;
+    int nRun;
+    int nDone;
+    int iMsgByMsgEnd = 0; /* elements before this index are not batched again */
     smsg_t *pMsg;
     ruleset_t *pRuleset;
     rsRetVal localRet;
@@ -610,8 +869,24 @@ static rsRetVal processBatch(batch_t *pBatch, wti_t *pWti) {
     /* execution phase */
     for (i = 0; i < batchNumMsgs(pBatch) && !wtiIsShutdownImmediate(pWti); ++i) {
         pMsg = pBatch->pElem[i].pMsg;
-        DBGPRINTF("processBATCH: next msg %d: %.128s\n", i, pMsg->pszRawMsg);
         pRuleset = (pMsg->pRuleset == NULL) ? runConf->rulesets.pDflt : pMsg->pRuleset;
+        if (pRuleset->batchExecDepth >= 0 && i >= iMsgByMsgEnd) {
+            for (nRun = 1; i + nRun < batchNumMsgs(pBatch); ++nRun) {
+                const smsg_t *const pNext = pBatch->pElem[i + nRun].pMsg;
+                if (((pNext->pRuleset == NULL) ? runConf->rulesets.pDflt : pNext->pRuleset) != pRuleset) break;
+            }
+            if (nRun > 1 && scriptExecBatchRun(pRuleset, pBatch, i, nRun, &nDone, pWti) == RS_RET_OK) {
+                if (nDone == nRun) {
+                    i += nRun - 1;
+                    continue;
+                }
+                /* suspended: continue message by message from there on */
+                iMsgByMsgEnd = i + nRun;
+                i += nDone;
+                pMsg = pBatch->pElem[i].pMsg;
+            }
+        }
+        DBGPRINTF("processBATCH: next msg %d: %.128s\n", i, pMsg->pszRawMsg);
         localRet = scriptExec(pRuleset->root, pMsg, pWti);
         /* the most important case here is that processing may be aborted
          * due to pbShutdownImmediate, in which case we MUST NOT flag this
@@ -739,6 +1014,7 @@ finalize_it:
 BEGINobjConstruct(ruleset) /* be sure to specify the object type also in END macro! */
     pThis->root = NULL;
     pThis->last = NULL;
+    pThis->batchExecDepth = -1;
 ENDobjConstruct(ruleset)
 
 
@@ -879,12 +1155,135 @@ DEFFUNC_llExecFunc(doRulesetOptimizeAll) {
     rulesetOptimize((ruleset_t *)pData);
     return RS_RET_OK;
 }
+
+static int isGlobalVarName(const uchar *const name) {
+    propid_t propid;
+    return propNameToID(name, &propid) == RS_RET_OK && propid == PROP_GLOBAL_VAR;
+}
+
+/* check if the statements starting at @p root assign or unset a global variable */
+static int scriptWritesGlobalVar(const struct cnfstmt *const root) {
+    const struct cnfstmt *stmt;
+
+    for (stmt = root; stmt != NULL; stmt = stmt->next) {
+        switch (stmt->nodetype) {
+            case S_SET:
+                if (isGlobalVarName(stmt->d.s_set.varname)) return 1;
+                break;
+            case S_UNSET:
+                if (isGlobalVarName(stmt->d.s_unset.varname)) return 1;
+                break;
+            case S_FOREACH:
+                if (isGlobalVarName((uchar *)stmt->d.s_foreach.iter->var) ||
+                    scriptWritesGlobalVar(stmt->d.s_foreach.body))
+                    return 1;
+                break;
+            case S_IF:
+                if (scriptWritesGlobalVar(stmt->d.s_if.t_then) || scriptWritesGlobalVar(stmt->d.s_if.t_else))
+                    return 1;
+                break;
+            case S_PRIFILT:
+                if (scriptWritesGlobalVar(stmt->d.s_prifilt.t_then) || scriptWritesGlobalVar(stmt->d.s_prifilt.t_else))
+                    return 1;
+                break;
+            case S_PROPFILT:
+                if (scriptWritesGlobalVar(stmt->d.s_propfilt.t_then)) return 1;
+                break;
+            default:
+                break;
+        }
+    }
+    return 0;
+}
+
+#define BATCH_EXEC_MAX_CALL_DEPTH 16 /* deeper (or recursive) call chains run message by message */
+
+/* Return the filter nesting depth scriptExecBatch() needs scratch bitmaps for
+ * when executing the statements starting at @p root, or -1 if they must be
+ * executed message by message because something in them observes what was
+ * executed for the previous message: an action that only runs if the previous
+ * one was suspended, a function reporting per-worker state of the previous
+ * statement or an indirect call, whose target is not known up front. Global
+ * variables are checked config-wide by the caller.
+ */
+static int scriptBatchDepth(const struct cnfstmt *const root, const int callDepth) {
+    const struct cnfstmt *stmt;
+    int depth = 0;
+    int d, dElse;
+
+    for (stmt = root; stmt != NULL; stmt = stmt->next) {
+        d = 0;
+        switch (stmt->nodetype) {
+            case S_IF:
+                if (cnfexprNeedsMsgOrder(stmt->d.s_if.expr)) return -1;
+                if ((d = scriptBatchDepth(stmt->d.s_if.t_then, callDepth)) < 0) return -1;
+                if ((dElse = scriptBatchDepth(stmt->d.s_if.t_else, callDepth)) < 0) return -1;
+                d = 1 + ((d > dElse) ? d : dElse);
+                break;
+            case S_PRIFILT:
+                if ((d = scriptBatchDepth(stmt->d.s_prifilt.t_then, callDepth)) < 0) return -1;
+                if ((dElse = scriptBatchDepth(stmt->d.s_prifilt.t_else, callDepth)) < 0) return -1;
+                d = 1 + ((d > dElse) ? d : dElse);
+                break;
+            case S_PROPFILT:
+                if ((d = scriptBatchDepth(stmt->d.s_propfilt.t_then, callDepth)) < 0) return -1;
+                ++d;
+                break;
+            case S_SET:
+                if (cnfexprNeedsMsgOrder(stmt->d.s_set.expr)) return -1;
+                break;
+            case S_FOREACH:
+                /* the body runs message by message, but must not look back either */
+                if (cnfexprNeedsMsgOrder(stmt->d.s_foreach.iter->collection) ||
+                    scriptBatchDepth(stmt->d.s_foreach.body, callDepth) < 0)
+                    return -1;
+                break;
+            case S_CALL:
+                if (stmt->d.s_call.ruleset == NULL) {
+                    if (callDepth >= BATCH_EXEC_MAX_CALL_DEPTH) return -1;
+                    if ((d = scriptBatchDepth(stmt->d.s_call.stmt, callDepth + 1)) < 0) return -1;
+                }
+                break;
+            case S_CALL_INDIRECT:
+                return -1;
+            case S_ACT:
+                if (stmt->d.act->bExecWhenPrevSusp) return -1;
+                break;
+            default:
+                break;
+        }
+        if (d > depth) depth = d;
+    }
+    return depth;
+}
+
+/* helper for rulesetOptimizeAll() */
+DEFFUNC_llExecFunc(doRulesetChkGlobalVarWrite) {
+    if (scriptWritesGlobalVar(((ruleset_t *)pData)->root)) *(int *)pParam = 1;
+    return RS_RET_OK;
+}
+
+/* helper for rulesetOptimizeAll(), decides if a ruleset can run batch-wise */
+DEFFUNC_llExecFunc(doRulesetSetBatchExec) {
+    ruleset_t *const pRuleset = (ruleset_t *)pData;
+    pRuleset->batchExecDepth = *(int *)pParam ? -1 : scriptBatchDepth(pRuleset->root, 0);
+    DBGPRINTF("ruleset '%s' executes %s\n", pRuleset->pszName,
+              (pRuleset->batchExecDepth < 0) ? "message by message" : "batch-wise");
+    return RS_RET_OK;
+}
+
 /* optimize all rulesets
  */
 rsRetVal rulesetOptimizeAll(rsconf_t *conf) {
+    int bMsgByMsg = !conf->globals.bRulesetBatchExec;
     DEFiRet;
     dbgprintf("begin ruleset optimization phase\n");
     llExecFunc(&(conf->rulesets.llRulesets), doRulesetOptimizeAll, NULL);
+    /* global variables are shared by all messages, so any write to one
+     * makes the order of messages observable wherever they are read
+     */
+    if (!bMsgByMsg) llExecFunc(&(conf->rulesets.llRulesets), doRulesetChkGlobalVarWrite, &bMsgByMsg);
+    llExecFunc(&(conf->rulesets.llRulesets), doRulesetSetBatchExec, &bMsgByMsg);
     dbgprintf("ruleset optimization phase finished.\n");
     RETiRet;
 }
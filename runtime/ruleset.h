@@ -36,6 +36,7 @@ struct ruleset_s {
         struct cnfstmt *root;
         struct cnfstmt *last;
         parserList_t *pParserLst; /* list of parsers to use for this ruleset */
+        int batchExecDepth; /* filter nesting depth for batch execution, -1: run message by message */
 };
 
 /* interfaces */
@@ -0,0 +1,1040 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file rxset.c
+ * @brief Multi-regex DFA behind regex lookup tables.
+ *
+ * Every regex is parsed into a small syntax tree and emitted into one shared
+ * Thompson NFA whose match node carries the regex index. Because matches may
+ * start anywhere, every DFA state implicitly contains S, the closure of all
+ * regex start nodes, and every state entered on byte class c contains T[c],
+ * the closure of the moves out of S on c. A DFA state is therefore stored as
+ * the class it was entered on plus the set R of NFA nodes it holds beyond S
+ * and T. That keeps the sets small even for thousands of regexes. Byte
+ * classes group bytes that no bracket expression or literal distinguishes.
+ *
+ * Assertions are resolved during closure: "^" is only passed in the start
+ * state (without REG_NEWLINE it only matches at offset 0), "$" is kept as a
+ * blocked node and only passed when the end of the subject is reached, which
+ * is what the per-state eolAcc value precomputes.
+ *
+ * Matches are recorded on the transitions, not in the states: each
+ * transition carries the lowest regex index that matches when it is taken,
+ * and match nodes are dropped from the state sets. Otherwise every regex
+ * matching right before a restart (say, at a space) would create its own copy
+ * of the state after the restart, which for large tables multiplies the
+ * number of states by the number of regexes.
+ */
+#include "config.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rxset.h"
+
+#define RXSET_MAX_NFA (1024 * 1024) /**< NFA nodes over all regexes */
+#define RXSET_MAX_REPEAT 255 /**< largest bound of {m,n} we expand */
+#define RXSET_MAX_DEPTH 64 /**< group nesting we parse */
+#define RXSET_MAX_ANCHORED_AST 4096 /**< syntax tree size up to which we check anchors */
+#define RXSET_MAX_STATES (256 * 1024) /**< DFA states */
+#define RXSET_MAX_TABLE (4 * 1024 * 1024) /**< DFA transitions (8 bytes each) */
+#define RXSET_MAX_POOL (8 * 1024 * 1024) /**< NFA node ids kept while building */
+#define RXSET_MAX_WORK (64 * 1024 * 1024) /**< NFA nodes processed while building, bounds build time */
+#define RXSET_NOACC INT32_MAX
+
+typedef enum { NFA_BYTES, NFA_SPLIT, NFA_BOL, NFA_EOL, NFA_MATCH } nfaType_t;
+
+typedef struct nfaNode_s {
+    uint8_t type;
+    int32_t out; /**< successor; for NFA_MATCH: regex index */
+    int32_t out1; /**< NFA_SPLIT: second successor; NFA_BYTES: byte set */
+} nfaNode_t;
+
+typedef enum { AST_SET, AST_EMPTY, AST_BOL, AST_EOL, AST_CAT, AST_ALT, AST_REP } astType_t;
+
+typedef struct astNode_s {
+    uint8_t type;
+    uint8_t bConsumes; /**< may match at least one byte */
+    int32_t l; /**< AST_SET: byte set */
+    int32_t r;
+    int32_t min, max; /**< AST_REP, max -1 = unbounded */
+} astNode_t;
+
+typedef uint32_t byteset_t[8];
+
+struct rxset_s {
+    int nRegex;
+    /* build state, freed by rxsetCompile() */
+    nfaNode_t *nfa;
+    int nNfa;
+    int maxNfa;
+    byteset_t *sets;
+    int nSets;
+    int maxSets;
+    int32_t *starts; /**< per regex start node, -1 if not compiled */
+    int maxStarts;
+    int nCompiled;
+    /* compiled DFA */
+    int nClasses;
+    int nStates;
+    unsigned char byteClass[256];
+    int32_t *delta; /**< nStates * nClasses, -1 = state not built */
+    int32_t *acc; /**< per transition: lowest regex index matching on taking it */
+    int32_t *eolAcc; /**< per state: same if the subject ends in the state */
+    int32_t startAcc; /**< lowest regex index matching the empty prefix */
+};
+
+typedef struct parser_s {
+    rxset_t *rx;
+    const unsigned char *p;
+    astNode_t *ast;
+    int nAst;
+    int maxAst;
+    int nAnchors;
+    int bUnsupported;
+    int bNoMem;
+} parser_t;
+
+static inline int bsetHas(const uint32_t *const set, const unsigned c) {
+    return (set[c >> 5] >> (c & 31)) & 1;
+}
+
+static inline void bsetAdd(uint32_t *const set, const unsigned c) {
+    set[c >> 5] |= 1u << (c & 31);
+}
+
+
+/* ---------------------------------------------------------------- parser */
+
+static int newAst(parser_t *const p, const astType_t type, const int32_t l, const int32_t r) {
+    if (p->nAst == p->maxAst) {
+        const int newMax = (p->maxAst == 0) ? 64 : 2 * p->maxAst;
+        astNode_t *const n = realloc(p->ast, newMax * sizeof(astNode_t));
+        if (n == NULL) {
+            p->bNoMem = 1;
+            return -1;
+        }
+        p->ast = n;
+        p->maxAst = newMax;
+    }
+    p->ast[p->nAst].type = type;
+    p->ast[p->nAst].l = l;
+    p->ast[p->nAst].r = r;
+    p->ast[p->nAst].min = p->ast[p->nAst].max = 0;
+    p->ast[p->nAst].bConsumes =
+        (type == AST_SET) || ((type == AST_CAT || type == AST_ALT) && (p->ast[l].bConsumes || p->ast[r].bConsumes));
+    return p->nAst++;
+}
+
+static int newSet(parser_t *const p, const uint32_t *const bits) {
+    rxset_t *const rx = p->rx;
+    if (rx->nSets == rx->maxSets) {
+        const int newMax = (rx->maxSets == 0) ? 256 : 2 * rx->maxSets;
+        byteset_t *const n = realloc(rx->sets, newMax * sizeof(byteset_t));
+        if (n == NULL) {
+            p->bNoMem = 1;
+            return -1;
+        }
+        rx->sets = n;
+        rx->maxSets = newMax;
+    }
+    memcpy(rx->sets[rx->nSets], bits, sizeof(byteset_t));
+    return newAst(p, AST_SET, rx->nSets++, -1);
+}
+
+static int unsupported(parser_t *const p) {
+    p->bUnsupported = 1;
+    return -1;
+}
+
+/* character classes as defined for the C locale */
+static int addClass(uint32_t *const bits, const char *const name, const size_t len) {
+    static const struct {
+        const char *name;
+        const char *ranges; /* pairs of inclusive bounds */
+    } classes[] = {{"alpha", "AZaz"},
+                   {"digit", "09"},
+                   {"alnum", "09AZaz"},
+                   {"upper", "AZ"},
+                   {"lower", "az"},
+                   {"space", "\t\r  "},
+                   {"blank", "\t\t  "},
+                   {"punct", "!/:@[`{~"},
+                   {"print", " ~"},
+                   {"graph", "!~"},
+                   {"cntrl", "\x01\x1f\x7f\x7f"},
+                   {"xdigit", "09AFaf"}};
+
+    for (size_t i = 0; i < sizeof(classes) / sizeof(classes[0]); ++i) {
+        if (strlen(classes[i].name) != len || memcmp(classes[i].name, name, len) != 0) continue;
+        for (const char *r = classes[i].ranges; *r != '\0'; r += 2) {
+            for (unsigned c = (unsigned char)r[0]; c <= (unsigned char)r[1]; ++c) bsetAdd(bits, c);
+        }
+        return 1;
+    }
+    return 0;
+}
+
+/* p->p points behind the opening '[' */
+static int parseBracket(parser_t *const p) {
+    uint32_t bits[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    int bNegate = 0;
+    int bFirst = 1;
+
+    if (*p->p == '^') {
+        bNegate = 1;
+        ++p->p;
+    }
+    for (;;) {
+        const unsigned char c = *p->p;
+        if (c == '\0' || c >= 0x80) return unsupported(p);
+        if (c == ']' && !bFirst) {
+            ++p->p;
+            break;
+        }
+        bFirst = 0;
+        if (c == '[' && (p->p[1] == '.' || p->p[1] == '=')) return unsupported(p);
+        if (c == '[' && p->p[1] == ':') {
+            const char *const name = (const char *)p->p + 2;
+            const char *const end = strstr(name, ":]");
+            if (end == NULL || !addClass(bits, name, end - name)) return unsupported(p);
+            p->p = (const unsigned char *)end + 2;
+            continue;
+        }
+        ++p->p;
+        if (*p->p == '-' && p->p[1] != ']' && p->p[1] != '\0') {
+            const unsigned char hi = p->p[1];
+            if (hi == '[' || hi >= 0x80 || hi < c) return unsupported(p);
+            for (unsigned b = c; b <= hi; ++b) bsetAdd(bits, b);
+            p->p += 2;
+        } else {
+            bsetAdd(bits, c);
+        }
+    }
+    if (bNegate) {
+        for (int i = 0; i < 8; ++i) bits[i] = ~bits[i];
+    }
+    bits[0] &= ~1u; /* NUL never matches */
+    return newSet(p, bits);
+}
+
+static int parseAlt(parser_t *p, int depth);
+
+static int parseAtom(parser_t *const p, const int depth) {
+    uint32_t bits[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    const unsigned char c = *p->p;
+    int a;
+
+    switch (c) {
+        case '(':
+            if (depth >= RXSET_MAX_DEPTH) return unsupported(p);
+            ++p->p;
+            if (*p->p == ')') {
+                ++p->p;
+                return newAst(p, AST_EMPTY, -1, -1);
+            }
+            if ((a = parseAlt(p, depth + 1)) < 0) return -1;
+            if (*p->p != ')') return unsupported(p);
+            ++p->p;
+            return a;
+        case '.':
+            ++p->p;
+            memset(bits, 0xff, sizeof(bits));
+            bits[0] &= ~1u;
+            return newSet(p, bits);
+        case '[':
+            ++p->p;
+            return parseBracket(p);
+        case '^':
+            ++p->p;
+            ++p->nAnchors;
+            return newAst(p, AST_BOL, -1, -1);
+        case '$':
+            ++p->p;
+            ++p->nAnchors;
+            return newAst(p, AST_EOL, -1, -1);
+        case '\\':
+            /* only escaped operators; GNU escapes and back-references are not ours */
+            if (p->p[1] == '\0' || strchr("^.[]$()|*+?{}\\", p->p[1]) == NULL) return unsupported(p);
+            bsetAdd(bits, p->p[1]);
+            p->p += 2;
+            return newSet(p, bits);
+        case '*':
+        case '+':
+        case '?':
+        case '{':
+            return unsupported(p);
+        default:
+            if (c >= 0x80) return unsupported(p);
+            bsetAdd(bits, c);
+            ++p->p;
+            return newSet(p, bits);
+    }
+}
+
+static int parseBound(parser_t *const p) {
+    int n = 0;
+    if (*p->p < '0' || *p->p > '9') return -1;
+    while (*p->p >= '0' && *p->p <= '9') {
+        n = n * 10 + (*p->p++ - '0');
+        if (n > RXSET_MAX_REPEAT) return -1;
+    }
+    return n;
+}
+
+static int parseRep(parser_t *const p, const int depth) {
+    int a;
+    int min, max;
+
+    if ((a = parseAtom(p, depth)) < 0) return -1;
+    while (*p->p == '*' || *p->p == '+' || *p->p == '?' || *p->p == '{') {
+        if (p->ast[a].type == AST_BOL || p->ast[a].type == AST_EOL) return unsupported(p);
+        switch (*p->p++) {
+            case '*':
+                min = 0;
+                max = -1;
+                break;
+            case '+':
+                min = 1;
+                max = -1;
+                break;
+            case '?':
+                min = 0;
+                max = 1;
+                break;
+            default: /* '{' */
+                if ((min = parseBound(p)) < 0) return unsupported(p);
+                max = min;
+                if (*p->p == ',') {
+                    ++p->p;
+                    if (*p->p == '}') {
+                        max = -1;
+                    } else if ((max = parseBound(p)) < 0) {
+                        return unsupported(p);
+                    }
+                }
+                if (*p->p != '}' || (max != -1 && max < min)) return unsupported(p);
+                ++p->p;
+                break;
+        }
+        if ((a = newAst(p, AST_REP, a, -1)) < 0) return -1;
+        p->ast[a].min = min;
+        p->ast[a].max = max;
+        p->ast[a].bConsumes = (max != 0) && p->ast[p->ast[a].l].bConsumes;
+    }
+    return a;
+}
+
+static int parseCat(parser_t *const p, const int depth) {
+    int l = -1;
+    int r;
+
+    while (*p->p != '\0' && *p->p != '|' && *p->p != ')') {
+        if ((r = parseRep(p, depth)) < 0) return -1;
+        if (l != -1 && (r = newAst(p, AST_CAT, l, r)) < 0) return -1;
+        l = r;
+    }
+    /* empty alternatives and unmatched ')' are left to regexec() */
+    if (l == -1 || (*p->p == ')' && depth == 0)) return unsupported(p);
+    return l;
+}
+
+static int parseAlt(parser_t *const p, const int depth) {
+    int l;
+    int r;
+
+    if ((l = parseCat(p, depth)) < 0) return -1;
+    while (*p->p == '|') {
+        ++p->p;
+        if ((r = parseCat(p, depth)) < 0) return -1;
+        if ((l = newAst(p, AST_ALT, l, r)) < 0) return -1;
+    }
+    return l;
+}
+
+
+/* glibc's regexec() considers "^" satisfied behind a newline the regex itself
+ * matched, and "$" in front of one, even without REG_NEWLINE. We only compile
+ * anchors where that cannot happen: "^" with nothing matchable before it and
+ * "$" with nothing matchable behind it. Both then simply mean start and end
+ * of the subject. bBefore/bAfter tell if bytes may be matched before/after a.
+ */
+static int anchorsPlain(const parser_t *const p, const int a, const int bBefore, const int bAfter) {
+    const astNode_t *const node = &p->ast[a];
+    int bSelf;
+
+    switch ((astType_t)node->type) {
+        case AST_BOL:
+            return !bBefore;
+        case AST_EOL:
+            return !bAfter;
+        case AST_CAT:
+            return anchorsPlain(p, node->l, bBefore, bAfter || p->ast[node->r].bConsumes) &&
+                   anchorsPlain(p, node->r, bBefore || p->ast[node->l].bConsumes, bAfter);
+        case AST_ALT:
+            return anchorsPlain(p, node->l, bBefore, bAfter) && anchorsPlain(p, node->r, bBefore, bAfter);
+        case AST_REP:
+            /* a repeated body may follow and precede itself */
+            bSelf = (node->max == -1 || node->max > 1) && p->ast[node->l].bConsumes;
+            return anchorsPlain(p, node->l, bBefore || bSelf, bAfter || bSelf);
+        case AST_SET:
+        case AST_EMPTY:
+        default:
+            return 1;
+    }
+}
+
+
+/* ---------------------------------------------------------------- NFA emission */
+
+static int32_t newNfa(parser_t *const p, const nfaType_t type, const int32_t out, const int32_t out1) {
+    rxset_t *const rx = p->rx;
+    if (rx->nNfa == rx->maxNfa) {
+        if (rx->maxNfa >= RXSET_MAX_NFA) {
+            p->bUnsupported = 1;
+            return -1;
+        }
+        const int newMax = (rx->maxNfa == 0) ? 1024 : 2 * rx->maxNfa;
+        nfaNode_t *const n = realloc(rx->nfa, newMax * sizeof(nfaNode_t));
+        if (n == NULL) {
+            p->bNoMem = 1;
+            return -1;
+        }
+        rx->nfa = n;
+        rx->maxNfa = newMax;
+    }
+    rx->nfa[rx->nNfa].type = type;
+    rx->nfa[rx->nNfa].out = out;
+    rx->nfa[rx->nNfa].out1 = out1;
+    return rx->nNfa++;
+}
+
+/* emit the NFA for AST node a, continuing at next; built back to front so
+ * that no patch lists are needed. Returns the entry node or -1.
+ */
+static int32_t emit(parser_t *const p, int a, int32_t next) {
+    astNode_t node = p->ast[a];
+    int32_t s, body;
+
+    switch ((astType_t)node.type) {
+        case AST_SET:
+            return newNfa(p, NFA_BYTES, next, node.l);
+        case AST_EMPTY:
+            return next;
+        case AST_BOL:
+            return newNfa(p, NFA_BOL, next, -1);
+        case AST_EOL:
+            return newNfa(p, NFA_EOL, next, -1);
+        case AST_CAT:
+            /* concatenations are left-deep; walk the spine instead of recursing */
+            do {
+                if ((next = emit(p, node.r, next)) < 0) return -1;
+                a = node.l;
+                node = p->ast[a];
+            } while (node.type == AST_CAT);
+            return emit(p, a, next);
+        case AST_ALT:
+            s = -1;
+            do {
+                if ((body = emit(p, node.r, next)) < 0) return -1;
+                if (s != -1 && (body = newNfa(p, NFA_SPLIT, body, s)) < 0) return -1;
+                s = body;
+                a = node.l;
+                node = p->ast[a];
+            } while (node.type == AST_ALT);
+            if ((body = emit(p, a, next)) < 0) return -1;
+            return newNfa(p, NFA_SPLIT, body, s);
+        case AST_REP:
+            if (node.max == -1) {
+                /* x* loops through a split node; x{m,} = x...x x* */
+                if ((s = newNfa(p, NFA_SPLIT, -1, next)) < 0 || (body = emit(p, node.l, s)) < 0) return -1;
+                p->rx->nfa[s].out = body;
+                next = s;
+            } else {
+                /* x{m,n} = x...x (x(x(x)?)?)? */
+                for (int i = node.min; i < node.max; ++i) {
+                    if ((body = emit(p, node.l, next)) < 0 || (next = newNfa(p, NFA_SPLIT, body, next)) < 0)
+                        return -1;
+                }
+            }
+            for (int i = 0; i < node.min; ++i) {
+                if ((next = emit(p, node.l, next)) < 0) return -1;
+            }
+            return next;
+        default:
+            return -1;
+    }
+}
+
+rsRetVal rxsetConstruct(rxset_t **const ppThis) {
+    DEFiRet;
+    CHKmalloc(*ppThis = calloc(1, sizeof(rxset_t)));
+finalize_it:
+    RETiRet;
+}
+
+static void freeBuildState(rxset_t *const pThis) {
+    free(pThis->nfa);
+    free(pThis->sets);
+    free(pThis->starts);
+    pThis->nfa = NULL;
+    pThis->sets = NULL;
+    pThis->starts = NULL;
+}
+
+void rxsetDestruct(rxset_t **const ppThis) {
+    if (*ppThis == NULL) return;
+    freeBuildState(*ppThis);
+    free((*ppThis)->delta);
+    free((*ppThis)->acc);
+    free((*ppThis)->eolAcc);
+    free(*ppThis);
+    *ppThis = NULL;
+}
+
+rsRetVal rxsetAdd(rxset_t *const pThis, const char *const regex, int *const pbCompiled) {
+    parser_t p;
+    const int nNfaBefore = pThis->nNfa;
+    const int nSetsBefore = pThis->nSets;
+    int32_t start = -1;
+    int root;
+    DEFiRet;
+
+    memset(&p, 0, sizeof(p));
+    p.rx = pThis;
+    p.p = (const unsigned char *)regex;
+
+    if (pThis->nRegex == pThis->maxStarts) {
+        const int newMax = (pThis->maxStarts == 0) ? 64 : 2 * pThis->maxStarts;
+        int32_t *n;
+        CHKmalloc(n = realloc(pThis->starts, newMax * sizeof(int32_t)));
+        pThis->starts = n;
+        pThis->maxStarts = newMax;
+    }
+
+    root = parseAlt(&p, 0);
+    if (root >= 0 && *p.p != '\0') p.bUnsupported = 1;
+    if (root >= 0 && !p.bUnsupported && p.nAnchors > 0) {
+        /* anchorsPlain() recurses along concatenations */
+        if (p.nAst > RXSET_MAX_ANCHORED_AST || !anchorsPlain(&p, root, 0, 0)) p.bUnsupported = 1;
+    }
+    if (root >= 0 && !p.bUnsupported) {
+        const int32_t match = newNfa(&p, NFA_MATCH, pThis->nRegex, -1);
+        if (match >= 0) start = emit(&p, root, match);
+    }
+    if (p.bNoMem) ABORT_FINALIZE(RS_RET_OUT_OF_MEMORY);
+    if (start < 0) {
+        /* drop whatever the partial parse produced */
+        pThis->nNfa = nNfaBefore;
+        pThis->nSets = nSetsBefore;
+    } else {
+        ++pThis->nCompiled;
+    }
+    pThis->starts[pThis->nRegex++] = start;
+    *pbCompiled = (start >= 0);
+
+finalize_it:
+    free(p.ast);
+    RETiRet;
+}
+
+
+/* ---------------------------------------------------------------- DFA construction */
+
+typedef struct builder_s {
+    rxset_t *rx;
+    uint32_t *mark; /**< per NFA node: generation it was last visited in */
+    uint32_t gen;
+    int32_t *stack;
+    uint8_t *inS; /**< NFA node is part of the implicit set S */
+    int32_t *out; /**< result of the current closure */
+    int nOut;
+    int32_t *scratch;
+    int *setClsOff; /**< per byte set: offset of its class list in setCls */
+    uint8_t *setCls; /**< the byte classes each set accepts */
+    int32_t *moves; /**< targets of the byte nodes of one state, by class */
+    size_t maxMoves;
+    int moveOff[257];
+    /* what S contributes */
+    int32_t accS;
+    int32_t eolAccS;
+    int32_t *tPool; /**< restart sets T, sorted, by class */
+    int tOff[257];
+    int16_t tag[256]; /**< per class: canonical class with the same T, -1 if T is empty */
+    int32_t tAcc[256];
+    int32_t tEolAcc[256];
+    /* DFA states as (tag, R) */
+    int32_t *pool; /**< R sets of all DFA states */
+    size_t nPool;
+    size_t maxPool;
+    size_t *stateOff;
+    int *stateLen;
+    int16_t *stateTag;
+    int32_t *hash;
+    uint32_t hashMask;
+    int maxStates;
+    size_t work;
+    unsigned char classRep[256];
+} builder_t;
+
+/* epsilon closure of the seeds, appended to b->out. Nodes in @p exclude are
+ * skipped (they are leaves, so nothing behind them is lost). Blocked "$"
+ * nodes are kept, blocked "^" nodes dropped: no later position can pass them.
+ */
+static void closure(builder_t *const b,
+                    const int32_t *const seeds,
+                    const int nSeeds,
+                    const int bAllowBol,
+                    const int bAllowEol,
+                    const uint8_t *const exclude) {
+    const nfaNode_t *const nfa = b->rx->nfa;
+    int sp = 0;
+
+    for (int i = 0; i < nSeeds; ++i) {
+        if (b->mark[seeds[i]] != b->gen) {
+            b->mark[seeds[i]] = b->gen;
+            b->stack[sp++] = seeds[i];
+        }
+    }
+    while (sp > 0) {
+        const int32_t n = b->stack[--sp];
+        int32_t succ[2];
+        int nSucc = 0;
+        if (exclude != NULL && exclude[n]) continue;
+        switch ((nfaType_t)nfa[n].type) {
+            case NFA_BYTES:
+            case NFA_MATCH:
+                b->out[b->nOut++] = n;
+                break;
+            case NFA_SPLIT:
+                succ[nSucc++] = nfa[n].out;
+                succ[nSucc++] = nfa[n].out1;
+                break;
+            case NFA_BOL:
+                if (bAllowBol) succ[nSucc++] = nfa[n].out;
+                break;
+            case NFA_EOL:
+                if (bAllowEol)
+                    succ[nSucc++] = nfa[n].out;
+                else
+                    b->out[b->nOut++] = n;
+                break;
+            default:
+                break;
+        }
+        for (int i = 0; i < nSucc; ++i) {
+            if (b->mark[succ[i]] != b->gen) {
+                b->mark[succ[i]] = b->gen;
+                b->stack[sp++] = succ[i];
+            }
+        }
+    }
+}
+
+static void closureStart(builder_t *const b) {
+    ++b->gen;
+    b->nOut = 0;
+}
+
+/* lowest regex index of the match nodes in set */
+static int32_t setAcc(const rxset_t *const rx, const int32_t *const set, const int len) {
+    int32_t acc = RXSET_NOACC;
+    for (int i = 0; i < len; ++i) {
+        if (rx->nfa[set[i]].type == NFA_MATCH && rx->nfa[set[i]].out < acc) acc = rx->nfa[set[i]].out;
+    }
+    return acc;
+}
+
+/* lowest regex index reachable from the "$" nodes in set once the end of the
+ * subject has been reached
+ */
+static int32_t eolClosureAcc(builder_t *const b, const int32_t *const set, const int len, const int bAllowBol) {
+    const nfaNode_t *const nfa = b->rx->nfa;
+    closureStart(b);
+    for (int i = 0; i < len; ++i) {
+        if (nfa[set[i]].type == NFA_EOL) closure(b, &nfa[set[i]].out, 1, bAllowBol, 1, NULL);
+    }
+    return setAcc(b->rx, b->out, b->nOut);
+}
+
+static int cmpInt32(const void *const a, const void *const b) {
+    const int32_t x = *(const int32_t *)a;
+    const int32_t y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t hashSet(const int32_t *const set, const int len) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < len; ++i) {
+        h = (h ^ (uint32_t)set[i]) * 16777619u;
+    }
+    return h;
+}
+
+static int inSorted(const int32_t *const set, const int len, const int32_t n) {
+    return len > 0 && bsearch(&n, set, len, sizeof(int32_t), cmpInt32) != NULL;
+}
+
+/* find the state entered on class c with closure b->out of the moves out of
+ * the previous state's R and T, adding it if needed; -1 if over budget.
+ * @p *pAcc receives the lowest regex index matching on the transition.
+ */
+static rsRetVal findOrAddState(builder_t *const b, const int c, int32_t *const pState, int32_t *const pAcc) {
+    rxset_t *const rx = b->rx;
+    const int tag = b->tag[c];
+    const int32_t *const T = b->tPool + b->tOff[c];
+    const int nT = b->tOff[c + 1] - b->tOff[c];
+    int32_t acc = setAcc(rx, b->out, b->nOut);
+    int len = 0;
+    uint32_t slot;
+    int32_t st;
+    DEFiRet;
+
+    if (b->tAcc[c] < acc) acc = b->tAcc[c];
+    *pAcc = (b->accS < acc) ? b->accS : acc;
+    qsort(b->out, b->nOut, sizeof(int32_t), cmpInt32);
+    for (int i = 0; i < b->nOut; ++i) {
+        if (rx->nfa[b->out[i]].type != NFA_MATCH && !inSorted(T, nT, b->out[i])) b->out[len++] = b->out[i];
+    }
+    for (slot = (hashSet(b->out, len) ^ (uint32_t)(tag + 1) * 2654435761u) & b->hashMask;
+         (st = b->hash[slot]) != -1; slot = (slot + 1) & b->hashMask) {
+        if (b->stateTag[st] == tag && b->stateLen[st] == len &&
+            memcmp(b->pool + b->stateOff[st], b->out, len * sizeof(int32_t)) == 0) {
+            *pState = st;
+            FINALIZE;
+        }
+    }
+    if (rx->nStates == b->maxStates || b->nPool + len > RXSET_MAX_POOL || b->work > RXSET_MAX_WORK) {
+        *pState = -1;
+        FINALIZE;
+    }
+    if (b->nPool + len > b->maxPool) {
+        size_t newMax = (b->maxPool == 0) ? 4096 : b->maxPool;
+        while (newMax < b->nPool + len) newMax *= 2;
+        int32_t *n;
+        CHKmalloc(n = realloc(b->pool, newMax * sizeof(int32_t)));
+        b->pool = n;
+        b->maxPool = newMax;
+    }
+    st = rx->nStates++;
+    memcpy(b->pool + b->nPool, b->out, len * sizeof(int32_t));
+    b->stateOff[st] = b->nPool;
+    b->stateLen[st] = len;
+    b->stateTag[st] = (int16_t)tag;
+    b->nPool += len;
+    b->hash[slot] = st;
+
+    /* eolClosureAcc() reuses b->out, so work on the pooled copy */
+    rx->eolAcc[st] = eolClosureAcc(b, b->pool + b->stateOff[st], len, 0);
+    if (b->tEolAcc[c] < rx->eolAcc[st]) rx->eolAcc[st] = b->tEolAcc[c];
+    if (b->eolAccS < rx->eolAcc[st]) rx->eolAcc[st] = b->eolAccS;
+    *pState = st;
+
+finalize_it:
+    RETiRet;
+}
+
+/* partition the byte values into classes no byte set distinguishes */
+static void buildByteClasses(rxset_t *const rx, builder_t *const b) {
+    unsigned char cls[256];
+    int16_t map[512];
+
+    memset(rx->byteClass, 0, sizeof(rx->byteClass));
+    rx->nClasses = 1;
+    for (int k = 0; k < rx->nSets && rx->nClasses < 256; ++k) {
+        int n = 0;
+        for (int i = 0; i < 2 * rx->nClasses; ++i) map[i] = -1;
+        for (int c = 0; c < 256; ++c) {
+            const int key = rx->byteClass[c] * 2 + bsetHas(rx->sets[k], c);
+            if (map[key] == -1) map[key] = n++;
+            cls[c] = (unsigned char)map[key];
+        }
+        memcpy(rx->byteClass, cls, sizeof(cls));
+        rx->nClasses = n;
+    }
+    for (int c = 255; c >= 0; --c) b->classRep[rx->byteClass[c]] = (unsigned char)c;
+}
+
+/* record for each byte set the classes it accepts */
+static rsRetVal buildSetClasses(builder_t *const b) {
+    const rxset_t *const rx = b->rx;
+    size_t n = 0;
+    size_t max = 0;
+    DEFiRet;
+
+    CHKmalloc(b->setClsOff = malloc((rx->nSets + 1) * sizeof(int)));
+    for (int k = 0; k < rx->nSets; ++k) {
+        b->setClsOff[k] = (int)n;
+        if (n + rx->nClasses > max) {
+            uint8_t *newCls;
+            max = 2 * max + rx->nClasses;
+            CHKmalloc(newCls = realloc(b->setCls, max));
+            b->setCls = newCls;
+        }
+        for (int c = 0; c < rx->nClasses; ++c) {
+            if (bsetHas(rx->sets[k], b->classRep[c])) b->setCls[n++] = (uint8_t)c;
+        }
+    }
+    b->setClsOff[rx->nSets] = (int)n;
+
+finalize_it:
+    RETiRet;
+}
+
+/* targets of the byte nodes in set, bucketed by the class they accept;
+ * b->moves + b->moveOff[c] holds the b->moveOff[c + 1] - b->moveOff[c] targets
+ * for class c
+ */
+static rsRetVal stateMoves(builder_t *const b, const int32_t *const set, const int len) {
+    const nfaNode_t *const nfa = b->rx->nfa;
+    const int nC = b->rx->nClasses;
+    int *const off = b->moveOff;
+    size_t n;
+    DEFiRet;
+
+    memset(off, 0, (nC + 1) * sizeof(int));
+    for (int i = 0; i < len; ++i) {
+        const nfaNode_t *const node = &nfa[set[i]];
+        if (node->type != NFA_BYTES) continue;
+        for (int k = b->setClsOff[node->out1]; k < b->setClsOff[node->out1 + 1]; ++k) ++off[b->setCls[k] + 1];
+    }
+    for (int c = 0; c < nC; ++c) off[c + 1] += off[c];
+    n = (size_t)off[nC];
+    if (n > b->maxMoves) {
+        int32_t *newMoves;
+        CHKmalloc(newMoves = realloc(b->moves, n * sizeof(int32_t)));
+        b->moves = newMoves;
+        b->maxMoves = n;
+    }
+    for (int i = 0; i < len; ++i) {
+        const nfaNode_t *const node = &nfa[set[i]];
+        if (node->type != NFA_BYTES) continue;
+        for (int k = b->setClsOff[node->out1]; k < b->setClsOff[node->out1 + 1]; ++k) {
+            b->moves[off[b->setCls[k]]++] = node->out;
+        }
+    }
+    /* the fill loop advanced each offset to the start of the next class */
+    for (int c = nC; c > 0; --c) off[c] = off[c - 1];
+    off[0] = 0;
+
+finalize_it:
+    RETiRet;
+}
+
+/* S and the restart sets T: S is the closure of all regex starts, which
+ * every state holds implicitly because a match may start at any offset. T[c]
+ * is the closure of the moves out of S on class c, so every state entered on
+ * class c holds it as well. States keep their T by reference (the tag), and
+ * only the remainder R is stored and compared. Otherwise, with many
+ * unanchored regexes, each state would carry large copies of the same T.
+ */
+static rsRetVal buildRestartSets(builder_t *const b, int32_t *const seeds) {
+    rxset_t *const rx = b->rx;
+    int32_t *S = NULL;
+    int nS = 0;
+    DEFiRet;
+
+    for (int i = 0; i < rx->nRegex; ++i) {
+        if (rx->starts[i] >= 0) seeds[nS++] = rx->starts[i];
+    }
+    closureStart(b);
+    closure(b, seeds, nS, 0, 0, NULL);
+    nS = b->nOut;
+    CHKmalloc(S = malloc((nS + 1) * sizeof(int32_t)));
+    memcpy(S, b->out, nS * sizeof(int32_t));
+    for (int i = 0; i < nS; ++i) b->inS[S[i]] = 1;
+    b->accS = setAcc(rx, S, nS);
+    b->eolAccS = eolClosureAcc(b, S, nS, 0);
+
+    CHKiRet(stateMoves(b, S, nS));
+    b->tOff[0] = 0;
+    for (int c = 0; c < rx->nClasses; ++c) {
+        int32_t *newPool;
+        int32_t *T;
+        closureStart(b);
+        closure(b, b->moves + b->moveOff[c], b->moveOff[c + 1] - b->moveOff[c], 0, 0, b->inS);
+        qsort(b->out, b->nOut, sizeof(int32_t), cmpInt32);
+        CHKmalloc(newPool = realloc(b->tPool, ((size_t)b->tOff[c] + b->nOut + 1) * sizeof(int32_t)));
+        b->tPool = newPool;
+        T = b->tPool + b->tOff[c];
+        memcpy(T, b->out, b->nOut * sizeof(int32_t));
+        b->tOff[c + 1] = b->tOff[c] + b->nOut;
+        b->tAcc[c] = setAcc(rx, T, b->nOut);
+        b->tEolAcc[c] = eolClosureAcc(b, T, b->tOff[c + 1] - b->tOff[c], 0);
+        b->tag[c] = (b->tOff[c + 1] == b->tOff[c]) ? -1 : c;
+        for (int c2 = 0; c2 < c && b->tag[c] == c; ++c2) {
+            if (b->tag[c2] == c2 && b->tOff[c2 + 1] - b->tOff[c2] == b->tOff[c + 1] - b->tOff[c] &&
+                memcmp(b->tPool + b->tOff[c2], T, (b->tOff[c + 1] - b->tOff[c]) * sizeof(int32_t)) == 0) {
+                b->tag[c] = (int16_t)c2;
+            }
+        }
+    }
+
+finalize_it:
+    free(S);
+    RETiRet;
+}
+
+rsRetVal rxsetCompile(rxset_t *const pThis) {
+    builder_t b;
+    int32_t *seeds = NULL;
+    int32_t tState[256]; /* target if only S and T move, -2 = not yet known */
+    int32_t tStateAcc[256];
+    int nC;
+    DEFiRet;
+
+    memset(&b, 0, sizeof(b));
+    b.rx = pThis;
+    if (pThis->nCompiled == 0) FINALIZE;
+
+    buildByteClasses(pThis, &b);
+    CHKiRet(buildSetClasses(&b));
+    nC = pThis->nClasses;
+    b.maxStates = RXSET_MAX_TABLE / nC;
+    if (b.maxStates > RXSET_MAX_STATES) b.maxStates = RXSET_MAX_STATES;
+
+    CHKmalloc(b.mark = calloc(pThis->nNfa, sizeof(uint32_t)));
+    CHKmalloc(b.stack = malloc(pThis->nNfa * sizeof(int32_t)));
+    CHKmalloc(b.inS = calloc(pThis->nNfa, 1));
+    CHKmalloc(b.out = malloc(pThis->nNfa * sizeof(int32_t)));
+    CHKmalloc(b.scratch = malloc(pThis->nNfa * sizeof(int32_t)));
+    CHKmalloc(seeds = malloc(pThis->nNfa * sizeof(int32_t)));
+    CHKmalloc(b.stateOff = malloc(b.maxStates * sizeof(size_t)));
+    CHKmalloc(b.stateLen = malloc(b.maxStates * sizeof(int)));
+    CHKmalloc(b.stateTag = malloc(b.maxStates * sizeof(int16_t)));
+    b.hashMask = 1;
+    while (b.hashMask < 2u * b.maxStates) b.hashMask <<= 1;
+    CHKmalloc(b.hash = malloc(b.hashMask * sizeof(int32_t)));
+    memset(b.hash, 0xff, b.hashMask * sizeof(int32_t));
+    --b.hashMask;
+    CHKmalloc(pThis->eolAcc = malloc(b.maxStates * sizeof(int32_t)));
+
+    CHKiRet(buildRestartSets(&b, seeds));
+
+    /* state 0: offset 0, where "^" may be passed. It is never the target of
+     * a transition, so it is not entered into the hash table.
+     */
+    {
+        int n = 0;
+        int len = 0;
+        for (int i = 0; i < pThis->nRegex; ++i) {
+            if (pThis->starts[i] >= 0) seeds[n++] = pThis->starts[i];
+        }
+        closureStart(&b);
+        closure(&b, seeds, n, 1, 0, NULL);
+        pThis->startAcc = setAcc(pThis, b.out, b.nOut);
+        /* at offset 0 the subject may also end: "^" stays passable */
+        n = b.nOut;
+        memcpy(seeds, b.out, n * sizeof(int32_t));
+        pThis->eolAcc[0] = eolClosureAcc(&b, seeds, n, 1);
+        CHKmalloc(b.pool = malloc((n + 1) * sizeof(int32_t)));
+        b.maxPool = n + 1;
+        for (int i = 0; i < n; ++i) {
+            if (pThis->nfa[seeds[i]].type != NFA_MATCH && !b.inS[seeds[i]]) b.pool[len++] = seeds[i];
+        }
+        b.stateOff[0] = 0;
+        b.stateLen[0] = len;
+        b.stateTag[0] = -1;
+        b.nPool = len;
+        pThis->nStates = 1;
+    }
+
+    CHKmalloc(pThis->delta = malloc((size_t)b.maxStates * nC * sizeof(int32_t)));
+    CHKmalloc(pThis->acc = malloc((size_t)b.maxStates * nC * sizeof(int32_t)));
+    for (int c = 0; c < nC; ++c) tState[c] = -2;
+    for (int st = 0; st < pThis->nStates; ++st) {
+        /* moves out of R and T; S is covered by the restart sets */
+        const int tag = b.stateTag[st];
+        const int nR = b.stateLen[st];
+        const int nT = (tag < 0) ? 0 : b.tOff[tag + 1] - b.tOff[tag];
+        if (b.work > RXSET_MAX_WORK) {
+            /* out of budget: leave the remaining states unexpanded */
+            for (int c = 0; c < nC; ++c) pThis->delta[(size_t)st * nC + c] = -1;
+            continue;
+        }
+        memcpy(b.scratch, b.pool + b.stateOff[st], nR * sizeof(int32_t));
+        if (nT > 0) memcpy(b.scratch + nR, b.tPool + b.tOff[tag], nT * sizeof(int32_t));
+        CHKiRet(stateMoves(&b, b.scratch, nR + nT));
+        b.work += nR + nT + b.moveOff[nC];
+        for (int c = 0; c < nC; ++c) {
+            const size_t t = (size_t)st * nC + c;
+            const int n = b.moveOff[c + 1] - b.moveOff[c];
+            /* most transitions are restarts that only S contributes to; share them */
+            if (n == 0 && tState[c] != -2) {
+                pThis->delta[t] = tState[c];
+                pThis->acc[t] = tStateAcc[c];
+                continue;
+            }
+            closureStart(&b);
+            closure(&b, b.moves + b.moveOff[c], n, 0, 0, b.inS);
+            b.work += b.nOut;
+            CHKiRet(findOrAddState(&b, c, &pThis->delta[t], &pThis->acc[t]));
+            if (n == 0) {
+                tState[c] = pThis->delta[t];
+                tStateAcc[c] = pThis->acc[t];
+            }
+        }
+    }
+    /* the tables were sized for the limit; give back what was not used */
+    {
+        int32_t *n;
+        if ((n = realloc(pThis->delta, (size_t)pThis->nStates * nC * sizeof(int32_t))) != NULL) pThis->delta = n;
+        if ((n = realloc(pThis->acc, (size_t)pThis->nStates * nC * sizeof(int32_t))) != NULL) pThis->acc = n;
+        if ((n = realloc(pThis->eolAcc, pThis->nStates * sizeof(int32_t))) != NULL) pThis->eolAcc = n;
+    }
+
+finalize_it:
+    if (iRet != RS_RET_OK) {
+        free(pThis->delta);
+        pThis->delta = NULL;
+    }
+    freeBuildState(pThis);
+    free(b.mark);
+    free(b.stack);
+    free(b.inS);
+    free(b.out);
+    free(b.scratch);
+    free(b.setClsOff);
+    free(b.setCls);
+    free(b.moves);
+    free(b.tPool);
+    free(b.pool);
+    free(b.stateOff);
+    free(b.stateLen);
+    free(b.stateTag);
+    free(b.hash);
+    free(seeds);
+    RETiRet;
+}
+
+int rxsetMatch(const rxset_t *const pThis, const unsigned char *const subject, const size_t len) {
+    const int32_t *const delta = pThis->delta;
+    const int32_t *const acc = pThis->acc;
+    const int nC = pThis->nClasses;
+    int32_t st = 0;
+    int32_t best;
+
+    if (delta == NULL) return RXSET_NOMATCH;
+    best = pThis->startAcc;
+    for (size_t i = 0; i < len && best != 0; ++i) {
+        const size_t t = (size_t)st * nC + pThis->byteClass[subject[i]];
+        st = delta[t];
+        if (st < 0) return RXSET_UNDECIDED;
+        if (acc[t] < best) best = acc[t];
+    }
+    if (pThis->eolAcc[st] < best) best = pThis->eolAcc[st];
+    return (best == RXSET_NOACC) ? RXSET_NOMATCH : best;
+}
+
+int rxsetNumStates(const rxset_t *const pThis) {
+    return pThis->nStates;
+}
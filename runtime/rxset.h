@@ -0,0 +1,76 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file rxset.h
+ * @brief Match a string against a whole set of POSIX extended regexes at once.
+ *
+ * The set answers "which is the lowest-numbered regex that matches anywhere in
+ * the subject", which is what a regex lookup table asks. All regexes are
+ * parsed into one Thompson NFA and compiled into a DFA ahead of time, so a
+ * lookup is a single pass over the subject with one table access per byte,
+ * independent of the number of regexes.
+ *
+ * Only the part of the ERE syntax with exactly known semantics is compiled:
+ * literals, ".", bracket expressions with ranges and character classes,
+ * anchors, grouping, alternation and the "*", "+", "?" and "{m,n}" operators.
+ * Regexes using anything else (GNU escapes like "\w", back-references,
+ * collating elements, non-ASCII bytes) are reported as not compiled by
+ * rxsetAdd() and never match inside the set; the caller must evaluate them
+ * separately. Matching follows regexec() with REG_EXTENDED | REG_NOSUB in the
+ * C locale, which is the locale rsyslog runs in.
+ *
+ * The DFA is built eagerly up to a size limit. A subject that would need a
+ * state beyond that limit makes rxsetMatch() return RXSET_UNDECIDED, so the
+ * caller can fall back to evaluating regex by regex. The compiled set is
+ * read-only and can be used by any number of threads concurrently.
+ */
+#ifndef INCLUDED_RXSET_H
+#define INCLUDED_RXSET_H
+
+#include <stddef.h>
+#include "rsyslog.h"
+
+#define RXSET_NOMATCH (-1) /**< no compiled regex matches */
+#define RXSET_UNDECIDED (-2) /**< the DFA is incomplete for this subject */
+
+typedef struct rxset_s rxset_t;
+
+rsRetVal rxsetConstruct(rxset_t **ppThis);
+
+/** @brief Free a set; @p *ppThis may be NULL and is set to NULL. */
+void rxsetDestruct(rxset_t **ppThis);
+
+/**
+ * @brief Add the next regex; the first one added has index 0.
+ *
+ * The regex must already have been accepted by regcomp(). If it uses syntax
+ * the set does not compile, it still occupies its index, but never matches,
+ * and @p *pbCompiled is set to 0.
+ *
+ * @return RS_RET_OK, or RS_RET_OUT_OF_MEMORY
+ */
+rsRetVal rxsetAdd(rxset_t *pThis, const char *regex, int *pbCompiled);
+
+/** @brief Build the DFA; call once after all regexes were added. */
+rsRetVal rxsetCompile(rxset_t *pThis);
+
+/**
+ * @return index of the lowest-numbered compiled regex matching @p subject,
+ *         RXSET_NOMATCH, or RXSET_UNDECIDED
+ */
+int rxsetMatch(const rxset_t *pThis, const unsigned char *subject, size_t len);
+
+/** @return number of DFA states, for diagnostics */
+int rxsetNumStates(const rxset_t *pThis);
+
+#endif /* #ifndef INCLUDED_RXSET_H */
@@ -160,14 +160,11 @@ static rsRetVal add_time(encbuf_t *b, uint16_t f, const struct syslogTime *t) {
     return add_tlv(b, f, TLV_TIME, 0, d, sizeof(d));
 }
 
-static rsRetVal add_json(encbuf_t *b, uint16_t f, smsg_t *msg, struct json_object *json) {
-    char *copy = NULL;
-    if (json == NULL) return RS_RET_OK;
-    MsgLock(msg);
-    const char *text = json_object_to_json_string_ext(json, JSON_C_TO_STRING_PLAIN);
-    if (text != NULL) copy = strdup(text);
-    MsgUnlock(msg);
-    if (copy == NULL) return RS_RET_OUT_OF_MEMORY;
+static rsRetVal add_json(encbuf_t *b, uint16_t f, smsg_t *msg, propid_t id) {
+    char *copy;
+    const rsRetVal r0 = msgJSONTreeToString(msg, id, JSON_C_TO_STRING_PLAIN, &copy);
+    if (r0 != RS_RET_OK) return r0;
+    if (copy == NULL) return RS_RET_OK;
     const rsRetVal r = add_bytes(b, f, copy, strlen(copy));
     free(copy);
     return r;
@@ -212,8 +209,8 @@ rsRetVal segdiskCodecEncode(smsg_t *msg, unsigned char **buf, size_t *len) {
     text = getRcvFromPort(msg);
     ADD(add_bytes(&b, F_RCVFROMPORT, text, strlen((char *)text)));
     if (msg->pszStrucData != NULL) ADD(add_bytes(&b, F_STRUCTURED_DATA, msg->pszStrucData, msg->lenStrucData));
-    ADD(add_json(&b, F_JSON, msg, msg->json));
-    ADD(add_json(&b, F_LOCALVARS, msg, msg->localvars));
+    ADD(add_json(&b, F_JSON, msg, PROP_CEE));
+    ADD(add_json(&b, F_LOCALVARS, msg, PROP_LOCAL_VAR));
     ADD(add_cstr(&b, F_APPNAME, msg, msg->pCSAPPNAME));
     ADD(add_cstr(&b, F_PROCID, msg, msg->pCSPROCID));
     ADD(add_cstr(&b, F_MSGID, msg, msg->pCSMSGID));
@@ -8,6 +8,20 @@
  * Startup reads only the fixed-size state file. Existing segments are opened
  * and validated lazily as dequeue reaches them, so startup cost is independent
  * of backlog bytes and segment count.
+ *
+ * With block compression enabled, appended records are collected in an open
+ * block and written as one compressed block record once it fills. A block
+ * carries the local sequence of its first record, so a commit frontier inside
+ * a block is the block offset plus the last committed sequence; replay skips
+ * the already committed prefix of that block.
+ *
+ * Plain records are staged and written in groups: the queue brackets a
+ * multi-message enqueue with segdiskStoreBeginAppend()/segdiskStoreCommitAppend()
+ * and the staged records go to disk with one vectored write and, under
+ * syncQueueFiles, one data sync. Staged records are invisible to readers until
+ * written; a reader that catches up with them forces the write, just as for an
+ * open compressed block. With io_uring support compiled in, a synchronized
+ * group is submitted as a linked write and fdatasync pair.
  */
 #include "config.h"
 #include "rsyslog.h"
@@ -23,7 +37,11 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
+#ifdef ENABLE_IO_URING
+    #include <liburing.h>
+#endif
 #include "errmsg.h"
 #include "segdisk_codec.h"
 #include "segdisk_crc.h"
@@ -33,13 +51,21 @@
 #define SEG_MAGIC "RSSEGH02"
 #define REC_MAGIC "RSRECD02"
 #define FOOT_MAGIC "RSSEAL02"
+#define BLK_MAGIC "RSBLKZ02"
 #define STORE_VERSION 2u
 #define STATE_SLOT_LEN SEGDISK_STATE_SLOT_LEN
 #define STATE_FILE_LEN SEGDISK_STATE_FILE_LEN
 #define SEG_HDR_LEN 52u
 #define REC_HDR_LEN 32u
 #define FOOT_LEN 48u
+#define BLK_HDR_LEN 40u
+#define BLK_ENTRY_LEN 8u
+#define BLK_CODEC_ZSTD 1u
 #define MAX_RECORD_SIZE (128u * 1024u * 1024u)
+#define MAX_BLOCK_RAW (MAX_RECORD_SIZE + BLK_ENTRY_LEN)
+#define MAX_BLOCK_STORED (MAX_BLOCK_RAW + (MAX_BLOCK_RAW >> 7) + 4096u)
+#define GRP_MAX_RECORDS 1024u /* never above the IOV_MAX of any supported platform */
+#define GRP_MAX_BYTES (8u * 1024u * 1024u)
 #define RECOVERY_SCAN_BUDGET (1024u * 1024u)
 #define STATE_FLAG_RECOVERY 1u
 #define STATE_FLAG_DEMATERIALIZING 2u
@@ -109,6 +135,31 @@ struct segdisk_store_s {
     uint64_t known_queue_size;
     unsigned int updates_since_checkpoint;
     sbool dematerializing;
+    /* open compressed block: serialized entries not yet written */
+    unsigned char *blk_buf;
+    size_t blk_len;
+    size_t blk_alloc;
+    uint32_t blk_records;
+    /* decompressed block the read cursor currently points into */
+    unsigned char *rblk_raw;
+    size_t rblk_pos;
+    uint64_t rblk_segment;
+    int64_t rblk_offset;
+    int64_t rblk_end;
+    uint64_t rblk_sequence;
+    uint32_t rblk_left;
+    sbool decompress_missing_logged;
+    /* group commit: encoded plain records staged for one vectored write */
+    struct iovec *grp_iov;
+    struct iovec *grp_wiov; /* scratch copy handed to the kernel */
+    unsigned int grp_count;
+    unsigned int grp_depth;
+    size_t grp_bytes;
+    uint32_t grp_crc;
+#ifdef ENABLE_IO_URING
+    struct io_uring uring;
+    int uring_state; /* 0 - not yet tried, 1 - ready, -1 - unavailable */
+#endif
     segdisk_store_stats_t stats;
 #ifdef ENABLE_IMDIAG
     segdisk_test_fault_point_t test_fault_point;
@@ -760,6 +811,306 @@ static void update_retry_overage(segdisk_store_t *s) {
         s->stats.retry_overage_max_bytes = s->stats.retry_overage_bytes;
 }
 
+static void release_group(segdisk_store_t *s) {
+    for (unsigned int i = 0; i < s->grp_count; ++i) free(s->grp_iov[i].iov_base);
+    s->grp_count = 0;
+    s->grp_bytes = 0;
+    s->grp_crc = 0;
+}
+
+static rsRetVal writev_full(int fd, struct iovec *iov, int cnt) {
+    while (cnt > 0) {
+        ssize_t n = writev(fd, iov, cnt);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return RS_RET_IO_ERROR;
+        }
+        while (cnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            ++iov;
+            --cnt;
+        }
+        if (n > 0) {
+            iov->iov_base = (unsigned char *)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+    return RS_RET_OK;
+}
+
+#ifdef ENABLE_IO_URING
+/* Submit the group write and its data sync as one linked pair, so both cost a
+ * single io_uring_enter(). Returns RS_RET_NOT_IMPLEMENTED if the ring cannot
+ * be used; the caller then falls back to writev() and fdatasync(). A short
+ * write cancels the linked sync and is finished by the caller as well; *done
+ * tells how many bytes already reached the file.
+ */
+static rsRetVal uring_write_group(segdisk_store_t *s, size_t *done, sbool *synced) {
+    *done = 0;
+    *synced = 0;
+    if (s->uring_state == 0) {
+        struct io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        if (io_uring_queue_init_params(4, &s->uring, &params) != 0) {
+            s->uring_state = -1;
+        } else if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+            io_uring_queue_exit(&s->uring);
+            s->uring_state = -1;
+        } else {
+            s->uring_state = 1;
+        }
+        if (s->uring_state < 0) DBGPRINTF("%s: segmentedDisk io_uring unavailable, using writev\n", s->queue_name);
+    }
+    if (s->uring_state < 0) return RS_RET_NOT_IMPLEMENTED;
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&s->uring);
+    if (sqe == NULL) return RS_RET_NOT_IMPLEMENTED;
+    io_uring_prep_writev(sqe, s->active_fd, s->grp_wiov, s->grp_count, (uint64_t)-1);
+    sqe->flags |= IOSQE_IO_LINK;
+    sqe->user_data = 1;
+    sqe = io_uring_get_sqe(&s->uring);
+    if (sqe == NULL) return RS_RET_NOT_IMPLEMENTED;
+    io_uring_prep_fsync(sqe, s->active_fd, IORING_FSYNC_DATASYNC);
+    sqe->user_data = 2;
+    int submitted;
+    do {
+        submitted = io_uring_submit_and_wait(&s->uring, 2);
+    } while (submitted == -EINTR);
+    if (submitted < 0) return RS_RET_IO_ERROR;
+    rsRetVal r = RS_RET_OK;
+    for (int i = 0; i < submitted; ++i) {
+        struct io_uring_cqe *cqe;
+        int err;
+        do {
+            err = io_uring_wait_cqe(&s->uring, &cqe);
+        } while (err == -EINTR);
+        if (err != 0) return RS_RET_IO_ERROR;
+        if (cqe->user_data == 1) {
+            if (cqe->res < 0)
+                r = RS_RET_IO_ERROR;
+            else
+                *done = (size_t)cqe->res;
+        } else if (cqe->res == 0) {
+            *synced = 1;
+        } else if (cqe->res != -ECANCELED) {
+            r = RS_RET_IO_ERROR;
+        }
+        io_uring_cqe_seen(&s->uring, cqe);
+    }
+    return r;
+}
+#endif
+
+/* Write all staged records to the active segment. The staged iovecs are
+ * copied first so that a partial write never disturbs the group kept for a
+ * retry.
+ */
+static rsRetVal write_group(segdisk_store_t *s) {
+    memcpy(s->grp_wiov, s->grp_iov, s->grp_count * sizeof(struct iovec));
+#ifdef ENABLE_IO_URING
+    if (s->cfg.sync_files) {
+        size_t done;
+        sbool synced;
+        const rsRetVal r = uring_write_group(s, &done, &synced);
+        if (r != RS_RET_NOT_IMPLEMENTED) {
+            if (r != RS_RET_OK) return r;
+            if (synced) return RS_RET_OK;
+            /* short write: finish it the classic way, then sync; if all
+             * bytes made it, only the sync is missing */
+            int i = 0;
+            while (i < (int)s->grp_count && done >= s->grp_wiov[i].iov_len) done -= s->grp_wiov[i++].iov_len;
+            if (i < (int)s->grp_count) {
+                s->grp_wiov[i].iov_base = (unsigned char *)s->grp_wiov[i].iov_base + done;
+                s->grp_wiov[i].iov_len -= done;
+                if (writev_full(s->active_fd, s->grp_wiov + i, (int)s->grp_count - i) != RS_RET_OK)
+                    return RS_RET_IO_ERROR;
+            }
+            if (sync_file_data(s->active_fd) != 0) return RS_RET_IO_ERROR;
+            return RS_RET_OK;
+        }
+        memcpy(s->grp_wiov, s->grp_iov, s->grp_count * sizeof(struct iovec));
+    }
+#endif
+    rsRetVal r = writev_full(s->active_fd, s->grp_wiov, (int)s->grp_count);
+    if (r == RS_RET_OK && s->cfg.sync_files && sync_file_data(s->active_fd) != 0) r = RS_RET_IO_ERROR;
+    return r;
+}
+
+/* Write the staged group. On failure the group stays staged for a later
+ * attempt and the segment is cut back to its accounted end, so the retry
+ * does not append behind a torn record.
+ */
+static rsRetVal flush_group(segdisk_store_t *s) {
+    if (s->grp_count == 0) return RS_RET_OK;
+    rsRetVal r = write_group(s);
+    if (r != RS_RET_OK) {
+        if (ftruncate(s->active_fd, s->active->data_end) != 0)
+            LogError(errno, RS_RET_IO_ERROR, "%s: segmentedDisk could not truncate segment after failed write",
+                     s->queue_name);
+        return r;
+    }
+    s->active->data_end += (int64_t)s->grp_bytes;
+    s->active->file_size += (int64_t)s->grp_bytes;
+    s->active->record_count += s->grp_count;
+    s->active->last_sequence = s->active->record_count;
+    s->active->rolling_crc ^= s->grp_crc;
+    s->last_data_segment = s->active->id;
+    s->stats.bytes += (int64_t)s->grp_bytes;
+    ++s->stats.group_writes;
+    s->stats.group_records += s->grp_count;
+    release_group(s);
+    /* rotation keeps groups within max_file_size unless the segment's first
+     * record alone exceeds it */
+    if (s->cfg.max_file_size > 0 && s->active->file_size + FOOT_LEN > s->cfg.max_file_size) r = seal_active(s);
+    return r;
+}
+
+static sbool block_mode(const segdisk_store_t *s) {
+    return s->cfg.compress != NULL && s->cfg.compress_block_size > 0;
+}
+
+/* Block record layout: magic, version, codec, stored length, local sequence
+ * of the first entry, entry count, raw length, header CRC and stored-bytes
+ * CRC, followed by the compressed entries. Each raw entry is its payload
+ * length, payload CRC and codec payload.
+ */
+static rsRetVal flush_block(segdisk_store_t *s) {
+    if (s->blk_records == 0) return RS_RET_OK;
+    unsigned char *stored = NULL;
+    size_t stored_len = 0;
+    rsRetVal r = s->cfg.compress(s->blk_buf, s->blk_len, &stored, &stored_len, s->cfg.compress_level);
+    if (r != RS_RET_OK) return r;
+    const size_t len = BLK_HDR_LEN + stored_len;
+    unsigned char *block = malloc(len);
+    if (block == NULL) {
+        free(stored);
+        return RS_RET_OUT_OF_MEMORY;
+    }
+    memcpy(block + BLK_HDR_LEN, stored, stored_len);
+    free(stored);
+    if (s->active == NULL) r = create_active(s);
+    if (r == RS_RET_OK && s->active->record_count != 0 && s->cfg.max_file_size > 0 &&
+        s->active->file_size + (int64_t)len + FOOT_LEN > s->cfg.max_file_size) {
+        r = seal_active(s);
+        if (r == RS_RET_OK) r = create_active(s);
+    }
+    if (r != RS_RET_OK) {
+        free(block);
+        return r;
+    }
+    const uint32_t records = s->blk_records;
+    memset(block, 0, BLK_HDR_LEN);
+    memcpy(block, BLK_MAGIC, 8);
+    put16(block + 8, STORE_VERSION);
+    put16(block + 10, BLK_CODEC_ZSTD);
+    put32(block + 12, (uint32_t)stored_len);
+    put64(block + 16, s->active->record_count + 1);
+    put32(block + 24, records);
+    put32(block + 28, (uint32_t)s->blk_len);
+    put32(block + 32, segdiskCrc32c(block, 32));
+    put32(block + 36, segdiskCrc32c(block + BLK_HDR_LEN, stored_len));
+    r = write_full(s->active_fd, block, len);
+    if (r == RS_RET_OK && s->cfg.sync_files && sync_file_data(s->active_fd) != 0) r = RS_RET_IO_ERROR;
+    if (r == RS_RET_OK) {
+        s->active->data_end += len;
+        s->active->file_size += len;
+        s->active->record_count += records;
+        s->active->last_sequence = s->active->record_count;
+        s->active->rolling_crc ^= get32(block + 32) ^ get32(block + 36);
+        s->last_data_segment = s->active->id;
+        s->stats.bytes += len;
+        ++s->stats.compressed_blocks;
+        s->stats.compressed_input_bytes += s->blk_len;
+        s->stats.compressed_output_bytes += len;
+        s->blk_len = 0;
+        s->blk_records = 0;
+    }
+    free(block);
+    if (r == RS_RET_OK && s->active->record_count == records && s->cfg.max_file_size > 0 &&
+        s->active->file_size + FOOT_LEN > s->cfg.max_file_size)
+        r = seal_active(s);
+    return r;
+}
+
+/* Add one record to the open block. A record that does not fit closes the
+ * current block first; a full block, or any block under syncQueueFiles, is
+ * written before returning. If that write fails the record is taken back out
+ * of the block so the caller's error result stays accurate.
+ */
+static rsRetVal append_block_record(segdisk_store_t *s, smsg_t *msg, sbool internal, int64_t *written) {
+    unsigned char *payload = NULL;
+    size_t payload_len = 0;
+    rsRetVal r = segdiskCodecEncode(msg, &payload, &payload_len);
+    if (r != RS_RET_OK) return r;
+    if (payload_len > MAX_RECORD_SIZE) {
+        free(payload);
+        return RS_RET_FILE_TOO_LARGE;
+    }
+    const size_t len = BLK_ENTRY_LEN + payload_len;
+    if (s->blk_len != 0 && s->blk_len + len > s->cfg.compress_block_size) {
+        r = flush_block(s);
+        if (r != RS_RET_OK) {
+            free(payload);
+            return r;
+        }
+    }
+    if (s->blk_len + len > s->blk_alloc) {
+        const size_t alloc = s->blk_len + len > s->cfg.compress_block_size ? s->blk_len + len
+                                                                           : s->cfg.compress_block_size;
+        unsigned char *buf = realloc(s->blk_buf, alloc);
+        if (buf == NULL) {
+            free(payload);
+            return RS_RET_OUT_OF_MEMORY;
+        }
+        s->blk_buf = buf;
+        s->blk_alloc = alloc;
+    }
+    unsigned char *const entry = s->blk_buf + s->blk_len;
+    put32(entry, (uint32_t)payload_len);
+    put32(entry + 4, segdiskCrc32c(payload, payload_len));
+    memcpy(entry + BLK_ENTRY_LEN, payload, payload_len);
+    free(payload);
+    s->blk_len += len;
+    ++s->blk_records;
+    ++s->known_queue_size;
+    if (s->blk_len >= s->cfg.compress_block_size || (s->cfg.sync_files && s->grp_depth == 0)) {
+        r = flush_block(s);
+        if (r != RS_RET_OK) {
+            if (s->blk_records != 0) {
+                s->blk_len -= len;
+                --s->blk_records;
+                --s->known_queue_size;
+            }
+            return r;
+        }
+    }
+    if (written != NULL) *written = len;
+    if (internal) update_retry_overage(s);
+    return RS_RET_OK;
+}
+
+/* Write staged records or a partially filled block once a reader has caught
+ * up with them. Returns 1 if new records became readable.
+ */
+static sbool flush_staged_for_reader(segdisk_store_t *s) {
+    if (s->blk_records == 0 && s->grp_count == 0) return 0;
+    const rsRetVal r = s->grp_count != 0 ? flush_group(s) : flush_block(s);
+    if (r != RS_RET_OK) {
+        LogError(0, r, "%s: segmentedDisk could not write staged records; will retry", s->queue_name);
+        return 0;
+    }
+    return 1;
+}
+
+/* Write everything a completed append group left in memory. Under
+ * syncQueueFiles this includes the open compressed block, which otherwise
+ * would have been written record by record.
+ */
+static rsRetVal flush_staged(segdisk_store_t *s) {
+    rsRetVal r = flush_group(s);
+    if (r == RS_RET_OK && s->cfg.sync_files) r = flush_block(s);
+    return r;
+}
+
 static rsRetVal append_record(segdisk_store_t *s, smsg_t *msg, sbool internal, int64_t *written) {
     if (s->dir_fd < 0) {
         const rsRetVal materialize_ret = materialize_empty(s);
@@ -769,49 +1120,197 @@ static rsRetVal append_record(segdisk_store_t *s, smsg_t *msg, sbool internal, i
         rsRetVal r = create_active(s);
         if (r != RS_RET_OK) return r;
     }
+    if (block_mode(s)) return append_block_record(s, msg, internal, written);
+    if (s->grp_iov == NULL) {
+        s->grp_iov = malloc(2 * GRP_MAX_RECORDS * sizeof(struct iovec));
+        if (s->grp_iov == NULL) return RS_RET_OUT_OF_MEMORY;
+        s->grp_wiov = s->grp_iov + GRP_MAX_RECORDS;
+    }
     unsigned char *record = NULL;
     size_t len = 0;
     uint32_t rolling_crc;
-    rsRetVal r = make_record(msg, s->active->record_count + 1, &record, &len, &rolling_crc);
+    const uint64_t sequence = s->active->record_count + s->grp_count + 1;
+    rsRetVal r = make_record(msg, sequence, &record, &len, &rolling_crc);
     if (r != RS_RET_OK) return r;
-    const sbool rotate = s->active->record_count != 0 && s->cfg.max_file_size > 0 &&
-                         s->active->file_size + (int64_t)len + FOOT_LEN > s->cfg.max_file_size;
-    if (rotate) {
-        r = seal_active(s);
-        if (r == RS_RET_OK) r = create_active(s);
-        if (r != RS_RET_OK) {
-            free(record);
-            return r;
-        }
+    const sbool rotate = s->active->record_count + s->grp_count != 0 && s->cfg.max_file_size > 0 &&
+                         s->active->file_size + (int64_t)(s->grp_bytes + len) + FOOT_LEN > s->cfg.max_file_size;
+    if (rotate || s->grp_count == GRP_MAX_RECORDS || s->grp_bytes + len > GRP_MAX_BYTES) r = flush_group(s);
+    if (r == RS_RET_OK && rotate && s->active != NULL) r = seal_active(s);
+    if (r == RS_RET_OK && s->active == NULL) r = create_active(s);
+    if (r != RS_RET_OK) {
+        free(record);
+        return r;
+    }
+    if (s->active->record_count + s->grp_count + 1 != sequence) {
+        /* the record was built for the segment that just got sealed */
         free(record);
         record = NULL;
         r = make_record(msg, 1, &record, &len, &rolling_crc);
         if (r != RS_RET_OK) return r;
     }
-    r = write_full(s->active_fd, record, len);
-    if (r == RS_RET_OK && s->cfg.sync_files && sync_file_data(s->active_fd) != 0) r = RS_RET_IO_ERROR;
-    if (r == RS_RET_OK) {
-        s->active->data_end += len;
-        s->active->file_size += len;
-        s->active->last_sequence = ++s->active->record_count;
-        s->active->rolling_crc ^= rolling_crc;
-        s->last_data_segment = s->active->id;
-        ++s->known_queue_size;
-        s->stats.bytes += len;
-        if (written != NULL) *written = len;
+    s->grp_iov[s->grp_count].iov_base = record;
+    s->grp_iov[s->grp_count].iov_len = len;
+    ++s->grp_count;
+    s->grp_bytes += len;
+    s->grp_crc ^= rolling_crc;
+    ++s->known_queue_size;
+    if (s->grp_depth == 0) {
+        r = flush_group(s);
+        if (r != RS_RET_OK) {
+            /* outside a group the caller learns about the failure right away,
+             * so the record must not stay behind */
+            if (s->grp_count != 0) {
+                free(s->grp_iov[--s->grp_count].iov_base);
+                s->grp_bytes -= len;
+                s->grp_crc ^= rolling_crc;
+                --s->known_queue_size;
+            }
+            return r;
+        }
     }
-    free(record);
-    if (r == RS_RET_OK && s->active->record_count == 1 && s->cfg.max_file_size > 0 &&
-        s->active->file_size + FOOT_LEN > s->cfg.max_file_size)
-        r = seal_active(s);
-    if (r == RS_RET_OK && internal) update_retry_overage(s);
-    return r;
+    if (written != NULL) *written = len;
+    if (internal) update_retry_overage(s);
+    return RS_RET_OK;
 }
 
 static sbool segment_is_undiscovered(const segdisk_store_t *s, uint64_t id) {
     return id != 0 && id <= s->discovery_through_segment;
 }
 
+static void drop_read_block(segdisk_store_t *s) {
+    free(s->rblk_raw);
+    s->rblk_raw = NULL;
+    s->rblk_pos = 0;
+    s->rblk_left = 0;
+    s->rblk_segment = 0;
+}
+
+/* A restart resumes at the start of a partially committed block. */
+static sbool block_entry_committed(const segdisk_store_t *s, uint64_t segment, int64_t offset, uint64_t sequence) {
+    return segment == s->committed_segment && offset == s->committed_offset &&
+           sequence <= s->committed_record_sequence;
+}
+
+/* Load the block whose header starts at *off into the read cache.
+ *
+ * RS_RET_INVALID_VALUE means the header itself is not trustworthy and the
+ * caller resynchronizes byte by byte, exactly as for a damaged record header.
+ * A valid header with damaged contents retires all entries of the block as
+ * corrupt records, moves *off behind it and returns RS_RET_NO_DATA.
+ */
+static rsRetVal load_block(segdisk_store_t *s, segdisk_segment_t *seg, int fd, int64_t *off, int *skipped,
+                           int *discovered) {
+    unsigned char h[BLK_HDR_LEN];
+    if (*off + (int64_t)BLK_HDR_LEN > seg->data_end) return RS_RET_INVALID_VALUE;
+    rsRetVal r = read_full_at(fd, h, sizeof(h), *off);
+    if (r != RS_RET_OK) return r;
+    const uint32_t stored_len = get32(h + 12);
+    const uint32_t count = get32(h + 24);
+    const uint32_t raw_len = get32(h + 28);
+    if (get16(h + 8) != STORE_VERSION || get32(h + 32) != segdiskCrc32c(h, 32) || count == 0 ||
+        raw_len > MAX_BLOCK_RAW || (uint64_t)count * BLK_ENTRY_LEN > raw_len || stored_len > MAX_BLOCK_STORED ||
+        *off + BLK_HDR_LEN + stored_len > seg->data_end)
+        return RS_RET_INVALID_VALUE;
+    if (get16(h + 10) != BLK_CODEC_ZSTD || s->cfg.decompress == NULL) {
+        if (!s->decompress_missing_logged) {
+            LogError(0, RS_RET_ZLIB_ERR,
+                     "%s: segmentedDisk segment '%s' holds zstd-compressed records, but zstd support is "
+                     "not available; the queue cannot be read",
+                     s->queue_name, seg->path);
+            s->decompress_missing_logged = 1;
+        }
+        return RS_RET_ZLIB_ERR;
+    }
+    const int64_t end = *off + BLK_HDR_LEN + stored_len;
+    unsigned char *stored = malloc(stored_len == 0 ? 1 : stored_len);
+    unsigned char *raw = malloc(raw_len);
+    if (stored == NULL || raw == NULL) {
+        free(stored);
+        free(raw);
+        return RS_RET_OUT_OF_MEMORY;
+    }
+    r = read_full_at(fd, stored, stored_len, *off + BLK_HDR_LEN);
+    sbool damaged = r != RS_RET_OK || segdiskCrc32c(stored, stored_len) != get32(h + 36) ||
+                    s->cfg.decompress(stored, stored_len, raw, raw_len) != RS_RET_OK;
+    free(stored);
+    size_t pos = 0;
+    for (uint32_t i = 0; !damaged && i < count; ++i) {
+        if (raw_len - pos < BLK_ENTRY_LEN || get32(raw + pos) > raw_len - pos - BLK_ENTRY_LEN)
+            damaged = 1;
+        else
+            pos += BLK_ENTRY_LEN + get32(raw + pos);
+    }
+    if (pos != raw_len) damaged = 1;
+    const sbool newly_discovered = segment_is_undiscovered(s, seg->id);
+    if (newly_discovered) s->stats.recovery_bytes += (uint64_t)(end - *off);
+    if (damaged) {
+        free(raw);
+        ++s->stats.corruption_events;
+        uint64_t sequence = get64(h + 16);
+        for (uint32_t i = 0; i < count; ++i, ++sequence) {
+            if (block_entry_committed(s, seg->id, *off, sequence)) continue;
+            if (newly_discovered) {
+                ++*discovered;
+                ++s->known_queue_size;
+                ++s->stats.recovery_records;
+            }
+            ++s->stats.corruption_records;
+            ++*skipped;
+        }
+        *off = end;
+        return RS_RET_NO_DATA;
+    }
+    drop_read_block(s);
+    s->rblk_raw = raw;
+    s->rblk_left = count;
+    s->rblk_sequence = get64(h + 16);
+    s->rblk_segment = seg->id;
+    s->rblk_offset = *off;
+    s->rblk_end = end;
+    return RS_RET_OK;
+}
+
+/* Hand out the next entry of the cached block. The read offset stays at the
+ * block start until the last entry is consumed, which keeps every batch end
+ * a valid restart position.
+ */
+static rsRetVal next_block_record(segdisk_store_t *s,
+                                  segdisk_segment_t *seg,
+                                  int64_t *off,
+                                  smsg_t **msg,
+                                  uint64_t *sequence,
+                                  int *skipped,
+                                  int *discovered) {
+    sbool found = 0;
+    while (!found && s->rblk_left > 0) {
+        const unsigned char *const entry = s->rblk_raw + s->rblk_pos;
+        const uint32_t n = get32(entry);
+        const uint64_t entry_sequence = s->rblk_sequence++;
+        s->rblk_pos += BLK_ENTRY_LEN + n;
+        --s->rblk_left;
+        if (block_entry_committed(s, seg->id, s->rblk_offset, entry_sequence)) continue;
+        if (segment_is_undiscovered(s, seg->id)) {
+            ++*discovered;
+            ++s->known_queue_size;
+            ++s->stats.recovery_records;
+        }
+        if (segdiskCrc32c(entry + BLK_ENTRY_LEN, n) != get32(entry + 4) ||
+            segdiskCodecDecode(entry + BLK_ENTRY_LEN, n, msg) != RS_RET_OK) {
+            ++s->stats.corruption_events;
+            ++s->stats.corruption_records;
+            ++*skipped;
+            continue;
+        }
+        *sequence = entry_sequence;
+        found = 1;
+    }
+    if (s->rblk_left == 0) {
+        *off = s->rblk_end;
+        drop_read_block(s);
+    }
+    return found ? RS_RET_OK : RS_RET_NO_DATA;
+}
+
 static rsRetVal record_at(segdisk_store_t *s,
                           segdisk_segment_t *seg,
                           int64_t *off,
@@ -821,6 +1320,9 @@ static rsRetVal record_at(segdisk_store_t *s,
                           int *discovered,
                           size_t *scan_budget) {
     if (seg->id == s->active_segment && s->active != NULL) seg->data_end = s->active->data_end;
+    if (s->rblk_left != 0 && s->rblk_segment == seg->id && s->rblk_offset == *off &&
+        next_block_record(s, seg, off, msg, sequence, skipped, discovered) == RS_RET_OK)
+        return RS_RET_OK;
     const int fd = open(seg->path, O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
     if (fd < 0) return RS_RET_IO_ERROR;
     while (*off + (int64_t)REC_HDR_LEN <= seg->data_end) {
@@ -830,6 +1332,18 @@ static rsRetVal record_at(segdisk_store_t *s,
             close(fd);
             return r;
         }
+        if (!memcmp(h, BLK_MAGIC, 8)) {
+            r = load_block(s, seg, fd, off, skipped, discovered);
+            if (r == RS_RET_OK && next_block_record(s, seg, off, msg, sequence, skipped, discovered) == RS_RET_OK) {
+                close(fd);
+                return RS_RET_OK;
+            }
+            if (r == RS_RET_OK || r == RS_RET_NO_DATA) continue;
+            if (r != RS_RET_INVALID_VALUE) {
+                close(fd);
+                return r;
+            }
+        }
         if (memcmp(h, REC_MAGIC, 8) || get16(h + 8) != STORE_VERSION || get32(h + 24) != segdiskCrc32c(h, 24) ||
             get32(h + 12) > MAX_RECORD_SIZE || *off + REC_HDR_LEN + get32(h + 12) > seg->data_end) {
             ++s->stats.corruption_events;
@@ -1212,6 +1726,7 @@ rsRetVal segdiskStoreOpen(segdisk_store_t **out, const segdisk_store_config_t *c
     if (cfg->file_prefix[0] == '\0' || strchr(cfg->file_prefix, '/') != NULL ||
         strchr(cfg->file_prefix, '\\') != NULL || !strcmp(cfg->file_prefix, ".") || !strcmp(cfg->file_prefix, ".."))
         return RS_RET_INVALID_VALUE;
+    if (cfg->compress_block_size > MAX_RECORD_SIZE) return RS_RET_INVALID_VALUE;
     segdisk_store_t *s = calloc(1, sizeof(*s));
     if (s == NULL) return RS_RET_OUT_OF_MEMORY;
     rsRetVal fail_ret = RS_RET_IO_ERROR;
@@ -1349,9 +1864,20 @@ rsRetVal segdiskStoreAppend(segdisk_store_t *s, smsg_t *msg, sbool internal, int
     return append_record(s, msg, internal, written);
 }
 
+void segdiskStoreBeginAppend(segdisk_store_t *s) {
+    ++s->grp_depth;
+}
+
+rsRetVal segdiskStoreCommitAppend(segdisk_store_t *s) {
+    if (s->grp_depth > 0) --s->grp_depth;
+    if (s->dir_fd < 0) return RS_RET_OK;
+    return flush_staged(s);
+}
+
 sbool segdiskStoreMayHaveData(const segdisk_store_t *s) {
     if (s == NULL) return 0;
     if (s->delete_first != 0) return 1;
+    if (s->blk_records != 0 || s->grp_count != 0) return 1;
     if (s->read_segment != NULL && s->read_offset < s->read_segment->data_end) return 1;
     if (s->read_segment == NULL && s->read_segment_id != 0 && s->read_segment_id <= s->last_data_segment) return 1;
     return s->active != NULL && s->active->record_count != 0 &&
@@ -1416,7 +1942,10 @@ rsRetVal segdiskStoreDequeueBatch(segdisk_store_t *s, batch_t *batch, int max, i
                     s->read_offset = SEG_HDR_LEN;
                 break;
             }
-            if (s->read_segment == NULL) break;
+            if (s->read_segment == NULL) {
+                if (flush_staged_for_reader(s)) continue;
+                break;
+            }
         }
         smsg_t *msg = NULL;
         uint64_t sequence = 0;
@@ -1429,7 +1958,10 @@ rsRetVal segdiskStoreDequeueBatch(segdisk_store_t *s, batch_t *batch, int max, i
             break;
         }
         if (r == RS_RET_NO_DATA) {
-            if (s->read_segment->id == s->active_segment) break;
+            if (s->read_segment->id == s->active_segment) {
+                if (flush_staged_for_reader(s)) continue;
+                break;
+            }
             ++s->read_segment_id;
             s->read_offset = SEG_HDR_LEN;
             free_segment(&s->read_segment);
@@ -1475,21 +2007,26 @@ rsRetVal segdiskStoreCompleteBatch(segdisk_store_t *s, batch_t *batch, int *comm
         release_batch_ctx(ctx);
         return RS_RET_OK;
     }
+    rsRetVal r = RS_RET_OK;
+    ++s->grp_depth;
     while (ctx->retry_index < batch->nElem) {
         const int i = ctx->retry_index;
         if (batch->eltState[i] == BATCH_STATE_RDY || batch->eltState[i] == BATCH_STATE_SUB) {
-            rsRetVal r = append_record(s, batch->pElem[i].pMsg, 1, NULL);
-            if (r != RS_RET_OK) {
-                *retried = ctx->retry_count;
-                return r;
-            }
+            r = append_record(s, batch->pElem[i].pMsg, 1, NULL);
+            if (r != RS_RET_OK) break;
             ++ctx->retry_count;
         }
         ++ctx->retry_index;
     }
+    --s->grp_depth;
     *retried = ctx->retry_count;
+    /* The retried copies must be written before the frontier moves past the
+     * originals. This also writes records staged by an enqueuer that is
+     * currently waiting for queue space, which is harmless. */
+    if (r == RS_RET_OK) r = flush_staged(s);
+    if (r != RS_RET_OK) return r;
     ctx->complete = 1;
-    const rsRetVal r = advance_completed(s);
+    r = advance_completed(s);
     if (r == RS_RET_OK) {
         batch->storeData = NULL;
         release_batch_ctx(ctx);
@@ -1499,8 +2036,11 @@ rsRetVal segdiskStoreCompleteBatch(segdisk_store_t *s, batch_t *batch, int *comm
 
 rsRetVal segdiskStoreCheckpoint(segdisk_store_t *s, sbool force_sync) {
     if (s->dir_fd < 0) return RS_RET_OK;
+    rsRetVal r = flush_group(s);
+    if (r == RS_RET_OK) r = flush_block(s);
+    if (r != RS_RET_OK) return r;
     capture_writer(s);
-    const rsRetVal r = write_state(s, force_sync, force_sync);
+    r = write_state(s, force_sync, force_sync);
     if (r == RS_RET_OK) test_fault(s, SEGDISK_TEST_FAULT_CHECKPOINT_PUBLISHED);
     return r;
 }
@@ -1533,6 +2073,10 @@ static void reset_after_dematerialize(segdisk_store_t *s) {
     s->known_queue_size = 0;
     s->updates_since_checkpoint = 0;
     s->dematerializing = 0;
+    s->blk_len = 0;
+    s->blk_records = 0;
+    release_group(s);
+    drop_read_block(s);
     s->stats.bytes = 0;
     s->stats.segments = 0;
     s->stats.retry_overage_bytes = 0;
@@ -1673,14 +2217,19 @@ rsRetVal segdiskStoreClose(segdisk_store_t **ps, sbool empty) {
     segdisk_store_t *s = *ps;
     rsRetVal r = RS_RET_OK;
     if (s->dir_fd < 0) {
+        free(s->blk_buf);
+        free(s->grp_iov);
+        drop_read_block(s);
         free(s->dir);
         free(s->queue_name);
         free(s);
         *ps = NULL;
         return RS_RET_OK;
     }
+    if (!empty) r = flush_group(s);
+    if (!empty && r == RS_RET_OK) r = flush_block(s);
     if (s->active_fd >= 0) {
-        if (!empty && s->active != NULL && s->active->record_count != 0)
+        if (!empty && r == RS_RET_OK && s->active != NULL && s->active->record_count != 0)
             r = seal_active(s);
         else {
             close(s->active_fd);
@@ -1701,6 +2250,13 @@ rsRetVal segdiskStoreClose(segdisk_store_t **ps, sbool empty) {
     }
     free_segment(&s->active);
     free_segment(&s->read_segment);
+    free(s->blk_buf);
+    release_group(s);
+    free(s->grp_iov);
+#ifdef ENABLE_IO_URING
+    if (s->uring_state > 0) io_uring_queue_exit(&s->uring);
+#endif
+    drop_read_block(s);
     while (s->pending_head != NULL) {
         segdisk_batch_ctx_t *n = s->pending_head->next;
         s->pending_head->pending = 0;
@@ -10,10 +10,20 @@
 /** Opaque segmented queue store. All access is serialized by its queue lock. */
 typedef struct segdisk_store_s segdisk_store_t;
 
+/** One-shot block codec, supplied by the queue from the lmzstdw interface. */
+typedef rsRetVal (*segdisk_compress_fn)(
+    const unsigned char *in, size_t in_len, unsigned char **out, size_t *out_len, int level);
+typedef rsRetVal (*segdisk_decompress_fn)(const unsigned char *in, size_t in_len, unsigned char *out, size_t out_len);
+
 /** Configuration captured when a segmented store object is constructed.
  *
  * lazy_create keeps a DA child unmaterialized until its first append. It does
  * not change the eager lifecycle of a pure segmentedDisk queue.
+ *
+ * A non-zero compress_block_size together with a compress callback groups
+ * appended records into compressed blocks of about that many serialized
+ * bytes. decompress may be set without compress so that blocks written by an
+ * earlier configuration remain readable.
  */
 typedef struct segdisk_store_config_s {
     const char *work_dir;
@@ -24,6 +34,10 @@ typedef struct segdisk_store_config_s {
     unsigned int checkpoint_interval;
     sbool sync_files;
     sbool lazy_create;
+    size_t compress_block_size;
+    int compress_level;
+    segdisk_compress_fn compress;
+    segdisk_decompress_fn decompress;
 } segdisk_store_config_t;
 
 /** Monotonic operation counters and current physical store gauges.
@@ -53,6 +67,11 @@ typedef struct segdisk_store_stats_s {
     uint64_t materializations;
     uint64_t dematerializations;
     uint64_t idle_cleanup_failures;
+    uint64_t compressed_blocks;
+    uint64_t compressed_input_bytes;
+    uint64_t compressed_output_bytes;
+    uint64_t group_writes;
+    uint64_t group_records;
 } segdisk_store_stats_t;
 
 #ifdef ENABLE_IMDIAG
@@ -85,12 +104,23 @@ typedef enum segdisk_test_fault_point_e {
  * Dematerialize is destructive and succeeds only when CanDematerialize proves
  * there is no known data, undiscovered recovery work, pending batch, retry,
  * completion, or deletion. Failure leaves a materialized recoverable store.
+ *
+ * BeginAppend/CommitAppend bracket a series of appends that may be written
+ * together. Appends inside the bracket are staged in memory and CommitAppend
+ * writes them with one vectored write and, with sync_files, one data sync.
+ * Brackets may overlap while the queue mutex is temporarily released; every
+ * CommitAppend writes all records staged so far, so a caller never returns
+ * before its own records are written. A failed commit returns the error but
+ * keeps the records staged and retries with the next write, so they stay
+ * counted.
  * Close destroys the object; Dematerialize resets the same object for a later
  * lazy append. GetStats and test-fault operations are safe before lazy
  * materialization.
  */
 rsRetVal segdiskStoreOpen(segdisk_store_t **store, const segdisk_store_config_t *config, int *queue_size);
 rsRetVal segdiskStoreAppend(segdisk_store_t *store, smsg_t *msg, sbool internal_retry, int64_t *written);
+void segdiskStoreBeginAppend(segdisk_store_t *store);
+rsRetVal segdiskStoreCommitAppend(segdisk_store_t *store);
 rsRetVal segdiskStoreDequeueBatch(segdisk_store_t *store, batch_t *batch, int max, int *skipped, int *discovered);
 rsRetVal segdiskStoreCompleteBatch(segdisk_store_t *store, batch_t *batch, int *committed, int *retried);
 rsRetVal segdiskStoreCheckpoint(segdisk_store_t *store, sbool force_sync);
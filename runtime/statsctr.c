@@ -0,0 +1,98 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file statsctr.c
+ * @brief Sharded statistics counters.
+ */
+#include "config.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "typedefs.h"
+#include "atomic.h"
+#include "statsctr.h"
+
+static pthread_once_t onceInit = PTHREAD_ONCE_INIT;
+static pthread_key_t keyThreadIdx;
+static sbool bHaveKey = 0;
+static unsigned nShards = 1;
+static unsigned nextThreadIdx = 0;
+DEF_ATOMIC_HELPER_MUT(mutNextThreadIdx);
+
+
+static void doInit(void) {
+    const long nCPUs = sysconf(_SC_NPROCESSORS_CONF);
+
+    while (nShards < STATSCTR_MAX_SHARDS && (long)nShards < nCPUs) nShards *= 2;
+    bHaveKey = (pthread_key_create(&keyThreadIdx, NULL) == 0);
+    INIT_ATOMIC_HELPER_MUT(mutNextThreadIdx);
+}
+
+
+unsigned statsctrThreadIdx(void) {
+    uintptr_t idx;
+
+    pthread_once(&onceInit, doInit);
+    if (!bHaveKey) return 0; /* all threads share the first shard */
+    idx = (uintptr_t)pthread_getspecific(keyThreadIdx);
+    if (idx == 0) {
+        /* stored + 1, as 0 means "not yet assigned" */
+        idx = ATOMIC_INC_AND_FETCH_unsigned(&nextThreadIdx, &mutNextThreadIdx);
+        pthread_setspecific(keyThreadIdx, (void *)idx);
+    }
+    return (unsigned)(idx - 1);
+}
+
+
+unsigned statsctrNumShards(void) {
+    pthread_once(&onceInit, doInit);
+    return nShards;
+}
+
+
+void statsctrShardedInit(shardedctr_t *const ctr) {
+    const unsigned n = statsctrNumShards();
+
+    ctr->single = 0;
+    /* one spare cache line to align the first slot */
+    ctr->mem = (n > 1) ? calloc(n + 1, STATSCTR_CACHELINE) : NULL;
+    if (ctr->mem == NULL) {
+        ctr->slots = &ctr->single;
+        ctr->mask = 0;
+    } else {
+        const uintptr_t addr = ((uintptr_t)ctr->mem + STATSCTR_CACHELINE - 1) & ~(uintptr_t)(STATSCTR_CACHELINE - 1);
+        ctr->slots = (uint64 *)addr;
+        ctr->mask = n - 1;
+    }
+}
+
+
+void statsctrShardedDestruct(shardedctr_t *const ctr) {
+    free(ctr->mem);
+    ctr->mem = NULL;
+    ctr->slots = &ctr->single;
+    ctr->mask = 0;
+}
+
+
+uint64 statsctrShardedGet(const shardedctr_t *const ctr) {
+    uint64 sum = 0;
+    for (unsigned i = 0; i <= ctr->mask; ++i) sum += PREFER_LOAD_uint64(ctr->slots + i * STATSCTR_SLOT_STRIDE);
+    return sum;
+}
+
+
+void statsctrShardedReset(shardedctr_t *const ctr) {
+    for (unsigned i = 0; i <= ctr->mask; ++i) PREFER_STORE_uint64(ctr->slots + i * STATSCTR_SLOT_STRIDE, 0);
+}
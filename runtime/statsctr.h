@@ -0,0 +1,78 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file statsctr.h
+ * @brief Sharded statistics counters.
+ *
+ * A regular stats counter is a single 64 bit word that every thread
+ * increments atomically. For counters updated for each message by many
+ * threads, such as the enqueue counter of a busy queue, the cache line
+ * holding it moves between cores on every update.
+ *
+ * A sharded counter has one slot per shard, each slot in a cache line of
+ * its own. A thread always updates the slot selected by its thread index,
+ * so threads on different shards never touch the same cache line. The
+ * updates are still atomic, because there can be more threads than shards.
+ * Reading sums up all slots without any locking, so a value read while
+ * updates are going on may be slightly out of date, like with a regular
+ * counter.
+ *
+ * The number of shards is the number of configured CPUs rounded up to a
+ * power of two, capped at STATSCTR_MAX_SHARDS.
+ */
+#ifndef INCLUDED_STATSCTR_H
+#define INCLUDED_STATSCTR_H
+
+#include <stddef.h>
+#include "typedefs.h"
+
+#define STATSCTR_CACHELINE 64 /**< bytes between two slots */
+#define STATSCTR_MAX_SHARDS 64
+#define STATSCTR_SLOT_STRIDE (STATSCTR_CACHELINE / sizeof(uint64))
+
+typedef struct shardedctr_s {
+    uint64 *slots; /**< one slot every STATSCTR_SLOT_STRIDE words */
+    unsigned mask; /**< number of shards - 1 */
+    void *mem; /**< allocation holding the slots, NULL if single is used */
+    uint64 single; /**< the only slot if no shards could be allocated */
+} shardedctr_t;
+
+/** @brief Small number identifying the calling thread, assigned on first use. */
+unsigned statsctrThreadIdx(void);
+
+/** @brief Number of shards counters get; at least 1. */
+unsigned statsctrNumShards(void);
+
+/**
+ * @brief Set up a counter with value 0.
+ *
+ * Never fails: if the shards cannot be allocated, the counter works with a
+ * single slot, just like a regular counter.
+ */
+void statsctrShardedInit(shardedctr_t *ctr);
+
+/** @brief Release the shards; the counter must no longer be updated. */
+void statsctrShardedDestruct(shardedctr_t *ctr);
+
+/** @brief Current value, the sum of all slots. */
+uint64 statsctrShardedGet(const shardedctr_t *ctr);
+
+/** @brief Set all slots to 0; updates made concurrently may get lost. */
+void statsctrShardedReset(shardedctr_t *ctr);
+
+/** @brief The slot the calling thread updates. */
+static inline uint64 *statsctrShardedSlot(shardedctr_t *const ctr) {
+    return ctr->slots + (size_t)(statsctrThreadIdx() & ctr->mask) * STATSCTR_SLOT_STRIDE;
+}
+
+#endif /* #ifndef INCLUDED_STATSCTR_H */
@@ -77,9 +77,19 @@ static statsobj_t *objRoot = NULL;
 static statsobj_t *objLast = NULL;
 
 static pthread_mutex_t mutStats;
-static pthread_mutex_t mutSenders;
 
-static struct hashtable *stats_senders = NULL;
+/* The sender table is split into shards by the hash of the sender name, so
+ * inputs recording different senders rarely share a lock. Known senders are
+ * updated under the read lock of their shard; only adding and removing a
+ * sender takes the write lock.
+ */
+#define SENDER_SHARDS 64
+typedef struct sender_shard_s {
+    pthread_rwlock_t rwlock;
+    struct hashtable *table;
+} sender_shard_t;
+static sender_shard_t senderShards[SENDER_SHARDS];
+static int nSenderShards = 0; /* number of initialized shards, SENDER_SHARDS unless init failed */
 
 /* ------------------------------ statsobj linked list maintenance  ------------------------------ */
 
@@ -254,6 +264,9 @@ static rsRetVal addManagedCounter(statsobj_t *pThis,
         case ctrType_Int:
             ctr->val.pInt = (int *)pCtr;
             break;
+        case ctrType_ShardedCtr:
+            ctr->val.pShardedCtr = (shardedctr_t *)pCtr;
+            break;
         default:
             // No action needed for other cases
             break;
@@ -338,6 +351,9 @@ static void resetResettableCtr(ctr_t *pCtr, int8_t bResetCtrs) {
             case ctrType_Int:
                 resetIntValue(pCtr->val.pInt);
                 break;
+            case ctrType_ShardedCtr:
+                statsctrShardedReset(pCtr->val.pShardedCtr);
+                break;
             default:
                 // No action needed for other cases
                 break;
@@ -379,6 +395,8 @@ static intctr_t accumulatedValue(ctr_t *pCtr) {
             return getIntCtrValue(pCtr->val.pIntCtr);
         case ctrType_Int:
             return (intctr_t)getIntValue(pCtr->val.pInt);
+        case ctrType_ShardedCtr:
+            return statsctrShardedGet(pCtr->val.pShardedCtr);
         default:
             // No action needed for other cases
             break;
@@ -495,6 +513,9 @@ static rsRetVal getStatsLine(statsobj_t *pThis, cstr_t **ppcstr, int8_t bResetCt
             case ctrType_Int:
                 rsCStrAppendInt(pcstr, getIntValue(pCtr->val.pInt));
                 break;
+            case ctrType_ShardedCtr:
+                rsCStrAppendInt(pcstr, statsctrShardedGet(pCtr->val.pShardedCtr));
+                break;
             default:
                 // No action needed for other cases
                 break;
@@ -513,44 +534,52 @@ finalize_it:
 
 
 /* this function obtains all sender stats. hlper to getAllStatsLines()
- * We need to keep this looked to avoid resizing of the hash table
- * (what could otherwise cause a segfault).
+ * Each shard is kept read-locked while it is walked, so that it cannot
+ * be resized underneath us; senders are still updated meanwhile.
  */
 static void getSenderStats(rsRetVal (*cb)(void *, const char *),
                            void *usrptr,
                            statsFmtType_t fmt,
                            const int8_t bResetCtrs) {
-    struct hashtable_itr *itr = NULL;
+    struct hashtable_itr *itr;
     struct sender_stats *stat;
+    uint64 nMsgs;
     char fmtbuf[2048];
 
-    pthread_mutex_lock(&mutSenders);
-
-    /* Iterator constructor only returns a valid iterator if
-     * the hashtable is not empty
-     */
-    if (hashtable_count(stats_senders) > 0) {
-        itr = hashtable_iterator(stats_senders);
-        do {
-            stat = (struct sender_stats *)hashtable_iterator_value(itr);
-            if (fmt == statsFmt_Legacy) {
-                snprintf(fmtbuf, sizeof(fmtbuf), "_sender_stat: sender=%s messages=%" PRIu64, stat->sender,
-                         stat->nMsgs);
-            } else {
-                snprintf(fmtbuf, sizeof(fmtbuf),
-                         "{ \"name\":\"_sender_stat\", "
-                         "\"origin\":\"impstats\", "
-                         "\"sender\":\"%s\", \"messages\":%" PRIu64 "}",
-                         stat->sender, stat->nMsgs);
-            }
-            fmtbuf[sizeof(fmtbuf) - 1] = '\0';
-            cb(usrptr, fmtbuf);
-            if (bResetCtrs) stat->nMsgs = 0;
-        } while (hashtable_iterator_advance(itr));
+    for (int i = 0; i < nSenderShards; ++i) {
+        sender_shard_t *const shard = &senderShards[i];
+
+        pthread_rwlock_rdlock(&shard->rwlock);
+        /* Iterator constructor only returns a valid iterator if
+         * the hashtable is not empty
+         */
+        if (hashtable_count(shard->table) > 0 && (itr = hashtable_iterator(shard->table)) != NULL) {
+            do {
+                stat = (struct sender_stats *)hashtable_iterator_value(itr);
+                if (bResetCtrs) {
+                    do {
+                        nMsgs = PREFER_LOAD_uint64(&stat->nMsgs);
+                    } while (nMsgs != 0 && !ATOMIC_CAS_uint64(&stat->nMsgs, nMsgs, 0, &stat->mutNMsgs));
+                } else {
+                    nMsgs = PREFER_LOAD_uint64(&stat->nMsgs);
+                }
+                if (fmt == statsFmt_Legacy) {
+                    snprintf(fmtbuf, sizeof(fmtbuf), "_sender_stat: sender=%s messages=%" PRIu64, stat->sender,
+                             (uint64_t)nMsgs);
+                } else {
+                    snprintf(fmtbuf, sizeof(fmtbuf),
+                             "{ \"name\":\"_sender_stat\", "
+                             "\"origin\":\"impstats\", "
+                             "\"sender\":\"%s\", \"messages\":%" PRIu64 "}",
+                             stat->sender, (uint64_t)nMsgs);
+                }
+                fmtbuf[sizeof(fmtbuf) - 1] = '\0';
+                cb(usrptr, fmtbuf);
+            } while (hashtable_iterator_advance(itr));
+            free(itr);
+        }
+        pthread_rwlock_unlock(&shard->rwlock);
     }
-
-    free(itr);
-    pthread_mutex_unlock(&mutSenders);
 }
 
 
@@ -741,6 +770,9 @@ static ATTR_NO_SANITIZE_THREAD rsRetVal emitPrometheusForObject(statsobj_t *o,
             case ctrType_Int:
                 value = (uint64_t)getIntValue(pCtr->val.pInt);
                 break;
+            case ctrType_ShardedCtr:
+                value = statsctrShardedGet(pCtr->val.pShardedCtr);
+                break;
             default:
                 value = 0;
                 break;
@@ -755,6 +787,9 @@ static ATTR_NO_SANITIZE_THREAD rsRetVal emitPrometheusForObject(statsobj_t *o,
                 case ctrType_Int:
                     resetIntValue(pCtr->val.pInt);
                     break;
+                case ctrType_ShardedCtr:
+                    statsctrShardedReset(pCtr->val.pShardedCtr);
+                    break;
                 default:
                     break;
             }
@@ -940,6 +975,10 @@ static rsRetVal getAllCounters(statsobj_counter_cb_t cb, void *ctx) {
                     value = (uint64_t)getIntValue(ctr->val.pInt);
                     break;
 
+                case ctrType_ShardedCtr:
+                    value = statsctrShardedGet(ctr->val.pShardedCtr);
+                    break;
+
                 default:
                     value = 0;
                     break;
@@ -947,8 +986,11 @@ static rsRetVal getAllCounters(statsobj_counter_cb_t cb, void *ctx) {
 
             /* Invoke callback with counter metadata and value.
              * Keep mutCtr locked to prevent list modification during iteration.
-             * Callback must not call back into statsobj or deadlock may occur. */
-            rsRetVal localRet = cb(ctx, o->name, o->origin, ctr->name, ctr->ctrType, value, ctr->flags);
+             * Callback must not call back into statsobj or deadlock may occur.
+             * Sharded counters are plain counters to consumers. */
+            rsRetVal localRet =
+                cb(ctx, o->name, o->origin, ctr->name,
+                   (ctr->ctrType == ctrType_ShardedCtr) ? ctrType_IntCtr : ctr->ctrType, value, ctr->flags);
 
             if (localRet != RS_RET_OK) {
                 pthread_mutex_unlock(&o->mutCtr);
@@ -981,40 +1023,83 @@ static rsRetVal enableStats(void) {
 }
 
 
-rsRetVal statsRecordSender(const uchar *sender, unsigned nMsgs, time_t lastSeen) {
+static sender_shard_t *senderShardOf(const uchar *const sender) {
+    unsigned hash = hash_from_string((void *)sender);
+
+    /* the shard's table uses the same hash, so mix it before picking the shard */
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bu;
+    hash ^= hash >> 16;
+    return &senderShards[hash % SENDER_SHARDS];
+}
+
+
+static void updateSender(struct sender_stats *const stat, const unsigned nMsgs, const time_t lastSeen) {
+    ATOMIC_ADD_uint64_RELAXED(&stat->nMsgs, &stat->mutNMsgs, nMsgs);
+    PREFER_STORE_time_t(&stat->lastSeen, lastSeen);
+}
+
+
+/* slow path of statsRecordSender(): the sender is not yet known */
+static rsRetVal addSender(sender_shard_t *const shard, const uchar *const sender, const unsigned nMsgs,
+                          const time_t lastSeen) {
     struct sender_stats *stat;
-    int mustUnlock = 0;
+    int bIsNew = 0;
     DEFiRet;
 
-    if (stats_senders == NULL) FINALIZE; /* unlikely: we could not init our hash table */
-
-    pthread_mutex_lock(&mutSenders);
-    mustUnlock = 1;
-    stat = hashtable_search(stats_senders, (void *)sender);
+    pthread_rwlock_wrlock(&shard->rwlock);
+    /* another thread may have added it since we looked */
+    stat = hashtable_search(shard->table, (void *)sender);
     if (stat == NULL) {
         DBGPRINTF("statsRecordSender: sender '%s' not found, adding\n", sender);
         CHKmalloc(stat = calloc(1, sizeof(struct sender_stats)));
-        stat->sender = (const uchar *)strdup((const char *)sender);
-        stat->nMsgs = 0;
-        if (runConf->globals.reportNewSenders) {
-            LogMsg(0, RS_RET_SENDER_APPEARED, LOG_INFO, "new sender '%s'", stat->sender);
+        if ((stat->sender = (const uchar *)strdup((const char *)sender)) == NULL) {
+            free(stat);
+            ABORT_FINALIZE(RS_RET_OUT_OF_MEMORY);
         }
-        if (hashtable_insert(stats_senders, (void *)stat->sender, (void *)stat) == 0) {
+        INIT_ATOMIC_HELPER_MUT64(stat->mutNMsgs);
+        if (hashtable_insert(shard->table, (void *)stat->sender, (void *)stat) == 0) {
             LogError(errno, RS_RET_INTERNAL_ERROR,
                      "error inserting sender '%s' into sender "
                      "hash table",
                      sender);
+            free((void *)stat->sender);
+            DESTROY_ATOMIC_HELPER_MUT64(stat->mutNMsgs);
+            free(stat);
             ABORT_FINALIZE(RS_RET_INTERNAL_ERROR);
         }
+        bIsNew = 1;
     }
+    updateSender(stat, nMsgs, lastSeen);
 
-    stat->nMsgs += nMsgs;
-    stat->lastSeen = lastSeen;
-    DBGPRINTF("DDDDD: statsRecordSender: '%s', nmsgs %u [%llu], lastSeen %llu\n", sender, nMsgs,
-              (long long unsigned)stat->nMsgs, (long long unsigned)lastSeen);
+finalize_it:
+    pthread_rwlock_unlock(&shard->rwlock);
+    /* reported outside the lock, as this enqueues a message */
+    if (bIsNew && runConf->globals.reportNewSenders) {
+        LogMsg(0, RS_RET_SENDER_APPEARED, LOG_INFO, "new sender '%s'", sender);
+    }
+    RETiRet;
+}
+
+
+rsRetVal statsRecordSender(const uchar *sender, unsigned nMsgs, time_t lastSeen) {
+    sender_shard_t *shard;
+    struct sender_stats *stat;
+    DEFiRet;
+
+    if (nSenderShards != SENDER_SHARDS) FINALIZE; /* unlikely: we could not init our hash tables */
+
+    shard = senderShardOf(sender);
+    pthread_rwlock_rdlock(&shard->rwlock);
+    stat = hashtable_search(shard->table, (void *)sender);
+    if (stat != NULL) updateSender(stat, nMsgs, lastSeen);
+    pthread_rwlock_unlock(&shard->rwlock);
+
+    if (stat == NULL) {
+        CHKiRet(addSender(shard, sender, nMsgs, lastSeen));
+    }
 
 finalize_it:
-    if (mustUnlock) pthread_mutex_unlock(&mutSenders);
     RETiRet;
 }
 
@@ -1038,41 +1123,74 @@ static void destructUnlinkedCounters(ctr_t *ctr) {
     }
 }
 
+/* a removed sender still to be reported, see checkGoneAwaySenders() */
+struct gone_sender {
+    struct gone_sender *next;
+    time_t lastSeen;
+    char sender[];
+};
+
 /* check if a sender has not sent info to us for an extended period
- * of time.
+ * of time. The shards are checked one after the other, so inputs are
+ * only held up while the shard of their sender is being checked.
+ * Removals are reported after the shard is unlocked, as reporting
+ * enqueues a message.
  */
 void checkGoneAwaySenders(const time_t tCurr) {
-    struct hashtable_itr *itr = NULL;
+    struct hashtable_itr *itr;
     struct sender_stats *stat;
     const time_t rqdLast = tCurr - runConf->globals.senderStatsTimeout;
+    struct gone_sender *gone = NULL;
     struct tm tm;
-
-    pthread_mutex_lock(&mutSenders);
-
-    /* Iterator constructor only returns a valid iterator if
-     * the hashtable is not empty
-     */
-    if (hashtable_count(stats_senders) > 0) {
-        itr = hashtable_iterator(stats_senders);
-        do {
-            stat = (struct sender_stats *)hashtable_iterator_value(itr);
-            if (stat->lastSeen < rqdLast) {
-                if (runConf->globals.reportGoneAwaySenders) {
-                    localtime_r(&stat->lastSeen, &tm);
-                    LogMsg(0, RS_RET_SENDER_GONE_AWAY, LOG_WARNING,
-                           "removing sender '%s' from connection "
-                           "table, last seen at "
-                           "%4.4d-%2.2d-%2.2d %2.2d:%2.2d:%2.2d",
-                           stat->sender, tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min,
-                           tm.tm_sec);
+    int bMore;
+
+    for (int i = 0; i < nSenderShards; ++i) {
+        sender_shard_t *const shard = &senderShards[i];
+
+        pthread_rwlock_wrlock(&shard->rwlock);
+        /* Iterator constructor only returns a valid iterator if
+         * the hashtable is not empty
+         */
+        if (hashtable_count(shard->table) > 0 && (itr = hashtable_iterator(shard->table)) != NULL) {
+            do {
+                stat = (struct sender_stats *)hashtable_iterator_value(itr);
+                if (stat->lastSeen < rqdLast) {
+                    if (runConf->globals.reportGoneAwaySenders) {
+                        const size_t lenSender = strlen((const char *)stat->sender);
+                        struct gone_sender *const g = malloc(sizeof(struct gone_sender) + lenSender + 1);
+                        if (g == NULL) {
+                            DBGPRINTF("out of memory, not reporting gone away sender '%s'\n", stat->sender);
+                        } else {
+                            memcpy(g->sender, stat->sender, lenSender + 1);
+                            g->lastSeen = stat->lastSeen;
+                            g->next = gone;
+                            gone = g;
+                        }
+                    }
+                    /* also frees the key, which is stat->sender */
+                    bMore = hashtable_iterator_remove(itr);
+                    DESTROY_ATOMIC_HELPER_MUT64(stat->mutNMsgs);
+                    free(stat);
+                } else {
+                    bMore = hashtable_iterator_advance(itr);
                 }
-                hashtable_remove(stats_senders, (void *)stat->sender);
-            }
-        } while (hashtable_iterator_advance(itr));
+            } while (bMore);
+            free(itr);
+        }
+        pthread_rwlock_unlock(&shard->rwlock);
+
+        while (gone != NULL) {
+            struct gone_sender *const next = gone->next;
+            localtime_r(&gone->lastSeen, &tm);
+            LogMsg(0, RS_RET_SENDER_GONE_AWAY, LOG_WARNING,
+                   "removing sender '%s' from connection "
+                   "table, last seen at "
+                   "%4.4d-%2.2d-%2.2d %2.2d:%2.2d:%2.2d",
+                   gone->sender, tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+            free(gone);
+            gone = next;
+        }
     }
-
-    pthread_mutex_unlock(&mutSenders);
-    free(itr);
 }
 
 /* destructor for the statsobj object */
@@ -1150,13 +1268,16 @@ BEGINAbstractObjClassInit(statsobj, 1, OBJ_IS_CORE_MODULE) /* class, version */
 
     /* init other data items */
     CHKiConcCtrl(pthread_mutex_init(&mutStats, NULL));
-    CHKiConcCtrl(pthread_mutex_init(&mutSenders, NULL));
 
-    if ((stats_senders = create_hashtable(100, hash_from_string, key_equals_string, NULL)) == NULL) {
-        LogError(0, RS_RET_INTERNAL_ERROR,
-                 "error trying to initialize hash-table "
-                 "for sender table. Sender statistics and warnings are disabled.");
-        ABORT_FINALIZE(RS_RET_INTERNAL_ERROR);
+    for (nSenderShards = 0; nSenderShards < SENDER_SHARDS; ++nSenderShards) {
+        sender_shard_t *const shard = &senderShards[nSenderShards];
+        if ((shard->table = create_hashtable(16, hash_from_string, key_equals_string, NULL)) == NULL) {
+            LogError(0, RS_RET_INTERNAL_ERROR,
+                     "error trying to initialize hash-table "
+                     "for sender table. Sender statistics and warnings are disabled.");
+            ABORT_FINALIZE(RS_RET_INTERNAL_ERROR);
+        }
+        pthread_rwlock_init(&shard->rwlock, NULL);
     }
 ENDObjClassInit(statsobj)
 
@@ -1165,6 +1286,9 @@ ENDObjClassInit(statsobj)
 BEGINObjClassExit(statsobj, OBJ_IS_CORE_MODULE) /* class, version */
     /* release objects we no longer need */
     pthread_mutex_destroy(&mutStats);
-    pthread_mutex_destroy(&mutSenders);
-    hashtable_destroy(stats_senders, 1);
+    for (int i = 0; i < nSenderShards; ++i) {
+        pthread_rwlock_destroy(&senderShards[i].rwlock);
+        hashtable_destroy(senderShards[i].table, 1);
+    }
+    nSenderShards = 0;
 ENDObjClassExit(statsobj)
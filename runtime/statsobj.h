@@ -26,7 +26,8 @@
  * describe activity within a subsystem. Each object keeps a doubly
  * linked list of counters and all objects are maintained in a global
  * list protected by a mutex. The counters are either 64 bit integers
- * (ctrType_IntCtr) or plain int values (ctrType_Int) and can be marked
+ * (ctrType_IntCtr), sharded 64 bit integers (ctrType_ShardedCtr, see
+ * statsctr.h) or plain int values (ctrType_Int) and can be marked
  * resettable. Statistics are only gathered while the global
  * ::GatherStats flag is non-zero.
  *
@@ -46,6 +47,7 @@
 #define INCLUDED_STATSOBJ_H
 
 #include "atomic.h"
+#include "statsctr.h"
 
 /* The following data item is somewhat dirty, in that it does not follow
  * our usual object calling conventions. However, much like with "Debug", we
@@ -62,7 +64,7 @@ extern int GatherStats;
 typedef uint64 intctr_t;
 
 /* counter types */
-typedef enum statsCtrType_e { ctrType_IntCtr, ctrType_Int } statsCtrType_t;
+typedef enum statsCtrType_e { ctrType_IntCtr, ctrType_Int, ctrType_ShardedCtr } statsCtrType_t;
 
 /* stats line format types */
 typedef enum statsFmtType_e {
@@ -96,7 +98,8 @@ typedef enum statsFmtType_e {
  * @param obj_name  Name of the statsobj instance (may be NULL/empty)
  * @param obj_origin Origin of the statsobj (e.g., "resource-usage", "core.queue")
  * @param ctr_name  Name of the counter
- * @param ctr_type  Type of counter (ctrType_IntCtr or ctrType_Int)
+ * @param ctr_type  Type of counter (ctrType_IntCtr or ctrType_Int; sharded
+ *                  counters are reported as ctrType_IntCtr)
  * @param value     Current counter value (read atomically for IntCtr, best-effort for Int)
  * @param flags     Counter flags (CTR_FLAG_RESETTABLE, etc.)
  * @return RS_RET_OK to continue iteration, error code to abort
@@ -127,6 +130,7 @@ typedef struct ctr_s {
     union {
         intctr_t *pIntCtr;
         int *pInt;
+        shardedctr_t *pShardedCtr;
     } val;
     int8_t flags;
     struct ctr_s *next, *prev;
@@ -150,10 +154,14 @@ struct statsobj_s {
         statsobj_t *next;
 };
 
+/* entry of the sender table (senders.keepTrack); nMsgs and lastSeen are
+ * updated atomically under the read lock of the sender's shard
+ */
 struct sender_stats {
     const uchar *sender;
-    uint64_t nMsgs;
+    uint64 nMsgs;
     time_t lastSeen;
+    DEF_ATOMIC_HELPER_MUT64(mutNMsgs);
 };
 
 
@@ -303,6 +311,32 @@ void checkGoneAwaySenders(time_t);
 #define STATSCOUNTER_DEC(ctr, mut) \
     if (STATSCOUNTER_ENABLED()) ATOMIC_DEC_uint64_RELAXED(&ctr, &mut);
 
+/* Sharded counters take the same arguments as the regular ones and are
+ * meant for counters that many threads update for each message. They
+ * are registered as ctrType_ShardedCtr and must be released with
+ * STATSCOUNTER_SHARDED_DESTRUCT once the stats object is gone.
+ */
+#define STATSCOUNTER_SHARDED_DEF(ctr, mut) \
+    shardedctr_t ctr;                      \
+    DEF_ATOMIC_HELPER_MUT64(mut);
+
+#define STATSCOUNTER_SHARDED_INIT(ctr, mut) \
+    INIT_ATOMIC_HELPER_MUT64(mut);          \
+    statsctrShardedInit(&(ctr));
+
+#define STATSCOUNTER_SHARDED_DESTRUCT(ctr, mut) \
+    statsctrShardedDestruct(&(ctr));            \
+    DESTROY_ATOMIC_HELPER_MUT64(mut);
+
+#define STATSCOUNTER_SHARDED_INC(ctr, mut) \
+    if (STATSCOUNTER_ENABLED()) ATOMIC_INC_uint64_RELAXED(statsctrShardedSlot(&(ctr)), &mut);
+
+#define STATSCOUNTER_SHARDED_ADD(ctr, mut, delta) \
+    if (STATSCOUNTER_ENABLED()) ATOMIC_ADD_uint64_RELAXED(statsctrShardedSlot(&(ctr)), &mut, delta);
+
+#define STATSCOUNTER_SHARDED_DEC(ctr, mut) \
+    if (STATSCOUNTER_ENABLED()) ATOMIC_DEC_uint64_RELAXED(statsctrShardedSlot(&(ctr)), &mut);
+
 /* the next macro works only if the variable is already guarded
  * by mutex (or the users risks a wrong result). It is assumed
  * that there are not concurrent operations that modify the counter.
@@ -813,6 +813,39 @@ static rsRetVal strmUnreadChar(strm_t *pThis, uchar c) {
     return RS_RET_OK;
 }
 
+/* Read up to and including the next LF, appending everything before it
+ * to pStr. *pC is the character already read and is '\n' on return. This is
+ * the equivalent of
+ *     while (c != '\n') { append c; strmReadChar(&c); }
+ * but takes whole runs from the read buffer instead of single characters.
+ * As with the character loop, what was appended before an error (most
+ * importantly EOF) remains in pStr.
+ */
+static rsRetVal ATTR_NONNULL() strmReadToLF(strm_t *const pThis, cstr_t *const pStr, uchar *const pC) {
+    uchar c = *pC;
+    DEFiRet;
+
+    while (c != '\n') {
+        CHKiRet(cstrAppendChar(pStr, c));
+        if (pThis->iUngetC == -1 && pThis->iBufPtr < pThis->iBufPtrMax) {
+            const uchar *const run = pThis->pIOBuf + pThis->iBufPtr;
+            const size_t avail = pThis->iBufPtrMax - pThis->iBufPtr;
+            const uchar *const lf = memchr(run, '\n', avail);
+            const size_t len = (lf == NULL) ? avail : (size_t)(lf - run);
+            if (len > 0) {
+                CHKiRet(rsCStrAppendStrWithLen(pStr, run, len));
+                pThis->iBufPtr += len;
+                pThis->iCurrOffs += len;
+            }
+        }
+        CHKiRet(strmReadChar(pThis, &c));
+    }
+    *pC = c;
+
+finalize_it:
+    RETiRet;
+}
+
 /* read a 'paragraph' from a strm file.
  * A paragraph may be terminated by a LF, by a LFLF, or by LF<not whitespace> depending on the option set.
  * The termination LF characters are read, but are
@@ -851,10 +884,7 @@ static rsRetVal ATTR_NONNULL(1, 2) strmReadLine(strm_t *const pThis,
         cstrDestruct(&pThis->prevLineSegment);
     }
     if (mode == 0) {
-        while (c != '\n') {
-            CHKiRet(cstrAppendChar(*ppCStr, c));
-            CHKiRet(strmReadChar(pThis, &c));
-        }
+        CHKiRet(strmReadToLF(pThis, *ppCStr, &c));
         if (trimLineOverBytes > 0 && (uint32_t)cstrLen(*ppCStr) > trimLineOverBytes) {
             /* Truncate long line at trimLineOverBytes position */
             dbgprintf("Truncate long line at %u, mode %d\n", trimLineOverBytes, mode);
@@ -866,8 +896,7 @@ static rsRetVal ATTR_NONNULL(1, 2) strmReadLine(strm_t *const pThis,
         finished = 0;
         while (finished == 0) {
             if (c != '\n') {
-                CHKiRet(cstrAppendChar(*ppCStr, c));
-                CHKiRet(strmReadChar(pThis, &c));
+                CHKiRet(strmReadToLF(pThis, *ppCStr, &c));
                 pThis->bPrevWasNL = 0;
             } else {
                 if ((((*ppCStr)->iStrLen) > 0)) {
@@ -938,10 +967,10 @@ static rsRetVal ATTR_NONNULL(1, 2) strmReadLine(strm_t *const pThis,
                         } else {
                             CHKiRet(cstrAppendChar(*ppCStr, c));
                         }
+                        CHKiRet(strmReadChar(pThis, &c));
                     } else {
-                        CHKiRet(cstrAppendChar(*ppCStr, c));
+                        CHKiRet(strmReadToLF(pThis, *ppCStr, &c));
                     }
-                    CHKiRet(strmReadChar(pThis, &c));
                 }
             }
         }
@@ -1028,14 +1057,11 @@ rsRetVal ATTR_NONNULL(1, 2) strmReadMultiLine(strm_t *pThis,
             cstrDestruct(&pThis->prevLineSegment);
         }
 
-        while (c != '\n') {
-            CHKiRet(cstrAppendChar(thisLine, c));
-            readCharRet = strmReadChar(pThis, &c);
-            if (readCharRet == RS_RET_EOF) { /* end of file reached without \n? */
-                CHKiRet(rsCStrConstructFromCStr(&pThis->prevLineSegment, thisLine));
-            }
-            CHKiRet(readCharRet);
+        readCharRet = strmReadToLF(pThis, thisLine, &c);
+        if (readCharRet == RS_RET_EOF) { /* end of file reached without \n? */
+            CHKiRet(rsCStrConstructFromCStr(&pThis->prevLineSegment, thisLine));
         }
+        CHKiRet(readCharRet);
         cstrFinalize(thisLine);
 
         /* we have a line, now let's assemble the message */
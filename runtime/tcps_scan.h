@@ -0,0 +1,114 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file tcps_scan.h
+ * @brief Vectorized frame delimiter search for the tcps_sess bulk framing path.
+ *
+ * The scanner finds the first occurrence of up to two delimiter bytes in a
+ * receive buffer. It uses AVX2, SSE2 or NEON when the compiler targets them
+ * and a scalar loop otherwise; all variants return identical results. Only
+ * full vector loads that stay inside [p, end) are issued, so the helper never
+ * reads past the caller's buffer.
+ */
+#ifndef INCLUDED_TCPS_SCAN_H
+#define INCLUDED_TCPS_SCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+#endif
+
+/**
+ * @brief Marker for an unused delimiter slot in tcpsScanDelim().
+ */
+#define TCPS_SCAN_NO_DELIM -1
+
+static inline const char *tcpsScanDelimScalar(const char *p, const char *const end, const int d1, const int d2) {
+    for (; p < end; ++p) {
+        const int c = (unsigned char)*p;
+        if (c == d1 || c == d2) return p;
+    }
+    return end;
+}
+
+/**
+ * @brief Locate the first byte equal to @p d1 or @p d2.
+ *
+ * @param p   start of the region to scan
+ * @param end one past the last byte of the region
+ * @param d1  first delimiter as unsigned byte value, or TCPS_SCAN_NO_DELIM
+ * @param d2  second delimiter as unsigned byte value, or TCPS_SCAN_NO_DELIM
+ * @return pointer to the first matching byte, or @p end if there is none
+ */
+static inline const char *tcpsScanDelim(const char *p, const char *const end, int d1, int d2) {
+    if (d1 == TCPS_SCAN_NO_DELIM) {
+        d1 = d2;
+        d2 = TCPS_SCAN_NO_DELIM;
+    }
+    if (d1 == TCPS_SCAN_NO_DELIM) return end;
+    if (d2 == TCPS_SCAN_NO_DELIM || d2 == d1) {
+        /* libc memchr() is already vectorized on every platform we care about */
+        const char *const hit = memchr(p, d1, (size_t)(end - p));
+        return (hit == NULL) ? end : hit;
+    }
+
+#if defined(__AVX2__)
+    {
+        const __m256i v1 = _mm256_set1_epi8((char)d1);
+        const __m256i v2 = _mm256_set1_epi8((char)d2);
+        while (end - p >= 32) {
+            const __m256i chunk = _mm256_loadu_si256((const __m256i *)p);
+            const __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, v1), _mm256_cmpeq_epi8(chunk, v2));
+            const uint32_t mask = (uint32_t)_mm256_movemask_epi8(hit);
+            if (mask != 0) return p + __builtin_ctz(mask);
+            p += 32;
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    {
+        const __m128i v1 = _mm_set1_epi8((char)d1);
+        const __m128i v2 = _mm_set1_epi8((char)d2);
+        while (end - p >= 16) {
+            const __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+            const __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(chunk, v1), _mm_cmpeq_epi8(chunk, v2));
+            const unsigned mask = (unsigned)_mm_movemask_epi8(hit);
+            if (mask != 0) return p + __builtin_ctz(mask);
+            p += 16;
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    {
+        const uint8x16_t v1 = vdupq_n_u8((uint8_t)d1);
+        const uint8x16_t v2 = vdupq_n_u8((uint8_t)d2);
+        while (end - p >= 16) {
+            const uint8x16_t chunk = vld1q_u8((const uint8_t *)p);
+            const uint8x16_t hit = vorrq_u8(vceqq_u8(chunk, v1), vceqq_u8(chunk, v2));
+            /* narrow each 16-bit lane by 4 to obtain a 4-bits-per-byte mask */
+            const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+            if (mask != 0) return p + (__builtin_ctzll(mask) >> 2);
+            p += 16;
+        }
+    }
+#endif
+    return tcpsScanDelimScalar(p, end, d1, d2);
+}
+
+#endif /* #ifndef INCLUDED_TCPS_SCAN_H */
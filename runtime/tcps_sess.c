@@ -46,6 +46,7 @@
 #include "net.h"
 #include "tcpsrv.h"
 #include "tcps_sess.h"
+#include "tcps_scan.h"
 #include "obj.h"
 #include "errmsg.h"
 #include "netstrm.h"
@@ -77,6 +78,7 @@ BEGINobjConstruct(tcps_sess) /* be sure to specify the object type also in END m
     pThis->iMsg = 0; /* just make sure... */
     pThis->iMaxLine = glbl.GetMaxLine(runConf);
     pThis->inputState = eAtStrtFram; /* indicate frame header expected */
+    pThis->bFrameNotInSlab = 0;
     pThis->eFraming = TCP_FRAMING_OCTET_STUFFING; /* just make sure... */
     pthread_mutex_init(&pThis->mut, NULL);
     pThis->fromHost = NULL;
@@ -84,6 +86,9 @@ BEGINobjConstruct(tcps_sess) /* be sure to specify the object type also in END m
     pThis->fromHostPort = NULL;
     pThis->iCurrLine = 0;
     pThis->pMsg_save = NULL;
+    pThis->pRcvSlab = NULL;
+    pThis->pRcvSlabData = NULL;
+    pThis->pSessSlab = NULL;
     pThis->tlsProbeBytes = 0;
     pThis->tlsProbeDone = 0;
     pThis->tlsMismatchWarned = 0;
@@ -205,6 +210,7 @@ BEGINobjDestruct(tcps_sess) /* be sure to specify the object type also in END an
     if (pThis->fromHostPort != NULL) CHKiRet(prop.Destruct(&pThis->fromHostPort));
     free(pThis->pMsg);
     free(pThis->pMsg_save);
+    if (pThis->pSessSlab != NULL) rcvslabRelease(pThis->pSessSlab);
 ENDobjDestruct(tcps_sess)
 
 
@@ -375,10 +381,16 @@ static rsRetVal SetOnMsgReceive(tcps_sess_t *pThis, rsRetVal (*OnMsgReceive)(tcp
  * function or some related code).
  * rgerhards, 2009-04-23
  */
-static rsRetVal defaultDoSubmitMessage(tcps_sess_t *pThis,
-                                       struct syslogTime *stTime,
-                                       time_t ttGenTime,
-                                       multi_submit_t *pMultiSub) {
+/*
+ * If pRawRef is not NULL, the iMsg bytes of the frame are not in the session
+ * buffer but at pRawRef inside the current receive slab, and the message
+ * references them instead of copying (see processDataRcvdBulk()).
+ */
+static rsRetVal submitFrame(tcps_sess_t *pThis,
+                            char *const pRawRef,
+                            struct syslogTime *stTime,
+                            time_t ttGenTime,
+                            multi_submit_t *pMultiSub) {
     smsg_t *pMsg;
     rsRetVal localRet;
     DEFiRet;
@@ -398,7 +410,11 @@ static rsRetVal defaultDoSubmitMessage(tcps_sess_t *pThis,
 
     /* we now create our own message object and submit it to the queue */
     CHKiRet(msgConstructWithTime(&pMsg, stTime, ttGenTime));
-    MsgSetRawMsg(pMsg, (char *)pThis->pMsg, pThis->iMsg);
+    if (pRawRef != NULL) {
+        MsgSetRawMsgRef(pMsg, pThis->pRcvSlab, pRawRef, pThis->iMsg);
+    } else {
+        MsgSetRawMsg(pMsg, (char *)pThis->pMsg, pThis->iMsg);
+    }
     MsgSetInputName(pMsg, cnf_params->pInputName);
     if (cnf_params->dfltTZ[0] != '\0') MsgSetDfltTZ(pMsg, (char *)cnf_params->dfltTZ);
     MsgSetFlowControlType(pMsg, pThis->pSrv->bUseFlowControl ? eFLOWCTL_LIGHT_DELAY : eFLOWCTL_NO_DELAY);
@@ -434,6 +450,13 @@ finalize_it:
     RETiRet;
 }
 
+static rsRetVal defaultDoSubmitMessage(tcps_sess_t *pThis,
+                                       struct syslogTime *stTime,
+                                       time_t ttGenTime,
+                                       multi_submit_t *pMultiSub) {
+    return submitFrame(pThis, NULL, stTime, ttGenTime, pMultiSub);
+}
+
 
 /* This should be called before a normal (non forced) close
  * of a TCP session. This function checks if there is any unprocessed
@@ -609,6 +632,7 @@ static rsRetVal ATTR_NONNULL(1) processDataRcvd(tcps_sess_t *pThis,
         if (c >= '0' && c <= '9' && pThis->bSuppOctetFram) {
             pThis->inputState = eInOctetCnt;
             pThis->bFrameOversize = 0;
+            pThis->bFrameNotInSlab = 0;
             pThis->iOctetsRemain = 0;
             pThis->eFraming = TCP_FRAMING_OCTET_COUNTING;
         } else if (c == ' ' && pThis->bSPFramingFix) {
@@ -621,6 +645,7 @@ static rsRetVal ATTR_NONNULL(1) processDataRcvd(tcps_sess_t *pThis,
         } else {
             pThis->inputState = eInMsg;
             pThis->bFrameOversize = 0;
+            pThis->bFrameNotInSlab = 0;
             pThis->eFraming = TCP_FRAMING_OCTET_STUFFING;
         }
     }
@@ -734,6 +759,7 @@ static rsRetVal ATTR_NONNULL(1) processDataRcvd(tcps_sess_t *pThis,
                          "peer: (hostname) %s, (ip) %s, (port) %s: invalid octet count %d.",
                          cnf_params->pszInputName, peerName, peerIP, peerPort, pThis->iOctetsRemain);
                 pThis->eFraming = TCP_FRAMING_OCTET_STUFFING;
+                pThis->bFrameNotInSlab = 1;
             } else if (pThis->iOctetsRemain > pThis->iMaxLine) {
                 pThis->bFrameOversize = 1;
                 /* while we can not do anything against it, we can at least log an indication
@@ -752,6 +778,8 @@ static rsRetVal ATTR_NONNULL(1) processDataRcvd(tcps_sess_t *pThis,
                          "to octet stuffing",
                          cnf_params->pszInputName, peerName, peerIP, peerPort, pThis->iOctetsRemain);
                 pThis->eFraming = TCP_FRAMING_OCTET_STUFFING;
+                /* the digits stay in pMsg, but the delimiter is dropped */
+                pThis->bFrameNotInSlab = 1;
             } else {
                 pThis->iMsg = 0;
             }
@@ -764,6 +792,112 @@ finalize_it:
 }
 
 
+/**
+ * @brief Frame the inner part of a message in bulk.
+ *
+ * Called while the session is inside a message body (or discarding the rest
+ * of a truncated one). Instead of feeding every byte through the
+ * processDataRcvd() state machine, the delimiter is located with the
+ * vectorized scanner (octet stuffing) or derived from the remaining octet
+ * count, and the message body is copied with a single memcpy(). Everything
+ * the byte-wise path treats specially - frame headers, octet counts,
+ * multi-line detection, regex framing and the byte that overflows
+ * maxMessageSize - is left to processDataRcvd().
+ *
+ * When the data lives in a shared receive slab (zero-copy framing), a
+ * delimited frame that started inside the current slab is not copied at all:
+ * the message references it in the slab. In octet-stuffing mode pMsg always
+ * holds exactly the iMsg bytes preceding pData whenever those lie in the
+ * current slab, because the only byte the per-byte path drops (the one that
+ * overflows maxMessageSize) also resets iMsg. The exception is a frame that
+ * fell back from a bad octet count to octet stuffing: pMsg may keep the
+ * digits but not their delimiter, so bFrameNotInSlab forces the copy.
+ * Octet-counted frames are still copied because the byte after them belongs to the next frame and can not
+ * take the terminating NUL.
+ *
+ * @return number of bytes consumed; 0 means the caller must process the
+ *         next byte through processDataRcvd().
+ */
+static size_t ATTR_NONNULL(1, 2, 4, 6, 7) processDataRcvdBulk(tcps_sess_t *const pThis,
+                                                              const char *const pData,
+                                                              const size_t avail,
+                                                              struct syslogTime *const stTime,
+                                                              const time_t ttGenTime,
+                                                              multi_submit_t *const pMultiSub,
+                                                              unsigned *const __restrict__ pnMsgs) {
+    const tcpsrv_t *const pSrv = pThis->pSrv;
+    size_t room;
+    size_t len;
+
+    if (pThis->eFraming == TCP_FRAMING_OCTET_COUNTING) {
+        if (pThis->iOctetsRemain < 1) return 0;
+        len = (size_t)pThis->iOctetsRemain;
+        if (len > avail) len = avail;
+        if (pThis->inputState == eInMsg) {
+            room = (size_t)(pThis->iMaxLine - pThis->iMsg);
+            if (len > room) len = room;
+            if (len == 0) return 0;
+            memcpy(pThis->pMsg + pThis->iMsg, pData, len);
+            pThis->iMsg += (int)len;
+            pThis->iOctetsRemain -= (int)len;
+            if (pThis->iOctetsRemain < 1) {
+                defaultDoSubmitMessage(pThis, stTime, ttGenTime, pMultiSub);
+                ++(*pnMsgs);
+                pThis->inputState = eAtStrtFram;
+            }
+        } else {
+            pThis->iOctetsRemain -= (int)len;
+            if (pThis->iOctetsRemain < 1) pThis->inputState = eAtStrtFram;
+        }
+        return len;
+    }
+
+    /* octet stuffing. The byte-wise path compares a plain (possibly signed)
+     * char against the int delimiter, so delimiters outside the char range
+     * never match there - mirror that to keep framing identical. */
+    const int d1 = pSrv->bDisableLFDelim ? TCPS_SCAN_NO_DELIM : '\n';
+    const int d2 = (pSrv->addtlFrameDelim != TCPSRV_NO_ADDTL_DELIMITER &&
+                    (int)(char)pSrv->addtlFrameDelim == pSrv->addtlFrameDelim)
+                       ? (unsigned char)pSrv->addtlFrameDelim
+                       : TCPS_SCAN_NO_DELIM;
+    const char *const pDelim = tcpsScanDelim(pData, pData + avail, d1, d2);
+    const sbool bFoundDelim = pDelim < pData + avail;
+    len = (size_t)(pDelim - pData);
+
+    if (pThis->inputState == eInMsgTruncating) {
+        if (!bFoundDelim) return avail;
+        pThis->inputState = eAtStrtFram;
+        return len + 1;
+    }
+
+    room = (size_t)(pThis->iMaxLine - pThis->iMsg);
+    if (bFoundDelim && len <= room && pThis->pRcvSlab != NULL && pThis->DoSubmitMessage == NULL &&
+        !pThis->bFrameNotInSlab &&
+        (size_t)pThis->iMsg <= (size_t)((const uchar *)pData - pThis->pRcvSlabData) && pThis->iMsg + len > 0) {
+        char *const pFrame = (char *)pData - pThis->iMsg;
+        pThis->iMsg += (int)len;
+        submitFrame(pThis, pFrame, stTime, ttGenTime, pMultiSub);
+        ++(*pnMsgs);
+        pThis->inputState = eAtStrtFram;
+        return len + 1;
+    }
+    if (len > room) {
+        /* copy what fits; the overflowing byte goes through the regular path */
+        memcpy(pThis->pMsg + pThis->iMsg, pData, room);
+        pThis->iMsg += (int)room;
+        return room;
+    }
+    memcpy(pThis->pMsg + pThis->iMsg, pData, len);
+    pThis->iMsg += (int)len;
+    if (!bFoundDelim) return len;
+
+    defaultDoSubmitMessage(pThis, stTime, ttGenTime, pMultiSub);
+    ++(*pnMsgs);
+    pThis->inputState = eAtStrtFram;
+    return len + 1;
+}
+
+
 /* Processes the data received via a TCP session. If there
  * is no other way to handle it, data is discarded.
  * Input parameter data is the data received, iLen is its
@@ -802,10 +936,25 @@ static rsRetVal DataRcvdUncompressed(tcps_sess_t *pThis, char *pData, const size
     multiSub.maxElem = NUM_MULTISUB;
     multiSub.nElem = 0;
 
-    /* We now copy the message to the session buffer. */
+    /* We now copy the message to the session buffer. Message bodies are
+     * framed in bulk, frame headers and the other edge states byte by byte.
+     */
     pEnd = pData + iLen; /* this is one off, which is intentional */
+#ifdef FEATURE_REGEXP
+    const sbool bBulkFraming = !pThis->pLstnInfo->bHasStartRegex && !pThis->pLstnInfo->cnf_params->bMultiLine;
+#else
+    const sbool bBulkFraming = !pThis->pLstnInfo->cnf_params->bMultiLine;
+#endif
 
     while (pData < pEnd) {
+        if (bBulkFraming && (pThis->inputState == eInMsg || pThis->inputState == eInMsgTruncating)) {
+            const size_t consumed =
+                processDataRcvdBulk(pThis, pData, pEnd - pData, &stTime, ttGenTime, &multiSub, &nMsgs);
+            if (consumed > 0) {
+                pData += consumed;
+                continue;
+            }
+        }
         CHKiRet(processDataRcvd(pThis, &pData, pEnd - pData, &stTime, ttGenTime, &multiSub, &nMsgs));
         pData++;
     }
@@ -1167,6 +1316,33 @@ finalize_it:
 }
 
 
+/**
+ * @brief Process data that was received into a shared receive slab.
+ *
+ * Behaves like DataRcvd() but lets delimited frames that are complete inside
+ * the slab reference it instead of being copied (see MsgSetRawMsgRef()).
+ * Decompressed streams are produced into a private buffer and therefore
+ * always take the copying path. The caller keeps its own slab reference and
+ * must not reuse the slab while rcvslabIsShared() reports other owners.
+ */
+static rsRetVal DataRcvdSlab(tcps_sess_t *pThis, rcvslab_t *const pSlab, const size_t iLen) {
+    DEFiRet;
+
+    ISOBJ_TYPE_assert(pThis, tcps_sess);
+    assert(iLen <= pSlab->size);
+
+    if (pThis->compressionMode != TCPSRV_COMPRESS_STREAM_ALWAYS) {
+        pThis->pRcvSlab = pSlab;
+        pThis->pRcvSlabData = pSlab->buf;
+    }
+    iRet = DataRcvd(pThis, (char *)pSlab->buf, iLen);
+    pThis->pRcvSlab = NULL;
+    pThis->pRcvSlabData = NULL;
+
+    RETiRet;
+}
+
+
 /* queryInterface function
  * rgerhards, 2008-02-29
  */
@@ -1189,6 +1365,7 @@ BEGINobjQueryInterface(tcps_sess)
     pIf->PrepareClose = PrepareClose;
     pIf->Close = Close;
     pIf->DataRcvd = DataRcvd;
+    pIf->DataRcvdSlab = DataRcvdSlab;
 
     pIf->SetUsrP = SetUsrP;
     pIf->SetTcpsrv = SetTcpsrv;
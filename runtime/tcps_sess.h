@@ -25,6 +25,7 @@
 #include "rsyslog.h"
 #include "obj.h"
 #include "prop.h"
+#include "rcvslab.h"
 #include <zlib.h>
 
 /* a forward-definition, we are somewhat cyclic */
@@ -59,9 +60,14 @@ struct tcps_sess_s {
             eInMsgCheckMultiLine
         } inputState; /* our current state */
         sbool bFrameOversize; /* current frame exceeded maxMessageSize before submit */
+        sbool bFrameNotInSlab; /* pMsg holds bytes that differ from the slab, e.g. the octet count
+                                * of a frame that fell back to octet stuffing; no zero-copy submit */
         int iOctetsRemain; /* Number of Octets remaining in message */
         TCPFRAMINGMODE eFraming;
         uchar *pMsg; /* message (fragment) received */
+        rcvslab_t *pRcvSlab; /**< slab holding the data currently processed, NULL if not zero-copy */
+        const uchar *pRcvSlabData; /**< first byte of the current slab data */
+        rcvslab_t *pSessSlab; /**< zero-copy receive slab kept across reads, owned by tcpsrv's doReceive() */
         prop_t *fromHost; /* host name we received messages from */
         prop_t *fromHostIP;
         prop_t *fromHostPort;
@@ -114,8 +120,10 @@ BEGINinterface(tcps_sess) /* name must also be changed in ENDinterface macro! */
     rsRetVal (*SetStrm)(tcps_sess_t *pThis, netstrm_t *);
     rsRetVal (*SetMsgIdx)(tcps_sess_t *pThis, int);
     rsRetVal (*SetOnMsgReceive)(tcps_sess_t *pThis, rsRetVal (*OnMsgReceive)(tcps_sess_t *, uchar *, int));
+    /* v5: zero-copy reception from a shared receive slab */
+    rsRetVal (*DataRcvdSlab)(tcps_sess_t *pThis, rcvslab_t *pSlab, size_t iLen);
 ENDinterface(tcps_sess)
-#define tcps_sessCURR_IF_VERSION 4 /* increment whenever you change the interface structure! */
+#define tcps_sessCURR_IF_VERSION 5 /* increment whenever you change the interface structure! */
 /* interface changes
  * to version v2, rgerhards, 2009-05-22
  * - Data structures changed
@@ -124,6 +132,8 @@ ENDinterface(tcps_sess)
  * - signature of SetHostIP() changed
  * version 4, 2025-01-??:
  * - SetHostPort() entry point added
+ * version 5, 2026-10-17:
+ * - DataRcvdSlab() entry point added
  */
 
 
@@ -960,6 +960,28 @@ finalize_it:
 #endif
 
 
+/**
+ * @brief Provide the zero-copy receive slab for the next read.
+ *
+ * The slab lives as long as the session. Only when messages from an earlier
+ * read still reference it is it handed over to them and replaced by a fresh
+ * one; otherwise it is reused as is.
+ *
+ * @return the slab to read into, or NULL if none could be allocated (the
+ *         caller then falls back to its private, copying buffer).
+ */
+static rcvslab_t *getRcvSlab(rcvslab_t **const ppSlab, const size_t size) {
+    if (*ppSlab != NULL && (rcvslabIsShared(*ppSlab) || (*ppSlab)->size < size)) {
+        rcvslabRelease(*ppSlab);
+        *ppSlab = NULL;
+    }
+    if (*ppSlab == NULL && rcvslabConstruct(ppSlab, size) != RS_RET_OK) {
+        *ppSlab = NULL;
+    }
+    return *ppSlab;
+}
+
+
 /**
  * @brief Receive and dispatch data for a TCP session with starvation control and EPOLL re-arm.
  *
@@ -980,12 +1002,17 @@ finalize_it:
  *  - `read_calls` counts only successful reads (RS_RET_OK), so the cap reflects actual data
  *    consumption, not retries/closures/errors.
  *
+ * Zero-copy framing:
+ *  - With `bZeroCopyFraming`, data is read into the session's refcounted receive slab that
+ *    frames may reference directly. Reads shorter than half the slab are processed by copy,
+ *    so queued messages never pin a mostly empty slab and the slab stays reusable.
+ *
  * @pre  `pioDescr`, `pioDescr->ptr.pSess`, and `pioDescr->pSrv` are valid; I/O is non-blocking.
  * @post On close paths, both `pioDescr` and `pSess` are invalid on return.
  */
 static rsRetVal ATTR_NONNULL(1)
     doReceive(tcpsrv_io_descr_t *const pioDescr, tcpsrvWrkrData_t *const wrkrData ATTR_UNUSED) {
-    char buf[128 * 1024]; /* reception buffer - may hold a partial or multiple messages */
+    char buf[TCPSRV_RCV_BUF_SIZE]; /* reception buffer - may hold a partial or multiple messages */
     ssize_t iRcvd;
     rsRetVal localRet;
     DEFiRet;
@@ -1031,7 +1058,9 @@ static rsRetVal ATTR_NONNULL(1)
             case RS_READING:
                 /* maxReads==0 is intentional and documented: it disables starvation protection. */
                 while (state == RS_READING && (maxReads == 0 || read_calls < maxReads)) {
-                    iRet = pThis->pRcvData(pSess, buf, sizeof(buf), &iRcvd, &oserr, &pioDescr->ioDirection);
+                    rcvslab_t *const pRcvSlab = pThis->bZeroCopyFraming ? getRcvSlab(&pSess->pSessSlab, sizeof(buf)) : NULL;
+                    iRet = pThis->pRcvData(pSess, (pRcvSlab == NULL) ? buf : (char *)pRcvSlab->buf, sizeof(buf),
+                                           &iRcvd, &oserr, &pioDescr->ioDirection);
 
                     switch (iRet) {
                         case RS_RET_CLOSED:
@@ -1058,7 +1087,13 @@ static rsRetVal ATTR_NONNULL(1)
                             if (pThis->workQueue.numWrkr > 1) {
                                 ++read_calls;
                             }
-                            localRet = tcps_sess.DataRcvd(pSess, buf, iRcvd);
+                            if (pRcvSlab == NULL) {
+                                localRet = tcps_sess.DataRcvd(pSess, buf, iRcvd);
+                            } else if ((size_t)iRcvd < pRcvSlab->size / 2) {
+                                localRet = tcps_sess.DataRcvd(pSess, (char *)pRcvSlab->buf, iRcvd);
+                            } else {
+                                localRet = tcps_sess.DataRcvdSlab(pSess, pRcvSlab, iRcvd);
+                            }
                             if (localRet != RS_RET_OK && localRet != RS_RET_QUEUE_FULL) {
                                 LogError(oserr, localRet, "Tearing down TCP Session from %s:%s", peerIP, peerPort);
                                 state = RS_DONECLOSE;
@@ -1807,6 +1842,7 @@ BEGINobjConstruct(tcpsrv) /* be sure to specify the object type also in END macr
     pThis->pszDrvrName = NULL;
     pThis->bPreserveCase = 1; /* preserve case in fromhost; default to true. */
     pThis->iSynBacklog = 0; /* default: unset */
+    pThis->bZeroCopyFraming = 0;
     pThis->DrvrTlsVerifyDepth = 0;
     pThis->DrvrTlsRevocationCheck = 0;
     pThis->compressionMode = TCPSRV_COMPRESS_NEVER;
@@ -2366,6 +2402,12 @@ static rsRetVal ATTR_NONNULL(1) SetStarvationMaxReads(tcpsrv_t *pThis, const uns
 }
 
 
+static rsRetVal ATTR_NONNULL(1) SetZeroCopyFraming(tcpsrv_t *pThis, const int bZeroCopyFraming) {
+    pThis->bZeroCopyFraming = bZeroCopyFraming;
+    return RS_RET_OK;
+}
+
+
 static rsRetVal ATTR_NONNULL(1) SetNumWrkr(tcpsrv_t *pThis, const int numWrkr) {
     pThis->workQueue.numWrkr = numWrkr;
     return RS_RET_OK;
@@ -2449,6 +2491,7 @@ BEGINobjQueryInterface(tcpsrv)
     pIf->SetSynBacklog = SetSynBacklog;
     pIf->SetNumWrkr = SetNumWrkr;
     pIf->SetStarvationMaxReads = SetStarvationMaxReads;
+    pIf->SetZeroCopyFraming = SetZeroCopyFraming;
 
 finalize_it:
 ENDobjQueryInterface(tcpsrv)
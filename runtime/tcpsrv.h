@@ -139,6 +139,10 @@ struct tcpsrv_io_descr_s {
 };
 
 #define TCPSRV_NO_ADDTL_DELIMITER -1 /* specifies that no additional delimiter is to be used in TCP framing */
+/**
+ * @brief Size of a single session read (stack buffer or zero-copy receive slab).
+ */
+#define TCPSRV_RCV_BUF_SIZE (128 * 1024)
 
 /* the tcpsrv object */
 struct tcpsrv_s {
@@ -207,6 +211,7 @@ struct tcpsrv_s {
         unsigned int ratelimitBurst;
         tcps_sess_t **pSessions; /**< array of all of our sessions */
         unsigned int starvationMaxReads;
+        sbool bZeroCopyFraming; /**< let frames reference the receive buffer instead of copying */
         void *pUsr; /**< a user-settable pointer (provides extensibility for "derived classes")*/
         /* callbacks */
         int (*pIsPermittedHost)(struct sockaddr *addr, char *fromHostFQDN, void *pUsrSrv, void *pUsrSess);
@@ -355,9 +360,11 @@ BEGINinterface(tcpsrv) /* name must also be changed in ENDinterface macro! */
      */
     rsRetVal (*SetNetworkNamespace)(tcpsrv_t *pThis, tcpLstnParams_t *const cnf_params,
                                     const char *const networkNamespace);
+    /* added v33 */
+    rsRetVal (*SetZeroCopyFraming)(tcpsrv_t *pThis, int);
 
 ENDinterface(tcpsrv)
-#define tcpsrvCURR_IF_VERSION 32 /* increment whenever you change the interface structure! */
+#define tcpsrvCURR_IF_VERSION 33 /* increment whenever you change the interface structure! */
 /* change for v4:
  * - SetAddtlFrameDelim() added -- rgerhards, 2008-12-10
  * - SetInputName() added -- rgerhards, 2008-12-10
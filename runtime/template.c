@@ -1034,12 +1034,10 @@ rsRetVal tplToJSON(struct template *pTpl, smsg_t *pMsg, struct json_object **pjs
     DEFiRet;
 
     if (pTpl->bHaveSubtree) {
-        if (jsonFind(pMsg, &pTpl->subtree, pjson) != RS_RET_OK) *pjson = NULL;
+        if (jsonFindRef(pMsg, &pTpl->subtree, pjson) != RS_RET_OK) *pjson = NULL;
         if (*pjson == NULL) {
             /* we need to have a root object! */
             *pjson = json_object_new_object();
-        } else {
-            json_object_get(*pjson); /* inc refcount */
         }
         FINALIZE;
     }
@@ -1159,7 +1157,7 @@ rsRetVal doEscape(uchar **pp, rs_size_t *pLen, unsigned short *pbMustBeFreed, in
     else if (mode == SQL_ESCAPE)
         for (p = *pp; *p && *p != '\'' && *p != '\\'; ++p);
     else if (mode == JSON_ESCAPE)
-        for (p = *pp; *p && (*p == '"' || *p == '\\'); ++p);
+        p = *pp + strcspn((char *)*pp, "\"\\");
     /* when we get out of the loop, we are either at the
      * string terminator or the first character to escape */
     if (p && *p == '\0') FINALIZE; /* nothing to do in this case! */
@@ -302,6 +302,7 @@ struct msgPropDescr_s {
     propid_t id;
     uchar *name; /* name and lenName are only set for dynamic */
     int nameLen; /* properties (JSON) */
+    struct jsonPath_s *path; /* JSON properties: name split into its components, NULL if not precompiled */
 };
 
 /* some forward-definitions from the grammar */
@@ -250,6 +250,12 @@ rsRetVal wtiNewIParam(wti_t *const pWti, action_t *const pAction, actWrkrIParams
         if (allocCount > SIZE_MAX / sizeof(actWrkrIParams_t)) {
             ABORT_FINALIZE(RS_RET_OUT_OF_MEMORY);
         }
+        if (pAction->pLatency != NULL) {
+            uint64_t *latencyRcvd;
+            /* grown first, so that a failure leaves iparams consistent */
+            CHKmalloc(latencyRcvd = realloc(wrkrInfo->p.tx.latencyRcvd, sizeof(uint64_t) * newMax));
+            wrkrInfo->p.tx.latencyRcvd = latencyRcvd;
+        }
         CHKmalloc(iparams = realloc(wrkrInfo->p.tx.iparams, sizeof(actWrkrIParams_t) * allocCount));
         startOffset = (size_t)wrkrInfo->p.tx.currIParam * (size_t)pAction->iNumTpls;
         zeroCount = ((size_t)newMax - (size_t)wrkrInfo->p.tx.maxIParams) * (size_t)pAction->iNumTpls;
@@ -495,6 +501,8 @@ PRAGMA_IGNORE_Wempty_body rsRetVal wtiWorker(wti_t *__restrict__ const pThis) {
                 }
                 free(wrkrInfo->p.tx.iparams);
                 wrkrInfo->p.tx.iparams = NULL;
+                free(wrkrInfo->p.tx.latencyRcvd);
+                wrkrInfo->p.tx.latencyRcvd = NULL;
                 wrkrInfo->p.tx.currIParam = 0;
                 wrkrInfo->p.tx.maxIParams = 0;
             } else {
@@ -60,6 +60,7 @@ typedef struct actWrkrInfo {
             actWrkrIParams_t *iparams; /* dynamically sized array for transactional outputs */
             int currIParam;
             int maxIParams; /* current max */
+            uint64_t *latencyRcvd; /* latency stamp per iparam, only if the action has a histogram */
         } tx;
         struct {
             actWrkrIParams_t actParams[CONF_OMOD_NUMSTRINGS_MAXSIZE];
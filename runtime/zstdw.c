@@ -22,6 +22,7 @@
  */
 
 #include "config.h"
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include <zstd.h>
@@ -142,6 +143,45 @@ done:
 }
 
 
+/* Compress a complete buffer into a newly allocated frame. The caller must
+ * free *ppOut. The frame carries no zstd checksum because the callers
+ * already protect the stored bytes with their own CRC.
+ */
+static rsRetVal zstd_compressBlock(const uchar *pIn, size_t lenIn, uchar **ppOut, size_t *pLenOut, int level) {
+    uchar *pOut = NULL;
+    DEFiRet;
+
+    const size_t bound = ZSTD_compressBound(lenIn);
+    CHKmalloc(pOut = malloc(bound));
+    const size_t len = ZSTD_compress(pOut, bound, pIn, lenIn, level);
+    if (ZSTD_isError(len)) {
+        LogError(0, RS_RET_ZLIB_ERR, "error returned from ZSTD_compress(): %s", ZSTD_getErrorName(len));
+        ABORT_FINALIZE(RS_RET_ZLIB_ERR);
+    }
+    *ppOut = pOut;
+    *pLenOut = len;
+    pOut = NULL;
+
+finalize_it:
+    free(pOut);
+    RETiRet;
+}
+
+
+/* Decompress a frame created by zstd_compressBlock(). The caller knows the
+ * exact decompressed size; any other result is reported as an error.
+ */
+static rsRetVal zstd_decompressBlock(const uchar *pIn, size_t lenIn, uchar *pOut, size_t lenOut) {
+    DEFiRet;
+
+    const size_t len = ZSTD_decompress(pOut, lenOut, pIn, lenIn);
+    if (ZSTD_isError(len) || len != lenOut) ABORT_FINALIZE(RS_RET_ZLIB_ERR);
+
+finalize_it:
+    RETiRet;
+}
+
+
 /* queryInterface function
  * rgerhards, 2008-03-05
  */
@@ -153,6 +193,8 @@ BEGINobjQueryInterface(zstdw)
     pIf->doStrmWrite = zstd_doStrmWrite;
     pIf->doCompressFinish = zstd_doCompressFinish;
     pIf->Destruct = zstd_Destruct;
+    pIf->compressBlock = zstd_compressBlock;
+    pIf->decompressBlock = zstd_decompressBlock;
 finalize_it:
 ENDobjQueryInterface(zstdw)
 
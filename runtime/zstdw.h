@@ -29,8 +29,11 @@ BEGINinterface(zstdw) /* name must also be changed in ENDinterface macro! */
                             rsRetVal (*strmPhysWrite)(strm_t *pThis, uchar *pBuf, size_t lenBuf));
     rsRetVal (*doCompressFinish)(strm_t *pThis, rsRetVal (*Destruct)(strm_t *pThis, uchar *pBuf, size_t lenBuf));
     rsRetVal (*Destruct)(strm_t *pThis);
+    /* v2: one-shot buffer compression, used for segmentedDisk record blocks */
+    rsRetVal (*compressBlock)(const uchar *pIn, size_t lenIn, uchar **ppOut, size_t *pLenOut, int level);
+    rsRetVal (*decompressBlock)(const uchar *pIn, size_t lenIn, uchar *pOut, size_t lenOut);
 ENDinterface(zstdw)
-#define zstdwCURR_IF_VERSION 1 /* increment whenever you change the interface structure! */
+#define zstdwCURR_IF_VERSION 2 /* increment whenever you change the interface structure! */
 
 
 /* prototypes */
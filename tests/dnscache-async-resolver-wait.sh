@@ -0,0 +1,27 @@
+#!/bin/bash
+# With reverselookup.resolver.publishIP="off", sessions wait for the async
+# (stub) resolver and always get the name.
+# This file is part of the rsyslog project, released under ASL 2.0.
+. ${srcdir:=.}/diag.sh init
+skip_ASAN "LD_PRELOAD conflicts with ASan runtime load order"
+export NUMMESSAGES=100
+export RSYSLOG_PRELOAD=".libs/liboverride_getnameinfo.so"
+export RSYSLOG_GETNAMEINFO_DELAY_MS=500
+export RSYSLOG_GETNAMEINFO_LOG="$RSYSLOG_DYNNAME.getnameinfo.log"
+generate_conf
+add_conf '
+global(reverselookup.resolver.threads="2" reverselookup.resolver.publishIP="off")
+module(load="../plugins/imtcp/.libs/imtcp")
+input(type="imtcp" address="127.0.0.1" port="0" listenPortFileName="'$RSYSLOG_DYNNAME'.tcpflood_port")
+
+template(name="outfmt" type="string" string="%fromhost% %msg:F,58:2%\n")
+:msg, contains, "msgnum:" action(type="omfile" template="outfmt"
+			         file="'$RSYSLOG_OUT_LOG'")
+'
+startup
+tcpflood -m$NUMMESSAGES -c10
+shutdown_when_empty
+wait_shutdown
+content_count_check "stub.example.net " $NUMMESSAGES
+content_count_check "lookup" 1 "$RSYSLOG_GETNAMEINFO_LOG"
+exit_test
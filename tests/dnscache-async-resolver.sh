@@ -0,0 +1,34 @@
+#!/bin/bash
+# With reverselookup.resolver.threads, a session from a source whose name
+# is still being looked up must get the IP as hostname instead of waiting
+# for the (stub) resolver; later sessions get the name, which is looked up
+# only once.
+# This file is part of the rsyslog project, released under ASL 2.0.
+. ${srcdir:=.}/diag.sh init
+skip_ASAN "LD_PRELOAD conflicts with ASan runtime load order"
+export NUMMESSAGES=20
+export RSYSLOG_PRELOAD=".libs/liboverride_getnameinfo.so"
+export RSYSLOG_GETNAMEINFO_DELAY_MS=4000
+export RSYSLOG_GETNAMEINFO_LOG="$RSYSLOG_DYNNAME.getnameinfo.log"
+generate_conf
+add_conf '
+global(reverselookup.resolver.threads="2")
+module(load="../plugins/imtcp/.libs/imtcp")
+input(type="imtcp" address="127.0.0.1" port="0" listenPortFileName="'$RSYSLOG_DYNNAME'.tcpflood_port")
+
+template(name="outfmt" type="string" string="%fromhost% %msg:F,58:2%\n")
+:msg, contains, "msgnum:" action(type="omfile" template="outfmt"
+			         file="'$RSYSLOG_OUT_LOG'")
+'
+startup
+tcpflood -m10
+wait_file_lines "$RSYSLOG_OUT_LOG" 10
+wait_file_lines "$RSYSLOG_GETNAMEINFO_LOG" 1
+./msleep 500 # let the resolver publish the name
+tcpflood -m10 -i10
+shutdown_when_empty
+wait_shutdown
+content_count_check --regex '^127\.0\.0\.1 0000000[0-9]$' 10
+content_count_check --regex '^stub\.example\.net 0000001[0-9]$' 10
+content_count_check "lookup" 1 "$RSYSLOG_GETNAMEINFO_LOG"
+exit_test
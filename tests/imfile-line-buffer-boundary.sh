@@ -0,0 +1,49 @@
+#!/bin/bash
+# Lines of varying length, many of them crossing the read buffer boundary,
+# must arrive unchanged and the persisted offset must resume exactly at the
+# next line after a restart.
+# This is part of the rsyslog testbench, licensed under ASL 2.0
+. ${srcdir:=.}/diag.sh init
+export NUMMESSAGES=400
+export NUMMESSAGES_HALF=$((NUMMESSAGES / 2))
+generate_conf
+add_conf '
+global(workDirectory="'${RSYSLOG_DYNNAME}'.spool" maxMessageSize="16k")
+
+module(load="../plugins/imfile/.libs/imfile")
+
+input(type="imfile" file="./'$RSYSLOG_DYNNAME'.input" tag="file:" readMode="0"
+      persistStateInterval="1")
+
+template(name="outfmt" type="string" string="%msg%\n")
+if $msg contains "msgnum:" then
+	action(type="omfile" file="'$RSYSLOG_OUT_LOG'" template="outfmt")
+'
+genlines() {
+	awk -v from="$1" -v to="$2" 'BEGIN {
+		for (i = from; i < to; ++i) {
+			line = sprintf("msgnum:%08d:", i)
+			for (k = (i * 1237) % 9000; k > 0; --k) line = line "X"
+			print line
+		}
+	}'
+}
+genlines 0 $NUMMESSAGES_HALF > $RSYSLOG_DYNNAME.input
+startup
+wait_file_lines $RSYSLOG_OUT_LOG $NUMMESSAGES_HALF
+shutdown_when_empty
+wait_shutdown
+
+genlines $NUMMESSAGES_HALF $NUMMESSAGES >> $RSYSLOG_DYNNAME.input
+startup
+wait_file_lines $RSYSLOG_OUT_LOG $NUMMESSAGES
+shutdown_when_empty
+wait_shutdown
+
+genlines 0 $NUMMESSAGES > $RSYSLOG_DYNNAME.expected
+if ! cmp -s $RSYSLOG_DYNNAME.expected $RSYSLOG_OUT_LOG; then
+	echo "FAIL: output differs from input"
+	diff $RSYSLOG_DYNNAME.expected $RSYSLOG_OUT_LOG | head -c 2000
+	error_exit 1
+fi
+exit_test
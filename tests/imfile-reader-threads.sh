@@ -0,0 +1,66 @@
+#!/bin/bash
+# Reads several files through a pool of reader threads, one of them much
+# busier than the others. Every file must be delivered completely and in
+# order, and the state files written by the readers must let a restarted
+# instance continue exactly where it left off.
+# This is part of the rsyslog testbench, licensed under ASL 2.0
+. ${srcdir:=.}/diag.sh init
+. $srcdir/diag.sh check-inotify-only
+export NUMFILES=8
+export HOTLINES=20000
+export LINES=500
+export NUMMESSAGES=$(((HOTLINES + (NUMFILES - 1) * LINES) * 2))
+generate_conf
+add_conf '
+global(workDirectory="'${RSYSLOG_DYNNAME}'.spool")
+
+module(load="../plugins/imfile/.libs/imfile" mode="inotify" readerThreads="4")
+
+input(type="imfile" file="./'$RSYSLOG_DYNNAME'.input.*.log" tag="file:"
+      persistStateInterval="100")
+
+template(name="outfmt" type="string" string="%msg%\n")
+if $msg contains "msgnum:" then
+	action(type="omfile" file="'$RSYSLOG_OUT_LOG'" template="outfmt")
+'
+# genlines file from to
+genlines() {
+	awk -v f="$1" -v from="$2" -v to="$3" 'BEGIN {
+		for (i = from; i < to; ++i) printf("file%02d msgnum:%08d:\n", f, i)
+	}'
+}
+# append lines [from, from + count) to every file, the first one gets hot times as many
+appendall() {
+	genlines 0 $(($1 * HOTLINES / LINES)) $((($1 + $2) * HOTLINES / LINES)) >> $RSYSLOG_DYNNAME.input.00.log
+	for i in $(seq 1 $((NUMFILES - 1))); do
+		genlines $i $1 $(($1 + $2)) >> $RSYSLOG_DYNNAME.input.$(printf %02d $i).log
+	done
+}
+
+appendall 0 $((LINES / 2))
+startup
+appendall $((LINES / 2)) $((LINES / 2))
+wait_file_lines $RSYSLOG_OUT_LOG $((NUMMESSAGES / 2))
+shutdown_when_empty
+wait_shutdown
+
+appendall $LINES $LINES
+startup
+wait_file_lines $RSYSLOG_OUT_LOG $NUMMESSAGES
+shutdown_when_empty
+wait_shutdown
+
+for i in $(seq 0 $((NUMFILES - 1))); do
+	f=$(printf %02d $i)
+	if [ $i -eq 0 ]; then
+		genlines 0 0 $((2 * HOTLINES)) > $RSYSLOG_DYNNAME.expected
+	else
+		genlines $i 0 $((2 * LINES)) > $RSYSLOG_DYNNAME.expected
+	fi
+	if ! grep "^file$f " $RSYSLOG_OUT_LOG | cmp -s $RSYSLOG_DYNNAME.expected -; then
+		echo "FAIL: lines of file $f missing, duplicated or out of order"
+		grep "^file$f " $RSYSLOG_OUT_LOG | diff $RSYSLOG_DYNNAME.expected - | head -20
+		error_exit 1
+	fi
+done
+exit_test
@@ -0,0 +1,45 @@
+#!/bin/bash
+# Frames that start with a bad octet count (zero or larger than maxFrameSize)
+# fall back to octet stuffing. They must arrive byte-for-byte the same on a
+# zero-copy listener as on a copying one.
+# added 2026-10-17 by Rainer Gerhards, released under ASL 2.0
+. ${srcdir:=.}/diag.sh init
+export NUMMESSAGES=30000
+export TESTDATA="$RSYSLOG_DYNNAME.testdata"
+for i in $(seq 0 $((NUMMESSAGES - 1))); do
+	case $((i % 3)) in
+	0) printf '<13>host tag: msgnum:%08d\n' $i ;;
+	1) printf '0 <13>host tag: msgnum:%08d\n' $i ;;
+	2) printf '123456 <13>host tag: msgnum:%08d\n' $i ;;
+	esac
+done > "$TESTDATA"
+generate_conf
+add_conf '
+module(load="../plugins/imtcp/.libs/imtcp" maxFrameSize="1000")
+input(type="imtcp" address="127.0.0.1" port="0" listenPortFileName="'$RSYSLOG_DYNNAME'.tcpflood_port"
+      framing.zeroCopy="on" ruleset="zerocopy")
+input(type="imtcp" address="127.0.0.1" port="0" listenPortFileName="'$RSYSLOG_DYNNAME'.tcpflood_port2"
+      ruleset="copy")
+
+template(name="outfmt" type="string" string="%rawmsg%\n")
+ruleset(name="zerocopy") {
+	action(type="omfile" template="outfmt" file="'$RSYSLOG_OUT_LOG'")
+}
+ruleset(name="copy") {
+	action(type="omfile" template="outfmt" file="'$RSYSLOG2_OUT_LOG'")
+}
+'
+startup
+assign_tcpflood_port2 "$RSYSLOG_DYNNAME.tcpflood_port2"
+tcpflood -B -I "$TESTDATA"
+tcpflood -p$TCPFLOOD_PORT2 -B -I "$TESTDATA"
+wait_file_lines "$RSYSLOG_OUT_LOG" $NUMMESSAGES
+wait_file_lines "$RSYSLOG2_OUT_LOG" $NUMMESSAGES
+shutdown_when_empty
+wait_shutdown
+if ! cmp "$RSYSLOG_OUT_LOG" "$RSYSLOG2_OUT_LOG"; then
+	echo "FAIL: zero-copy listener output differs from copying listener"
+	diff "$RSYSLOG_OUT_LOG" "$RSYSLOG2_OUT_LOG" | head -20
+	error_exit 1
+fi
+exit_test
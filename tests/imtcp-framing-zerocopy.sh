@@ -0,0 +1,23 @@
+#!/bin/bash
+# Checks that messages referencing the imtcp receive slab survive the
+# session's next reads and that octet-counted frames still arrive intact.
+# added 2026-10-17 by Rainer Gerhards, released under ASL 2.0
+. ${srcdir:=.}/diag.sh init
+export NUMMESSAGES=20000
+export QUEUE_EMPTY_CHECK_FUNC=wait_file_lines
+generate_conf
+add_conf '
+module(load="../plugins/imtcp/.libs/imtcp" framing.zeroCopy="on")
+input(type="imtcp" address="127.0.0.1" port="0" listenPortFileName="'$RSYSLOG_DYNNAME'.tcpflood_port")
+
+template(name="outfmt" type="string" string="%msg:F,58:2%\n")
+:msg, contains, "msgnum:" action(type="omfile" template="outfmt"
+			         file="'$RSYSLOG_OUT_LOG'")
+'
+startup
+tcpflood -c5 -m $((NUMMESSAGES / 2))
+tcpflood -c5 -O -i $((NUMMESSAGES / 2)) -m $((NUMMESSAGES / 2))
+shutdown_when_empty
+wait_shutdown
+seq_check
+exit_test
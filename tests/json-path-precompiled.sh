@@ -0,0 +1,24 @@
+#!/bin/bash
+# check JSON property paths, which are split into their components at config
+# load: nested members, empty components, array subscripts, keys that only
+# look like subscripts, and paths through missing, null or scalar values
+# Released under ASL 2.0
+. ${srcdir:=.}/diag.sh init
+generate_conf
+add_conf '
+template(name="outfmt" type="string"
+	 string="%$!j!a!b!c%|%$!j!a!!b!c%|%$!j!arr[1]%|%$!j!arr[2]%|%$!j!arr[0]!k%|%$!j!lit[1]%|%$!j!a!x!y%|%$!j!n%|%$!j!s!x%|%$.l!m%\n")
+
+if $msg contains "msgnum:" then {
+	set $.ret = parse_json("{ \"a\": { \"b\": { \"c\": \"abc\" } }, \"arr\": [ { \"k\": \"v\" }, \"one\" ], \"lit[1]\": \"literal\", \"n\": null, \"s\": \"str\" }", "\$!j");
+	set $.l!m = "local";
+	action(type="omfile" file="'$RSYSLOG_OUT_LOG'" template="outfmt")
+}
+'
+startup
+injectmsg 0 1
+shutdown_when_empty
+wait_shutdown
+export EXPECTED='abc|abc|one||v|literal||||local'
+cmp_exact
+exit_test
@@ -0,0 +1,54 @@
+#!/bin/bash
+# check that regex lookup tables keep first-match semantics when most entries
+# are compiled into the table DFA and some (GNU escapes) are not, also after a
+# HUP reload swapped in a reordered table.
+# This file is part of the rsyslog project, released under ASL 2.0
+. ${srcdir:=.}/diag.sh init
+generate_conf
+add_conf '
+lookup_table(name="rx" file="'$RSYSLOG_DYNNAME'.rx.lkp_tbl" reloadOnHUP="on")
+
+template(name="outfmt" type="string" string="%msg%:%$.lkp%\n")
+
+set $.lkp = lookup("rx", $msg);
+
+action(type="omfile" file=`echo $RSYSLOG_OUT_LOG` template="outfmt")
+'
+printf '%s\n' \
+	'{ "version": 1, "nomatch": "none", "type": "regex", "table": [' \
+	'  { "regex": "\\bdisk\\b", "tag": "word" },' \
+	'  { "regex": "^error", "tag": "err" },' \
+	'  { "regex": "disk", "tag": "disk" },' \
+	'  { "regex": "^error.*crit", "tag": "crit" },' \
+	'  { "regex": "(fan|psu)[0-9]+ (failed|missing)$", "tag": "hw" }' \
+	'] }' > "$RSYSLOG_DYNNAME.rx.lkp_tbl"
+startup
+injectmsg_literal '<165>1 2003-03-01T01:00:00.000Z host app - - - error on disk0 crit'
+injectmsg_literal '<165>1 2003-03-01T01:00:00.000Z host app - - - the disk is full'
+injectmsg_literal '<165>1 2003-03-01T01:00:00.000Z host app - - - diskette'
+injectmsg_literal '<165>1 2003-03-01T01:00:00.000Z host app - - - psu2 failed'
+injectmsg_literal '<165>1 2003-03-01T01:00:00.000Z host app - - - psu2 failed again'
+wait_queueempty
+printf '%s\n' \
+	'{ "version": 1, "nomatch": "none", "type": "regex", "table": [' \
+	'  { "regex": "^error.*crit", "tag": "crit" },' \
+	'  { "regex": "disk", "tag": "disk" },' \
+	'  { "regex": "\\bdisk\\b", "tag": "word" }' \
+	'] }' > "$RSYSLOG_DYNNAME.rx.lkp_tbl"
+issue_HUP
+await_lookup_table_reload
+injectmsg_literal '<165>1 2003-03-01T01:00:01.000Z host app - - - error on disk0 crit'
+injectmsg_literal '<165>1 2003-03-01T01:00:01.000Z host app - - - the disk is full'
+injectmsg_literal '<165>1 2003-03-01T01:00:01.000Z host app - - - psu2 failed'
+shutdown_when_empty
+wait_shutdown
+export EXPECTED='error on disk0 crit:err
+the disk is full:word
+diskette:disk
+psu2 failed:hw
+psu2 failed again:none
+error on disk0 crit:crit
+the disk is full:disk
+psu2 failed:none'
+cmp_exact
+exit_test
@@ -0,0 +1,48 @@
+#!/bin/bash
+# check that messages duplicated for queued rulesets share their JSON
+# variables copy-on-write: changes made by one copy, including by the
+# original after the call, must never show up in another one.
+# Released under ASL 2.0
+. ${srcdir:=.}/diag.sh init
+export NUMMESSAGES=100
+generate_conf
+add_conf '
+template(name="outfmt" type="string" string="%$!a!b%|%$!a!c%|%$!x%|%$.l%|%$!a%\n")
+
+ruleset(name="rs_q1" queue.type="LinkedList") {
+	set $!a!c = "q1";
+	unset $!x;
+	set $.l = "q1-local";
+	action(type="omfile" file="'$RSYSLOG2_OUT_LOG'" template="outfmt")
+}
+
+ruleset(name="rs_q2" queue.type="LinkedList") {
+	unset $!a;
+	action(type="omfile" file="'$RSYSLOG_DYNNAME'.q2.log" template="outfmt")
+}
+
+if $msg contains "msgnum:" then {
+	set $!a!b = "orig";
+	set $!x = "x";
+	set $.l = "local";
+	call rs_q1
+	call rs_q2
+	set $!a!b = "main";
+	set $.l = "main-local";
+	action(type="omfile" file="'$RSYSLOG_OUT_LOG'" template="outfmt")
+}
+'
+startup
+injectmsg 0 $NUMMESSAGES
+shutdown_when_empty
+wait_shutdown
+
+expect_lines() {
+	EXPECTED=$(for ((i = 0; i < NUMMESSAGES; ++i)); do printf '%s\n' "$1"; done)
+	export EXPECTED
+	cmp_exact "$2"
+}
+expect_lines 'main||x|main-local|{ "b": "main" }' "$RSYSLOG_OUT_LOG"
+expect_lines 'orig|q1||q1-local|{ "b": "orig", "c": "q1" }' "$RSYSLOG2_OUT_LOG"
+expect_lines '||x|local|' "$RSYSLOG_DYNNAME.q2.log"
+exit_test
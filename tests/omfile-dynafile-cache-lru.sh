@@ -0,0 +1,48 @@
+#!/bin/bash
+# Cycle more dynafile names than the cache holds, so that nearly every
+# message evicts the least recently used file and later reopens it, while a
+# second action with a cache large enough for all names only ever hits. Both
+# must deliver every message to the right file.
+# This file is part of the rsyslog project, released under ASL 2.0
+. ${srcdir:=.}/diag.sh init
+require_plugin imtcp
+export NUMMESSAGES=20000
+export NUMNAMES=200
+generate_conf
+add_conf '
+module(load="../plugins/imtcp/.libs/imtcp")
+input(type="imtcp" address="127.0.0.1" port="0" listenPortFileName="'$RSYSLOG_DYNNAME'.tcpflood_port")
+
+template(name="outfmt" type="string" string="%msg:F,58:2%\n")
+template(name="small" type="string" string="'$RSYSLOG_DYNNAME'.small.%$.name%.log")
+template(name="large" type="string" string="'$RSYSLOG_DYNNAME'.large.%$.name%.log")
+
+if $msg contains "msgnum:" then {
+	set $.name = cnum(field($msg, 58, 2)) % '$NUMNAMES';
+	action(type="omfile" dynafile="small" template="outfmt" dynaFileCacheSize="16")
+	action(type="omfile" dynafile="large" template="outfmt" dynaFileCacheSize="256")
+}
+'
+startup
+tcpflood -m$NUMMESSAGES
+shutdown_when_empty
+wait_shutdown
+for cache in small large; do
+	files=$(ls $RSYSLOG_DYNNAME.$cache.*.log | wc -l)
+	if [ "$files" -ne "$NUMNAMES" ]; then
+		echo "FAIL: $cache cache wrote $files files, expected $NUMNAMES"
+		error_exit 1
+	fi
+	# each file must only hold messages belonging to its name
+	for f in $RSYSLOG_DYNNAME.$cache.*.log; do
+		name=${f%.log}
+		name=${name##*.}
+		if awk -v n="$name" -v m="$NUMNAMES" '($1 + 0) % m != n { exit 1 }' "$f"; then :; else
+			echo "FAIL: $f holds messages of another name"
+			error_exit 1
+		fi
+	done
+	cat $RSYSLOG_DYNNAME.$cache.*.log | sort -n > $RSYSLOG_OUT_LOG
+	seq_check
+done
+exit_test
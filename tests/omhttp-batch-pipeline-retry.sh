@@ -0,0 +1,51 @@
+#!/bin/bash
+# Checks that a failed request of a pipelined transaction makes the core
+# retry the transaction, so no message is lost (duplicates are fine).
+# This file is part of the rsyslog project, released under ASL 2.0
+
+#  Starting actual testbench
+. ${srcdir:=.}/diag.sh init
+export NUMMESSAGES=20000
+export SEQ_CHECK_OPTIONS="-d"
+
+omhttp_start_server 0 --threaded --fail-every 50
+
+generate_conf
+add_conf '
+template(name="tpl" type="string"
+	 string="{\"msgnum\":\"%msg:F,58:2%\"}")
+
+module(load="../contrib/omhttp/.libs/omhttp")
+
+main_queue(queue.dequeueBatchSize="2048")
+
+if $msg contains "msgnum:" then
+	action(
+		# Payload
+		action.resumeRetryCount="-1"
+		action.resumeInterval="1"
+		name="my_http_action"
+		type="omhttp"
+		errorfile="'$RSYSLOG_DYNNAME/omhttp.error.log'"
+		template="tpl"
+
+		server="localhost"
+		serverport="'$omhttp_server_lstnport'"
+		restpath="my/endpoint"
+		batch="on"
+		batch.format="jsonarray"
+		batch.maxsize="100"
+		pipeline.maxinflight="8"
+
+		# Auth
+		usehttps="off"
+    )
+'
+startup
+injectmsg
+shutdown_when_empty
+wait_shutdown
+omhttp_get_data $omhttp_server_lstnport my/endpoint jsonarray
+omhttp_stop_server
+seq_check
+exit_test
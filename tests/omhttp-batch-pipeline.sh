@@ -0,0 +1,54 @@
+#!/bin/bash
+# Checks that pipeline.maxinflight keeps several batch requests of one
+# transaction in flight at the same time and that all data arrives.
+# This file is part of the rsyslog project, released under ASL 2.0
+
+#  Starting actual testbench
+. ${srcdir:=.}/diag.sh init
+export NUMMESSAGES=20000
+
+omhttp_start_server 0 --threaded --post-delay-ms 20
+
+generate_conf
+add_conf '
+template(name="tpl" type="string"
+	 string="{\"msgnum\":\"%msg:F,58:2%\"}")
+
+module(load="../contrib/omhttp/.libs/omhttp")
+
+main_queue(queue.dequeueBatchSize="2048")
+
+if $msg contains "msgnum:" then
+	action(
+		# Payload
+		name="my_http_action"
+		type="omhttp"
+		errorfile="'$RSYSLOG_DYNNAME/omhttp.error.log'"
+		template="tpl"
+
+		server="localhost"
+		serverport="'$omhttp_server_lstnport'"
+		restpath="my/endpoint"
+		batch="on"
+		batch.format="jsonarray"
+		batch.maxsize="100"
+		pipeline.maxinflight="4"
+
+		# Auth
+		usehttps="off"
+    )
+'
+startup
+injectmsg
+shutdown_when_empty
+wait_shutdown
+max_concurrent=$(curl -s localhost:${omhttp_server_lstnport}/_omhttp/max_concurrent)
+omhttp_get_data $omhttp_server_lstnport my/endpoint jsonarray
+omhttp_stop_server
+seq_check
+echo "max concurrent requests seen by server: $max_concurrent"
+if [ "$max_concurrent" -lt 2 ] || [ "$max_concurrent" -gt 4 ]; then
+	echo "FAIL: expected 2 to 4 concurrent requests, server saw '$max_concurrent'"
+	error_exit 1
+fi
+exit_test
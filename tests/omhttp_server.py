@@ -5,19 +5,30 @@ import os
 import zlib
 import base64
 import random
+import threading
 import time
 
 now = getattr(time, 'monotonic', time.time)
 
 try:
     from BaseHTTPServer import BaseHTTPRequestHandler, HTTPServer  # Python 2
+    from SocketServer import ThreadingMixIn
 except ImportError:
     from http.server import BaseHTTPRequestHandler, HTTPServer  # Python 3
+    from socketserver import ThreadingMixIn
 
 # Keep track of data received at each path
 data = {}
 
-metadata = {'posts': 0, 'fail_after': 0, 'fail_every': -1, 'decompress': False, 'userpwd': ''}
+metadata = {'posts': 0, 'fail_after': 0, 'fail_every': -1, 'decompress': False, 'userpwd': '',
+            'post_delay_ms': 0, 'concurrent': 0, 'max_concurrent': 0}
+
+# serializes updates of the counters above when requests are served in parallel
+lock = threading.Lock()
+
+
+class ThreadingHTTPServer(ThreadingMixIn, HTTPServer):
+    daemon_threads = True
 
 
 class MyHandler(BaseHTTPRequestHandler):
@@ -31,6 +42,9 @@ class MyHandler(BaseHTTPRequestHandler):
     Note that rsyslog usually sends escaped json data, so some parsing may be needed.
     A get request for <host>:<post>/post/endpoint responds with...
         ["{\"msgnum\":\"00001\"}", "{\"msgnum\":\"00001\"}"]
+
+    A get request for /_omhttp/max_concurrent returns the highest number of
+    POST requests that were in progress at the same time.
     """
 
     def validate_auth(self):
@@ -54,8 +68,18 @@ class MyHandler(BaseHTTPRequestHandler):
         return True
 
     def do_POST(self):
-        metadata['posts'] += 1
-
+        with lock:
+            metadata['posts'] += 1
+            self.post_number = metadata['posts']
+            metadata['concurrent'] += 1
+            metadata['max_concurrent'] = max(metadata['max_concurrent'], metadata['concurrent'])
+        try:
+            self.handle_post()
+        finally:
+            with lock:
+                metadata['concurrent'] -= 1
+
+    def handle_post(self):
         if metadata['userpwd']:
             if not self.validate_auth():
                 return
@@ -74,7 +98,7 @@ class MyHandler(BaseHTTPRequestHandler):
                 self.wfile.write(b'INTERVAL FAILURE')
                 return
 
-        if metadata['fail_with_400_after'] != -1 and metadata['posts'] > metadata['fail_with_400_after']:
+        if metadata['fail_with_400_after'] != -1 and self.post_number > metadata['fail_with_400_after']:
             if metadata['fail_with_delay_secs']:
                 print("sleeping for: {0}".format(metadata['fail_with_delay_secs']))
                 time.sleep(metadata['fail_with_delay_secs'])
@@ -83,14 +107,14 @@ class MyHandler(BaseHTTPRequestHandler):
             self.wfile.write(b'BAD REQUEST')
             return
 
-        if metadata['fail_with_401_or_403_after'] != -1 and metadata['posts'] > metadata['fail_with_401_or_403_after']:
+        if metadata['fail_with_401_or_403_after'] != -1 and self.post_number > metadata['fail_with_401_or_403_after']:
             status = random.choice([401, 403])
             self.send_response(status)
             self.end_headers()
             self.wfile.write(b'BAD REQUEST')
             return
 
-        if metadata['posts'] > 1 and metadata['fail_every'] != -1 and metadata['posts'] % metadata['fail_every'] == 0:
+        if self.post_number > 1 and metadata['fail_every'] != -1 and self.post_number % metadata['fail_every'] == 0:
             if metadata['fail_with_delay_secs']:
                 print("sleeping for: {0}".format(metadata['fail_with_delay_secs']))
                 time.sleep(metadata['fail_with_delay_secs'])
@@ -114,9 +138,13 @@ class MyHandler(BaseHTTPRequestHandler):
             self.wfile.write(b'BAD REQUEST')
             return
 
-        if self.path not in data:
-            data[self.path] = []
-        data[self.path].append(post_data.decode('utf-8'))
+        if metadata['post_delay_ms']:
+            time.sleep(metadata['post_delay_ms'] / 1000.0)
+
+        with lock:
+            if self.path not in data:
+                data[self.path] = []
+            data[self.path].append(post_data.decode('utf-8'))
 
         res = json.dumps({'msg': 'ok'}).encode('utf8')
 
@@ -129,7 +157,9 @@ class MyHandler(BaseHTTPRequestHandler):
         return
 
     def do_GET(self):
-        if self.path in data:
+        if self.path == '/_omhttp/max_concurrent':
+            result = metadata['max_concurrent']
+        elif self.path in data:
             result = data[self.path]
         else:
             result = []
@@ -166,6 +196,9 @@ if __name__ == '__main__':
                         default=-1, help='stop failing after n seconds from the first POST')
     parser.add_argument('--decompress', action='store_true', default=False, help='decompress posted data')
     parser.add_argument('--userpwd', action='store', default='', help='only accept this user:password combination')
+    parser.add_argument('--threaded', action='store_true', default=False, help='serve requests in parallel')
+    parser.add_argument('--post-delay-ms', action='store', type=int, default=0,
+                        help='delay each successful POST response by n milliseconds')
     args = parser.parse_args()
     metadata['fail_after'] = args.fail_after
     metadata['fail_every'] = args.fail_every
@@ -179,7 +212,9 @@ if __name__ == '__main__':
     metadata['fail_interval_base_time'] = None
     metadata['decompress'] = args.decompress
     metadata['userpwd'] = args.userpwd
-    server = HTTPServer((args.interface, args.port), MyHandler)
+    metadata['post_delay_ms'] = args.post_delay_ms
+    server_class = ThreadingHTTPServer if args.threaded else HTTPServer
+    server = server_class((args.interface, args.port), MyHandler)
     lstn_port = server.server_address[1]
     pid = os.getpid()
     print('starting omhttp test server at {interface}:{port} with pid {pid}'
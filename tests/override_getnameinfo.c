@@ -0,0 +1,60 @@
+#define _GNU_SOURCE
+#include "config.h"
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Stub reverse resolver for the dnscache tests. Name lookups answer
+ * RSYSLOG_GETNAMEINFO_NAME (default "stub.example.net") after sleeping
+ * RSYSLOG_GETNAMEINFO_DELAY_MS milliseconds; each completed lookup appends
+ * a line to RSYSLOG_GETNAMEINFO_LOG. Numeric lookups go to the real
+ * getnameinfo().
+ */
+typedef int (*getnameinfo_func_t)(
+    const struct sockaddr *sa, socklen_t salen, char *host, socklen_t hostlen, char *serv, socklen_t servlen, int flags);
+
+static getnameinfo_func_t real_getnameinfo = NULL;
+
+static void __attribute__((constructor)) init_real_getnameinfo(void) {
+    real_getnameinfo = (getnameinfo_func_t)dlsym(RTLD_NEXT, "getnameinfo");
+}
+
+int getnameinfo(
+    const struct sockaddr *sa, socklen_t salen, char *host, socklen_t hostlen, char *serv, socklen_t servlen, int flags) {
+    const char *const delay = getenv("RSYSLOG_GETNAMEINFO_DELAY_MS");
+    const char *const log = getenv("RSYSLOG_GETNAMEINFO_LOG");
+    const char *name = getenv("RSYSLOG_GETNAMEINFO_NAME");
+
+    if ((flags & NI_NUMERICHOST) || host == NULL) {
+        if (real_getnameinfo == NULL) return EAI_SYSTEM;
+        return real_getnameinfo(sa, salen, host, hostlen, serv, servlen, flags);
+    }
+
+    if (delay != NULL) {
+        const long ms = atol(delay);
+        struct timespec ts = {ms / 1000, (ms % 1000) * 1000000};
+        while (nanosleep(&ts, &ts) != 0) {
+        }
+    }
+    if (name == NULL) name = "stub.example.net";
+    if ((socklen_t)strlen(name) >= hostlen) return EAI_OVERFLOW;
+    strcpy(host, name);
+    if (serv != NULL && servlen > 0) serv[0] = '\0';
+
+    if (log != NULL && log[0] != '\0') {
+        const int fd = open(log, O_CREAT | O_WRONLY | O_APPEND, 0600);
+        if (fd >= 0) {
+            const ssize_t written = write(fd, "lookup\n", sizeof("lookup\n") - 1);
+            (void)written;
+            (void)close(fd);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,31 @@
+#!/bin/bash
+# Messages parsed by a separate parse stage (parser.workerThreads) must reach
+# the main queue as well as a ruleset with its own queue, completely and
+# with the header fields already parsed.
+# This file is part of the rsyslog project, released under ASL 2.0.
+. ${srcdir:=.}/diag.sh init
+export NUMMESSAGES=20000
+export QUEUE_EMPTY_CHECK_FUNC=wait_file_lines
+generate_conf
+add_conf '
+global(parser.workerThreads="4")
+module(load="../plugins/imtcp/.libs/imtcp")
+input(type="imtcp" address="127.0.0.1" port="0" listenPortFileName="'$RSYSLOG_DYNNAME'.tcpflood_port")
+input(type="imtcp" address="127.0.0.1" port="0" listenPortFileName="'$RSYSLOG_DYNNAME'.tcpflood_port2" ruleset="rs")
+
+template(name="outfmt" type="string" string="%msg:F,58:2%\n")
+ruleset(name="rs" queue.type="LinkedList") {
+	if $hostname == "172.20.245.8" and $programname == "tag" then
+		action(type="omfile" template="outfmt" file="'$RSYSLOG_OUT_LOG'")
+}
+if $msg contains "msgnum:" and $hostname == "172.20.245.8" and $programname == "tag" then
+	action(type="omfile" template="outfmt" file="'$RSYSLOG_OUT_LOG'")
+'
+startup
+assign_tcpflood_port2 "${RSYSLOG_DYNNAME}.tcpflood_port2"
+tcpflood -p$TCPFLOOD_PORT -m$((NUMMESSAGES / 2)) -i0
+tcpflood -p$TCPFLOOD_PORT2 -m$((NUMMESSAGES / 2)) -i$((NUMMESSAGES / 2))
+shutdown_when_empty
+wait_shutdown
+seq_check
+exit_test
@@ -0,0 +1,26 @@
+#!/bin/bash
+# Disk-assisted ringBuffer main queue: a burst far above the high water mark
+# must leave the lock-free enqueue path, spill to disk and drain back
+# completely. imdiag injection is fully delayable so the injector does not
+# overrun the intentionally tiny queue (see da-mainmsg-q.sh).
+# added 2026-10-17 by Rainer Gerhards, released under ASL 2.0
+. ${srcdir:=.}/diag.sh init
+export RSTB_IMDIAG_INJECT_DELAY_MODE=full
+export NUMMESSAGES=5000
+export QUEUE_EMPTY_CHECK_FUNC=wait_seq_check
+generate_conf
+add_conf '
+global(workDirectory="'$RSYSLOG_DYNNAME'.spool")
+main_queue(queue.type="ringBuffer" queue.size="200" queue.highWatermark="80"
+	   queue.lowWatermark="40" queue.filename="mainq" queue.timeoutShutdown="10000")
+
+template(name="outfmt" type="string" string="%msg:F,58:2%\n")
+:msg, contains, "msgnum:" action(type="omfile" template="outfmt"
+			         file="'$RSYSLOG_OUT_LOG'")
+'
+startup
+injectmsg 0 $NUMMESSAGES
+shutdown_when_empty
+wait_shutdown
+seq_check
+exit_test
@@ -0,0 +1,32 @@
+#!/bin/bash
+# A sharded ringBuffer main queue keyed on the sender must deliver all
+# messages and keep the order of each TCP session, even though several
+# workers drain and steal from the shards concurrently.
+# added 2026-10-17 by Rainer Gerhards, released under ASL 2.0
+. ${srcdir:=.}/diag.sh init
+export NUMMESSAGES=80000
+export QUEUE_EMPTY_CHECK_FUNC=wait_file_lines
+generate_conf
+add_conf '
+main_queue(queue.type="ringBuffer" queue.size="20000" queue.workerThreads="4"
+	   queue.workerThreadMinimumMessages="1000" queue.shards="4" queue.shardKey="source")
+module(load="../plugins/imtcp/.libs/imtcp" workerThreads="8")
+input(type="imtcp" address="127.0.0.1" port="0" listenPortFileName="'$RSYSLOG_DYNNAME'.tcpflood_port")
+
+template(name="outfmt" type="string" string="%fromhost-port% %msg:F,58:2%\n")
+:msg, contains, "msgnum:" action(type="omfile" template="outfmt"
+			         file="'$RSYSLOG_OUT_LOG'")
+'
+startup
+tcpflood -c16 -m $NUMMESSAGES
+shutdown_when_empty
+wait_shutdown
+# tcpflood numbers messages in send order, so each session must be ascending
+if ! awk '{ n = $2 + 0; if (($1 in last) && n <= last[$1]) { print "out of order: " $0; exit 1 } last[$1] = n }' \
+	"$RSYSLOG_OUT_LOG"; then
+	error_exit 1
+fi
+cut -d' ' -f2 < "$RSYSLOG_OUT_LOG" > "$RSYSLOG_DYNNAME.seq"
+export SEQ_CHECK_FILE="$RSYSLOG_DYNNAME.seq"
+seq_check
+exit_test
@@ -0,0 +1,25 @@
+#!/bin/bash
+# Many imtcp workers feed a ringBuffer main queue concurrently. Messages
+# must arrive complete while producers use the lock-free enqueue path and
+# several main queue workers dequeue.
+# added 2026-10-17 by Rainer Gerhards, released under ASL 2.0
+. ${srcdir:=.}/diag.sh init
+export NUMMESSAGES=80000
+export QUEUE_EMPTY_CHECK_FUNC=wait_file_lines
+generate_conf
+add_conf '
+main_queue(queue.type="ringBuffer" queue.size="20000" queue.workerThreads="4"
+	   queue.workerThreadMinimumMessages="1000")
+module(load="../plugins/imtcp/.libs/imtcp" workerThreads="8")
+input(type="imtcp" address="127.0.0.1" port="0" listenPortFileName="'$RSYSLOG_DYNNAME'.tcpflood_port")
+
+template(name="outfmt" type="string" string="%msg:F,58:2%\n")
+:msg, contains, "msgnum:" action(type="omfile" template="outfmt"
+			         file="'$RSYSLOG_OUT_LOG'")
+'
+startup
+tcpflood -c16 -m $NUMMESSAGES
+shutdown_when_empty
+wait_shutdown
+seq_check
+exit_test
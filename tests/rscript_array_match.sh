@@ -0,0 +1,29 @@
+#!/bin/bash
+# check contains/startswith/endswith against arrays large enough to be
+# compiled into a multi-pattern matcher, including overlapping members
+. ${srcdir:=.}/diag.sh init
+generate_conf
+add_conf '
+template(name="outfmt" type="string" string="%programname%:%$!res%\n")
+if $programname contains ["she", "hers", "his", "xyz", "abc"] then set $!res!c = "c";
+if $programname contains_i ["SHE", "HERS", "HIS", "XYZ", "ABC"] then set $!res!ci = "ci";
+if $programname startswith ["ush", "hi", "abcd", "q", "zz"] then set $!res!sw = "sw";
+if $programname startswith_i ["USH", "HI", "ABCD", "Q", "ZZ"] then set $!res!swi = "swi";
+if $programname endswith ["ers", "is", "ax", "_foo", "-bar"] then set $!res!ew = "ew";
+action(type="omfile" template="outfmt" file="'${RSYSLOG_OUT_LOG}'")
+'
+startup
+injectmsg_literal '<165>1 2003-03-01T01:00:00.000Z host ushers - - - test1'
+injectmsg_literal '<165>1 2003-03-01T01:00:00.000Z host USHERS - - - test2'
+injectmsg_literal '<165>1 2003-03-01T01:00:00.000Z host this - - - test3'
+injectmsg_literal '<165>1 2003-03-01T01:00:00.000Z host hersh - - - test4'
+injectmsg_literal '<165>1 2003-03-01T01:00:00.000Z host nomatch - - - test5'
+shutdown_when_empty
+wait_shutdown
+export EXPECTED='ushers:{ "c": "c", "ci": "ci", "sw": "sw", "swi": "swi", "ew": "ew" }
+USHERS:{ "ci": "ci", "swi": "swi" }
+this:{ "c": "c", "ci": "ci", "ew": "ew" }
+hersh:{ "c": "c", "ci": "ci" }
+nomatch:'
+cmp_exact
+exit_test
@@ -0,0 +1,24 @@
+#!/bin/bash
+# A global variable written by the ruleset makes the order in which messages
+# pass the statements observable. Such configs must keep message by message
+# execution: every message has to see the counter value it set itself.
+# This file is part of the rsyslog project, released under ASL 2.0
+. ${srcdir:=.}/diag.sh init
+export NUMMESSAGES=10000
+generate_conf
+add_conf '
+global(ruleset.batchExecution="on")
+main_queue(queue.dequeueBatchSize="1024")
+template(name="outfmt" type="string" string="%$.cnt%\n")
+
+set $/cnt = $/cnt + 1;
+set $.cnt = $/cnt;
+action(type="omfile" file="'$RSYSLOG_OUT_LOG'" template="outfmt")
+'
+startup
+injectmsg 0 $NUMMESSAGES
+shutdown_when_empty
+wait_shutdown
+seq 1 $NUMMESSAGES > $RSYSLOG_DYNNAME.expected
+cmp_exact_file $RSYSLOG_DYNNAME.expected $RSYSLOG_OUT_LOG
+exit_test
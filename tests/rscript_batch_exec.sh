@@ -0,0 +1,64 @@
+#!/bin/bash
+# Check that batch-wise ruleset execution keeps the per-message semantics of
+# if/else, priority and property filters, set/unset, synchronous ruleset calls
+# and stop. Messages are injected quickly so that the main queue hands out
+# large batches; one action gets all surviving messages and must see them in
+# their original order.
+# This file is part of the rsyslog project, released under ASL 2.0
+. ${srcdir:=.}/diag.sh init
+export NUMMESSAGES=10000
+generate_conf
+add_conf '
+global(ruleset.batchExecution="on")
+main_queue(queue.dequeueBatchSize="1024")
+template(name="outfmt" type="string" string="%$.n%,%$.kind%,%$.pri%,%$.sub%,%$.tmp%\n")
+template(name="lowfmt" type="string" string="%$.n%\n")
+
+ruleset(name="sub") {
+	if $.n % 2 == 0 then
+		set $.sub = "even";
+	else
+		set $.sub = "odd";
+}
+
+if $msg contains "msgnum:" then {
+	set $.n = cnum(field($msg, 58, 2));
+	set $.tmp = "x";
+	if $.n % 5 == 0 then stop
+	if $.n % 3 == 0 then {
+		set $.kind = "three";
+	} else {
+		set $.kind = "other";
+		unset $.tmp;
+	}
+	local4.debug {
+		set $.pri = "local4";
+	}
+	mail.* {
+		set $.pri = "mail";
+	}
+	call sub
+	:msg, contains, "msgnum:00001" {
+		action(type="omfile" file="'$RSYSLOG_DYNNAME'.low.log" template="lowfmt")
+		if $.n % 7 == 0 then stop
+	}
+	action(type="omfile" file="'$RSYSLOG_OUT_LOG'" template="outfmt")
+}
+'
+startup
+injectmsg 0 $NUMMESSAGES
+shutdown_when_empty
+wait_shutdown
+
+awk -v n=$NUMMESSAGES 'BEGIN {
+	for (i = 0; i < n; ++i) {
+		if (i % 5 == 0) continue;
+		if (i >= 1000 && i < 2000 && i % 7 == 0) continue;
+		printf "%d,%s,local4,%s,%s\n", i, (i % 3 == 0) ? "three" : "other",
+			(i % 2 == 0) ? "even" : "odd", (i % 3 == 0) ? "x" : ""
+	}
+}' > $RSYSLOG_DYNNAME.expected
+cmp_exact_file $RSYSLOG_DYNNAME.expected $RSYSLOG_OUT_LOG
+awk 'BEGIN { for (i = 1000; i < 2000; ++i) if (i % 5 != 0) print i }' > $RSYSLOG_DYNNAME.expected
+cmp_exact_file $RSYSLOG_DYNNAME.expected $RSYSLOG_DYNNAME.low.log
+exit_test
@@ -10,6 +10,7 @@ import struct
 
 SEG_HEADER_LEN = 52
 RECORD_HEADER_LEN = 32
+BLOCK_HEADER_LEN = 40
 FOOTER_LEN = 48
 STATE_SLOT_LEN = 256
 
@@ -41,9 +42,26 @@ def inspect_segment(path):
         if footer_valid:
             end -= FOOTER_LEN
     records = []
+    blocks = []
     offset = SEG_HEADER_LEN
     while offset + RECORD_HEADER_LEN <= end:
         header = data[offset:offset + RECORD_HEADER_LEN]
+        if header[:8] == b"RSBLKZ02" and offset + BLOCK_HEADER_LEN <= end:
+            block_header = data[offset:offset + BLOCK_HEADER_LEN]
+            stored_len = struct.unpack_from(">I", block_header, 12)[0]
+            stored_end = offset + BLOCK_HEADER_LEN + stored_len
+            if valid_crc(block_header, 32) and stored_end <= end:
+                blocks.append({
+                    "offset": offset,
+                    "first_sequence": struct.unpack_from(">Q", block_header, 16)[0],
+                    "record_count": struct.unpack_from(">I", block_header, 24)[0],
+                    "raw_length": struct.unpack_from(">I", block_header, 28)[0],
+                    "stored_length": stored_len,
+                    "stored_crc_valid": struct.unpack_from(">I", block_header, 36)[0]
+                    == crc32c(data[offset + BLOCK_HEADER_LEN:stored_end]),
+                })
+                offset = stored_end
+                continue
         if header[:8] != b"RSRECD02" or not valid_crc(header, 24):
             offset += 1
             continue
@@ -79,6 +97,7 @@ def inspect_segment(path):
         "sealed": sealed,
         "footer_valid": footer_valid,
         "records": records,
+        "blocks": blocks,
     }
 
 
@@ -131,6 +150,8 @@ def inspect_store(directory):
         "segments": segments,
         "segment_errors": segment_errors,
         "record_count": sum(len(segment["records"]) for segment in segments),
+        "block_count": sum(len(segment["blocks"]) for segment in segments),
+        "block_record_count": sum(block["record_count"] for segment in segments for block in segment["blocks"]),
     }
 
 
@@ -175,6 +196,24 @@ def corrupt_record(directory, record_index=None, message_number=None):
     raise IndexError(f"{target} does not exist")
 
 
+def corrupt_block(directory, block_index):
+    current = 0
+    for path in sorted(directory.glob("segment-*.*")):
+        if path.suffix not in (".open", ".recover", ".seg"):
+            continue
+        for block in inspect_segment(path)["blocks"]:
+            if current == block_index:
+                offset = block["offset"] + BLOCK_HEADER_LEN + block["stored_length"] // 2
+                with path.open("r+b") as stream:
+                    stream.seek(offset)
+                    byte = stream.read(1)
+                    stream.seek(offset)
+                    stream.write(bytes([byte[0] ^ 0x01]))
+                return
+            current += 1
+    raise IndexError(f"block index {block_index} does not exist")
+
+
 def find_record(directory, message_number):
     for path in sorted(directory.glob("segment-*.*")):
         if path.suffix not in (".open", ".recover", ".seg"):
@@ -279,6 +318,7 @@ def main():
     selector.add_argument("--corrupt-newest-state-slot", action="store_true")
     selector.add_argument("--corrupt-record-framing", type=int, metavar="MESSAGE_NUMBER")
     selector.add_argument("--corrupt-record-codec", type=int, metavar="MESSAGE_NUMBER")
+    selector.add_argument("--corrupt-block", type=int, metavar="BLOCK_INDEX")
     selector.add_argument("--corrupt-segment-header", type=int, metavar="SEGMENT_ID")
     selector.add_argument("--corrupt-segment-footer", type=int, metavar="SEGMENT_ID")
     selector.add_argument("--corrupt-segment-framing", type=int, metavar="SEGMENT_ID")
@@ -295,6 +335,8 @@ def main():
         corrupt_record_framing(args.directory, args.corrupt_record_framing)
     if args.corrupt_record_codec is not None:
         corrupt_record_codec(args.directory, args.corrupt_record_codec)
+    if args.corrupt_block is not None:
+        corrupt_block(args.directory, args.corrupt_block)
     if args.corrupt_segment_header is not None:
         corrupt_segment_header(args.directory, args.corrupt_segment_header)
     if args.corrupt_segment_footer is not None:
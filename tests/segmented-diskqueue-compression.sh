@@ -0,0 +1,80 @@
+#!/bin/bash
+# Verify zstd-compressed record blocks in a segmentedDisk queue: the backlog
+# must be stored as blocks only, survive a restart, and a block with a damaged
+# payload must cost exactly the records of that block while every other record
+# is still delivered.
+# added 2026-10-17 by Rainer Gerhards, released under ASL 2.0
+. ${srcdir:=.}/diag.sh init
+check_command_available python3
+export NUMMESSAGES=2000
+SPOOL_DIR="$PWD/${RSYSLOG_DYNNAME}.spool"
+INSPECT_JSON="${RSYSLOG_DYNNAME}.segdisk-inspect.json"
+
+write_conf() {
+	generate_conf
+	add_conf '
+module(load="../plugins/omtesting/.libs/omtesting")
+global(workDirectory="'"$SPOOL_DIR"'")
+main_queue(
+	queue.type="segmentedDisk"
+	queue.filename="mainq"
+	queue.maxFileSize="16k"
+	queue.dequeueBatchSize="32"
+	queue.saveOnShutdown="on"
+	queue.timeoutShutdown="1"
+	queue.timeoutActionCompletion="100"
+	queue.compression="zstd"
+	queue.compressionBlockSize="4k"
+)
+
+template(name="outfmt" type="string" string="%msg:F,58:2%\n")
+'"$1"'
+if ($msg contains "msgnum:") then
+	action(type="omfile" file="'$RSYSLOG_OUT_LOG'" template="outfmt")
+'
+}
+
+write_conf ':omtesting:sleep 10 0'
+startup
+injectmsg 0 "$NUMMESSAGES"
+shutdown_immediate
+wait_shutdown
+
+python3 "$srcdir/segdisk-inspect.py" "$SPOOL_DIR/mainq.segq" > "$INSPECT_JSON"
+python3 - "$INSPECT_JSON" <<'PY' || error_exit 1
+import json
+import sys
+
+store = json.load(open(sys.argv[1]))
+blocks = [block for segment in store["segments"] for block in segment["blocks"]]
+if store["record_count"] != 0 or len(blocks) < 4:
+    sys.exit(f"FAIL: expected only compressed blocks, got {store['record_count']} records, {len(blocks)} blocks")
+if not all(block["stored_crc_valid"] for block in blocks):
+    sys.exit("FAIL: a freshly written block has an invalid CRC")
+if sum(block["stored_length"] for block in blocks) * 2 > sum(block["raw_length"] for block in blocks):
+    sys.exit("FAIL: compressed blocks are not smaller than half of the serialized records")
+if len(store["segments"]) < 2:
+    sys.exit("FAIL: the backlog did not rotate into several segments")
+PY
+
+# Damage a block from the middle of the backlog. Records of the batch that was
+# interrupted by shutdown are appended again at the tail, so a middle block
+# holds only records that exist nowhere else.
+read -r victim lost < <(python3 -c '
+import json, sys
+blocks = [b for s in json.load(open(sys.argv[1]))["segments"] for b in s["blocks"]]
+print(len(blocks) // 2, blocks[len(blocks) // 2]["record_count"])' "$INSPECT_JSON")
+python3 "$srcdir/segdisk-inspect.py" "$SPOOL_DIR/mainq.segq" --corrupt-block "$victim" > /dev/null
+
+write_conf '# no delay after restart'
+startup
+shutdown_when_empty
+wait_shutdown
+
+delivered=$(sort -u "$RSYSLOG_OUT_LOG" | wc -l)
+if [ "$delivered" -ne $((NUMMESSAGES - lost)) ]; then
+	echo "FAIL: expected $((NUMMESSAGES - lost)) distinct records with one damaged block of $lost, got $delivered"
+	error_exit 1
+fi
+rm -rf "${RSYSLOG_DYNNAME}.spool"
+exit_test
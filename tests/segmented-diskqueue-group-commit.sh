@@ -0,0 +1,55 @@
+#!/bin/bash
+# SPDX-License-Identifier: Apache-2.0
+#
+# Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+#
+# Feed a segmentedDisk queue with syncQueueFiles enabled through imtcp, whose
+# multi-message submissions are written as append groups. Exact delivery
+# proves that staged records are neither lost nor duplicated; the impstats
+# group counters prove that at least one write carried several records.
+. ${srcdir:=.}/diag.sh init
+require_plugin impstats
+export NUMMESSAGES=20000
+STATS_FILE="$PWD/${RSYSLOG_DYNNAME}.stats.log"
+
+generate_conf
+add_conf '
+module(load="../plugins/impstats/.libs/impstats" log.file="'"$STATS_FILE"'" interval="1")
+module(load="../plugins/imtcp/.libs/imtcp")
+input(type="imtcp" address="127.0.0.1" port="0"
+	listenPortFileName="'"$RSYSLOG_DYNNAME"'.tcpflood_port")
+global(workDirectory="'${RSYSLOG_DYNNAME}'.spool")
+main_queue(queue.type="segmentedDisk" queue.filename="mainq"
+	queue.syncQueueFiles="on" queue.timeoutShutdown="10000"
+	queue.maxFileSize="256k" queue.dequeueBatchSize="256")
+template(name="outfmt" type="string" string="%msg:F,58:2%\n")
+if ($msg contains "msgnum:") then
+	action(type="omfile" file="'"$RSYSLOG_OUT_LOG"'" template="outfmt")
+'
+
+startup
+tcpflood -p"$TCPFLOOD_PORT" -c4 -m"$NUMMESSAGES"
+wait_file_lines "$RSYSLOG_OUT_LOG" "$NUMMESSAGES"
+# impstats samples once per second; wait for a sample covering every record
+deadline=$((SECONDS + 30))
+while :; do
+	line=$(grep 'group.records=' "$STATS_FILE" | tail -n 1)
+	records=$(printf '%s\n' "$line" | sed -E 's/.*group\.records=([0-9]+).*/\1/')
+	[ "${records:-0}" -ge "$NUMMESSAGES" ] && break
+	if [ "$SECONDS" -ge "$deadline" ]; then
+		cat "$STATS_FILE"
+		error_exit 1 "group.records did not reach $NUMMESSAGES"
+	fi
+	./msleep 100
+done
+writes=$(printf '%s\n' "$line" | sed -E 's/.*group\.writes=([0-9]+).*/\1/')
+shutdown_when_empty
+wait_shutdown
+seq_check
+if [ "$writes" -ge "$records" ]; then
+	printf 'FAIL: %s group writes for %s records, no write was shared\n' "$writes" "$records"
+	cat "$STATS_FILE"
+	error_exit 1
+fi
+rm -rf "${RSYSLOG_DYNNAME}.spool"
+exit_test
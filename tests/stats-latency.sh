@@ -0,0 +1,35 @@
+#!/bin/bash
+# global(stats.latency="on") adds latency histograms to the queue and action
+# stats; every message processed by an action is counted exactly once.
+# This file is part of the rsyslog project, released under ASL 2.0
+. ${srcdir:=.}/diag.sh init
+export NUMMESSAGES=1000
+export STATSFILE="$RSYSLOG_DYNNAME.out.stats.log"
+generate_conf
+add_conf '
+global(stats.latency="on")
+
+ruleset(name="stats") {
+  action(type="omfile" file="'${STATSFILE}'")
+}
+
+module(load="../plugins/impstats/.libs/impstats" interval="1" severity="7" Ruleset="stats")
+
+template(name="outfmt" type="string" string="%msg:F,58:2%\n")
+if $msg contains "msgnum:" then {
+  action(name="direct_action" type="omfile" file="'${RSYSLOG_OUT_LOG}'" template="outfmt")
+  action(name="queued_action" type="omfile" file="'${RSYSLOG2_OUT_LOG}'" template="outfmt"
+         queue.type="LinkedList")
+}
+'
+startup
+injectmsg 0 $NUMMESSAGES
+wait_file_lines "$RSYSLOG_OUT_LOG" $NUMMESSAGES
+wait_file_lines "$RSYSLOG2_OUT_LOG" $NUMMESSAGES
+wait_content "direct_action: origin=core.action .*latency.count=$NUMMESSAGES " "$STATSFILE"
+wait_content "queued_action: origin=core.action .*latency.count=$NUMMESSAGES " "$STATSFILE"
+wait_content "queued_action queue: origin=core.queue .*latency.count=$NUMMESSAGES " "$STATSFILE"
+shutdown_when_empty
+wait_shutdown
+content_check --regex "main Q: origin=core.queue .*latency.le_100us=[0-9]* .*latency.le_inf=[0-9]* latency.count=[0-9]* latency.sum_us=[0-9]*" "$STATSFILE"
+exit_test
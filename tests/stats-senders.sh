@@ -0,0 +1,40 @@
+#!/bin/bash
+# senders.keepTrack="on": messages received over several connections from
+# the same sender add up in a single _sender_stat record. With
+# senders.timeoutAfter and senders.reportGoneAway="on", the first janitor
+# run (after one minute) must then remove the idle sender and say so.
+# This file is part of the rsyslog project, released under ASL 2.0
+. ${srcdir:=.}/diag.sh init
+export NUMMESSAGES=10000
+export QUEUE_EMPTY_CHECK_FUNC=wait_file_lines
+export STATSFILE="$RSYSLOG_DYNNAME.out.stats.log"
+export TB_TEST_TIMEOUT=120 # the janitor runs only once a minute
+generate_conf
+add_conf '
+global(senders.keepTrack="on" senders.timeoutAfter="1" senders.reportGoneAway="on"
+       janitor.interval="1")
+
+module(load="../plugins/impstats/.libs/impstats" log.file="'$STATSFILE'"
+	interval="1" ruleset="stats")
+
+ruleset(name="stats") {
+	stop # nothing to do here
+}
+
+module(load="../plugins/imtcp/.libs/imtcp")
+input(type="imtcp" address="127.0.0.1" port="0" listenPortFileName="'$RSYSLOG_DYNNAME'.tcpflood_port")
+
+template(name="outfmt" type="string" string="%msg:F,58:2%\n")
+:msg, contains, "msgnum:" action(type="omfile" template="outfmt"
+			         file="'$RSYSLOG_OUT_LOG'")
+:msg, contains, "removing sender" action(type="omfile" file="'$RSYSLOG2_OUT_LOG'")
+'
+startup
+tcpflood -m $NUMMESSAGES -c 4
+wait_file_lines "$RSYSLOG_OUT_LOG" $NUMMESSAGES
+wait_content "_sender_stat: sender=.* messages=$NUMMESSAGES\$" "$STATSFILE"
+wait_content "removing sender '.*' from connection table, last seen at" "$RSYSLOG2_OUT_LOG"
+shutdown_when_empty
+wait_shutdown
+seq_check
+exit_test
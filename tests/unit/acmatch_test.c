@@ -0,0 +1,164 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file acmatch_test.c
+ * @brief Differential coverage for the multi-pattern matcher.
+ *
+ * Compiles random pattern sets over a small alphabet (so that patterns
+ * overlap, nest and share failure links) and checks every mode against a
+ * straightforward per-pattern loop, case-sensitive and case-insensitive.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "acmatch.h"
+
+#include "../../runtime/acmatch.c"
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            fprintf(stderr, "CHECK failed at %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            exit(1);                                                                        \
+        }                                                                                   \
+    } while (0)
+
+#define MAX_PATTERNS 64
+#define MAX_LEN 12
+#define SUBJECT_LEN 48
+
+static int eqByte(const unsigned char a, const unsigned char b, const int bNoCase) {
+    return foldByte(a, bNoCase) == foldByte(b, bNoCase);
+}
+
+static int eqBuf(const unsigned char *a, const unsigned char *b, const size_t len, const int bNoCase) {
+    for (size_t i = 0; i < len; ++i) {
+        if (!eqByte(a[i], b[i], bNoCase)) return 0;
+    }
+    return 1;
+}
+
+/* the per-pattern loop the matcher replaces */
+static int naiveMatch(const unsigned char *const *patterns,
+                      const size_t *lens,
+                      const int n,
+                      const acmatchMode_t mode,
+                      const int bNoCase,
+                      const unsigned char *subject,
+                      const size_t len) {
+    for (int i = 0; i < n; ++i) {
+        if (lens[i] > len) continue;
+        switch (mode) {
+            case ACMATCH_CONTAINS:
+                for (size_t off = 0; off + lens[i] <= len; ++off) {
+                    if (eqBuf(subject + off, patterns[i], lens[i], bNoCase)) return 1;
+                }
+                break;
+            case ACMATCH_PREFIX:
+                if (eqBuf(subject, patterns[i], lens[i], bNoCase)) return 1;
+                break;
+            case ACMATCH_SUFFIX:
+                if (eqBuf(subject + len - lens[i], patterns[i], lens[i], bNoCase)) return 1;
+                break;
+            default:
+                break;
+        }
+    }
+    return 0;
+}
+
+static void randomBuf(unsigned char *buf, const size_t len) {
+    /* mostly a tiny alphabet, both cases, plus the odd byte from elsewhere */
+    static const char alphabet[] = "abcAB";
+    for (size_t i = 0; i < len; ++i) {
+        buf[i] = (rand() % 16 == 0) ? (unsigned char)(rand() % 256) : (unsigned char)alphabet[rand() % 5];
+    }
+}
+
+static void checkRandom(const acmatchMode_t mode, const int bNoCase) {
+    unsigned char store[MAX_PATTERNS][MAX_LEN];
+    const unsigned char *patterns[MAX_PATTERNS];
+    size_t lens[MAX_PATTERNS];
+    unsigned char subject[SUBJECT_LEN];
+    acmatch_t *m;
+
+    for (int round = 0; round < 300; ++round) {
+        const int n = 1 + rand() % MAX_PATTERNS;
+        for (int i = 0; i < n; ++i) {
+            /* empty patterns are rare but legal and match everything */
+            lens[i] = (rand() % 50 == 0) ? 0 : 1 + (size_t)(rand() % MAX_LEN);
+            randomBuf(store[i], lens[i]);
+            patterns[i] = store[i];
+        }
+        CHECK(acmatchConstruct(&m, patterns, lens, n, mode, bNoCase) == RS_RET_OK);
+        for (int t = 0; t < 200; ++t) {
+            const size_t len = (size_t)(rand() % SUBJECT_LEN);
+            randomBuf(subject, len);
+            /* plant a pattern now and then so that matches are frequent */
+            if (t % 3 == 0 && lens[t % n] <= len) {
+                const size_t off = (mode == ACMATCH_PREFIX)   ? 0
+                                   : (mode == ACMATCH_SUFFIX) ? len - lens[t % n]
+                                                              : (size_t)rand() % (len - lens[t % n] + 1);
+                memcpy(subject + off, patterns[t % n], lens[t % n]);
+            }
+            CHECK(acmatchMatch(m, subject, len) == naiveMatch(patterns, lens, n, mode, bNoCase, subject, len));
+        }
+        acmatchDestruct(&m);
+        CHECK(m == NULL);
+    }
+}
+
+static void checkBasics(void) {
+    const unsigned char *patterns[] = {(const unsigned char *)"he", (const unsigned char *)"she",
+                                       (const unsigned char *)"his", (const unsigned char *)"hers"};
+    const size_t lens[] = {2, 3, 3, 4};
+    acmatch_t *m;
+
+    CHECK(acmatchConstruct(&m, patterns, lens, 4, ACMATCH_CONTAINS, 0) == RS_RET_OK);
+    CHECK(acmatchMatch(m, (const unsigned char *)"ushers", 6));
+    CHECK(acmatchMatch(m, (const unsigned char *)"xhisx", 5));
+    CHECK(!acmatchMatch(m, (const unsigned char *)"hxsxr", 5));
+    CHECK(!acmatchMatch(m, (const unsigned char *)"", 0));
+    CHECK(!acmatchMatch(m, (const unsigned char *)"SHE", 3));
+    acmatchDestruct(&m);
+
+    CHECK(acmatchConstruct(&m, patterns, lens, 4, ACMATCH_CONTAINS, 1) == RS_RET_OK);
+    CHECK(acmatchMatch(m, (const unsigned char *)"SHE", 3));
+    acmatchDestruct(&m);
+
+    CHECK(acmatchConstruct(&m, patterns, lens, 4, ACMATCH_PREFIX, 0) == RS_RET_OK);
+    CHECK(acmatchMatch(m, (const unsigned char *)"hersheys", 8));
+    CHECK(!acmatchMatch(m, (const unsigned char *)"ushers", 6));
+    CHECK(!acmatchMatch(m, (const unsigned char *)"h", 1));
+    acmatchDestruct(&m);
+
+    CHECK(acmatchConstruct(&m, patterns, lens, 4, ACMATCH_SUFFIX, 0) == RS_RET_OK);
+    CHECK(acmatchMatch(m, (const unsigned char *)"ushers", 6));
+    CHECK(!acmatchMatch(m, (const unsigned char *)"usher", 5));
+    CHECK(!acmatchMatch(m, (const unsigned char *)"she!", 4));
+    CHECK(acmatchMatch(m, (const unsigned char *)"ashe", 4));
+    CHECK(acmatchMatch(m, (const unsigned char *)"this", 4));
+    acmatchDestruct(&m);
+}
+
+int main(void) {
+    srand(4711);
+    checkBasics();
+    for (int bNoCase = 0; bNoCase < 2; ++bNoCase) {
+        checkRandom(ACMATCH_CONTAINS, bNoCase);
+        checkRandom(ACMATCH_PREFIX, bNoCase);
+        checkRandom(ACMATCH_SUFFIX, bNoCase);
+    }
+    return 0;
+}
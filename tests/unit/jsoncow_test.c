@@ -0,0 +1,257 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file jsoncow_test.c
+ * @brief Coverage for copy-on-write sharing of JSON trees.
+ *
+ * Shares a tree between two holders the way MsgDup() does and modifies it
+ * through one of them: the other one must still see the original values,
+ * only the nodes on the modified path may be copied, and a second write to
+ * the same path must not copy again. Also checks the set of private nodes
+ * across growth and reset, and that renderable copies render the same text.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <json.h>
+#include "jsoncow.h"
+
+#include "../../runtime/jsoncow.c"
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            fprintf(stderr, "CHECK failed at %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            exit(1);                                                                        \
+        }                                                                                   \
+    } while (0)
+
+typedef struct holder_s {
+    struct json_object *root;
+    jsoncow_t *cow;
+} holder_t;
+
+static struct json_object *member(struct json_object *const parent, const char *const key) {
+    struct json_object *json;
+    CHECK(json_object_object_get_ex(parent, key, &json));
+    return json;
+}
+
+static char *render(struct json_object *const json) {
+    char *const str = strdup(json_object_to_json_string_ext(json, JSON_C_TO_STRING_PLAIN));
+    CHECK(str != NULL);
+    return str;
+}
+
+static int rendersAs(struct json_object *const json, const char *const expected) {
+    char *const str = render(json);
+    const int r = !strcmp(str, expected);
+    free(str);
+    return r;
+}
+
+/* {"a": {"b": {"c": 1}, "x": {"y": "keep"}}, "arr": [{"k": "v"}, 2], "s": "str"} */
+static struct json_object *buildTree(void) {
+    struct json_object *const root = json_object_new_object();
+    struct json_object *const a = json_object_new_object();
+    struct json_object *const b = json_object_new_object();
+    struct json_object *const x = json_object_new_object();
+    struct json_object *const arr = json_object_new_array();
+    struct json_object *const elem = json_object_new_object();
+
+    json_object_object_add(b, "c", json_object_new_int64(1));
+    json_object_object_add(x, "y", json_object_new_string("keep"));
+    json_object_object_add(a, "b", b);
+    json_object_object_add(a, "x", x);
+    json_object_object_add(elem, "k", json_object_new_string("v"));
+    json_object_array_add(arr, elem);
+    json_object_array_add(arr, json_object_new_int64(2));
+    json_object_object_add(root, "a", a);
+    json_object_object_add(root, "arr", arr);
+    json_object_object_add(root, "s", json_object_new_string("str"));
+    return root;
+}
+
+/* what MsgDup() does */
+static void share(holder_t *const orig, holder_t *const copy) {
+    if (orig->cow == NULL) {
+        CHECK(jsoncowConstruct(&orig->cow) == RS_RET_OK);
+    } else {
+        jsoncowReset(orig->cow);
+    }
+    CHECK(jsoncowConstruct(&copy->cow) == RS_RET_OK);
+    copy->root = json_object_get(orig->root);
+}
+
+/* set root!a!b!<key> = val, the way msgAddJSON() walks the path */
+static void setABKey(holder_t *const h, const char *const key, struct json_object *const val) {
+    struct json_object *a, *b;
+    CHECK(jsoncowOwnRoot(h->cow, &h->root) == RS_RET_OK);
+    a = member(h->root, "a");
+    CHECK(jsoncowOwnMember(h->cow, h->root, "a", &a) == RS_RET_OK);
+    b = member(a, "b");
+    CHECK(jsoncowOwnMember(h->cow, a, "b", &b) == RS_RET_OK);
+    json_object_object_add(b, key, val);
+}
+
+static void checkPathCopy(void) {
+    holder_t orig = {buildTree(), NULL};
+    holder_t copy = {NULL, NULL};
+    struct json_object *rootBefore, *aBefore, *bBefore;
+    char *const before = render(orig.root);
+
+    share(&orig, &copy);
+    CHECK(copy.root == orig.root);
+
+    setABKey(&copy, "c", json_object_new_int64(2));
+    CHECK(rendersAs(orig.root, before));
+    CHECK(json_object_get_int64(member(member(member(copy.root, "a"), "b"), "c")) == 2);
+    /* only the path was copied, everything else is still shared */
+    CHECK(copy.root != orig.root);
+    CHECK(member(copy.root, "a") != member(orig.root, "a"));
+    CHECK(member(member(copy.root, "a"), "x") == member(member(orig.root, "a"), "x"));
+    CHECK(member(copy.root, "arr") == member(orig.root, "arr"));
+    CHECK(member(copy.root, "s") == member(orig.root, "s"));
+
+    /* the path is private now, writing it again copies nothing */
+    rootBefore = copy.root;
+    aBefore = member(copy.root, "a");
+    bBefore = member(aBefore, "b");
+    setABKey(&copy, "d", json_object_new_int64(3));
+    CHECK(copy.root == rootBefore);
+    CHECK(member(copy.root, "a") == aBefore);
+    CHECK(member(aBefore, "b") == bBefore);
+
+    /* the original copies as well when it writes after sharing */
+    setABKey(&orig, "e", json_object_new_int64(4));
+    CHECK(!json_object_object_get_ex(member(member(copy.root, "a"), "b"), "e", NULL));
+    CHECK(!json_object_object_get_ex(member(member(orig.root, "a"), "b"), "d", NULL));
+
+    /* sharing again makes the original's private nodes shared once more */
+    {
+        holder_t copy2 = {NULL, NULL};
+        share(&orig, &copy2);
+        CHECK(!jsoncowIsOwned(orig.cow, orig.root));
+        char *const shared = render(copy2.root);
+        setABKey(&orig, "f", json_object_new_int64(5));
+        CHECK(rendersAs(copy2.root, shared));
+        json_object_put(copy2.root);
+        jsoncowDestruct(&copy2.cow);
+        free(shared);
+    }
+
+    json_object_put(orig.root);
+    json_object_put(copy.root);
+    jsoncowDestruct(&orig.cow);
+    jsoncowDestruct(&copy.cow);
+    CHECK(orig.cow == NULL);
+    free(before);
+}
+
+static void checkArrayElement(void) {
+    holder_t orig = {buildTree(), NULL};
+    holder_t copy = {NULL, NULL};
+    struct json_object *arr, *elem;
+
+    share(&orig, &copy);
+    CHECK(jsoncowOwnRoot(copy.cow, &copy.root) == RS_RET_OK);
+    arr = member(copy.root, "arr");
+    CHECK(jsoncowOwnMember(copy.cow, copy.root, "arr", &arr) == RS_RET_OK);
+    elem = json_object_array_get_idx(arr, 0);
+    CHECK(jsoncowOwnElement(copy.cow, arr, 0, &elem) == RS_RET_OK);
+    CHECK(elem == json_object_array_get_idx(arr, 0));
+    json_object_object_add(elem, "k", json_object_new_string("changed"));
+
+    CHECK(!strcmp(json_object_get_string(member(json_object_array_get_idx(member(orig.root, "arr"), 0), "k")), "v"));
+    CHECK(!strcmp(json_object_get_string(member(elem, "k")), "changed"));
+    /* scalars are never copied */
+    elem = json_object_array_get_idx(arr, 1);
+    CHECK(jsoncowOwnElement(copy.cow, arr, 1, &elem) == RS_RET_OK);
+    CHECK(elem == json_object_array_get_idx(member(orig.root, "arr"), 1));
+
+    json_object_put(orig.root);
+    json_object_put(copy.root);
+    jsoncowDestruct(&orig.cow);
+    jsoncowDestruct(&copy.cow);
+}
+
+static void checkOwnedSet(void) {
+    enum { N = 1000 };
+    static struct json_object *objs[N];
+    jsoncow_t *cow;
+    struct json_object *const scalar = json_object_new_int64(1);
+
+    CHECK(jsoncowConstruct(&cow) == RS_RET_OK);
+    CHECK(jsoncowAddOwned(cow, scalar) == RS_RET_OK);
+    CHECK(!jsoncowIsOwned(cow, scalar));
+    for (int i = 0; i < N; ++i) {
+        objs[i] = (i % 2) ? json_object_new_object() : json_object_new_array();
+        CHECK(jsoncowAddOwned(cow, objs[i]) == RS_RET_OK);
+        CHECK(jsoncowAddOwned(cow, objs[i]) == RS_RET_OK);
+    }
+    CHECK(cow->n == N);
+    for (int i = 0; i < N; ++i) CHECK(jsoncowIsOwned(cow, objs[i]));
+    jsoncowReset(cow);
+    for (int i = 0; i < N; ++i) CHECK(!jsoncowIsOwned(cow, objs[i]));
+    CHECK(jsoncowAddOwned(cow, objs[0]) == RS_RET_OK);
+    CHECK(jsoncowIsOwned(cow, objs[0]));
+    for (int i = 0; i < N; ++i) json_object_put(objs[i]);
+    json_object_put(scalar);
+    jsoncowDestruct(&cow);
+}
+
+static void checkRenderDup(void) {
+    struct json_object *const root = buildTree();
+    struct json_object *const parsed = json_tokener_parse("{\"d\": 1.50, \"e\": 1e3}");
+    char *const expected = render(root);
+    char *str;
+
+    CHECK((str = jsoncowRenderDup(root, JSON_C_TO_STRING_PLAIN)) != NULL);
+    CHECK(!strcmp(str, expected));
+    free(str);
+
+    CHECK((str = jsoncowRenderDup(member(root, "s"), JSON_C_TO_STRING_PLAIN)) != NULL);
+    CHECK(!strcmp(str, "\"str\""));
+    free(str);
+    CHECK((str = jsoncowRenderDup(member(root, "s"), JSON_C_TO_STRING_PRETTY)) != NULL);
+    CHECK(!strcmp(str, "\"str\""));
+    free(str);
+
+    /* parsed numbers keep their original text */
+    CHECK(parsed != NULL);
+    for (int i = 0; i < 2; ++i) {
+        struct json_object *const num = member(parsed, i ? "e" : "d");
+        char *const direct = render(num);
+        CHECK((str = jsoncowRenderDup(num, JSON_C_TO_STRING_PLAIN)) != NULL);
+        CHECK(!strcmp(str, direct));
+        free(str);
+        CHECK((str = jsoncowRenderDup(num, JSON_C_TO_STRING_SPACED)) != NULL);
+        CHECK(!strcmp(str, direct));
+        free(str);
+        free(direct);
+    }
+
+    CHECK(jsoncowRenderDup(NULL, JSON_C_TO_STRING_PLAIN) == NULL);
+    json_object_put(parsed);
+    json_object_put(root);
+    free(expected);
+}
+
+int main(void) {
+    checkPathCopy();
+    checkArrayElement();
+    checkOwnedSet();
+    checkRenderDup();
+    return 0;
+}
@@ -0,0 +1,212 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file jsonesc_test.c
+ * @brief Differential fuzzing of the vectorized JSON escaper.
+ *
+ * The oracle is the character-at-a-time escaper msg.c used before, kept
+ * here verbatim in its logic. Random inputs, biased towards the bytes that
+ * need escaping and towards backslash sequences, must escape to the same
+ * bytes with either escapeAll setting, at every alignment and through
+ * output buffers so small that nearly every call stops early.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "jsonesc.h"
+
+#include "../../runtime/jsonesc.c"
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            fprintf(stderr, "CHECK failed at %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            exit(1);                                                                        \
+        }                                                                                   \
+    } while (0)
+
+#define MAX_LEN 4096
+
+/* the former jsonAddVal_escaped() loop; dst must hold 6 * len bytes */
+static size_t oracleEscape(const unsigned char *const pSrc, const size_t buflen, unsigned char *dst, const int escapeAll) {
+    static const char hexdig[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
+    unsigned char *const dst_base = dst;
+    unsigned char c, nc;
+    char numbuf[4];
+    size_t ni;
+    int j;
+
+    for (size_t i = 0; i < buflen; ++i) {
+        c = pSrc[i];
+        if ((c >= 0x30 && c <= 0x5b) || (c >= 0x23 && c <= 0x2e) || (c >= 0x5d) || c == 0x20 || c == 0x21) {
+            *dst++ = c;
+        } else {
+            switch (c) {
+                case '\0':
+                    memcpy(dst, "\\u0000", 6);
+                    dst += 6;
+                    break;
+                case '\"':
+                    *dst++ = '\\';
+                    *dst++ = '"';
+                    break;
+                case '/':
+                    *dst++ = '\\';
+                    *dst++ = '/';
+                    break;
+                case '\\':
+                    if (escapeAll == 0) {
+                        ni = i + 1;
+                        if (ni < buflen) {
+                            nc = pSrc[ni];
+                            if (nc == '"' || nc == '/' || nc == '\\' || nc == 'b' || nc == 'f' || nc == 'n' ||
+                                nc == 'r' || nc == 't' || nc == 'u') {
+                                *dst++ = c;
+                                *dst++ = nc;
+                                i = ni;
+                                break;
+                            }
+                        }
+                    }
+                    *dst++ = '\\';
+                    *dst++ = '\\';
+                    break;
+                case '\010':
+                    *dst++ = '\\';
+                    *dst++ = 'b';
+                    break;
+                case '\014':
+                    *dst++ = '\\';
+                    *dst++ = 'f';
+                    break;
+                case '\n':
+                    *dst++ = '\\';
+                    *dst++ = 'n';
+                    break;
+                case '\r':
+                    *dst++ = '\\';
+                    *dst++ = 'r';
+                    break;
+                case '\t':
+                    *dst++ = '\\';
+                    *dst++ = 't';
+                    break;
+                default:
+                    for (j = 0; j < 4; ++j) {
+                        numbuf[3 - j] = hexdig[c % 16];
+                        c = c / 16;
+                    }
+                    *dst++ = '\\';
+                    *dst++ = 'u';
+                    memcpy(dst, numbuf, 4);
+                    dst += 4;
+                    break;
+            }
+        }
+    }
+    return (size_t)(dst - dst_base);
+}
+
+/* escape through chunks of at most chunkSize bytes, like jsonAddVal_escaped() */
+static size_t chunkedEscape(const unsigned char *src,
+                            const size_t len,
+                            unsigned char *const out,
+                            const size_t chunkSize,
+                            const int escapeAll) {
+    static unsigned char chunk[MAX_LEN * 6];
+    const unsigned char *const end = src + len;
+    size_t outLen = 0;
+
+    while (src < end) {
+        const unsigned char *const before = src;
+        const size_t n = jsonescEncode(&src, end, chunk, chunkSize, escapeAll);
+        CHECK(n <= chunkSize);
+        CHECK(src > before || n > 0);
+        memcpy(out + outLen, chunk, n);
+        outLen += n;
+    }
+    return outLen;
+}
+
+static unsigned char randomByte(void) {
+    static const unsigned char special[] = {'"', '\\', '/', '\0', '\n', '\r', '\t', '\b', '\f', 0x1f, 0x7f, 0x80,
+                                            0xff, 'u', 'n', ' ', '!', '#', '.', '0', '[', ']'};
+    const int r = rand();
+    if (r % 4 == 0) return special[(r / 4) % sizeof(special)];
+    return (unsigned char)(r >> 8);
+}
+
+static void checkOne(const unsigned char *const buf, const size_t len) {
+    static unsigned char expected[MAX_LEN * 6];
+    static unsigned char actual[MAX_LEN * 6];
+    static const size_t chunkSizes[] = {JSONESC_MAX_SEQ, 7, 33, MAX_LEN * 6};
+
+    const unsigned char *const scan = jsonescScan(buf, buf + len);
+    CHECK(scan == jsonescScanScalar(buf, buf + len));
+    for (int escapeAll = 0; escapeAll < 2; ++escapeAll) {
+        const size_t expLen = oracleEscape(buf, len, expected, escapeAll);
+        for (size_t k = 0; k < sizeof(chunkSizes) / sizeof(chunkSizes[0]); ++k) {
+            const size_t actLen = chunkedEscape(buf, len, actual, chunkSizes[k], escapeAll);
+            CHECK(actLen == expLen);
+            CHECK(memcmp(actual, expected, expLen) == 0);
+        }
+    }
+}
+
+/* a single special byte at every position and alignment, including the vector tails */
+static void checkAllPositions(void) {
+    static const unsigned char special[] = {'"', '\\', '/', '\0', 0x1f, '\n'};
+    unsigned char buf[MAX_LEN + 64];
+
+    for (size_t s = 0; s < sizeof(special); ++s) {
+        for (int start = 0; start < 33; ++start) {
+            for (int len = 0; len <= 100; ++len) {
+                memset(buf, 'a', sizeof(buf));
+                /* a special byte just past the end must never be reported */
+                buf[start + len] = special[s];
+                CHECK(jsonescScan(buf + start, buf + start + len) == buf + start + len);
+                for (int pos = start; pos < start + len; ++pos) {
+                    memset(buf, (pos & 1) ? 0x80 : 0x20, sizeof(buf));
+                    buf[pos] = special[s];
+                    CHECK(jsonescScan(buf + start, buf + start + len) == buf + pos);
+                    checkOne(buf + start, (size_t)len);
+                }
+            }
+        }
+    }
+}
+
+int main(void) {
+    static unsigned char buf[MAX_LEN + 64];
+
+    checkAllPositions();
+    for (int c = 0; c < 256; ++c) {
+        buf[0] = (unsigned char)c;
+        CHECK(jsonescNeedsEscape((unsigned char)c) == (jsonescScan(buf, buf + 1) == buf));
+        checkOne(buf, 1);
+    }
+
+    srand(4711);
+    for (int round = 0; round < 20000; ++round) {
+        const size_t start = (size_t)(rand() % 64);
+        const size_t len = (size_t)(rand() % ((round % 10 == 0) ? MAX_LEN : 200));
+        /* mostly clean input with sparse escapes, like real log messages */
+        const int density = 1 + rand() % 64;
+        for (size_t i = 0; i < len; ++i)
+            buf[start + i] = (rand() % density == 0) ? randomByte() : (unsigned char)(0x20 + rand() % 0x5f);
+        checkOne(buf + start, len);
+    }
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file mpmcring_test.c
+ * @brief Coverage for the lock-free ring behind queue.type="ringBuffer".
+ *
+ * Checks the single-threaded full/empty boundaries and wrap-around, then runs
+ * several producers against several consumers and verifies that every element
+ * is delivered exactly once and that each producer's elements keep their
+ * order.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include "mpmcring.h"
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            fprintf(stderr, "CHECK failed at %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            exit(1);                                                                        \
+        }                                                                                   \
+    } while (0)
+
+#define N_PRODUCERS 8
+#define N_CONSUMERS 4
+#define PER_PRODUCER 200000
+/* element value: producer index in the high bits, sequence in the low bits */
+#define SEQ_BITS 24
+
+static mpmcring_t ring;
+static unsigned char seen[N_PRODUCERS][PER_PRODUCER];
+static int nConsumed;
+
+static void *producer(void *arg) {
+    const uintptr_t id = (uintptr_t)arg;
+    for (uintptr_t i = 0; i < PER_PRODUCER; ++i) {
+        /* +1 keeps NULL out of the ring, just like real message pointers */
+        while (!mpmcRingPush(&ring, (void *)((id << SEQ_BITS | i) + 1))) sched_yield();
+    }
+    return NULL;
+}
+
+static void *consumer(void __attribute__((unused)) * arg) {
+    long last[N_PRODUCERS];
+    void *p;
+    for (int i = 0; i < N_PRODUCERS; ++i) last[i] = -1;
+    while (__atomic_load_n(&nConsumed, __ATOMIC_RELAXED) < N_PRODUCERS * PER_PRODUCER) {
+        if (!mpmcRingPop(&ring, &p)) {
+            sched_yield();
+            continue;
+        }
+        const uintptr_t v = (uintptr_t)p - 1;
+        const uintptr_t id = v >> SEQ_BITS;
+        const long seq = (long)(v & ((1u << SEQ_BITS) - 1));
+        CHECK(id < N_PRODUCERS && seq < PER_PRODUCER);
+        CHECK(seq > last[id]); /* per-producer FIFO as observed by one consumer */
+        last[id] = seq;
+        CHECK(__atomic_fetch_add(&seen[id][seq], 1, __ATOMIC_RELAXED) == 0);
+        __atomic_fetch_add(&nConsumed, 1, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+static void check_single_thread(void) {
+    mpmcring_t r;
+    void *p;
+
+    CHECK(mpmcRingInit(&r, 5) == 0); /* rounded up to 8 */
+    CHECK(!mpmcRingPop(&r, &p));
+    for (int lap = 0; lap < 3; ++lap) {
+        for (uintptr_t i = 1; i <= 8; ++i) CHECK(mpmcRingPush(&r, (void *)i));
+        CHECK(!mpmcRingPush(&r, (void *)9));
+        for (uintptr_t i = 1; i <= 8; ++i) {
+            CHECK(mpmcRingPop(&r, &p));
+            CHECK(p == (void *)i);
+        }
+        CHECK(!mpmcRingPop(&r, &p));
+    }
+    /* keep the ring partially filled while the cursors wrap many times */
+    CHECK(mpmcRingPush(&r, (void *)1));
+    for (uintptr_t i = 2; i <= 100; ++i) {
+        CHECK(mpmcRingPush(&r, (void *)i));
+        CHECK(mpmcRingPop(&r, &p));
+        CHECK(p == (void *)(i - 1));
+    }
+    CHECK(mpmcRingPop(&r, &p));
+    CHECK(p == (void *)100);
+    CHECK(!mpmcRingPop(&r, &p));
+    mpmcRingDestroy(&r);
+}
+
+int main(void) {
+    pthread_t prod[N_PRODUCERS];
+    pthread_t cons[N_CONSUMERS];
+
+    check_single_thread();
+
+    CHECK(mpmcRingInit(&ring, 1024) == 0);
+    for (uintptr_t i = 0; i < N_CONSUMERS; ++i) CHECK(pthread_create(&cons[i], NULL, consumer, NULL) == 0);
+    for (uintptr_t i = 0; i < N_PRODUCERS; ++i) CHECK(pthread_create(&prod[i], NULL, producer, (void *)i) == 0);
+    for (int i = 0; i < N_PRODUCERS; ++i) pthread_join(prod[i], NULL);
+    for (int i = 0; i < N_CONSUMERS; ++i) pthread_join(cons[i], NULL);
+
+    for (int i = 0; i < N_PRODUCERS; ++i) {
+        for (int j = 0; j < PER_PRODUCER; ++j) CHECK(seen[i][j] == 1);
+    }
+    mpmcRingDestroy(&ring);
+    return 0;
+}
@@ -0,0 +1,197 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file msgpool_test.c
+ * @brief Coverage for the per-thread message object pool.
+ *
+ * Checks local reuse and the cache limit on one thread, then lets producer
+ * threads allocate objects that consumer threads release, like inputs and
+ * queue workers do, and verifies that recycled objects are never handed out
+ * twice, keep their one-time initialization and that every object created is
+ * destructed exactly once when the pool is torn down.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "msgpool.h"
+
+#include "../../runtime/msgpool.c"
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            fprintf(stderr, "CHECK failed at %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            exit(1);                                                                        \
+        }                                                                                   \
+    } while (0)
+
+#define N_PRODUCERS 4
+#define N_CONSUMERS 3
+#define PER_PRODUCER 200000
+/* well below what the caches keep, so that nearly all objects are recycled */
+#define HANDOFF_SIZE 512
+#define INIT_MAGIC 0x4d534750u
+
+typedef struct testObj_s {
+    unsigned magic; /* stands in for the message mutex */
+    int live;
+    char payload[200];
+} testObj_t;
+
+static int nCreated;
+static int nDestroyed;
+
+static struct {
+    pthread_mutex_t mut;
+    pthread_cond_t notEmpty;
+    pthread_cond_t notFull;
+    testObj_t *objs[HANDOFF_SIZE];
+    int head;
+    int n;
+    int producersDone;
+} handoff = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, {NULL}, 0, 0, 0};
+
+static void objDestruct(void *const p) {
+    testObj_t *const o = (testObj_t *)p;
+    CHECK(o->magic == INIT_MAGIC);
+    CHECK(!o->live);
+    o->magic = 0;
+    __atomic_fetch_add(&nDestroyed, 1, __ATOMIC_SEQ_CST);
+}
+
+static testObj_t *objGet(void) {
+    int bRecycled;
+    testObj_t *const o = msgpoolAlloc(&bRecycled);
+    CHECK(o != NULL);
+    if (bRecycled) {
+        CHECK(o->magic == INIT_MAGIC);
+        CHECK(!o->live);
+    } else {
+        o->magic = INIT_MAGIC;
+        __atomic_fetch_add(&nCreated, 1, __ATOMIC_SEQ_CST);
+    }
+    o->live = 1;
+    return o;
+}
+
+static void objPut(testObj_t *const o) {
+    CHECK(o->live);
+    o->live = 0;
+    msgpoolRelease(o);
+}
+
+static void *producer(void __attribute__((unused)) * arg) {
+    for (int i = 0; i < PER_PRODUCER; ++i) {
+        testObj_t *const o = objGet();
+        pthread_mutex_lock(&handoff.mut);
+        while (handoff.n == HANDOFF_SIZE) pthread_cond_wait(&handoff.notFull, &handoff.mut);
+        handoff.objs[(handoff.head + handoff.n++) % HANDOFF_SIZE] = o;
+        pthread_cond_signal(&handoff.notEmpty);
+        pthread_mutex_unlock(&handoff.mut);
+    }
+    return NULL;
+}
+
+static void *consumer(void __attribute__((unused)) * arg) {
+    for (;;) {
+        testObj_t *o;
+        pthread_mutex_lock(&handoff.mut);
+        while (handoff.n == 0 && handoff.producersDone < N_PRODUCERS)
+            pthread_cond_wait(&handoff.notEmpty, &handoff.mut);
+        if (handoff.n == 0) {
+            pthread_mutex_unlock(&handoff.mut);
+            return NULL;
+        }
+        o = handoff.objs[handoff.head];
+        handoff.head = (handoff.head + 1) % HANDOFF_SIZE;
+        --handoff.n;
+        pthread_cond_signal(&handoff.notFull);
+        pthread_mutex_unlock(&handoff.mut);
+        objPut(o);
+    }
+}
+
+static void *producerMain(void *arg) {
+    producer(arg);
+    pthread_mutex_lock(&handoff.mut);
+    ++handoff.producersDone;
+    pthread_cond_broadcast(&handoff.notEmpty);
+    pthread_mutex_unlock(&handoff.mut);
+    return NULL;
+}
+
+static void checkLocal(void) {
+    static testObj_t *objs[MSGPOOL_CACHE_MAX + 10];
+    msgpoolStats_t stats;
+    testObj_t *o = objGet();
+    objPut(o);
+    CHECK(objGet() == o); /* the last object released is the first reused */
+    objPut(o);
+
+    for (int i = 0; i < MSGPOOL_CACHE_MAX + 10; ++i) objs[i] = objGet();
+    for (int i = 0; i < MSGPOOL_CACHE_MAX + 10; ++i) objPut(objs[i]);
+    msgpoolGetStats(&stats);
+    CHECK(stats.hits == 2);
+    CHECK(stats.misses == MSGPOOL_CACHE_MAX + 10);
+    CHECK(stats.trimmed == 10);
+    CHECK(nDestroyed == 10);
+}
+
+static void *exitingThread(void *arg) {
+    *(testObj_t **)arg = objGet();
+    return NULL;
+}
+
+/* objects of an exited thread still go home, and the cache is adopted */
+static void checkOrphan(void) {
+    pthread_t thrd;
+    testObj_t *o;
+    testObj_t *again;
+    CHECK(pthread_create(&thrd, NULL, exitingThread, &o) == 0);
+    pthread_join(thrd, NULL);
+    objPut(o);
+    for (int i = 1; i < MSGPOOL_BATCH; ++i) objPut(objGet());
+    CHECK(pthread_create(&thrd, NULL, exitingThread, &again) == 0);
+    pthread_join(thrd, NULL);
+    objPut(again);
+}
+
+int main(void) {
+    pthread_t prod[N_PRODUCERS];
+    pthread_t cons[N_CONSUMERS];
+    msgpoolStats_t stats;
+
+#ifdef MSGPOOL_BYPASS
+    return 77; /* --disable-msgpool: nothing is recycled, skip */
+#endif
+    CHECK(msgpoolInit(sizeof(testObj_t), objDestruct) == RS_RET_OK);
+    checkLocal();
+    checkOrphan();
+
+    for (int i = 0; i < N_CONSUMERS; ++i) CHECK(pthread_create(&cons[i], NULL, consumer, NULL) == 0);
+    for (int i = 0; i < N_PRODUCERS; ++i) CHECK(pthread_create(&prod[i], NULL, producerMain, NULL) == 0);
+    for (int i = 0; i < N_PRODUCERS; ++i) pthread_join(prod[i], NULL);
+    for (int i = 0; i < N_CONSUMERS; ++i) pthread_join(cons[i], NULL);
+
+    msgpoolGetStats(&stats);
+    CHECK(stats.hits + stats.misses
+          == 2 + MSGPOOL_CACHE_MAX + 10 + 2 + MSGPOOL_BATCH - 1 + (uint64)N_PRODUCERS * PER_PRODUCER);
+    CHECK(stats.remoteFrees > 0);
+    CHECK(stats.hits > (uint64)N_PRODUCERS * PER_PRODUCER / 10 * 9); /* nearly all objects were recycled */
+
+    msgpoolExit();
+    CHECK(nDestroyed == nCreated);
+    return 0;
+}
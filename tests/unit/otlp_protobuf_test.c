@@ -0,0 +1,261 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file otlp_protobuf_test.c
+ * @brief Byte-exact comparison of the omotel streaming protobuf encoder.
+ *
+ * The oracle is omotel_protobuf_build_export(), which packs a protobuf-c
+ * object graph. Hand-picked batches cover the default-value rules (empty
+ * strings, zero numbers, false booleans, missing or malformed trace ids,
+ * negative enum values, empty keys), attribute renaming and the shared
+ * host.name resource attribute; randomized batches then mix all of them.
+ * Every batch is encoded into the same buffer to cover reuse, including
+ * records long enough to need multi-byte length prefixes.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../plugins/omotel/otlp_protobuf.c"
+#include "opentelemetry/proto/common/v1/common.pb-c.c"
+#include "opentelemetry/proto/resource/v1/resource.pb-c.c"
+#include "opentelemetry/proto/logs/v1/logs.pb-c.c"
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            fprintf(stderr, "CHECK failed at %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            exit(1);                                                                        \
+        }                                                                                   \
+    } while (0)
+
+#define N_RANDOM_BATCHES 500
+#define MAX_RANDOM_RECORDS 40
+
+static omotel_pbuf_t buf;
+
+static void checkSame(const omotel_log_record_t *records,
+                      size_t count,
+                      const omotel_resource_attrs_t *resource_attrs,
+                      const attribute_map_t *attribute_map) {
+    uint8_t *expected = NULL;
+    size_t expected_len = 0;
+
+    CHECK(omotel_protobuf_build_export(records, count, resource_attrs, attribute_map, &expected, &expected_len) ==
+          RS_RET_OK);
+    CHECK(omotel_protobuf_encode_export(records, count, resource_attrs, attribute_map, &buf) == RS_RET_OK);
+    if (buf.len != expected_len || memcmp(buf.data, expected, expected_len) != 0) {
+        size_t i = 0;
+        while (i < buf.len && i < expected_len && buf.data[i] == expected[i]) ++i;
+        fprintf(stderr, "encoding differs at offset %zu (length %zu, expected %zu)\n", i, buf.len, expected_len);
+        exit(1);
+    }
+    free(expected);
+}
+
+static void checkDefaults(void) {
+    omotel_log_record_t records[3];
+
+    memset(records, 0, sizeof(records));
+    /* nothing but defaults: body is still written as an empty string */
+    checkSame(records, 1, NULL, NULL);
+
+    records[0].severity_number = 0xffffffffu; /* sign-extended like int32 */
+    records[0].severity_text = "";
+    records[0].body = "";
+    records[0].app_name = "";
+    records[0].proc_id = "";
+    records[0].msg_id = "";
+    records[0].hostname = "";
+    records[0].trace_id = "0af7651916cd43dd8448eb211c80319";
+    records[0].span_id = "b7ad6b71692033310";
+    records[1].trace_id = "0af7651916cd43dd8448eb211c80319g";
+    records[1].span_id = "b7ad6b716920333x";
+    records[1].hostname = "a";
+    records[2].hostname = "b";
+    checkSame(records, 3, NULL, NULL);
+}
+
+static void checkFullRecord(void) {
+    struct fjson_object *custom;
+    omotel_resource_attrs_t resource_attrs = {
+        .service_instance_id = "instance-1",
+        .deployment_environment = "production",
+    };
+    omotel_log_record_t records[2];
+
+    custom = fjson_tokener_parse(
+        "{\"team\": \"ops\", \"empty\": \"\", \"negative\": -42, \"zero\": 0, \"ratio\": 3.5,"
+        " \"dzero\": 0.0, \"no\": false, \"yes\": true, \"nothing\": null, \"\": \"no key\","
+        " \"nested\": {\"a\": 1}, \"list\": [1, 2]}");
+    CHECK(custom != NULL);
+    resource_attrs.custom_attributes = custom;
+
+    memset(records, 0, sizeof(records));
+    records[0].time_unix_nano = 1700000000123456789ull;
+    records[0].observed_time_unix_nano = 1700000000223456789ull;
+    records[0].severity_number = 9;
+    records[0].severity_text = "INFO";
+    records[0].body = "hello world";
+    records[0].hostname = "host1";
+    records[0].app_name = "app";
+    records[0].proc_id = "123";
+    records[0].msg_id = "ID1";
+    records[0].trace_id = "0AF7651916cd43dd8448eb211c80319c";
+    records[0].span_id = "b7ad6b7169203331";
+    records[0].trace_flags = 1;
+    records[0].facility = 16;
+    records[1].time_unix_nano = 5;
+    records[1].severity_number = 17;
+    records[1].hostname = "host1";
+    records[1].trace_flags = 255;
+    checkSame(records, 2, &resource_attrs, NULL);
+
+    fjson_object_put(custom);
+}
+
+static void checkAttributeMap(void) {
+    struct attribute_map_entry_s entries[] = {
+        {"hostname", "host"}, {"appname", "service"}, {"procid", ""}, {"facility", "syslog.facility.code"}};
+    attribute_map_t map = {entries, sizeof(entries) / sizeof(entries[0]), sizeof(entries) / sizeof(entries[0])};
+    omotel_log_record_t record;
+
+    memset(&record, 0, sizeof(record));
+    record.body = "mapped";
+    record.hostname = "h";
+    record.app_name = "a";
+    record.proc_id = "1";
+    record.msg_id = "m";
+    record.facility = 23;
+    checkSame(&record, 1, NULL, &map);
+}
+
+/* records and containers longer than 127 bytes get multi-byte lengths */
+static void checkLongRecords(void) {
+    static char big[70000];
+    static char mid[200];
+    omotel_log_record_t records[64];
+    size_t capacity;
+
+    memset(big, 'b', sizeof(big) - 1);
+    memset(mid, 'm', sizeof(mid) - 1);
+    memset(records, 0, sizeof(records));
+    for (int i = 0; i < 64; ++i) {
+        records[i].time_unix_nano = (uint64_t)i + 1;
+        records[i].body = (i % 8 == 0) ? big : mid;
+        records[i].hostname = "h";
+        records[i].facility = (uint16_t)(i % 24);
+    }
+    checkSame(records, 64, NULL, NULL);
+
+    /* a following small batch reuses the grown buffer */
+    capacity = buf.capacity;
+    checkSame(records + 1, 1, NULL, NULL);
+    CHECK(buf.capacity == capacity);
+}
+
+static const char *randomString(void) {
+    static const char *const values[] = {NULL, "", "a", "host-1", "host-2", "value with spaces", "\xc3\xa4\xc3\xb6"};
+    return values[rand() % (int)(sizeof(values) / sizeof(values[0]))];
+}
+
+static const char *randomHexId(size_t len) {
+    static char ids[4][40];
+    static int next = 0;
+    char *const id = ids[next++ % 4];
+    const int kind = rand() % 5;
+
+    if (kind == 0) return NULL;
+    if (kind == 1) return "";
+    for (size_t i = 0; i < len; ++i) id[i] = "0123456789abcdefABCDEF"[rand() % 22];
+    id[len] = '\0';
+    if (kind == 2) id[rand() % len] = 'x'; /* not hex */
+    if (kind == 3) id[len - 1] = '\0'; /* wrong length */
+    return id;
+}
+
+static void checkRandomBatches(void) {
+    static char bodies[MAX_RANDOM_RECORDS][512];
+    static char ids[MAX_RANDOM_RECORDS][2][40];
+    struct attribute_map_entry_s entries[] = {{"hostname", "host.name.override"}, {"msgid", "event.id"}};
+    attribute_map_t map = {entries, 2, 2};
+    omotel_log_record_t records[MAX_RANDOM_RECORDS];
+    struct fjson_object *custom;
+    omotel_resource_attrs_t resource_attrs = {0};
+
+    custom = fjson_tokener_parse("{\"k1\": \"v\", \"k2\": 7, \"k3\": -0.25, \"k4\": true}");
+    CHECK(custom != NULL);
+    for (int batch = 0; batch < N_RANDOM_BATCHES; ++batch) {
+        const size_t count = 1 + (size_t)(rand() % MAX_RANDOM_RECORDS);
+
+        memset(records, 0, sizeof(records));
+        for (size_t i = 0; i < count; ++i) {
+            const size_t body_len = (size_t)(rand() % (int)sizeof(bodies[i]));
+            const char *id;
+
+            memset(bodies[i], 'a' + (int)(i % 26), body_len);
+            bodies[i][body_len] = '\0';
+            records[i].body = (rand() % 8 == 0) ? NULL : bodies[i];
+            records[i].time_unix_nano = (rand() % 4 == 0) ? 0 : ((uint64_t)rand() << 32 | (uint64_t)rand());
+            records[i].observed_time_unix_nano = (rand() % 4 == 0) ? 0 : (uint64_t)rand();
+            records[i].severity_number = (uint32_t)(rand() % 25);
+            records[i].severity_text = randomString();
+            records[i].hostname = (batch % 3 == 0) ? "same-host" : randomString();
+            records[i].app_name = randomString();
+            records[i].proc_id = randomString();
+            records[i].msg_id = randomString();
+            records[i].trace_flags = (uint8_t)(rand() % 3 == 0 ? rand() : 0);
+            records[i].facility = (uint16_t)(rand() % 24);
+            /* randomHexId() reuses a small ring of buffers */
+            if ((id = randomHexId(32)) != NULL) {
+                strcpy(ids[i][0], id);
+                id = ids[i][0];
+            }
+            records[i].trace_id = id;
+            if ((id = randomHexId(16)) != NULL) {
+                strcpy(ids[i][1], id);
+                id = ids[i][1];
+            }
+            records[i].span_id = id;
+        }
+        resource_attrs.service_instance_id = randomString();
+        resource_attrs.deployment_environment = randomString();
+        resource_attrs.custom_attributes = (batch % 2) ? custom : NULL;
+        checkSame(records, count, &resource_attrs, (batch % 4 == 1) ? &map : NULL);
+    }
+    fjson_object_put(custom);
+}
+
+static void checkInvalidParameters(void) {
+    omotel_log_record_t record;
+
+    memset(&record, 0, sizeof(record));
+    CHECK(omotel_protobuf_encode_export(NULL, 1, NULL, NULL, &buf) == RS_RET_PARAM_ERROR);
+    CHECK(omotel_protobuf_encode_export(&record, 0, NULL, NULL, &buf) == RS_RET_PARAM_ERROR);
+    CHECK(omotel_protobuf_encode_export(&record, 1, NULL, NULL, NULL) == RS_RET_PARAM_ERROR);
+    CHECK(buf.len == 0);
+}
+
+int main(void) {
+    srand(20261017);
+    omotel_pbuf_init(&buf);
+    checkDefaults();
+    checkFullRecord();
+    checkAttributeMap();
+    checkLongRecords();
+    checkRandomBatches();
+    checkInvalidParameters();
+    omotel_pbuf_free(&buf);
+    return 0;
+}
@@ -0,0 +1,199 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file perctile_sketch_test.c
+ * @brief Coverage for the percentile_stats sketch backend.
+ *
+ * Checks every estimate against the exact nearest-rank value of the same
+ * data for several accuracies, that collecting resets the window, that
+ * values outside the bucket range and below 1 are handled, and that no
+ * observation is lost while many threads record and a reporter collects
+ * concurrently.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <pthread.h>
+#include "perctile_sketch.h"
+
+#include "../../runtime/statsctr.c"
+#include "../../runtime/perctile_sketch.c"
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            fprintf(stderr, "CHECK failed at %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            exit(1);                                                                        \
+        }                                                                                   \
+    } while (0)
+
+#define N_VALUES 100000
+#define N_THREADS 32
+#define N_UPDATES 50000
+
+static const uint8_t percentiles[] = {1, 10, 25, 50, 75, 90, 95, 99, 100};
+
+static int cmpInt64(const void *p1, const void *p2) {
+    const int64_t a = *(const int64_t *)p1;
+    const int64_t b = *(const int64_t *)p2;
+    return (a > b) - (a < b);
+}
+
+static void checkAccuracy(const double accuracy) {
+    perctile_sketch_t *sketch;
+    perctile_sketch_window_t win;
+    int64_t *values;
+    uint64_t *merged;
+    int64_t sum = 0;
+
+    CHECK(perctile_sketch_new(&sketch, accuracy, PERCTILE_SKETCH_MAX_BUCKETS) == RS_RET_OK);
+    CHECK((values = malloc(N_VALUES * sizeof(*values))) != NULL);
+    CHECK((merged = malloc(perctile_sketch_buckets(sketch) * sizeof(*merged))) != NULL);
+    for (int i = 0; i < N_VALUES; ++i) {
+        /* log-uniform over 1 .. ~1e12, with small integers well represented */
+        values[i] = (int64_t)exp((double)rand() / RAND_MAX * 27.6);
+        sum += values[i];
+        CHECK(perctile_sketch_add(sketch, values[i]) == RS_RET_OK);
+    }
+    qsort(values, N_VALUES, sizeof(*values), cmpInt64);
+
+    perctile_sketch_collect(sketch, merged, &win);
+    CHECK(win.count == N_VALUES);
+    CHECK(win.sum == sum);
+    CHECK(win.min == values[0]);
+    CHECK(win.max == values[N_VALUES - 1]);
+    for (size_t i = 0; i < sizeof(percentiles); ++i) {
+        uint64_t rank = (uint64_t)((percentiles[i] / 100.0) * N_VALUES);
+        const int64_t exact = values[rank > 0 ? rank - 1 : 0];
+        const int64_t estimate = perctile_sketch_quantile(sketch, merged, &win, percentiles[i]);
+        /* relative accuracy, plus rounding to an integer */
+        CHECK(fabs((double)(estimate - exact)) <= accuracy * (double)exact + 0.5);
+    }
+
+    /* the window was reset */
+    perctile_sketch_collect(sketch, merged, &win);
+    CHECK(win.count == 0 && win.sum == 0);
+    free(merged);
+    free(values);
+    perctile_sketch_del(sketch);
+}
+
+/* few buckets: large values share the open-ended last bucket, which is
+ * reported as the window max */
+static void checkBoundedBuckets(void) {
+    perctile_sketch_t *sketch;
+    perctile_sketch_window_t win;
+    uint64_t merged[PERCTILE_SKETCH_MIN_BUCKETS];
+
+    CHECK(perctile_sketch_new(&sketch, 0.01, PERCTILE_SKETCH_MIN_BUCKETS) == RS_RET_OK);
+    CHECK(perctile_sketch_buckets(sketch) == PERCTILE_SKETCH_MIN_BUCKETS);
+    CHECK(perctile_sketch_add(sketch, -5) == RS_RET_OK);
+    CHECK(perctile_sketch_add(sketch, 0) == RS_RET_OK);
+    CHECK(perctile_sketch_add(sketch, 1000000) == RS_RET_OK);
+    CHECK(perctile_sketch_add(sketch, 2000000) == RS_RET_OK);
+    perctile_sketch_collect(sketch, merged, &win);
+    CHECK(win.count == 4 && win.min == -5 && win.max == 2000000 && win.sum == 2999995);
+    CHECK(merged[0] == 2 && merged[PERCTILE_SKETCH_MIN_BUCKETS - 1] == 2);
+    CHECK(perctile_sketch_quantile(sketch, merged, &win, 50) == 0);
+    CHECK(perctile_sketch_quantile(sketch, merged, &win, 100) == 2000000);
+    perctile_sketch_del(sketch);
+
+    /* coarse accuracy needs fewer buckets than allowed */
+    CHECK(perctile_sketch_new(&sketch, 0.2, PERCTILE_SKETCH_MAX_BUCKETS) == RS_RET_OK);
+    CHECK(perctile_sketch_buckets(sketch) < 200);
+    perctile_sketch_del(sketch);
+}
+
+static void checkParameters(void) {
+    perctile_sketch_t *sketch = NULL;
+
+    CHECK(perctile_sketch_new(&sketch, 0.0, PERCTILE_SKETCH_DFLT_MAX_BUCKETS) == RS_RET_PARAM_ERROR);
+    CHECK(perctile_sketch_new(&sketch, 0.9, PERCTILE_SKETCH_DFLT_MAX_BUCKETS) == RS_RET_PARAM_ERROR);
+    CHECK(perctile_sketch_new(&sketch, NAN, PERCTILE_SKETCH_DFLT_MAX_BUCKETS) == RS_RET_PARAM_ERROR);
+    CHECK(perctile_sketch_new(&sketch, 0.01, PERCTILE_SKETCH_MIN_BUCKETS - 1) == RS_RET_PARAM_ERROR);
+    CHECK(perctile_sketch_new(&sketch, 0.01, PERCTILE_SKETCH_MAX_BUCKETS + 1) == RS_RET_PARAM_ERROR);
+    CHECK(sketch == NULL);
+}
+
+static perctile_sketch_t *sharedSketch;
+static int bStopCollector;
+DEF_ATOMIC_HELPER_MUT(mutStop);
+
+static void *observer(void *arg) {
+    const int64_t base = (int64_t)(uintptr_t)arg;
+
+    for (int i = 0; i < N_UPDATES; ++i) {
+        CHECK(perctile_sketch_add(sharedSketch, base + i % 1000) == RS_RET_OK);
+    }
+    return NULL;
+}
+
+typedef struct collected_s {
+    uint64_t count;
+    int64_t sum;
+} collected_t;
+
+static void *collector(void *arg) {
+    collected_t *const total = arg;
+    perctile_sketch_window_t win;
+    uint64_t *merged;
+
+    CHECK((merged = malloc(perctile_sketch_buckets(sharedSketch) * sizeof(*merged))) != NULL);
+    while (!ATOMIC_LOAD_32BIT(&bStopCollector, &mutStop)) {
+        perctile_sketch_collect(sharedSketch, merged, &win);
+        total->count += win.count;
+        total->sum += win.sum;
+    }
+    free(merged);
+    return NULL;
+}
+
+static void checkConcurrentObservers(void) {
+    pthread_t threads[N_THREADS];
+    pthread_t collectorThread;
+    collected_t total = {0, 0};
+    perctile_sketch_window_t win;
+    uint64_t *merged;
+    int64_t expectedSum = 0;
+
+    CHECK(perctile_sketch_new(&sharedSketch, 0.01, PERCTILE_SKETCH_DFLT_MAX_BUCKETS) == RS_RET_OK);
+    CHECK(pthread_create(&collectorThread, NULL, collector, &total) == 0);
+    for (uintptr_t t = 0; t < N_THREADS; ++t) {
+        CHECK(pthread_create(&threads[t], NULL, observer, (void *)(t * 1000)) == 0);
+        for (int i = 0; i < N_UPDATES; ++i) expectedSum += (int64_t)(t * 1000) + i % 1000;
+    }
+    for (int t = 0; t < N_THREADS; ++t) CHECK(pthread_join(threads[t], NULL) == 0);
+    ATOMIC_STORE_32BIT(&bStopCollector, &mutStop, 1);
+    CHECK(pthread_join(collectorThread, NULL) == 0);
+
+    CHECK((merged = malloc(perctile_sketch_buckets(sharedSketch) * sizeof(*merged))) != NULL);
+    perctile_sketch_collect(sharedSketch, merged, &win);
+    CHECK(total.count + win.count == (uint64_t)N_THREADS * N_UPDATES);
+    CHECK(total.sum + win.sum == expectedSum);
+    free(merged);
+    perctile_sketch_del(sharedSketch);
+}
+
+int main(void) {
+    srand(20261017);
+    INIT_ATOMIC_HELPER_MUT(mutStop);
+    checkParameters();
+    checkAccuracy(0.01);
+    checkAccuracy(0.001);
+    checkAccuracy(0.05);
+    checkBoundedBuckets();
+    checkConcurrentObservers();
+    return 0;
+}
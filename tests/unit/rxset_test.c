@@ -0,0 +1,261 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file rxset_test.c
+ * @brief Differential coverage for the multi-regex DFA.
+ *
+ * Generates random regex tables over a tiny alphabet, so that regexes overlap
+ * and interact, and checks that the set reports the same lowest matching
+ * index as running regexec() on each regex in table order, which is what the
+ * regex lookup table did before. Fixed cases cover anchors, classes, bounds
+ * and the syntax the set must leave to regexec().
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <regex.h>
+#include "rxset.h"
+
+#include "../../runtime/rxset.c"
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            fprintf(stderr, "CHECK failed at %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            exit(1);                                                                        \
+        }                                                                                   \
+    } while (0)
+
+#define MAX_REGEX 40
+#define MAX_REGEX_LEN 64
+
+static void genAtom(char **const pp, const int depth) {
+    static const char *const atoms[] = {"a", "b", "c", ".", "[ab]", "[^a]", "[a-c]", "[[:digit:]]", "\\.", "x"};
+    const int r = rand() % 14;
+    if (r < 10) {
+        *pp += sprintf(*pp, "%s", atoms[r]);
+    } else if (r < 12 && depth < 3) {
+        *(*pp)++ = '(';
+        for (int n = 1 + rand() % 3; n > 0; --n) genAtom(pp, depth + 1);
+        if (rand() % 3 == 0) {
+            *(*pp)++ = '|';
+            genAtom(pp, depth + 1);
+        }
+        *(*pp)++ = ')';
+    } else if (r == 12) {
+        *(*pp)++ = '^';
+        return;
+    } else {
+        *(*pp)++ = '$';
+        return;
+    }
+    switch (rand() % 8) {
+        case 0:
+            *(*pp)++ = '*';
+            break;
+        case 1:
+            *(*pp)++ = '+';
+            break;
+        case 2:
+            *(*pp)++ = '?';
+            break;
+        case 3:
+            *pp += sprintf(*pp, "{%d,%d}", rand() % 2, 1 + rand() % 3);
+            break;
+        default:
+            break;
+    }
+}
+
+static void genRegex(char *buf) {
+    char *p = buf;
+    for (int n = 1 + rand() % 4; n > 0; --n) genAtom(&p, 0);
+    if (rand() % 5 == 0) {
+        *p++ = '|';
+        genAtom(&p, 0);
+    }
+    *p = '\0';
+}
+
+static void genSubject(char *buf, const int len) {
+    static const char alphabet[] = "abc1.x\n";
+    for (int i = 0; i < len; ++i) buf[i] = alphabet[rand() % (sizeof(alphabet) - 1)];
+    buf[len] = '\0';
+}
+
+static void checkRandom(void) {
+    char src[MAX_REGEX][MAX_REGEX_LEN * 4];
+    regex_t re[MAX_REGEX];
+    int compiled[MAX_REGEX];
+    char subject[32];
+    int nUndecided = 0;
+
+    for (int round = 0; round < 400; ++round) {
+        rxset_t *set;
+        int n = 0;
+        CHECK(rxsetConstruct(&set) == RS_RET_OK);
+        for (int tries = 1 + rand() % MAX_REGEX; tries > 0; --tries) {
+            genRegex(src[n]);
+            if (regcomp(&re[n], src[n], REG_EXTENDED | REG_NOSUB) != 0) continue;
+            CHECK(rxsetAdd(set, src[n], &compiled[n]) == RS_RET_OK);
+            ++n;
+        }
+        CHECK(rxsetCompile(set) == RS_RET_OK);
+        for (int t = 0; t < 100; ++t) {
+            int expected = RXSET_NOMATCH;
+            genSubject(subject, rand() % 12);
+            for (int i = 0; i < n; ++i) {
+                if (compiled[i] && regexec(&re[i], subject, 0, NULL, 0) == 0) {
+                    expected = i;
+                    break;
+                }
+            }
+            const int r = rxsetMatch(set, (const unsigned char *)subject, strlen(subject));
+            if (r == RXSET_UNDECIDED) {
+                ++nUndecided;
+                continue;
+            }
+            if (r != expected) {
+                fprintf(stderr, "subject '%s': set says %d, regexec says %d\n", subject, r, expected);
+                for (int i = 0; i < n; ++i) fprintf(stderr, "  %d%s: %s\n", i, compiled[i] ? "" : " (n/c)", src[i]);
+            }
+            CHECK(r == expected);
+        }
+        for (int i = 0; i < n; ++i) regfree(&re[i]);
+        rxsetDestruct(&set);
+        CHECK(set == NULL);
+    }
+    CHECK(nUndecided == 0); /* these tables are far below the size limits */
+}
+
+/* a large table of similar regexes, as in real lookup tables, where the
+ * restart sets T are large and shared by many states
+ */
+static void checkLarge(void) {
+    enum { N = 2000 };
+    static regex_t re[N];
+    char src[64];
+    char subject[64];
+    rxset_t *set;
+    int compiled;
+
+    CHECK(rxsetConstruct(&set) == RS_RET_OK);
+    for (int i = 0; i < N; ++i) {
+        if (i % 2 == 0)
+            snprintf(src, sizeof(src), "(^|[ =])k%04d[a-c]+( |$)", i);
+        else
+            snprintf(src, sizeof(src), "u%04d.x", i);
+        CHECK(regcomp(&re[i], src, REG_EXTENDED | REG_NOSUB) == 0);
+        CHECK(rxsetAdd(set, src, &compiled) == RS_RET_OK && compiled);
+    }
+    CHECK(rxsetCompile(set) == RS_RET_OK);
+    for (int t = 0; t < 300; ++t) {
+        int expected = RXSET_NOMATCH;
+        char *p = subject;
+        for (int n = rand() % 3; n >= 0; --n) {
+            const int k = rand() % (N + 50);
+            p += sprintf(p, (rand() % 2) ? "k%04d%s " : "u%04d%s=", k, (rand() % 2) ? "ab" : "1x");
+        }
+        if (rand() % 2) p[-1] = '\0';
+        for (int i = 0; i < N; ++i) {
+            if (regexec(&re[i], subject, 0, NULL, 0) == 0) {
+                expected = i;
+                break;
+            }
+        }
+        CHECK(rxsetMatch(set, (const unsigned char *)subject, strlen(subject)) == expected);
+    }
+    for (int i = 0; i < N; ++i) regfree(&re[i]);
+    rxsetDestruct(&set);
+}
+
+static int matchOne(const char *const regex, const char *const subject) {
+    rxset_t *set;
+    int compiled;
+    int r;
+    CHECK(rxsetConstruct(&set) == RS_RET_OK);
+    CHECK(rxsetAdd(set, regex, &compiled) == RS_RET_OK);
+    CHECK(compiled);
+    CHECK(rxsetCompile(set) == RS_RET_OK);
+    r = rxsetMatch(set, (const unsigned char *)subject, strlen(subject));
+    rxsetDestruct(&set);
+    return r == 0;
+}
+
+static int isCompiled(const char *const regex) {
+    rxset_t *set;
+    int compiled;
+    CHECK(rxsetConstruct(&set) == RS_RET_OK);
+    CHECK(rxsetAdd(set, regex, &compiled) == RS_RET_OK);
+    CHECK(rxsetCompile(set) == RS_RET_OK);
+    rxsetDestruct(&set);
+    return compiled;
+}
+
+static void checkFixed(void) {
+    rxset_t *set;
+    int compiled;
+
+    CHECK(matchOne("^$", ""));
+    CHECK(!matchOne("^$", "a"));
+    CHECK(matchOne("^ab", "abc"));
+    CHECK(!matchOne("^ab", "cab"));
+    CHECK(matchOne("ab$", "cab"));
+    CHECK(matchOne("x*", ""));
+    CHECK(matchOne("[[:upper:]][[:digit:]]{2,3}$", "zzA123"));
+    CHECK(!matchOne("[[:upper:]][[:digit:]]{2,3}$", "zzA1"));
+    CHECK(matchOne("^(foo|bar)+baz", "barfoobaz"));
+    CHECK(matchOne("[]x]", "]"));
+    CHECK(matchOne("[a-]", "-"));
+    CHECK(matchOne("[^a]", "\n"));
+    CHECK(matchOne("a.c", "a\nc"));
+    CHECK(matchOne("\\$[0-9]+\\.", "cost $42."));
+    CHECK(matchOne("a{3}", "xaaax"));
+    CHECK(!matchOne("^a{3}$", "aaaa"));
+    CHECK(matchOne("()x", "x"));
+
+    CHECK(matchOne("(^a|b$)", "xb"));
+    CHECK(!matchOne("(^a|b$)", "xa"));
+
+    CHECK(!isCompiled("\\w+"));
+    CHECK(!isCompiled("a^b"));
+    CHECK(!isCompiled(".$."));
+    CHECK(!isCompiled("(a$)+"));
+    CHECK(!isCompiled("(a)\\1"));
+    CHECK(!isCompiled("[[:alpha:][.a.]]"));
+    CHECK(!isCompiled("a|"));
+    CHECK(!isCompiled("caf\xc3\xa9"));
+    CHECK(!isCompiled("a{1000}"));
+
+    /* first match in table order wins, unsupported regexes keep their index */
+    CHECK(rxsetConstruct(&set) == RS_RET_OK);
+    CHECK(rxsetAdd(set, "error", &compiled) == RS_RET_OK && compiled);
+    CHECK(rxsetAdd(set, "\\bdisk\\b", &compiled) == RS_RET_OK && !compiled);
+    CHECK(rxsetAdd(set, "disk", &compiled) == RS_RET_OK && compiled);
+    CHECK(rxsetAdd(set, "d.sk full", &compiled) == RS_RET_OK && compiled);
+    CHECK(rxsetCompile(set) == RS_RET_OK);
+    CHECK(rxsetMatch(set, (const unsigned char *)"disk full", 9) == 2);
+    CHECK(rxsetMatch(set, (const unsigned char *)"disk full error", 15) == 0);
+    CHECK(rxsetMatch(set, (const unsigned char *)"dusk full", 9) == 3);
+    CHECK(rxsetMatch(set, (const unsigned char *)"fine", 4) == RXSET_NOMATCH);
+    rxsetDestruct(&set);
+}
+
+int main(void) {
+    srand(4711);
+    checkFixed();
+    checkLarge();
+    checkRandom();
+    return 0;
+}
@@ -0,0 +1,115 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file statsctr_test.c
+ * @brief Coverage for sharded statistics counters.
+ *
+ * Lets more threads than there are shards update the same counters and
+ * checks that no update is lost, that every thread keeps its index, that
+ * slots are cache line aligned and that reset and the single slot fallback
+ * behave like a regular counter.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "statsctr.h"
+
+#include "../../runtime/statsctr.c"
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            fprintf(stderr, "CHECK failed at %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            exit(1);                                                                        \
+        }                                                                                   \
+    } while (0)
+
+#define N_THREADS 96 /* more than STATSCTR_MAX_SHARDS */
+#define N_UPDATES 20000
+
+static shardedctr_t ctrCount;
+static shardedctr_t ctrBytes;
+DEF_ATOMIC_HELPER_MUT64(mutCtr);
+
+static void *updater(void *arg) {
+    const unsigned idx = statsctrThreadIdx();
+    const uint64 delta = (uint64)(uintptr_t)arg;
+
+    for (int i = 0; i < N_UPDATES; ++i) {
+        ATOMIC_INC_uint64_RELAXED(statsctrShardedSlot(&ctrCount), &mutCtr);
+        ATOMIC_ADD_uint64_RELAXED(statsctrShardedSlot(&ctrBytes), &mutCtr, delta);
+    }
+    CHECK(statsctrThreadIdx() == idx);
+    return NULL;
+}
+
+static void checkConcurrentUpdates(void) {
+    pthread_t threads[N_THREADS];
+    uint64 expectedBytes = 0;
+
+    statsctrShardedInit(&ctrCount);
+    statsctrShardedInit(&ctrBytes);
+    for (uintptr_t i = 0; i < N_THREADS; ++i) {
+        CHECK(pthread_create(&threads[i], NULL, updater, (void *)(i + 1)) == 0);
+        expectedBytes += (uint64)(i + 1) * N_UPDATES;
+    }
+    for (int i = 0; i < N_THREADS; ++i) CHECK(pthread_join(threads[i], NULL) == 0);
+
+    CHECK(statsctrShardedGet(&ctrCount) == (uint64)N_THREADS * N_UPDATES);
+    CHECK(statsctrShardedGet(&ctrBytes) == expectedBytes);
+
+    statsctrShardedReset(&ctrCount);
+    CHECK(statsctrShardedGet(&ctrCount) == 0);
+    CHECK(statsctrShardedGet(&ctrBytes) == expectedBytes);
+    statsctrShardedDestruct(&ctrCount);
+    statsctrShardedDestruct(&ctrBytes);
+}
+
+static void checkLayout(void) {
+    const unsigned n = statsctrNumShards();
+    shardedctr_t ctr;
+
+    CHECK(n >= 1 && n <= STATSCTR_MAX_SHARDS);
+    CHECK((n & (n - 1)) == 0);
+    statsctrShardedInit(&ctr);
+    if (ctr.mem != NULL) {
+        CHECK(ctr.mask == n - 1);
+        CHECK((uintptr_t)ctr.slots % STATSCTR_CACHELINE == 0);
+        CHECK((char *)(ctr.slots + ctr.mask * STATSCTR_SLOT_STRIDE) + sizeof(uint64) <=
+              (char *)ctr.mem + (n + 1) * STATSCTR_CACHELINE);
+    }
+    statsctrShardedDestruct(&ctr);
+}
+
+/* what a counter looks like if the shards could not be allocated */
+static void checkSingleSlot(void) {
+    shardedctr_t ctr;
+
+    statsctrShardedInit(&ctr);
+    statsctrShardedDestruct(&ctr);
+    CHECK(ctr.slots == &ctr.single && ctr.mask == 0);
+    for (int i = 0; i < 1000; ++i) ATOMIC_INC_uint64_RELAXED(statsctrShardedSlot(&ctr), &mutCtr);
+    CHECK(statsctrShardedGet(&ctr) == 1000);
+    statsctrShardedReset(&ctr);
+    CHECK(statsctrShardedGet(&ctr) == 0);
+}
+
+int main(void) {
+    INIT_ATOMIC_HELPER_MUT64(mutCtr);
+    checkLayout();
+    checkSingleSlot();
+    checkConcurrentUpdates();
+    return 0;
+}
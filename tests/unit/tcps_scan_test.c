@@ -0,0 +1,80 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Copyright 2026 Rainer Gerhards and Adiscon GmbH.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * @file tcps_scan_test.c
+ * @brief Differential coverage for the vectorized TCP frame delimiter scanner.
+ *
+ * The oracle is the scalar scanner: every alignment, length and delimiter
+ * combination must report the same first match, including matches in the
+ * vector tail and buffers without any delimiter.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tcps_scan.h"
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            fprintf(stderr, "CHECK failed at %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            exit(1);                                                                        \
+        }                                                                                   \
+    } while (0)
+
+#define BUF_LEN 160
+
+static void check_all_positions(const int d1, const int d2) {
+    char buf[BUF_LEN + 1];
+    for (int start = 0; start < 33; ++start) {
+        for (int len = 0; start + len <= BUF_LEN; ++len) {
+            const char *const end = buf + start + len;
+            memset(buf, 'a', sizeof(buf));
+            CHECK(tcpsScanDelim(buf + start, end, d1, d2) == end);
+            for (int pos = start; pos < start + len; pos += 7) {
+                memset(buf, 'a', sizeof(buf));
+                buf[pos] = (char)((pos & 1) && d2 != TCPS_SCAN_NO_DELIM ? d2 : (d1 == TCPS_SCAN_NO_DELIM ? d2 : d1));
+                /* a delimiter just past the end must never be reported */
+                buf[start + len] = (char)d1;
+                const char *const hit = tcpsScanDelim(buf + start, end, d1, d2);
+                CHECK(hit == tcpsScanDelimScalar(buf + start, end, d1, d2));
+                CHECK(hit == buf + pos);
+            }
+        }
+    }
+}
+
+int main(void) {
+    char buf[4096];
+
+    check_all_positions('\n', TCPS_SCAN_NO_DELIM);
+    check_all_positions('\n', 0);
+    check_all_positions(TCPS_SCAN_NO_DELIM, 0xe4);
+    check_all_positions('\n', 0xff);
+
+    CHECK(tcpsScanDelim(buf, buf + sizeof(buf), TCPS_SCAN_NO_DELIM, TCPS_SCAN_NO_DELIM) == buf + sizeof(buf));
+
+    /* random data with sparse delimiters, high bytes included */
+    srand(4711);
+    for (int round = 0; round < 2000; ++round) {
+        for (size_t i = 0; i < sizeof(buf); ++i) buf[i] = (char)(rand() & 0xff);
+        const int d1 = rand() & 0xff;
+        const int d2 = (round & 1) ? TCPS_SCAN_NO_DELIM : (rand() & 0xff);
+        const size_t start = (size_t)(rand() % 64);
+        const size_t len = (size_t)(rand() % (int)(sizeof(buf) - start));
+        const char *const end = buf + start + len;
+        CHECK(tcpsScanDelim(buf + start, end, d1, d2) == tcpsScanDelimScalar(buf + start, end, d1, d2));
+    }
+
+    return 0;
+}
@@ -71,6 +71,7 @@
 #include "parserif.h"
 #include "janitor.h"
 #include "rsconf.h"
+#include "hashtable.h"
 
 MODULE_TYPE_OUTPUT;
 MODULE_TYPE_NOKEEP;
@@ -85,56 +86,23 @@ static rsRetVal normalizeDynaFileCacheSize(int *const pNewVal);
 DEF_OMOD_STATIC_DATA;
 DEFobjCurrIf(strm) DEFobjCurrIf(statsobj)
 
-/**
- * @brief Global counter/clock for file access timestamping.
- *
- * This counter is used as a "Lamport logical clock" for the LRU mechanism
- * of the dynamic file cache. It provides a monotonically increasing sequence
- * number to track the access order of files, rather than actual time.
- * It is highly unlikely to wrap within the lifetime of a process.
- */
-#ifdef HAVE_ATOMIC_BUILTINS64
-    static uint64 clockFileAccess = 0;
-#else
-    static unsigned clockFileAccess = 0;
-#endif
-
-/**
- * @brief Mutex for protecting clockFileAccess in non-atomic builtins environments.
- */
-#ifndef HAVE_ATOMIC_BUILTINS
-static pthread_mutex_t mutClock;
-#endif
-
-/**
- * @brief Retrieves and increments the global file access clock.
- *
- * This function provides a monotonically increasing counter used for the LRU
- * mechanism in the dynamic file cache. It is thread-safe.
- *
- * @return The incremented value of the file access clock.
- */
-static uint64 getClockFileAccess(void) {
-#ifdef HAVE_ATOMIC_BUILTINS64
-    return ATOMIC_INC_AND_FETCH_uint64(&clockFileAccess, &mutClock);
-#else
-    return ATOMIC_INC_AND_FETCH_unsigned(&clockFileAccess, &mutClock);
-#endif
-}
-
-
 /**
  * @brief Structure for a dynamic file name cache entry.
  *
  * This structure holds information about a dynamically opened file,
  * including its name, the associated stream, signature provider data,
- * and access timestamp for LRU management.
+ * and its links into the cache's hash index and LRU list. Links are slot
+ * indexes into the cache array, -1 terminates a list. An entry is linked
+ * exactly while pName is set.
  */
 struct s_dynaFileCacheEntry {
     uchar *pName; /**< name currently open, if dynamic name */
     strm_t *pStrm; /**< our output stream */
     void *sigprovFileData; /**< opaque data ptr for provider use */
-    uint64 clkTickAccessed; /**< for LRU - based on clockFileAccess */
+    unsigned hash; /**< hash_from_string() of pName */
+    int iHashNext; /**< next slot in the same hash bucket */
+    int iLRUPrev; /**< next more recently used slot */
+    int iLRUNext; /**< next less recently used slot */
     short nInactive; /**< number of minutes not writen - for close timeout */
 };
 typedef struct s_dynaFileCacheEntry dynaFileCacheEntry;
@@ -187,9 +155,17 @@ typedef struct _instanceData {
     /**
      * The cache is implemented as an array. An empty element is indicated
      * by a NULL pointer. Memory is allocated as needed. The following
-     * pointer points to the overall structure.
+     * pointer points to the overall structure. Lookup goes through a
+     * chained hash index over the slots, eviction takes the tail of an
+     * intrusive LRU list, so neither depends on the cache size.
      */
     dynaFileCacheEntry **dynCache;
+    int *dynCacheBuckets; /**< first slot of each hash chain, -1 = empty */
+    unsigned dynCacheHashMask; /**< number of buckets - 1 */
+    int *dynCacheFree; /**< stack of released slots below iCurrCacheSize */
+    int nDynCacheFree; /**< number of entries on dynCacheFree */
+    int iLRUHead; /**< most recently used slot, -1 = none */
+    int iLRUTail; /**< least recently used slot, next eviction victim */
     off_t iSizeLimit; /**< file size limit, 0 = no limit */
     uchar *pszSizeLimitCmd; /**< command to carry out when size limit is reached */
     sbool bSizeLimitCmdPassFileName; /**< pass current file name to size limit command? */
@@ -208,6 +184,8 @@ typedef struct _instanceData {
     STATSCOUNTER_DEF(ctrMiss, mutCtrMiss);
     STATSCOUNTER_DEF(ctrMax, mutCtrMax);
     STATSCOUNTER_DEF(ctrCloseTimeouts, mutCtrCloseTimeouts);
+    STATSCOUNTER_DEF(ctrProbes, mutCtrProbes);
+    STATSCOUNTER_DEF(ctrMaxProbe, mutCtrMaxProbe);
     char janitorID[128]; /**< holds ID for janitor calls */
 } instanceData;
 
@@ -506,11 +484,139 @@ finalize_it:
 }
 
 
+/**
+ * @brief Allocates the dynamic file cache and its index for @p size slots.
+ *
+ * The hash index gets at least two buckets per slot, rounded up to a power
+ * of two, so chains stay short even when the cache is full.
+ *
+ * @param pData Pointer to the instance data to receive the cache.
+ * @param size Maximum number of cache entries.
+ * @return RS_RET_OK on success, RS_RET_OUT_OF_MEMORY otherwise.
+ */
+static rsRetVal dynaFileAllocCache(instanceData *__restrict__ const pData, const int size) {
+    unsigned nBuckets = 2;
+    unsigned i;
+    DEFiRet;
+
+    while (nBuckets < 2 * (unsigned)size) nBuckets <<= 1;
+    CHKmalloc(pData->dynCache = (dynaFileCacheEntry **)calloc(size, sizeof(dynaFileCacheEntry *)));
+    CHKmalloc(pData->dynCacheBuckets = (int *)malloc(nBuckets * sizeof(int)));
+    CHKmalloc(pData->dynCacheFree = (int *)malloc(size * sizeof(int)));
+    for (i = 0; i < nBuckets; ++i) pData->dynCacheBuckets[i] = -1;
+    pData->dynCacheHashMask = nBuckets - 1;
+    pData->nDynCacheFree = 0;
+    pData->iLRUHead = pData->iLRUTail = -1;
+    pData->iCurrElt = -1; /* no current element */
+
+finalize_it:
+    RETiRet;
+}
+
+
+/**
+ * @brief Removes slot @p iEntry from the LRU list.
+ */
+static void dynaFileLRUUnlink(instanceData *__restrict__ const pData, const int iEntry) {
+    dynaFileCacheEntry **const pCache = pData->dynCache;
+    const int prev = pCache[iEntry]->iLRUPrev;
+    const int next = pCache[iEntry]->iLRUNext;
+
+    if (prev == -1)
+        pData->iLRUHead = next;
+    else
+        pCache[prev]->iLRUNext = next;
+    if (next == -1)
+        pData->iLRUTail = prev;
+    else
+        pCache[next]->iLRUPrev = prev;
+}
+
+
+/**
+ * @brief Puts slot @p iEntry at the most recently used end of the LRU list.
+ */
+static void dynaFileLRUPushFront(instanceData *__restrict__ const pData, const int iEntry) {
+    dynaFileCacheEntry **const pCache = pData->dynCache;
+
+    pCache[iEntry]->iLRUPrev = -1;
+    pCache[iEntry]->iLRUNext = pData->iLRUHead;
+    if (pData->iLRUHead == -1)
+        pData->iLRUTail = iEntry;
+    else
+        pCache[pData->iLRUHead]->iLRUPrev = iEntry;
+    pData->iLRUHead = iEntry;
+}
+
+
+/**
+ * @brief Marks slot @p iEntry as most recently used.
+ */
+static void dynaFileLRUTouch(instanceData *__restrict__ const pData, const int iEntry) {
+    if (pData->iLRUHead == iEntry) return;
+    dynaFileLRUUnlink(pData, iEntry);
+    dynaFileLRUPushFront(pData, iEntry);
+}
+
+
+/**
+ * @brief Adds the named slot @p iEntry to the hash index and LRU list.
+ */
+static void dynaFileLinkCacheEntry(instanceData *__restrict__ const pData, const int iEntry) {
+    dynaFileCacheEntry *const pEntry = pData->dynCache[iEntry];
+    int *const pBucket = &pData->dynCacheBuckets[pEntry->hash & pData->dynCacheHashMask];
+
+    pEntry->iHashNext = *pBucket;
+    *pBucket = iEntry;
+    dynaFileLRUPushFront(pData, iEntry);
+}
+
+
+/**
+ * @brief Removes slot @p iEntry from the hash index and LRU list.
+ */
+static void dynaFileUnlinkCacheEntry(instanceData *__restrict__ const pData, const int iEntry) {
+    dynaFileCacheEntry **const pCache = pData->dynCache;
+    int *pLink = &pData->dynCacheBuckets[pCache[iEntry]->hash & pData->dynCacheHashMask];
+
+    while (*pLink != iEntry) {
+        assert(*pLink != -1);
+        pLink = &pCache[*pLink]->iHashNext;
+    }
+    *pLink = pCache[iEntry]->iHashNext;
+    dynaFileLRUUnlink(pData, iEntry);
+}
+
+
+/**
+ * @brief Looks up @p name in the cache index.
+ *
+ * Updates the probe counters with the number of entries compared.
+ *
+ * @return the slot holding @p name, or -1 if it is not cached.
+ */
+static int dynaFileFindCacheEntry(instanceData *__restrict__ const pData, const uchar *const name, const unsigned hash) {
+    dynaFileCacheEntry **const pCache = pData->dynCache;
+    unsigned nProbes = 0;
+    int i;
+
+    for (i = pData->dynCacheBuckets[hash & pData->dynCacheHashMask]; i != -1; i = pCache[i]->iHashNext) {
+        ++nProbes;
+        if (pCache[i]->hash == hash && !ustrcmp(name, pCache[i]->pName)) break;
+    }
+    STATSCOUNTER_ADD(pData->ctrProbes, pData->mutCtrProbes, nProbes);
+    STATSCOUNTER_SETMAX_NOMUT(pData->ctrMaxProbe, nProbes);
+    return i;
+}
+
+
 /**
  * @brief Deletes an entry from the dynamic file name cache.
  *
  * This function closes the associated file stream, frees memory for the
- * file name, and optionally frees the cache entry structure itself.
+ * file name, and optionally frees the cache entry structure itself. A
+ * named entry is removed from the cache index; a freed slot is recorded
+ * for reuse.
  *
  * @param pData Pointer to the instance data containing the dynamic file cache.
  * @param iEntry The index of the entry to be deleted in the cache array.
@@ -530,6 +636,7 @@ static rsRetVal dynaFileDelCacheEntry(instanceData *__restrict__ const pData, co
               pCache[iEntry]->pName == NULL ? UCHAR_CONSTANT("[OPEN FAILED]") : pCache[iEntry]->pName);
 
     if (pCache[iEntry]->pName != NULL) {
+        dynaFileUnlinkCacheEntry(pData, iEntry);
         free(pCache[iEntry]->pName);
         pCache[iEntry]->pName = NULL;
     }
@@ -549,6 +656,7 @@ static rsRetVal dynaFileDelCacheEntry(instanceData *__restrict__ const pData, co
     if (bFreeEntry) {
         free(pCache[iEntry]);
         pCache[iEntry] = NULL;
+        pData->dynCacheFree[pData->nDynCacheFree++] = iEntry;
     }
 
 finalize_it:
@@ -571,6 +679,9 @@ static void dynaFileFreeCacheEntries(instanceData *__restrict__ const pData) {
     for (i = 0; i < pData->iCurrCacheSize; ++i) {
         dynaFileDelCacheEntry(pData, i, 1);
     }
+    /* all slots are free again, start over with a fresh slot range */
+    pData->iCurrCacheSize = 0;
+    pData->nDynCacheFree = 0;
     /* invalidate current element */
     pData->iCurrElt = -1;
     pData->pStrm = NULL;
@@ -588,8 +699,10 @@ static void dynaFileFreeCacheEntries(instanceData *__restrict__ const pData) {
 static void dynaFileFreeCache(instanceData *__restrict__ const pData) {
     assert(pData != NULL);
 
-    dynaFileFreeCacheEntries(pData);
-    if (pData->dynCache != NULL) free(pData->dynCache);
+    if (pData->dynCache != NULL) dynaFileFreeCacheEntries(pData);
+    free(pData->dynCache);
+    free(pData->dynCacheBuckets);
+    free(pData->dynCacheFree);
 }
 
 
@@ -755,8 +868,8 @@ finalize_it:
  *
  * This function checks if the requested dynamic file name is already present
  * in the cache. If so, it reuses the existing file handle. If not, it attempts
- * to open the new file, potentially evicting an older entry from the LRU cache
- * if the cache is full.
+ * to open the new file, potentially evicting the least recently used entry
+ * if the cache is full. Lookup and eviction both run in constant time.
  *
  * @param pData Pointer to the instance data for the file output action.
  * @param newFileName The new dynamic file name to prepare.
@@ -765,11 +878,9 @@ finalize_it:
  */
 static rsRetVal ATTR_NONNULL()
     prepareDynFile(instanceData *__restrict__ const pData, const uchar *__restrict__ const newFileName) {
-    uint64 ctOldest; /* "timestamp" of oldest element */
-    int iOldest;
+    unsigned hash;
     int i;
     int iFirstFree;
-    int bNewCacheSlot;
     rsRetVal localRet;
     dynaFileCacheEntry **pCache;
     DEFiRet;
@@ -789,9 +900,8 @@ static rsRetVal ATTR_NONNULL()
     if ((pData->iCurrElt != -1) && (pCache[pData->iCurrElt] != NULL) && (pCache[pData->iCurrElt]->pName != NULL) &&
         !ustrcmp(newFileName, pCache[pData->iCurrElt]->pName)) {
         /* great, we are all set */
-        pCache[pData->iCurrElt]->clkTickAccessed = getClockFileAccess();
+        dynaFileLRUTouch(pData, pData->iCurrElt);
         STATSCOUNTER_INC(pData->ctrLevel0, pData->mutCtrLevel0);
-        /* LRU needs only a strictly monotonically increasing counter, so such a one could do */
         FINALIZE;
     }
 
@@ -806,32 +916,17 @@ static rsRetVal ATTR_NONNULL()
         CHKiRet(strm.Flush(pData->pStrm));
     }
 
-    /* Now let's search the table if we find a matching spot.
-     * While doing so, we also prepare for creation of a new one.
-     */
+    /* Now let's search the index if we find a matching spot. */
     pData->iCurrElt = -1; /* invalid current element pointer */
-    iFirstFree = -1; /* not yet found */
-    bNewCacheSlot = 0;
-    iOldest = 0; /* we assume the first element to be the oldest - that will change as we loop */
-    ctOldest = getClockFileAccess(); /* there must always be an older one */
-    for (i = 0; i < pData->iCurrCacheSize; ++i) {
-        if (pCache[i] == NULL || pCache[i]->pName == NULL) {
-            if (iFirstFree == -1) iFirstFree = i;
-        } else { /* got an element, let's see if it matches */
-            if (!ustrcmp(newFileName, pCache[i]->pName)) {
-                /* we found our element! */
-                pData->pStrm = pCache[i]->pStrm;
-                if (pData->useSigprov) pData->sigprovFileData = pCache[i]->sigprovFileData;
-                pData->iCurrElt = i;
-                pCache[i]->clkTickAccessed = getClockFileAccess(); /* update "timestamp" for LRU */
-                FINALIZE;
-            }
-            /* did not find it - so lets keep track of the counters for LRU */
-            if (pCache[i]->clkTickAccessed < ctOldest) {
-                ctOldest = pCache[i]->clkTickAccessed;
-                iOldest = i;
-            }
-        }
+    hash = hash_from_string((void *)newFileName);
+    i = dynaFileFindCacheEntry(pData, newFileName, hash);
+    if (i != -1) {
+        /* we found our element! */
+        pData->pStrm = pCache[i]->pStrm;
+        if (pData->useSigprov) pData->sigprovFileData = pCache[i]->sigprovFileData;
+        pData->iCurrElt = i;
+        dynaFileLRUTouch(pData, i);
+        FINALIZE;
     }
 
     /* we have not found an entry */
@@ -844,10 +939,14 @@ static rsRetVal ATTR_NONNULL()
      */
     pData->pStrm = NULL, pData->sigprovFileData = NULL;
 
-    if (iFirstFree == -1 && (pData->iCurrCacheSize < pData->iDynaFileCacheSize)) {
-        /* there is space left, so set it to that index */
-        iFirstFree = pData->iCurrCacheSize;
-        bNewCacheSlot = 1;
+    /* prefer a previously released slot, then a never used one */
+    if (pData->nDynCacheFree > 0) {
+        iFirstFree = pData->dynCacheFree[--pData->nDynCacheFree];
+    } else if (pData->iCurrCacheSize < pData->iDynaFileCacheSize) {
+        iFirstFree = pData->iCurrCacheSize++;
+        STATSCOUNTER_SETMAX_NOMUT(pData->ctrMax, (unsigned)pData->iCurrCacheSize);
+    } else {
+        iFirstFree = -1;
     }
 
     /* Note that the following code sequence does not work with the cache entry itself,
@@ -855,13 +954,18 @@ static rsRetVal ATTR_NONNULL()
      * The cache array is only updated after the open was successful. -- rgerhards, 2010-03-21
      */
     if (iFirstFree == -1) {
-        dynaFileDelCacheEntry(pData, iOldest, 0);
+        /* a full cache has every slot named, so the LRU tail exists */
+        iFirstFree = pData->iLRUTail;
+        assert(iFirstFree != -1);
+        dynaFileDelCacheEntry(pData, iFirstFree, 0);
         STATSCOUNTER_INC(pData->ctrEvict, pData->mutCtrEvict);
-        iFirstFree = iOldest; /* this one *is* now free ;) */
     }
     if (pCache[iFirstFree] == NULL) {
         /* we need to allocate memory for the cache structure */
-        CHKmalloc(pCache[iFirstFree] = (dynaFileCacheEntry *)calloc(1, sizeof(dynaFileCacheEntry)));
+        if ((pCache[iFirstFree] = (dynaFileCacheEntry *)calloc(1, sizeof(dynaFileCacheEntry))) == NULL) {
+            pData->dynCacheFree[pData->nDynCacheFree++] = iFirstFree;
+            ABORT_FINALIZE(RS_RET_OUT_OF_MEMORY);
+        }
     }
 
     /* Ok, we finally can open the file */
@@ -893,12 +997,9 @@ static rsRetVal ATTR_NONNULL()
     }
     pCache[iFirstFree]->pStrm = pData->pStrm;
     if (pData->useSigprov) pCache[iFirstFree]->sigprovFileData = pData->sigprovFileData;
-    pCache[iFirstFree]->clkTickAccessed = getClockFileAccess();
+    pCache[iFirstFree]->hash = hash;
+    dynaFileLinkCacheEntry(pData, iFirstFree);
     pData->iCurrElt = iFirstFree;
-    if (bNewCacheSlot) {
-        pData->iCurrCacheSize++;
-        STATSCOUNTER_SETMAX_NOMUT(pData->ctrMax, (unsigned)pData->iCurrCacheSize);
-    }
     DBGPRINTF("Added new entry %d for file cache, file '%s'.\n", iFirstFree, newFileName);
 
 finalize_it:
@@ -1369,6 +1470,12 @@ static rsRetVal setupInstStatsCtrs(instanceData *__restrict__ const pData) {
     STATSCOUNTER_INIT(pData->ctrCloseTimeouts, pData->mutCtrCloseTimeouts);
     CHKiRet(statsobj.AddCounter(pData->stats, UCHAR_CONSTANT("closetimeouts"), ctrType_IntCtr, CTR_FLAG_RESETTABLE,
                                 &(pData->ctrCloseTimeouts)));
+    STATSCOUNTER_INIT(pData->ctrProbes, pData->mutCtrProbes);
+    CHKiRet(statsobj.AddCounter(pData->stats, UCHAR_CONSTANT("probes"), ctrType_IntCtr, CTR_FLAG_RESETTABLE,
+                                &(pData->ctrProbes)));
+    STATSCOUNTER_INIT(pData->ctrMaxProbe, pData->mutCtrMaxProbe);
+    CHKiRet(statsobj.AddCounter(pData->stats, UCHAR_CONSTANT("maxprobe"), ctrType_IntCtr, CTR_FLAG_RESETTABLE,
+                                &(pData->ctrMaxProbe)));
     CHKiRet(statsobj.ConstructFinalize(pData->stats));
 
 finalize_it:
@@ -1626,11 +1733,8 @@ BEGINnewActInst
          */
         CHKiRet(OMSRsetEntry(*ppOMSR, 1, ustrdup(pData->fname), OMSR_TPL_AS_DYNAFILE));
         pData->iNumTpls = 2;
-        // TODO: create unified code for this (legacy+v6 system)
         /* we now allocate the cache table */
-        CHKmalloc(pData->dynCache =
-                      (dynaFileCacheEntry **)calloc(pData->iDynaFileCacheSize, sizeof(dynaFileCacheEntry *)));
-        pData->iCurrElt = -1; /* no current element */
+        CHKiRet(dynaFileAllocCache(pData, pData->iDynaFileCacheSize));
     }
     // TODO: add	pData->iSizeLimit = 0; /* default value, use outchannels to configure! */
     setupInstStatsCtrs(pData);
@@ -1701,8 +1805,7 @@ BEGINparseSelectorAct
              */
             CHKiRet(OMSRsetEntry(*ppOMSR, 1, ustrdup(pData->fname), OMSR_TPL_AS_DYNAFILE));
             /* we now allocate the cache table */
-            CHKmalloc(pData->dynCache =
-                          (dynaFileCacheEntry **)calloc(cs.iDynaFileCacheSize, sizeof(dynaFileCacheEntry *)));
+            CHKiRet(dynaFileAllocCache(pData, cs.iDynaFileCacheSize));
             break;
 
         case '/':
@@ -1788,7 +1891,6 @@ BEGINmodExit
     CODESTARTmodExit;
     objRelease(strm, CORE_COMPONENT);
     objRelease(statsobj, CORE_COMPONENT);
-    DESTROY_ATOMIC_HELPER_MUT(mutClock);
 ENDmodExit
 
 
@@ -1810,8 +1912,6 @@ BEGINmodInitNoPredecl(File)
     CHKiRet(objUse(strm, CORE_COMPONENT));
     CHKiRet(objUse(statsobj, CORE_COMPONENT));
 
-    INIT_ATOMIC_HELPER_MUT(mutClock);
-
     INITChkCoreFeature(bCoreSupportsBatching, CORE_FEATURE_BATCHING);
     DBGPRINTF("omfile: %susing transactional output interface.\n", bCoreSupportsBatching ? "" : "not ");
     CHKiRet(omsdRegCFSLineHdlr((uchar *)"dynafilecachesize", 0, eCmdHdlrInt, setDynaFileCacheSize, NULL,
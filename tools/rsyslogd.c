@@ -877,6 +877,84 @@ static rsRetVal msgConsumer(void __attribute__((unused)) * notNeeded, batch_t *p
 }
 
 
+/* number of messages the parse stage hands to a target queue at once */
+#define PARSERQ_FWD_BATCH 128
+
+/* queue a message would be submitted to, were there no parse stage */
+static qqueue_t *getRulesetQueue(smsg_t *const pMsg) {
+    ruleset_t *const pRuleset = MsgGetRuleset(pMsg);
+    return (pRuleset == NULL) ? runConf->pMsgQueue : ruleset.GetRulesetQueue(pRuleset);
+}
+
+/* forward what was collected for pQueue; the messages carry their own reference */
+static void parserQueueForward(qqueue_t *const pQueue, multi_submit_t *const pMultiSub) {
+    if (pMultiSub->nElem == 0) return;
+    if (pQueue == NULL) {
+        /* queue no longer exists during shutdown */
+        for (int i = 0; i < pMultiSub->nElem; ++i) msgDestruct(&pMultiSub->ppMsgs[i]);
+    } else {
+        pQueue->MultiEnq(pQueue, pMultiSub);
+    }
+    pMultiSub->nElem = 0;
+}
+
+/**
+ * @brief Consumer of the parser queue (Worker Thread).
+ *
+ * Runs the same preprocessing msgConsumer() would do and then hands the
+ * messages to the main or ruleset queue they belong to. With a parse stage,
+ * the workers of those queues find the messages already parsed, and parsing
+ * of the next batch overlaps with rule processing of the previous one.
+ *
+ * Messages are forwarded in the order of the batch. Discarded messages are
+ * dropped here. The batch itself is released by the parser queue, so every
+ * forwarded message gets an additional reference.
+ */
+static rsRetVal parserQueueConsumer(void __attribute__((unused)) * notNeeded, batch_t *pBatch, wti_t *pWti) {
+    smsg_t *fwdMsgs[PARSERQ_FWD_BATCH];
+    multi_submit_t multiSub = {PARSERQ_FWD_BATCH, 0, fwdMsgs};
+    qqueue_t *pCurrQueue = NULL;
+    int i;
+    DEFiRet;
+    assert(pBatch != NULL);
+    preprocessBatch(pBatch, pWti);
+    for (i = 0; i < pBatch->nElem && !wtiIsShutdownImmediate(pWti); i++) {
+        if (pBatch->eltState[i] != BATCH_STATE_DISC) {
+            smsg_t *const pMsg = pBatch->pElem[i].pMsg;
+            qqueue_t *const pQueue = getRulesetQueue(pMsg);
+            if (pQueue != pCurrQueue || multiSub.nElem == multiSub.maxElem) {
+                parserQueueForward(pCurrQueue, &multiSub);
+                pCurrQueue = pQueue;
+            }
+            multiSub.ppMsgs[multiSub.nElem++] = MsgAddRef(pMsg);
+        }
+        pBatch->eltState[i] = BATCH_STATE_COMM;
+    }
+    parserQueueForward(pCurrQueue, &multiSub);
+    RETiRet;
+}
+
+
+/* create the queue of the parse stage. Its workers parse messages and pass
+ * them on to the main and ruleset queues. It is an in-memory queue with the
+ * ruleset queue defaults; only the number of workers is configurable.
+ */
+rsRetVal createParserQueue(qqueue_t **ppQueue, const int iWorkerThreads) {
+    DEFiRet;
+
+    CHKiRet(qqueueConstruct(ppQueue, QUEUETYPE_FIXED_ARRAY, iWorkerThreads, 0, parserQueueConsumer));
+    obj.SetName((obj_t *)(*ppQueue), UCHAR_CONSTANT("parser Q"));
+    qqueueSetDefaultsRulesetQueue(*ppQueue);
+    CHKiRet(qqueueSetiNumWorkerThreads(*ppQueue, iWorkerThreads));
+    CHKiRet(qqueueSetiDeqBatchSize(*ppQueue, PARSERQ_FWD_BATCH));
+    qqueueCorrectParams(*ppQueue);
+
+finalize_it:
+    if (iRet != RS_RET_OK && *ppQueue != NULL) qqueueDestruct(ppQueue);
+    RETiRet;
+}
+
+
 /* create a main message queue, now also used for ruleset queues. This function
  * needs to be moved to some other module, but it is considered acceptable for
  * the time being (remember that we want to restructure config processing at large!).
@@ -1281,7 +1359,11 @@ rsRetVal submitMsg2(smsg_t *pMsg) {
 
     pRuleset = MsgGetRuleset(pMsg);
     assert(ruleset.GetRulesetQueue != NULL); /* This is only to keep clang static analyzer happy */
-    pQueue = (pRuleset == NULL) ? runConf->pMsgQueue : ruleset.GetRulesetQueue(pRuleset);
+    if (runConf->pParserQueue != NULL && (pMsg->msgFlags & (NEEDS_PARSING | NEEDS_ACLCHK_U)) != 0) {
+        pQueue = runConf->pParserQueue;
+    } else {
+        pQueue = (pRuleset == NULL) ? runConf->pMsgQueue : ruleset.GetRulesetQueue(pRuleset);
+    }
 
     /* if a plugin logs a message during shutdown, the queue may no longer exist */
     if (pQueue == NULL) {
@@ -1309,7 +1391,12 @@ rsRetVal ATTR_NONNULL() multiSubmitMsg2(multi_submit_t *const pMultiSub) {
     if (pMultiSub->nElem == 0) FINALIZE;
 
     pRuleset = MsgGetRuleset(pMultiSub->ppMsgs[0]);
-    pQueue = (pRuleset == NULL) ? runConf->pMsgQueue : ruleset.GetRulesetQueue(pRuleset);
+    /* all messages of a multi-submit come from the same input, so the first one decides */
+    if (runConf->pParserQueue != NULL && (pMultiSub->ppMsgs[0]->msgFlags & (NEEDS_PARSING | NEEDS_ACLCHK_U)) != 0) {
+        pQueue = runConf->pParserQueue;
+    } else {
+        pQueue = (pRuleset == NULL) ? runConf->pMsgQueue : ruleset.GetRulesetQueue(pRuleset);
+    }
 
     /* if a plugin logs a message during shutdown, the queue may no longer exist */
     if (pQueue == NULL) {
@@ -2559,6 +2646,12 @@ static void deinitAll(void) {
      */
     srSleep(0, 50);
 
+    /* the parse stage is drained into the main and ruleset queues, so it goes first */
+    if (runConf->pParserQueue != NULL) {
+        DBGPRINTF("Terminating parser queue...\n");
+        qqueueDestruct(&runConf->pParserQueue);
+    }
+
     /* drain queue (if configured so) and stop main queue worker thread pool */
     DBGPRINTF("Terminating main queue...\n");
     qqueueDestruct(&runConf->pMsgQueue);
@@ -2572,6 +2665,9 @@ static void deinitAll(void) {
 
     DBGPRINTF("all primary multi-thread sources have been terminated - now doing aux cleanup...\n");
 
+    /* resolver threads use the config, so they must be gone before it is */
+    dnscacheStopResolver();
+
     DBGPRINTF("destructing current config...\n");
     rsconf.Destruct(&runConf);
 